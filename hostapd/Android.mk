@@ -140,6 +140,15 @@ ifdef CONFIG_ELOOP_EPOLL
 L_CFLAGS += -DCONFIG_ELOOP_EPOLL
 endif
 
+ifdef CONFIG_ELOOP_STATS
+L_CFLAGS += -DCONFIG_ELOOP_STATS
+endif
+
+ifdef CONFIG_MEM_POOL
+L_CFLAGS += -DCONFIG_MEM_POOL
+OBJS += src/utils/mem_pool.c
+endif
+
 OBJS += src/utils/common.c
 OBJS += src/utils/wpa_debug.c
 OBJS += src/utils/wpabuf.c
@@ -420,6 +429,7 @@ OBJS += src/eap_common/eap_sim_common.c
 # replaced with another file implementating the interface specified in
 # eap_sim_db.h.
 OBJS += src/eap_server/eap_sim_db.c
+OBJS += src/utils/timer_list.c
 NEED_FIPS186_2_PRF=y
 endif
 
@@ -1040,6 +1050,10 @@ ifdef CONFIG_DEBUG_FILE
 L_CFLAGS += -DCONFIG_DEBUG_FILE
 endif
 
+ifdef CONFIG_DEBUG_BUFFERED
+L_CFLAGS += -DCONFIG_DEBUG_BUFFERED
+endif
+
 ifdef CONFIG_ANDROID_LOG
 L_CFLAGS += -DCONFIG_ANDROID_LOG
 endif
@@ -1050,6 +1064,9 @@ OBJS_c += src/utils/os_$(CONFIG_OS).c
 OBJS_c += src/common/cli.c
 OBJS_c += src/utils/eloop.c
 OBJS_c += src/utils/common.c
+ifdef CONFIG_MEM_POOL
+OBJS_c += src/utils/mem_pool.c
+endif
 ifdef CONFIG_WPA_TRACE
 OBJS_c += src/utils/trace.c
 endif
@@ -9,6 +9,7 @@
 #include "utils/includes.h"
 #ifndef CONFIG_NATIVE_WINDOWS
 #include <grp.h>
+#include <sys/stat.h>
 #endif /* CONFIG_NATIVE_WINDOWS */
 
 #include "utils/common.h"
@@ -1114,6 +1115,28 @@ static int add_r1kh(struct hostapd_bss_config *bss, char *value)
 
 	return 0;
 }
+
+
+static int parse_r0kh(struct hostapd_bss_config *bss, char *pos, int line)
+{
+	if (add_r0kh(bss, pos) < 0) {
+		wpa_printf(MSG_DEBUG, "Line %d: Invalid r0kh '%s'",
+			   line, pos);
+		return -1;
+	}
+	return 0;
+}
+
+
+static int parse_r1kh(struct hostapd_bss_config *bss, char *pos, int line)
+{
+	if (add_r1kh(bss, pos) < 0) {
+		wpa_printf(MSG_DEBUG, "Line %d: Invalid r1kh '%s'",
+			   line, pos);
+		return -1;
+	}
+	return 0;
+}
 #endif /* CONFIG_IEEE80211R_AP */
 
 
@@ -2059,10 +2082,399 @@ static int parse_fils_realm(struct hostapd_bss_config *bss, const char *val)
 #endif /* CONFIG_FILS */
 
 
+/*
+ * Configuration fields that map directly to a single member of struct
+ * hostapd_config or struct hostapd_bss_config or that have a separate parser
+ * function. These are looked up with a binary search instead of going through
+ * the full list of string comparisons in hostapd_config_fill().
+ */
+enum hostapd_config_field_type {
+	HOSTAPD_FIELD_INT_BSS, HOSTAPD_FIELD_INT_CONF,
+	HOSTAPD_FIELD_STR_BSS, HOSTAPD_FIELD_STR_CONF,
+	HOSTAPD_FIELD_FUNC
+};
+
+struct hostapd_config_field {
+	const char *name;
+	enum hostapd_config_field_type type;
+	size_t offset;
+	size_t size;
+	int (*parser)(struct hostapd_bss_config *bss, char *pos, int line);
+};
+
+#define BSS_MEMBER_SIZE(f) sizeof(((struct hostapd_bss_config *) 0)->f)
+#define CONF_MEMBER_SIZE(f) sizeof(((struct hostapd_config *) 0)->f)
+
+#define INT_BSS_NAME(n, f) #n, HOSTAPD_FIELD_INT_BSS, \
+	offsetof(struct hostapd_bss_config, f), BSS_MEMBER_SIZE(f), NULL
+#define INT_CONF_NAME(n, f) #n, HOSTAPD_FIELD_INT_CONF, \
+	offsetof(struct hostapd_config, f), CONF_MEMBER_SIZE(f), NULL
+#define STR_BSS_NAME(n, f) #n, HOSTAPD_FIELD_STR_BSS, \
+	offsetof(struct hostapd_bss_config, f), 0, NULL
+#define STR_CONF_NAME(n, f) #n, HOSTAPD_FIELD_STR_CONF, \
+	offsetof(struct hostapd_config, f), 0, NULL
+#define INT_BSS(f) INT_BSS_NAME(f, f)
+#define INT_CONF(f) INT_CONF_NAME(f, f)
+#define STR_BSS(f) STR_BSS_NAME(f, f)
+#define STR_CONF(f) STR_CONF_NAME(f, f)
+#define FUNC(n, func) #n, HOSTAPD_FIELD_FUNC, 0, 0, func
+
+static const struct hostapd_config_field hostapd_config_fields[] = {
+	{ STR_CONF(driver_params) },
+	{ INT_BSS(logger_syslog_level) },
+	{ INT_BSS(logger_stdout_level) },
+	{ INT_BSS(logger_syslog) },
+	{ INT_BSS(logger_stdout) },
+	{ INT_BSS(wds_sta) },
+	{ INT_BSS(start_disabled) },
+	{ INT_BSS_NAME(ap_isolate, isolate) },
+	{ INT_BSS(ap_max_inactivity) },
+	{ INT_BSS(skip_inactivity_poll) },
+	{ INT_CONF(ieee80211d) },
+	{ INT_CONF(ieee80211h) },
+	{ INT_BSS_NAME(ieee8021x, ieee802_1x) },
+#ifdef EAP_SERVER
+	{ INT_BSS(eap_server) },
+	{ STR_BSS(ca_cert) },
+	{ STR_BSS(server_cert) },
+	{ STR_BSS(private_key) },
+	{ STR_BSS(private_key_passwd) },
+	{ INT_BSS(check_crl) },
+	{ INT_BSS(tls_session_lifetime) },
+	{ STR_BSS(ocsp_stapling_response) },
+	{ STR_BSS(ocsp_stapling_response_multi) },
+	{ STR_BSS(dh_file) },
+	{ STR_BSS(openssl_ciphers) },
+	{ INT_BSS(fragment_size) },
+#ifdef EAP_SERVER_FAST
+	{ STR_BSS(eap_fast_a_id_info) },
+	{ INT_BSS(eap_fast_prov) },
+	{ INT_BSS(pac_key_lifetime) },
+	{ INT_BSS(pac_key_refresh_time) },
+#endif /* EAP_SERVER_FAST */
+#ifdef EAP_SERVER_SIM
+	{ STR_BSS(eap_sim_db) },
+	{ INT_BSS(eap_sim_db_timeout) },
+	{ INT_BSS(eap_sim_aka_result_ind) },
+#endif /* EAP_SERVER_SIM */
+#ifdef EAP_SERVER_TNC
+	{ INT_BSS(tnc) },
+#endif /* EAP_SERVER_TNC */
+#ifdef EAP_SERVER_PWD
+	{ INT_BSS(pwd_group) },
+#endif /* EAP_SERVER_PWD */
+	{ INT_BSS(eap_server_erp) },
+#endif /* EAP_SERVER */
+	{ INT_BSS(erp_send_reauth_start) },
+	{ STR_BSS(erp_domain) },
+	{ INT_BSS(eapol_key_index_workaround) },
+	{ STR_BSS(nas_identifier) },
+#ifndef CONFIG_NO_RADIUS
+	{ INT_BSS_NAME(radius_acct_interim_interval, acct_interim_interval) },
+	{ INT_BSS(radius_request_cui) },
+	{ INT_BSS(radius_das_port) },
+	{ INT_BSS(radius_das_time_window) },
+	{ INT_BSS(radius_das_require_event_timestamp) },
+#endif /* CONFIG_NO_RADIUS */
+	{ INT_BSS(wpa) },
+	{ INT_BSS(wpa_strict_rekey) },
+	{ INT_BSS(wpa_gmk_rekey) },
+	{ INT_BSS(wpa_ptk_rekey) },
+#ifdef CONFIG_RSN_PREAUTH
+	{ INT_BSS(rsn_preauth) },
+	{ STR_BSS(rsn_preauth_interfaces) },
+#endif /* CONFIG_RSN_PREAUTH */
+#ifdef CONFIG_PEERKEY
+	{ INT_BSS(peerkey) },
+#endif /* CONFIG_PEERKEY */
+#ifdef CONFIG_IEEE80211R_AP
+	{ INT_BSS(r0_key_lifetime) },
+	{ INT_BSS(reassociation_deadline) },
+	{ INT_BSS(rkh_pos_timeout) },
+	{ INT_BSS(rkh_neg_timeout) },
+	{ INT_BSS(rkh_pull_timeout) },
+	{ INT_BSS(rkh_pull_retries) },
+	{ INT_BSS(pmk_r1_push) },
+	{ INT_BSS(ft_over_ds) },
+	{ INT_BSS(ft_psk_generate_local) },
+	{ FUNC(r0kh, parse_r0kh) },
+	{ FUNC(r1kh, parse_r1kh) },
+#endif /* CONFIG_IEEE80211R_AP */
+#ifndef CONFIG_NO_CTRL_IFACE
+	{ STR_BSS(ctrl_interface) },
+#endif /* CONFIG_NO_CTRL_IFACE */
+#ifdef RADIUS_SERVER
+	{ STR_BSS(radius_server_clients) },
+	{ INT_BSS(radius_server_auth_port) },
+	{ INT_BSS(radius_server_acct_port) },
+	{ INT_BSS(radius_server_acct_reuseport) },
+	{ INT_BSS(radius_server_batch) },
+	{ INT_BSS(radius_server_sqlite_queue) },
+	{ INT_BSS(radius_server_sqlite_commit_interval) },
+	{ INT_BSS(radius_server_sqlite_wal) },
+	{ INT_BSS(radius_server_ipv6) },
+#endif /* RADIUS_SERVER */
+	{ INT_BSS(use_pae_group_addr) },
+	{ INT_CONF(acs_exclude_dfs) },
+	{ INT_BSS(ignore_broadcast_ssid) },
+	{ INT_BSS(no_probe_resp_if_max_sta) },
+#ifndef CONFIG_NO_VLAN
+	{ INT_BSS_NAME(dynamic_vlan, ssid.dynamic_vlan) },
+	{ INT_BSS_NAME(per_sta_vif, ssid.per_sta_vif) },
+#ifdef CONFIG_FULL_DYNAMIC_VLAN
+	{ STR_BSS_NAME(vlan_tagged_interface, ssid.vlan_tagged_interface) },
+#endif /* CONFIG_FULL_DYNAMIC_VLAN */
+#endif /* CONFIG_NO_VLAN */
+	{ INT_CONF(ap_table_max_size) },
+	{ INT_CONF(ap_table_expiration_time) },
+	{ INT_BSS_NAME(uapsd_advertisement_enabled, wmm_uapsd) },
+	{ INT_CONF(use_driver_iface_addr) },
+#ifdef CONFIG_IEEE80211W
+	{ INT_BSS(ieee80211w) },
+#endif /* CONFIG_IEEE80211W */
+#ifdef CONFIG_IEEE80211N
+	{ INT_CONF(ieee80211n) },
+	{ INT_CONF(require_ht) },
+	{ INT_CONF(obss_interval) },
+#endif /* CONFIG_IEEE80211N */
+#ifdef CONFIG_IEEE80211AC
+	{ INT_CONF(ieee80211ac) },
+	{ INT_CONF(require_vht) },
+	{ INT_CONF(vht_oper_chwidth) },
+	{ INT_CONF(vht_oper_centr_freq_seg0_idx) },
+	{ INT_CONF(vht_oper_centr_freq_seg1_idx) },
+	{ INT_BSS(vendor_vht) },
+	{ INT_BSS(use_sta_nsts) },
+#endif /* CONFIG_IEEE80211AC */
+#ifdef CONFIG_IEEE80211AX
+	{ INT_CONF(ieee80211ax) },
+	{ INT_CONF_NAME(he_su_beamformer, he_phy_capab.he_su_beamformer) },
+	{ INT_CONF_NAME(he_su_beamformee, he_phy_capab.he_su_beamformee) },
+	{ INT_CONF_NAME(he_mu_beamformer, he_phy_capab.he_mu_beamformer) },
+	{ INT_CONF_NAME(he_bss_color, he_op.he_bss_color) },
+	{ INT_CONF_NAME(he_default_pe_duration, he_op.he_default_pe_duration) },
+	{ INT_CONF_NAME(he_twt_required, he_op.he_twt_required) },
+	{ INT_CONF_NAME(he_rts_threshold, he_op.he_rts_threshold) },
+#endif /* CONFIG_IEEE80211AX */
+	{ INT_BSS(max_listen_interval) },
+	{ INT_BSS(disable_pmksa_caching) },
+	{ INT_BSS(okc) },
+#ifdef CONFIG_WPS
+	{ INT_BSS(wps_independent) },
+	{ INT_BSS(ap_setup_locked) },
+	{ STR_BSS(wps_pin_requests) },
+	{ STR_BSS(config_methods) },
+	{ STR_BSS(ap_pin) },
+	{ INT_BSS(skip_cred_build) },
+	{ INT_BSS(wps_cred_processing) },
+	{ STR_BSS(upnp_iface) },
+	{ STR_BSS(friendly_name) },
+	{ STR_BSS(manufacturer_url) },
+	{ STR_BSS(model_description) },
+	{ STR_BSS(model_url) },
+	{ STR_BSS(upc) },
+	{ INT_BSS(pbc_in_m1) },
+	{ STR_BSS(server_id) },
+#endif /* CONFIG_WPS */
+	{ INT_BSS(disassoc_low_ack) },
+	{ INT_BSS(time_advertisement) },
+#ifdef CONFIG_WNM_AP
+	{ INT_BSS(wnm_sleep_mode) },
+	{ INT_BSS(bss_transition) },
+#endif /* CONFIG_WNM_AP */
+#ifdef CONFIG_INTERWORKING
+	{ INT_BSS(interworking) },
+	{ INT_BSS(internet) },
+	{ INT_BSS(asra) },
+	{ INT_BSS(esr) },
+	{ INT_BSS(uesa) },
+	{ FUNC(roaming_consortium, parse_roaming_consortium) },
+	{ FUNC(venue_name, parse_venue_name) },
+	{ FUNC(anqp_3gpp_cell_net, parse_3gpp_cell_net) },
+	{ FUNC(nai_realm, parse_nai_realm) },
+	{ FUNC(anqp_elem, parse_anqp_elem) },
+	{ INT_BSS(gas_comeback_delay) },
+	{ FUNC(qos_map_set, parse_qos_map_set) },
+#endif /* CONFIG_INTERWORKING */
+#ifdef CONFIG_RADIUS_TEST
+	{ STR_BSS(dump_msk_file) },
+#endif /* CONFIG_RADIUS_TEST */
+#ifdef CONFIG_PROXYARP
+	{ INT_BSS(proxy_arp) },
+#endif /* CONFIG_PROXYARP */
+#ifdef CONFIG_HS20
+	{ INT_BSS(hs20) },
+	{ INT_BSS(disable_dgaf) },
+	{ INT_BSS(na_mcast_to_ucast) },
+	{ INT_BSS(osen) },
+	{ INT_BSS(anqp_domain_id) },
+	{ INT_BSS(hs20_deauth_req_timeout) },
+	{ FUNC(hs20_oper_friendly_name, hs20_parse_oper_friendly_name) },
+	{ FUNC(hs20_wan_metrics, hs20_parse_wan_metrics) },
+	{ FUNC(osu_ssid, hs20_parse_osu_ssid) },
+	{ FUNC(osu_server_uri, hs20_parse_osu_server_uri) },
+	{ FUNC(osu_friendly_name, hs20_parse_osu_friendly_name) },
+	{ FUNC(osu_nai, hs20_parse_osu_nai) },
+	{ FUNC(osu_method_list, hs20_parse_osu_method_list) },
+	{ FUNC(osu_icon, hs20_parse_osu_icon) },
+	{ FUNC(osu_service_desc, hs20_parse_osu_service_desc) },
+	{ STR_BSS(subscr_remediation_url) },
+	{ INT_BSS(subscr_remediation_method) },
+#endif /* CONFIG_HS20 */
+#ifdef CONFIG_MBO
+	{ INT_BSS_NAME(mbo, mbo_enabled) },
+	{ INT_BSS(mbo_cell_data_conn_pref) },
+#endif /* CONFIG_MBO */
+#ifdef CONFIG_TESTING_OPTIONS
+	{ INT_CONF(ecsa_ie_only) },
+#endif /* CONFIG_TESTING_OPTIONS */
+	{ INT_BSS(sae_anti_clogging_threshold) },
+	{ INT_CONF(spectrum_mgmt_required) },
+	{ STR_BSS(wowlan_triggers) },
+	{ INT_CONF(track_sta_max_num) },
+	{ INT_CONF(track_sta_max_age) },
+	{ STR_BSS(no_probe_resp_if_seen_on) },
+	{ STR_BSS(no_auth_if_seen_on) },
+	{ INT_BSS(gas_address3) },
+	{ INT_CONF(stationary_ap) },
+	{ INT_BSS(ftm_responder) },
+	{ INT_BSS(ftm_initiator) },
+#ifdef CONFIG_FILS
+	{ INT_BSS(fils_dh_group) },
+	{ INT_BSS(dhcp_rapid_commit_proxy) },
+	{ INT_BSS(fils_hlp_wait_time) },
+	{ INT_BSS(dhcp_server_port) },
+	{ INT_BSS(dhcp_relay_port) },
+#endif /* CONFIG_FILS */
+	{ INT_BSS(multicast_to_unicast) },
+	{ INT_BSS(broadcast_deauth) },
+#ifdef CONFIG_DPP
+	{ STR_BSS(dpp_connector) },
+#endif /* CONFIG_DPP */
+};
+
+#undef BSS_MEMBER_SIZE
+#undef CONF_MEMBER_SIZE
+#undef INT_BSS_NAME
+#undef INT_CONF_NAME
+#undef STR_BSS_NAME
+#undef STR_CONF_NAME
+#undef INT_BSS
+#undef INT_CONF
+#undef STR_BSS
+#undef STR_CONF
+#undef FUNC
+
+#define NUM_HOSTAPD_CONFIG_FIELDS ARRAY_SIZE(hostapd_config_fields)
+
+/* hostapd_config_fields[] indexes sorted by field name */
+static u16 hostapd_config_field_idx[NUM_HOSTAPD_CONFIG_FIELDS];
+static int hostapd_config_field_idx_ready = 0;
+
+
+static int hostapd_config_field_cmp(const void *a, const void *b)
+{
+	const u16 *ia = a, *ib = b;
+
+	return os_strcmp(hostapd_config_fields[*ia].name,
+			 hostapd_config_fields[*ib].name);
+}
+
+
+static const struct hostapd_config_field *
+hostapd_config_get_field(const char *name)
+{
+	size_t left, right, mid;
+	const struct hostapd_config_field *field;
+	int res;
+
+	if (!hostapd_config_field_idx_ready) {
+		for (mid = 0; mid < NUM_HOSTAPD_CONFIG_FIELDS; mid++)
+			hostapd_config_field_idx[mid] = mid;
+		qsort(hostapd_config_field_idx, NUM_HOSTAPD_CONFIG_FIELDS,
+		      sizeof(hostapd_config_field_idx[0]),
+		      hostapd_config_field_cmp);
+		hostapd_config_field_idx_ready = 1;
+	}
+
+	left = 0;
+	right = NUM_HOSTAPD_CONFIG_FIELDS;
+	while (left < right) {
+		mid = left + (right - left) / 2;
+		field = &hostapd_config_fields[hostapd_config_field_idx[mid]];
+		res = os_strcmp(name, field->name);
+		if (res == 0)
+			return field;
+		if (res < 0)
+			right = mid;
+		else
+			left = mid + 1;
+	}
+
+	return NULL;
+}
+
+
+static int hostapd_config_set_field(struct hostapd_config *conf,
+				    struct hostapd_bss_config *bss,
+				    const struct hostapd_config_field *field,
+				    char *pos, int line)
+{
+	u8 *base;
+	int val;
+	char **str;
+
+	if (field->type == HOSTAPD_FIELD_FUNC)
+		return field->parser(bss, pos, line) < 0 ? 1 : 0;
+
+	if (field->type == HOSTAPD_FIELD_INT_BSS ||
+	    field->type == HOSTAPD_FIELD_STR_BSS)
+		base = (u8 *) bss;
+	else
+		base = (u8 *) conf;
+
+	if (field->type == HOSTAPD_FIELD_STR_BSS ||
+	    field->type == HOSTAPD_FIELD_STR_CONF) {
+		str = (char **) (base + field->offset);
+		os_free(*str);
+		*str = os_strdup(pos);
+		return 0;
+	}
+
+	val = atoi(pos);
+	switch (field->size) {
+	case 1:
+		*(u8 *) (base + field->offset) = val;
+		break;
+	case 2:
+		*(u16 *) (base + field->offset) = val;
+		break;
+	case 4:
+		*(u32 *) (base + field->offset) = val;
+		break;
+	case 8:
+		*(u64 *) (base + field->offset) = (s64) val;
+		break;
+	default:
+		wpa_printf(MSG_ERROR, "Line %d: unsupported field size for '%s'",
+			   line, field->name);
+		return 1;
+	}
+
+	return 0;
+}
+
+
 static int hostapd_config_fill(struct hostapd_config *conf,
 			       struct hostapd_bss_config *bss,
 			       const char *buf, char *pos, int line)
 {
+	const struct hostapd_config_field *field;
+
+	field = hostapd_config_get_field(buf);
+	if (field)
+		return hostapd_config_set_field(conf, bss, field, pos, line);
+
 	if (os_strcmp(buf, "interface") == 0) {
 		os_strlcpy(conf->bss[0]->iface, pos,
 			   sizeof(conf->bss[0]->iface));
@@ -2089,20 +2501,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->driver = driver;
-	} else if (os_strcmp(buf, "driver_params") == 0) {
-		os_free(conf->driver_params);
-		conf->driver_params = os_strdup(pos);
 	} else if (os_strcmp(buf, "debug") == 0) {
 		wpa_printf(MSG_DEBUG, "Line %d: DEPRECATED: 'debug' configuration variable is not used anymore",
 			   line);
-	} else if (os_strcmp(buf, "logger_syslog_level") == 0) {
-		bss->logger_syslog_level = atoi(pos);
-	} else if (os_strcmp(buf, "logger_stdout_level") == 0) {
-		bss->logger_stdout_level = atoi(pos);
-	} else if (os_strcmp(buf, "logger_syslog") == 0) {
-		bss->logger_syslog = atoi(pos);
-	} else if (os_strcmp(buf, "logger_stdout") == 0) {
-		bss->logger_stdout = atoi(pos);
 	} else if (os_strcmp(buf, "dump_file") == 0) {
 		wpa_printf(MSG_INFO, "Line %d: DEPRECATED: 'dump_file' configuration variable is not used anymore",
 			   line);
@@ -2156,26 +2557,10 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wds_sta") == 0) {
-		bss->wds_sta = atoi(pos);
-	} else if (os_strcmp(buf, "start_disabled") == 0) {
-		bss->start_disabled = atoi(pos);
-	} else if (os_strcmp(buf, "ap_isolate") == 0) {
-		bss->isolate = atoi(pos);
-	} else if (os_strcmp(buf, "ap_max_inactivity") == 0) {
-		bss->ap_max_inactivity = atoi(pos);
-	} else if (os_strcmp(buf, "skip_inactivity_poll") == 0) {
-		bss->skip_inactivity_poll = atoi(pos);
 	} else if (os_strcmp(buf, "country_code") == 0) {
 		os_memcpy(conf->country, pos, 2);
 	} else if (os_strcmp(buf, "country3") == 0) {
 		conf->country[2] = strtol(pos, NULL, 16);
-	} else if (os_strcmp(buf, "ieee80211d") == 0) {
-		conf->ieee80211d = atoi(pos);
-	} else if (os_strcmp(buf, "ieee80211h") == 0) {
-		conf->ieee80211h = atoi(pos);
-	} else if (os_strcmp(buf, "ieee8021x") == 0) {
-		bss->ieee802_1x = atoi(pos);
 	} else if (os_strcmp(buf, "eapol_version") == 0) {
 		int eapol_version = atoi(pos);
 
@@ -2191,41 +2576,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	} else if (os_strcmp(buf, "eap_authenticator") == 0) {
 		bss->eap_server = atoi(pos);
 		wpa_printf(MSG_ERROR, "Line %d: obsolete eap_authenticator used; this has been renamed to eap_server", line);
-	} else if (os_strcmp(buf, "eap_server") == 0) {
-		bss->eap_server = atoi(pos);
 	} else if (os_strcmp(buf, "eap_user_file") == 0) {
 		if (hostapd_config_read_eap_user(pos, bss))
 			return 1;
-	} else if (os_strcmp(buf, "ca_cert") == 0) {
-		os_free(bss->ca_cert);
-		bss->ca_cert = os_strdup(pos);
-	} else if (os_strcmp(buf, "server_cert") == 0) {
-		os_free(bss->server_cert);
-		bss->server_cert = os_strdup(pos);
-	} else if (os_strcmp(buf, "private_key") == 0) {
-		os_free(bss->private_key);
-		bss->private_key = os_strdup(pos);
-	} else if (os_strcmp(buf, "private_key_passwd") == 0) {
-		os_free(bss->private_key_passwd);
-		bss->private_key_passwd = os_strdup(pos);
-	} else if (os_strcmp(buf, "check_crl") == 0) {
-		bss->check_crl = atoi(pos);
-	} else if (os_strcmp(buf, "tls_session_lifetime") == 0) {
-		bss->tls_session_lifetime = atoi(pos);
-	} else if (os_strcmp(buf, "ocsp_stapling_response") == 0) {
-		os_free(bss->ocsp_stapling_response);
-		bss->ocsp_stapling_response = os_strdup(pos);
-	} else if (os_strcmp(buf, "ocsp_stapling_response_multi") == 0) {
-		os_free(bss->ocsp_stapling_response_multi);
-		bss->ocsp_stapling_response_multi = os_strdup(pos);
-	} else if (os_strcmp(buf, "dh_file") == 0) {
-		os_free(bss->dh_file);
-		bss->dh_file = os_strdup(pos);
-	} else if (os_strcmp(buf, "openssl_ciphers") == 0) {
-		os_free(bss->openssl_ciphers);
-		bss->openssl_ciphers = os_strdup(pos);
-	} else if (os_strcmp(buf, "fragment_size") == 0) {
-		bss->fragment_size = atoi(pos);
 #ifdef EAP_SERVER_FAST
 	} else if (os_strcmp(buf, "pac_opaque_encr_key") == 0) {
 		os_free(bss->pac_opaque_encr_key);
@@ -2259,35 +2612,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		} else {
 			bss->eap_fast_a_id_len = idlen / 2;
 		}
-	} else if (os_strcmp(buf, "eap_fast_a_id_info") == 0) {
-		os_free(bss->eap_fast_a_id_info);
-		bss->eap_fast_a_id_info = os_strdup(pos);
-	} else if (os_strcmp(buf, "eap_fast_prov") == 0) {
-		bss->eap_fast_prov = atoi(pos);
-	} else if (os_strcmp(buf, "pac_key_lifetime") == 0) {
-		bss->pac_key_lifetime = atoi(pos);
-	} else if (os_strcmp(buf, "pac_key_refresh_time") == 0) {
-		bss->pac_key_refresh_time = atoi(pos);
 #endif /* EAP_SERVER_FAST */
-#ifdef EAP_SERVER_SIM
-	} else if (os_strcmp(buf, "eap_sim_db") == 0) {
-		os_free(bss->eap_sim_db);
-		bss->eap_sim_db = os_strdup(pos);
-	} else if (os_strcmp(buf, "eap_sim_db_timeout") == 0) {
-		bss->eap_sim_db_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "eap_sim_aka_result_ind") == 0) {
-		bss->eap_sim_aka_result_ind = atoi(pos);
-#endif /* EAP_SERVER_SIM */
-#ifdef EAP_SERVER_TNC
-	} else if (os_strcmp(buf, "tnc") == 0) {
-		bss->tnc = atoi(pos);
-#endif /* EAP_SERVER_TNC */
-#ifdef EAP_SERVER_PWD
-	} else if (os_strcmp(buf, "pwd_group") == 0) {
-		bss->pwd_group = atoi(pos);
-#endif /* EAP_SERVER_PWD */
-	} else if (os_strcmp(buf, "eap_server_erp") == 0) {
-		bss->eap_server_erp = atoi(pos);
 #endif /* EAP_SERVER */
 	} else if (os_strcmp(buf, "eap_message") == 0) {
 		char *term;
@@ -2307,11 +2632,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   (term - bss->eap_req_id_text) - 1);
 			bss->eap_req_id_text_len--;
 		}
-	} else if (os_strcmp(buf, "erp_send_reauth_start") == 0) {
-		bss->erp_send_reauth_start = atoi(pos);
-	} else if (os_strcmp(buf, "erp_domain") == 0) {
-		os_free(bss->erp_domain);
-		bss->erp_domain = os_strdup(pos);
 	} else if (os_strcmp(buf, "wep_key_len_broadcast") == 0) {
 		int val = atoi(pos);
 
@@ -2346,8 +2666,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, bss->eap_reauth_period);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "eapol_key_index_workaround") == 0) {
-		bss->eapol_key_index_workaround = atoi(pos);
 #ifdef CONFIG_IAPP
 	} else if (os_strcmp(buf, "iapp_interface") == 0) {
 		bss->ieee802_11f = 1;
@@ -2360,9 +2678,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "nas_identifier") == 0) {
-		os_free(bss->nas_identifier);
-		bss->nas_identifier = os_strdup(pos);
 #ifndef CONFIG_NO_RADIUS
 	} else if (os_strcmp(buf, "radius_client_addr") == 0) {
 		if (hostapd_parse_ip_addr(pos, &bss->radius->client_addr)) {
@@ -2442,10 +2757,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->radius->acct_server->shared_secret_len = len;
 	} else if (os_strcmp(buf, "radius_retry_primary_interval") == 0) {
 		bss->radius->retry_primary_interval = atoi(pos);
-	} else if (os_strcmp(buf, "radius_acct_interim_interval") == 0) {
-		bss->acct_interim_interval = atoi(pos);
-	} else if (os_strcmp(buf, "radius_request_cui") == 0) {
-		bss->radius_request_cui = atoi(pos);
 	} else if (os_strcmp(buf, "radius_auth_req_attr") == 0) {
 		struct hostapd_radius_attr *attr, *a;
 		attr = hostapd_parse_radius_attr(pos);
@@ -2478,18 +2789,12 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				a = a->next;
 			a->next = attr;
 		}
-	} else if (os_strcmp(buf, "radius_das_port") == 0) {
-		bss->radius_das_port = atoi(pos);
 	} else if (os_strcmp(buf, "radius_das_client") == 0) {
 		if (hostapd_parse_das_client(bss, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid DAS client",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "radius_das_time_window") == 0) {
-		bss->radius_das_time_window = atoi(pos);
-	} else if (os_strcmp(buf, "radius_das_require_event_timestamp") == 0) {
-		bss->radius_das_require_event_timestamp = atoi(pos);
 	} else if (os_strcmp(buf, "radius_das_require_message_authenticator") ==
 		   0) {
 		bss->radius_das_require_message_authenticator = atoi(pos);
@@ -2509,17 +2814,9 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, bss->max_num_sta, MAX_STA_COUNT);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wpa") == 0) {
-		bss->wpa = atoi(pos);
 	} else if (os_strcmp(buf, "wpa_group_rekey") == 0) {
 		bss->wpa_group_rekey = atoi(pos);
 		bss->wpa_group_rekey_set = 1;
-	} else if (os_strcmp(buf, "wpa_strict_rekey") == 0) {
-		bss->wpa_strict_rekey = atoi(pos);
-	} else if (os_strcmp(buf, "wpa_gmk_rekey") == 0) {
-		bss->wpa_gmk_rekey = atoi(pos);
-	} else if (os_strcmp(buf, "wpa_ptk_rekey") == 0) {
-		bss->wpa_ptk_rekey = atoi(pos);
 	} else if (os_strcmp(buf, "wpa_group_update_count") == 0) {
 		char *endp;
 		unsigned long val = strtoul(pos, &endp, 0);
@@ -2613,17 +2910,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   bss->rsn_pairwise, pos);
 			return 1;
 		}
-#ifdef CONFIG_RSN_PREAUTH
-	} else if (os_strcmp(buf, "rsn_preauth") == 0) {
-		bss->rsn_preauth = atoi(pos);
-	} else if (os_strcmp(buf, "rsn_preauth_interfaces") == 0) {
-		os_free(bss->rsn_preauth_interfaces);
-		bss->rsn_preauth_interfaces = os_strdup(pos);
-#endif /* CONFIG_RSN_PREAUTH */
-#ifdef CONFIG_PEERKEY
-	} else if (os_strcmp(buf, "peerkey") == 0) {
-		bss->peerkey = atoi(pos);
-#endif /* CONFIG_PEERKEY */
 #ifdef CONFIG_IEEE80211R_AP
 	} else if (os_strcmp(buf, "mobility_domain") == 0) {
 		if (os_strlen(pos) != 2 * MOBILITY_DOMAIN_ID_LEN ||
@@ -2642,41 +2928,8 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "r0_key_lifetime") == 0) {
-		bss->r0_key_lifetime = atoi(pos);
-	} else if (os_strcmp(buf, "reassociation_deadline") == 0) {
-		bss->reassociation_deadline = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_pos_timeout") == 0) {
-		bss->rkh_pos_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_neg_timeout") == 0) {
-		bss->rkh_neg_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_pull_timeout") == 0) {
-		bss->rkh_pull_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "rkh_pull_retries") == 0) {
-		bss->rkh_pull_retries = atoi(pos);
-	} else if (os_strcmp(buf, "r0kh") == 0) {
-		if (add_r0kh(bss, pos) < 0) {
-			wpa_printf(MSG_DEBUG, "Line %d: Invalid r0kh '%s'",
-				   line, pos);
-			return 1;
-		}
-	} else if (os_strcmp(buf, "r1kh") == 0) {
-		if (add_r1kh(bss, pos) < 0) {
-			wpa_printf(MSG_DEBUG, "Line %d: Invalid r1kh '%s'",
-				   line, pos);
-			return 1;
-		}
-	} else if (os_strcmp(buf, "pmk_r1_push") == 0) {
-		bss->pmk_r1_push = atoi(pos);
-	} else if (os_strcmp(buf, "ft_over_ds") == 0) {
-		bss->ft_over_ds = atoi(pos);
-	} else if (os_strcmp(buf, "ft_psk_generate_local") == 0) {
-		bss->ft_psk_generate_local = atoi(pos);
 #endif /* CONFIG_IEEE80211R_AP */
 #ifndef CONFIG_NO_CTRL_IFACE
-	} else if (os_strcmp(buf, "ctrl_interface") == 0) {
-		os_free(bss->ctrl_interface);
-		bss->ctrl_interface = os_strdup(pos);
 	} else if (os_strcmp(buf, "ctrl_interface_group") == 0) {
 #ifndef CONFIG_NATIVE_WINDOWS
 		struct group *grp;
@@ -2704,19 +2957,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			   bss->ctrl_interface_gid);
 #endif /* CONFIG_NATIVE_WINDOWS */
 #endif /* CONFIG_NO_CTRL_IFACE */
-#ifdef RADIUS_SERVER
-	} else if (os_strcmp(buf, "radius_server_clients") == 0) {
-		os_free(bss->radius_server_clients);
-		bss->radius_server_clients = os_strdup(pos);
-	} else if (os_strcmp(buf, "radius_server_auth_port") == 0) {
-		bss->radius_server_auth_port = atoi(pos);
-	} else if (os_strcmp(buf, "radius_server_acct_port") == 0) {
-		bss->radius_server_acct_port = atoi(pos);
-	} else if (os_strcmp(buf, "radius_server_ipv6") == 0) {
-		bss->radius_server_ipv6 = atoi(pos);
-#endif /* RADIUS_SERVER */
-	} else if (os_strcmp(buf, "use_pae_group_addr") == 0) {
-		bss->use_pae_group_addr = atoi(pos);
 	} else if (os_strcmp(buf, "hw_mode") == 0) {
 		if (os_strcmp(pos, "a") == 0)
 			conf->hw_mode = HOSTAPD_MODE_IEEE80211A;
@@ -2750,8 +2990,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "acs_exclude_dfs") == 0) {
-		conf->acs_exclude_dfs = atoi(pos);
 	} else if (os_strcmp(buf, "channel") == 0) {
 		if (os_strcmp(pos, "acs_survey") == 0) {
 #ifndef CONFIG_ACS
@@ -2897,10 +3135,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			conf->preamble = SHORT_PREAMBLE;
 		else
 			conf->preamble = LONG_PREAMBLE;
-	} else if (os_strcmp(buf, "ignore_broadcast_ssid") == 0) {
-		bss->ignore_broadcast_ssid = atoi(pos);
-	} else if (os_strcmp(buf, "no_probe_resp_if_max_sta") == 0) {
-		bss->no_probe_resp_if_max_sta = atoi(pos);
 	} else if (os_strcmp(buf, "wep_default_key") == 0) {
 		bss->ssid.wep.idx = atoi(pos);
 		if (bss->ssid.wep.idx > 3) {
@@ -2920,10 +3154,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 #ifndef CONFIG_NO_VLAN
-	} else if (os_strcmp(buf, "dynamic_vlan") == 0) {
-		bss->ssid.dynamic_vlan = atoi(pos);
-	} else if (os_strcmp(buf, "per_sta_vif") == 0) {
-		bss->ssid.per_sta_vif = atoi(pos);
 	} else if (os_strcmp(buf, "vlan_file") == 0) {
 		if (hostapd_config_read_vlan_file(bss, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: failed to read VLAN file '%s'",
@@ -2939,16 +3169,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, bss->ssid.vlan_naming);
 			return 1;
 		}
-#ifdef CONFIG_FULL_DYNAMIC_VLAN
-	} else if (os_strcmp(buf, "vlan_tagged_interface") == 0) {
-		os_free(bss->ssid.vlan_tagged_interface);
-		bss->ssid.vlan_tagged_interface = os_strdup(pos);
-#endif /* CONFIG_FULL_DYNAMIC_VLAN */
 #endif /* CONFIG_NO_VLAN */
-	} else if (os_strcmp(buf, "ap_table_max_size") == 0) {
-		conf->ap_table_max_size = atoi(pos);
-	} else if (os_strcmp(buf, "ap_table_expiration_time") == 0) {
-		conf->ap_table_expiration_time = atoi(pos);
 	} else if (os_strncmp(buf, "tx_queue_", 9) == 0) {
 		if (hostapd_config_tx_queue(conf, buf, pos)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid TX queue item",
@@ -2958,8 +3179,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	} else if (os_strcmp(buf, "wme_enabled") == 0 ||
 		   os_strcmp(buf, "wmm_enabled") == 0) {
 		bss->wmm_enabled = atoi(pos);
-	} else if (os_strcmp(buf, "uapsd_advertisement_enabled") == 0) {
-		bss->wmm_uapsd = atoi(pos);
 	} else if (os_strncmp(buf, "wme_ac_", 7) == 0 ||
 		   os_strncmp(buf, "wmm_ac_", 7) == 0) {
 		if (hostapd_config_wmm_ac(conf->wmm_ac_params, buf, pos)) {
@@ -2979,11 +3198,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "use_driver_iface_addr") == 0) {
-		conf->use_driver_iface_addr = atoi(pos);
 #ifdef CONFIG_IEEE80211W
-	} else if (os_strcmp(buf, "ieee80211w") == 0) {
-		bss->ieee80211w = atoi(pos);
 	} else if (os_strcmp(buf, "group_mgmt_cipher") == 0) {
 		if (os_strcmp(pos, "AES-128-CMAC") == 0) {
 			bss->group_mgmt_cipher = WPA_CIPHER_AES_128_CMAC;
@@ -3014,65 +3229,21 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 #endif /* CONFIG_IEEE80211W */
 #ifdef CONFIG_IEEE80211N
-	} else if (os_strcmp(buf, "ieee80211n") == 0) {
-		conf->ieee80211n = atoi(pos);
 	} else if (os_strcmp(buf, "ht_capab") == 0) {
 		if (hostapd_config_ht_capab(conf, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid ht_capab",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "require_ht") == 0) {
-		conf->require_ht = atoi(pos);
-	} else if (os_strcmp(buf, "obss_interval") == 0) {
-		conf->obss_interval = atoi(pos);
 #endif /* CONFIG_IEEE80211N */
 #ifdef CONFIG_IEEE80211AC
-	} else if (os_strcmp(buf, "ieee80211ac") == 0) {
-		conf->ieee80211ac = atoi(pos);
 	} else if (os_strcmp(buf, "vht_capab") == 0) {
 		if (hostapd_config_vht_capab(conf, pos) < 0) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid vht_capab",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "require_vht") == 0) {
-		conf->require_vht = atoi(pos);
-	} else if (os_strcmp(buf, "vht_oper_chwidth") == 0) {
-		conf->vht_oper_chwidth = atoi(pos);
-	} else if (os_strcmp(buf, "vht_oper_centr_freq_seg0_idx") == 0) {
-		conf->vht_oper_centr_freq_seg0_idx = atoi(pos);
-	} else if (os_strcmp(buf, "vht_oper_centr_freq_seg1_idx") == 0) {
-		conf->vht_oper_centr_freq_seg1_idx = atoi(pos);
-	} else if (os_strcmp(buf, "vendor_vht") == 0) {
-		bss->vendor_vht = atoi(pos);
-	} else if (os_strcmp(buf, "use_sta_nsts") == 0) {
-		bss->use_sta_nsts = atoi(pos);
 #endif /* CONFIG_IEEE80211AC */
-#ifdef CONFIG_IEEE80211AX
-	} else if (os_strcmp(buf, "ieee80211ax") == 0) {
-		conf->ieee80211ax = atoi(pos);
-	} else if (os_strcmp(buf, "he_su_beamformer") == 0) {
-		conf->he_phy_capab.he_su_beamformer = atoi(pos);
-	} else if (os_strcmp(buf, "he_su_beamformee") == 0) {
-		conf->he_phy_capab.he_su_beamformee = atoi(pos);
-	} else if (os_strcmp(buf, "he_mu_beamformer") == 0) {
-		conf->he_phy_capab.he_mu_beamformer = atoi(pos);
-	} else if (os_strcmp(buf, "he_bss_color") == 0) {
-		conf->he_op.he_bss_color = atoi(pos);
-	} else if (os_strcmp(buf, "he_default_pe_duration") == 0) {
-		conf->he_op.he_default_pe_duration = atoi(pos);
-	} else if (os_strcmp(buf, "he_twt_required") == 0) {
-		conf->he_op.he_twt_required = atoi(pos);
-	} else if (os_strcmp(buf, "he_rts_threshold") == 0) {
-		conf->he_op.he_rts_threshold = atoi(pos);
-#endif /* CONFIG_IEEE80211AX */
-	} else if (os_strcmp(buf, "max_listen_interval") == 0) {
-		bss->max_listen_interval = atoi(pos);
-	} else if (os_strcmp(buf, "disable_pmksa_caching") == 0) {
-		bss->disable_pmksa_caching = atoi(pos);
-	} else if (os_strcmp(buf, "okc") == 0) {
-		bss->okc = atoi(pos);
 #ifdef CONFIG_WPS
 	} else if (os_strcmp(buf, "wps_state") == 0) {
 		bss->wps_state = atoi(pos);
@@ -3081,18 +3252,11 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wps_independent") == 0) {
-		bss->wps_independent = atoi(pos);
-	} else if (os_strcmp(buf, "ap_setup_locked") == 0) {
-		bss->ap_setup_locked = atoi(pos);
 	} else if (os_strcmp(buf, "uuid") == 0) {
 		if (uuid_str2bin(pos, bss->uuid)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid UUID", line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wps_pin_requests") == 0) {
-		os_free(bss->wps_pin_requests);
-		bss->wps_pin_requests = os_strdup(pos);
 	} else if (os_strcmp(buf, "device_name") == 0) {
 		if (os_strlen(pos) > WPS_DEV_NAME_MAX_LEN) {
 			wpa_printf(MSG_ERROR, "Line %d: Too long "
@@ -3136,20 +3300,12 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	} else if (os_strcmp(buf, "device_type") == 0) {
 		if (wps_dev_type_str2bin(pos, bss->device_type))
 			return 1;
-	} else if (os_strcmp(buf, "config_methods") == 0) {
-		os_free(bss->config_methods);
-		bss->config_methods = os_strdup(pos);
 	} else if (os_strcmp(buf, "os_version") == 0) {
 		if (hexstr2bin(pos, bss->os_version, 4)) {
 			wpa_printf(MSG_ERROR, "Line %d: invalid os_version",
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "ap_pin") == 0) {
-		os_free(bss->ap_pin);
-		bss->ap_pin = os_strdup(pos);
-	} else if (os_strcmp(buf, "skip_cred_build") == 0) {
-		bss->skip_cred_build = atoi(pos);
 	} else if (os_strcmp(buf, "extra_cred") == 0) {
 		os_free(bss->extra_cred);
 		bss->extra_cred = (u8 *) os_readfile(pos, &bss->extra_cred_len);
@@ -3158,8 +3314,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "wps_cred_processing") == 0) {
-		bss->wps_cred_processing = atoi(pos);
 	} else if (os_strcmp(buf, "ap_settings") == 0) {
 		os_free(bss->ap_settings);
 		bss->ap_settings =
@@ -3169,29 +3323,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "upnp_iface") == 0) {
-		os_free(bss->upnp_iface);
-		bss->upnp_iface = os_strdup(pos);
-	} else if (os_strcmp(buf, "friendly_name") == 0) {
-		os_free(bss->friendly_name);
-		bss->friendly_name = os_strdup(pos);
-	} else if (os_strcmp(buf, "manufacturer_url") == 0) {
-		os_free(bss->manufacturer_url);
-		bss->manufacturer_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "model_description") == 0) {
-		os_free(bss->model_description);
-		bss->model_description = os_strdup(pos);
-	} else if (os_strcmp(buf, "model_url") == 0) {
-		os_free(bss->model_url);
-		bss->model_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "upc") == 0) {
-		os_free(bss->upc);
-		bss->upc = os_strdup(pos);
-	} else if (os_strcmp(buf, "pbc_in_m1") == 0) {
-		bss->pbc_in_m1 = atoi(pos);
-	} else if (os_strcmp(buf, "server_id") == 0) {
-		os_free(bss->server_id);
-		bss->server_id = os_strdup(pos);
 #ifdef CONFIG_WPS_NFC
 	} else if (os_strcmp(buf, "wps_nfc_dev_pw_id") == 0) {
 		bss->wps_nfc_dev_pw_id = atoi(pos);
@@ -3228,8 +3359,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		else
 			bss->p2p &= ~P2P_ALLOW_CROSS_CONNECTION;
 #endif /* CONFIG_P2P_MANAGER */
-	} else if (os_strcmp(buf, "disassoc_low_ack") == 0) {
-		bss->disassoc_low_ack = atoi(pos);
 	} else if (os_strcmp(buf, "tdls_prohibit") == 0) {
 		if (atoi(pos))
 			bss->tdls |= TDLS_PROHIBIT;
@@ -3245,8 +3374,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		extern int rsn_testing;
 		rsn_testing = atoi(pos);
 #endif /* CONFIG_RSN_TESTING */
-	} else if (os_strcmp(buf, "time_advertisement") == 0) {
-		bss->time_advertisement = atoi(pos);
 	} else if (os_strcmp(buf, "time_zone") == 0) {
 		size_t tz_len = os_strlen(pos);
 		if (tz_len < 4 || tz_len > 255) {
@@ -3258,15 +3385,7 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		bss->time_zone = os_strdup(pos);
 		if (bss->time_zone == NULL)
 			return 1;
-#ifdef CONFIG_WNM_AP
-	} else if (os_strcmp(buf, "wnm_sleep_mode") == 0) {
-		bss->wnm_sleep_mode = atoi(pos);
-	} else if (os_strcmp(buf, "bss_transition") == 0) {
-		bss->bss_transition = atoi(pos);
-#endif /* CONFIG_WNM_AP */
 #ifdef CONFIG_INTERWORKING
-	} else if (os_strcmp(buf, "interworking") == 0) {
-		bss->interworking = atoi(pos);
 	} else if (os_strcmp(buf, "access_network_type") == 0) {
 		bss->access_network_type = atoi(pos);
 		if (bss->access_network_type < 0 ||
@@ -3276,14 +3395,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "internet") == 0) {
-		bss->internet = atoi(pos);
-	} else if (os_strcmp(buf, "asra") == 0) {
-		bss->asra = atoi(pos);
-	} else if (os_strcmp(buf, "esr") == 0) {
-		bss->esr = atoi(pos);
-	} else if (os_strcmp(buf, "uesa") == 0) {
-		bss->uesa = atoi(pos);
 	} else if (os_strcmp(buf, "venue_group") == 0) {
 		bss->venue_group = atoi(pos);
 		bss->venue_info_set = 1;
@@ -3295,12 +3406,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			wpa_printf(MSG_ERROR, "Line %d: invalid hessid", line);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "roaming_consortium") == 0) {
-		if (parse_roaming_consortium(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "venue_name") == 0) {
-		if (parse_venue_name(bss, pos, line) < 0)
-			return 1;
 	} else if (os_strcmp(buf, "network_auth_type") == 0) {
 		u8 auth_type;
 		u16 redirect_url_len;
@@ -3369,15 +3474,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		os_free(bss->domain_name);
 		bss->domain_name = domain_list;
 		bss->domain_name_len = domain_list_len;
-	} else if (os_strcmp(buf, "anqp_3gpp_cell_net") == 0) {
-		if (parse_3gpp_cell_net(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "nai_realm") == 0) {
-		if (parse_nai_realm(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "anqp_elem") == 0) {
-		if (parse_anqp_elem(bss, pos, line) < 0)
-			return 1;
 	} else if (os_strcmp(buf, "gas_frag_limit") == 0) {
 		int val = atoi(pos);
 
@@ -3388,40 +3484,8 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		bss->gas_frag_limit = val;
-	} else if (os_strcmp(buf, "gas_comeback_delay") == 0) {
-		bss->gas_comeback_delay = atoi(pos);
-	} else if (os_strcmp(buf, "qos_map_set") == 0) {
-		if (parse_qos_map_set(bss, pos, line) < 0)
-			return 1;
 #endif /* CONFIG_INTERWORKING */
-#ifdef CONFIG_RADIUS_TEST
-	} else if (os_strcmp(buf, "dump_msk_file") == 0) {
-		os_free(bss->dump_msk_file);
-		bss->dump_msk_file = os_strdup(pos);
-#endif /* CONFIG_RADIUS_TEST */
-#ifdef CONFIG_PROXYARP
-	} else if (os_strcmp(buf, "proxy_arp") == 0) {
-		bss->proxy_arp = atoi(pos);
-#endif /* CONFIG_PROXYARP */
 #ifdef CONFIG_HS20
-	} else if (os_strcmp(buf, "hs20") == 0) {
-		bss->hs20 = atoi(pos);
-	} else if (os_strcmp(buf, "disable_dgaf") == 0) {
-		bss->disable_dgaf = atoi(pos);
-	} else if (os_strcmp(buf, "na_mcast_to_ucast") == 0) {
-		bss->na_mcast_to_ucast = atoi(pos);
-	} else if (os_strcmp(buf, "osen") == 0) {
-		bss->osen = atoi(pos);
-	} else if (os_strcmp(buf, "anqp_domain_id") == 0) {
-		bss->anqp_domain_id = atoi(pos);
-	} else if (os_strcmp(buf, "hs20_deauth_req_timeout") == 0) {
-		bss->hs20_deauth_req_timeout = atoi(pos);
-	} else if (os_strcmp(buf, "hs20_oper_friendly_name") == 0) {
-		if (hs20_parse_oper_friendly_name(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "hs20_wan_metrics") == 0) {
-		if (hs20_parse_wan_metrics(bss, pos, line) < 0)
-			return 1;
 	} else if (os_strcmp(buf, "hs20_conn_capab") == 0) {
 		if (hs20_parse_conn_capab(bss, pos, line) < 0) {
 			return 1;
@@ -3456,38 +3520,8 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "osu_ssid") == 0) {
-		if (hs20_parse_osu_ssid(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "osu_server_uri") == 0) {
-		if (hs20_parse_osu_server_uri(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "osu_friendly_name") == 0) {
-		if (hs20_parse_osu_friendly_name(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "osu_nai") == 0) {
-		if (hs20_parse_osu_nai(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "osu_method_list") == 0) {
-		if (hs20_parse_osu_method_list(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "osu_icon") == 0) {
-		if (hs20_parse_osu_icon(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "osu_service_desc") == 0) {
-		if (hs20_parse_osu_service_desc(bss, pos, line) < 0)
-			return 1;
-	} else if (os_strcmp(buf, "subscr_remediation_url") == 0) {
-		os_free(bss->subscr_remediation_url);
-		bss->subscr_remediation_url = os_strdup(pos);
-	} else if (os_strcmp(buf, "subscr_remediation_method") == 0) {
-		bss->subscr_remediation_method = atoi(pos);
 #endif /* CONFIG_HS20 */
 #ifdef CONFIG_MBO
-	} else if (os_strcmp(buf, "mbo") == 0) {
-		bss->mbo_enabled = atoi(pos);
-	} else if (os_strcmp(buf, "mbo_cell_data_conn_pref") == 0) {
-		bss->mbo_cell_data_conn_pref = atoi(pos);
 	} else if (os_strcmp(buf, "oce") == 0) {
 		bss->oce = atoi(pos);
 #endif /* CONFIG_MBO */
@@ -3509,8 +3543,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	PARSE_TEST_PROBABILITY(ignore_assoc_probability)
 	PARSE_TEST_PROBABILITY(ignore_reassoc_probability)
 	PARSE_TEST_PROBABILITY(corrupt_gtk_rekey_mic_probability)
-	} else if (os_strcmp(buf, "ecsa_ie_only") == 0) {
-		conf->ecsa_ie_only = atoi(pos);
 	} else if (os_strcmp(buf, "bss_load_test") == 0) {
 		WPA_PUT_LE16(bss->bss_load_test, atoi(pos));
 		pos = os_strchr(pos, ':');
@@ -3565,8 +3597,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	} else if (os_strcmp(buf, "assocresp_elements") == 0) {
 		if (parse_wpabuf_hex(line, buf, &bss->assocresp_elements, pos))
 			return 1;
-	} else if (os_strcmp(buf, "sae_anti_clogging_threshold") == 0) {
-		bss->sae_anti_clogging_threshold = atoi(pos);
 	} else if (os_strcmp(buf, "sae_groups") == 0) {
 		if (hostapd_parse_intlist(&bss->sae_groups, pos)) {
 			wpa_printf(MSG_ERROR,
@@ -3582,11 +3612,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 			return 1;
 		}
 		conf->local_pwr_constraint = val;
-	} else if (os_strcmp(buf, "spectrum_mgmt_required") == 0) {
-		conf->spectrum_mgmt_required = atoi(pos);
-	} else if (os_strcmp(buf, "wowlan_triggers") == 0) {
-		os_free(bss->wowlan_triggers);
-		bss->wowlan_triggers = os_strdup(pos);
 #ifdef CONFIG_FST
 	} else if (os_strcmp(buf, "fst_group_id") == 0) {
 		size_t len = os_strlen(pos);
@@ -3646,16 +3671,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 		}
 		conf->fst_cfg.llt = (u32) val;
 #endif /* CONFIG_FST */
-	} else if (os_strcmp(buf, "track_sta_max_num") == 0) {
-		conf->track_sta_max_num = atoi(pos);
-	} else if (os_strcmp(buf, "track_sta_max_age") == 0) {
-		conf->track_sta_max_age = atoi(pos);
-	} else if (os_strcmp(buf, "no_probe_resp_if_seen_on") == 0) {
-		os_free(bss->no_probe_resp_if_seen_on);
-		bss->no_probe_resp_if_seen_on = os_strdup(pos);
-	} else if (os_strcmp(buf, "no_auth_if_seen_on") == 0) {
-		os_free(bss->no_auth_if_seen_on);
-		bss->no_auth_if_seen_on = os_strdup(pos);
 	} else if (os_strcmp(buf, "lci") == 0) {
 		wpabuf_free(conf->lci);
 		conf->lci = wpabuf_parse_bin(pos);
@@ -3680,14 +3695,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				WLAN_RRM_CAPS_BEACON_REPORT_PASSIVE |
 				WLAN_RRM_CAPS_BEACON_REPORT_ACTIVE |
 				WLAN_RRM_CAPS_BEACON_REPORT_TABLE;
-	} else if (os_strcmp(buf, "gas_address3") == 0) {
-		bss->gas_address3 = atoi(pos);
-	} else if (os_strcmp(buf, "stationary_ap") == 0) {
-		conf->stationary_ap = atoi(pos);
-	} else if (os_strcmp(buf, "ftm_responder") == 0) {
-		bss->ftm_responder = atoi(pos);
-	} else if (os_strcmp(buf, "ftm_initiator") == 0) {
-		bss->ftm_initiator = atoi(pos);
 #ifdef CONFIG_FILS
 	} else if (os_strcmp(buf, "fils_cache_id") == 0) {
 		if (hexstr2bin(pos, bss->fils_cache_id, FILS_CACHE_ID_LEN)) {
@@ -3700,8 +3707,6 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 	} else if (os_strcmp(buf, "fils_realm") == 0) {
 		if (parse_fils_realm(bss, pos) < 0)
 			return 1;
-	} else if (os_strcmp(buf, "fils_dh_group") == 0) {
-		bss->fils_dh_group = atoi(pos);
 	} else if (os_strcmp(buf, "dhcp_server") == 0) {
 		if (hostapd_parse_ip_addr(pos, &bss->dhcp_server)) {
 			wpa_printf(MSG_ERROR,
@@ -3709,23 +3714,8 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 				   line, pos);
 			return 1;
 		}
-	} else if (os_strcmp(buf, "dhcp_rapid_commit_proxy") == 0) {
-		bss->dhcp_rapid_commit_proxy = atoi(pos);
-	} else if (os_strcmp(buf, "fils_hlp_wait_time") == 0) {
-		bss->fils_hlp_wait_time = atoi(pos);
-	} else if (os_strcmp(buf, "dhcp_server_port") == 0) {
-		bss->dhcp_server_port = atoi(pos);
-	} else if (os_strcmp(buf, "dhcp_relay_port") == 0) {
-		bss->dhcp_relay_port = atoi(pos);
 #endif /* CONFIG_FILS */
-	} else if (os_strcmp(buf, "multicast_to_unicast") == 0) {
-		bss->multicast_to_unicast = atoi(pos);
-	} else if (os_strcmp(buf, "broadcast_deauth") == 0) {
-		bss->broadcast_deauth = atoi(pos);
 #ifdef CONFIG_DPP
-	} else if (os_strcmp(buf, "dpp_connector") == 0) {
-		os_free(bss->dpp_connector);
-		bss->dpp_connector = os_strdup(pos);
 	} else if (os_strcmp(buf, "dpp_netaccesskey") == 0) {
 		if (parse_wpabuf_hex(line, buf, &bss->dpp_netaccesskey, pos))
 			return 1;
@@ -3748,6 +3738,47 @@ static int hostapd_config_fill(struct hostapd_config *conf,
 }
 
 
+/* Configuration fields with a value that refers to a file */
+static const char * const hostapd_config_file_fields[] = {
+	"accept_mac_file", "deny_mac_file", "wpa_psk_file", "eap_user_file",
+	"vlan_file", "ca_cert", "server_cert", "private_key", "dh_file",
+	"radius_server_clients", "ocsp_stapling_response",
+	"ocsp_stapling_response_multi", NULL
+};
+
+
+static int hostapd_config_record_line(struct hostapd_bss_config *bss,
+				      const char *field, const char *value)
+{
+#ifndef CONFIG_NATIVE_WINDOWS
+	char buf[4096 + 100];
+	struct stat st;
+	int i, res;
+
+	/*
+	 * Include file information so that changes in the referenced files
+	 * are noticed on reload even if the configuration line itself did not
+	 * change.
+	 */
+	for (i = 0; hostapd_config_file_fields[i]; i++) {
+		if (os_strcmp(field, hostapd_config_file_fields[i]) != 0)
+			continue;
+		if (stat(value, &st) < 0)
+			break;
+		res = os_snprintf(buf, sizeof(buf), "%s|%llu|%llu|%llu", value,
+				  (unsigned long long) st.st_mtime,
+				  (unsigned long long) st.st_size,
+				  (unsigned long long) st.st_ino);
+		if (os_snprintf_error(sizeof(buf), res))
+			break;
+		return hostapd_config_add_line(bss, field, buf);
+	}
+#endif /* CONFIG_NATIVE_WINDOWS */
+
+	return hostapd_config_add_line(bss, field, value);
+}
+
+
 /**
  * hostapd_config_read - Read and parse a configuration file
  * @fname: Configuration file name (including path, if needed)
@@ -3814,7 +3845,13 @@ struct hostapd_config * hostapd_config_read(const char *fname)
 		}
 		*pos = '\0';
 		pos++;
+		if (os_strcmp(buf, "bss") != 0 &&
+		    hostapd_config_record_line(bss, buf, pos) < 0)
+			errors++;
 		errors += hostapd_config_fill(conf, bss, buf, pos, line);
+		if (os_strcmp(buf, "bss") == 0 && conf->last_bss != bss &&
+		    hostapd_config_record_line(conf->last_bss, buf, pos) < 0)
+			errors++;
 	}
 
 	fclose(f);
@@ -3845,6 +3882,15 @@ int hostapd_set_iface(struct hostapd_config *conf,
 	int errors;
 	size_t i;
 
+	/*
+	 * The configuration no longer matches the file, so a reload needs to
+	 * reconfigure the interface completely.
+	 */
+	for (i = 0; i < conf->num_bss; i++) {
+		wpabuf_free(conf->bss[i]->config_lines);
+		conf->bss[i]->config_lines = NULL;
+	}
+
 	errors = hostapd_config_fill(conf, bss, field, value, 0);
 	if (errors) {
 		wpa_printf(MSG_INFO, "Failed to set configuration field '%s' "
@@ -25,6 +25,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/mem_pool.h"
 #include "utils/module_tests.h"
 #include "common/version.h"
 #include "common/ieee802_11_defs.h"
@@ -34,6 +35,7 @@
 #include "eapol_auth/eapol_auth_sm.h"
 #include "radius/radius_client.h"
 #include "radius/radius_server.h"
+#include "eap_server/eap_sim_db.h"
 #include "l2_packet/l2_packet.h"
 #include "ap/hostapd.h"
 #include "ap/ap_config.h"
@@ -60,6 +62,9 @@
 
 #define HOSTAPD_CLI_DUP_VALUE_MAX_LEN 256
 
+/* Maximum length of an ALL_STA reply; fits in a single UDP datagram */
+#define HOSTAPD_CTRL_IFACE_ALL_STA_MAX_LEN 65000
+
 #ifdef CONFIG_CTRL_IFACE_UDP
 #define COOKIE_LEN 8
 static unsigned char cookie[COOKIE_LEN];
@@ -75,11 +80,89 @@ static void hostapd_ctrl_iface_send(struct hostapd_data *hapd, int level,
 				    const char *buf, size_t len);
 
 
+/* Retry interval for monitors that had their receive queue full */
+#define HOSTAPD_CTRL_IFACE_EVENT_RETRY_MS 20
+
+static void hostapd_ctrl_iface_event_retry(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+
+	if (!hapd->ctrl_events || hapd->ctrl_sock < 0)
+		return;
+	if (ctrl_iface_event_flush(hapd->ctrl_sock, &hapd->ctrl_dst,
+				   hapd->ctrl_events) > 0 &&
+	    !eloop_is_timeout_registered(hostapd_ctrl_iface_event_retry,
+					 hapd, NULL))
+		eloop_register_timeout(0,
+				       HOSTAPD_CTRL_IFACE_EVENT_RETRY_MS * 1000,
+				       hostapd_ctrl_iface_event_retry,
+				       hapd, NULL);
+}
+
+
+static void hostapd_global_ctrl_iface_event_retry(void *eloop_ctx,
+						  void *timeout_ctx)
+{
+	struct hapd_interfaces *interfaces = eloop_ctx;
+
+	if (!interfaces->global_ctrl_events ||
+	    interfaces->global_ctrl_sock < 0)
+		return;
+	if (ctrl_iface_event_flush(interfaces->global_ctrl_sock,
+				   &interfaces->global_ctrl_dst,
+				   interfaces->global_ctrl_events) > 0 &&
+	    !eloop_is_timeout_registered(
+		    hostapd_global_ctrl_iface_event_retry, interfaces, NULL))
+		eloop_register_timeout(0,
+				       HOSTAPD_CTRL_IFACE_EVENT_RETRY_MS * 1000,
+				       hostapd_global_ctrl_iface_event_retry,
+				       interfaces, NULL);
+}
+
+
+static struct ctrl_iface_event_ring *
+hostapd_ctrl_iface_events(struct ctrl_iface_event_ring **ring)
+{
+	if (*ring)
+		return *ring;
+
+	*ring = os_zalloc(sizeof(**ring));
+	if (*ring &&
+	    ctrl_iface_event_ring_init(*ring, CTRL_IFACE_EVENT_RING_SIZE) < 0) {
+		os_free(*ring);
+		*ring = NULL;
+	}
+	return *ring;
+}
+
+
+static void hostapd_ctrl_iface_events_free(struct ctrl_iface_event_ring **ring)
+{
+	if (!*ring)
+		return;
+	ctrl_iface_event_ring_deinit(*ring);
+	os_free(*ring);
+	*ring = NULL;
+}
+
+
 static int hostapd_ctrl_iface_attach(struct hostapd_data *hapd,
 				     struct sockaddr_storage *from,
-				     socklen_t fromlen)
+				     socklen_t fromlen, const char *params)
 {
-	return ctrl_iface_attach(&hapd->ctrl_dst, from, fromlen);
+	struct ctrl_iface_event_ring *ring;
+
+	ring = hostapd_ctrl_iface_events(&hapd->ctrl_events);
+	if (!ring ||
+	    ctrl_iface_event_attach(&hapd->ctrl_dst, ring, from, fromlen,
+				    params) < 0)
+		return -1;
+	/* Deliver buffered events (resume=<seq>) after the response */
+	if (!eloop_is_timeout_registered(hostapd_ctrl_iface_event_retry,
+					 hapd, NULL))
+		eloop_register_timeout(0, 0, hostapd_ctrl_iface_event_retry,
+				       hapd, NULL);
+	return 0;
 }
 
 
@@ -87,7 +170,8 @@ static int hostapd_ctrl_iface_detach(struct hostapd_data *hapd,
 				     struct sockaddr_storage *from,
 				     socklen_t fromlen)
 {
-	return ctrl_iface_detach(&hapd->ctrl_dst, from, fromlen);
+	return ctrl_iface_event_detach(&hapd->ctrl_dst, hapd->ctrl_events,
+				       from, fromlen);
 }
 
 
@@ -100,6 +184,17 @@ static int hostapd_ctrl_iface_level(struct hostapd_data *hapd,
 }
 
 
+static int
+hostapd_ctrl_iface_events_status(struct dl_list *ctrl_dst,
+				 struct ctrl_iface_event_ring **ring,
+				 char *buf, size_t buflen)
+{
+	if (!hostapd_ctrl_iface_events(ring))
+		return -1;
+	return ctrl_iface_event_status(ctrl_dst, *ring, buf, buflen);
+}
+
+
 static int hostapd_ctrl_iface_new_sta(struct hostapd_data *hapd,
 				      const char *txtaddr)
 {
@@ -2354,6 +2449,69 @@ static int hostapd_ctrl_iface_remove_neighbor(struct hostapd_data *hapd,
 }
 
 
+/*
+ * Load neighbor database entries from a file with one entry per line in the
+ * SET_NEIGHBOR command format. Empty lines and lines starting with '#' are
+ * ignored. Entries that were added before a failing line are kept and the
+ * failing line is reported as "FAIL line=<n>".
+ */
+static int hostapd_ctrl_iface_load_neighbors(struct hostapd_data *hapd,
+					     const char *fname, char *reply,
+					     size_t reply_size)
+{
+	FILE *f;
+	char buf[2048], *pos;
+	int line = 0, count = 0, ret = 0;
+
+	f = fopen(fname, "r");
+	if (!f) {
+		wpa_printf(MSG_ERROR,
+			   "CTRL: LOAD_NEIGHBORS: Could not open '%s'", fname);
+		return -1;
+	}
+
+	while (fgets(buf, sizeof(buf), f)) {
+		line++;
+		pos = os_strchr(buf, '\n');
+		if (pos) {
+			*pos = '\0';
+		} else if (!feof(f)) {
+			wpa_printf(MSG_ERROR,
+				   "CTRL: LOAD_NEIGHBORS: Too long line %d in '%s'",
+				   line, fname);
+			ret = -1;
+			break;
+		}
+		pos = buf;
+		while (*pos == ' ' || *pos == '\t')
+			pos++;
+		if (*pos == '\0' || *pos == '#')
+			continue;
+
+		if (hostapd_ctrl_iface_set_neighbor(hapd, pos) < 0) {
+			wpa_printf(MSG_ERROR,
+				   "CTRL: LOAD_NEIGHBORS: Invalid entry on line %d in '%s'",
+				   line, fname);
+			ret = -1;
+			break;
+		}
+		count++;
+	}
+
+	fclose(f);
+
+	wpa_printf(MSG_DEBUG, "CTRL: LOAD_NEIGHBORS: Added %d entries from '%s'",
+		   count, fname);
+	if (ret < 0) {
+		ret = os_snprintf(reply, reply_size, "FAIL line=%d\n", line);
+		if (os_snprintf_error(reply_size, ret))
+			return -1;
+		return ret;
+	}
+	return 0;
+}
+
+
 static int hostapd_ctrl_driver_flags(struct hostapd_iface *iface, char *buf,
 				     size_t buflen)
 {
@@ -2399,6 +2557,18 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_MEM_POOL
+	} else if (os_strcmp(buf, "MEM_POOL_STATS") == 0) {
+		reply_len = mem_pool_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "MEM_POOL_STATS RESET") == 0) {
+		mem_pool_stats_reset();
+#endif /* CONFIG_MEM_POOL */
 	} else if (os_strcmp(buf, "STATUS") == 0) {
 		reply_len = hostapd_ctrl_iface_status(hapd, reply,
 						      reply_size);
@@ -2433,6 +2603,17 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 				reply_len += res;
 		}
 #endif /* CONFIG_NO_RADIUS */
+#if defined(EAP_SERVER_SIM) || defined(EAP_SERVER_AKA)
+		if (reply_len >= 0) {
+			res = eap_sim_db_get_mib(hapd->eap_sim_db_priv,
+						 reply + reply_len,
+						 reply_size - reply_len);
+			if (res < 0)
+				reply_len = -1;
+			else
+				reply_len += res;
+		}
+#endif /* EAP_SERVER_SIM || EAP_SERVER_AKA */
 	} else if (os_strncmp(buf, "MIB ", 4) == 0) {
 		reply_len = hostapd_ctrl_iface_mib(hapd, reply, reply_size,
 						   buf + 4);
@@ -2445,9 +2626,21 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "STA-NEXT ", 9) == 0) {
 		reply_len = hostapd_ctrl_iface_sta_next(hapd, buf + 9, reply,
 							reply_size);
+	} else if (os_strcmp(buf, "ALL_STA") == 0) {
+		reply_len = hostapd_ctrl_iface_all_sta(hapd, NULL, reply,
+						       reply_size);
+	} else if (os_strncmp(buf, "ALL_STA ", 8) == 0) {
+		reply_len = hostapd_ctrl_iface_all_sta(hapd, buf + 8, reply,
+						       reply_size);
 	} else if (os_strcmp(buf, "ATTACH") == 0) {
-		if (hostapd_ctrl_iface_attach(hapd, from, fromlen))
+		if (hostapd_ctrl_iface_attach(hapd, from, fromlen, NULL))
 			reply_len = -1;
+	} else if (os_strncmp(buf, "ATTACH ", 7) == 0) {
+		if (hostapd_ctrl_iface_attach(hapd, from, fromlen, buf + 7))
+			reply_len = -1;
+	} else if (os_strcmp(buf, "EVENTS_STATUS") == 0) {
+		reply_len = hostapd_ctrl_iface_events_status(
+			&hapd->ctrl_dst, &hapd->ctrl_events, reply, reply_size);
 	} else if (os_strcmp(buf, "DETACH") == 0) {
 		if (hostapd_ctrl_iface_detach(hapd, from, fromlen))
 			reply_len = -1;
@@ -2643,6 +2836,13 @@ static int hostapd_ctrl_iface_receive_process(struct hostapd_data *hapd,
 	} else if (os_strncmp(buf, "REMOVE_NEIGHBOR ", 16) == 0) {
 		if (hostapd_ctrl_iface_remove_neighbor(hapd, buf + 16))
 			reply_len = -1;
+	} else if (os_strncmp(buf, "LOAD_NEIGHBORS ", 15) == 0) {
+		res = hostapd_ctrl_iface_load_neighbors(hapd, buf + 15, reply,
+							reply_size);
+		if (res < 0)
+			reply_len = -1;
+		else if (res > 0)
+			reply_len = res;
 	} else if (os_strncmp(buf, "REQ_LCI ", 8) == 0) {
 		if (hostapd_ctrl_iface_req_lci(hapd, buf + 8))
 			reply_len = -1;
@@ -2744,7 +2944,7 @@ static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 	struct sockaddr_storage from;
 	socklen_t fromlen = sizeof(from);
 	char *reply, *pos = buf;
-	const int reply_size = 4096;
+	int reply_size = 4096;
 	int reply_len;
 	int level = MSG_DEBUG;
 #ifdef CONFIG_CTRL_IFACE_UDP
@@ -2803,6 +3003,17 @@ static void hostapd_ctrl_iface_receive(int sock, void *eloop_ctx,
 		level = MSG_EXCESSIVE;
 	wpa_hexdump_ascii(level, "RX ctrl_iface", pos, res);
 
+	if (os_strncmp(pos, "ALL_STA", 7) == 0) {
+		char *tmp;
+
+		/* Allow replies larger than the default buffer (max_len=) */
+		tmp = os_realloc(reply, HOSTAPD_CTRL_IFACE_ALL_STA_MAX_LEN);
+		if (tmp) {
+			reply = tmp;
+			reply_size = HOSTAPD_CTRL_IFACE_ALL_STA_MAX_LEN;
+		}
+	}
+
 	reply_len = hostapd_ctrl_iface_receive_process(hapd, pos,
 						       reply, reply_size,
 						       &from, fromlen);
@@ -3139,6 +3350,8 @@ void hostapd_ctrl_iface_deinit(struct hostapd_data *hapd)
 	dl_list_for_each_safe(dst, prev, &hapd->ctrl_dst, struct wpa_ctrl_dst,
 			      list)
 		os_free(dst);
+	eloop_cancel_timeout(hostapd_ctrl_iface_event_retry, hapd, NULL);
+	hostapd_ctrl_iface_events_free(&hapd->ctrl_events);
 
 #ifdef CONFIG_TESTING_OPTIONS
 	l2_packet_deinit(hapd->l2_test);
@@ -3171,9 +3384,22 @@ static int hostapd_ctrl_iface_remove(struct hapd_interfaces *interfaces,
 
 static int hostapd_global_ctrl_iface_attach(struct hapd_interfaces *interfaces,
 					    struct sockaddr_storage *from,
-					    socklen_t fromlen)
+					    socklen_t fromlen,
+					    const char *params)
 {
-	return ctrl_iface_attach(&interfaces->global_ctrl_dst, from, fromlen);
+	struct ctrl_iface_event_ring *ring;
+
+	ring = hostapd_ctrl_iface_events(&interfaces->global_ctrl_events);
+	if (!ring ||
+	    ctrl_iface_event_attach(&interfaces->global_ctrl_dst, ring,
+				    from, fromlen, params) < 0)
+		return -1;
+	if (!eloop_is_timeout_registered(hostapd_global_ctrl_iface_event_retry,
+					 interfaces, NULL))
+		eloop_register_timeout(0, 0,
+				       hostapd_global_ctrl_iface_event_retry,
+				       interfaces, NULL);
+	return 0;
 }
 
 
@@ -3181,7 +3407,19 @@ static int hostapd_global_ctrl_iface_detach(struct hapd_interfaces *interfaces,
 					    struct sockaddr_storage *from,
 					    socklen_t fromlen)
 {
-	return ctrl_iface_detach(&interfaces->global_ctrl_dst, from, fromlen);
+	return ctrl_iface_event_detach(&interfaces->global_ctrl_dst,
+				       interfaces->global_ctrl_events,
+				       from, fromlen);
+}
+
+
+static int
+hostapd_global_ctrl_iface_events_status(struct hapd_interfaces *interfaces,
+					char *buf, size_t buflen)
+{
+	return hostapd_ctrl_iface_events_status(&interfaces->global_ctrl_dst,
+						&interfaces->global_ctrl_events,
+						buf, buflen);
 }
 
 
@@ -3533,6 +3771,18 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_MEM_POOL
+	} else if (os_strcmp(buf, "MEM_POOL_STATS") == 0) {
+		reply_len = mem_pool_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "MEM_POOL_STATS RESET") == 0) {
+		mem_pool_stats_reset();
+#endif /* CONFIG_MEM_POOL */
 	} else if (os_strcmp(buf, "FLUSH") == 0) {
 		hostapd_ctrl_iface_flush(interfaces);
 	} else if (os_strncmp(buf, "ADD ", 4) == 0) {
@@ -3543,8 +3793,15 @@ static void hostapd_global_ctrl_iface_receive(int sock, void *eloop_ctx,
 			reply_len = -1;
 	} else if (os_strcmp(buf, "ATTACH") == 0) {
 		if (hostapd_global_ctrl_iface_attach(interfaces, &from,
-						     fromlen))
+						     fromlen, NULL))
 			reply_len = -1;
+	} else if (os_strncmp(buf, "ATTACH ", 7) == 0) {
+		if (hostapd_global_ctrl_iface_attach(interfaces, &from,
+						     fromlen, buf + 7))
+			reply_len = -1;
+	} else if (os_strcmp(buf, "EVENTS_STATUS") == 0) {
+		reply_len = hostapd_global_ctrl_iface_events_status(
+			interfaces, reply, reply_size);
 	} else if (os_strcmp(buf, "DETACH") == 0) {
 		if (hostapd_global_ctrl_iface_detach(interfaces, &from,
 			fromlen))
@@ -3856,6 +4113,9 @@ void hostapd_global_ctrl_iface_deinit(struct hapd_interfaces *interfaces)
 	dl_list_for_each_safe(dst, prev, &interfaces->global_ctrl_dst,
 			      struct wpa_ctrl_dst, list)
 		os_free(dst);
+	eloop_cancel_timeout(hostapd_global_ctrl_iface_event_retry, interfaces,
+			     NULL);
+	hostapd_ctrl_iface_events_free(&interfaces->global_ctrl_events);
 }
 
 
@@ -3863,62 +4123,36 @@ static void hostapd_ctrl_iface_send(struct hostapd_data *hapd, int level,
 				    enum wpa_msg_type type,
 				    const char *buf, size_t len)
 {
-	struct wpa_ctrl_dst *dst, *next;
-	struct dl_list *ctrl_dst;
-	struct msghdr msg;
-	int idx;
-	struct iovec io[2];
-	char levelstr[10];
-	int s;
+	struct hapd_interfaces *interfaces = hapd->iface->interfaces;
+	struct ctrl_iface_event_ring *ring;
 
 	if (type != WPA_MSG_ONLY_GLOBAL) {
-		s = hapd->ctrl_sock;
-		ctrl_dst = &hapd->ctrl_dst;
+		if (hapd->ctrl_sock < 0 ||
+		    !ctrl_iface_event_wanted(&hapd->ctrl_dst, hapd->ctrl_events,
+					     level))
+			return;
+		ring = hostapd_ctrl_iface_events(&hapd->ctrl_events);
+		if (!ring)
+			return;
+		ctrl_iface_event_add(ring, level, buf, len);
+		/*
+		 * Deliver immediately also when a retry is pending for a
+		 * monitor that does not keep up so that the other monitors
+		 * are not delayed.
+		 */
+		hostapd_ctrl_iface_event_retry(hapd, NULL);
 	} else {
-		s = hapd->iface->interfaces->global_ctrl_sock;
-		ctrl_dst = &hapd->iface->interfaces->global_ctrl_dst;
-	}
-
-	if (s < 0 || dl_list_empty(ctrl_dst))
-		return;
-
-	os_snprintf(levelstr, sizeof(levelstr), "<%d>", level);
-	io[0].iov_base = levelstr;
-	io[0].iov_len = os_strlen(levelstr);
-	io[1].iov_base = (char *) buf;
-	io[1].iov_len = len;
-	os_memset(&msg, 0, sizeof(msg));
-	msg.msg_iov = io;
-	msg.msg_iovlen = 2;
-
-	idx = 0;
-	dl_list_for_each_safe(dst, next, ctrl_dst, struct wpa_ctrl_dst, list) {
-		if (level >= dst->debug_level) {
-			sockaddr_print(MSG_DEBUG, "CTRL_IFACE monitor send",
-				       &dst->addr, dst->addrlen);
-			msg.msg_name = &dst->addr;
-			msg.msg_namelen = dst->addrlen;
-			if (sendmsg(s, &msg, 0) < 0) {
-				int _errno = errno;
-				wpa_printf(MSG_INFO, "CTRL_IFACE monitor[%d]: "
-					   "%d - %s",
-					   idx, errno, strerror(errno));
-				dst->errors++;
-				if (dst->errors > 10 || _errno == ENOENT) {
-					if (type != WPA_MSG_ONLY_GLOBAL)
-						hostapd_ctrl_iface_detach(
-							hapd, &dst->addr,
-							dst->addrlen);
-					else
-						hostapd_global_ctrl_iface_detach(
-							hapd->iface->interfaces,
-							&dst->addr,
-							dst->addrlen);
-				}
-			} else
-				dst->errors = 0;
-		}
-		idx++;
+		if (interfaces->global_ctrl_sock < 0 ||
+		    !ctrl_iface_event_wanted(&interfaces->global_ctrl_dst,
+					     interfaces->global_ctrl_events,
+					     level))
+			return;
+		ring = hostapd_ctrl_iface_events(
+			&interfaces->global_ctrl_events);
+		if (!ring)
+			return;
+		ctrl_iface_event_add(ring, level, buf, len);
+		hostapd_global_ctrl_iface_event_retry(interfaces, NULL);
 	}
 }
 
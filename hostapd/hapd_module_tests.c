@@ -10,9 +10,205 @@
 
 #include "utils/common.h"
 #include "utils/module_tests.h"
+#include "eap_server/eap_sim_db.h"
+
+
+#if defined(EAP_SERVER_SIM) || defined(EAP_SERVER_AKA)
+
+#define EAP_SIM_DB_TEST_USERS 1000
+
+static void eap_sim_db_test_cb(void *ctx, void *session_ctx)
+{
+}
+
+
+static int eap_sim_db_test_add(struct eap_sim_db_data *data,
+			       char **pseudonyms, char **reauth_ids)
+{
+	char permanent[20], *id;
+	u8 mk[EAP_SIM_MK_LEN];
+	int i;
+
+	for (i = 0; i < EAP_SIM_DB_TEST_USERS; i++) {
+		os_snprintf(permanent, sizeof(permanent), "0%015d", i);
+		os_free(pseudonyms[i]);
+		os_free(reauth_ids[i]);
+		pseudonyms[i] = eap_sim_db_get_next_pseudonym(data,
+							      EAP_SIM_DB_AKA);
+		reauth_ids[i] = eap_sim_db_get_next_reauth_id(data,
+							      EAP_SIM_DB_AKA);
+		if (!pseudonyms[i] || !reauth_ids[i])
+			return -1;
+		id = os_strdup(pseudonyms[i]);
+		if (!id || eap_sim_db_add_pseudonym(data, permanent, id) < 0)
+			return -1;
+		id = os_strdup(reauth_ids[i]);
+		os_memset(mk, i, sizeof(mk));
+		if (!id || eap_sim_db_add_reauth(data, permanent, id, i, mk) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+
+static int eap_sim_db_test_check(struct eap_sim_db_data *data,
+				 char **pseudonyms, char **reauth_ids,
+				 int removed)
+{
+	char permanent[20];
+	const char *perm;
+	struct eap_sim_reauth *r;
+	int i;
+
+	for (i = 0; i < EAP_SIM_DB_TEST_USERS; i++) {
+		os_snprintf(permanent, sizeof(permanent), "0%015d", i);
+		perm = eap_sim_db_get_permanent(data, pseudonyms[i]);
+		if (!perm || os_strcmp(perm, permanent) != 0) {
+			wpa_printf(MSG_INFO, "Pseudonym %d not found", i);
+			return -1;
+		}
+		r = eap_sim_db_get_reauth_entry(data, reauth_ids[i]);
+		if (removed && i % 2 == 0) {
+			if (r) {
+				wpa_printf(MSG_INFO,
+					   "Removed reauth entry %d found", i);
+				return -1;
+			}
+			continue;
+		}
+		if (!r || os_strcmp(r->permanent, permanent) != 0 ||
+		    r->counter != i || r->mk[0] != (i & 0xff)) {
+			wpa_printf(MSG_INFO, "Reauth entry %d not found", i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+static int eap_sim_db_test_remove(struct eap_sim_db_data *data,
+				  char **reauth_ids)
+{
+	struct eap_sim_reauth *r;
+	int i;
+
+	for (i = 0; i < EAP_SIM_DB_TEST_USERS; i += 2) {
+		r = eap_sim_db_get_reauth_entry(data, reauth_ids[i]);
+		if (!r)
+			return -1;
+		eap_sim_db_remove_reauth(data, r);
+	}
+
+	return 0;
+}
+
+
+static int eap_sim_db_module_tests(void)
+{
+	struct eap_sim_db_data *data;
+	char *pseudonyms[EAP_SIM_DB_TEST_USERS];
+	char *reauth_ids[EAP_SIM_DB_TEST_USERS];
+	char *old = NULL;
+	int i, ret = -1;
+#ifdef CONFIG_SQLITE
+	char fname[100], config[120];
+#endif /* CONFIG_SQLITE */
+
+	wpa_printf(MSG_INFO, "eap_sim_db module tests");
+
+	os_memset(pseudonyms, 0, sizeof(pseudonyms));
+	os_memset(reauth_ids, 0, sizeof(reauth_ids));
+
+	data = eap_sim_db_init("none", 1, eap_sim_db_test_cb, NULL);
+	if (!data ||
+	    eap_sim_db_test_add(data, pseudonyms, reauth_ids) < 0 ||
+	    eap_sim_db_test_check(data, pseudonyms, reauth_ids, 0) < 0)
+		goto fail;
+
+	/* A new pseudonym replaces the previous one */
+	old = pseudonyms[0];
+	pseudonyms[0] = eap_sim_db_get_next_pseudonym(data, EAP_SIM_DB_AKA);
+	if (!pseudonyms[0] ||
+	    eap_sim_db_add_pseudonym(data, "0000000000000000",
+				     os_strdup(pseudonyms[0])) < 0 ||
+	    eap_sim_db_get_permanent(data, old) ||
+	    !eap_sim_db_get_permanent(data, pseudonyms[0]))
+		goto fail;
+
+	if (eap_sim_db_test_remove(data, reauth_ids) < 0 ||
+	    eap_sim_db_test_check(data, pseudonyms, reauth_ids, 1) < 0)
+		goto fail;
+	eap_sim_db_deinit(data);
+	data = NULL;
+
+#ifdef CONFIG_SQLITE
+	/* Updates are written behind and loaded back on a cache miss */
+	os_snprintf(fname, sizeof(fname), "/tmp/eap_sim_db_test-%d.sqlite",
+		    getpid());
+	os_snprintf(config, sizeof(config), "none db=%s", fname);
+	unlink(fname);
+
+	data = eap_sim_db_init(config, 1, eap_sim_db_test_cb, NULL);
+	if (!data ||
+	    eap_sim_db_test_add(data, pseudonyms, reauth_ids) < 0)
+		goto fail_db;
+	eap_sim_db_deinit(data);
+
+	data = eap_sim_db_init(config, 1, eap_sim_db_test_cb, NULL);
+	if (!data ||
+	    eap_sim_db_test_check(data, pseudonyms, reauth_ids, 0) < 0 ||
+	    eap_sim_db_test_remove(data, reauth_ids) < 0 ||
+	    /* Some of the deletions have not yet been written */
+	    eap_sim_db_test_check(data, pseudonyms, reauth_ids, 1) < 0)
+		goto fail_db;
+	eap_sim_db_deinit(data);
+
+	data = eap_sim_db_init(config, 1, eap_sim_db_test_cb, NULL);
+	if (!data ||
+	    eap_sim_db_test_check(data, pseudonyms, reauth_ids, 1) < 0)
+		goto fail_db;
+	eap_sim_db_deinit(data);
+	data = NULL;
+	unlink(fname);
+#endif /* CONFIG_SQLITE */
+
+	ret = 0;
+	goto fail;
+
+#ifdef CONFIG_SQLITE
+fail_db:
+	unlink(fname);
+#endif /* CONFIG_SQLITE */
+fail:
+	if (data)
+		eap_sim_db_deinit(data);
+	os_free(old);
+	for (i = 0; i < EAP_SIM_DB_TEST_USERS; i++) {
+		os_free(pseudonyms[i]);
+		os_free(reauth_ids[i]);
+	}
+
+	if (ret)
+		wpa_printf(MSG_ERROR, "eap_sim_db module test failure");
+
+	return ret;
+}
+
+#endif /* EAP_SERVER_SIM || EAP_SERVER_AKA */
+
 
 int hapd_module_tests(void)
 {
+	int ret = 0;
+
 	wpa_printf(MSG_INFO, "hostapd module tests");
-	return 0;
+
+#if defined(EAP_SERVER_SIM) || defined(EAP_SERVER_AKA)
+	if (eap_sim_db_module_tests() < 0)
+		ret = -1;
+#endif /* EAP_SERVER_SIM || EAP_SERVER_AKA */
+
+	return ret;
 }
@@ -46,6 +46,11 @@
  * SQN generation follows the not time-based Profile 2 described in
  * 3GPP TS 33.102 Annex C.3.2. The length of IND is 5 bits by default, but this
  * can be changed with a command line options if needed.
+ *
+ * Requests that are queued on the socket are processed in batches of up to
+ * HLR_AUC_GW_BATCH requests. SQN changes are persisted once per batch, either
+ * in a single SQLite transaction or by appending them to the SQN log of the
+ * Milenage file (with -u) before the responses are sent.
  */
 
 #include "includes.h"
@@ -66,21 +71,29 @@ static int update_milenage = 0;
 static int sqn_changes = 0;
 static int ind_len = 5;
 static int stdout_debug = 1;
+static FILE *sqn_log = NULL;
+static int sqn_log_dirty = 0;
+
+#define HLR_AUC_GW_BATCH 32
+#define IMSI_HASH_SIZE 4096
 
 /* GSM triplets */
 struct gsm_triplet {
 	struct gsm_triplet *next;
+	struct gsm_triplet *hnext; /* next in the IMSI hash bucket */
 	char imsi[20];
 	u8 kc[8];
 	u8 sres[4];
 	u8 _rand[16];
 };
 
-static struct gsm_triplet *gsm_db = NULL, *gsm_db_pos = NULL;
+static struct gsm_triplet *gsm_db = NULL;
+static struct gsm_triplet *gsm_hash[IMSI_HASH_SIZE];
 
 /* OPc and AMF parameters for Milenage (Example algorithms for AKA). */
 struct milenage_parameters {
 	struct milenage_parameters *next;
+	struct milenage_parameters *hnext; /* next in the IMSI hash bucket */
 	char imsi[20];
 	u8 ki[16];
 	u8 opc[16];
@@ -91,6 +104,7 @@ struct milenage_parameters {
 };
 
 static struct milenage_parameters *milenage_db = NULL;
+static struct milenage_parameters *milenage_hash[IMSI_HASH_SIZE];
 
 #define EAP_SIM_MAX_CHAL 3
 
@@ -103,9 +117,22 @@ static struct milenage_parameters *milenage_db = NULL;
 #define EAP_AKA_CK_LEN 16
 
 
+static unsigned int imsi_hash(const char *imsi, size_t len)
+{
+	unsigned int hash = 5381;
+
+	while (len--)
+		hash = (hash << 5) + hash + (u8) *imsi++;
+	return hash & (IMSI_HASH_SIZE - 1);
+}
+
+
 #ifdef CONFIG_SQLITE
 
 static sqlite3 *sqlite_db = NULL;
+static sqlite3_stmt *db_stmt_get_milenage = NULL;
+static sqlite3_stmt *db_stmt_set_sqn = NULL;
+static int db_in_transaction = 0;
 static struct milenage_parameters db_tmp_milenage;
 
 
@@ -141,7 +168,18 @@ static int db_table_create_milenage(sqlite3 *db)
 }
 
 
-static sqlite3 * db_open(const char *db_file)
+static void db_close(void)
+{
+	sqlite3_finalize(db_stmt_get_milenage);
+	sqlite3_finalize(db_stmt_set_sqn);
+	db_stmt_get_milenage = NULL;
+	db_stmt_set_sqn = NULL;
+	sqlite3_close(sqlite_db);
+	sqlite_db = NULL;
+}
+
+
+static int db_open(const char *db_file, int wal)
 {
 	sqlite3 *db;
 
@@ -149,54 +187,86 @@ static sqlite3 * db_open(const char *db_file)
 		printf("Failed to open database %s: %s\n",
 		       db_file, sqlite3_errmsg(db));
 		sqlite3_close(db);
-		return NULL;
+		return -1;
 	}
+	sqlite_db = db;
 
 	if (!db_table_exists(db, "milenage") &&
-	    db_table_create_milenage(db) < 0) {
-		sqlite3_close(db);
-		return NULL;
+	    db_table_create_milenage(db) < 0)
+		goto fail;
+
+	/*
+	 * With write-ahead logging, SQN updates do not need to rewrite the
+	 * database pages on each commit and the database can be modified by
+	 * other processes while requests are being processed. The journal
+	 * mode is stored in the database file, so this is done only when
+	 * requested.
+	 */
+	if (wal &&
+	    (sqlite3_exec(db, "PRAGMA journal_mode=WAL;", NULL, NULL, NULL) !=
+	     SQLITE_OK ||
+	     sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", NULL, NULL,
+			  NULL) != SQLITE_OK))
+		printf("Could not enable WAL mode for database %s: %s\n",
+		       db_file, sqlite3_errmsg(db));
+
+	if (sqlite3_prepare_v2(db, "SELECT * FROM milenage WHERE imsi=?;", -1,
+			       &db_stmt_get_milenage, NULL) != SQLITE_OK ||
+	    sqlite3_prepare_v2(db, "UPDATE milenage SET sqn=? WHERE imsi=?;",
+			       -1, &db_stmt_set_sqn, NULL) != SQLITE_OK) {
+		printf("Failed to prepare SQLite statements: %s\n",
+		       sqlite3_errmsg(db));
+		goto fail;
 	}
 
-	return db;
+	return 0;
+
+fail:
+	db_close();
+	return -1;
 }
 
 
-static int get_milenage_cb(void *ctx, int argc, char *argv[], char *col[])
+static int db_get_milenage_row(sqlite3_stmt *stmt,
+			       struct milenage_parameters *m)
 {
-	struct milenage_parameters *m = ctx;
 	int i;
 
 	m->set = 1;
 
-	for (i = 0; i < argc; i++) {
-		if (os_strcmp(col[i], "ki") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->ki, sizeof(m->ki))) {
+	for (i = 0; i < sqlite3_column_count(stmt); i++) {
+		const char *col = sqlite3_column_name(stmt, i);
+		const char *val = (const char *) sqlite3_column_text(stmt, i);
+
+		if (!col || !val)
+			continue;
+
+		if (os_strcmp(col, "ki") == 0 &&
+		    hexstr2bin(val, m->ki, sizeof(m->ki))) {
 			printf("Invalid ki value in database\n");
 			return -1;
 		}
 
-		if (os_strcmp(col[i], "opc") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->opc, sizeof(m->opc))) {
+		if (os_strcmp(col, "opc") == 0 &&
+		    hexstr2bin(val, m->opc, sizeof(m->opc))) {
 			printf("Invalid opcvalue in database\n");
 			return -1;
 		}
 
-		if (os_strcmp(col[i], "amf") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->amf, sizeof(m->amf))) {
+		if (os_strcmp(col, "amf") == 0 &&
+		    hexstr2bin(val, m->amf, sizeof(m->amf))) {
 			printf("Invalid amf value in database\n");
 			return -1;
 		}
 
-		if (os_strcmp(col[i], "sqn") == 0 && argv[i] &&
-		    hexstr2bin(argv[i], m->sqn, sizeof(m->sqn))) {
+		if (os_strcmp(col, "sqn") == 0 &&
+		    hexstr2bin(val, m->sqn, sizeof(m->sqn))) {
 			printf("Invalid sqn value in database\n");
 			return -1;
 		}
 
-		if (os_strcmp(col[i], "res_len") == 0 && argv[i]) {
-			m->res_len = atoi(argv[i]);
-		}
+		if (os_strcmp(col, "res_len") == 0)
+			m->res_len = atoi(val);
 	}
 
 	return 0;
@@ -205,20 +275,21 @@ static int get_milenage_cb(void *ctx, int argc, char *argv[], char *col[])
 
 static struct milenage_parameters * db_get_milenage(const char *imsi_txt)
 {
-	char cmd[128];
+	sqlite3_stmt *stmt = db_stmt_get_milenage;
 	unsigned long long imsi;
+	int res = -1;
 
 	os_memset(&db_tmp_milenage, 0, sizeof(db_tmp_milenage));
 	imsi = atoll(imsi_txt);
 	os_snprintf(db_tmp_milenage.imsi, sizeof(db_tmp_milenage.imsi),
 		    "%llu", imsi);
-	os_snprintf(cmd, sizeof(cmd),
-		    "SELECT * FROM milenage WHERE imsi=%llu;", imsi);
-	if (sqlite3_exec(sqlite_db, cmd, get_milenage_cb, &db_tmp_milenage,
-			 NULL) != SQLITE_OK)
-		return NULL;
+	sqlite3_bind_int64(stmt, 1, imsi);
+	if (sqlite3_step(stmt) == SQLITE_ROW)
+		res = db_get_milenage_row(stmt, &db_tmp_milenage);
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
 
-	if (!db_tmp_milenage.set)
+	if (res < 0 || !db_tmp_milenage.set)
 		return NULL;
 	return &db_tmp_milenage;
 }
@@ -226,23 +297,46 @@ static struct milenage_parameters * db_get_milenage(const char *imsi_txt)
 
 static int db_update_milenage_sqn(struct milenage_parameters *m)
 {
-	char cmd[128], val[13], *pos;
+	sqlite3_stmt *stmt = db_stmt_set_sqn;
+	char val[13];
+	int ret = 0;
 
 	if (sqlite_db == NULL)
 		return 0;
 
-	pos = val;
-	pos += wpa_snprintf_hex(pos, sizeof(val), m->sqn, 6);
-	*pos = '\0';
-	os_snprintf(cmd, sizeof(cmd),
-		    "UPDATE milenage SET sqn='%s' WHERE imsi=%s;",
-		    val, m->imsi);
-	if (sqlite3_exec(sqlite_db, cmd, NULL, NULL, NULL) != SQLITE_OK) {
+	/* Updates are committed in db_commit() once per batch of requests */
+	if (!db_in_transaction) {
+		if (sqlite3_exec(sqlite_db, "BEGIN;", NULL, NULL, NULL) !=
+		    SQLITE_OK)
+			printf("SQLite: Failed to start transaction: %s\n",
+			       sqlite3_errmsg(sqlite_db));
+		else
+			db_in_transaction = 1;
+	}
+
+	wpa_snprintf_hex(val, sizeof(val), m->sqn, 6);
+	sqlite3_bind_text(stmt, 1, val, -1, SQLITE_STATIC);
+	sqlite3_bind_int64(stmt, 2, atoll(m->imsi));
+	if (sqlite3_step(stmt) != SQLITE_DONE) {
 		printf("Failed to update SQN in database for IMSI %s\n",
 		       m->imsi);
-		return -1;
+		ret = -1;
 	}
-	return 0;
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
+	return ret;
+}
+
+
+static void db_commit(void)
+{
+	if (!db_in_transaction)
+		return;
+	db_in_transaction = 0;
+	if (sqlite3_exec(sqlite_db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK)
+		printf("SQLite: Failed to commit SQN updates: %s\n",
+		       sqlite3_errmsg(sqlite_db));
 }
 
 #endif /* CONFIG_SQLITE */
@@ -277,6 +371,7 @@ static int read_gsm_triplets(const char *fname)
 	FILE *f;
 	char buf[200], *pos, *pos2;
 	struct gsm_triplet *g = NULL;
+	unsigned int h;
 	int line, ret = 0;
 
 	if (fname == NULL)
@@ -349,6 +444,9 @@ static int read_gsm_triplets(const char *fname)
 
 		g->next = gsm_db;
 		gsm_db = g;
+		h = imsi_hash(g->imsi, os_strlen(g->imsi));
+		g->hnext = gsm_hash[h];
+		gsm_hash[h] = g;
 		g = NULL;
 	}
 	os_free(g);
@@ -361,26 +459,29 @@ static int read_gsm_triplets(const char *fname)
 
 static struct gsm_triplet * get_gsm_triplet(const char *imsi)
 {
-	struct gsm_triplet *g = gsm_db_pos;
+	struct gsm_triplet **pos, *g, **tail;
 
-	while (g) {
-		if (strcmp(g->imsi, imsi) == 0) {
-			gsm_db_pos = g->next;
-			return g;
-		}
-		g = g->next;
-	}
+	pos = &gsm_hash[imsi_hash(imsi, os_strlen(imsi))];
+	while (*pos && strcmp((*pos)->imsi, imsi) != 0)
+		pos = &(*pos)->hnext;
+	g = *pos;
+	if (!g)
+		return NULL;
 
-	g = gsm_db;
-	while (g && g != gsm_db_pos) {
-		if (strcmp(g->imsi, imsi) == 0) {
-			gsm_db_pos = g->next;
-			return g;
-		}
-		g = g->next;
+	/*
+	 * Move the triplet to the end of the hash bucket to rotate through
+	 * all the triplets for this IMSI.
+	 */
+	if (g->hnext) {
+		*pos = g->hnext;
+		tail = pos;
+		while (*tail)
+			tail = &(*tail)->hnext;
+		*tail = g;
+		g->hnext = NULL;
 	}
 
-	return NULL;
+	return g;
 }
 
 
@@ -389,6 +490,7 @@ static int read_milenage(const char *fname)
 	FILE *f;
 	char buf[200], *pos, *pos2;
 	struct milenage_parameters *m = NULL;
+	unsigned int h;
 	int line, ret = 0;
 
 	if (fname == NULL)
@@ -483,6 +585,9 @@ static int read_milenage(const char *fname)
 
 		m->next = milenage_db;
 		milenage_db = m;
+		h = imsi_hash(m->imsi, os_strlen(m->imsi));
+		m->hnext = milenage_hash[h];
+		milenage_hash[h] = m;
 		m = NULL;
 	}
 	os_free(m);
@@ -493,7 +598,24 @@ static int read_milenage(const char *fname)
 }
 
 
-static void update_milenage_file(const char *fname)
+static struct milenage_parameters * get_milenage_file(const char *imsi,
+						      size_t imsi_len)
+{
+	struct milenage_parameters *m;
+
+	m = milenage_hash[imsi_hash(imsi, imsi_len)];
+	while (m) {
+		if (os_strncmp(m->imsi, imsi, imsi_len) == 0 &&
+		    m->imsi[imsi_len] == '\0')
+			break;
+		m = m->hnext;
+	}
+
+	return m;
+}
+
+
+static int update_milenage_file(const char *fname)
 {
 	FILE *f, *f2;
 	char name[500], buf[500], *pos;
@@ -504,7 +626,7 @@ static void update_milenage_file(const char *fname)
 	f = fopen(fname, "r");
 	if (f == NULL) {
 		printf("Could not open Milenage data file '%s'\n", fname);
-		return;
+		return -1;
 	}
 
 	snprintf(name, sizeof(name), "%s.new", fname);
@@ -512,7 +634,7 @@ static void update_milenage_file(const char *fname)
 	if (f2 == NULL) {
 		printf("Could not write Milenage data file '%s'\n", name);
 		fclose(f);
-		return;
+		return -1;
 	}
 
 	while (fgets(buf, sizeof(buf), f)) {
@@ -525,12 +647,7 @@ static void update_milenage_file(const char *fname)
 
 		imsi_len = pos - buf;
 
-		for (m = milenage_db; m; m = m->next) {
-			if (strncmp(buf, m->imsi, imsi_len) == 0 &&
-			    m->imsi[imsi_len] == '\0')
-				break;
-		}
-
+		m = get_milenage_file(buf, imsi_len);
 		if (!m)
 			goto no_update;
 
@@ -549,34 +666,128 @@ static void update_milenage_file(const char *fname)
 		fprintf(f2, "%s", buf);
 	}
 
+	/* The SQN log is removed once the new file is in place */
+	fflush(f2);
+	fsync(fileno(f2));
 	fclose(f2);
 	fclose(f);
 
 	snprintf(name, sizeof(name), "%s.bak", fname);
 	if (rename(fname, name) < 0) {
 		perror("rename");
-		return;
+		return -1;
 	}
 
 	snprintf(name, sizeof(name), "%s.new", fname);
 	if (rename(name, fname) < 0) {
 		perror("rename");
-		return;
+		return -1;
 	}
 
+	return 0;
 }
 
 
-static struct milenage_parameters * get_milenage(const char *imsi)
+/*
+ * SQN changes for the Milenage file entries are appended to <fname>.sqn as
+ * "<IMSI> <SQN>" lines when the file is updated (-u). The log is replayed on
+ * startup and merged into the Milenage file on exit or when it grows large.
+ */
+
+#define SQN_LOG_MAX_ENTRIES 100000
+
+static unsigned int sqn_log_entries = 0;
+
+
+static int read_sqn_log(const char *fname)
 {
-	struct milenage_parameters *m = milenage_db;
+	FILE *f;
+	char name[500], buf[100], *pos;
+	struct milenage_parameters *m;
+	u8 sqn[6];
 
-	while (m) {
-		if (strcmp(m->imsi, imsi) == 0)
-			break;
-		m = m->next;
+	snprintf(name, sizeof(name), "%s.sqn", fname);
+	f = fopen(name, "r");
+	if (f == NULL)
+		return 0;
+
+	while (fgets(buf, sizeof(buf), f)) {
+		pos = os_strchr(buf, ' ');
+		if (!pos || hexstr2bin(pos + 1, sqn, 6))
+			continue;
+		m = get_milenage_file(buf, pos - buf);
+		if (!m)
+			continue;
+		os_memcpy(m->sqn, sqn, 6);
+		sqn_changes = 1;
+		sqn_log_entries++;
+	}
+
+	fclose(f);
+
+	return 0;
+}
+
+
+static int open_sqn_log(const char *fname, const char *mode)
+{
+	char name[500];
+
+	snprintf(name, sizeof(name), "%s.sqn", fname);
+	sqn_log = fopen(name, mode);
+	if (sqn_log == NULL) {
+		printf("Could not open SQN log file '%s'\n", name);
+		return -1;
 	}
 
+	return 0;
+}
+
+
+static void close_sqn_log(const char *fname)
+{
+	char name[500];
+
+	if (sqn_log == NULL)
+		return;
+	fclose(sqn_log);
+	sqn_log = NULL;
+
+	/* The SQN values are now in the Milenage file */
+	snprintf(name, sizeof(name), "%s.sqn", fname);
+	unlink(name);
+	sqn_log_entries = 0;
+}
+
+
+static void sqn_flush(void)
+{
+#ifdef CONFIG_SQLITE
+	db_commit();
+#endif /* CONFIG_SQLITE */
+
+	if (sqn_log == NULL || !sqn_log_dirty)
+		return;
+	/* Make the SQN changes of the batch survive a crash */
+	fflush(sqn_log);
+	fsync(fileno(sqn_log));
+	sqn_log_dirty = 0;
+
+	if (sqn_log_entries >= SQN_LOG_MAX_ENTRIES &&
+	    update_milenage_file(milenage_file) == 0) {
+		close_sqn_log(milenage_file);
+		open_sqn_log(milenage_file, "w");
+		sqn_changes = 0;
+	}
+}
+
+
+static struct milenage_parameters * get_milenage(const char *imsi)
+{
+	struct milenage_parameters *m;
+
+	m = get_milenage_file(imsi, os_strlen(imsi));
+
 #ifdef CONFIG_SQLITE
 	if (!m)
 		m = db_get_milenage(imsi);
@@ -586,6 +797,26 @@ static struct milenage_parameters * get_milenage(const char *imsi)
 }
 
 
+static void milenage_sqn_changed(struct milenage_parameters *m)
+{
+	char sqn[13];
+
+	sqn_changes = 1;
+#ifdef CONFIG_SQLITE
+	db_update_milenage_sqn(m);
+	if (m == &db_tmp_milenage)
+		return;
+#endif /* CONFIG_SQLITE */
+
+	if (sqn_log) {
+		wpa_snprintf_hex(sqn, sizeof(sqn), m->sqn, 6);
+		fprintf(sqn_log, "%s %s\n", m->imsi, sqn);
+		sqn_log_entries++;
+		sqn_log_dirty = 1;
+	}
+}
+
+
 static int sim_req_auth(char *imsi, char *resp, size_t resp_len)
 {
 	int count, max_chal, ret;
@@ -751,10 +982,7 @@ static int aka_req_auth(char *imsi, char *resp, size_t resp_len)
 			return -1;
 		res_len = EAP_AKA_RES_MAX_LEN;
 		inc_sqn(m->sqn);
-#ifdef CONFIG_SQLITE
-		db_update_milenage_sqn(m);
-#endif /* CONFIG_SQLITE */
-		sqn_changes = 1;
+		milenage_sqn_changed(m);
 		if (stdout_debug) {
 			printf("AKA: Milenage with SQN=%02x%02x%02x%02x%02x%02x\n",
 			       m->sqn[0], m->sqn[1], m->sqn[2],
@@ -853,10 +1081,7 @@ static int aka_auts(char *imsi, char *resp, size_t resp_len)
 			       "SQN=%02x%02x%02x%02x%02x%02x\n",
 			       sqn[0], sqn[1], sqn[2], sqn[3], sqn[4], sqn[5]);
 		}
-#ifdef CONFIG_SQLITE
-		db_update_milenage_sqn(m);
-#endif /* CONFIG_SQLITE */
-		sqn_changes = 1;
+		milenage_sqn_changed(m);
 	}
 
 	return 0;
@@ -884,43 +1109,63 @@ static int process_cmd(char *cmd, char *resp, size_t resp_len)
 
 static int process(int s)
 {
-	char buf[1000], resp[1000];
-	struct sockaddr_un from;
-	socklen_t fromlen;
+	char buf[1000], resp[HLR_AUC_GW_BATCH][1000];
+	struct sockaddr_un from[HLR_AUC_GW_BATCH];
+	socklen_t fromlen[HLR_AUC_GW_BATCH];
 	ssize_t res;
+	int i, num;
 
-	fromlen = sizeof(from);
-	res = recvfrom(s, buf, sizeof(buf), 0, (struct sockaddr *) &from,
-		       &fromlen);
-	if (res < 0) {
-		perror("recvfrom");
-		return -1;
-	}
+	/*
+	 * Wait for the first request and then process all the requests that
+	 * are already queued (up to HLR_AUC_GW_BATCH) before persisting the
+	 * SQN changes and sending the responses.
+	 */
+	for (num = 0; num < HLR_AUC_GW_BATCH; num++) {
+		resp[num][0] = '\0';
+		fromlen[num] = sizeof(from[num]);
+		res = recvfrom(s, buf, sizeof(buf), num ? MSG_DONTWAIT : 0,
+			       (struct sockaddr *) &from[num], &fromlen[num]);
+		if (res < 0) {
+			if (num == 0) {
+				perror("recvfrom");
+				return -1;
+			}
+			break;
+		}
 
-	if (res == 0)
-		return 0;
+		if (res == 0)
+			continue;
 
-	if ((size_t) res >= sizeof(buf))
-		res = sizeof(buf) - 1;
-	buf[res] = '\0';
+		if ((size_t) res >= sizeof(buf))
+			res = sizeof(buf) - 1;
+		buf[res] = '\0';
 
-	printf("Received: %s\n", buf);
+		if (stdout_debug)
+			printf("Received: %s\n", buf);
 
-	if (process_cmd(buf, resp, sizeof(resp)) < 0) {
-		printf("Failed to process request\n");
-		return -1;
-	}
+		if (process_cmd(buf, resp[num], sizeof(resp[num])) < 0) {
+			printf("Failed to process request\n");
+			resp[num][0] = '\0';
+			continue;
+		}
 
-	if (resp[0] == '\0') {
-		printf("No response\n");
-		return 0;
+		if (resp[num][0] == '\0')
+			printf("No response\n");
 	}
 
-	printf("Send: %s\n", resp);
+	sqn_flush();
 
-	if (sendto(s, resp, os_strlen(resp), 0, (struct sockaddr *) &from,
-		   fromlen) < 0)
-		perror("send");
+	for (i = 0; i < num; i++) {
+		if (resp[i][0] == '\0')
+			continue;
+
+		if (stdout_debug)
+			printf("Send: %s\n", resp[i]);
+
+		if (sendto(s, resp[i], os_strlen(resp[i]), 0,
+			   (struct sockaddr *) &from[i], fromlen[i]) < 0)
+			perror("send");
+	}
 
 	return 0;
 }
@@ -931,8 +1176,14 @@ static void cleanup(void)
 	struct gsm_triplet *g, *gprev;
 	struct milenage_parameters *m, *prev;
 
-	if (update_milenage && milenage_file && sqn_changes)
-		update_milenage_file(milenage_file);
+	sqn_flush();
+	if (update_milenage && milenage_file && sqn_changes &&
+	    update_milenage_file(milenage_file) == 0)
+		close_sqn_log(milenage_file);
+	if (sqn_log) {
+		fclose(sqn_log);
+		sqn_log = NULL;
+	}
 
 	g = gsm_db;
 	while (g) {
@@ -954,10 +1205,8 @@ static void cleanup(void)
 		unlink(socket_path);
 
 #ifdef CONFIG_SQLITE
-	if (sqlite_db) {
-		sqlite3_close(sqlite_db);
-		sqlite_db = NULL;
-	}
+	if (sqlite_db)
+		db_close();
 #endif /* CONFIG_SQLITE */
 }
 
@@ -976,18 +1225,22 @@ static void usage(void)
 	       "Copyright (c) 2005-2017, Jouni Malinen <j@w1.fi>\n"
 	       "\n"
 	       "usage:\n"
-	       "hlr_auc_gw [-hu] [-s<socket path>] [-g<triplet file>] "
+	       "hlr_auc_gw [-hquW] [-s<socket path>] [-g<triplet file>] "
 	       "[-m<milenage file>] \\\n"
 	       "        [-D<DB file>] [-i<IND len in bits>] [command]\n"
 	       "\n"
 	       "options:\n"
 	       "  -h = show this usage help\n"
-	       "  -u = update SQN in Milenage file on exit\n"
+	       "  -q = do not print requests and responses\n"
+	       "  -u = update SQN in Milenage file (changes are logged "
+	       "to <milenage file>.sqn\n"
+	       "       and merged into the file on exit)\n"
 	       "  -s<socket path> = path for UNIX domain socket\n"
 	       "                    (default: %s)\n"
 	       "  -g<triplet file> = path for GSM authentication triplets\n"
 	       "  -m<milenage file> = path for Milenage keys\n"
 	       "  -D<DB file> = path to SQLite database\n"
+	       "  -W = switch the SQLite database to WAL journal mode\n"
 	       "  -i<IND len in bits> = IND length for SQN (default: 5)\n"
 	       "\n"
 	       "If the optional command argument, like "
@@ -1006,6 +1259,7 @@ int main(int argc, char *argv[])
 	int c;
 	char *gsm_triplet_file = NULL;
 	char *sqlite_db_file = NULL;
+	int sqlite_wal = 0;
 	int ret = 0;
 
 	if (os_program_init())
@@ -1014,7 +1268,7 @@ int main(int argc, char *argv[])
 	socket_path = default_socket_path;
 
 	for (;;) {
-		c = getopt(argc, argv, "D:g:hi:m:s:u");
+		c = getopt(argc, argv, "D:g:hi:m:qs:uW");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -1042,12 +1296,18 @@ int main(int argc, char *argv[])
 		case 'm':
 			milenage_file = optarg;
 			break;
+		case 'q':
+			stdout_debug = 0;
+			break;
 		case 's':
 			socket_path = optarg;
 			break;
 		case 'u':
 			update_milenage = 1;
 			break;
+		case 'W':
+			sqlite_wal = 1;
+			break;
 		default:
 			usage();
 			return -1;
@@ -1060,7 +1320,7 @@ int main(int argc, char *argv[])
 	}
 
 #ifdef CONFIG_SQLITE
-	if (sqlite_db_file && (sqlite_db = db_open(sqlite_db_file)) == NULL)
+	if (sqlite_db_file && db_open(sqlite_db_file, sqlite_wal) < 0)
 		return -1;
 #endif /* CONFIG_SQLITE */
 
@@ -1070,6 +1330,11 @@ int main(int argc, char *argv[])
 	if (milenage_file && read_milenage(milenage_file) < 0)
 		return -1;
 
+	if (update_milenage && milenage_file &&
+	    (read_sqn_log(milenage_file) < 0 ||
+	     open_sqn_log(milenage_file, "a") < 0))
+		return -1;
+
 	if (optind == argc) {
 		serv_sock = open_socket(socket_path);
 		if (serv_sock < 0)
@@ -1097,10 +1362,8 @@ int main(int argc, char *argv[])
 	}
 
 #ifdef CONFIG_SQLITE
-	if (sqlite_db) {
-		sqlite3_close(sqlite_db);
-		sqlite_db = NULL;
-	}
+	if (sqlite_db)
+		db_close();
 #endif /* CONFIG_SQLITE */
 
 	os_program_deinit();
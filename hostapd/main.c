@@ -15,6 +15,7 @@
 #include "utils/common.h"
 #include "utils/eloop.h"
 #include "utils/uuid.h"
+#include "utils/mem_pool.h"
 #include "crypto/random.h"
 #include "crypto/tls.h"
 #include "common/version.h"
@@ -39,19 +40,16 @@ static struct hapd_global global;
 
 
 #ifndef CONFIG_NO_HOSTAPD_LOGGER
-static void hostapd_logger_cb(void *ctx, const u8 *addr, unsigned int module,
-			      int level, const char *txt, size_t len)
+#define HOSTAPD_LOGGER_STDOUT BIT(0)
+#define HOSTAPD_LOGGER_SYSLOG BIT(1)
+
+/* Get the logger_stdout/logger_syslog destinations that accept a message */
+static unsigned int hostapd_logger_dest(struct hostapd_data *hapd,
+					unsigned int module, int level)
 {
-	struct hostapd_data *hapd = ctx;
-	char *format, *module_str;
-	int maxlen;
 	int conf_syslog_level, conf_stdout_level;
 	unsigned int conf_syslog, conf_stdout;
-
-	maxlen = len + 100;
-	format = os_malloc(maxlen);
-	if (!format)
-		return;
+	unsigned int dest = 0;
 
 	if (hapd && hapd->conf) {
 		conf_syslog_level = hapd->conf->logger_syslog_level;
@@ -63,6 +61,51 @@ static void hostapd_logger_cb(void *ctx, const u8 *addr, unsigned int module,
 		conf_syslog = conf_stdout = (unsigned int) -1;
 	}
 
+#ifdef CONFIG_DEBUG_SYSLOG
+	if (wpa_debug_syslog)
+		conf_stdout = 0;
+#endif /* CONFIG_DEBUG_SYSLOG */
+	if ((conf_stdout & module) && level >= conf_stdout_level)
+		dest |= HOSTAPD_LOGGER_STDOUT;
+
+#ifndef CONFIG_NATIVE_WINDOWS
+	if ((conf_syslog & module) && level >= conf_syslog_level)
+		dest |= HOSTAPD_LOGGER_SYSLOG;
+#endif /* CONFIG_NATIVE_WINDOWS */
+
+	return dest;
+}
+
+
+static int hostapd_logger_filter(void *ctx, unsigned int module, int level)
+{
+	unsigned int dest = hostapd_logger_dest(ctx, module, level);
+
+	if ((dest & HOSTAPD_LOGGER_STDOUT) &&
+	    wpa_debug_level_enabled(MSG_INFO))
+		return 1;
+
+	return !!(dest & HOSTAPD_LOGGER_SYSLOG);
+}
+
+
+static void hostapd_logger_cb(void *ctx, const u8 *addr, unsigned int module,
+			      int level, const char *txt, size_t len)
+{
+	struct hostapd_data *hapd = ctx;
+	char *format, *module_str;
+	int maxlen;
+	unsigned int dest;
+
+	dest = hostapd_logger_dest(hapd, module, level);
+	if (!dest)
+		return;
+
+	maxlen = len + 100;
+	format = os_malloc(maxlen);
+	if (!format)
+		return;
+
 	switch (module) {
 	case HOSTAPD_MODULE_IEEE80211:
 		module_str = "IEEE 802.11";
@@ -108,17 +151,13 @@ static void hostapd_logger_cb(void *ctx, const u8 *addr, unsigned int module,
 			    module_str ? module_str : "",
 			    module_str ? ": " : "", txt);
 
-#ifdef CONFIG_DEBUG_SYSLOG
-	if (wpa_debug_syslog)
-		conf_stdout = 0;
-#endif /* CONFIG_DEBUG_SYSLOG */
-	if ((conf_stdout & module) && level >= conf_stdout_level) {
+	if (dest & HOSTAPD_LOGGER_STDOUT) {
 		wpa_debug_print_timestamp();
 		wpa_printf(MSG_INFO, "%s", format);
 	}
 
 #ifndef CONFIG_NATIVE_WINDOWS
-	if ((conf_syslog & module) && level >= conf_syslog_level) {
+	if (dest & HOSTAPD_LOGGER_SYSLOG) {
 		int priority;
 		switch (level) {
 		case HOSTAPD_LEVEL_DEBUG_VERBOSE:
@@ -340,6 +379,7 @@ static int hostapd_global_init(struct hapd_interfaces *interfaces,
 	os_memset(&global, 0, sizeof(global));
 
 	hostapd_logger_register_cb(hostapd_logger_cb);
+	hostapd_logger_register_filter_cb(hostapd_logger_filter);
 
 	if (eap_server_register_methods()) {
 		wpa_printf(MSG_ERROR, "Failed to register EAP methods");
@@ -482,6 +522,7 @@ static void usage(void)
 		"   -K   include key data in debug messages\n"
 #ifdef CONFIG_DEBUG_FILE
 		"   -f   log output to debug file instead of stdout\n"
+		"   -F   log output to debug file in binary format\n"
 #endif /* CONFIG_DEBUG_FILE */
 #ifdef CONFIG_DEBUG_LINUX_TRACING
 		"   -T   record to Linux tracing in addition to logging\n"
@@ -642,6 +683,7 @@ int main(int argc, char *argv[])
 	int c, debug = 0, daemonize = 0;
 	char *pid_file = NULL;
 	const char *log_file = NULL;
+	int log_file_binary = 0;
 	const char *entropy_file = NULL;
 	char **bss_config = NULL, **tmp_bss;
 	size_t num_bss_configs = 0;
@@ -651,6 +693,8 @@ int main(int argc, char *argv[])
 	int start_ifaces_in_sync = 0;
 	char **if_names = NULL;
 	size_t if_names_size = 0;
+	struct os_reltime phase;
+	unsigned int prepare_us;
 
 	if (os_program_init())
 		return -1;
@@ -671,7 +715,7 @@ int main(int argc, char *argv[])
 #endif /* CONFIG_ETH_P_OUI */
 
 	for (;;) {
-		c = getopt(argc, argv, "b:Bde:f:hi:KP:sSTtu:vg:G:");
+		c = getopt(argc, argv, "b:Bde:f:F:hi:KP:sSTtu:vg:G:");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -692,6 +736,10 @@ int main(int argc, char *argv[])
 		case 'f':
 			log_file = optarg;
 			break;
+		case 'F':
+			log_file = optarg;
+			log_file_binary = 1;
+			break;
 		case 'K':
 			wpa_debug_show_keys++;
 			break;
@@ -757,7 +805,9 @@ int main(int argc, char *argv[])
 
 	wpa_msg_register_ifname_cb(hostapd_msg_ifname_cb);
 
-	if (log_file)
+	if (log_file && log_file_binary)
+		wpa_debug_open_binary_file(log_file);
+	else if (log_file)
 		wpa_debug_open_file(log_file);
 	else
 		wpa_debug_setup_stdout();
@@ -867,10 +917,28 @@ int main(int argc, char *argv[])
 	 * In such case, the interface will be enabled from eloop context within
 	 * hostapd_global_run().
 	 */
+	for (i = 0; i < interfaces.count; i++) {
+		struct hostapd_startup_timing *t = &interfaces.iface[i]->startup;
+
+		os_memset(t, 0, sizeof(*t));
+		os_get_reltime(&t->start);
+	}
+	os_get_reltime(&phase);
+	if (hostapd_prepare_interfaces(&interfaces))
+		goto out;
+	/* PSKs of all interfaces are derived together */
+	prepare_us = hostapd_startup_us(&phase);
+	for (i = 0; i < interfaces.count; i++)
+		interfaces.iface[i]->startup.prepare = prepare_us;
+
 	interfaces.terminate_on_error = interfaces.count;
 	for (i = 0; i < interfaces.count; i++) {
+		struct hostapd_startup_timing *t = &interfaces.iface[i]->startup;
+
+		os_get_reltime(&phase);
 		if (hostapd_driver_init(interfaces.iface[i]))
 			goto out;
+		t->driver = hostapd_startup_us(&phase);
 #ifdef CONFIG_MBO
 		for (j = 0; j < interfaces.iface[i]->num_bss; j++) {
 			struct hostapd_data *hapd = interfaces.iface[i]->bss[j];
@@ -919,6 +987,7 @@ int main(int argc, char *argv[])
 		eloop_cancel_timeout(hostapd_periodic, &interfaces, NULL);
 	hostapd_global_deinit(pid_file, interfaces.eloop_initialized);
 	os_free(pid_file);
+	mem_pool_deinit_all();
 
 	wpa_debug_close_syslog();
 	if (log_file)
@@ -7,6 +7,9 @@
  */
 
 #include "utils/includes.h"
+#ifdef CONFIG_PARALLEL_STARTUP
+#include <pthread.h>
+#endif /* CONFIG_PARALLEL_STARTUP */
 
 #include "utils/common.h"
 #include "crypto/sha1.h"
@@ -68,6 +71,7 @@ void hostapd_config_defaults_bss(struct hostapd_bss_config *bss)
 	bss->dtim_period = 2;
 
 	bss->radius_server_auth_port = 1812;
+	bss->radius_server_sqlite_queue = 1024;
 	bss->eap_sim_db_timeout = 1;
 	bss->ap_max_inactivity = AP_MAX_INACTIVITY;
 	bss->eapol_version = EAPOL_VERSION;
@@ -344,7 +348,10 @@ int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf)
 	struct hostapd_ssid *ssid = &conf->ssid;
 
 	if (ssid->wpa_passphrase != NULL) {
-		if (ssid->wpa_psk != NULL) {
+		if (ssid->wpa_psk != NULL && !ssid->wpa_psk_set) {
+			wpa_printf(MSG_DEBUG,
+				   "Using previously derived WPA PSK");
+		} else if (ssid->wpa_psk != NULL) {
 			wpa_printf(MSG_DEBUG, "Using pre-configured WPA PSK "
 				   "instead of passphrase");
 		} else {
@@ -360,6 +367,153 @@ int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf)
 }
 
 
+struct hostapd_psk_job {
+	struct hostapd_bss_config *bss;
+	u8 psk[PMK_LEN];
+};
+
+struct hostapd_psk_jobs {
+	struct hostapd_psk_job *job;
+	size_t num;
+	size_t next;
+#ifdef CONFIG_PARALLEL_STARTUP
+	pthread_mutex_t lock;
+#endif /* CONFIG_PARALLEL_STARTUP */
+};
+
+
+static struct hostapd_psk_job *
+hostapd_psk_next_job(struct hostapd_psk_jobs *jobs)
+{
+	struct hostapd_psk_job *job = NULL;
+
+#ifdef CONFIG_PARALLEL_STARTUP
+	pthread_mutex_lock(&jobs->lock);
+#endif /* CONFIG_PARALLEL_STARTUP */
+	if (jobs->next < jobs->num)
+		job = &jobs->job[jobs->next++];
+#ifdef CONFIG_PARALLEL_STARTUP
+	pthread_mutex_unlock(&jobs->lock);
+#endif /* CONFIG_PARALLEL_STARTUP */
+
+	return job;
+}
+
+
+/*
+ * This may be run in a worker thread, so it must not use os_malloc() or debug
+ * prints (neither is thread safe).
+ */
+static void * hostapd_psk_worker(void *ctx)
+{
+	struct hostapd_psk_jobs *jobs = ctx;
+	struct hostapd_psk_job *job;
+	struct hostapd_ssid *ssid;
+
+	while ((job = hostapd_psk_next_job(jobs))) {
+		ssid = &job->bss->ssid;
+		pbkdf2_sha1(ssid->wpa_passphrase, ssid->ssid, ssid->ssid_len,
+			    4096, job->psk, PMK_LEN);
+	}
+
+	return NULL;
+}
+
+
+#ifdef CONFIG_PARALLEL_STARTUP
+static void hostapd_psk_run_parallel(struct hostapd_psk_jobs *jobs,
+				     unsigned int max_threads)
+{
+	pthread_t *threads;
+	unsigned int i, num_threads = 0;
+	long cpus;
+
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus > 0 && (unsigned long) cpus < max_threads)
+		max_threads = cpus;
+	if (jobs->num < max_threads)
+		max_threads = jobs->num;
+	if (max_threads <= 1 || pthread_mutex_init(&jobs->lock, NULL) != 0) {
+		hostapd_psk_worker(jobs);
+		return;
+	}
+
+	/* The calling thread is one of the workers */
+	threads = os_calloc(max_threads - 1, sizeof(pthread_t));
+	for (i = 0; threads && i < max_threads - 1; i++) {
+		if (pthread_create(&threads[i], NULL, hostapd_psk_worker,
+				   jobs) != 0)
+			break;
+		num_threads++;
+	}
+	wpa_printf(MSG_DEBUG, "Deriving %u WPA PSK(s) using %u thread(s)",
+		   (unsigned int) jobs->num, num_threads + 1);
+	hostapd_psk_worker(jobs);
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+	os_free(threads);
+	pthread_mutex_destroy(&jobs->lock);
+}
+#endif /* CONFIG_PARALLEL_STARTUP */
+
+
+/**
+ * hostapd_config_derive_psks - Derive passphrase based PSKs for BSSs
+ * @bss: Array of BSS configurations
+ * @num_bss: Number of entries in bss
+ * @max_threads: Maximum number of threads to use
+ * Returns: Number of derived PSKs or -1 on failure
+ *
+ * This can be used during startup to derive the PSKs for all BSSs at once
+ * before the BSSs are set up. If hostapd was built with
+ * CONFIG_PARALLEL_STARTUP=y, the PBKDF2 operations are distributed over
+ * worker threads. hostapd_setup_wpa_psk() uses the derived PSK instead of
+ * deriving it again.
+ */
+int hostapd_config_derive_psks(struct hostapd_bss_config **bss, size_t num_bss,
+			       unsigned int max_threads)
+{
+	struct hostapd_psk_jobs jobs;
+	struct hostapd_ssid *ssid;
+	size_t i;
+	int ret = 0;
+
+	os_memset(&jobs, 0, sizeof(jobs));
+	jobs.job = os_calloc(num_bss, sizeof(*jobs.job));
+	if (!jobs.job)
+		return -1;
+	for (i = 0; i < num_bss; i++) {
+		ssid = &bss[i]->ssid;
+		if (ssid->wpa_passphrase && !ssid->wpa_psk && ssid->ssid_set)
+			jobs.job[jobs.num++].bss = bss[i];
+	}
+
+#ifdef CONFIG_PARALLEL_STARTUP
+	hostapd_psk_run_parallel(&jobs, max_threads);
+#else /* CONFIG_PARALLEL_STARTUP */
+	hostapd_psk_worker(&jobs);
+#endif /* CONFIG_PARALLEL_STARTUP */
+
+	for (i = 0; i < jobs.num; i++) {
+		ssid = &jobs.job[i].bss->ssid;
+		ssid->wpa_psk = os_zalloc(sizeof(struct hostapd_wpa_psk));
+		if (!ssid->wpa_psk) {
+			ret = -1;
+			break;
+		}
+		os_memcpy(ssid->wpa_psk->psk, jobs.job[i].psk, PMK_LEN);
+		wpa_hexdump_ascii(MSG_DEBUG, "SSID",
+				  (u8 *) ssid->ssid, ssid->ssid_len);
+		wpa_hexdump_key(MSG_DEBUG, "PSK (from passphrase)",
+				ssid->wpa_psk->psk, PMK_LEN);
+		ret++;
+	}
+
+	bin_clear_free(jobs.job, num_bss * sizeof(*jobs.job));
+	return ret;
+}
+
+
 static void hostapd_config_free_radius(struct hostapd_radius_server *servers,
 				       int num_servers)
 {
@@ -630,6 +784,8 @@ void hostapd_config_free_bss(struct hostapd_bss_config *conf)
 	wpabuf_free(conf->dpp_csign);
 #endif /* CONFIG_DPP */
 
+	wpabuf_free(conf->config_lines);
+
 	os_free(conf);
 }
 
@@ -1092,3 +1248,353 @@ void hostapd_set_security_params(struct hostapd_bss_config *bss,
 		}
 	}
 }
+
+
+/**
+ * hostapd_config_add_line - Record a configuration file line for a BSS
+ * @bss: BSS configuration
+ * @field: Configuration field name
+ * @value: Configuration field value (possibly with file information)
+ * Returns: 0 on success or -1 on failure
+ */
+int hostapd_config_add_line(struct hostapd_bss_config *bss,
+			    const char *field, const char *value)
+{
+	size_t len = os_strlen(field) + 1 + os_strlen(value) + 1;
+
+	if (wpabuf_resize(&bss->config_lines, len) < 0)
+		return -1;
+	wpabuf_printf(bss->config_lines, "%s=%s", field, value);
+	wpabuf_put_u8(bss->config_lines, '\0');
+	return 0;
+}
+
+
+static const struct {
+	const char *field;
+	unsigned int reconf;
+} hostapd_reconf_fields[] = {
+	/* Used directly from the configuration when needed */
+	{ "logger_syslog", HOSTAPD_RECONF_CONF },
+	{ "logger_syslog_level", HOSTAPD_RECONF_CONF },
+	{ "logger_stdout", HOSTAPD_RECONF_CONF },
+	{ "logger_stdout_level", HOSTAPD_RECONF_CONF },
+	{ "max_num_sta", HOSTAPD_RECONF_CONF },
+	{ "max_listen_interval", HOSTAPD_RECONF_CONF },
+	{ "skip_inactivity_poll", HOSTAPD_RECONF_CONF },
+	{ "disassoc_low_ack", HOSTAPD_RECONF_CONF },
+	{ "radius_acct_interim_interval", HOSTAPD_RECONF_CONF },
+	{ "wpa_psk_radius", HOSTAPD_RECONF_CONF },
+	{ "assocresp_elements", HOSTAPD_RECONF_CONF },
+	{ "anqp_elem", HOSTAPD_RECONF_CONF },
+	{ "venue_name", HOSTAPD_RECONF_CONF },
+	{ "network_auth_type", HOSTAPD_RECONF_CONF },
+	{ "ipaddr_type_availability", HOSTAPD_RECONF_CONF },
+	{ "domain_name", HOSTAPD_RECONF_CONF },
+	{ "anqp_3gpp_cell_net", HOSTAPD_RECONF_CONF },
+	{ "nai_realm", HOSTAPD_RECONF_CONF },
+	{ "gas_frag_limit", HOSTAPD_RECONF_CONF },
+	{ "gas_comeback_delay", HOSTAPD_RECONF_CONF },
+	{ "hs20_oper_friendly_name", HOSTAPD_RECONF_CONF },
+	{ "hs20_wan_metrics", HOSTAPD_RECONF_CONF },
+	{ "hs20_conn_capab", HOSTAPD_RECONF_CONF },
+	{ "hs20_operating_class", HOSTAPD_RECONF_CONF },
+	{ "hs20_icon", HOSTAPD_RECONF_CONF },
+	{ "hs20_deauth_req_timeout", HOSTAPD_RECONF_CONF },
+	{ "osu_ssid", HOSTAPD_RECONF_CONF },
+	{ "osu_server_uri", HOSTAPD_RECONF_CONF },
+	{ "osu_friendly_name", HOSTAPD_RECONF_CONF },
+	{ "osu_nai", HOSTAPD_RECONF_CONF },
+	{ "osu_method_list", HOSTAPD_RECONF_CONF },
+	{ "osu_icon", HOSTAPD_RECONF_CONF },
+	{ "osu_service_desc", HOSTAPD_RECONF_CONF },
+	{ "subscr_remediation_url", HOSTAPD_RECONF_CONF },
+	{ "subscr_remediation_method", HOSTAPD_RECONF_CONF },
+	{ "mbo_cell_data_conn_pref", HOSTAPD_RECONF_CONF },
+
+	/* Beacon and Probe Response frame contents */
+	{ "ignore_broadcast_ssid", HOSTAPD_RECONF_BEACON },
+	{ "dtim_period", HOSTAPD_RECONF_BEACON },
+	{ "ap_isolate", HOSTAPD_RECONF_BEACON },
+	{ "ap_max_inactivity", HOSTAPD_RECONF_BEACON },
+	{ "interworking", HOSTAPD_RECONF_BEACON },
+	{ "access_network_type", HOSTAPD_RECONF_BEACON },
+	{ "internet", HOSTAPD_RECONF_BEACON },
+	{ "asra", HOSTAPD_RECONF_BEACON },
+	{ "esr", HOSTAPD_RECONF_BEACON },
+	{ "uesa", HOSTAPD_RECONF_BEACON },
+	{ "venue_group", HOSTAPD_RECONF_BEACON },
+	{ "venue_type", HOSTAPD_RECONF_BEACON },
+	{ "hessid", HOSTAPD_RECONF_BEACON },
+	{ "roaming_consortium", HOSTAPD_RECONF_BEACON },
+	{ "hs20", HOSTAPD_RECONF_BEACON },
+	{ "disable_dgaf", HOSTAPD_RECONF_BEACON | HOSTAPD_RECONF_WPA },
+	{ "vendor_elements", HOSTAPD_RECONF_BEACON },
+	{ "time_advertisement", HOSTAPD_RECONF_BEACON },
+	{ "time_zone", HOSTAPD_RECONF_BEACON },
+	{ "bss_transition", HOSTAPD_RECONF_BEACON },
+	{ "wnm_sleep_mode", HOSTAPD_RECONF_BEACON },
+	{ "tdls_prohibit", HOSTAPD_RECONF_BEACON },
+	{ "tdls_prohibit_chan_switch", HOSTAPD_RECONF_BEACON },
+	{ "rrm_neighbor_report", HOSTAPD_RECONF_BEACON },
+	{ "rrm_beacon_report", HOSTAPD_RECONF_BEACON },
+	{ "mbo", HOSTAPD_RECONF_BEACON },
+
+	/* Access control lists */
+	{ "macaddr_acl", HOSTAPD_RECONF_ACL },
+	{ "accept_mac_file", HOSTAPD_RECONF_ACL },
+	{ "deny_mac_file", HOSTAPD_RECONF_ACL },
+
+	/* RADIUS client */
+	{ "auth_server_addr", HOSTAPD_RECONF_RADIUS },
+	{ "auth_server_port", HOSTAPD_RECONF_RADIUS },
+	{ "auth_server_shared_secret", HOSTAPD_RECONF_RADIUS },
+	{ "acct_server_addr", HOSTAPD_RECONF_RADIUS },
+	{ "acct_server_port", HOSTAPD_RECONF_RADIUS },
+	{ "acct_server_shared_secret", HOSTAPD_RECONF_RADIUS },
+	{ "radius_retry_primary_interval", HOSTAPD_RECONF_RADIUS },
+	{ "radius_client_addr", HOSTAPD_RECONF_RADIUS },
+	{ "radius_auth_req_attr", HOSTAPD_RECONF_CONF },
+	{ "radius_acct_req_attr", HOSTAPD_RECONF_CONF },
+
+	/* Pre-shared keys */
+	{ "wpa_passphrase", HOSTAPD_RECONF_PSK },
+	{ "wpa_psk", HOSTAPD_RECONF_PSK },
+	{ "wpa_psk_file", HOSTAPD_RECONF_PSK },
+
+	/* WPA authenticator parameters that do not change the RSN element */
+	{ "wpa_group_rekey", HOSTAPD_RECONF_WPA },
+	{ "wpa_strict_rekey", HOSTAPD_RECONF_WPA },
+	{ "wpa_gmk_rekey", HOSTAPD_RECONF_WPA },
+	{ "wpa_ptk_rekey", HOSTAPD_RECONF_WPA },
+	{ "wpa_group_update_count", HOSTAPD_RECONF_WPA },
+	{ "wpa_pairwise_update_count", HOSTAPD_RECONF_WPA },
+	{ "peerkey", HOSTAPD_RECONF_WPA },
+	{ "disable_pmksa_caching", HOSTAPD_RECONF_WPA },
+	{ "okc", HOSTAPD_RECONF_WPA },
+	{ "r0kh", HOSTAPD_RECONF_WPA },
+	{ "r1kh", HOSTAPD_RECONF_WPA },
+	{ "r0_key_lifetime", HOSTAPD_RECONF_WPA },
+	{ "reassociation_deadline", HOSTAPD_RECONF_WPA },
+	{ "pmk_r1_push", HOSTAPD_RECONF_WPA },
+	{ "ft_psk_generate_local", HOSTAPD_RECONF_WPA },
+	{ "rkh_pos_timeout", HOSTAPD_RECONF_WPA },
+	{ "rkh_neg_timeout", HOSTAPD_RECONF_WPA },
+	{ "rkh_pull_timeout", HOSTAPD_RECONF_WPA },
+	{ "rkh_pull_retries", HOSTAPD_RECONF_WPA },
+
+	/* WPS device attributes */
+	{ "device_name", HOSTAPD_RECONF_WPS },
+	{ "manufacturer", HOSTAPD_RECONF_WPS },
+	{ "model_name", HOSTAPD_RECONF_WPS },
+	{ "model_number", HOSTAPD_RECONF_WPS },
+	{ "serial_number", HOSTAPD_RECONF_WPS },
+	{ "friendly_name", HOSTAPD_RECONF_WPS },
+	{ "manufacturer_url", HOSTAPD_RECONF_WPS },
+	{ "model_description", HOSTAPD_RECONF_WPS },
+	{ "model_url", HOSTAPD_RECONF_WPS },
+	{ "upc", HOSTAPD_RECONF_WPS },
+	{ "wps_vendor_ext", HOSTAPD_RECONF_WPS },
+
+	/* BSS specific parameters that require the stations to reconnect */
+	{ "ssid", HOSTAPD_RECONF_BSS },
+	{ "ssid2", HOSTAPD_RECONF_BSS },
+	{ "utf8_ssid", HOSTAPD_RECONF_BSS },
+	{ "wpa", HOSTAPD_RECONF_BSS },
+	{ "wpa_key_mgmt", HOSTAPD_RECONF_BSS },
+	{ "wpa_pairwise", HOSTAPD_RECONF_BSS },
+	{ "rsn_pairwise", HOSTAPD_RECONF_BSS },
+	{ "ieee80211w", HOSTAPD_RECONF_BSS },
+	{ "auth_algs", HOSTAPD_RECONF_BSS },
+	{ "ieee8021x", HOSTAPD_RECONF_BSS },
+	{ "eap_server", HOSTAPD_RECONF_BSS },
+	{ "eap_user_file", HOSTAPD_RECONF_BSS },
+	{ "wep_default_key", HOSTAPD_RECONF_BSS },
+	{ "wep_key0", HOSTAPD_RECONF_BSS },
+	{ "wep_key1", HOSTAPD_RECONF_BSS },
+	{ "wep_key2", HOSTAPD_RECONF_BSS },
+	{ "wep_key3", HOSTAPD_RECONF_BSS },
+	{ "nas_identifier", HOSTAPD_RECONF_BSS },
+	{ "wps_state", HOSTAPD_RECONF_BSS },
+	{ "proxy_arp", HOSTAPD_RECONF_BSS },
+	{ "qos_map_set", HOSTAPD_RECONF_BSS },
+};
+
+
+static unsigned int hostapd_config_field_reconf(const char *field,
+						size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(hostapd_reconf_fields); i++) {
+		if (os_strlen(hostapd_reconf_fields[i].field) == len &&
+		    os_strncmp(hostapd_reconf_fields[i].field, field, len) == 0)
+			return hostapd_reconf_fields[i].reconf;
+	}
+
+	/* Unknown field; this may be an interface parameter */
+	return HOSTAPD_RECONF_IFACE;
+}
+
+
+struct hostapd_config_line {
+	const char *txt;
+	size_t field_len;
+	size_t pos;
+};
+
+
+static int hostapd_config_line_cmp(const void *a, const void *b)
+{
+	const struct hostapd_config_line *la = a, *lb = b;
+	size_t len = la->field_len < lb->field_len ?
+		la->field_len : lb->field_len;
+	int res;
+
+	res = os_memcmp(la->txt, lb->txt, len);
+	if (res == 0 && la->field_len != lb->field_len)
+		res = la->field_len < lb->field_len ? -1 : 1;
+	if (res == 0)
+		res = la->pos < lb->pos ? -1 : 1;
+	return res;
+}
+
+
+/* Returns config lines sorted by field name (in file order within a field) */
+static struct hostapd_config_line *
+hostapd_config_lines(const struct wpabuf *buf, size_t *num)
+{
+	struct hostapd_config_line *lines;
+	const char *pos, *end, *eq;
+	size_t count = 0;
+
+	*num = 0;
+	pos = wpabuf_head(buf);
+	end = pos + wpabuf_len(buf);
+	while (pos < end) {
+		count++;
+		pos += os_strlen(pos) + 1;
+	}
+	lines = os_calloc(count ? count : 1, sizeof(*lines));
+	if (!lines)
+		return NULL;
+
+	for (pos = wpabuf_head(buf); pos < end; pos += os_strlen(pos) + 1) {
+		eq = os_strchr(pos, '=');
+		lines[*num].txt = pos;
+		lines[*num].field_len = eq ? (size_t) (eq - pos) :
+			os_strlen(pos);
+		lines[*num].pos = *num;
+		(*num)++;
+	}
+	qsort(lines, *num, sizeof(*lines), hostapd_config_line_cmp);
+
+	return lines;
+}
+
+
+/**
+ * hostapd_config_diff_bss - Determine changes between BSS configurations
+ * @old: Current BSS configuration
+ * @new: New BSS configuration
+ * @changed: Buffer for a comma separated list of changed fields or %NULL
+ * @changed_len: Length of the changed buffer
+ * Returns: Bitfield of HOSTAPD_RECONF_* values for the parts of the BSS that
+ * need to be updated (0 = no changes)
+ *
+ * The comparison is done based on the configuration file lines recorded in
+ * hostapd_config_read(). If this information is not available for both
+ * configurations, HOSTAPD_RECONF_IFACE is returned.
+ */
+unsigned int hostapd_config_diff_bss(const struct hostapd_bss_config *old,
+				     const struct hostapd_bss_config *new,
+				     char *changed, size_t changed_len)
+{
+	struct hostapd_config_line *ol = NULL, *nl = NULL, *l;
+	size_t onum = 0, nnum = 0, i = 0, j = 0, i2, j2, k;
+	unsigned int reconf = 0;
+	char *pos = changed, *end = changed + changed_len;
+	int res, diff;
+
+	if (changed && changed_len)
+		changed[0] = '\0';
+
+	if (!old->config_lines || !new->config_lines)
+		return HOSTAPD_RECONF_IFACE;
+
+	ol = hostapd_config_lines(old->config_lines, &onum);
+	nl = hostapd_config_lines(new->config_lines, &nnum);
+	if (!ol || !nl) {
+		reconf = HOSTAPD_RECONF_IFACE;
+		goto out;
+	}
+
+	while (i < onum || j < nnum) {
+		/* Find the next field name and its lines in both lists */
+		if (i == onum)
+			l = &nl[j];
+		else if (j == nnum)
+			l = &ol[i];
+		else if (hostapd_config_line_cmp(&ol[i], &nl[j]) < 0)
+			l = &ol[i];
+		else
+			l = &nl[j];
+		for (i2 = i; i2 < onum && ol[i2].field_len == l->field_len &&
+			     os_memcmp(ol[i2].txt, l->txt, l->field_len) == 0;
+		     i2++)
+			;
+		for (j2 = j; j2 < nnum && nl[j2].field_len == l->field_len &&
+			     os_memcmp(nl[j2].txt, l->txt, l->field_len) == 0;
+		     j2++)
+			;
+
+		diff = i2 - i != j2 - j;
+		for (k = 0; !diff && k < i2 - i; k++)
+			diff = os_strcmp(ol[i + k].txt, nl[j + k].txt) != 0;
+
+		if (diff) {
+			reconf |= hostapd_config_field_reconf(l->txt,
+							      l->field_len);
+			if (changed && end - pos > (int) l->field_len + 2) {
+				res = os_snprintf(pos, end - pos, "%s%.*s",
+						  pos == changed ? "" : ",",
+						  (int) l->field_len, l->txt);
+				if (!os_snprintf_error(end - pos, res))
+					pos += res;
+			}
+		}
+
+		i = i2;
+		j = j2;
+	}
+
+out:
+	os_free(ol);
+	os_free(nl);
+	return reconf;
+}
+
+
+int hostapd_config_reconf_txt(unsigned int reconf, char *buf, size_t buflen)
+{
+	static const char *names[] = {
+		"conf", "beacon", "acl", "radius", "psk", "wpa", "wps", "bss",
+		"iface"
+	};
+	char *pos = buf, *end = buf + buflen;
+	size_t i;
+	int res;
+
+	buf[0] = '\0';
+	for (i = 0; i < ARRAY_SIZE(names); i++) {
+		if (!(reconf & BIT(i)))
+			continue;
+		res = os_snprintf(pos, end - pos, "%s%s",
+				  pos == buf ? "" : ",", names[i]);
+		if (os_snprintf_error(end - pos, res))
+			break;
+		pos += res;
+	}
+
+	return pos - buf;
+}
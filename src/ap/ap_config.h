@@ -386,6 +386,11 @@ struct hostapd_bss_config {
 	char *radius_server_clients;
 	int radius_server_auth_port;
 	int radius_server_acct_port;
+	int radius_server_acct_reuseport;
+	int radius_server_batch;
+	int radius_server_sqlite_queue;
+	int radius_server_sqlite_commit_interval;
+	int radius_server_sqlite_wal;
 	int radius_server_ipv6;
 
 	int use_pae_group_addr; /* Whether to send EAPOL frames to PAE group
@@ -641,6 +646,15 @@ struct hostapd_bss_config {
 	struct wpabuf *dpp_csign;
 	unsigned int dpp_csign_expiry;
 #endif /* CONFIG_DPP */
+
+	/*
+	 * Configuration file lines for this BSS as NUL terminated
+	 * "<field>=<value>" strings in file order. These are used to determine
+	 * which parts of the configuration changed on reload. %NULL if the
+	 * configuration was not read from a file or if it has been modified
+	 * at runtime.
+	 */
+	struct wpabuf *config_lines;
 };
 
 /**
@@ -788,6 +802,17 @@ struct hostapd_config {
 };
 
 
+/* Parts of a BSS that need to be updated for changed configuration */
+#define HOSTAPD_RECONF_CONF BIT(0) /* used directly from the configuration */
+#define HOSTAPD_RECONF_BEACON BIT(1)
+#define HOSTAPD_RECONF_ACL BIT(2)
+#define HOSTAPD_RECONF_RADIUS BIT(3)
+#define HOSTAPD_RECONF_PSK BIT(4)
+#define HOSTAPD_RECONF_WPA BIT(5)
+#define HOSTAPD_RECONF_WPS BIT(6)
+#define HOSTAPD_RECONF_BSS BIT(7) /* restart the BSS */
+#define HOSTAPD_RECONF_IFACE BIT(8) /* restart all BSSs of the interface */
+
 int hostapd_mac_comp(const void *a, const void *b);
 struct hostapd_config * hostapd_config_defaults(void);
 void hostapd_config_defaults_bss(struct hostapd_bss_config *bss);
@@ -803,6 +828,8 @@ const u8 * hostapd_get_psk(const struct hostapd_bss_config *conf,
 			   const u8 *addr, const u8 *p2p_dev_addr,
 			   const u8 *prev_psk);
 int hostapd_setup_wpa_psk(struct hostapd_bss_config *conf);
+int hostapd_config_derive_psks(struct hostapd_bss_config **bss, size_t num_bss,
+			       unsigned int max_threads);
 int hostapd_vlan_valid(struct hostapd_vlan *vlan,
 		       struct vlan_description *vlan_desc);
 const char * hostapd_get_vlan_id_ifname(struct hostapd_vlan *vlan,
@@ -812,5 +839,11 @@ hostapd_config_get_radius_attr(struct hostapd_radius_attr *attr, u8 type);
 int hostapd_config_check(struct hostapd_config *conf, int full_config);
 void hostapd_set_security_params(struct hostapd_bss_config *bss,
 				 int full_config);
+int hostapd_config_add_line(struct hostapd_bss_config *bss,
+			    const char *field, const char *value);
+unsigned int hostapd_config_diff_bss(const struct hostapd_bss_config *old,
+				     const struct hostapd_bss_config *new,
+				     char *changed, size_t changed_len);
+int hostapd_config_reconf_txt(unsigned int reconf, char *buf, size_t buflen);
 
 #endif /* HOSTAPD_CONFIG_H */
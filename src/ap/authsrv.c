@@ -101,6 +101,11 @@ static int hostapd_setup_radius_srv(struct hostapd_data *hapd)
 	srv.client_file = conf->radius_server_clients;
 	srv.auth_port = conf->radius_server_auth_port;
 	srv.acct_port = conf->radius_server_acct_port;
+	srv.acct_reuseport = conf->radius_server_acct_reuseport;
+	srv.batch = conf->radius_server_batch;
+	srv.sqlite_queue = conf->radius_server_sqlite_queue;
+	srv.sqlite_commit_interval = conf->radius_server_sqlite_commit_interval;
+	srv.sqlite_wal = conf->radius_server_sqlite_wal;
 	srv.conf_ctx = hapd;
 	srv.eap_sim_db_priv = hapd->eap_sim_db_priv;
 	srv.ssl_ctx = hapd->ssl_ctx;
@@ -9,6 +9,7 @@
 #include "utils/includes.h"
 
 #include "utils/common.h"
+#include "utils/json.h"
 #include "common/ieee802_11_defs.h"
 #include "common/sae.h"
 #include "eapol_auth/eapol_auth_sm.h"
@@ -251,6 +252,367 @@ int hostapd_ctrl_iface_sta_next(struct hostapd_data *hapd, const char *txtaddr,
 }
 
 
+enum all_sta_field {
+	ALL_STA_FLAGS,
+	ALL_STA_AID,
+	ALL_STA_CAPABILITY,
+	ALL_STA_LISTEN_INTERVAL,
+	ALL_STA_VLAN_ID,
+	ALL_STA_CONNECTED_TIME,
+	ALL_STA_RX_PACKETS,
+	ALL_STA_TX_PACKETS,
+	ALL_STA_RX_BYTES,
+	ALL_STA_TX_BYTES,
+	ALL_STA_INACTIVE_MSEC,
+	ALL_STA_TX_RETRY_FAILED,
+	NUM_ALL_STA_FIELDS
+};
+
+static const struct {
+	const char *name;
+	unsigned int driver:1; /* value from driver station data */
+	unsigned int def:1; /* included by default */
+} all_sta_fields[NUM_ALL_STA_FIELDS] = {
+	[ALL_STA_FLAGS] = { "flags", 0, 1 },
+	[ALL_STA_AID] = { "aid", 0, 1 },
+	[ALL_STA_CAPABILITY] = { "capability", 0, 0 },
+	[ALL_STA_LISTEN_INTERVAL] = { "listen_interval", 0, 0 },
+	[ALL_STA_VLAN_ID] = { "vlan_id", 0, 0 },
+	[ALL_STA_CONNECTED_TIME] = { "connected_time", 0, 1 },
+	[ALL_STA_RX_PACKETS] = { "rx_packets", 1, 1 },
+	[ALL_STA_TX_PACKETS] = { "tx_packets", 1, 1 },
+	[ALL_STA_RX_BYTES] = { "rx_bytes", 1, 1 },
+	[ALL_STA_TX_BYTES] = { "tx_bytes", 1, 1 },
+	[ALL_STA_INACTIVE_MSEC] = { "inactive_msec", 1, 1 },
+	[ALL_STA_TX_RETRY_FAILED] = { "tx_retry_failed", 1, 0 },
+};
+
+/* Maximum length of a single station entry in ALL_STA output */
+#define ALL_STA_ENTRY_MAX_LEN 1024
+/* Room reserved for the end of the ALL_STA output */
+#define ALL_STA_TRAILER_LEN 40
+
+struct all_sta_dump {
+	struct sta_info **sta; /* sorted by address */
+	struct hostap_sta_driver_data *data;
+	u8 *data_valid;
+	size_t num;
+};
+
+
+static int all_sta_addr_cmp(const void *a, const void *b)
+{
+	const struct sta_info *sa = *(const struct sta_info **) a;
+	const struct sta_info *sb = *(const struct sta_info **) b;
+
+	return os_memcmp(sa->addr, sb->addr, ETH_ALEN);
+}
+
+
+static void all_sta_driver_data(void *ctx, const u8 *addr,
+				const struct hostap_sta_driver_data *data)
+{
+	struct all_sta_dump *dump = ctx;
+	size_t start = 0, end = dump->num, i;
+	int res;
+
+	while (start < end) {
+		i = start + (end - start) / 2;
+		res = os_memcmp(addr, dump->sta[i]->addr, ETH_ALEN);
+		if (res == 0) {
+			dump->data[i] = *data;
+			dump->data_valid[i] = 1;
+			return;
+		}
+		if (res < 0)
+			end = i;
+		else
+			start = i + 1;
+	}
+}
+
+
+static void all_sta_add_field(struct wpabuf *out, int json,
+			      enum all_sta_field field,
+			      struct sta_info *sta,
+			      const struct hostap_sta_driver_data *data)
+{
+	const char *name = all_sta_fields[field].name;
+	unsigned long long val;
+	struct os_reltime age;
+	char flags[200];
+
+	if (all_sta_fields[field].driver && !data)
+		return;
+
+	switch (field) {
+	case ALL_STA_FLAGS:
+		if (ap_sta_flags_txt(sta->flags, flags, sizeof(flags)) < 0)
+			return;
+		if (json) {
+			json_value_sep(out);
+			json_add_string(out, name, flags);
+		} else {
+			wpabuf_printf(out, " %s=%s", name, flags);
+		}
+		return;
+	case ALL_STA_AID:
+		val = sta->aid;
+		break;
+	case ALL_STA_CAPABILITY:
+		val = sta->capability;
+		break;
+	case ALL_STA_LISTEN_INTERVAL:
+		val = sta->listen_interval;
+		break;
+	case ALL_STA_VLAN_ID:
+		if (sta->vlan_id <= 0)
+			return;
+		val = sta->vlan_id;
+		break;
+	case ALL_STA_CONNECTED_TIME:
+		if (!sta->connected_time.sec)
+			return;
+		os_reltime_age(&sta->connected_time, &age);
+		val = age.sec;
+		break;
+	case ALL_STA_RX_PACKETS:
+		val = data->rx_packets;
+		break;
+	case ALL_STA_TX_PACKETS:
+		val = data->tx_packets;
+		break;
+	case ALL_STA_RX_BYTES:
+		val = data->rx_bytes;
+		break;
+	case ALL_STA_TX_BYTES:
+		val = data->tx_bytes;
+		break;
+	case ALL_STA_INACTIVE_MSEC:
+		val = data->inactive_msec;
+		break;
+	case ALL_STA_TX_RETRY_FAILED:
+		val = data->tx_retry_failed;
+		break;
+	default:
+		return;
+	}
+
+	if (json) {
+		json_value_sep(out);
+		json_add_ull(out, name, val);
+	} else {
+		wpabuf_printf(out, " %s=%llu", name, val);
+	}
+}
+
+
+static int all_sta_parse_fields(const char *pos, u32 *fields)
+{
+	const char *end;
+	size_t len;
+	int i;
+
+	*fields = 0;
+	while (*pos && *pos != ' ') {
+		end = pos;
+		while (*end && *end != ' ' && *end != ',')
+			end++;
+		len = end - pos;
+		if (len == 3 && os_strncmp(pos, "all", 3) == 0) {
+			*fields |= BIT(NUM_ALL_STA_FIELDS) - 1;
+		} else {
+			for (i = 0; i < NUM_ALL_STA_FIELDS; i++) {
+				if (os_strlen(all_sta_fields[i].name) == len &&
+				    os_strncmp(pos, all_sta_fields[i].name,
+					       len) == 0)
+					break;
+			}
+			if (i == NUM_ALL_STA_FIELDS)
+				return -1;
+			*fields |= BIT(i);
+		}
+		pos = *end == ',' ? end + 1 : end;
+	}
+
+	return *fields ? 0 : -1;
+}
+
+
+/**
+ * hostapd_ctrl_iface_all_sta - Dump information on all stations
+ * @hapd: Pointer to BSS data
+ * @cmd: Space separated parameters (see below) or %NULL
+ * @buf: Buffer for the reply
+ * @buflen: Length of the reply buffer
+ * Returns: Length of the reply or -1 on failure
+ *
+ * Parameters:
+ * fields=<name>[,<name>...] - information to include (or "all")
+ * format=<text|json> - one line per station or a JSON object
+ * after=<addr> - start from the first station with a larger address
+ * max=<num> - maximum number of stations to include
+ * max_len=<len> - maximum reply length (default 4096, limited by buflen)
+ *
+ * Stations are listed in the order of their addresses. If all the stations
+ * did not fit into the reply, it ends with next=<addr> (text) or the "next"
+ * member (JSON) and the next page can be fetched with after=<addr>. Driver
+ * statistics are fetched with a single request when the driver supports it.
+ */
+int hostapd_ctrl_iface_all_sta(struct hostapd_data *hapd, const char *cmd,
+			       char *buf, size_t buflen)
+{
+	struct all_sta_dump dump;
+	struct sta_info *sta;
+	struct wpabuf *out = NULL;
+	const struct hostap_sta_driver_data *data;
+	const char *pos;
+	u8 after[ETH_ALEN];
+	int use_after = 0, json = 0, driver = 0, bulk = 0, ret = -1;
+	size_t max_sta = (size_t) -1, max_len = 4096, i, prev_len, count = 0;
+	u32 fields = 0;
+	int f;
+
+	for (f = 0; f < NUM_ALL_STA_FIELDS; f++) {
+		if (all_sta_fields[f].def)
+			fields |= BIT(f);
+	}
+
+	for (pos = cmd; pos && *pos; pos = os_strchr(pos, ' ')) {
+		while (*pos == ' ')
+			pos++;
+		if (*pos == '\0')
+			break;
+		if (os_strncmp(pos, "fields=", 7) == 0) {
+			if (all_sta_parse_fields(pos + 7, &fields) < 0)
+				return -1;
+		} else if (os_strncmp(pos, "format=json", 11) == 0) {
+			json = 1;
+		} else if (os_strncmp(pos, "format=text", 11) == 0) {
+			json = 0;
+		} else if (os_strncmp(pos, "after=", 6) == 0) {
+			if (hwaddr_aton(pos + 6, after))
+				return -1;
+			use_after = 1;
+		} else if (os_strncmp(pos, "max=", 4) == 0) {
+			if (atoi(pos + 4) <= 0)
+				return -1;
+			max_sta = atoi(pos + 4);
+		} else if (os_strncmp(pos, "max_len=", 8) == 0) {
+			if (atoi(pos + 8) <= 0)
+				return -1;
+			max_len = atoi(pos + 8);
+		} else {
+			return -1;
+		}
+	}
+	if (max_len > buflen)
+		max_len = buflen;
+	if (max_len <= ALL_STA_TRAILER_LEN)
+		return -1;
+
+	for (f = 0; f < NUM_ALL_STA_FIELDS; f++) {
+		if ((fields & BIT(f)) && all_sta_fields[f].driver)
+			driver = 1;
+	}
+
+	os_memset(&dump, 0, sizeof(dump));
+	if (hapd->num_sta > 0) {
+		dump.sta = os_calloc(hapd->num_sta, sizeof(struct sta_info *));
+		if (!dump.sta)
+			return -1;
+	}
+	for (sta = hapd->sta_list; sta && dump.num < (size_t) hapd->num_sta;
+	     sta = sta->next) {
+		if (use_after && os_memcmp(sta->addr, after, ETH_ALEN) <= 0)
+			continue;
+		dump.sta[dump.num++] = sta;
+	}
+	if (dump.num > 1)
+		qsort(dump.sta, dump.num, sizeof(struct sta_info *),
+		      all_sta_addr_cmp);
+
+	if (driver && dump.num) {
+		dump.data = os_calloc(dump.num,
+				      sizeof(struct hostap_sta_driver_data));
+		dump.data_valid = os_zalloc(dump.num);
+		if (!dump.data || !dump.data_valid)
+			goto fail;
+		bulk = hostapd_drv_read_all_sta_data(hapd, all_sta_driver_data,
+						     &dump) == 0;
+	}
+
+	out = wpabuf_alloc(max_len + ALL_STA_ENTRY_MAX_LEN);
+	if (!out)
+		goto fail;
+	if (json) {
+		json_start_object(out, NULL);
+		json_start_array(out, "stations");
+	}
+
+	for (i = 0; i < dump.num && count < max_sta; i++) {
+		sta = dump.sta[i];
+		data = NULL;
+		if (driver && !bulk && !dump.data_valid[i] &&
+		    hostapd_drv_read_sta_data(hapd, &dump.data[i],
+					      sta->addr) == 0)
+			dump.data_valid[i] = 1;
+		if (driver && dump.data_valid[i])
+			data = &dump.data[i];
+
+		prev_len = wpabuf_len(out);
+		if (json) {
+			if (count)
+				json_value_sep(out);
+			json_start_object(out, NULL);
+			wpabuf_printf(out, "\"addr\":\"" MACSTR "\"",
+				      MAC2STR(sta->addr));
+		} else {
+			wpabuf_printf(out, MACSTR, MAC2STR(sta->addr));
+		}
+		for (f = 0; f < NUM_ALL_STA_FIELDS; f++) {
+			if (fields & BIT(f))
+				all_sta_add_field(out, json, f, sta, data);
+		}
+		if (json)
+			json_end_object(out);
+		else
+			wpabuf_put_u8(out, '\n');
+
+		if (wpabuf_len(out) + ALL_STA_TRAILER_LEN > max_len) {
+			/* Does not fit; drop the entry and end the page */
+			out->used = prev_len;
+			break;
+		}
+		count++;
+	}
+
+	if (dump.num && count == 0)
+		goto fail; /* max_len too small for a single entry */
+
+	if (json) {
+		json_end_array(out);
+		if (count < dump.num)
+			wpabuf_printf(out, ",\"next\":\"" MACSTR "\"",
+				      MAC2STR(dump.sta[count - 1]->addr));
+		json_end_object(out);
+		wpabuf_put_u8(out, '\n');
+	} else if (count < dump.num) {
+		wpabuf_printf(out, "next=" MACSTR "\n",
+			      MAC2STR(dump.sta[count - 1]->addr));
+	}
+
+	os_memcpy(buf, wpabuf_head(out), wpabuf_len(out));
+	ret = wpabuf_len(out);
+fail:
+	wpabuf_free(out);
+	os_free(dump.sta);
+	os_free(dump.data);
+	os_free(dump.data_valid);
+	return ret;
+}
+
+
 #ifdef CONFIG_P2P_MANAGER
 static int p2p_manager_disconnect(struct hostapd_data *hapd, u16 stype,
 				  u8 minor_reason_code, const u8 *addr)
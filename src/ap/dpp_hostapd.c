@@ -20,10 +20,21 @@
 #include "dpp_hostapd.h"
 
 
-static void hostapd_dpp_auth_success(struct hostapd_data *hapd, int initiator);
+static void hostapd_dpp_auth_success(struct hostapd_data *hapd,
+				     struct dpp_authentication *auth,
+				     int initiator);
 
 static const u8 broadcast[ETH_ALEN] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
 
+/* Maximum number of concurrent authentication exchanges */
+#define HOSTAPD_DPP_MAX_AUTH 64
+
+/*
+ * Time (in seconds) to keep an exchange after the Configuration Response has
+ * been built so that a retransmitted GAS request can still be answered
+ */
+#define HOSTAPD_DPP_CONF_DONE_TIMEOUT 10
+
 
 static struct dpp_configurator *
 hostapd_dpp_configurator_get_id(struct hostapd_data *hapd, unsigned int id)
@@ -39,17 +50,110 @@ hostapd_dpp_configurator_get_id(struct hostapd_data *hapd, unsigned int id)
 }
 
 
-static unsigned int hapd_dpp_next_id(struct hostapd_data *hapd)
+static void hostapd_dpp_bootstrap_add(struct hostapd_data *hapd,
+				      struct dpp_bootstrap_info *bi)
+{
+	unsigned int idx = DPP_BOOTSTRAP_HASH(bi->pubkey_hash);
+
+	/* Identifiers are allocated as max + 1 of the existing entries */
+	bi->id = ++hapd->dpp_bootstrap_max_id;
+	dl_list_add(&hapd->dpp_bootstrap, &bi->list);
+	bi->hnext = hapd->dpp_bootstrap_hash[idx];
+	hapd->dpp_bootstrap_hash[idx] = bi;
+}
+
+
+static void hostapd_dpp_bootstrap_hash_del(struct hostapd_data *hapd,
+					   struct dpp_bootstrap_info *bi)
+{
+	struct dpp_bootstrap_info **pos;
+
+	pos = &hapd->dpp_bootstrap_hash[DPP_BOOTSTRAP_HASH(bi->pubkey_hash)];
+	while (*pos) {
+		if (*pos == bi) {
+			*pos = bi->hnext;
+			return;
+		}
+		pos = &(*pos)->hnext;
+	}
+}
+
+
+static struct dpp_bootstrap_info *
+hostapd_dpp_bootstrap_find(struct hostapd_data *hapd, const u8 *hash, int own)
 {
 	struct dpp_bootstrap_info *bi;
-	unsigned int max_id = 0;
 
-	dl_list_for_each(bi, &hapd->dpp_bootstrap, struct dpp_bootstrap_info,
+	for (bi = hapd->dpp_bootstrap_hash[DPP_BOOTSTRAP_HASH(hash)]; bi;
+	     bi = bi->hnext) {
+		if (!bi->own == !own &&
+		    os_memcmp(bi->pubkey_hash, hash, SHA256_MAC_LEN) == 0)
+			return bi;
+	}
+	return NULL;
+}
+
+
+/*
+ * Find the authentication exchange with the specified peer. The broadcast
+ * address matches an exchange that was initiated without knowing the peer
+ * address.
+ */
+static struct dpp_authentication *
+hostapd_dpp_auth_get(struct hostapd_data *hapd, const u8 *addr)
+{
+	struct dpp_authentication *auth;
+	int bcast = is_broadcast_ether_addr(addr);
+
+	dl_list_for_each(auth, &hapd->dpp_auth, struct dpp_authentication,
 			 list) {
-		if (bi->id > max_id)
-			max_id = bi->id;
+		if (bcast ? is_zero_ether_addr(auth->peer_mac_addr) :
+		    os_memcmp(auth->peer_mac_addr, addr, ETH_ALEN) == 0)
+			return auth;
 	}
-	return max_id + 1;
+	return NULL;
+}
+
+
+static void hostapd_dpp_conf_done_timeout(void *eloop_ctx, void *timeout_ctx);
+
+
+static void hostapd_dpp_auth_remove(struct hostapd_data *hapd,
+				    struct dpp_authentication *auth)
+{
+	eloop_cancel_timeout(hostapd_dpp_conf_done_timeout, hapd, auth);
+	dl_list_del(&auth->list);
+	hapd->dpp_num_auth--;
+	dpp_auth_deinit(auth);
+}
+
+
+static void hostapd_dpp_auth_add(struct hostapd_data *hapd,
+				 struct dpp_authentication *auth)
+{
+	if (hapd->dpp_num_auth >= HOSTAPD_DPP_MAX_AUTH) {
+		struct dpp_authentication *oldest;
+
+		oldest = dl_list_last(&hapd->dpp_auth,
+				      struct dpp_authentication, list);
+		wpa_printf(MSG_DEBUG,
+			   "DPP: Too many authentication exchanges - remove the oldest one (peer "
+			   MACSTR ")", MAC2STR(oldest->peer_mac_addr));
+		hostapd_dpp_auth_remove(hapd, oldest);
+	}
+	dl_list_add(&hapd->dpp_auth, &auth->list);
+	hapd->dpp_num_auth++;
+}
+
+
+static void hostapd_dpp_conf_done_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct hostapd_data *hapd = eloop_ctx;
+	struct dpp_authentication *auth = timeout_ctx;
+
+	wpa_printf(MSG_DEBUG, "DPP: Remove completed exchange with " MACSTR,
+		   MAC2STR(auth->peer_mac_addr));
+	hostapd_dpp_auth_remove(hapd, auth);
 }
 
 
@@ -62,26 +166,29 @@ static unsigned int hapd_dpp_next_id(struct hostapd_data *hapd)
 int hostapd_dpp_qr_code(struct hostapd_data *hapd, const char *cmd)
 {
 	struct dpp_bootstrap_info *bi;
-	struct dpp_authentication *auth = hapd->dpp_auth;
+	struct dpp_authentication *auth;
 
 	bi = dpp_parse_qr_code(cmd);
 	if (!bi)
 		return -1;
 
-	bi->id = hapd_dpp_next_id(hapd);
-	dl_list_add(&hapd->dpp_bootstrap, &bi->list);
+	hostapd_dpp_bootstrap_add(hapd, bi);
 
-	if (auth && auth->response_pending &&
-	    dpp_notify_new_qr_code(auth, bi) == 1) {
+	dl_list_for_each(auth, &hapd->dpp_auth, struct dpp_authentication,
+			 list) {
 		struct wpabuf *msg;
 
+		if (!auth->response_pending ||
+		    dpp_notify_new_qr_code(auth, bi) != 1)
+			continue;
+
 		wpa_printf(MSG_DEBUG,
 			   "DPP: Sending out pending authentication response");
 		msg = dpp_alloc_msg(DPP_PA_AUTHENTICATION_RESP,
 				    wpabuf_len(auth->resp_attr));
 		if (!msg)
-			goto out;
-		wpabuf_put_buf(msg, hapd->dpp_auth->resp_attr);
+			break;
+		wpabuf_put_buf(msg, auth->resp_attr);
 
 		hostapd_drv_send_action(hapd, auth->curr_freq, 0,
 					auth->peer_mac_addr,
@@ -89,7 +196,6 @@ int hostapd_dpp_qr_code(struct hostapd_data *hapd, const char *cmd)
 		wpabuf_free(msg);
 	}
 
-out:
 	return bi->id;
 }
 
@@ -183,8 +289,7 @@ int hostapd_dpp_bootstrap_gen(struct hostapd_data *hapd, const char *cmd)
 		    mac ? "M:" : "", mac ? mac : "", mac ? ";" : "",
 		    info ? "I:" : "", info ? info : "", info ? ";" : "",
 		    pk);
-	bi->id = hapd_dpp_next_id(hapd);
-	dl_list_add(&hapd->dpp_bootstrap, &bi->list);
+	hostapd_dpp_bootstrap_add(hapd, bi);
 	ret = bi->id;
 	bi = NULL;
 fail:
@@ -225,9 +330,19 @@ static int dpp_bootstrap_del(struct hostapd_data *hapd, unsigned int id)
 			continue;
 		found = 1;
 		dl_list_del(&bi->list);
+		hostapd_dpp_bootstrap_hash_del(hapd, bi);
 		dpp_bootstrap_info_free(bi);
 	}
 
+	if (found && (id == 0 || id == hapd->dpp_bootstrap_max_id)) {
+		hapd->dpp_bootstrap_max_id = 0;
+		dl_list_for_each(bi, &hapd->dpp_bootstrap,
+				 struct dpp_bootstrap_info, list) {
+			if (bi->id > hapd->dpp_bootstrap_max_id)
+				hapd->dpp_bootstrap_max_id = bi->id;
+		}
+	}
+
 	if (id == 0)
 		return 0; /* flush succeeds regardless of entries found */
 	return found ? 0 : -1;
@@ -286,25 +401,27 @@ int hostapd_dpp_bootstrap_info(struct hostapd_data *hapd, int id,
 void hostapd_dpp_tx_status(struct hostapd_data *hapd, const u8 *dst,
 			   const u8 *data, size_t data_len, int ok)
 {
+	struct dpp_authentication *auth;
+
 	wpa_printf(MSG_DEBUG, "DPP: TX status: dst=" MACSTR " ok=%d",
 		   MAC2STR(dst), ok);
 
-	if (!hapd->dpp_auth) {
+	auth = hostapd_dpp_auth_get(hapd, dst);
+	if (!auth) {
 		wpa_printf(MSG_DEBUG,
 			   "DPP: Ignore TX status since there is no ongoing authentication exchange");
 		return;
 	}
 
-	if (hapd->dpp_auth->remove_on_tx_status) {
+	if (auth->remove_on_tx_status) {
 		wpa_printf(MSG_DEBUG,
 			   "DPP: Terminate authentication exchange due to an earlier error");
-		dpp_auth_deinit(hapd->dpp_auth);
-		hapd->dpp_auth = NULL;
+		hostapd_dpp_auth_remove(hapd, auth);
 		return;
 	}
 
-	if (hapd->dpp_auth_ok_on_ack)
-		hostapd_dpp_auth_success(hapd, 1);
+	if (auth->auth_ok_on_ack)
+		hostapd_dpp_auth_success(hapd, auth, 1);
 }
 
 
@@ -443,6 +560,7 @@ int hostapd_dpp_auth_init(struct hostapd_data *hapd, const char *cmd)
 {
 	const char *pos;
 	struct dpp_bootstrap_info *peer_bi, *own_bi = NULL;
+	struct dpp_authentication *auth;
 	struct wpabuf *msg;
 	const u8 *dst;
 	int res;
@@ -489,38 +607,36 @@ int hostapd_dpp_auth_init(struct hostapd_data *hapd, const char *cmd)
 			goto fail;
 	}
 
-	if (hapd->dpp_auth)
-		dpp_auth_deinit(hapd->dpp_auth);
-	hapd->dpp_auth = dpp_auth_init(hapd, peer_bi, own_bi, configurator);
-	if (!hapd->dpp_auth)
+	dst = is_zero_ether_addr(peer_bi->mac_addr) ? broadcast :
+		peer_bi->mac_addr;
+	auth = hostapd_dpp_auth_get(hapd, dst);
+	if (auth)
+		hostapd_dpp_auth_remove(hapd, auth);
+	auth = dpp_auth_init(hapd, peer_bi, own_bi, configurator);
+	if (!auth)
 		goto fail;
-	hostapd_dpp_set_testing_options(hapd, hapd->dpp_auth);
-	hostapd_dpp_set_configurator(hapd, hapd->dpp_auth, cmd);
+	hostapd_dpp_set_testing_options(hapd, auth);
+	hostapd_dpp_set_configurator(hapd, auth, cmd);
 
 	/* TODO: Support iteration over all frequencies and filtering of
 	 * frequencies based on locally enabled channels that allow initiation
 	 * of transmission. */
 	if (peer_bi->num_freq > 0)
-		hapd->dpp_auth->curr_freq = peer_bi->freq[0];
+		auth->curr_freq = peer_bi->freq[0];
 	else
-		hapd->dpp_auth->curr_freq = 2412;
+		auth->curr_freq = 2412;
+
+	if (!is_broadcast_ether_addr(dst))
+		os_memcpy(auth->peer_mac_addr, dst, ETH_ALEN);
+	hostapd_dpp_auth_add(hapd, auth);
 
 	msg = dpp_alloc_msg(DPP_PA_AUTHENTICATION_REQ,
-			    wpabuf_len(hapd->dpp_auth->req_attr));
+			    wpabuf_len(auth->req_attr));
 	if (!msg)
 		return -1;
-	wpabuf_put_buf(msg, hapd->dpp_auth->req_attr);
+	wpabuf_put_buf(msg, auth->req_attr);
 
-	if (is_zero_ether_addr(peer_bi->mac_addr)) {
-		dst = broadcast;
-	} else {
-		dst = peer_bi->mac_addr;
-		os_memcpy(hapd->dpp_auth->peer_mac_addr, peer_bi->mac_addr,
-			  ETH_ALEN);
-	}
-	hapd->dpp_auth_ok_on_ack = 0;
-
-	res = hostapd_drv_send_action(hapd, hapd->dpp_auth->curr_freq, 0,
+	res = hostapd_drv_send_action(hapd, auth->curr_freq, 0,
 				      dst, wpabuf_head(msg), wpabuf_len(msg));
 	wpabuf_free(msg);
 
@@ -537,7 +653,8 @@ static void hostapd_dpp_rx_auth_req(struct hostapd_data *hapd, const u8 *src,
 {
 	const u8 *r_bootstrap, *i_bootstrap, *wrapped_data;
 	u16 r_bootstrap_len, i_bootstrap_len, wrapped_data_len;
-	struct dpp_bootstrap_info *bi, *own_bi = NULL, *peer_bi = NULL;
+	struct dpp_bootstrap_info *own_bi, *peer_bi;
+	struct dpp_authentication *auth;
 	struct wpabuf *msg;
 
 	wpa_printf(MSG_DEBUG, "DPP: Authentication Request from " MACSTR,
@@ -577,61 +694,51 @@ static void hostapd_dpp_rx_auth_req(struct hostapd_data *hapd, const u8 *src,
 
 	/* Try to find own and peer bootstrapping key matches based on the
 	 * received hash values */
-	dl_list_for_each(bi, &hapd->dpp_bootstrap, struct dpp_bootstrap_info,
-			 list) {
-		if (!own_bi && bi->own &&
-		    os_memcmp(bi->pubkey_hash, r_bootstrap,
-			      SHA256_MAC_LEN) == 0) {
-			wpa_printf(MSG_DEBUG,
-				   "DPP: Found matching own bootstrapping information");
-			own_bi = bi;
-		}
-
-		if (!peer_bi && !bi->own &&
-		    os_memcmp(bi->pubkey_hash, i_bootstrap,
-			      SHA256_MAC_LEN) == 0) {
-			wpa_printf(MSG_DEBUG,
-				   "DPP: Found matching peer bootstrapping information");
-			peer_bi = bi;
-		}
-
-		if (own_bi && peer_bi)
-			break;
-	}
-
+	own_bi = hostapd_dpp_bootstrap_find(hapd, r_bootstrap, 1);
 	if (!own_bi) {
 		wpa_printf(MSG_DEBUG,
 			   "DPP: No matching own bootstrapping key found - ignore message");
 		return;
 	}
+	wpa_printf(MSG_DEBUG,
+		   "DPP: Found matching own bootstrapping information");
+
+	peer_bi = hostapd_dpp_bootstrap_find(hapd, i_bootstrap, 0);
+	if (peer_bi)
+		wpa_printf(MSG_DEBUG,
+			   "DPP: Found matching peer bootstrapping information");
 
-	if (hapd->dpp_auth) {
+	auth = hostapd_dpp_auth_get(hapd, src);
+	if (auth && eloop_is_timeout_registered(hostapd_dpp_conf_done_timeout,
+						hapd, auth)) {
 		wpa_printf(MSG_DEBUG,
-			   "DPP: Already in DPP authentication exchange - ignore new one");
+			   "DPP: Replace the completed exchange with the peer");
+		hostapd_dpp_auth_remove(hapd, auth);
+	} else if (auth) {
+		wpa_printf(MSG_DEBUG,
+			   "DPP: Already in DPP authentication exchange with the peer - ignore new one");
 		return;
 	}
 
-	hapd->dpp_auth_ok_on_ack = 0;
-	hapd->dpp_auth = dpp_auth_req_rx(hapd->msg_ctx, hapd->dpp_allowed_roles,
-					 hapd->dpp_qr_mutual,
-					 peer_bi, own_bi, freq, buf,
-					 wrapped_data, wrapped_data_len);
-	if (!hapd->dpp_auth) {
+	auth = dpp_auth_req_rx(hapd->msg_ctx, hapd->dpp_allowed_roles,
+			       hapd->dpp_qr_mutual, peer_bi, own_bi, freq, buf,
+			       wrapped_data, wrapped_data_len);
+	if (!auth) {
 		wpa_printf(MSG_DEBUG, "DPP: No response generated");
 		return;
 	}
-	hostapd_dpp_set_testing_options(hapd, hapd->dpp_auth);
-	hostapd_dpp_set_configurator(hapd, hapd->dpp_auth,
-				     hapd->dpp_configurator_params);
-	os_memcpy(hapd->dpp_auth->peer_mac_addr, src, ETH_ALEN);
+	hostapd_dpp_set_testing_options(hapd, auth);
+	hostapd_dpp_set_configurator(hapd, auth, hapd->dpp_configurator_params);
+	os_memcpy(auth->peer_mac_addr, src, ETH_ALEN);
+	hostapd_dpp_auth_add(hapd, auth);
 
 	msg = dpp_alloc_msg(DPP_PA_AUTHENTICATION_RESP,
-			    wpabuf_len(hapd->dpp_auth->resp_attr));
+			    wpabuf_len(auth->resp_attr));
 	if (!msg)
 		return;
-	wpabuf_put_buf(msg, hapd->dpp_auth->resp_attr);
+	wpabuf_put_buf(msg, auth->resp_attr);
 
-	hostapd_drv_send_action(hapd, hapd->dpp_auth->curr_freq, 0,
+	hostapd_drv_send_action(hapd, auth->curr_freq, 0,
 				src, wpabuf_head(msg), wpabuf_len(msg));
 	wpabuf_free(msg);
 }
@@ -644,7 +751,7 @@ static void hostapd_dpp_gas_resp_cb(void *ctx, const u8 *addr, u8 dialog_token,
 {
 	struct hostapd_data *hapd = ctx;
 	const u8 *pos;
-	struct dpp_authentication *auth = hapd->dpp_auth;
+	struct dpp_authentication *auth = hostapd_dpp_auth_get(hapd, addr);
 
 	if (!auth || !auth->auth_success) {
 		wpa_printf(MSG_DEBUG, "DPP: No matching exchange in progress");
@@ -734,20 +841,18 @@ static void hostapd_dpp_gas_resp_cb(void *ctx, const u8 *addr, u8 dialog_token,
 			os_free(hex);
 		}
 	}
-	dpp_auth_deinit(hapd->dpp_auth);
-	hapd->dpp_auth = NULL;
+	hostapd_dpp_auth_remove(hapd, auth);
 	return;
 
 fail:
 	wpa_msg(hapd->msg_ctx, MSG_INFO, DPP_EVENT_CONF_FAILED);
-	dpp_auth_deinit(hapd->dpp_auth);
-	hapd->dpp_auth = NULL;
+	hostapd_dpp_auth_remove(hapd, auth);
 }
 
 
-static void hostapd_dpp_start_gas_client(struct hostapd_data *hapd)
+static void hostapd_dpp_start_gas_client(struct hostapd_data *hapd,
+					 struct dpp_authentication *auth)
 {
-	struct dpp_authentication *auth = hapd->dpp_auth;
 	struct wpabuf *buf, *conf_req;
 	char json[100];
 	int res;
@@ -804,36 +909,37 @@ static void hostapd_dpp_start_gas_client(struct hostapd_data *hapd)
 }
 
 
-static void hostapd_dpp_auth_success(struct hostapd_data *hapd, int initiator)
+static void hostapd_dpp_auth_success(struct hostapd_data *hapd,
+				     struct dpp_authentication *auth,
+				     int initiator)
 {
 	wpa_printf(MSG_DEBUG, "DPP: Authentication succeeded");
 	wpa_msg(hapd->msg_ctx, MSG_INFO, DPP_EVENT_AUTH_SUCCESS "init=%d",
 		initiator);
 
-	if (!hapd->dpp_auth->configurator)
-		hostapd_dpp_start_gas_client(hapd);
+	auth->auth_ok_on_ack = 0;
+	if (!auth->configurator)
+		hostapd_dpp_start_gas_client(hapd, auth);
 }
 
 
 static void hostapd_dpp_rx_auth_resp(struct hostapd_data *hapd, const u8 *src,
 				  const u8 *buf, size_t len)
 {
-	struct dpp_authentication *auth = hapd->dpp_auth;
+	struct dpp_authentication *auth;
 	struct wpabuf *msg, *attr;
 
 	wpa_printf(MSG_DEBUG, "DPP: Authentication Response from " MACSTR,
 		   MAC2STR(src));
 
+	auth = hostapd_dpp_auth_get(hapd, src);
 	if (!auth) {
-		wpa_printf(MSG_DEBUG,
-			   "DPP: No DPP Authentication in progress - drop");
-		return;
+		/* Request may have been sent without known peer address */
+		auth = hostapd_dpp_auth_get(hapd, broadcast);
 	}
-
-	if (!is_zero_ether_addr(auth->peer_mac_addr) &&
-	    os_memcmp(src, auth->peer_mac_addr, ETH_ALEN) != 0) {
-		wpa_printf(MSG_DEBUG, "DPP: MAC address mismatch (expected "
-			   MACSTR ") - drop", MAC2STR(auth->peer_mac_addr));
+	if (!auth || !auth->initiator) {
+		wpa_printf(MSG_DEBUG,
+			   "DPP: No DPP Authentication in progress with the peer - drop");
 		return;
 	}
 
@@ -856,30 +962,25 @@ static void hostapd_dpp_rx_auth_resp(struct hostapd_data *hapd, const u8 *src,
 	wpabuf_put_buf(msg, attr);
 	wpabuf_free(attr);
 
+	auth->auth_ok_on_ack = 1;
 	hostapd_drv_send_action(hapd, auth->curr_freq, 0, src,
 				wpabuf_head(msg), wpabuf_len(msg));
 	wpabuf_free(msg);
-	hapd->dpp_auth_ok_on_ack = 1;
 }
 
 
 static void hostapd_dpp_rx_auth_conf(struct hostapd_data *hapd, const u8 *src,
 				     const u8 *buf, size_t len)
 {
-	struct dpp_authentication *auth = hapd->dpp_auth;
+	struct dpp_authentication *auth;
 
 	wpa_printf(MSG_DEBUG, "DPP: Authentication Confirmation from " MACSTR,
 		   MAC2STR(src));
 
+	auth = hostapd_dpp_auth_get(hapd, src);
 	if (!auth) {
 		wpa_printf(MSG_DEBUG,
-			   "DPP: No DPP Authentication in progress - drop");
-		return;
-	}
-
-	if (os_memcmp(src, auth->peer_mac_addr, ETH_ALEN) != 0) {
-		wpa_printf(MSG_DEBUG, "DPP: MAC address mismatch (expected "
-			   MACSTR ") - drop", MAC2STR(auth->peer_mac_addr));
+			   "DPP: No DPP Authentication in progress with the peer - drop");
 		return;
 	}
 
@@ -888,7 +989,7 @@ static void hostapd_dpp_rx_auth_conf(struct hostapd_data *hapd, const u8 *src,
 		return;
 	}
 
-	hostapd_dpp_auth_success(hapd, 0);
+	hostapd_dpp_auth_success(hapd, auth, 0);
 }
 
 
@@ -1105,7 +1206,6 @@ hostapd_dpp_rx_pkex_commit_reveal_req(struct hostapd_data *hapd, const u8 *src,
 	bi = os_zalloc(sizeof(*bi));
 	if (!bi)
 		return;
-	bi->id = hapd_dpp_next_id(hapd);
 	bi->type = DPP_BOOTSTRAP_PKEX;
 	os_memcpy(bi->mac_addr, src, ETH_ALEN);
 	bi->num_freq = 1;
@@ -1119,7 +1219,7 @@ hostapd_dpp_rx_pkex_commit_reveal_req(struct hostapd_data *hapd, const u8 *src,
 		dpp_bootstrap_info_free(bi);
 		return;
 	}
-	dl_list_add(&hapd->dpp_bootstrap, &bi->list);
+	hostapd_dpp_bootstrap_add(hapd, bi);
 }
 
 
@@ -1152,7 +1252,6 @@ hostapd_dpp_rx_pkex_commit_reveal_resp(struct hostapd_data *hapd, const u8 *src,
 	bi = os_zalloc(sizeof(*bi));
 	if (!bi)
 		return;
-	bi->id = hapd_dpp_next_id(hapd);
 	bi->type = DPP_BOOTSTRAP_PKEX;
 	os_memcpy(bi->mac_addr, src, ETH_ALEN);
 	bi->num_freq = 1;
@@ -1166,7 +1265,7 @@ hostapd_dpp_rx_pkex_commit_reveal_resp(struct hostapd_data *hapd, const u8 *src,
 		dpp_bootstrap_info_free(bi);
 		return;
 	}
-	dl_list_add(&hapd->dpp_bootstrap, &bi->list);
+	hostapd_dpp_bootstrap_add(hapd, bi);
 
 	os_snprintf(cmd, sizeof(cmd), " peer=%u %s",
 		    bi->id,
@@ -1239,12 +1338,11 @@ struct wpabuf *
 hostapd_dpp_gas_req_handler(struct hostapd_data *hapd, const u8 *sa,
 			    const u8 *query, size_t query_len)
 {
-	struct dpp_authentication *auth = hapd->dpp_auth;
+	struct dpp_authentication *auth = hostapd_dpp_auth_get(hapd, sa);
 	struct wpabuf *resp;
 
 	wpa_printf(MSG_DEBUG, "DPP: GAS request from " MACSTR, MAC2STR(sa));
-	if (!auth || !auth->auth_success ||
-	    os_memcmp(sa, auth->peer_mac_addr, ETH_ALEN) != 0) {
+	if (!auth || !auth->auth_success) {
 		wpa_printf(MSG_DEBUG, "DPP: No matching exchange in progress");
 		return NULL;
 	}
@@ -1254,6 +1352,12 @@ hostapd_dpp_gas_req_handler(struct hostapd_data *hapd, const u8 *sa,
 	resp = dpp_conf_req_rx(auth, query, query_len);
 	if (!resp)
 		wpa_msg(hapd->msg_ctx, MSG_INFO, DPP_EVENT_CONF_FAILED);
+	/* The exchange is completed from the Configurator view point; GAS
+	 * server takes care of delivering the response. Keep the exchange for
+	 * a while in case the Enrollee retransmits the request. */
+	eloop_cancel_timeout(hostapd_dpp_conf_done_timeout, hapd, auth);
+	eloop_register_timeout(HOSTAPD_DPP_CONF_DONE_TIMEOUT, 0,
+			       hostapd_dpp_conf_done_timeout, hapd, auth);
 	return resp;
 }
 
@@ -1461,6 +1565,7 @@ int hostapd_dpp_init(struct hostapd_data *hapd)
 {
 	dl_list_init(&hapd->dpp_bootstrap);
 	dl_list_init(&hapd->dpp_configurator);
+	dl_list_init(&hapd->dpp_auth);
 	hapd->dpp_allowed_roles = DPP_CAPAB_CONFIGURATOR | DPP_CAPAB_ENROLLEE;
 	hapd->dpp_init_done = 1;
 	return 0;
@@ -1484,8 +1589,11 @@ void hostapd_dpp_deinit(struct hostapd_data *hapd)
 		return;
 	dpp_bootstrap_del(hapd, 0);
 	dpp_configurator_del(hapd, 0);
-	dpp_auth_deinit(hapd->dpp_auth);
-	hapd->dpp_auth = NULL;
+	while (!dl_list_empty(&hapd->dpp_auth))
+		hostapd_dpp_auth_remove(hapd,
+					dl_list_first(&hapd->dpp_auth,
+						      struct dpp_authentication,
+						      list));
 	hostapd_dpp_pkex_remove(hapd, "*");
 	hapd->dpp_pkex = NULL;
 	os_free(hapd->dpp_configurator_params);
@@ -56,6 +56,7 @@ static int hostapd_setup_encryption(char *iface, struct hostapd_data *hapd);
 static int hostapd_broadcast_wep_clear(struct hostapd_data *hapd);
 static int setup_interface2(struct hostapd_iface *iface);
 static void channel_list_update_timeout(void *eloop_ctx, void *timeout_ctx);
+static void hostapd_set_acl(struct hostapd_data *hapd);
 
 
 int hostapd_for_each_interface(struct hapd_interfaces *interfaces,
@@ -138,25 +139,235 @@ static void hostapd_reload_bss(struct hostapd_data *hapd)
 }
 
 
-static void hostapd_clear_old(struct hostapd_iface *iface)
+static void hostapd_clear_old_bss(struct hostapd_data *hapd)
 {
-	size_t j;
-
 	/*
 	 * Deauthenticate all stations since the new configuration may not
 	 * allow them to use the BSS anymore.
 	 */
-	for (j = 0; j < iface->num_bss; j++) {
-		hostapd_flush_old_stations(iface->bss[j],
-					   WLAN_REASON_PREV_AUTH_NOT_VALID);
-		hostapd_broadcast_wep_clear(iface->bss[j]);
+	hostapd_flush_old_stations(hapd, WLAN_REASON_PREV_AUTH_NOT_VALID);
+	hostapd_broadcast_wep_clear(hapd);
+
+#ifndef CONFIG_NO_RADIUS
+	/*
+	 * Pending messages were built for the old configuration. The sockets
+	 * are opened again for changed RADIUS servers only when the BSS is not
+	 * restarted (see hostapd_reload_bss_changes()).
+	 */
+	radius_client_flush(hapd->radius, 0);
+#endif /* CONFIG_NO_RADIUS */
+}
+
+
+static void hostapd_clear_old(struct hostapd_iface *iface)
+{
+	size_t j;
+
+	for (j = 0; j < iface->num_bss; j++)
+		hostapd_clear_old_bss(iface->bss[j]);
+}
+
+
+#ifndef CONFIG_NO_RADIUS
+static void hostapd_reload_keep_radius_server(struct hostapd_radius_servers *old,
+					      struct hostapd_radius_servers *new)
+{
+	/* Continue using the currently selected (possibly backup) servers */
+	if (old->auth_server && new->num_auth_servers == old->num_auth_servers)
+		new->auth_server = new->auth_servers +
+			(old->auth_server - old->auth_servers);
+	if (old->acct_server && new->num_acct_servers == old->num_acct_servers)
+		new->acct_server = new->acct_servers +
+			(old->acct_server - old->acct_servers);
+}
+#endif /* CONFIG_NO_RADIUS */
+
+
+static int hostapd_reload_sta_psk_valid(struct hostapd_data *hapd,
+					struct sta_info *sta)
+{
+	struct hostapd_sta_wpa_psk_short *pos;
+	const u8 *pmk, *psk = NULL;
+	int pmk_len;
+
+	pmk = wpa_auth_get_pmk(sta->wpa_sm, &pmk_len);
+	if (!pmk || pmk_len != PMK_LEN)
+		return 0;
+
+	while ((psk = hostapd_get_psk(hapd->conf, sta->addr, NULL, psk))) {
+		if (os_memcmp_const(psk, pmk, PMK_LEN) == 0)
+			return 1;
+	}
+
+	/* PSKs received from the RADIUS server do not depend on the
+	 * configuration */
+	for (pos = sta->psk; pos; pos = pos->next) {
+		if (os_memcmp_const(pos->psk, pmk, PMK_LEN) == 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+/*
+ * Disconnect stations that use a PSK that is not in the reloaded
+ * configuration anymore. Stations for which the PSK cannot be verified (e.g.,
+ * after an FT roam from another AP) are disconnected as well. SAE stations are
+ * disconnected and the PMKSA cache is flushed if wpa_passphrase changed.
+ */
+static void hostapd_reload_check_psk(struct hostapd_data *hapd,
+				     struct hostapd_bss_config *old)
+{
+	struct hostapd_bss_config *conf = hapd->conf;
+	struct sta_info *sta;
+	int passphrase_changed, akm;
+
+	passphrase_changed = !old->ssid.wpa_passphrase !=
+		!conf->ssid.wpa_passphrase ||
+		(conf->ssid.wpa_passphrase &&
+		 os_strcmp(old->ssid.wpa_passphrase,
+			   conf->ssid.wpa_passphrase) != 0);
+	if (passphrase_changed && hapd->wpa_auth &&
+	    wpa_key_mgmt_sae(conf->wpa_key_mgmt))
+		wpa_auth_pmksa_flush(hapd->wpa_auth);
+
+	for (sta = hapd->sta_list; sta; sta = sta->next) {
+		if (!sta->wpa_sm)
+			continue;
+		akm = wpa_auth_sta_key_mgmt(sta->wpa_sm);
+		if (wpa_key_mgmt_sae(akm)) {
+			if (!passphrase_changed)
+				continue;
+		} else if (!wpa_key_mgmt_wpa_psk(akm) ||
+			   hostapd_reload_sta_psk_valid(hapd, sta)) {
+			continue;
+		}
+
+		wpa_printf(MSG_DEBUG, "Disconnect " MACSTR
+			   " since its PSK is not in the configuration anymore",
+			   MAC2STR(sta->addr));
+		ap_sta_disconnect(hapd, sta, sta->addr,
+				  WLAN_REASON_PREV_AUTH_NOT_VALID);
+	}
+}
+
+
+/*
+ * Take the new configuration into use for a BSS that does not need to be
+ * restarted. hapd->conf has already been replaced with the new configuration
+ * and old points to the previous configuration that is going to be freed.
+ */
+static void hostapd_reload_bss_changes(struct hostapd_data *hapd,
+				       struct hostapd_bss_config *old,
+				       unsigned int reconf)
+{
+	struct hostapd_bss_config *conf = hapd->conf;
+	struct sta_info *sta;
 
 #ifndef CONFIG_NO_RADIUS
-		/* TODO: update dynamic data based on changed configuration
-		 * items (e.g., open/close sockets, etc.) */
-		radius_client_flush(iface->bss[j]->radius, 0);
+	if (reconf & HOSTAPD_RECONF_RADIUS) {
+		if (radius_client_reconfig_servers(hapd->radius,
+						   conf->radius) < 0 &&
+		    hapd->radius)
+			wpa_printf(MSG_ERROR,
+				   "Failed to re-configure RADIUS servers after reloading configuration");
+	} else {
+		hostapd_reload_keep_radius_server(old->radius, conf->radius);
+		radius_client_reconfig(hapd->radius, conf->radius);
+	}
 #endif /* CONFIG_NO_RADIUS */
+
+	if (!hapd->started)
+		return;
+
+	if (!(reconf & HOSTAPD_RECONF_PSK)) {
+		/* Avoid deriving the PSK(s) again */
+		hostapd_config_clear_wpa_psk(&conf->ssid.wpa_psk);
+		conf->ssid.wpa_psk = old->ssid.wpa_psk;
+		old->ssid.wpa_psk = NULL;
+	} else {
+		if (hostapd_setup_wpa_psk(conf))
+			wpa_printf(MSG_ERROR, "Failed to re-configure WPA PSK "
+				   "after reloading configuration");
+		hostapd_reload_check_psk(hapd, old);
+	}
+
+	if (hapd->wpa_auth) {
+		/* Update pointers to the new configuration data */
+		hostapd_update_wpa_conf(hapd);
+		if (reconf & HOSTAPD_RECONF_WPA) {
+			const u8 *wpa_ie;
+			size_t wpa_ie_len;
+
+			wpa_ie = wpa_auth_get_wpa_ie(hapd->wpa_auth,
+						     &wpa_ie_len);
+			if (hostapd_set_generic_elem(hapd, wpa_ie, wpa_ie_len))
+				wpa_printf(MSG_ERROR, "Failed to configure WPA IE for "
+					   "the kernel driver.");
+			reconf |= HOSTAPD_RECONF_BEACON;
+		}
 	}
+
+	if (reconf & HOSTAPD_RECONF_ACL) {
+		hostapd_set_acl(hapd);
+		for (sta = hapd->sta_list; sta; sta = sta->next) {
+			struct vlan_description vlan_id;
+
+			if (hostapd_check_acl(hapd, sta->addr, &vlan_id) ==
+			    HOSTAPD_ACL_REJECT)
+				ap_sta_disconnect(hapd, sta, sta->addr,
+						  WLAN_REASON_UNSPECIFIED);
+		}
+	}
+
+	if (reconf & HOSTAPD_RECONF_BEACON)
+		ieee802_11_set_beacon(hapd);
+
+	if (reconf & HOSTAPD_RECONF_WPS)
+		hostapd_update_wps(hapd);
+
+	wpa_printf(MSG_DEBUG, "Updated configuration for interface %s",
+		   conf->iface);
+}
+
+
+static void hostapd_reload_iconf(struct hostapd_data *hapd,
+				 struct hostapd_config *newconf,
+				 struct hostapd_config *oldconf)
+{
+	hapd->iconf = newconf;
+	hapd->iconf->channel = oldconf->channel;
+	hapd->iconf->acs = oldconf->acs;
+	hapd->iconf->secondary_channel = oldconf->secondary_channel;
+	hapd->iconf->ieee80211n = oldconf->ieee80211n;
+	hapd->iconf->ieee80211ac = oldconf->ieee80211ac;
+	hapd->iconf->ht_capab = oldconf->ht_capab;
+	hapd->iconf->vht_capab = oldconf->vht_capab;
+	hapd->iconf->vht_oper_chwidth = oldconf->vht_oper_chwidth;
+	hapd->iconf->vht_oper_centr_freq_seg0_idx =
+		oldconf->vht_oper_centr_freq_seg0_idx;
+	hapd->iconf->vht_oper_centr_freq_seg1_idx =
+		oldconf->vht_oper_centr_freq_seg1_idx;
+}
+
+
+#define HOSTAPD_RELOAD_CHANGED_LEN 256
+
+static void hostapd_reload_report(struct hostapd_data *hapd,
+				  unsigned int reconf, const char *changed)
+{
+	char applied[100];
+
+	if (reconf)
+		hostapd_config_reconf_txt(reconf, applied, sizeof(applied));
+	else
+		os_strlcpy(applied, "none", sizeof(applied));
+	wpa_printf(MSG_INFO, "%s: Configuration reloaded (applied=%s%s%s)",
+		   hapd->conf->iface, applied, changed[0] ? " changed=" : "",
+		   changed);
+	wpa_msg(hapd->msg_ctx, MSG_INFO, AP_CONFIG_RELOADED "applied=%s%s%s",
+		applied, changed[0] ? " changed=" : "", changed);
 }
 
 
@@ -164,6 +375,9 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 {
 	struct hostapd_data *hapd = iface->bss[0];
 	struct hostapd_config *newconf, *oldconf;
+	struct hostapd_bss_config *old;
+	unsigned int *reconf = NULL, all = 0;
+	char **changed = NULL;
 	size_t j;
 
 	if (iface->config_fname == NULL) {
@@ -181,32 +395,66 @@ int hostapd_reload_config(struct hostapd_iface *iface)
 	if (newconf == NULL)
 		return -1;
 
-	hostapd_clear_old(iface);
+	/*
+	 * Determine which parts of the configuration changed for each BSS to
+	 * avoid disconnecting stations when that is not needed.
+	 */
+	if (newconf->num_bss == iface->num_bss) {
+		reconf = os_calloc(iface->num_bss, sizeof(*reconf));
+		changed = os_calloc(iface->num_bss, sizeof(char *));
+	}
+	for (j = 0; reconf && changed && j < iface->num_bss; j++) {
+		changed[j] = os_zalloc(HOSTAPD_RELOAD_CHANGED_LEN);
+		if (!changed[j]) {
+			all |= HOSTAPD_RECONF_IFACE;
+			break;
+		}
+		reconf[j] = hostapd_config_diff_bss(iface->bss[j]->conf,
+						    newconf->bss[j], changed[j],
+						    HOSTAPD_RELOAD_CHANGED_LEN);
+		all |= reconf[j];
+	}
+	if (!reconf || !changed)
+		all |= HOSTAPD_RECONF_IFACE;
+
+	if (all & HOSTAPD_RECONF_IFACE) {
+		hostapd_clear_old(iface);
+	} else {
+		for (j = 0; j < iface->num_bss; j++) {
+			if (reconf[j] & HOSTAPD_RECONF_BSS)
+				hostapd_clear_old_bss(iface->bss[j]);
+		}
+	}
 
 	oldconf = hapd->iconf;
 	iface->conf = newconf;
 
 	for (j = 0; j < iface->num_bss; j++) {
 		hapd = iface->bss[j];
-		hapd->iconf = newconf;
-		hapd->iconf->channel = oldconf->channel;
-		hapd->iconf->acs = oldconf->acs;
-		hapd->iconf->secondary_channel = oldconf->secondary_channel;
-		hapd->iconf->ieee80211n = oldconf->ieee80211n;
-		hapd->iconf->ieee80211ac = oldconf->ieee80211ac;
-		hapd->iconf->ht_capab = oldconf->ht_capab;
-		hapd->iconf->vht_capab = oldconf->vht_capab;
-		hapd->iconf->vht_oper_chwidth = oldconf->vht_oper_chwidth;
-		hapd->iconf->vht_oper_centr_freq_seg0_idx =
-			oldconf->vht_oper_centr_freq_seg0_idx;
-		hapd->iconf->vht_oper_centr_freq_seg1_idx =
-			oldconf->vht_oper_centr_freq_seg1_idx;
+		old = hapd->conf;
+		hostapd_reload_iconf(hapd, newconf, oldconf);
 		hapd->conf = newconf->bss[j];
-		hostapd_reload_bss(hapd);
+		if (all & HOSTAPD_RECONF_IFACE) {
+			hostapd_reload_bss(hapd);
+			hostapd_reload_report(hapd, HOSTAPD_RECONF_IFACE,
+					      changed && changed[j] ?
+					      changed[j] : "");
+			continue;
+		}
+
+		if (reconf[j] & HOSTAPD_RECONF_BSS)
+			hostapd_reload_bss(hapd);
+		else
+			hostapd_reload_bss_changes(hapd, old, reconf[j]);
+		hostapd_reload_report(hapd, reconf[j], changed[j]);
 	}
 
 	hostapd_config_free(oldconf);
 
+	for (j = 0; changed && j < iface->num_bss; j++)
+		os_free(changed[j]);
+	os_free(changed);
+	os_free(reconf);
 
 	return 0;
 }
@@ -896,6 +1144,58 @@ hostapd_das_disconnect(void *ctx, struct radius_das_attrs *attr)
 #endif /* CONFIG_NO_RADIUS */
 
 
+/**
+ * hostapd_startup_us - Get time elapsed since a startup phase started
+ * @start: Start time of the phase
+ * Returns: Elapsed time in microseconds
+ */
+unsigned int hostapd_startup_us(struct os_reltime *start)
+{
+	struct os_reltime age;
+
+	os_reltime_age(start, &age);
+	return age.sec * 1000000 + age.usec;
+}
+
+
+static void hostapd_startup_report(struct hostapd_iface *iface)
+{
+	struct hostapd_startup_timing *t = &iface->startup;
+	const struct {
+		const char *name;
+		unsigned int us;
+	} phases[] = {
+		{ "total", hostapd_startup_us(&t->start) },
+		{ "prepare", t->prepare },
+		{ "driver", t->driver },
+		{ "channel", t->channel },
+		{ "bss", t->bss },
+		{ "radius", t->radius },
+		{ "auth", t->auth },
+		{ "beacon", t->beacon },
+		{ "commit", t->commit },
+	};
+	char buf[300], *pos = buf, *end = buf + sizeof(buf);
+	size_t i;
+	int res;
+
+	buf[0] = '\0';
+	for (i = 0; i < ARRAY_SIZE(phases); i++) {
+		res = os_snprintf(pos, end - pos, " %s=%u.%03u", phases[i].name,
+				  phases[i].us / 1000, phases[i].us % 1000);
+		if (os_snprintf_error(end - pos, res))
+			break;
+		pos += res;
+	}
+	wpa_printf(MSG_INFO, "%s: Startup timing (ms):%s num_bss=%u",
+		   iface->bss[0]->conf->iface, buf,
+		   (unsigned int) iface->num_bss);
+
+	/* Start the next measurement from scratch */
+	os_memset(t, 0, sizeof(*t));
+}
+
+
 /**
  * hostapd_setup_bss - Per-BSS setup (initialization)
  * @hapd: Pointer to BSS data
@@ -915,6 +1215,7 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 	char force_ifname[IFNAMSIZ];
 	u8 if_addr[ETH_ALEN];
 	int flush_old_stations = 1;
+	struct os_reltime phase;
 
 	wpa_printf(MSG_DEBUG, "%s(hapd=%p (%s), first=%d)",
 		   __func__, hapd, conf->iface, first);
@@ -1046,6 +1347,7 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 	if (wpa_debug_level <= MSG_MSGDUMP)
 		conf->radius->msg_dumps = 1;
 #ifndef CONFIG_NO_RADIUS
+	os_get_reltime(&phase);
 	hapd->radius = radius_client_init(hapd, conf->radius);
 	if (hapd->radius == NULL) {
 		wpa_printf(MSG_ERROR, "RADIUS client initialization failed.");
@@ -1074,8 +1376,10 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 			return -1;
 		}
 	}
+	hapd->iface->startup.radius += hostapd_startup_us(&phase);
 #endif /* CONFIG_NO_RADIUS */
 
+	os_get_reltime(&phase);
 	if (hostapd_acl_init(hapd)) {
 		wpa_printf(MSG_ERROR, "ACL initialization failed.");
 		return -1;
@@ -1101,6 +1405,7 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 
 	if ((conf->wpa || conf->osen) && hostapd_setup_wpa(hapd))
 		return -1;
+	hapd->iface->startup.auth += hostapd_startup_us(&phase);
 
 	if (accounting_init(hapd)) {
 		wpa_printf(MSG_ERROR, "Accounting initialization failed.");
@@ -1158,8 +1463,10 @@ static int hostapd_setup_bss(struct hostapd_data *hapd, int first)
 		return -1;
 	}
 
+	os_get_reltime(&phase);
 	if (!conf->start_disabled && ieee802_11_set_beacon(hapd) < 0)
 		return -1;
+	hapd->iface->startup.beacon += hostapd_startup_us(&phase);
 
 	if (hapd->wpa_auth && wpa_init_keys(hapd->wpa_auth) < 0)
 		return -1;
@@ -1688,10 +1995,12 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 	u8 *prev_addr;
 	int delay_apply_cfg = 0;
 	int res_dfs_offload = 0;
+	struct os_reltime phase;
 
 	if (err)
 		goto fail;
 
+	iface->startup.channel = hostapd_startup_us(&iface->startup.setup_start);
 	wpa_printf(MSG_DEBUG, "Completing interface initialization");
 	if (iface->conf->channel) {
 #ifdef NEED_AP_MLME
@@ -1785,6 +2094,7 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 
 	prev_addr = hapd->own_addr;
 
+	os_get_reltime(&phase);
 	for (j = 0; j < iface->num_bss; j++) {
 		hapd = iface->bss[j];
 		if (j)
@@ -1801,6 +2111,7 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 			prev_addr = hapd->own_addr;
 	}
 	hapd = iface->bss[0];
+	iface->startup.bss = hostapd_startup_us(&phase);
 
 	hostapd_tx_queue_params(iface);
 
@@ -1808,11 +2119,13 @@ static int hostapd_setup_interface_complete_sync(struct hostapd_iface *iface,
 
 	hostapd_set_acl(hapd);
 
+	os_get_reltime(&phase);
 	if (hostapd_driver_commit(hapd) < 0) {
 		wpa_printf(MSG_ERROR, "%s: Failed to commit driver "
 			   "configuration", __func__);
 		goto fail;
 	}
+	iface->startup.commit = hostapd_startup_us(&phase);
 
 	/*
 	 * WPS UPnP module can be initialized only when the "upnp_iface" is up.
@@ -1861,6 +2174,7 @@ dfs_offload:
 
 	wpa_printf(MSG_DEBUG, "%s: Setup of interface done.",
 		   iface->bss[0]->conf->iface);
+	hostapd_startup_report(iface);
 	if (iface->interfaces && iface->interfaces->terminate_on_error > 0)
 		iface->interfaces->terminate_on_error--;
 
@@ -1968,6 +2282,63 @@ int hostapd_setup_interface_complete(struct hostapd_iface *iface, int err)
 }
 
 
+/*
+ * Maximum number of worker threads for startup preparation with
+ * CONFIG_PARALLEL_STARTUP=y
+ */
+#define HOSTAPD_STARTUP_MAX_THREADS 16
+
+/**
+ * hostapd_prepare_interfaces - Prepare interfaces for setup
+ * @interfaces: Interfaces that are going to be set up
+ * Returns: 0 on success, -1 on failure
+ *
+ * This performs operations that do not depend on the driver for all BSSs of
+ * all interfaces in one go before the interfaces are set up one by one. This
+ * is currently used to derive the passphrase based PSKs, which can be done in
+ * parallel.
+ */
+int hostapd_prepare_interfaces(struct hapd_interfaces *interfaces)
+{
+	struct hostapd_bss_config **bss;
+	struct hostapd_config *conf;
+	struct os_reltime start;
+	size_t i, j, num_bss = 0;
+	int res;
+
+	for (i = 0; i < interfaces->count; i++)
+		num_bss += interfaces->iface[i]->conf->num_bss;
+	if (num_bss == 0)
+		return 0;
+
+	bss = os_calloc(num_bss, sizeof(*bss));
+	if (!bss)
+		return -1;
+	num_bss = 0;
+	for (i = 0; i < interfaces->count; i++) {
+		conf = interfaces->iface[i]->conf;
+		for (j = 0; j < conf->num_bss; j++)
+			bss[num_bss++] = conf->bss[j];
+	}
+
+	os_get_reltime(&start);
+	res = hostapd_config_derive_psks(bss, num_bss,
+					 HOSTAPD_STARTUP_MAX_THREADS);
+	os_free(bss);
+	if (res < 0) {
+		wpa_printf(MSG_ERROR, "Failed to derive WPA PSKs");
+		return -1;
+	}
+	if (res > 0)
+		wpa_printf(MSG_INFO,
+			   "Startup preparation: derived %d PSK(s) in %u.%03u ms",
+			   res, hostapd_startup_us(&start) / 1000,
+			   hostapd_startup_us(&start) % 1000);
+
+	return 0;
+}
+
+
 /**
  * hostapd_setup_interface - Setup of an interface
  * @iface: Pointer to interface data.
@@ -1988,6 +2359,12 @@ int hostapd_setup_interface(struct hostapd_iface *iface)
 {
 	int ret;
 
+	if (!os_reltime_initialized(&iface->startup.start)) {
+		os_memset(&iface->startup, 0, sizeof(iface->startup));
+		os_get_reltime(&iface->startup.start);
+	}
+	os_get_reltime(&iface->startup.setup_start);
+
 	ret = setup_interface(iface);
 	if (ret) {
 		wpa_printf(MSG_ERROR, "%s: Unable to setup interface.",
@@ -11,6 +11,7 @@
 
 #include "common/defs.h"
 #include "utils/list.h"
+#include "utils/timer_list.h"
 #include "ap_config.h"
 #include "drivers/driver.h"
 
@@ -42,6 +43,7 @@ struct hapd_interfaces {
 	size_t count;
 	int global_ctrl_sock;
 	struct dl_list global_ctrl_dst;
+	struct ctrl_iface_event_ring *global_ctrl_events;
 	char *global_iface_path;
 	char *global_iface_name;
 #ifndef CONFIG_NATIVE_WINDOWS
@@ -105,6 +107,7 @@ struct wps_stat {
 
 struct hostapd_neighbor_entry {
 	struct dl_list list;
+	struct hostapd_neighbor_entry *hnext; /* next entry in hash table list */
 	u8 bssid[ETH_ALEN];
 	struct wpa_ssid_value ssid;
 	struct wpabuf *nr;
@@ -115,6 +118,12 @@ struct hostapd_neighbor_entry {
 	int stationary;
 };
 
+/* Neighbor Report elements encoded for requests for a specific SSID */
+struct hostapd_neighbor_report_cache {
+	struct wpa_ssid_value ssid;
+	struct wpabuf *elems;
+};
+
 /**
  * struct hostapd_data - hostapd per-BSS data structure
  */
@@ -171,6 +180,7 @@ struct hostapd_data {
 
 	int ctrl_sock;
 	struct dl_list ctrl_dst;
+	struct ctrl_iface_event_ring *ctrl_events;
 
 	void *ssl_ctx;
 	void *eap_sim_db_priv;
@@ -286,6 +296,8 @@ struct hostapd_data {
 	struct wpabuf *mesh_pending_auth;
 	struct os_reltime mesh_pending_auth_time;
 	u8 mesh_required_peer[ETH_ALEN];
+	u8 *mesh_llid_map; /* bitmap of Local Link IDs in use */
+	struct timer_list mesh_plink_timers; /* struct sta_info::plink_timer */
 #endif /* CONFIG_MESH */
 
 #ifdef CONFIG_SQLITE
@@ -316,6 +328,16 @@ struct hostapd_data {
 #endif /* CONFIG_MBO */
 
 	struct dl_list nr_db;
+#define NR_DB_HASH_SIZE 256
+	/* Neighbor APs often share the last octet (e.g., :00 for the first BSS
+	 * of each radio), so mix in the other vendor-assigned octets */
+#define NR_DB_HASH(bssid) ((bssid[3] + bssid[4] * 17 + bssid[5] * 131) & \
+			   (NR_DB_HASH_SIZE - 1))
+	struct hostapd_neighbor_entry *nr_db_hash[NR_DB_HASH_SIZE];
+#define NR_REPORT_CACHE_SIZE 4
+	struct hostapd_neighbor_report_cache nr_report_cache[
+		NR_REPORT_CACHE_SIZE];
+	unsigned int nr_report_cache_next;
 
 	u8 beacon_req_token;
 	u8 lci_req_token;
@@ -327,12 +349,18 @@ struct hostapd_data {
 
 #ifdef CONFIG_DPP
 	struct dl_list dpp_bootstrap; /* struct dpp_bootstrap_info */
+#define DPP_BOOTSTRAP_HASH_SIZE 1024
+#define DPP_BOOTSTRAP_HASH(hash) (WPA_GET_BE16(hash) & \
+				  (DPP_BOOTSTRAP_HASH_SIZE - 1))
+	struct dpp_bootstrap_info *dpp_bootstrap_hash[DPP_BOOTSTRAP_HASH_SIZE];
+	unsigned int dpp_bootstrap_max_id;
 	struct dl_list dpp_configurator; /* struct dpp_configurator */
 	int dpp_init_done;
-	struct dpp_authentication *dpp_auth;
+	/* Ongoing authentication exchanges, most recently started first */
+	struct dl_list dpp_auth; /* struct dpp_authentication */
+	unsigned int dpp_num_auth;
 	u8 dpp_allowed_roles;
 	int dpp_qr_mutual;
-	int dpp_auth_ok_on_ack;
 	struct gas_query_ap *gas;
 	struct dpp_pkex *dpp_pkex;
 	struct dpp_bootstrap_info *dpp_pkex_bi;
@@ -506,6 +534,20 @@ struct hostapd_iface {
 	unsigned int num_sta_seen;
 
 	u8 dfs_domain;
+
+	/* Duration of interface startup phases (in microseconds) */
+	struct hostapd_startup_timing {
+		struct os_reltime start; /* start of interface setup */
+		struct os_reltime setup_start; /* start of setup_interface() */
+		unsigned int prepare; /* hostapd_prepare_interfaces() */
+		unsigned int driver; /* driver initialization */
+		unsigned int channel; /* country, hw features, ACS, DFS */
+		unsigned int bss; /* hostapd_setup_bss() for all BSSs */
+		unsigned int radius; /* RADIUS client/DAS init within bss */
+		unsigned int auth; /* authenticator init within bss */
+		unsigned int beacon; /* Beacon setup within bss */
+		unsigned int commit; /* driver commit */
+	} startup;
 };
 
 /* hostapd.c */
@@ -517,6 +559,8 @@ struct hostapd_data *
 hostapd_alloc_bss_data(struct hostapd_iface *hapd_iface,
 		       struct hostapd_config *conf,
 		       struct hostapd_bss_config *bss);
+int hostapd_prepare_interfaces(struct hapd_interfaces *interfaces);
+unsigned int hostapd_startup_us(struct os_reltime *start);
 int hostapd_setup_interface(struct hostapd_iface *iface);
 int hostapd_setup_interface_complete(struct hostapd_iface *iface, int err);
 void hostapd_interface_deinit(struct hostapd_iface *iface);
@@ -607,8 +607,10 @@ void ieee802_1x_encapsulate_radius(struct hostapd_data *hapd,
 		   "packet");
 
 	sm->radius_identifier = radius_client_get_id(hapd->radius);
-	msg = radius_msg_new(RADIUS_CODE_ACCESS_REQUEST,
-			     sm->radius_identifier);
+	msg = radius_msg_new_len(RADIUS_CODE_ACCESS_REQUEST,
+				 sm->radius_identifier,
+				 RADIUS_EAP_ATTR_ESTIMATE +
+				 radius_msg_eap_len(len));
 	if (msg == NULL) {
 		wpa_printf(MSG_INFO, "Could not create new RADIUS packet");
 		return;
@@ -1731,6 +1733,10 @@ ieee802_1x_receive_auth(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_UNKNOWN;
 	}
 
+	/* msg is kept after returning; copy it out of the receive buffer */
+	if (radius_msg_own_buf(msg) < 0)
+		return RADIUS_RX_UNKNOWN;
+
 	sm->radius_identifier = -1;
 	wpa_printf(MSG_DEBUG, "RADIUS packet matching with station " MACSTR,
 		   MAC2STR(sta->addr));
@@ -20,8 +20,7 @@ hostapd_neighbor_get(struct hostapd_data *hapd, const u8 *bssid,
 {
 	struct hostapd_neighbor_entry *nr;
 
-	dl_list_for_each(nr, &hapd->nr_db, struct hostapd_neighbor_entry,
-			 list) {
+	for (nr = hapd->nr_db_hash[NR_DB_HASH(bssid)]; nr; nr = nr->hnext) {
 		if (os_memcmp(bssid, nr->bssid, ETH_ALEN) == 0 &&
 		    (!ssid ||
 		     (ssid->ssid_len == nr->ssid.ssid_len &&
@@ -33,6 +32,82 @@ hostapd_neighbor_get(struct hostapd_data *hapd, const u8 *bssid,
 }
 
 
+static void hostapd_neighbor_hash_del(struct hostapd_data *hapd,
+				      struct hostapd_neighbor_entry *nr)
+{
+	struct hostapd_neighbor_entry **pos;
+
+	for (pos = &hapd->nr_db_hash[NR_DB_HASH(nr->bssid)]; *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == nr) {
+			*pos = nr->hnext;
+			nr->hnext = NULL;
+			return;
+		}
+	}
+}
+
+
+static void hostapd_neighbor_report_cache_flush(struct hostapd_data *hapd)
+{
+	unsigned int i;
+
+	for (i = 0; i < NR_REPORT_CACHE_SIZE; i++) {
+		wpabuf_free(hapd->nr_report_cache[i].elems);
+		hapd->nr_report_cache[i].elems = NULL;
+	}
+}
+
+
+/**
+ * hostapd_neighbor_report_cache_get - Get cached Neighbor Report elements
+ * @hapd: BSS data
+ * @ssid: SSID from the Neighbor Report Request
+ * Returns: Neighbor Report elements for the neighbors with the specified SSID
+ * or %NULL if not cached
+ *
+ * The cache is cleared whenever the neighbor database is modified.
+ */
+const struct wpabuf *
+hostapd_neighbor_report_cache_get(struct hostapd_data *hapd,
+				  const struct wpa_ssid_value *ssid)
+{
+	struct hostapd_neighbor_report_cache *c;
+	unsigned int i;
+
+	for (i = 0; i < NR_REPORT_CACHE_SIZE; i++) {
+		c = &hapd->nr_report_cache[i];
+		if (c->elems && c->ssid.ssid_len == ssid->ssid_len &&
+		    os_memcmp(c->ssid.ssid, ssid->ssid, ssid->ssid_len) == 0)
+			return c->elems;
+	}
+	return NULL;
+}
+
+
+/**
+ * hostapd_neighbor_report_cache_set - Cache Neighbor Report elements
+ * @hapd: BSS data
+ * @ssid: SSID from the Neighbor Report Request
+ * @elems: Neighbor Report elements; the cache takes ownership of the buffer
+ *
+ * The oldest cached SSID is replaced if all cache entries are in use.
+ */
+void hostapd_neighbor_report_cache_set(struct hostapd_data *hapd,
+				       const struct wpa_ssid_value *ssid,
+				       struct wpabuf *elems)
+{
+	struct hostapd_neighbor_report_cache *c;
+
+	c = &hapd->nr_report_cache[hapd->nr_report_cache_next];
+	hapd->nr_report_cache_next = (hapd->nr_report_cache_next + 1) %
+		NR_REPORT_CACHE_SIZE;
+	wpabuf_free(c->elems);
+	os_memcpy(&c->ssid, ssid, sizeof(c->ssid));
+	c->elems = elems;
+}
+
+
 static void hostapd_neighbor_clear_entry(struct hostapd_neighbor_entry *nr)
 {
 	wpabuf_free(nr->nr);
@@ -48,7 +123,7 @@ static void hostapd_neighbor_clear_entry(struct hostapd_neighbor_entry *nr)
 
 
 static struct hostapd_neighbor_entry *
-hostapd_neighbor_add(struct hostapd_data *hapd)
+hostapd_neighbor_add(struct hostapd_data *hapd, const u8 *bssid)
 {
 	struct hostapd_neighbor_entry *nr;
 
@@ -57,6 +132,8 @@ hostapd_neighbor_add(struct hostapd_data *hapd)
 		return NULL;
 
 	dl_list_add(&hapd->nr_db, &nr->list);
+	nr->hnext = hapd->nr_db_hash[NR_DB_HASH(bssid)];
+	hapd->nr_db_hash[NR_DB_HASH(bssid)] = nr;
 
 	return nr;
 }
@@ -69,9 +146,11 @@ int hostapd_neighbor_set(struct hostapd_data *hapd, const u8 *bssid,
 {
 	struct hostapd_neighbor_entry *entry;
 
+	hostapd_neighbor_report_cache_flush(hapd);
+
 	entry = hostapd_neighbor_get(hapd, bssid, ssid);
 	if (!entry)
-		entry = hostapd_neighbor_add(hapd);
+		entry = hostapd_neighbor_add(hapd, bssid);
 	if (!entry)
 		return -1;
 
@@ -115,6 +194,8 @@ int hostapd_neighbor_remove(struct hostapd_data *hapd, const u8 *bssid,
 	if (!nr)
 		return -1;
 
+	hostapd_neighbor_report_cache_flush(hapd);
+	hostapd_neighbor_hash_del(hapd, nr);
 	hostapd_neighbor_clear_entry(nr);
 	dl_list_del(&nr->list);
 	os_free(nr);
@@ -133,4 +214,6 @@ void hostpad_free_neighbor_db(struct hostapd_data *hapd)
 		dl_list_del(&nr->list);
 		os_free(nr);
 	}
+	os_memset(hapd->nr_db_hash, 0, sizeof(hapd->nr_db_hash));
+	hostapd_neighbor_report_cache_flush(hapd);
 }
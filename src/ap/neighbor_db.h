@@ -20,5 +20,11 @@ int hostapd_neighbor_set(struct hostapd_data *hapd, const u8 *bssid,
 int hostapd_neighbor_remove(struct hostapd_data *hapd, const u8 *bssid,
 			    const struct wpa_ssid_value *ssid);
 void hostpad_free_neighbor_db(struct hostapd_data *hapd);
+const struct wpabuf *
+hostapd_neighbor_report_cache_get(struct hostapd_data *hapd,
+				  const struct wpa_ssid_value *ssid);
+void hostapd_neighbor_report_cache_set(struct hostapd_data *hapd,
+				       const struct wpa_ssid_value *ssid,
+				       struct wpabuf *elems);
 
 #endif /* NEIGHBOR_DB_H */
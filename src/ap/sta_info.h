@@ -15,6 +15,7 @@
 #endif /* CONFIG_MESH */
 
 #include "list.h"
+#include "timer_list.h"
 #include "vlan.h"
 #include "common/wpa_common.h"
 #include "common/ieee802_11_defs.h"
@@ -85,6 +86,7 @@ struct sta_info {
 	u16 peer_aid;
 	u16 mpm_close_reason;
 	int mpm_retries;
+	struct timer_list_entry plink_timer; /* hapd->mesh_plink_timers */
 	u8 my_nonce[WPA_NONCE_LEN];
 	u8 peer_nonce[WPA_NONCE_LEN];
 	u8 aek[32];	/* SHA256 digest length */
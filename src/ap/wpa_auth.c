@@ -12,6 +12,7 @@
 #include "utils/eloop.h"
 #include "utils/state_machine.h"
 #include "utils/bitfield.h"
+#include "utils/mem_pool.h"
 #include "common/ieee802_11_defs.h"
 #include "crypto/aes.h"
 #include "crypto/aes_wrap.h"
@@ -62,6 +63,10 @@ static void wpa_group_put(struct wpa_authenticator *wpa_auth,
 			  struct wpa_group *group);
 static u8 * ieee80211w_kde_add(struct wpa_state_machine *sm, u8 *pos);
 
+static struct mem_pool wpa_sm_pool =
+	MEM_POOL_INIT("wpa_state_machine", sizeof(struct wpa_state_machine),
+		      16);
+
 static const u32 eapol_key_timeout_first = 100; /* ms */
 static const u32 eapol_key_timeout_subseq = 1000; /* ms */
 static const u32 eapol_key_timeout_first_group = 500; /* ms */
@@ -574,6 +579,32 @@ int wpa_reconfig(struct wpa_authenticator *wpa_auth,
 }
 
 
+/**
+ * wpa_auth_update_conf - Update WPA authenticator configuration parameters
+ * @wpa_auth: Pointer to WPA authenticator data from wpa_init()
+ * @conf: Configuration for WPA authenticator
+ * Returns: 0 on success, -1 on failure
+ *
+ * This is similar to wpa_reconfig(), but does not reinitialize the GTK. It can
+ * be used when the changes in the configuration do not affect the ciphers or
+ * key management, so that the associated stations can remain connected.
+ */
+int wpa_auth_update_conf(struct wpa_authenticator *wpa_auth,
+			 struct wpa_auth_config *conf)
+{
+	if (wpa_auth == NULL)
+		return 0;
+
+	os_memcpy(&wpa_auth->conf, conf, sizeof(*conf));
+	if (wpa_auth_gen_wpa_ie(wpa_auth)) {
+		wpa_printf(MSG_ERROR, "Could not generate WPA IE.");
+		return -1;
+	}
+
+	return 0;
+}
+
+
 struct wpa_state_machine *
 wpa_auth_sta_init(struct wpa_authenticator *wpa_auth, const u8 *addr,
 		  const u8 *p2p_dev_addr)
@@ -583,7 +614,7 @@ wpa_auth_sta_init(struct wpa_authenticator *wpa_auth, const u8 *addr,
 	if (wpa_auth->group->wpa_group_state == WPA_GROUP_FATAL_FAILURE)
 		return NULL;
 
-	sm = os_zalloc(sizeof(struct wpa_state_machine));
+	sm = mem_pool_alloc(&wpa_sm_pool);
 	if (sm == NULL)
 		return NULL;
 	os_memcpy(sm->addr, addr, ETH_ALEN);
@@ -684,7 +715,7 @@ static void wpa_free_sta_sm(struct wpa_state_machine *sm)
 	os_free(sm->last_rx_eapol_key);
 	os_free(sm->wpa_ie);
 	wpa_group_put(sm->wpa_auth, sm->group);
-	os_free(sm);
+	mem_pool_free(&wpa_sm_pool, sm);
 }
 
 
@@ -3906,6 +3937,15 @@ int wpa_auth_get_pairwise(struct wpa_state_machine *sm)
 }
 
 
+const u8 * wpa_auth_get_pmk(struct wpa_state_machine *sm, int *len)
+{
+	if (!sm)
+		return NULL;
+	*len = sm->pmk_len;
+	return sm->PMK;
+}
+
+
 int wpa_auth_sta_key_mgmt(struct wpa_state_machine *sm)
 {
 	if (sm == NULL)
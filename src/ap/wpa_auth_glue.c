@@ -972,6 +972,14 @@ void hostapd_reconfig_wpa(struct hostapd_data *hapd)
 }
 
 
+int hostapd_update_wpa_conf(struct hostapd_data *hapd)
+{
+	struct wpa_auth_config wpa_auth_conf;
+	hostapd_wpa_auth_conf(hapd->conf, hapd->iconf, &wpa_auth_conf);
+	return wpa_auth_update_conf(hapd->wpa_auth, &wpa_auth_conf);
+}
+
+
 void hostapd_deinit_wpa(struct hostapd_data *hapd)
 {
 	ieee80211_tkip_countermeasures_deinit(hapd);
@@ -11,6 +11,7 @@
 
 int hostapd_setup_wpa(struct hostapd_data *hapd);
 void hostapd_reconfig_wpa(struct hostapd_data *hapd);
+int hostapd_update_wpa_conf(struct hostapd_data *hapd);
 void hostapd_deinit_wpa(struct hostapd_data *hapd);
 
 #endif /* WPA_AUTH_GLUE_H */
@@ -10,6 +10,10 @@
 #include "utils/includes.h"
 #include <netdb.h>
 #include <sys/un.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/sockios.h>
+#endif /* __linux__ */
 
 #include "utils/common.h"
 #include "ctrl_iface_common.h"
@@ -171,3 +175,565 @@ int ctrl_iface_level(struct dl_list *ctrl_dst, struct sockaddr_storage *from,
 
 	return -1;
 }
+
+
+int ctrl_iface_event_ring_init(struct ctrl_iface_event_ring *ring,
+			       size_t size)
+{
+	os_memset(ring, 0, sizeof(*ring));
+	ring->events = os_calloc(size, sizeof(struct ctrl_iface_event *));
+	if (!ring->events)
+		return -1;
+	ring->size = size;
+	ring->next_seq = 1;
+	return 0;
+}
+
+
+void ctrl_iface_event_ring_deinit(struct ctrl_iface_event_ring *ring)
+{
+	size_t i;
+
+	for (i = 0; i < ring->count; i++)
+		os_free(ring->events[(ring->start + i) % ring->size]);
+	os_free(ring->events);
+	os_memset(ring, 0, sizeof(*ring));
+}
+
+
+static struct ctrl_iface_event *
+ctrl_iface_event_get(struct ctrl_iface_event_ring *ring, u64 seq)
+{
+	u64 oldest = ring->next_seq - ring->count;
+
+	if (seq < oldest || seq >= ring->next_seq)
+		return NULL;
+	return ring->events[(ring->start + (seq - oldest)) % ring->size];
+}
+
+
+/**
+ * ctrl_iface_event_wanted - Check whether an event needs to be buffered
+ * @ctrl_dst: List of attached monitors
+ * @ring: Event buffer for the control interface or %NULL if not yet allocated
+ * @level: Priority level of the event
+ * Returns: 1 if the event needs to be buffered or 0 if not
+ *
+ * Events are buffered for the attached monitors that accept the level. Without
+ * such monitors, events that would be delivered to a monitor with the default
+ * level are buffered only for CTRL_IFACE_EVENT_RESUME_TIME seconds after a
+ * monitor detached so that it can resume from the last event it received after
+ * reconnecting.
+ */
+int ctrl_iface_event_wanted(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring, int level)
+{
+	struct wpa_ctrl_dst *dst;
+	struct os_reltime now;
+
+	dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+		if (level >= dst->debug_level)
+			return 1;
+	}
+
+	if (level < MSG_INFO || !ring ||
+	    !os_reltime_initialized(&ring->last_detach))
+		return 0;
+	os_get_reltime(&now);
+	return !os_reltime_expired(&now, &ring->last_detach,
+				   CTRL_IFACE_EVENT_RESUME_TIME);
+}
+
+
+void ctrl_iface_event_add(struct ctrl_iface_event_ring *ring, int level,
+			  const char *buf, size_t len)
+{
+	struct ctrl_iface_event *ev;
+
+	if (!ring->size)
+		return;
+
+	ev = os_malloc(sizeof(*ev) + len);
+	if (!ev)
+		return;
+	ev->seq = ring->next_seq++;
+	ev->level = level;
+	ev->len = len;
+	os_memcpy(ev + 1, buf, len);
+
+	if (ring->count == ring->size) {
+		/* Monitors that have not yet received this will see a gap */
+		os_free(ring->events[ring->start]);
+		ring->start = (ring->start + 1) % ring->size;
+		ring->count--;
+	}
+	ring->events[(ring->start + ring->count) % ring->size] = ev;
+	ring->count++;
+}
+
+
+/**
+ * ctrl_iface_event_attach - Attach a monitor with event delivery parameters
+ * @ctrl_dst: List of attached monitors
+ * @ring: Event buffer for the control interface
+ * @from: Address of the monitor
+ * @fromlen: Length of the address
+ * @params: Space separated parameters or %NULL
+ * Returns: 0 on success or -1 on failure
+ *
+ * Supported parameters:
+ * seq - prefix events with their sequence number ("<level:seq>")
+ * batch=<max> - deliver up to <max> newline separated events per datagram
+ * resume=<seq> - start delivery from a buffered event with sequence number
+ *	<seq> instead of the next new event
+ */
+int ctrl_iface_event_attach(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring,
+			    struct sockaddr_storage *from, socklen_t fromlen,
+			    const char *params)
+{
+	struct wpa_ctrl_dst *dst;
+	const char *pos = params;
+	int show_seq = 0, max_batch = 1;
+	u64 next_seq = ring->next_seq;
+	char *end;
+
+	while (pos && *pos) {
+		if (*pos == ' ') {
+			pos++;
+			continue;
+		}
+		if (os_strncmp(pos, "seq", 3) == 0 &&
+		    (pos[3] == ' ' || pos[3] == '\0')) {
+			show_seq = 1;
+		} else if (os_strncmp(pos, "batch=", 6) == 0) {
+			max_batch = atoi(pos + 6);
+			if (max_batch < 1)
+				return -1;
+		} else if (os_strncmp(pos, "resume=", 7) == 0) {
+			next_seq = strtoull(pos + 7, &end, 10);
+			if (end == pos + 7 || (*end != ' ' && *end != '\0'))
+				return -1;
+			if (next_seq < 1)
+				next_seq = 1;
+			if (next_seq > ring->next_seq)
+				next_seq = ring->next_seq;
+		} else {
+			return -1;
+		}
+		pos = os_strchr(pos, ' ');
+	}
+
+	if (ctrl_iface_attach(ctrl_dst, from, fromlen) < 0)
+		return -1;
+	dst = dl_list_first(ctrl_dst, struct wpa_ctrl_dst, list);
+	dst->show_seq = show_seq;
+	dst->max_batch = max_batch;
+	dst->next_seq = next_seq;
+	return 0;
+}
+
+
+/**
+ * ctrl_iface_event_detach - Detach a monitor
+ * @ctrl_dst: List of attached monitors
+ * @ring: Event buffer for the control interface
+ * @from: Address of the monitor
+ * @fromlen: Length of the address
+ * Returns: 0 on success or -1 if the monitor was not attached
+ */
+int ctrl_iface_event_detach(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring,
+			    struct sockaddr_storage *from, socklen_t fromlen)
+{
+	struct wpa_ctrl_dst *dst;
+
+	dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+		if (ring && !sockaddr_compare(from, fromlen,
+					      &dst->addr, dst->addrlen)) {
+			/* Unread events remain queued for the socket */
+			ring->detached_in_flight += dst->in_flight;
+			break;
+		}
+	}
+
+	if (ctrl_iface_detach(ctrl_dst, from, fromlen) < 0)
+		return -1;
+	if (ring)
+		os_get_reltime(&ring->last_detach);
+	return 0;
+}
+
+
+static size_t ctrl_iface_event_hdr(struct wpa_ctrl_dst *dst,
+				   const struct ctrl_iface_event *ev,
+				   char *buf, size_t buflen)
+{
+	int res;
+
+	if (dst->show_seq)
+		res = os_snprintf(buf, buflen, "<%d:%llu>", ev->level,
+				  (unsigned long long) ev->seq);
+	else
+		res = os_snprintf(buf, buflen, "<%d>", ev->level);
+	if (os_snprintf_error(buflen, res))
+		return 0;
+	return res;
+}
+
+
+static int ctrl_iface_event_outq(int sock)
+{
+#ifdef SIOCOUTQ
+	int outq;
+
+	if (ioctl(sock, SIOCOUTQ, &outq) == 0 && outq >= 0)
+		return outq;
+#endif /* SIOCOUTQ */
+	return -1;
+}
+
+
+/**
+ * ctrl_iface_event_in_flight - Update the per-monitor send buffer use
+ * @ctrl_dst: List of attached monitors
+ * @ring: Event buffer for the control interface
+ * @sent: Monitor that the last datagram was sent to or %NULL
+ * @outq: Current send buffer use of the control interface socket
+ *
+ * Monitors that are connected to the control interface socket are not limited
+ * by the receive queue length and all the datagrams that they have not yet
+ * read are charged to the one socket, so the kernel reports only the total.
+ * Growth is charged to the monitor that was sent to and the data that has been
+ * read is credited first to the detached monitors and then to the monitors
+ * that were sent to most recently. A monitor that does not read its events
+ * stops being sent to once it reaches its limit, so after that the monitors
+ * that keep up with the events get the credit for what they read.
+ */
+static void ctrl_iface_event_in_flight(struct dl_list *ctrl_dst,
+				       struct ctrl_iface_event_ring *ring,
+				       struct wpa_ctrl_dst *sent, int outq)
+{
+	struct wpa_ctrl_dst *dst, *newest, *oldest = NULL;
+	size_t total = ring->detached_in_flight, drained, used;
+
+	if (outq < 0)
+		return;
+
+	dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+		/*
+		 * A monitor that has read the probe datagram has also read
+		 * all the earlier ones sent to it.
+		 */
+		if (!sent && dst->probe_len &&
+		    (size_t) outq + dst->probe_len <= dst->probe_outq) {
+			dst->in_flight = 0;
+			dst->probe_len = 0;
+		}
+		total += dst->in_flight;
+		if (!oldest || dst->last_send < oldest->last_send)
+			oldest = dst;
+	}
+	if ((size_t) outq >= total) {
+		/*
+		 * Use that is not from the monitor that was sent to is most
+		 * likely from the one that has not been able to get events for
+		 * the longest time.
+		 */
+		if (sent)
+			sent->in_flight += outq - total;
+		else if (oldest)
+			oldest->in_flight += outq - total;
+		return;
+	}
+
+	drained = total - outq;
+	used = drained < ring->detached_in_flight ?
+		drained : ring->detached_in_flight;
+	ring->detached_in_flight -= used;
+	drained -= used;
+
+	while (drained) {
+		newest = NULL;
+		dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+			if (dst->in_flight &&
+			    (!newest || dst->last_send > newest->last_send))
+				newest = dst;
+		}
+		if (!newest)
+			break;
+		used = drained < newest->in_flight ?
+			drained : newest->in_flight;
+		newest->in_flight -= used;
+		drained -= used;
+	}
+}
+
+
+/* Returns 1 if events remain pending, 0 if not, -1 if dst is to be removed */
+static int ctrl_iface_event_send(int sock, struct dl_list *ctrl_dst,
+				 struct wpa_ctrl_dst *dst,
+				 struct ctrl_iface_event_ring *ring, int idx,
+				 size_t limit, int probe)
+{
+	u64 oldest = ring->next_seq - ring->count;
+	char batch[CTRL_IFACE_EVENT_BATCH_LEN];
+	size_t in_flight;
+	int outq;
+
+	if (dst->next_seq < oldest) {
+		dst->events_lost += oldest - dst->next_seq;
+		dst->next_seq = oldest;
+	}
+
+	while (dst->next_seq < ring->next_seq) {
+		const struct ctrl_iface_event *ev, *single = NULL;
+		struct iovec io[2];
+		struct msghdr msg;
+		char hdr[40];
+		size_t hdr_len, used = 0;
+		unsigned int num = 0;
+		u64 seq;
+
+		for (seq = dst->next_seq; seq < ring->next_seq; seq++) {
+			ev = ctrl_iface_event_get(ring, seq);
+			if (ev->level < dst->debug_level)
+				continue;
+			hdr_len = ctrl_iface_event_hdr(dst, ev, hdr,
+						       sizeof(hdr));
+			if (dst->max_batch <= 1 ||
+			    (num == 0 &&
+			     hdr_len + ev->len > sizeof(batch))) {
+				/* Send as a separate datagram */
+				single = ev;
+				seq++;
+				break;
+			}
+			if (num == dst->max_batch ||
+			    used + !!num + hdr_len + ev->len > sizeof(batch))
+				break;
+			if (num)
+				batch[used++] = '\n';
+			os_memcpy(batch + used, hdr, hdr_len);
+			used += hdr_len;
+			os_memcpy(batch + used, ev + 1, ev->len);
+			used += ev->len;
+			num++;
+		}
+
+		if (!single && num == 0) {
+			/* Only events filtered out by the monitor level left */
+			dst->next_seq = seq;
+			break;
+		}
+
+		if (single) {
+			io[0].iov_base = hdr;
+			io[0].iov_len = hdr_len;
+			io[1].iov_base = (void *) (single + 1);
+			io[1].iov_len = single->len;
+			num = 1;
+		} else {
+			io[0].iov_base = batch;
+			io[0].iov_len = used;
+		}
+		os_memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = io;
+		msg.msg_iovlen = single ? 2 : 1;
+		msg.msg_name = &dst->addr;
+		msg.msg_namelen = dst->addrlen;
+
+		/*
+		 * Keep the monitor within its share of the send buffer so that
+		 * a monitor that does not read its events does not block the
+		 * other monitors and the command responses.
+		 */
+		if (limit && dst->in_flight && !probe &&
+		    dst->in_flight + (single ? hdr_len + single->len : used) >
+		    limit)
+			return 1; /* try again later */
+		ctrl_iface_event_in_flight(ctrl_dst, ring, NULL,
+					   ctrl_iface_event_outq(sock));
+
+		sockaddr_print(MSG_DEBUG, "CTRL_IFACE monitor send",
+			       &dst->addr, dst->addrlen);
+		if (sendmsg(sock, &msg, MSG_DONTWAIT) < 0) {
+			int _errno = errno;
+
+			if (_errno == EAGAIN || _errno == EWOULDBLOCK ||
+			    _errno == ENOBUFS) {
+				wpa_printf(MSG_DEBUG,
+					   "CTRL_IFACE monitor[%d]: %llu event(s) pending",
+					   idx, (unsigned long long)
+					   (ring->next_seq - dst->next_seq));
+				return 1;
+			}
+			wpa_printf(MSG_INFO, "CTRL_IFACE monitor[%d]: %d - %s",
+				   idx, _errno, strerror(_errno));
+			dst->errors++;
+			if (dst->errors > 10 || _errno == ENOENT)
+				return -1;
+			/* Skip the events that could not be delivered */
+			dst->next_seq = seq;
+			return 0;
+		}
+		dst->errors = 0;
+		dst->events_sent += num;
+		dst->next_seq = seq;
+		dst->last_send = ++ring->sends;
+		in_flight = dst->in_flight;
+		outq = ctrl_iface_event_outq(sock);
+		ctrl_iface_event_in_flight(ctrl_dst, ring, dst, outq);
+		if (probe) {
+			dst->probe_len = dst->in_flight > in_flight ?
+				dst->in_flight - in_flight : 0;
+			dst->probe_outq = outq;
+			return dst->next_seq < ring->next_seq;
+		}
+		dst->probe_len = 0;
+	}
+
+	return 0;
+}
+
+
+static void ctrl_iface_event_remove(struct ctrl_iface_event_ring *ring,
+				    struct wpa_ctrl_dst *dst)
+{
+	sockaddr_print(MSG_DEBUG, "CTRL_IFACE monitor detached",
+		       &dst->addr, dst->addrlen);
+	/* Unread events remain queued for the socket */
+	ring->detached_in_flight += dst->in_flight;
+	dl_list_del(&dst->list);
+	os_free(dst);
+	os_get_reltime(&ring->last_detach);
+}
+
+
+/**
+ * ctrl_iface_event_flush - Deliver buffered events to attached monitors
+ * @sock: Control interface socket
+ * @ctrl_dst: List of attached monitors
+ * @ring: Event buffer for the control interface
+ * Returns: 1 if some of the monitors were not able to receive all pending
+ * events (i.e., a new attempt needs to be scheduled) or 0 if not
+ *
+ * The sendmsg() calls do not block, so this can be called from the event loop
+ * without a slow monitor blocking the process. Each monitor gets an equal
+ * share of half of the socket send buffer for events it has not yet read, so a
+ * monitor that stops reading holds back only its own events. Monitors are
+ * removed if they no longer exist or if delivery fails with other errors
+ * repeatedly.
+ */
+int ctrl_iface_event_flush(int sock, struct dl_list *ctrl_dst,
+			   struct ctrl_iface_event_ring *ring)
+{
+	struct wpa_ctrl_dst *dst, *next, *probe = NULL;
+	int idx = 0, probe_idx = 0, pending = 0, res;
+	int sndbuf = 0, outq;
+	socklen_t optlen = sizeof(sndbuf);
+	size_t limit = 0;
+	u64 sends = ring->sends;
+	struct os_reltime now;
+
+	/*
+	 * Leave half of the send buffer available for command responses and
+	 * share the other half between the monitors.
+	 */
+	outq = ctrl_iface_event_outq(sock);
+	if (outq >= 0 && !dl_list_empty(ctrl_dst) &&
+	    getsockopt(sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, &optlen) == 0 &&
+	    sndbuf > 0)
+		limit = sndbuf / 2 / dl_list_len(ctrl_dst);
+	ctrl_iface_event_in_flight(ctrl_dst, ring, NULL, outq);
+
+	dl_list_for_each_safe(dst, next, ctrl_dst, struct wpa_ctrl_dst, list) {
+		res = ctrl_iface_event_send(sock, ctrl_dst, dst, ring, idx,
+					    limit, 0);
+		if (res > 0) {
+			pending = 1;
+			if (!probe || dst->last_send < probe->last_send) {
+				probe = dst;
+				probe_idx = idx;
+			}
+		} else if (res < 0) {
+			if (dst == probe)
+				probe = NULL;
+			ctrl_iface_event_remove(ring, dst);
+		}
+		idx++;
+	}
+
+	/*
+	 * The credit for read events may have gone to a monitor that does not
+	 * read them, so when no monitor was able to get events, send a probe
+	 * datagram to the one that has waited for the longest time as long as
+	 * a quarter of the send buffer remains available. Once the monitor has
+	 * read the probe, it has read all its earlier events as well. Only one
+	 * probe is outstanding at a time so that the read data can be
+	 * attributed to it.
+	 */
+	if (!probe || sends != ring->sends || !limit ||
+	    (size_t) ctrl_iface_event_outq(sock) >= (size_t) sndbuf / 4 * 3)
+		return pending;
+	os_get_reltime(&now);
+	dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+		if (!dst->probe_len)
+			continue;
+		if (!os_reltime_expired(&now, &ring->last_probe,
+					CTRL_IFACE_EVENT_PROBE_TIMEOUT))
+			return pending;
+		dst->probe_len = 0;
+	}
+	ring->last_probe = now;
+	if (ctrl_iface_event_send(sock, ctrl_dst, probe, ring, probe_idx,
+				  limit, 1) < 0)
+		ctrl_iface_event_remove(ring, probe);
+
+	return pending;
+}
+
+
+int ctrl_iface_event_status(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring,
+			    char *buf, size_t buflen)
+{
+	struct wpa_ctrl_dst *dst;
+	char *pos = buf, *end = buf + buflen;
+	u64 oldest = ring->next_seq - ring->count;
+	int idx = 0, ret;
+
+	ret = os_snprintf(pos, end - pos,
+			  "next_seq=%llu\n"
+			  "oldest_seq=%llu\n"
+			  "buffered=%u\n"
+			  "ring_size=%u\n",
+			  (unsigned long long) ring->next_seq,
+			  (unsigned long long) oldest,
+			  (unsigned int) ring->count,
+			  (unsigned int) ring->size);
+	if (os_snprintf_error(end - pos, ret))
+		return pos - buf;
+	pos += ret;
+
+	dl_list_for_each(dst, ctrl_dst, struct wpa_ctrl_dst, list) {
+		u64 next = dst->next_seq < oldest ? oldest : dst->next_seq;
+
+		ret = os_snprintf(pos, end - pos,
+				  "monitor[%d]=level=%d next_seq=%llu "
+				  "pending=%llu sent=%u lost=%u errors=%d "
+				  "batch=%u seq=%d in_flight=%u\n",
+				  idx++, dst->debug_level,
+				  (unsigned long long) dst->next_seq,
+				  (unsigned long long) (ring->next_seq - next),
+				  dst->events_sent, dst->events_lost +
+				  (unsigned int) (next - dst->next_seq),
+				  dst->errors, dst->max_batch, dst->show_seq,
+				  (unsigned int) dst->in_flight);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
@@ -23,6 +23,70 @@ struct wpa_ctrl_dst {
 	socklen_t addrlen;
 	int debug_level;
 	int errors;
+
+	/* Event delivery state when used with struct ctrl_iface_event_ring */
+	u64 next_seq; /* sequence number of the next event to deliver */
+	unsigned int events_sent;
+	unsigned int events_lost; /* overwritten in the ring before delivery */
+	unsigned int max_batch; /* maximum number of events per datagram */
+	unsigned int show_seq:1; /* include sequence numbers in events */
+	/* Estimated send buffer use by events not yet read by the monitor */
+	size_t in_flight;
+	u64 last_send; /* value of sends in the ring for the last datagram */
+	/* Send buffer use after and by the last probe datagram */
+	size_t probe_outq;
+	size_t probe_len;
+};
+
+/* Default number of events buffered for control interface monitors */
+#ifndef CTRL_IFACE_EVENT_RING_SIZE
+#define CTRL_IFACE_EVENT_RING_SIZE 256
+#endif /* CTRL_IFACE_EVENT_RING_SIZE */
+
+/* Maximum length of a datagram with a batch of events */
+#define CTRL_IFACE_EVENT_BATCH_LEN 4096
+
+/*
+ * Number of seconds events are still buffered without attached monitors after
+ * a monitor detaches so that it can resume after reconnecting
+ */
+#ifndef CTRL_IFACE_EVENT_RESUME_TIME
+#define CTRL_IFACE_EVENT_RESUME_TIME 60
+#endif /* CTRL_IFACE_EVENT_RESUME_TIME */
+
+/*
+ * Number of seconds to wait for a monitor to read a probe datagram that is
+ * sent to it beyond its share of the send buffer
+ */
+#define CTRL_IFACE_EVENT_PROBE_TIMEOUT 1
+
+struct ctrl_iface_event {
+	u64 seq;
+	int level;
+	size_t len;
+	/* followed by len octets of the event message */
+};
+
+/**
+ * struct ctrl_iface_event_ring - Buffer of control interface events
+ *
+ * Events are stored in a ring buffer shared by all the monitors attached to
+ * a control interface and each monitor has its own read position (next_seq in
+ * struct wpa_ctrl_dst). A monitor that is not able to receive events
+ * immediately gets them delivered later in order and a monitor that falls
+ * more than the ring size behind loses the oldest events (counted in
+ * events_lost).
+ */
+struct ctrl_iface_event_ring {
+	struct ctrl_iface_event **events;
+	size_t size;
+	size_t start; /* index of the oldest event */
+	size_t count;
+	u64 next_seq; /* sequence number for the next event */
+	struct os_reltime last_detach; /* when a monitor last detached */
+	size_t detached_in_flight; /* in_flight of detached monitors */
+	u64 sends; /* number of datagrams sent to the monitors */
+	struct os_reltime last_probe;
 };
 
 void sockaddr_print(int level, const char *msg, struct sockaddr_storage *sock,
@@ -35,4 +99,24 @@ int ctrl_iface_detach(struct dl_list *ctrl_dst, struct sockaddr_storage *from,
 int ctrl_iface_level(struct dl_list *ctrl_dst, struct sockaddr_storage *from,
 		     socklen_t fromlen, const char *level);
 
+int ctrl_iface_event_ring_init(struct ctrl_iface_event_ring *ring,
+			       size_t size);
+void ctrl_iface_event_ring_deinit(struct ctrl_iface_event_ring *ring);
+int ctrl_iface_event_wanted(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring, int level);
+void ctrl_iface_event_add(struct ctrl_iface_event_ring *ring, int level,
+			  const char *buf, size_t len);
+int ctrl_iface_event_attach(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring,
+			    struct sockaddr_storage *from, socklen_t fromlen,
+			    const char *params);
+int ctrl_iface_event_detach(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring,
+			    struct sockaddr_storage *from, socklen_t fromlen);
+int ctrl_iface_event_flush(int sock, struct dl_list *ctrl_dst,
+			   struct ctrl_iface_event_ring *ring);
+int ctrl_iface_event_status(struct dl_list *ctrl_dst,
+			    struct ctrl_iface_event_ring *ring,
+			    char *buf, size_t buflen);
+
 #endif /* CONTROL_IFACE_COMMON_H */
@@ -89,6 +89,7 @@ enum dpp_bootstrap_type {
 
 struct dpp_bootstrap_info {
 	struct dl_list list;
+	struct dpp_bootstrap_info *hnext; /* next entry in pubkey_hash index */
 	unsigned int id;
 	enum dpp_bootstrap_type type;
 	char *uri;
@@ -136,6 +137,7 @@ struct dpp_configuration {
 };
 
 struct dpp_authentication {
+	struct dl_list list;
 	void *msg_ctx;
 	const struct dpp_curve_params *curve;
 	struct dpp_bootstrap_info *peer_bi;
@@ -164,6 +166,7 @@ struct dpp_authentication {
 	int initiator;
 	int configurator;
 	int remove_on_tx_status;
+	int auth_ok_on_ack;
 	int auth_success;
 	struct wpabuf *conf_req;
 	struct dpp_configuration *conf_ap;
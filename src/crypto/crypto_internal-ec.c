@@ -0,0 +1,1225 @@
+/*
+ * Elliptic curve arithmetic for internal crypto implementation
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * This is a dedicated implementation of the NIST prime curves P-256, P-384,
+ * and P-521 (IKE groups 19, 20, and 21) for the crypto_ec_*() and
+ * crypto_ecdh_*() wrappers. Field elements are kept in Montgomery form as
+ * arrays of 32-bit words and points in Jacobian coordinates. All field
+ * operations that can depend on secret values run in constant time.
+ * Multiplication of an arbitrary point uses a Montgomery ladder with
+ * conditional swaps and multiplication of the group generator uses a
+ * precomputed fixed-base comb table.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "random.h"
+#include "crypto.h"
+
+
+/* P-521 needs 17 32-bit words */
+#define EC_MAX_WORDS 17
+#define EC_MAX_LEN 66
+
+/* Comb width for the fixed-base generator multiplication */
+#define EC_COMB_TEETH 4
+#define EC_COMB_SIZE (1 << EC_COMB_TEETH)
+
+static const u8 ec_p256_prime[32] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x01,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+static const u8 ec_p256_b[32] = {
+	0x5A, 0xC6, 0x35, 0xD8, 0xAA, 0x3A, 0x93, 0xE7,
+	0xB3, 0xEB, 0xBD, 0x55, 0x76, 0x98, 0x86, 0xBC,
+	0x65, 0x1D, 0x06, 0xB0, 0xCC, 0x53, 0xB0, 0xF6,
+	0x3B, 0xCE, 0x3C, 0x3E, 0x27, 0xD2, 0x60, 0x4B
+};
+static const u8 ec_p256_order[32] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xBC, 0xE6, 0xFA, 0xAD, 0xA7, 0x17, 0x9E, 0x84,
+	0xF3, 0xB9, 0xCA, 0xC2, 0xFC, 0x63, 0x25, 0x51
+};
+static const u8 ec_p256_gx[32] = {
+	0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47,
+	0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+	0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0,
+	0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96
+};
+static const u8 ec_p256_gy[32] = {
+	0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B,
+	0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
+	0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE,
+	0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5
+};
+static const u8 ec_p384_prime[48] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE,
+	0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF
+};
+static const u8 ec_p384_b[48] = {
+	0xB3, 0x31, 0x2F, 0xA7, 0xE2, 0x3E, 0xE7, 0xE4,
+	0x98, 0x8E, 0x05, 0x6B, 0xE3, 0xF8, 0x2D, 0x19,
+	0x18, 0x1D, 0x9C, 0x6E, 0xFE, 0x81, 0x41, 0x12,
+	0x03, 0x14, 0x08, 0x8F, 0x50, 0x13, 0x87, 0x5A,
+	0xC6, 0x56, 0x39, 0x8D, 0x8A, 0x2E, 0xD1, 0x9D,
+	0x2A, 0x85, 0xC8, 0xED, 0xD3, 0xEC, 0x2A, 0xEF
+};
+static const u8 ec_p384_order[48] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xC7, 0x63, 0x4D, 0x81, 0xF4, 0x37, 0x2D, 0xDF,
+	0x58, 0x1A, 0x0D, 0xB2, 0x48, 0xB0, 0xA7, 0x7A,
+	0xEC, 0xEC, 0x19, 0x6A, 0xCC, 0xC5, 0x29, 0x73
+};
+static const u8 ec_p384_gx[48] = {
+	0xAA, 0x87, 0xCA, 0x22, 0xBE, 0x8B, 0x05, 0x37,
+	0x8E, 0xB1, 0xC7, 0x1E, 0xF3, 0x20, 0xAD, 0x74,
+	0x6E, 0x1D, 0x3B, 0x62, 0x8B, 0xA7, 0x9B, 0x98,
+	0x59, 0xF7, 0x41, 0xE0, 0x82, 0x54, 0x2A, 0x38,
+	0x55, 0x02, 0xF2, 0x5D, 0xBF, 0x55, 0x29, 0x6C,
+	0x3A, 0x54, 0x5E, 0x38, 0x72, 0x76, 0x0A, 0xB7
+};
+static const u8 ec_p384_gy[48] = {
+	0x36, 0x17, 0xDE, 0x4A, 0x96, 0x26, 0x2C, 0x6F,
+	0x5D, 0x9E, 0x98, 0xBF, 0x92, 0x92, 0xDC, 0x29,
+	0xF8, 0xF4, 0x1D, 0xBD, 0x28, 0x9A, 0x14, 0x7C,
+	0xE9, 0xDA, 0x31, 0x13, 0xB5, 0xF0, 0xB8, 0xC0,
+	0x0A, 0x60, 0xB1, 0xCE, 0x1D, 0x7E, 0x81, 0x9D,
+	0x7A, 0x43, 0x1D, 0x7C, 0x90, 0xEA, 0x0E, 0x5F
+};
+static const u8 ec_p521_prime[66] = {
+	0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF
+};
+static const u8 ec_p521_b[66] = {
+	0x00, 0x51, 0x95, 0x3E, 0xB9, 0x61, 0x8E, 0x1C,
+	0x9A, 0x1F, 0x92, 0x9A, 0x21, 0xA0, 0xB6, 0x85,
+	0x40, 0xEE, 0xA2, 0xDA, 0x72, 0x5B, 0x99, 0xB3,
+	0x15, 0xF3, 0xB8, 0xB4, 0x89, 0x91, 0x8E, 0xF1,
+	0x09, 0xE1, 0x56, 0x19, 0x39, 0x51, 0xEC, 0x7E,
+	0x93, 0x7B, 0x16, 0x52, 0xC0, 0xBD, 0x3B, 0xB1,
+	0xBF, 0x07, 0x35, 0x73, 0xDF, 0x88, 0x3D, 0x2C,
+	0x34, 0xF1, 0xEF, 0x45, 0x1F, 0xD4, 0x6B, 0x50,
+	0x3F, 0x00
+};
+static const u8 ec_p521_order[66] = {
+	0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFA, 0x51, 0x86, 0x87, 0x83, 0xBF, 0x2F,
+	0x96, 0x6B, 0x7F, 0xCC, 0x01, 0x48, 0xF7, 0x09,
+	0xA5, 0xD0, 0x3B, 0xB5, 0xC9, 0xB8, 0x89, 0x9C,
+	0x47, 0xAE, 0xBB, 0x6F, 0xB7, 0x1E, 0x91, 0x38,
+	0x64, 0x09
+};
+static const u8 ec_p521_gx[66] = {
+	0x00, 0xC6, 0x85, 0x8E, 0x06, 0xB7, 0x04, 0x04,
+	0xE9, 0xCD, 0x9E, 0x3E, 0xCB, 0x66, 0x23, 0x95,
+	0xB4, 0x42, 0x9C, 0x64, 0x81, 0x39, 0x05, 0x3F,
+	0xB5, 0x21, 0xF8, 0x28, 0xAF, 0x60, 0x6B, 0x4D,
+	0x3D, 0xBA, 0xA1, 0x4B, 0x5E, 0x77, 0xEF, 0xE7,
+	0x59, 0x28, 0xFE, 0x1D, 0xC1, 0x27, 0xA2, 0xFF,
+	0xA8, 0xDE, 0x33, 0x48, 0xB3, 0xC1, 0x85, 0x6A,
+	0x42, 0x9B, 0xF9, 0x7E, 0x7E, 0x31, 0xC2, 0xE5,
+	0xBD, 0x66
+};
+static const u8 ec_p521_gy[66] = {
+	0x01, 0x18, 0x39, 0x29, 0x6A, 0x78, 0x9A, 0x3B,
+	0xC0, 0x04, 0x5C, 0x8A, 0x5F, 0xB4, 0x2C, 0x7D,
+	0x1B, 0xD9, 0x98, 0xF5, 0x44, 0x49, 0x57, 0x9B,
+	0x44, 0x68, 0x17, 0xAF, 0xBD, 0x17, 0x27, 0x3E,
+	0x66, 0x2C, 0x97, 0xEE, 0x72, 0x99, 0x5E, 0xF4,
+	0x26, 0x40, 0xC5, 0x50, 0xB9, 0x01, 0x3F, 0xAD,
+	0x07, 0x61, 0x35, 0x3C, 0x70, 0x86, 0xA2, 0x72,
+	0xC2, 0x40, 0x88, 0xBE, 0x94, 0x76, 0x9F, 0xD1,
+	0x66, 0x50
+};
+
+
+struct ec_curve {
+	int group;
+	size_t len; /* length of the prime and the order in octets */
+	size_t bits; /* length of the prime in bits */
+	const u8 *prime;
+	const u8 *b;
+	const u8 *order;
+	const u8 *gx;
+	const u8 *gy;
+};
+
+static const struct ec_curve ec_curves[] = {
+	{ 19, 32, 256, ec_p256_prime, ec_p256_b, ec_p256_order,
+	  ec_p256_gx, ec_p256_gy },
+	{ 20, 48, 384, ec_p384_prime, ec_p384_b, ec_p384_order,
+	  ec_p384_gx, ec_p384_gy },
+	{ 21, 66, 521, ec_p521_prime, ec_p521_b, ec_p521_order,
+	  ec_p521_gx, ec_p521_gy },
+};
+
+#define EC_NUM_CURVES ARRAY_SIZE(ec_curves)
+
+
+typedef u32 ec_fe[EC_MAX_WORDS];
+
+struct ec_point {
+	ec_fe x;
+	ec_fe y;
+	ec_fe z; /* z = 0 for the point at infinity */
+};
+
+struct crypto_ec_point {
+	struct ec_point p;
+};
+
+struct ec_comb {
+	int ready;
+	struct ec_point t[EC_COMB_SIZE];
+};
+
+/* Fixed-base comb tables; computed on first use of each curve */
+static struct ec_comb ec_comb_tables[EC_NUM_CURVES];
+
+struct crypto_ec {
+	const struct ec_curve *curve;
+	struct ec_comb *comb;
+	size_t words;
+	size_t order_bits;
+	ec_fe p;
+	u32 p_inv; /* -p^-1 mod 2^32 */
+	ec_fe rr; /* R^2 mod p */
+	ec_fe one; /* R mod p, i.e., 1 in Montgomery form */
+	ec_fe b; /* b in Montgomery form */
+	struct ec_point g; /* generator */
+	u8 exp_inv[EC_MAX_LEN]; /* p - 2 */
+	u8 exp_sqrt[EC_MAX_LEN]; /* (p + 1) / 4 */
+	struct crypto_bignum *prime;
+	struct crypto_bignum *order;
+};
+
+
+/* Field arithmetic (mod p); all values are fully reduced to [0, p) */
+
+static void ec_bin_to_words(u32 *r, size_t words, const u8 *buf, size_t len)
+{
+	size_t i;
+
+	os_memset(r, 0, words * sizeof(u32));
+	for (i = 0; i < len; i++) {
+		size_t pos = len - 1 - i;
+
+		r[i / 4] |= (u32) buf[pos] << (8 * (i % 4));
+	}
+}
+
+
+static void ec_words_to_bin(u8 *buf, size_t len, const u32 *a)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		buf[len - 1 - i] = a[i / 4] >> (8 * (i % 4));
+}
+
+
+/* Returns all-ones mask if a < b, zero otherwise */
+static u32 ec_words_lt(const u32 *a, const u32 *b, size_t words)
+{
+	u64 borrow = 0;
+	size_t i;
+
+	for (i = 0; i < words; i++) {
+		u64 d = (u64) a[i] - b[i] - borrow;
+
+		borrow = (d >> 32) & 1;
+	}
+	return (u32) 0 - (u32) borrow;
+}
+
+
+static u32 ec_fe_is_zero(const struct crypto_ec *e, const u32 *a)
+{
+	u32 acc = 0;
+	size_t i;
+
+	for (i = 0; i < e->words; i++)
+		acc |= a[i];
+	/* all-ones mask if acc == 0 */
+	return (u32) 0 - (u32) (((u64) acc - 1) >> 63);
+}
+
+
+static void ec_fe_select(const struct crypto_ec *e, u32 *r, const u32 *a,
+			 u32 mask)
+{
+	size_t i;
+
+	for (i = 0; i < e->words; i++)
+		r[i] = (r[i] & ~mask) | (a[i] & mask);
+}
+
+
+/* r = t - p if t >= p (t has words + 1 limbs in hi), constant time */
+static void ec_fe_reduce_once(const struct crypto_ec *e, u32 *r, u32 *t,
+			      u32 hi)
+{
+	u32 d[EC_MAX_WORDS];
+	u64 borrow = 0;
+	u32 mask;
+	size_t i;
+
+	for (i = 0; i < e->words; i++) {
+		u64 v = (u64) t[i] - e->p[i] - borrow;
+
+		d[i] = (u32) v;
+		borrow = (v >> 32) & 1;
+	}
+	/* use the difference if there was a carry out or no borrow */
+	mask = ((u32) 0 - (hi & 1)) | ((u32) borrow - 1);
+	for (i = 0; i < e->words; i++)
+		r[i] = (t[i] & ~mask) | (d[i] & mask);
+}
+
+
+static void ec_fe_add(const struct crypto_ec *e, u32 *r, const u32 *a,
+		      const u32 *b)
+{
+	u64 carry = 0;
+	size_t i;
+
+	for (i = 0; i < e->words; i++) {
+		carry += (u64) a[i] + b[i];
+		r[i] = (u32) carry;
+		carry >>= 32;
+	}
+	ec_fe_reduce_once(e, r, r, (u32) carry);
+}
+
+
+static void ec_fe_sub(const struct crypto_ec *e, u32 *r, const u32 *a,
+		      const u32 *b)
+{
+	u64 borrow = 0, carry = 0;
+	u32 mask;
+	size_t i;
+
+	for (i = 0; i < e->words; i++) {
+		u64 v = (u64) a[i] - b[i] - borrow;
+
+		r[i] = (u32) v;
+		borrow = (v >> 32) & 1;
+	}
+	/* add p back if the result went negative */
+	mask = (u32) 0 - (u32) borrow;
+	for (i = 0; i < e->words; i++) {
+		carry += (u64) r[i] + (e->p[i] & mask);
+		r[i] = (u32) carry;
+		carry >>= 32;
+	}
+}
+
+
+/* Montgomery multiplication: r = a * b * R^-1 (mod p) */
+static void ec_fe_mul(const struct crypto_ec *e, u32 *r, const u32 *a,
+		      const u32 *b)
+{
+	u32 t[EC_MAX_WORDS + 2];
+	size_t i, j, n = e->words;
+
+	os_memset(t, 0, sizeof(t));
+	for (i = 0; i < n; i++) {
+		u64 c = 0;
+		u32 m;
+
+		for (j = 0; j < n; j++) {
+			c += (u64) a[j] * b[i] + t[j];
+			t[j] = (u32) c;
+			c >>= 32;
+		}
+		c += t[n];
+		t[n] = (u32) c;
+		t[n + 1] = (u32) (c >> 32);
+
+		m = t[0] * e->p_inv;
+		c = ((u64) m * e->p[0] + t[0]) >> 32;
+		for (j = 1; j < n; j++) {
+			c += (u64) m * e->p[j] + t[j];
+			t[j - 1] = (u32) c;
+			c >>= 32;
+		}
+		c += t[n];
+		t[n - 1] = (u32) c;
+		t[n] = t[n + 1] + (u32) (c >> 32);
+	}
+	ec_fe_reduce_once(e, r, t, t[n]);
+}
+
+
+static void ec_fe_sqr(const struct crypto_ec *e, u32 *r, const u32 *a)
+{
+	ec_fe_mul(e, r, a, a);
+}
+
+
+/* r = a^exp with a public exponent (big endian, length of the prime) */
+static void ec_fe_pow(const struct crypto_ec *e, u32 *r, const u32 *a,
+		      const u8 *exp)
+{
+	ec_fe t;
+	size_t i;
+	int bit;
+
+	os_memcpy(t, e->one, sizeof(t));
+	for (i = 0; i < e->curve->len; i++) {
+		for (bit = 7; bit >= 0; bit--) {
+			ec_fe_sqr(e, t, t);
+			if (exp[i] & BIT(bit))
+				ec_fe_mul(e, t, t, a);
+		}
+	}
+	os_memcpy(r, t, sizeof(t));
+}
+
+
+static void ec_fe_inv(const struct crypto_ec *e, u32 *r, const u32 *a)
+{
+	ec_fe_pow(e, r, a, e->exp_inv);
+}
+
+
+/* Convert a big endian value into Montgomery form; fails if value >= p */
+static int ec_fe_from_bin(const struct crypto_ec *e, u32 *r, const u8 *buf)
+{
+	ec_fe t;
+
+	ec_bin_to_words(t, e->words, buf, e->curve->len);
+	if (!ec_words_lt(t, e->p, e->words))
+		return -1;
+	ec_fe_mul(e, r, t, e->rr);
+	return 0;
+}
+
+
+static void ec_fe_to_bin(const struct crypto_ec *e, u8 *buf, const u32 *a)
+{
+	ec_fe t, one;
+
+	os_memset(one, 0, sizeof(one));
+	one[0] = 1;
+	ec_fe_mul(e, t, a, one);
+	ec_words_to_bin(buf, e->curve->len, t);
+}
+
+
+/* r = x^3 - 3x + b */
+static void ec_fe_y_sqr(const struct crypto_ec *e, u32 *r, const u32 *x)
+{
+	ec_fe t, t2;
+
+	ec_fe_sqr(e, t, x);
+	ec_fe_mul(e, t, t, x);
+	ec_fe_add(e, t2, x, x);
+	ec_fe_add(e, t2, t2, x);
+	ec_fe_sub(e, t, t, t2);
+	ec_fe_add(e, r, t, e->b);
+}
+
+
+/* Point arithmetic in Jacobian coordinates (a = -3 for all curves) */
+
+static void ec_point_select(const struct crypto_ec *e, struct ec_point *r,
+			    const struct ec_point *a, u32 mask)
+{
+	ec_fe_select(e, r->x, a->x, mask);
+	ec_fe_select(e, r->y, a->y, mask);
+	ec_fe_select(e, r->z, a->z, mask);
+}
+
+
+static void ec_point_cswap(const struct crypto_ec *e, struct ec_point *a,
+			   struct ec_point *b, u32 mask)
+{
+	u32 *pa = &a->x[0], *pb = &b->x[0];
+	size_t i;
+
+	for (i = 0; i < 3 * EC_MAX_WORDS; i++) {
+		u32 t = (pa[i] ^ pb[i]) & mask;
+
+		pa[i] ^= t;
+		pb[i] ^= t;
+	}
+}
+
+
+/* dbl-2001-b; the point at infinity maps to itself since Z3 = 2*Y1*Z1 */
+static void ec_point_double(const struct crypto_ec *e, struct ec_point *r,
+			    const struct ec_point *a)
+{
+	ec_fe delta, gamma, beta, alpha, t1, t2;
+
+	ec_fe_sqr(e, delta, a->z);
+	ec_fe_sqr(e, gamma, a->y);
+	ec_fe_mul(e, beta, a->x, gamma);
+
+	/* alpha = 3 * (X1 - delta) * (X1 + delta) */
+	ec_fe_sub(e, t1, a->x, delta);
+	ec_fe_add(e, t2, a->x, delta);
+	ec_fe_mul(e, alpha, t1, t2);
+	ec_fe_add(e, t1, alpha, alpha);
+	ec_fe_add(e, alpha, t1, alpha);
+
+	/* Z3 = (Y1 + Z1)^2 - gamma - delta */
+	ec_fe_add(e, t1, a->y, a->z);
+	ec_fe_sqr(e, t1, t1);
+	ec_fe_sub(e, t1, t1, gamma);
+	ec_fe_sub(e, r->z, t1, delta);
+
+	/* X3 = alpha^2 - 8 * beta */
+	ec_fe_add(e, beta, beta, beta);
+	ec_fe_add(e, beta, beta, beta); /* 4 * beta */
+	ec_fe_add(e, t2, beta, beta);
+	ec_fe_sqr(e, t1, alpha);
+	ec_fe_sub(e, r->x, t1, t2);
+
+	/* Y3 = alpha * (4 * beta - X3) - 8 * gamma^2 */
+	ec_fe_sub(e, t1, beta, r->x);
+	ec_fe_mul(e, t1, alpha, t1);
+	ec_fe_sqr(e, t2, gamma);
+	ec_fe_add(e, t2, t2, t2);
+	ec_fe_add(e, t2, t2, t2);
+	ec_fe_add(e, t2, t2, t2);
+	ec_fe_sub(e, r->y, t1, t2);
+}
+
+
+/*
+ * add-2007-bl with constant time handling of the point at infinity as either
+ * input. If handle_dbl is set, a == b is detected and the doubling result is
+ * selected; otherwise, the caller guarantees that the inputs are distinct
+ * unless either is the point at infinity (e.g., in the Montgomery ladder).
+ * a == -b results in Z3 = 0 naturally.
+ */
+static void ec_point_add(const struct crypto_ec *e, struct ec_point *r,
+			 const struct ec_point *a, const struct ec_point *b,
+			 int handle_dbl)
+{
+	ec_fe z1z1, z2z2, u1, u2, s1, s2, h, i, j, rr, v, t;
+	struct ec_point res, dbl;
+	u32 a_inf, b_inf, same;
+
+	a_inf = ec_fe_is_zero(e, a->z);
+	b_inf = ec_fe_is_zero(e, b->z);
+
+	ec_fe_sqr(e, z1z1, a->z);
+	ec_fe_sqr(e, z2z2, b->z);
+	ec_fe_mul(e, u1, a->x, z2z2);
+	ec_fe_mul(e, u2, b->x, z1z1);
+	ec_fe_mul(e, s1, a->y, b->z);
+	ec_fe_mul(e, s1, s1, z2z2);
+	ec_fe_mul(e, s2, b->y, a->z);
+	ec_fe_mul(e, s2, s2, z1z1);
+	ec_fe_sub(e, h, u2, u1);
+	ec_fe_add(e, i, h, h);
+	ec_fe_sqr(e, i, i);
+	ec_fe_mul(e, j, h, i);
+	ec_fe_sub(e, rr, s2, s1);
+	ec_fe_add(e, rr, rr, rr);
+	ec_fe_mul(e, v, u1, i);
+
+	/* X3 = r^2 - J - 2 * V */
+	ec_fe_sqr(e, t, rr);
+	ec_fe_sub(e, t, t, j);
+	ec_fe_sub(e, t, t, v);
+	ec_fe_sub(e, res.x, t, v);
+
+	/* Y3 = r * (V - X3) - 2 * S1 * J */
+	ec_fe_sub(e, t, v, res.x);
+	ec_fe_mul(e, t, rr, t);
+	ec_fe_mul(e, s1, s1, j);
+	ec_fe_add(e, s1, s1, s1);
+	ec_fe_sub(e, res.y, t, s1);
+
+	/* Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) * H */
+	ec_fe_add(e, t, a->z, b->z);
+	ec_fe_sqr(e, t, t);
+	ec_fe_sub(e, t, t, z1z1);
+	ec_fe_sub(e, t, t, z2z2);
+	ec_fe_mul(e, res.z, t, h);
+
+	if (handle_dbl) {
+		same = ec_fe_is_zero(e, h) & ec_fe_is_zero(e, rr) &
+			~a_inf & ~b_inf;
+		ec_point_double(e, &dbl, a);
+		ec_point_select(e, &res, &dbl, same);
+	}
+
+	ec_point_select(e, &res, b, a_inf);
+	ec_point_select(e, &res, a, b_inf);
+	os_memcpy(r, &res, sizeof(res));
+	os_memset(&dbl, 0, sizeof(dbl));
+}
+
+
+static int ec_scalar_bit(const u8 *k, size_t len, size_t bit)
+{
+	if (bit >= len * 8)
+		return 0;
+	return (k[len - 1 - bit / 8] >> (bit % 8)) & 1;
+}
+
+
+/* r = k * a with Montgomery ladder; k is big endian with length of order */
+static void ec_point_mul_ladder(const struct crypto_ec *e, struct ec_point *r,
+				const struct ec_point *a, const u8 *k)
+{
+	struct ec_point r0, r1;
+	size_t i;
+	u32 mask;
+
+	os_memset(&r0, 0, sizeof(r0));
+	os_memcpy(&r1, a, sizeof(r1));
+
+	for (i = e->order_bits; i > 0; i--) {
+		mask = (u32) 0 - (u32) ec_scalar_bit(k, e->curve->len, i - 1);
+		ec_point_cswap(e, &r0, &r1, mask);
+		ec_point_add(e, &r1, &r0, &r1, 0);
+		ec_point_double(e, &r0, &r0);
+		ec_point_cswap(e, &r0, &r1, mask);
+	}
+
+	os_memcpy(r, &r0, sizeof(r0));
+	os_memset(&r0, 0, sizeof(r0));
+	os_memset(&r1, 0, sizeof(r1));
+}
+
+
+static void ec_comb_init(const struct crypto_ec *e, struct ec_comb *comb)
+{
+	struct ec_point base[EC_COMB_TEETH];
+	size_t d = (e->order_bits + EC_COMB_TEETH - 1) / EC_COMB_TEETH;
+	size_t i, j;
+
+	/* base[j] = 2^(j * d) * G */
+	os_memcpy(&base[0], &e->g, sizeof(base[0]));
+	for (j = 1; j < EC_COMB_TEETH; j++) {
+		os_memcpy(&base[j], &base[j - 1], sizeof(base[j]));
+		for (i = 0; i < d; i++)
+			ec_point_double(e, &base[j], &base[j]);
+	}
+
+	/* t[i] = sum of base[j] for each bit j set in i */
+	os_memset(&comb->t[0], 0, sizeof(comb->t[0]));
+	for (i = 1; i < EC_COMB_SIZE; i++) {
+		for (j = 0; j < EC_COMB_TEETH; j++) {
+			if (i & BIT(j))
+				break;
+		}
+		ec_point_add(e, &comb->t[i], &comb->t[i & ~BIT(j)], &base[j],
+			     1);
+	}
+
+	comb->ready = 1;
+}
+
+
+/* r = k * G with the fixed-base comb table */
+static void ec_point_mul_base(const struct crypto_ec *e, struct ec_point *r,
+			      const u8 *k)
+{
+	struct ec_point q, sel;
+	size_t d = (e->order_bits + EC_COMB_TEETH - 1) / EC_COMB_TEETH;
+	size_t col, i, j;
+
+	os_memset(&q, 0, sizeof(q));
+	for (col = d; col > 0; col--) {
+		unsigned int digit = 0;
+
+		for (j = 0; j < EC_COMB_TEETH; j++)
+			digit |= ec_scalar_bit(k, e->curve->len,
+					       j * d + col - 1) << j;
+
+		/* constant time table lookup */
+		os_memset(&sel, 0, sizeof(sel));
+		for (i = 0; i < EC_COMB_SIZE; i++) {
+			u32 diff = (u32) i ^ digit;
+			u32 mask = (u32) 0 - (u32) (((u64) diff - 1) >> 63);
+
+			ec_point_select(e, &sel, &e->comb->t[i], mask);
+		}
+
+		ec_point_double(e, &q, &q);
+		ec_point_add(e, &q, &q, &sel, 1);
+	}
+
+	os_memcpy(r, &q, sizeof(q));
+	os_memset(&q, 0, sizeof(q));
+	os_memset(&sel, 0, sizeof(sel));
+}
+
+
+static int ec_point_is_generator(const struct crypto_ec *e,
+				 const struct ec_point *a)
+{
+	size_t len = e->words * sizeof(u32);
+
+	return os_memcmp(a->x, e->g.x, len) == 0 &&
+		os_memcmp(a->y, e->g.y, len) == 0 &&
+		os_memcmp(a->z, e->g.z, len) == 0;
+}
+
+
+static int ec_scalar_is_zero(const u8 *k, size_t len)
+{
+	u8 acc = 0;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		acc |= k[i];
+	return acc == 0;
+}
+
+
+static void ec_point_mul(struct crypto_ec *e, struct ec_point *r,
+			 const struct ec_point *a, const u8 *k)
+{
+	if (ec_point_is_generator(e, a)) {
+		if (!e->comb->ready)
+			ec_comb_init(e, e->comb);
+		ec_point_mul_base(e, r, k);
+	} else {
+		ec_point_mul_ladder(e, r, a, k);
+	}
+}
+
+
+static int ec_point_to_affine(const struct crypto_ec *e, u32 *x, u32 *y,
+			      const struct ec_point *a)
+{
+	ec_fe zinv, t;
+
+	if (ec_fe_is_zero(e, a->z))
+		return -1;
+
+	ec_fe_inv(e, zinv, a->z);
+	ec_fe_sqr(e, t, zinv);
+	if (x)
+		ec_fe_mul(e, x, a->x, t);
+	if (y) {
+		ec_fe_mul(e, t, t, zinv);
+		ec_fe_mul(e, y, a->y, t);
+	}
+	return 0;
+}
+
+
+static int ec_point_on_curve(const struct crypto_ec *e,
+			     const struct ec_point *a)
+{
+	ec_fe z2, z4, z6, lhs, rhs, t;
+
+	if (ec_fe_is_zero(e, a->z))
+		return 1;
+
+	/* Y^2 = X^3 - 3 * X * Z^4 + b * Z^6 */
+	ec_fe_sqr(e, z2, a->z);
+	ec_fe_sqr(e, z4, z2);
+	ec_fe_mul(e, z6, z4, z2);
+
+	ec_fe_sqr(e, lhs, a->y);
+
+	ec_fe_sqr(e, rhs, a->x);
+	ec_fe_mul(e, rhs, rhs, a->x);
+	ec_fe_mul(e, t, a->x, z4);
+	ec_fe_sub(e, rhs, rhs, t);
+	ec_fe_sub(e, rhs, rhs, t);
+	ec_fe_sub(e, rhs, rhs, t);
+	ec_fe_mul(e, t, e->b, z6);
+	ec_fe_add(e, rhs, rhs, t);
+
+	return os_memcmp(lhs, rhs, e->words * sizeof(u32)) == 0;
+}
+
+
+/* k = b (mod order) as a big endian value with the length of the order */
+static int ec_scalar_from_bignum(struct crypto_ec *e,
+				 const struct crypto_bignum *b, u8 *k)
+{
+	struct crypto_bignum *tmp;
+	int ret;
+
+	tmp = crypto_bignum_init();
+	if (!tmp)
+		return -1;
+	ret = crypto_bignum_mod(b, e->order, tmp);
+	if (ret == 0 &&
+	    crypto_bignum_to_bin(tmp, k, e->curve->len, e->curve->len) < 0)
+		ret = -1;
+	crypto_bignum_deinit(tmp, 1);
+	return ret;
+}
+
+
+struct crypto_ec * crypto_ec_init(int group)
+{
+	struct crypto_ec *e;
+	const struct ec_curve *curve = NULL;
+	ec_fe t;
+	size_t i, len;
+	u32 inv;
+	int carry;
+
+	for (i = 0; i < EC_NUM_CURVES; i++) {
+		if (ec_curves[i].group == group) {
+			curve = &ec_curves[i];
+			break;
+		}
+	}
+	if (!curve)
+		return NULL;
+
+	e = os_zalloc(sizeof(*e));
+	if (!e)
+		return NULL;
+
+	e->curve = curve;
+	e->comb = &ec_comb_tables[i];
+	len = curve->len;
+	e->words = (len + 3) / 4;
+	e->order_bits = curve->bits;
+	ec_bin_to_words(e->p, e->words, curve->prime, len);
+
+	/* p_inv = -p^-1 mod 2^32 using Newton iteration */
+	inv = 1;
+	for (i = 0; i < 5; i++)
+		inv *= 2 - e->p[0] * inv;
+	e->p_inv = (u32) 0 - inv;
+
+	/* R mod p and R^2 mod p by repeated doubling of 1 */
+	os_memset(t, 0, sizeof(t));
+	t[0] = 1;
+	for (i = 0; i < 32 * e->words; i++)
+		ec_fe_add(e, t, t, t);
+	os_memcpy(e->one, t, sizeof(t));
+	for (i = 0; i < 32 * e->words; i++)
+		ec_fe_add(e, t, t, t);
+	os_memcpy(e->rr, t, sizeof(t));
+
+	/* p - 2 and (p + 1) / 4 for inversion and square roots */
+	os_memcpy(e->exp_inv, curve->prime, len);
+	e->exp_inv[len - 1] -= 2; /* p ends with 0xff for all curves */
+	os_memcpy(e->exp_sqrt, curve->prime, len);
+	carry = 1;
+	for (i = len; i > 0 && carry; i--) {
+		e->exp_sqrt[i - 1]++;
+		carry = e->exp_sqrt[i - 1] == 0;
+	}
+	for (i = len; i > 0; i--) {
+		e->exp_sqrt[i - 1] >>= 2;
+		if (i > 1)
+			e->exp_sqrt[i - 1] |= e->exp_sqrt[i - 2] << 6;
+	}
+
+	e->prime = crypto_bignum_init_set(curve->prime, len);
+	e->order = crypto_bignum_init_set(curve->order, len);
+	if (!e->prime || !e->order ||
+	    ec_fe_from_bin(e, e->b, curve->b) < 0 ||
+	    ec_fe_from_bin(e, e->g.x, curve->gx) < 0 ||
+	    ec_fe_from_bin(e, e->g.y, curve->gy) < 0) {
+		crypto_ec_deinit(e);
+		return NULL;
+	}
+	os_memcpy(e->g.z, e->one, sizeof(e->g.z));
+
+	return e;
+}
+
+
+void crypto_ec_deinit(struct crypto_ec *e)
+{
+	if (!e)
+		return;
+	crypto_bignum_deinit(e->prime, 0);
+	crypto_bignum_deinit(e->order, 0);
+	os_free(e);
+}
+
+
+struct crypto_ec_point * crypto_ec_point_init(struct crypto_ec *e)
+{
+	if (TEST_FAIL())
+		return NULL;
+	if (!e)
+		return NULL;
+	/* all zero coordinates represent the point at infinity */
+	return os_zalloc(sizeof(struct crypto_ec_point));
+}
+
+
+size_t crypto_ec_prime_len(struct crypto_ec *e)
+{
+	return e->curve->len;
+}
+
+
+size_t crypto_ec_prime_len_bits(struct crypto_ec *e)
+{
+	return e->curve->bits;
+}
+
+
+const struct crypto_bignum * crypto_ec_get_prime(struct crypto_ec *e)
+{
+	return e->prime;
+}
+
+
+const struct crypto_bignum * crypto_ec_get_order(struct crypto_ec *e)
+{
+	return e->order;
+}
+
+
+void crypto_ec_point_deinit(struct crypto_ec_point *p, int clear)
+{
+	if (clear)
+		bin_clear_free(p, sizeof(*p));
+	else
+		os_free(p);
+}
+
+
+int crypto_ec_point_to_bin(struct crypto_ec *e,
+			   const struct crypto_ec_point *point, u8 *x, u8 *y)
+{
+	ec_fe ax, ay;
+
+	if (TEST_FAIL())
+		return -1;
+
+	if (ec_point_to_affine(e, x ? ax : NULL, y ? ay : NULL,
+			       &point->p) < 0)
+		return -1;
+	if (x)
+		ec_fe_to_bin(e, x, ax);
+	if (y)
+		ec_fe_to_bin(e, y, ay);
+	os_memset(ax, 0, sizeof(ax));
+	os_memset(ay, 0, sizeof(ay));
+	return 0;
+}
+
+
+struct crypto_ec_point * crypto_ec_point_from_bin(struct crypto_ec *e,
+						  const u8 *val)
+{
+	struct crypto_ec_point *p;
+
+	if (TEST_FAIL())
+		return NULL;
+
+	p = os_zalloc(sizeof(*p));
+	if (!p)
+		return NULL;
+
+	if (ec_fe_from_bin(e, p->p.x, val) < 0 ||
+	    ec_fe_from_bin(e, p->p.y, val + e->curve->len) < 0) {
+		crypto_ec_point_deinit(p, 1);
+		return NULL;
+	}
+	os_memcpy(p->p.z, e->one, sizeof(p->p.z));
+
+	if (!ec_point_on_curve(e, &p->p)) {
+		crypto_ec_point_deinit(p, 1);
+		return NULL;
+	}
+
+	return p;
+}
+
+
+int crypto_ec_point_add(struct crypto_ec *e, const struct crypto_ec_point *a,
+			const struct crypto_ec_point *b,
+			struct crypto_ec_point *c)
+{
+	if (TEST_FAIL())
+		return -1;
+	ec_point_add(e, &c->p, &a->p, &b->p, 1);
+	return 0;
+}
+
+
+int crypto_ec_point_mul(struct crypto_ec *e, const struct crypto_ec_point *p,
+			const struct crypto_bignum *b,
+			struct crypto_ec_point *res)
+{
+	u8 k[EC_MAX_LEN];
+
+	if (TEST_FAIL())
+		return -1;
+	if (ec_scalar_from_bignum(e, b, k) < 0)
+		return -1;
+	ec_point_mul(e, &res->p, &p->p, k);
+	os_memset(k, 0, sizeof(k));
+	return 0;
+}
+
+
+int crypto_ec_point_invert(struct crypto_ec *e, struct crypto_ec_point *p)
+{
+	ec_fe zero;
+
+	if (TEST_FAIL())
+		return -1;
+	os_memset(zero, 0, sizeof(zero));
+	ec_fe_sub(e, p->p.y, zero, p->p.y);
+	return 0;
+}
+
+
+int crypto_ec_point_solve_y_coord(struct crypto_ec *e,
+				  struct crypto_ec_point *p,
+				  const struct crypto_bignum *x, int y_bit)
+{
+	u8 buf[EC_MAX_LEN];
+	ec_fe y2, y, t, zero;
+	int ret = -1;
+
+	if (TEST_FAIL())
+		return -1;
+
+	if (crypto_bignum_to_bin(x, buf, sizeof(buf), e->curve->len) !=
+	    (int) e->curve->len ||
+	    ec_fe_from_bin(e, t, buf) < 0)
+		goto fail;
+
+	/* y = (x^3 - 3x + b)^((p + 1) / 4) since p = 3 (mod 4) */
+	ec_fe_y_sqr(e, y2, t);
+	ec_fe_pow(e, y, y2, e->exp_sqrt);
+	ec_fe_sqr(e, zero, y);
+	if (os_memcmp(zero, y2, e->words * sizeof(u32)) != 0)
+		goto fail; /* x is not on the curve */
+
+	ec_fe_to_bin(e, buf, y);
+	if ((buf[e->curve->len - 1] & 1) != !!y_bit) {
+		os_memset(zero, 0, sizeof(zero));
+		ec_fe_sub(e, y, zero, y);
+	}
+
+	os_memcpy(p->p.x, t, sizeof(t));
+	os_memcpy(p->p.y, y, sizeof(y));
+	os_memcpy(p->p.z, e->one, sizeof(e->one));
+	ret = 0;
+fail:
+	os_memset(buf, 0, sizeof(buf));
+	os_memset(y, 0, sizeof(y));
+	return ret;
+}
+
+
+struct crypto_bignum *
+crypto_ec_point_compute_y_sqr(struct crypto_ec *e,
+			      const struct crypto_bignum *x)
+{
+	u8 buf[EC_MAX_LEN];
+	ec_fe t;
+	struct crypto_bignum *y_sqr = NULL;
+
+	if (TEST_FAIL())
+		return NULL;
+
+	if (crypto_bignum_to_bin(x, buf, sizeof(buf), e->curve->len) ==
+	    (int) e->curve->len &&
+	    ec_fe_from_bin(e, t, buf) == 0) {
+		ec_fe_y_sqr(e, t, t);
+		ec_fe_to_bin(e, buf, t);
+		y_sqr = crypto_bignum_init_set(buf, e->curve->len);
+	}
+
+	os_memset(buf, 0, sizeof(buf));
+	os_memset(t, 0, sizeof(t));
+	return y_sqr;
+}
+
+
+int crypto_ec_point_is_at_infinity(struct crypto_ec *e,
+				   const struct crypto_ec_point *p)
+{
+	return ec_fe_is_zero(e, p->p.z) ? 1 : 0;
+}
+
+
+int crypto_ec_point_is_on_curve(struct crypto_ec *e,
+				const struct crypto_ec_point *p)
+{
+	return ec_point_on_curve(e, &p->p);
+}
+
+
+int crypto_ec_point_cmp(const struct crypto_ec *e,
+			const struct crypto_ec_point *a,
+			const struct crypto_ec_point *b)
+{
+	ec_fe z1z1, z2z2, t1, t2;
+	u32 a_inf, b_inf;
+
+	a_inf = ec_fe_is_zero(e, a->p.z);
+	b_inf = ec_fe_is_zero(e, b->p.z);
+	if (a_inf || b_inf)
+		return !(a_inf && b_inf);
+
+	/* X1 * Z2^2 == X2 * Z1^2 and Y1 * Z2^3 == Y2 * Z1^3 */
+	ec_fe_sqr(e, z1z1, a->p.z);
+	ec_fe_sqr(e, z2z2, b->p.z);
+	ec_fe_mul(e, t1, a->p.x, z2z2);
+	ec_fe_mul(e, t2, b->p.x, z1z1);
+	if (os_memcmp(t1, t2, e->words * sizeof(u32)) != 0)
+		return 1;
+	ec_fe_mul(e, t1, a->p.y, z2z2);
+	ec_fe_mul(e, t1, t1, b->p.z);
+	ec_fe_mul(e, t2, b->p.y, z1z1);
+	ec_fe_mul(e, t2, t2, a->p.z);
+	return os_memcmp(t1, t2, e->words * sizeof(u32)) != 0;
+}
+
+
+struct crypto_ecdh {
+	struct crypto_ec *ec;
+	u8 priv[EC_MAX_LEN];
+	struct ec_point pub;
+};
+
+struct crypto_ecdh * crypto_ecdh_init(int group)
+{
+	struct crypto_ecdh *ecdh;
+	const struct ec_curve *curve;
+	size_t len;
+	u8 top_mask;
+	int i;
+
+	ecdh = os_zalloc(sizeof(*ecdh));
+	if (!ecdh)
+		return NULL;
+
+	ecdh->ec = crypto_ec_init(group);
+	if (!ecdh->ec)
+		goto fail;
+	curve = ecdh->ec->curve;
+	len = curve->len;
+	top_mask = curve->bits % 8 ? (1 << (curve->bits % 8)) - 1 : 0xff;
+
+	/* Private key: random value in range [1, order - 1] */
+	for (i = 0; ; i++) {
+		if (i == 100 || random_get_bytes(ecdh->priv, len) < 0)
+			goto fail;
+		ecdh->priv[0] &= top_mask;
+		if (os_memcmp(ecdh->priv, curve->order, len) < 0 &&
+		    !ec_scalar_is_zero(ecdh->priv, len))
+			break;
+	}
+
+	ec_point_mul(ecdh->ec, &ecdh->pub, &ecdh->ec->g, ecdh->priv);
+	return ecdh;
+fail:
+	crypto_ecdh_deinit(ecdh);
+	return NULL;
+}
+
+
+struct wpabuf * crypto_ecdh_get_pubkey(struct crypto_ecdh *ecdh, int inc_y)
+{
+	struct wpabuf *buf;
+	struct crypto_ec *e = ecdh->ec;
+	size_t len = e->curve->len;
+	ec_fe x, y;
+
+	if (ec_point_to_affine(e, x, y, &ecdh->pub) < 0)
+		return NULL;
+
+	buf = wpabuf_alloc(inc_y ? 2 * len : len);
+	if (!buf)
+		return NULL;
+	ec_fe_to_bin(e, wpabuf_put(buf, len), x);
+	if (inc_y)
+		ec_fe_to_bin(e, wpabuf_put(buf, len), y);
+	return buf;
+}
+
+
+struct wpabuf * crypto_ecdh_set_peerkey(struct crypto_ecdh *ecdh, int inc_y,
+					const u8 *key, size_t len)
+{
+	struct crypto_ec *e = ecdh->ec;
+	size_t prime_len = e->curve->len;
+	struct crypto_ec_point *pub = NULL;
+	struct crypto_bignum *x = NULL;
+	struct ec_point shared;
+	struct wpabuf *secret = NULL;
+	ec_fe sx;
+
+	if (len != (inc_y ? 2 : 1) * prime_len) {
+		wpa_printf(MSG_ERROR, "ECDH: Invalid peer public key length");
+		return NULL;
+	}
+
+	if (inc_y) {
+		pub = crypto_ec_point_from_bin(e, key);
+	} else {
+		x = crypto_bignum_init_set(key, len);
+		pub = crypto_ec_point_init(e);
+		if (x && pub && crypto_ec_point_solve_y_coord(e, pub, x, 0) < 0) {
+			crypto_ec_point_deinit(pub, 0);
+			pub = NULL;
+		}
+	}
+	if (!pub || !ec_point_on_curve(e, &pub->p)) {
+		wpa_printf(MSG_ERROR,
+			   "ECDH: Peer public key is not a valid curve point");
+		goto fail;
+	}
+
+	ec_point_mul_ladder(e, &shared, &pub->p, ecdh->priv);
+	if (ec_point_to_affine(e, sx, NULL, &shared) < 0) {
+		wpa_printf(MSG_ERROR, "ECDH: Shared secret is at infinity");
+		goto fail;
+	}
+
+	secret = wpabuf_alloc(prime_len);
+	if (secret)
+		ec_fe_to_bin(e, wpabuf_put(secret, prime_len), sx);
+
+fail:
+	os_memset(&shared, 0, sizeof(shared));
+	os_memset(sx, 0, sizeof(sx));
+	crypto_bignum_deinit(x, 0);
+	crypto_ec_point_deinit(pub, 0);
+	return secret;
+}
+
+
+void crypto_ecdh_deinit(struct crypto_ecdh *ecdh)
+{
+	if (ecdh) {
+		crypto_ec_deinit(ecdh->ec);
+		bin_clear_free(ecdh, sizeof(*ecdh));
+	}
+}
@@ -47,3 +47,220 @@ error:
 	bignum_deinit(bn_result);
 	return ret;
 }
+
+
+struct crypto_bignum * crypto_bignum_init(void)
+{
+	if (TEST_FAIL())
+		return NULL;
+	return (struct crypto_bignum *) bignum_init();
+}
+
+
+struct crypto_bignum * crypto_bignum_init_set(const u8 *buf, size_t len)
+{
+	struct bignum *bn;
+
+	if (TEST_FAIL())
+		return NULL;
+
+	bn = bignum_init();
+	if (bn && bignum_set_unsigned_bin(bn, buf, len) < 0) {
+		bignum_deinit(bn);
+		bn = NULL;
+	}
+	return (struct crypto_bignum *) bn;
+}
+
+
+void crypto_bignum_deinit(struct crypto_bignum *n, int clear)
+{
+	/* libtommath clears the digits with mp_clear() in all cases */
+	bignum_deinit((struct bignum *) n);
+}
+
+
+int crypto_bignum_to_bin(const struct crypto_bignum *a,
+			 u8 *buf, size_t buflen, size_t padlen)
+{
+	size_t num_bytes, offset;
+
+	if (TEST_FAIL())
+		return -1;
+
+	if (padlen > buflen)
+		return -1;
+
+	num_bytes = bignum_get_unsigned_bin_len((struct bignum *) a);
+	if (num_bytes > buflen)
+		return -1;
+	if (padlen > num_bytes)
+		offset = padlen - num_bytes;
+	else
+		offset = 0;
+
+	os_memset(buf, 0, offset);
+	if (bignum_get_unsigned_bin((const struct bignum *) a, buf + offset,
+				    NULL) < 0)
+		return -1;
+
+	return num_bytes + offset;
+}
+
+
+int crypto_bignum_add(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	return bignum_add((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_mod(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	return bignum_mod((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_exptmod(const struct crypto_bignum *a,
+			  const struct crypto_bignum *b,
+			  const struct crypto_bignum *c,
+			  struct crypto_bignum *d)
+{
+	if (TEST_FAIL())
+		return -1;
+
+	return bignum_exptmod((const struct bignum *) a,
+			      (const struct bignum *) b,
+			      (const struct bignum *) c, (struct bignum *) d);
+}
+
+
+int crypto_bignum_inverse(const struct crypto_bignum *a,
+			  const struct crypto_bignum *b,
+			  struct crypto_bignum *c)
+{
+	struct bignum *exp;
+	int res = -1;
+
+	if (TEST_FAIL())
+		return -1;
+
+	/*
+	 * The internal libtommath build leaves out mp_invmod(), so use Fermat's
+	 * little theorem: c = a^(b - 2) (mod b). This requires b to be a prime,
+	 * which holds for all the users (group prime or group order).
+	 */
+	exp = bignum_init();
+	if (!exp ||
+	    bignum_set_unsigned_bin(exp, (const u8 *) "\x02", 1) < 0 ||
+	    bignum_sub((const struct bignum *) b, exp, exp) < 0 ||
+	    bignum_exptmod((const struct bignum *) a, exp,
+			   (const struct bignum *) b, (struct bignum *) c) < 0)
+		goto fail;
+
+	/* a was not invertible (a = 0 mod b) */
+	if (bignum_cmp_d((struct bignum *) c, 0) == 0)
+		goto fail;
+	res = 0;
+fail:
+	bignum_deinit(exp);
+	return res;
+}
+
+
+int crypto_bignum_sub(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	if (TEST_FAIL())
+		return -1;
+	return bignum_sub((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_div(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b,
+		      struct crypto_bignum *c)
+{
+	if (TEST_FAIL())
+		return -1;
+	return bignum_div((const struct bignum *) a, (const struct bignum *) b,
+			  (struct bignum *) c);
+}
+
+
+int crypto_bignum_mulmod(const struct crypto_bignum *a,
+			 const struct crypto_bignum *b,
+			 const struct crypto_bignum *c,
+			 struct crypto_bignum *d)
+{
+	if (TEST_FAIL())
+		return -1;
+	return bignum_mulmod((const struct bignum *) a,
+			     (const struct bignum *) b,
+			     (const struct bignum *) c, (struct bignum *) d);
+}
+
+
+int crypto_bignum_cmp(const struct crypto_bignum *a,
+		      const struct crypto_bignum *b)
+{
+	return bignum_cmp((const struct bignum *) a, (const struct bignum *) b);
+}
+
+
+int crypto_bignum_bits(const struct crypto_bignum *a)
+{
+	return bignum_get_bits((const struct bignum *) a);
+}
+
+
+int crypto_bignum_is_zero(const struct crypto_bignum *a)
+{
+	return bignum_cmp_d((const struct bignum *) a, 0) == 0;
+}
+
+
+int crypto_bignum_is_one(const struct crypto_bignum *a)
+{
+	return bignum_cmp_d((const struct bignum *) a, 1) == 0;
+}
+
+
+int crypto_bignum_legendre(const struct crypto_bignum *a,
+			   const struct crypto_bignum *p)
+{
+	struct bignum *exp = NULL, *tmp = NULL;
+	int res = -2;
+
+	if (TEST_FAIL())
+		return -2;
+
+	exp = bignum_init();
+	tmp = bignum_init();
+	if (!exp || !tmp ||
+	    /* exp = (p-1) / 2 */
+	    bignum_set_unsigned_bin(tmp, (const u8 *) "\x02", 1) < 0 ||
+	    bignum_div((const struct bignum *) p, tmp, exp) < 0 ||
+	    bignum_exptmod((const struct bignum *) a, exp,
+			   (const struct bignum *) p, tmp) < 0)
+		goto fail;
+
+	if (bignum_cmp_d(tmp, 1) == 0)
+		res = 1;
+	else if (bignum_cmp_d(tmp, 0) == 0)
+		res = 0;
+	else
+		res = -1;
+
+fail:
+	bignum_deinit(tmp);
+	bignum_deinit(exp);
+	return res;
+}
@@ -2664,6 +2664,22 @@ struct wpa_driver_ops {
 	int (*read_sta_data)(void *priv, struct hostap_sta_driver_data *data,
 			     const u8 *addr);
 
+	/**
+	 * read_all_sta_data - Fetch data for all stations
+	 * @priv: Private driver interface data
+	 * @cb: Function to call for each station
+	 * @ctx: Context data for the callback
+	 * Returns: 0 on success, -1 on failure
+	 *
+	 * This is an optional alternative for read_sta_data() that fetches
+	 * data for all the stations of the interface with a single request.
+	 */
+	int (*read_all_sta_data)(void *priv,
+				 void (*cb)(void *ctx, const u8 *addr,
+					    const struct hostap_sta_driver_data
+					    *data),
+				 void *ctx);
+
 	/**
 	 * hapd_send_eapol - Send an EAPOL packet (AP only)
 	 * @priv: private driver interface data
@@ -22,19 +22,51 @@
 #endif /* CONFIG_SQLITE */
 
 #include "common.h"
+#include "list.h"
+#include "timer_list.h"
 #include "crypto/random.h"
 #include "eap_common/eap_sim_common.h"
 #include "eap_server/eap_sim_db.h"
 #include "eloop.h"
 
+#define EAP_SIM_DB_HASH_SIZE 1024
+/* Maximum time (in milliseconds) an update waits before it is written */
+#define EAP_SIM_DB_FLUSH_INTERVAL 100
+/* Number of queued updates that are written without waiting any longer */
+#define EAP_SIM_DB_FLUSH_BATCH 256
+/*
+ * Maximum number of cached pseudonym and reauth entries (each) when the
+ * entries are also stored in a database. Entries that have not been used for
+ * EAP_SIM_DB_CACHE_MIN_AGE seconds are dropped from the cache (least recently
+ * used first) to stay within the limit. The minimum age is well beyond the
+ * duration of an EAP exchange, so a reauth entry is not freed while an EAP
+ * session may still be holding a pointer to it.
+ */
+#define EAP_SIM_DB_CACHE_SIZE 8192
+#define EAP_SIM_DB_CACHE_MIN_AGE 300
+/* Bucket i of the latency histogram covers [2^i, 2^(i+1)) microseconds */
+#define EAP_SIM_DB_LATENCY_BUCKETS 24
+
 struct eap_sim_pseudonym {
-	struct eap_sim_pseudonym *next;
+	struct eap_sim_pseudonym *next; /* next in the permanent hash bucket */
+	struct eap_sim_pseudonym *hnext; /* next in the pseudonym hash bucket */
+	struct dl_list dirty; /* data->dirty_pseudonyms */
+	struct dl_list lru; /* data->pseudonym_lru */
+	struct os_reltime last_used;
 	char *permanent; /* permanent username */
 	char *pseudonym; /* pseudonym username */
 };
 
+struct eap_sim_db_deleted {
+	struct dl_list list; /* data->deleted_reauths */
+	char *permanent;
+};
+
 struct eap_sim_db_pending {
-	struct eap_sim_db_pending *next;
+	struct eap_sim_db_pending *next; /* next in the IMSI hash bucket */
+	struct timer_list_entry timer; /* data->pending_timers */
+	struct os_reltime sent;
+	int expired;
 	char imsi[20];
 	enum { PENDING, SUCCESS, FAILURE } state;
 	void *cb_session_ctx;
@@ -63,26 +95,314 @@ struct eap_sim_db_data {
 	char *local_sock;
 	void (*get_complete_cb)(void *ctx, void *session_ctx);
 	void *ctx;
-	struct eap_sim_pseudonym *pseudonyms;
-	struct eap_sim_reauth *reauths;
-	struct eap_sim_db_pending *pending;
+	/* pseudonyms and reauth entries hashed by permanent username */
+	struct eap_sim_pseudonym *pseudonyms[EAP_SIM_DB_HASH_SIZE];
+	struct eap_sim_reauth *reauths[EAP_SIM_DB_HASH_SIZE];
+	/* the same entries hashed by pseudonym and reauth_id */
+	struct eap_sim_pseudonym *pseudonym_ids[EAP_SIM_DB_HASH_SIZE];
+	struct eap_sim_reauth *reauth_ids[EAP_SIM_DB_HASH_SIZE];
+	/* the same entries ordered from least to most recently used */
+	struct dl_list pseudonym_lru;
+	struct dl_list reauth_lru;
+	unsigned int num_pseudonyms;
+	unsigned int num_reauths;
+	/* queries to the external server hashed by IMSI */
+	struct eap_sim_db_pending *pending[EAP_SIM_DB_HASH_SIZE];
+	struct timer_list pending_timers;
+	unsigned int num_pending;
 	unsigned int eap_sim_db_timeout;
+
+	unsigned int queries;
+	unsigned int responses;
+	unsigned int failures;
+	unsigned int timeouts;
+	unsigned int unexpected;
+	u64 latency_total;
+	unsigned int latency_max;
+	unsigned int latency_hist[EAP_SIM_DB_LATENCY_BUCKETS];
+
 #ifdef CONFIG_SQLITE
 	sqlite3 *sqlite_db;
-	char db_tmp_identity[100];
-	char db_tmp_pseudonym_str[100];
-	struct eap_sim_pseudonym db_tmp_pseudonym;
-	struct eap_sim_reauth db_tmp_reauth;
+	sqlite3_stmt *stmt_add_pseudonym;
+	sqlite3_stmt *stmt_get_pseudonym;
+	sqlite3_stmt *stmt_add_reauth;
+	sqlite3_stmt *stmt_get_reauth;
+	sqlite3_stmt *stmt_del_reauth;
+	/* updates not yet written to the database */
+	struct dl_list dirty_pseudonyms;
+	struct dl_list dirty_reauths;
+	struct dl_list deleted_reauths;
+	unsigned int num_dirty;
 #endif /* CONFIG_SQLITE */
 };
 
 
-static void eap_sim_db_del_timeout(void *eloop_ctx, void *user_ctx);
-static void eap_sim_db_query_timeout(void *eloop_ctx, void *user_ctx);
+static unsigned int eap_sim_db_hash(const char *str)
+{
+	unsigned int hash = 5381;
+
+	while (*str)
+		hash = (hash << 5) + hash + (u8) *str++;
+	return hash & (EAP_SIM_DB_HASH_SIZE - 1);
+}
+
+
+static struct eap_sim_pseudonym *
+eap_sim_db_get_pseudonym_perm(struct eap_sim_db_data *data,
+			      const char *permanent)
+{
+	struct eap_sim_pseudonym *p;
+
+	p = data->pseudonyms[eap_sim_db_hash(permanent)];
+	while (p && os_strcmp(p->permanent, permanent) != 0)
+		p = p->next;
+	return p;
+}
+
+
+static struct eap_sim_pseudonym *
+eap_sim_db_get_pseudonym_id(struct eap_sim_db_data *data,
+			    const char *pseudonym)
+{
+	struct eap_sim_pseudonym *p;
+
+	p = data->pseudonym_ids[eap_sim_db_hash(pseudonym)];
+	while (p && os_strcmp(p->pseudonym, pseudonym) != 0)
+		p = p->hnext;
+	return p;
+}
+
+
+static void eap_sim_db_pseudonym_id_add(struct eap_sim_db_data *data,
+					struct eap_sim_pseudonym *p)
+{
+	unsigned int h = eap_sim_db_hash(p->pseudonym);
+
+	p->hnext = data->pseudonym_ids[h];
+	data->pseudonym_ids[h] = p;
+}
+
+
+static void eap_sim_db_pseudonym_id_del(struct eap_sim_db_data *data,
+					struct eap_sim_pseudonym *p)
+{
+	struct eap_sim_pseudonym **pp;
+
+	pp = &data->pseudonym_ids[eap_sim_db_hash(p->pseudonym)];
+	while (*pp && *pp != p)
+		pp = &(*pp)->hnext;
+	if (*pp)
+		*pp = p->hnext;
+}
+
+
+static struct eap_sim_pseudonym *
+eap_sim_db_new_pseudonym(struct eap_sim_db_data *data, const char *permanent,
+			 char *pseudonym)
+{
+	struct eap_sim_pseudonym *p;
+	unsigned int h;
+
+	p = os_zalloc(sizeof(*p));
+	if (!p)
+		return NULL;
+	p->permanent = os_strdup(permanent);
+	if (!p->permanent) {
+		os_free(p);
+		return NULL;
+	}
+	p->pseudonym = pseudonym;
+
+	h = eap_sim_db_hash(permanent);
+	p->next = data->pseudonyms[h];
+	data->pseudonyms[h] = p;
+	eap_sim_db_pseudonym_id_add(data, p);
+	os_get_reltime(&p->last_used);
+	dl_list_add_tail(&data->pseudonym_lru, &p->lru);
+	data->num_pseudonyms++;
+	return p;
+}
+
+
+static void eap_sim_db_touch_pseudonym(struct eap_sim_db_data *data,
+				       struct eap_sim_pseudonym *p)
+{
+	os_get_reltime(&p->last_used);
+	dl_list_del(&p->lru);
+	dl_list_add_tail(&data->pseudonym_lru, &p->lru);
+}
+
+
+static struct eap_sim_reauth *
+eap_sim_db_get_reauth_perm(struct eap_sim_db_data *data, const char *permanent)
+{
+	struct eap_sim_reauth *r;
+
+	r = data->reauths[eap_sim_db_hash(permanent)];
+	while (r && os_strcmp(r->permanent, permanent) != 0)
+		r = r->next;
+	return r;
+}
+
+
+static struct eap_sim_reauth *
+eap_sim_db_get_reauth_id(struct eap_sim_db_data *data, const char *reauth_id)
+{
+	struct eap_sim_reauth *r;
+
+	r = data->reauth_ids[eap_sim_db_hash(reauth_id)];
+	while (r && os_strcmp(r->reauth_id, reauth_id) != 0)
+		r = r->hnext;
+	return r;
+}
+
+
+static void eap_sim_db_reauth_id_add(struct eap_sim_db_data *data,
+				     struct eap_sim_reauth *r)
+{
+	unsigned int h = eap_sim_db_hash(r->reauth_id);
+
+	r->hnext = data->reauth_ids[h];
+	data->reauth_ids[h] = r;
+}
+
+
+static void eap_sim_db_reauth_id_del(struct eap_sim_db_data *data,
+				     struct eap_sim_reauth *r)
+{
+	struct eap_sim_reauth **pp;
+
+	pp = &data->reauth_ids[eap_sim_db_hash(r->reauth_id)];
+	while (*pp && *pp != r)
+		pp = &(*pp)->hnext;
+	if (*pp)
+		*pp = r->hnext;
+}
+
+
+static struct eap_sim_reauth *
+eap_sim_db_new_reauth(struct eap_sim_db_data *data, const char *permanent,
+		      char *reauth_id)
+{
+	struct eap_sim_reauth *r;
+	unsigned int h;
+
+	r = os_zalloc(sizeof(*r));
+	if (!r)
+		return NULL;
+	r->permanent = os_strdup(permanent);
+	if (!r->permanent) {
+		os_free(r);
+		return NULL;
+	}
+	r->reauth_id = reauth_id;
+
+	h = eap_sim_db_hash(permanent);
+	r->next = data->reauths[h];
+	data->reauths[h] = r;
+	eap_sim_db_reauth_id_add(data, r);
+	os_get_reltime(&r->last_used);
+	dl_list_add_tail(&data->reauth_lru, &r->lru);
+	data->num_reauths++;
+	return r;
+}
+
+
+static void eap_sim_db_touch_reauth(struct eap_sim_db_data *data,
+				    struct eap_sim_reauth *r)
+{
+	os_get_reltime(&r->last_used);
+	dl_list_del(&r->lru);
+	dl_list_add_tail(&data->reauth_lru, &r->lru);
+}
+
+
+static int eap_sim_db_unlink_reauth(struct eap_sim_db_data *data,
+				    struct eap_sim_reauth *r)
+{
+	struct eap_sim_reauth **pp;
+
+	pp = &data->reauths[eap_sim_db_hash(r->permanent)];
+	while (*pp && *pp != r)
+		pp = &(*pp)->next;
+	if (!*pp)
+		return -1;
+	*pp = r->next;
+	eap_sim_db_reauth_id_del(data, r);
+	dl_list_del(&r->lru);
+	data->num_reauths--;
+	return 0;
+}
+
+
+static void eap_sim_db_free_pseudonym(struct eap_sim_pseudonym *p)
+{
+	os_free(p->permanent);
+	os_free(p->pseudonym);
+	os_free(p);
+}
+
+
+static void eap_sim_db_free_reauth(struct eap_sim_reauth *r)
+{
+	os_free(r->permanent);
+	os_free(r->reauth_id);
+	os_free(r);
+}
 
 
 #ifdef CONFIG_SQLITE
 
+/*
+ * With a database, the hash tables above work as a cache. Entries are loaded
+ * from the database on first use and updates are written behind in batches,
+ * each batch within a single transaction.
+ */
+
+static void db_flush_timeout(void *eloop_ctx, void *user_ctx);
+
+
+static int db_cache_expired(struct os_reltime *last_used)
+{
+	struct os_reltime age;
+
+	os_reltime_age(last_used, &age);
+	return age.sec >= EAP_SIM_DB_CACHE_MIN_AGE;
+}
+
+
+/* Drop unused entries that have already been written to the database */
+static void db_cache_evict(struct eap_sim_db_data *data)
+{
+	struct eap_sim_pseudonym *p, **pp;
+	struct eap_sim_reauth *r;
+
+	while (data->num_pseudonyms > EAP_SIM_DB_CACHE_SIZE) {
+		p = dl_list_first(&data->pseudonym_lru,
+				  struct eap_sim_pseudonym, lru);
+		if (p->dirty.next || !db_cache_expired(&p->last_used))
+			break;
+		pp = &data->pseudonyms[eap_sim_db_hash(p->permanent)];
+		while (*pp && *pp != p)
+			pp = &(*pp)->next;
+		if (*pp)
+			*pp = p->next;
+		eap_sim_db_pseudonym_id_del(data, p);
+		dl_list_del(&p->lru);
+		data->num_pseudonyms--;
+		eap_sim_db_free_pseudonym(p);
+	}
+
+	while (data->num_reauths > EAP_SIM_DB_CACHE_SIZE) {
+		r = dl_list_first(&data->reauth_lru, struct eap_sim_reauth, lru);
+		if (r->dirty.next || !db_cache_expired(&r->last_used) ||
+		    eap_sim_db_unlink_reauth(data, r) < 0)
+			break;
+		eap_sim_db_free_reauth(r);
+	}
+}
+
+
 static int db_table_exists(sqlite3 *db, const char *name)
 {
 	char cmd[128];
@@ -138,236 +458,387 @@ static int db_table_create_reauth(sqlite3 *db)
 }
 
 
-static sqlite3 * db_open(const char *db_file)
+static int db_prepare(sqlite3 *db, sqlite3_stmt **stmt, const char *sql)
+{
+	if (sqlite3_prepare_v2(db, sql, -1, stmt, NULL) != SQLITE_OK) {
+		wpa_printf(MSG_ERROR, "EAP-SIM DB: Failed to prepare '%s': %s",
+			   sql, sqlite3_errmsg(db));
+		return -1;
+	}
+	return 0;
+}
+
+
+static void db_close(struct eap_sim_db_data *data)
+{
+	sqlite3_finalize(data->stmt_add_pseudonym);
+	sqlite3_finalize(data->stmt_get_pseudonym);
+	sqlite3_finalize(data->stmt_add_reauth);
+	sqlite3_finalize(data->stmt_get_reauth);
+	sqlite3_finalize(data->stmt_del_reauth);
+	data->stmt_add_pseudonym = NULL;
+	data->stmt_get_pseudonym = NULL;
+	data->stmt_add_reauth = NULL;
+	data->stmt_get_reauth = NULL;
+	data->stmt_del_reauth = NULL;
+	sqlite3_close(data->sqlite_db);
+	data->sqlite_db = NULL;
+}
+
+
+static int db_open(struct eap_sim_db_data *data, const char *db_file)
 {
 	sqlite3 *db;
+	char *err = NULL;
 
 	if (sqlite3_open(db_file, &db)) {
 		wpa_printf(MSG_ERROR, "EAP-SIM DB: Failed to open database "
 			   "%s: %s", db_file, sqlite3_errmsg(db));
 		sqlite3_close(db);
-		return NULL;
+		return -1;
 	}
+	data->sqlite_db = db;
 
 	if (!db_table_exists(db, "pseudonyms") &&
-	    db_table_create_pseudonym(db) < 0) {
-		sqlite3_close(db);
-		return NULL;
-	}
+	    db_table_create_pseudonym(db) < 0)
+		goto fail;
 
 	if (!db_table_exists(db, "reauth") &&
-	    db_table_create_reauth(db) < 0) {
-		sqlite3_close(db);
-		return NULL;
+	    db_table_create_reauth(db) < 0)
+		goto fail;
+
+	/* Lookups are done based on the pseudonym and reauth_id */
+	if (sqlite3_exec(db,
+			 "CREATE INDEX IF NOT EXISTS pseudonyms_pseudonym "
+			 "ON pseudonyms(pseudonym);"
+			 "CREATE INDEX IF NOT EXISTS reauth_reauth_id "
+			 "ON reauth(reauth_id);",
+			 NULL, NULL, &err) != SQLITE_OK) {
+		wpa_printf(MSG_ERROR, "EAP-SIM DB: SQLite error: %s", err);
+		sqlite3_free(err);
+		goto fail;
 	}
 
-	return db;
+	if (db_prepare(db, &data->stmt_add_pseudonym,
+		       "INSERT OR REPLACE INTO pseudonyms "
+		       "(permanent, pseudonym) VALUES (?, ?);") ||
+	    db_prepare(db, &data->stmt_get_pseudonym,
+		       "SELECT permanent FROM pseudonyms WHERE pseudonym=?;") ||
+	    db_prepare(db, &data->stmt_add_reauth,
+		       "INSERT OR REPLACE INTO reauth "
+		       "(permanent, reauth_id, counter, mk, k_encr, k_aut, "
+		       "k_re) VALUES (?, ?, ?, ?, ?, ?, ?);") ||
+	    db_prepare(db, &data->stmt_get_reauth,
+		       "SELECT permanent, counter, mk, k_encr, k_aut, k_re "
+		       "FROM reauth WHERE reauth_id=?;") ||
+	    db_prepare(db, &data->stmt_del_reauth,
+		       "DELETE FROM reauth WHERE permanent=?;"))
+		goto fail;
+
+	return 0;
+
+fail:
+	db_close(data);
+	return -1;
 }
 
 
-static int valid_db_string(const char *str)
+static void db_step(struct eap_sim_db_data *data, sqlite3_stmt *stmt)
 {
-	const char *pos = str;
-	while (*pos) {
-		if ((*pos < '0' || *pos > '9') &&
-		    (*pos < 'a' || *pos > 'f'))
-			return 0;
-		pos++;
-	}
-	return 1;
+	if (sqlite3_step(stmt) != SQLITE_DONE)
+		wpa_printf(MSG_ERROR, "EAP-SIM DB: SQLite error: %s",
+			   sqlite3_errmsg(data->sqlite_db));
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
 }
 
 
-static int db_add_pseudonym(struct eap_sim_db_data *data,
-			    const char *permanent, char *pseudonym)
+static void db_bind_hex(sqlite3_stmt *stmt, int col, const u8 *bin,
+			size_t len)
 {
-	char cmd[128];
+	char hex[2 * EAP_AKA_PRIME_K_RE_LEN + 1];
+
+	wpa_snprintf_hex(hex, sizeof(hex), bin, len);
+	sqlite3_bind_text(stmt, col, hex, -1, SQLITE_TRANSIENT);
+}
+
+
+static void db_column_hex(sqlite3_stmt *stmt, int col, u8 *bin, size_t len)
+{
+	const char *hex = (const char *) sqlite3_column_text(stmt, col);
+
+	if (hex)
+		hexstr2bin(hex, bin, len);
+}
+
+
+static void db_flush(struct eap_sim_db_data *data)
+{
+	struct eap_sim_db_deleted *d;
+	struct eap_sim_pseudonym *p;
+	struct eap_sim_reauth *r;
 	char *err = NULL;
+	sqlite3_stmt *stmt;
 
-	if (!valid_db_string(permanent) || !valid_db_string(pseudonym)) {
-		os_free(pseudonym);
-		return -1;
+	eloop_cancel_timeout(db_flush_timeout, data, NULL);
+	if (!data->num_dirty)
+		return;
+
+	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Writing %u update(s) to database",
+		   data->num_dirty);
+	if (sqlite3_exec(data->sqlite_db, "BEGIN;", NULL, NULL, &err) !=
+	    SQLITE_OK) {
+		wpa_printf(MSG_ERROR, "EAP-SIM DB: SQLite error: %s", err);
+		sqlite3_free(err);
+		err = NULL;
+	}
+
+	/*
+	 * Deletions go first since a reauth entry may have been removed and
+	 * then added again for the same permanent username.
+	 */
+	stmt = data->stmt_del_reauth;
+	while ((d = dl_list_first(&data->deleted_reauths,
+				  struct eap_sim_db_deleted, list))) {
+		dl_list_del(&d->list);
+		sqlite3_bind_text(stmt, 1, d->permanent, -1, SQLITE_STATIC);
+		db_step(data, stmt);
+		os_free(d->permanent);
+		os_free(d);
+	}
+
+	stmt = data->stmt_add_pseudonym;
+	while ((p = dl_list_first(&data->dirty_pseudonyms,
+				  struct eap_sim_pseudonym, dirty))) {
+		dl_list_del(&p->dirty);
+		sqlite3_bind_text(stmt, 1, p->permanent, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 2, p->pseudonym, -1, SQLITE_STATIC);
+		db_step(data, stmt);
 	}
 
-	os_snprintf(cmd, sizeof(cmd), "INSERT OR REPLACE INTO pseudonyms "
-		    "(permanent, pseudonym) VALUES ('%s', '%s');",
-		    permanent, pseudonym);
-	os_free(pseudonym);
-	if (sqlite3_exec(data->sqlite_db, cmd, NULL, NULL, &err) != SQLITE_OK)
-	{
+	stmt = data->stmt_add_reauth;
+	while ((r = dl_list_first(&data->dirty_reauths,
+				  struct eap_sim_reauth, dirty))) {
+		dl_list_del(&r->dirty);
+		sqlite3_bind_text(stmt, 1, r->permanent, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 2, r->reauth_id, -1, SQLITE_STATIC);
+		sqlite3_bind_int(stmt, 3, r->counter);
+		db_bind_hex(stmt, 4, r->mk, EAP_SIM_MK_LEN);
+		db_bind_hex(stmt, 5, r->k_encr, EAP_SIM_K_ENCR_LEN);
+		db_bind_hex(stmt, 6, r->k_aut, EAP_AKA_PRIME_K_AUT_LEN);
+		db_bind_hex(stmt, 7, r->k_re, EAP_AKA_PRIME_K_RE_LEN);
+		db_step(data, stmt);
+	}
+
+	data->num_dirty = 0;
+	if (sqlite3_exec(data->sqlite_db, "COMMIT;", NULL, NULL, &err) !=
+	    SQLITE_OK) {
 		wpa_printf(MSG_ERROR, "EAP-SIM DB: SQLite error: %s", err);
 		sqlite3_free(err);
-		return -1;
 	}
+}
 
-	return 0;
+
+static void db_flush_timeout(void *eloop_ctx, void *user_ctx)
+{
+	db_flush(eloop_ctx);
 }
 
 
-static int get_pseudonym_cb(void *ctx, int argc, char *argv[], char *col[])
+static void db_queue(struct eap_sim_db_data *data, struct dl_list *list,
+		     struct dl_list *item)
 {
-	struct eap_sim_db_data *data = ctx;
-	int i;
+	if (item->next)
+		return; /* already queued */
+	dl_list_add_tail(list, item);
+	if (++data->num_dirty >= EAP_SIM_DB_FLUSH_BATCH)
+		db_flush(data);
+	else if (data->num_dirty == 1)
+		eloop_register_timeout(0, EAP_SIM_DB_FLUSH_INTERVAL * 1000,
+				       db_flush_timeout, data, NULL);
+}
 
-	for (i = 0; i < argc; i++) {
-		if (os_strcmp(col[i], "permanent") == 0 && argv[i]) {
-			os_strlcpy(data->db_tmp_identity, argv[i],
-				   sizeof(data->db_tmp_identity));
-		}
-	}
 
-	return 0;
+static void db_unqueue(struct eap_sim_db_data *data, struct dl_list *item)
+{
+	if (!item->next)
+		return;
+	dl_list_del(item);
+	data->num_dirty--;
 }
 
 
-static char *
+static void db_add_pseudonym(struct eap_sim_db_data *data,
+			     struct eap_sim_pseudonym *p)
+{
+	if (!data->sqlite_db)
+		return;
+	db_queue(data, &data->dirty_pseudonyms, &p->dirty);
+	db_cache_evict(data);
+}
+
+
+static struct eap_sim_pseudonym *
 db_get_pseudonym(struct eap_sim_db_data *data, const char *pseudonym)
 {
-	char cmd[128];
+	struct eap_sim_pseudonym *p = NULL;
+	sqlite3_stmt *stmt = data->stmt_get_pseudonym;
+	char *id;
 
-	if (!valid_db_string(pseudonym))
+	if (!data->sqlite_db)
 		return NULL;
-	os_memset(&data->db_tmp_identity, 0, sizeof(data->db_tmp_identity));
-	os_snprintf(cmd, sizeof(cmd),
-		    "SELECT permanent FROM pseudonyms WHERE pseudonym='%s';",
-		    pseudonym);
-	if (sqlite3_exec(data->sqlite_db, cmd, get_pseudonym_cb, data, NULL) !=
-	    SQLITE_OK)
-		return NULL;
-	if (data->db_tmp_identity[0] == '\0')
-		return NULL;
-	return data->db_tmp_identity;
+
+	/*
+	 * Pending updates are all in the cache, so this lookup missed them. The
+	 * database may still have an older pseudonym for a permanent username
+	 * that is cached with a newer one; that is checked below.
+	 */
+	sqlite3_bind_text(stmt, 1, pseudonym, -1, SQLITE_STATIC);
+	if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0)) {
+		const char *permanent;
+
+		permanent = (const char *) sqlite3_column_text(stmt, 0);
+		id = os_strdup(pseudonym);
+		if (id && eap_sim_db_get_pseudonym_perm(data, permanent)) {
+			/* The cached entry has a newer pseudonym */
+			os_free(id);
+		} else if (id) {
+			p = eap_sim_db_new_pseudonym(data, permanent, id);
+			if (!p)
+				os_free(id);
+		}
+	}
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	if (p)
+		db_cache_evict(data);
+
+	return p;
 }
 
 
-static int db_add_reauth(struct eap_sim_db_data *data, const char *permanent,
-			 char *reauth_id, u16 counter, const u8 *mk,
-			 const u8 *k_encr, const u8 *k_aut, const u8 *k_re)
+static void db_add_reauth(struct eap_sim_db_data *data,
+			  struct eap_sim_reauth *r)
 {
-	char cmd[2000], *pos, *end;
-	char *err = NULL;
+	if (!data->sqlite_db)
+		return;
+	db_queue(data, &data->dirty_reauths, &r->dirty);
+	db_cache_evict(data);
+}
 
-	if (!valid_db_string(permanent) || !valid_db_string(reauth_id)) {
-		os_free(reauth_id);
-		return -1;
-	}
 
-	pos = cmd;
-	end = pos + sizeof(cmd);
-	pos += os_snprintf(pos, end - pos, "INSERT OR REPLACE INTO reauth "
-			   "(permanent, reauth_id, counter%s%s%s%s) "
-			   "VALUES ('%s', '%s', %u",
-			   mk ? ", mk" : "",
-			   k_encr ? ", k_encr" : "",
-			   k_aut ? ", k_aut" : "",
-			   k_re ? ", k_re" : "",
-			   permanent, reauth_id, counter);
-	os_free(reauth_id);
-
-	if (mk) {
-		pos += os_snprintf(pos, end - pos, ", '");
-		pos += wpa_snprintf_hex(pos, end - pos, mk, EAP_SIM_MK_LEN);
-		pos += os_snprintf(pos, end - pos, "'");
-	}
+static int db_reauth_deleted(struct eap_sim_db_data *data,
+			     const char *permanent)
+{
+	struct eap_sim_db_deleted *d;
 
-	if (k_encr) {
-		pos += os_snprintf(pos, end - pos, ", '");
-		pos += wpa_snprintf_hex(pos, end - pos, k_encr,
-					EAP_SIM_K_ENCR_LEN);
-		pos += os_snprintf(pos, end - pos, "'");
+	dl_list_for_each(d, &data->deleted_reauths, struct eap_sim_db_deleted,
+			 list) {
+		if (os_strcmp(d->permanent, permanent) == 0)
+			return 1;
 	}
+	return 0;
+}
 
-	if (k_aut) {
-		pos += os_snprintf(pos, end - pos, ", '");
-		pos += wpa_snprintf_hex(pos, end - pos, k_aut,
-					EAP_AKA_PRIME_K_AUT_LEN);
-		pos += os_snprintf(pos, end - pos, "'");
-	}
 
-	if (k_re) {
-		pos += os_snprintf(pos, end - pos, ", '");
-		pos += wpa_snprintf_hex(pos, end - pos, k_re,
-					EAP_AKA_PRIME_K_RE_LEN);
-		pos += os_snprintf(pos, end - pos, "'");
-	}
+static struct eap_sim_reauth *
+db_get_reauth(struct eap_sim_db_data *data, const char *reauth_id)
+{
+	struct eap_sim_reauth *r = NULL;
+	sqlite3_stmt *stmt = data->stmt_get_reauth;
+	char *id;
 
-	os_snprintf(pos, end - pos, ");");
+	if (!data->sqlite_db)
+		return NULL;
 
-	if (sqlite3_exec(data->sqlite_db, cmd, NULL, NULL, &err) != SQLITE_OK)
-	{
-		wpa_printf(MSG_ERROR, "EAP-SIM DB: SQLite error: %s", err);
-		sqlite3_free(err);
-		return -1;
+	/*
+	 * Pending additions are all in the cache, so this lookup missed them.
+	 * The database may still have an entry that has been replaced in the
+	 * cache or removed with the deletion not yet written.
+	 */
+	sqlite3_bind_text(stmt, 1, reauth_id, -1, SQLITE_STATIC);
+	if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0)) {
+		const char *permanent;
+
+		permanent = (const char *) sqlite3_column_text(stmt, 0);
+		id = os_strdup(reauth_id);
+		if (id && (eap_sim_db_get_reauth_perm(data, permanent) ||
+			   db_reauth_deleted(data, permanent))) {
+			/* The cached entry is newer or was removed */
+			os_free(id);
+		} else if (id) {
+			r = eap_sim_db_new_reauth(data, permanent, id);
+			if (!r)
+				os_free(id);
+		}
+		if (r) {
+			r->counter = sqlite3_column_int(stmt, 1);
+			db_column_hex(stmt, 2, r->mk, sizeof(r->mk));
+			db_column_hex(stmt, 3, r->k_encr, sizeof(r->k_encr));
+			db_column_hex(stmt, 4, r->k_aut, sizeof(r->k_aut));
+			db_column_hex(stmt, 5, r->k_re, sizeof(r->k_re));
+		}
 	}
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	if (r)
+		db_cache_evict(data);
 
-	return 0;
+	return r;
 }
 
 
-static int get_reauth_cb(void *ctx, int argc, char *argv[], char *col[])
+static void db_remove_reauth(struct eap_sim_db_data *data,
+			     struct eap_sim_reauth *reauth)
 {
-	struct eap_sim_db_data *data = ctx;
-	int i;
-	struct eap_sim_reauth *reauth = &data->db_tmp_reauth;
-
-	for (i = 0; i < argc; i++) {
-		if (os_strcmp(col[i], "permanent") == 0 && argv[i]) {
-			os_strlcpy(data->db_tmp_identity, argv[i],
-				   sizeof(data->db_tmp_identity));
-			reauth->permanent = data->db_tmp_identity;
-		} else if (os_strcmp(col[i], "counter") == 0 && argv[i]) {
-			reauth->counter = atoi(argv[i]);
-		} else if (os_strcmp(col[i], "mk") == 0 && argv[i]) {
-			hexstr2bin(argv[i], reauth->mk, sizeof(reauth->mk));
-		} else if (os_strcmp(col[i], "k_encr") == 0 && argv[i]) {
-			hexstr2bin(argv[i], reauth->k_encr,
-				   sizeof(reauth->k_encr));
-		} else if (os_strcmp(col[i], "k_aut") == 0 && argv[i]) {
-			hexstr2bin(argv[i], reauth->k_aut,
-				   sizeof(reauth->k_aut));
-		} else if (os_strcmp(col[i], "k_re") == 0 && argv[i]) {
-			hexstr2bin(argv[i], reauth->k_re,
-				   sizeof(reauth->k_re));
-		}
+	struct eap_sim_db_deleted *d;
+
+	if (!data->sqlite_db)
+		return;
+
+	db_unqueue(data, &reauth->dirty);
+	d = os_zalloc(sizeof(*d));
+	if (!d)
+		return;
+	d->permanent = os_strdup(reauth->permanent);
+	if (!d->permanent) {
+		os_free(d);
+		return;
 	}
+	db_queue(data, &data->deleted_reauths, &d->list);
+}
 
-	return 0;
+#else /* CONFIG_SQLITE */
+
+static void db_add_pseudonym(struct eap_sim_db_data *data,
+			     struct eap_sim_pseudonym *p)
+{
+}
+
+
+static struct eap_sim_pseudonym *
+db_get_pseudonym(struct eap_sim_db_data *data, const char *pseudonym)
+{
+	return NULL;
+}
+
+
+static void db_add_reauth(struct eap_sim_db_data *data,
+			  struct eap_sim_reauth *r)
+{
 }
 
 
 static struct eap_sim_reauth *
 db_get_reauth(struct eap_sim_db_data *data, const char *reauth_id)
 {
-	char cmd[256];
-
-	if (!valid_db_string(reauth_id))
-		return NULL;
-	os_memset(&data->db_tmp_reauth, 0, sizeof(data->db_tmp_reauth));
-	os_strlcpy(data->db_tmp_pseudonym_str, reauth_id,
-		   sizeof(data->db_tmp_pseudonym_str));
-	data->db_tmp_reauth.reauth_id = data->db_tmp_pseudonym_str;
-	os_snprintf(cmd, sizeof(cmd),
-		    "SELECT * FROM reauth WHERE reauth_id='%s';", reauth_id);
-	if (sqlite3_exec(data->sqlite_db, cmd, get_reauth_cb, data, NULL) !=
-	    SQLITE_OK)
-		return NULL;
-	if (data->db_tmp_reauth.permanent == NULL)
-		return NULL;
-	return &data->db_tmp_reauth;
+	return NULL;
 }
 
 
 static void db_remove_reauth(struct eap_sim_db_data *data,
 			     struct eap_sim_reauth *reauth)
 {
-	char cmd[256];
-
-	if (!valid_db_string(reauth->permanent))
-		return;
-	os_snprintf(cmd, sizeof(cmd),
-		    "DELETE FROM reauth WHERE permanent='%s';",
-		    reauth->permanent);
-	sqlite3_exec(data->sqlite_db, cmd, NULL, NULL, NULL);
 }
 
 #endif /* CONFIG_SQLITE */
@@ -376,18 +847,12 @@ static void db_remove_reauth(struct eap_sim_db_data *data,
 static struct eap_sim_db_pending *
 eap_sim_db_get_pending(struct eap_sim_db_data *data, const char *imsi, int aka)
 {
-	struct eap_sim_db_pending *entry, *prev = NULL;
+	struct eap_sim_db_pending *entry;
 
-	entry = data->pending;
+	entry = data->pending[eap_sim_db_hash(imsi)];
 	while (entry) {
-		if (entry->aka == aka && os_strcmp(entry->imsi, imsi) == 0) {
-			if (prev)
-				prev->next = entry->next;
-			else
-				data->pending = entry->next;
+		if (entry->aka == aka && os_strcmp(entry->imsi, imsi) == 0)
 			break;
-		}
-		prev = entry;
 		entry = entry->next;
 	}
 	return entry;
@@ -397,59 +862,91 @@ eap_sim_db_get_pending(struct eap_sim_db_data *data, const char *imsi, int aka)
 static void eap_sim_db_add_pending(struct eap_sim_db_data *data,
 				   struct eap_sim_db_pending *entry)
 {
-	entry->next = data->pending;
-	data->pending = entry;
+	unsigned int h = eap_sim_db_hash(entry->imsi);
+
+	entry->next = data->pending[h];
+	data->pending[h] = entry;
+	data->num_pending++;
+	data->queries++;
+	os_get_reltime(&entry->sent);
+	timer_list_set(&data->pending_timers, &entry->timer,
+		       data->eap_sim_db_timeout, 0);
 }
 
 
 static void eap_sim_db_free_pending(struct eap_sim_db_data *data,
 				    struct eap_sim_db_pending *entry)
 {
-	eloop_cancel_timeout(eap_sim_db_query_timeout, data, entry);
-	eloop_cancel_timeout(eap_sim_db_del_timeout, data, entry);
-	os_free(entry);
-}
+	struct eap_sim_db_pending **pp;
 
-
-static void eap_sim_db_del_pending(struct eap_sim_db_data *data,
-				   struct eap_sim_db_pending *entry)
-{
-	struct eap_sim_db_pending **pp = &data->pending;
-
-	while (*pp != NULL) {
-		if (*pp == entry) {
-			*pp = entry->next;
-			eap_sim_db_free_pending(data, entry);
-			return;
-		}
+	pp = &data->pending[eap_sim_db_hash(entry->imsi)];
+	while (*pp && *pp != entry)
 		pp = &(*pp)->next;
+	if (*pp) {
+		*pp = entry->next;
+		data->num_pending--;
 	}
+	timer_list_cancel(&data->pending_timers, &entry->timer);
+	os_free(entry);
 }
 
 
-static void eap_sim_db_del_timeout(void *eloop_ctx, void *user_ctx)
+/*
+ * Pending queries are kept in a timer list that registers only the earliest
+ * expiration with eloop. All queries use the same timeout, so new entries are
+ * normally added to the end of the list.
+ */
+static void eap_sim_db_pending_timeout(void *ctx,
+				       struct timer_list_entry *timer)
 {
-	struct eap_sim_db_data *data = eloop_ctx;
-	struct eap_sim_db_pending *entry = user_ctx;
-
-	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Delete query timeout for %p", entry);
-	eap_sim_db_del_pending(data, entry);
-}
-
+	struct eap_sim_db_data *data = ctx;
+	struct eap_sim_db_pending *entry;
 
-static void eap_sim_db_query_timeout(void *eloop_ctx, void *user_ctx)
-{
-	struct eap_sim_db_data *data = eloop_ctx;
-	struct eap_sim_db_pending *entry = user_ctx;
+	entry = timer_list_owner(timer, struct eap_sim_db_pending, timer);
+	if (entry->expired) {
+		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Delete query timeout for %p",
+			   entry);
+		eap_sim_db_free_pending(data, entry);
+		return;
+	}
 
 	/*
 	 * Report failure and allow some time for EAP server to process it
 	 * before deleting the query.
 	 */
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Query timeout for %p", entry);
+	if (entry->state == PENDING)
+		data->timeouts++;
 	entry->state = FAILURE;
+	entry->expired = 1;
+	timer_list_set(&data->pending_timers, &entry->timer, 1, 0);
 	data->get_complete_cb(data->ctx, entry->cb_session_ctx);
-	eloop_register_timeout(1, 0, eap_sim_db_del_timeout, data, entry);
+}
+
+
+static void eap_sim_db_response(struct eap_sim_db_data *data,
+				struct eap_sim_db_pending *entry, int success)
+{
+	struct os_reltime age;
+	unsigned int usec, i;
+
+	if (entry->state == PENDING) {
+		os_reltime_age(&entry->sent, &age);
+		usec = age.sec * 1000000 + age.usec;
+		data->responses++;
+		data->latency_total += usec;
+		if (usec > data->latency_max)
+			data->latency_max = usec;
+		for (i = 0; i < EAP_SIM_DB_LATENCY_BUCKETS - 1; i++) {
+			if (usec < (2U << i))
+				break;
+		}
+		data->latency_hist[i]++;
+	}
+
+	if (!success)
+		data->failures++;
+	entry->state = success ? SUCCESS : FAILURE;
 }
 
 
@@ -470,6 +967,7 @@ static void eap_sim_db_sim_resp_auth(struct eap_sim_db_data *data,
 	if (entry == NULL) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: No pending entry for the "
 			   "received message found");
+		data->unexpected++;
 		return;
 	}
 
@@ -477,8 +975,7 @@ static void eap_sim_db_sim_resp_auth(struct eap_sim_db_data *data,
 	if (os_strncmp(start, "FAILURE", 7) == 0) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: External server reported "
 			   "failure");
-		entry->state = FAILURE;
-		eap_sim_db_add_pending(data, entry);
+		eap_sim_db_response(data, entry, 0);
 		data->get_complete_cb(data->ctx, entry->cb_session_ctx);
 		return;
 	}
@@ -519,15 +1016,15 @@ static void eap_sim_db_sim_resp_auth(struct eap_sim_db_data *data,
 	}
 	entry->u.sim.num_chal = num_chal;
 
-	entry->state = SUCCESS;
+	eap_sim_db_response(data, entry, 1);
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Authentication data parsed "
 		   "successfully - callback");
-	eap_sim_db_add_pending(data, entry);
 	data->get_complete_cb(data->ctx, entry->cb_session_ctx);
 	return;
 
 parse_fail:
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Failed to parse response string");
+	data->failures++;
 	eap_sim_db_free_pending(data, entry);
 }
 
@@ -548,6 +1045,7 @@ static void eap_sim_db_aka_resp_auth(struct eap_sim_db_data *data,
 	if (entry == NULL) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: No pending entry for the "
 			   "received message found");
+		data->unexpected++;
 		return;
 	}
 
@@ -555,8 +1053,7 @@ static void eap_sim_db_aka_resp_auth(struct eap_sim_db_data *data,
 	if (os_strncmp(start, "FAILURE", 7) == 0) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: External server reported "
 			   "failure");
-		entry->state = FAILURE;
-		eap_sim_db_add_pending(data, entry);
+		eap_sim_db_response(data, entry, 0);
 		data->get_complete_cb(data->ctx, entry->cb_session_ctx);
 		return;
 	}
@@ -610,39 +1107,22 @@ static void eap_sim_db_aka_resp_auth(struct eap_sim_db_data *data,
 	if (hexstr2bin(start, entry->u.aka.res, entry->u.aka.res_len))
 		goto parse_fail;
 
-	entry->state = SUCCESS;
+	eap_sim_db_response(data, entry, 1);
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Authentication data parsed "
 		   "successfully - callback");
-	eap_sim_db_add_pending(data, entry);
 	data->get_complete_cb(data->ctx, entry->cb_session_ctx);
 	return;
 
 parse_fail:
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Failed to parse response string");
+	data->failures++;
 	eap_sim_db_free_pending(data, entry);
 }
 
 
-static void eap_sim_db_receive(int sock, void *eloop_ctx, void *sock_ctx)
+static void eap_sim_db_process_msg(struct eap_sim_db_data *data, char *buf)
 {
-	struct eap_sim_db_data *data = eloop_ctx;
-	char buf[1000], *pos, *cmd, *imsi;
-	int res;
-
-	res = recv(sock, buf, sizeof(buf) - 1, 0);
-	if (res < 0)
-		return;
-	buf[res] = '\0';
-	wpa_hexdump_ascii_key(MSG_MSGDUMP, "EAP-SIM DB: Received from an "
-			      "external source", (u8 *) buf, res);
-	if (res == 0)
-		return;
-
-	if (data->get_complete_cb == NULL) {
-		wpa_printf(MSG_DEBUG, "EAP-SIM DB: No get_complete_cb "
-			   "registered");
-		return;
-	}
+	char *pos, *cmd, *imsi;
 
 	/* <cmd> <IMSI> ... */
 
@@ -673,6 +1153,41 @@ parse_fail:
 }
 
 
+static void eap_sim_db_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct eap_sim_db_data *data = eloop_ctx;
+	char buf[1000];
+	int res;
+
+	/*
+	 * Several requests can be outstanding, so process all the responses
+	 * that are already queued instead of returning to eloop after each.
+	 */
+	for (;;) {
+		res = recv(sock, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+		if (res < 0)
+			return;
+		buf[res] = '\0';
+		wpa_hexdump_ascii_key(MSG_MSGDUMP, "EAP-SIM DB: Received from "
+				      "an external source", (u8 *) buf, res);
+		if (res == 0)
+			return;
+
+		if (data->get_complete_cb == NULL) {
+			wpa_printf(MSG_DEBUG, "EAP-SIM DB: No get_complete_cb "
+				   "registered");
+			return;
+		}
+
+		eap_sim_db_process_msg(data, buf);
+
+		/* The callbacks may have reconnected the socket */
+		if (data->sock != sock)
+			return;
+	}
+}
+
+
 static int eap_sim_db_open_socket(struct eap_sim_db_data *data)
 {
 	struct sockaddr_un addr;
@@ -696,12 +1211,16 @@ static int eap_sim_db_open_socket(struct eap_sim_db_data *data)
 	if (data->local_sock == NULL) {
 		close(data->sock);
 		data->sock = -1;
+	dl_list_init(&data->pseudonym_lru);
+	dl_list_init(&data->reauth_lru);
 		return -1;
 	}
 	if (bind(data->sock, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
 		wpa_printf(MSG_INFO, "bind(eap_sim_db): %s", strerror(errno));
 		close(data->sock);
 		data->sock = -1;
+	dl_list_init(&data->pseudonym_lru);
+	dl_list_init(&data->reauth_lru);
 		return -1;
 	}
 
@@ -716,6 +1235,8 @@ static int eap_sim_db_open_socket(struct eap_sim_db_data *data)
 				  os_strlen(addr.sun_path));
 		close(data->sock);
 		data->sock = -1;
+	dl_list_init(&data->pseudonym_lru);
+	dl_list_init(&data->reauth_lru);
 		unlink(data->local_sock);
 		os_free(data->local_sock);
 		data->local_sock = NULL;
@@ -734,6 +1255,8 @@ static void eap_sim_db_close_socket(struct eap_sim_db_data *data)
 		eloop_unregister_read_sock(data->sock);
 		close(data->sock);
 		data->sock = -1;
+	dl_list_init(&data->pseudonym_lru);
+	dl_list_init(&data->reauth_lru);
 	}
 	if (data->local_sock) {
 		unlink(data->local_sock);
@@ -764,6 +1287,15 @@ eap_sim_db_init(const char *config, unsigned int db_timeout,
 		return NULL;
 
 	data->sock = -1;
+	dl_list_init(&data->pseudonym_lru);
+	dl_list_init(&data->reauth_lru);
+	timer_list_init(&data->pending_timers, eap_sim_db_pending_timeout,
+			data);
+#ifdef CONFIG_SQLITE
+	dl_list_init(&data->dirty_pseudonyms);
+	dl_list_init(&data->dirty_reauths);
+	dl_list_init(&data->deleted_reauths);
+#endif /* CONFIG_SQLITE */
 	data->get_complete_cb = get_complete_cb;
 	data->ctx = ctx;
 	data->eap_sim_db_timeout = db_timeout;
@@ -775,8 +1307,7 @@ eap_sim_db_init(const char *config, unsigned int db_timeout,
 		*pos = '\0';
 #ifdef CONFIG_SQLITE
 		pos += 4;
-		data->sqlite_db = db_open(pos);
-		if (data->sqlite_db == NULL)
+		if (db_open(data, pos) < 0)
 			goto fail;
 #endif /* CONFIG_SQLITE */
 	}
@@ -799,22 +1330,6 @@ fail:
 }
 
 
-static void eap_sim_db_free_pseudonym(struct eap_sim_pseudonym *p)
-{
-	os_free(p->permanent);
-	os_free(p->pseudonym);
-	os_free(p);
-}
-
-
-static void eap_sim_db_free_reauth(struct eap_sim_reauth *r)
-{
-	os_free(r->permanent);
-	os_free(r->reauth_id);
-	os_free(r);
-}
-
-
 /**
  * eap_sim_db_deinit - Deinitialize EAP-SIM DB/authentication gw interface
  * @priv: Private data pointer from eap_sim_db_init()
@@ -825,36 +1340,40 @@ void eap_sim_db_deinit(void *priv)
 	struct eap_sim_pseudonym *p, *prev;
 	struct eap_sim_reauth *r, *prevr;
 	struct eap_sim_db_pending *pending, *prev_pending;
+	unsigned int i;
 
 #ifdef CONFIG_SQLITE
 	if (data->sqlite_db) {
-		sqlite3_close(data->sqlite_db);
-		data->sqlite_db = NULL;
+		db_flush(data);
+		db_close(data);
 	}
 #endif /* CONFIG_SQLITE */
 
 	eap_sim_db_close_socket(data);
 	os_free(data->fname);
+	timer_list_deinit(&data->pending_timers);
+
+	for (i = 0; i < EAP_SIM_DB_HASH_SIZE; i++) {
+		p = data->pseudonyms[i];
+		while (p) {
+			prev = p;
+			p = p->next;
+			eap_sim_db_free_pseudonym(prev);
+		}
 
-	p = data->pseudonyms;
-	while (p) {
-		prev = p;
-		p = p->next;
-		eap_sim_db_free_pseudonym(prev);
-	}
-
-	r = data->reauths;
-	while (r) {
-		prevr = r;
-		r = r->next;
-		eap_sim_db_free_reauth(prevr);
-	}
+		r = data->reauths[i];
+		while (r) {
+			prevr = r;
+			r = r->next;
+			eap_sim_db_free_reauth(prevr);
+		}
 
-	pending = data->pending;
-	while (pending) {
-		prev_pending = pending;
-		pending = pending->next;
-		eap_sim_db_free_pending(data, prev_pending);
+		pending = data->pending[i];
+		while (pending) {
+			prev_pending = pending;
+			pending = pending->next;
+			os_free(prev_pending);
+		}
 	}
 
 	os_free(data);
@@ -891,14 +1410,6 @@ static int eap_sim_db_send(struct eap_sim_db_data *data, const char *msg,
 }
 
 
-static void eap_sim_db_expire_pending(struct eap_sim_db_data *data,
-				      struct eap_sim_db_pending *entry)
-{
-	eloop_register_timeout(data->eap_sim_db_timeout, 0,
-			       eap_sim_db_query_timeout, data, entry);
-}
-
-
 /**
  * eap_sim_db_get_gsm_triplets - Get GSM triplets
  * @data: Private data pointer from eap_sim_db_init()
@@ -956,7 +1467,6 @@ int eap_sim_db_get_gsm_triplets(struct eap_sim_db_data *data,
 		if (entry->state == PENDING) {
 			wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending entry -> "
 				   "still pending");
-			eap_sim_db_add_pending(data, entry);
 			return EAP_SIM_DB_PENDING;
 		}
 
@@ -1003,7 +1513,6 @@ int eap_sim_db_get_gsm_triplets(struct eap_sim_db_data *data,
 	entry->cb_session_ctx = cb_session_ctx;
 	entry->state = PENDING;
 	eap_sim_db_add_pending(data, entry);
-	eap_sim_db_expire_pending(data, entry);
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added query %p", entry);
 
 	return EAP_SIM_DB_PENDING;
@@ -1115,37 +1624,25 @@ int eap_sim_db_add_pseudonym(struct eap_sim_db_data *data,
 		   "username '%s'", pseudonym, permanent);
 
 	/* TODO: could store last two pseudonyms */
-#ifdef CONFIG_SQLITE
-	if (data->sqlite_db)
-		return db_add_pseudonym(data, permanent, pseudonym);
-#endif /* CONFIG_SQLITE */
-	for (p = data->pseudonyms; p; p = p->next) {
-		if (os_strcmp(permanent, p->permanent) == 0)
-			break;
-	}
+	p = eap_sim_db_get_pseudonym_perm(data, permanent);
 	if (p) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Replacing previous "
 			   "pseudonym: %s", p->pseudonym);
+		eap_sim_db_pseudonym_id_del(data, p);
 		os_free(p->pseudonym);
 		p->pseudonym = pseudonym;
+		eap_sim_db_pseudonym_id_add(data, p);
+		eap_sim_db_touch_pseudonym(data, p);
+		db_add_pseudonym(data, p);
 		return 0;
 	}
 
-	p = os_zalloc(sizeof(*p));
+	p = eap_sim_db_new_pseudonym(data, permanent, pseudonym);
 	if (p == NULL) {
 		os_free(pseudonym);
 		return -1;
 	}
-
-	p->next = data->pseudonyms;
-	p->permanent = os_strdup(permanent);
-	if (p->permanent == NULL) {
-		os_free(p);
-		os_free(pseudonym);
-		return -1;
-	}
-	p->pseudonym = pseudonym;
-	data->pseudonyms = p;
+	db_add_pseudonym(data, p);
 
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added new pseudonym entry");
 	return 0;
@@ -1159,32 +1656,21 @@ eap_sim_db_add_reauth_data(struct eap_sim_db_data *data,
 {
 	struct eap_sim_reauth *r;
 
-	for (r = data->reauths; r; r = r->next) {
-		if (os_strcmp(r->permanent, permanent) == 0)
-			break;
-	}
-
+	r = eap_sim_db_get_reauth_perm(data, permanent);
 	if (r) {
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Replacing previous "
 			   "reauth_id: %s", r->reauth_id);
+		eap_sim_db_reauth_id_del(data, r);
 		os_free(r->reauth_id);
 		r->reauth_id = reauth_id;
+		eap_sim_db_reauth_id_add(data, r);
+		eap_sim_db_touch_reauth(data, r);
 	} else {
-		r = os_zalloc(sizeof(*r));
+		r = eap_sim_db_new_reauth(data, permanent, reauth_id);
 		if (r == NULL) {
 			os_free(reauth_id);
 			return NULL;
 		}
-
-		r->next = data->reauths;
-		r->permanent = os_strdup(permanent);
-		if (r->permanent == NULL) {
-			os_free(r);
-			os_free(reauth_id);
-			return NULL;
-		}
-		r->reauth_id = reauth_id;
-		data->reauths = r;
 		wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added new reauth entry");
 	}
 
@@ -1218,16 +1704,12 @@ int eap_sim_db_add_reauth(struct eap_sim_db_data *data, const char *permanent,
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Add reauth_id '%s' for permanent "
 		   "identity '%s'", reauth_id, permanent);
 
-#ifdef CONFIG_SQLITE
-	if (data->sqlite_db)
-		return db_add_reauth(data, permanent, reauth_id, counter, mk,
-				     NULL, NULL, NULL);
-#endif /* CONFIG_SQLITE */
 	r = eap_sim_db_add_reauth_data(data, permanent, reauth_id, counter);
 	if (r == NULL)
 		return -1;
 
 	os_memcpy(r->mk, mk, EAP_SIM_MK_LEN);
+	db_add_reauth(data, r);
 
 	return 0;
 }
@@ -1261,11 +1743,6 @@ int eap_sim_db_add_reauth_prime(struct eap_sim_db_data *data,
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Add reauth_id '%s' for permanent "
 		   "identity '%s'", reauth_id, permanent);
 
-#ifdef CONFIG_SQLITE
-	if (data->sqlite_db)
-		return db_add_reauth(data, permanent, reauth_id, counter, NULL,
-				     k_encr, k_aut, k_re);
-#endif /* CONFIG_SQLITE */
 	r = eap_sim_db_add_reauth_data(data, permanent, reauth_id, counter);
 	if (r == NULL)
 		return -1;
@@ -1273,6 +1750,7 @@ int eap_sim_db_add_reauth_prime(struct eap_sim_db_data *data,
 	os_memcpy(r->k_encr, k_encr, EAP_SIM_K_ENCR_LEN);
 	os_memcpy(r->k_aut, k_aut, EAP_AKA_PRIME_K_AUT_LEN);
 	os_memcpy(r->k_re, k_re, EAP_AKA_PRIME_K_RE_LEN);
+	db_add_reauth(data, r);
 
 	return 0;
 }
@@ -1290,19 +1768,13 @@ eap_sim_db_get_permanent(struct eap_sim_db_data *data, const char *pseudonym)
 {
 	struct eap_sim_pseudonym *p;
 
-#ifdef CONFIG_SQLITE
-	if (data->sqlite_db)
-		return db_get_pseudonym(data, pseudonym);
-#endif /* CONFIG_SQLITE */
-
-	p = data->pseudonyms;
-	while (p) {
-		if (os_strcmp(p->pseudonym, pseudonym) == 0)
-			return p->permanent;
-		p = p->next;
-	}
+	p = eap_sim_db_get_pseudonym_id(data, pseudonym);
+	if (p)
+		eap_sim_db_touch_pseudonym(data, p);
+	else
+		p = db_get_pseudonym(data, pseudonym);
 
-	return NULL;
+	return p ? p->permanent : NULL;
 }
 
 
@@ -1318,17 +1790,11 @@ eap_sim_db_get_reauth_entry(struct eap_sim_db_data *data,
 {
 	struct eap_sim_reauth *r;
 
-#ifdef CONFIG_SQLITE
-	if (data->sqlite_db)
-		return db_get_reauth(data, reauth_id);
-#endif /* CONFIG_SQLITE */
-
-	r = data->reauths;
-	while (r) {
-		if (os_strcmp(r->reauth_id, reauth_id) == 0)
-			break;
-		r = r->next;
-	}
+	r = eap_sim_db_get_reauth_id(data, reauth_id);
+	if (r)
+		eap_sim_db_touch_reauth(data, r);
+	else
+		r = db_get_reauth(data, reauth_id);
 
 	return r;
 }
@@ -1343,26 +1809,10 @@ eap_sim_db_get_reauth_entry(struct eap_sim_db_data *data,
 void eap_sim_db_remove_reauth(struct eap_sim_db_data *data,
 			      struct eap_sim_reauth *reauth)
 {
-	struct eap_sim_reauth *r, *prev = NULL;
-#ifdef CONFIG_SQLITE
-	if (data->sqlite_db) {
-		db_remove_reauth(data, reauth);
+	if (eap_sim_db_unlink_reauth(data, reauth) < 0)
 		return;
-	}
-#endif /* CONFIG_SQLITE */
-	r = data->reauths;
-	while (r) {
-		if (r == reauth) {
-			if (prev)
-				prev->next = r->next;
-			else
-				data->reauths = r->next;
-			eap_sim_db_free_reauth(r);
-			return;
-		}
-		prev = r;
-		r = r->next;
-	}
+	db_remove_reauth(data, reauth);
+	eap_sim_db_free_reauth(reauth);
 }
 
 
@@ -1421,7 +1871,6 @@ int eap_sim_db_get_aka_auth(struct eap_sim_db_data *data, const char *username,
 		}
 
 		if (entry->state == PENDING) {
-			eap_sim_db_add_pending(data, entry);
 			wpa_printf(MSG_DEBUG, "EAP-SIM DB: Pending");
 			return EAP_SIM_DB_PENDING;
 		}
@@ -1465,7 +1914,6 @@ int eap_sim_db_get_aka_auth(struct eap_sim_db_data *data, const char *username,
 	entry->cb_session_ctx = cb_session_ctx;
 	entry->state = PENDING;
 	eap_sim_db_add_pending(data, entry);
-	eap_sim_db_expire_pending(data, entry);
 	wpa_printf(MSG_DEBUG, "EAP-SIM DB: Added query %p", entry);
 
 	return EAP_SIM_DB_PENDING;
@@ -1539,6 +1987,68 @@ int eap_sim_db_resynchronize(struct eap_sim_db_data *data,
 }
 
 
+static unsigned int eap_sim_db_latency_percentile(struct eap_sim_db_data *data,
+						  unsigned int percent)
+{
+	unsigned int i, count = 0, target;
+
+	target = (data->responses * percent + 99) / 100;
+	for (i = 0; i < EAP_SIM_DB_LATENCY_BUCKETS; i++) {
+		count += data->latency_hist[i];
+		if (count >= target)
+			break;
+	}
+	if (i >= EAP_SIM_DB_LATENCY_BUCKETS - 1)
+		return data->latency_max;
+	/* Upper bound of the bucket, but not beyond the measured maximum */
+	return (2U << i) < data->latency_max ? (2U << i) : data->latency_max;
+}
+
+
+/**
+ * eap_sim_db_get_mib - Get EAP-SIM DB MIB information
+ * @data: Private data pointer from eap_sim_db_init()
+ * @buf: Buffer for returning MIB data in text format
+ * @buflen: Maximum buf length in octets
+ * Returns: Number of octets written into the buffer
+ *
+ * The latency values are in microseconds and cover the queries that received
+ * a response from the external server.
+ */
+int eap_sim_db_get_mib(struct eap_sim_db_data *data, char *buf, size_t buflen)
+{
+	int ret;
+
+	if (!data)
+		return 0;
+
+	ret = os_snprintf(buf, buflen,
+			  "eapSimDbQueries=%u\n"
+			  "eapSimDbResponses=%u\n"
+			  "eapSimDbFailures=%u\n"
+			  "eapSimDbTimeouts=%u\n"
+			  "eapSimDbUnexpectedResponses=%u\n"
+			  "eapSimDbPendingQueries=%u\n"
+			  "eapSimDbLatencyAvg=%u\n"
+			  "eapSimDbLatencyP50=%u\n"
+			  "eapSimDbLatencyP95=%u\n"
+			  "eapSimDbLatencyP99=%u\n"
+			  "eapSimDbLatencyMax=%u\n",
+			  data->queries, data->responses, data->failures,
+			  data->timeouts, data->unexpected, data->num_pending,
+			  data->responses ?
+			  (unsigned int) (data->latency_total /
+					  data->responses) : 0,
+			  eap_sim_db_latency_percentile(data, 50),
+			  eap_sim_db_latency_percentile(data, 95),
+			  eap_sim_db_latency_percentile(data, 99),
+			  data->latency_max);
+	if (os_snprintf_error(buflen, ret))
+		return 0;
+	return ret;
+}
+
+
 /**
  * sim_get_username - Extract username from SIM identity
  * @identity: Identity
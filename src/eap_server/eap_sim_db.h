@@ -9,6 +9,7 @@
 #ifndef EAP_SIM_DB_H
 #define EAP_SIM_DB_H
 
+#include "utils/list.h"
 #include "eap_common/eap_sim_common.h"
 
 /* Identity prefixes */
@@ -65,7 +66,11 @@ const char * eap_sim_db_get_permanent(struct eap_sim_db_data *data,
 				      const char *pseudonym);
 
 struct eap_sim_reauth {
-	struct eap_sim_reauth *next;
+	struct eap_sim_reauth *next; /* next in the permanent hash bucket */
+	struct eap_sim_reauth *hnext; /* next in the reauth_id hash bucket */
+	struct dl_list dirty; /* not yet written to the database */
+	struct dl_list lru; /* data->reauth_lru */
+	struct os_reltime last_used;
 	char *permanent; /* Permanent username */
 	char *reauth_id; /* Fast re-authentication username */
 	u16 counter;
@@ -90,6 +95,9 @@ int eap_sim_db_resynchronize(struct eap_sim_db_data *data,
 			     const char *username, const u8 *auts,
 			     const u8 *_rand);
 
+int eap_sim_db_get_mib(struct eap_sim_db_data *data, char *buf,
+		       size_t buflen);
+
 char * sim_get_username(const u8 *identity, size_t identity_len);
 
 #endif /* EAP_SIM_DB_H */
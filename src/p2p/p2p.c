@@ -50,23 +50,181 @@ static void p2p_scan_timeout(void *eloop_ctx, void *timeout_ctx);
 #endif /* P2P_PEER_EXPIRATION_AGE */
 
 
+/*
+ * Peer entries are kept in a binary min-heap ordered by last_seen so that the
+ * oldest entry can be found without going through all the peers.
+ */
+
+static void p2p_expire_heap_set(struct p2p_data *p2p, size_t idx,
+				struct p2p_device *dev)
+{
+	p2p->expire_heap[idx] = dev;
+	dev->expire_idx = idx;
+}
+
+
+static void p2p_expire_heap_fix(struct p2p_data *p2p, size_t idx)
+{
+	struct p2p_device *dev = p2p->expire_heap[idx];
+	size_t parent, child;
+
+	while (idx > 0) {
+		parent = (idx - 1) / 2;
+		if (!os_reltime_before(&dev->last_seen,
+				       &p2p->expire_heap[parent]->last_seen))
+			break;
+		p2p_expire_heap_set(p2p, idx, p2p->expire_heap[parent]);
+		idx = parent;
+	}
+
+	for (;;) {
+		child = 2 * idx + 1;
+		if (child >= p2p->expire_heap_len)
+			break;
+		if (child + 1 < p2p->expire_heap_len &&
+		    os_reltime_before(&p2p->expire_heap[child + 1]->last_seen,
+				      &p2p->expire_heap[child]->last_seen))
+			child++;
+		if (!os_reltime_before(&p2p->expire_heap[child]->last_seen,
+				       &dev->last_seen))
+			break;
+		p2p_expire_heap_set(p2p, idx, p2p->expire_heap[child]);
+		idx = child;
+	}
+
+	p2p_expire_heap_set(p2p, idx, dev);
+}
+
+
+static int p2p_expire_heap_add(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	if (p2p->expire_heap_len == p2p->expire_heap_size) {
+		struct p2p_device **heap;
+		size_t size = p2p->expire_heap_size ?
+			2 * p2p->expire_heap_size : 16;
+
+		heap = os_realloc_array(p2p->expire_heap, size, sizeof(*heap));
+		if (!heap)
+			return -1;
+		p2p->expire_heap = heap;
+		p2p->expire_heap_size = size;
+	}
+
+	p2p_expire_heap_set(p2p, p2p->expire_heap_len++, dev);
+	p2p_expire_heap_fix(p2p, dev->expire_idx);
+	return 0;
+}
+
+
+static void p2p_expire_heap_del(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	size_t idx = dev->expire_idx;
+
+	p2p->expire_heap_len--;
+	if (idx < p2p->expire_heap_len) {
+		p2p_expire_heap_set(p2p, idx,
+				    p2p->expire_heap[p2p->expire_heap_len]);
+		p2p_expire_heap_fix(p2p, idx);
+	}
+}
+
+
+static int p2p_device_index_add(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	unsigned int idx = P2P_DEV_HASH(dev->info.p2p_device_addr);
+
+	if (p2p_expire_heap_add(p2p, dev) < 0)
+		return -1;
+	dev->hnext = p2p->dev_hash[idx];
+	p2p->dev_hash[idx] = dev;
+	p2p->num_devices++;
+	return 0;
+}
+
+
+static void p2p_device_index_del(struct p2p_data *p2p, struct p2p_device *dev)
+{
+	struct p2p_device **pos;
+
+	pos = &p2p->dev_hash[P2P_DEV_HASH(dev->info.p2p_device_addr)];
+	while (*pos && *pos != dev)
+		pos = &(*pos)->hnext;
+	if (*pos)
+		*pos = dev->hnext;
+
+	p2p_device_set_interface_addr(p2p, dev, NULL);
+	p2p_expire_heap_del(p2p, dev);
+	p2p->num_devices--;
+}
+
+
+static void p2p_device_seen(struct p2p_data *p2p, struct p2p_device *dev,
+			    const struct os_reltime *seen)
+{
+	if (seen)
+		dev->last_seen = *seen;
+	else
+		os_get_reltime(&dev->last_seen);
+	p2p_expire_heap_fix(p2p, dev->expire_idx);
+}
+
+
+/**
+ * p2p_device_set_interface_addr - Set P2P Interface Address of a peer entry
+ * @p2p: P2P module context from p2p_init()
+ * @dev: Peer entry
+ * @addr: P2P Interface Address or %NULL to clear it
+ */
+void p2p_device_set_interface_addr(struct p2p_data *p2p,
+				   struct p2p_device *dev, const u8 *addr)
+{
+	struct p2p_device **pos;
+
+	if (!is_zero_ether_addr(dev->interface_addr)) {
+		pos = &p2p->iface_hash[P2P_DEV_HASH(dev->interface_addr)];
+		while (*pos && *pos != dev)
+			pos = &(*pos)->iface_hnext;
+		if (*pos)
+			*pos = dev->iface_hnext;
+		dev->iface_hnext = NULL;
+	}
+
+	if (!addr) {
+		os_memset(dev->interface_addr, 0, ETH_ALEN);
+		return;
+	}
+
+	os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+	if (!is_zero_ether_addr(addr)) {
+		pos = &p2p->iface_hash[P2P_DEV_HASH(addr)];
+		dev->iface_hnext = *pos;
+		*pos = dev;
+	}
+}
+
+
 void p2p_expire_peers(struct p2p_data *p2p)
 {
-	struct p2p_device *dev, *n;
+	struct p2p_device *dev, *skip = NULL;
 	struct os_reltime now;
 	size_t i;
 
 	os_get_reltime(&now);
-	dl_list_for_each_safe(dev, n, &p2p->devices, struct p2p_device, list) {
+	while (p2p->expire_heap_len > 0) {
+		dev = p2p->expire_heap[0];
 		if (dev->last_seen.sec + P2P_PEER_EXPIRATION_AGE >= now.sec)
-			continue;
+			break;
 
 		if (dev == p2p->go_neg_peer) {
 			/*
 			 * GO Negotiation is in progress with the peer, so
 			 * don't expire the peer entry until GO Negotiation
-			 * fails or times out.
+			 * fails or times out. Take the entry out of the heap
+			 * for the remainder of this iteration to get to the
+			 * next oldest one.
 			 */
+			p2p_expire_heap_del(p2p, dev);
+			skip = dev;
 			continue;
 		}
 
@@ -77,7 +235,7 @@ void p2p_expire_peers(struct p2p_data *p2p)
 			 * We are connected as a client to a group in which the
 			 * peer is the GO, so do not expire the peer entry.
 			 */
-			os_get_reltime(&dev->last_seen);
+			p2p_device_seen(p2p, dev, NULL);
 			continue;
 		}
 
@@ -91,7 +249,7 @@ void p2p_expire_peers(struct p2p_data *p2p)
 			 * The peer is connected as a client in a group where
 			 * we are the GO, so do not expire the peer entry.
 			 */
-			os_get_reltime(&dev->last_seen);
+			p2p_device_seen(p2p, dev, NULL);
 			continue;
 		}
 
@@ -100,6 +258,9 @@ void p2p_expire_peers(struct p2p_data *p2p)
 		dl_list_del(&dev->list);
 		p2p_device_free(p2p, dev);
 	}
+
+	if (skip)
+		p2p_expire_heap_add(p2p, skip); /* cannot fail; space exists */
 }
 
 
@@ -376,7 +537,8 @@ static void p2p_device_clear_reported(struct p2p_data *p2p)
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->dev_hash[P2P_DEV_HASH(addr)]; dev; dev = dev->hnext) {
 		if (os_memcmp(dev->info.p2p_device_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -394,7 +556,9 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr)
 {
 	struct p2p_device *dev;
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
+
+	for (dev = p2p->iface_hash[P2P_DEV_HASH(addr)]; dev;
+	     dev = dev->iface_hnext) {
 		if (os_memcmp(dev->interface_addr, addr, ETH_ALEN) == 0)
 			return dev;
 	}
@@ -414,20 +578,15 @@ struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 					     const u8 *addr)
 {
-	struct p2p_device *dev, *oldest = NULL;
-	size_t count = 0;
+	struct p2p_device *dev, *oldest;
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev)
 		return dev;
 
-	dl_list_for_each(dev, &p2p->devices, struct p2p_device, list) {
-		count++;
-		if (oldest == NULL ||
-		    os_reltime_before(&dev->last_seen, &oldest->last_seen))
-			oldest = dev;
-	}
-	if (count + 1 > p2p->cfg->max_peers && oldest) {
+	if (p2p->num_devices + 1 > p2p->cfg->max_peers &&
+	    p2p->expire_heap_len > 0) {
+		oldest = p2p->expire_heap[0];
 		p2p_dbg(p2p, "Remove oldest peer entry to make room for a new peer");
 		dl_list_del(&oldest->list);
 		p2p_device_free(p2p, oldest);
@@ -436,8 +595,12 @@ static struct p2p_device * p2p_create_device(struct p2p_data *p2p,
 	dev = os_zalloc(sizeof(*dev));
 	if (dev == NULL)
 		return NULL;
-	dl_list_add(&p2p->devices, &dev->list);
 	os_memcpy(dev->info.p2p_device_addr, addr, ETH_ALEN);
+	if (p2p_device_index_add(p2p, dev) < 0) {
+		os_free(dev);
+		return NULL;
+	}
+	dl_list_add(&p2p->devices, &dev->list);
 
 	return dev;
 }
@@ -527,9 +690,9 @@ static int p2p_add_group_clients(struct p2p_data *p2p, const u8 *go_dev_addr,
 			dev->flags |= P2P_DEV_REPORTED | P2P_DEV_REPORTED_ONCE;
 		}
 
-		os_memcpy(dev->interface_addr, cli->p2p_interface_addr,
-			  ETH_ALEN);
-		os_memcpy(&dev->last_seen, rx_time, sizeof(struct os_reltime));
+		p2p_device_set_interface_addr(p2p, dev,
+					      cli->p2p_interface_addr);
+		p2p_device_seen(p2p, dev, rx_time);
 		os_memcpy(dev->member_in_go_dev, go_dev_addr, ETH_ALEN);
 		os_memcpy(dev->member_in_go_iface, go_interface_addr,
 			  ETH_ALEN);
@@ -773,13 +936,13 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 		return -1;
 	}
 
-	os_memcpy(&dev->last_seen, rx_time, sizeof(struct os_reltime));
+	p2p_device_seen(p2p, dev, rx_time);
 
 	dev->flags &= ~(P2P_DEV_PROBE_REQ_ONLY | P2P_DEV_GROUP_CLIENT_ONLY |
 			P2P_DEV_LAST_SEEN_AS_GROUP_CLIENT);
 
 	if (os_memcmp(addr, p2p_dev_addr, ETH_ALEN) != 0)
-		os_memcpy(dev->interface_addr, addr, ETH_ALEN);
+		p2p_device_set_interface_addr(p2p, dev, addr);
 	if (msg.ssid &&
 	    msg.ssid[1] <= sizeof(dev->oper_ssid) &&
 	    (msg.ssid[1] != P2P_WILDCARD_SSID_LEN ||
@@ -911,6 +1074,8 @@ static void p2p_device_free(struct p2p_data *p2p, struct p2p_device *dev)
 {
 	int i;
 
+	p2p_device_index_del(p2p, dev);
+
 	if (p2p->go_neg_peer == dev) {
 		/*
 		 * If GO Negotiation is in progress, report that it has failed.
@@ -1722,7 +1887,7 @@ int p2p_authorize(struct p2p_data *p2p, const u8 *peer_addr,
 void p2p_add_dev_info(struct p2p_data *p2p, const u8 *addr,
 		      struct p2p_device *dev, struct p2p_message *msg)
 {
-	os_get_reltime(&dev->last_seen);
+	p2p_device_seen(p2p, dev, NULL);
 
 	p2p_copy_wps_info(p2p, dev, 0, msg);
 
@@ -2076,7 +2241,7 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 			}
 		}
 
-		os_get_reltime(&dev->last_seen);
+		p2p_device_seen(p2p, dev, NULL);
 		p2p_parse_free(&msg);
 		return; /* already known */
 	}
@@ -2087,7 +2252,7 @@ static void p2p_add_dev_from_probe_req(struct p2p_data *p2p, const u8 *addr,
 		return;
 	}
 
-	os_get_reltime(&dev->last_seen);
+	p2p_device_seen(p2p, dev, NULL);
 	dev->flags |= P2P_DEV_PROBE_REQ_ONLY;
 
 	if (msg.listen_channel) {
@@ -2121,7 +2286,7 @@ struct p2p_device * p2p_add_dev_from_go_neg_req(struct p2p_data *p2p,
 
 	dev = p2p_get_device(p2p, addr);
 	if (dev) {
-		os_get_reltime(&dev->last_seen);
+		p2p_device_seen(p2p, dev, NULL);
 		return dev; /* already known */
 	}
 
@@ -3028,6 +3193,7 @@ void p2p_deinit(struct p2p_data *p2p)
 	p2p_remove_wps_vendor_extensions(p2p);
 	os_free(p2p->no_go_freq.range);
 	p2p_service_flush_asp(p2p);
+	os_free(p2p->expire_heap);
 
 	os_free(p2p);
 }
@@ -5406,7 +5572,7 @@ int p2p_process_nfc_connection_handover(struct p2p_data *p2p,
 
 	params->peer = &dev->info;
 
-	os_get_reltime(&dev->last_seen);
+	p2p_device_seen(p2p, dev, NULL);
 	dev->flags &= ~(P2P_DEV_PROBE_REQ_ONLY | P2P_DEV_GROUP_CLIENT_ONLY);
 	p2p_copy_wps_info(p2p, dev, 0, &msg);
 
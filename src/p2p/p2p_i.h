@@ -40,6 +40,9 @@ enum p2p_go_state {
  */
 struct p2p_device {
 	struct dl_list list;
+	struct p2p_device *hnext; /* next entry in P2P Device Address hash */
+	struct p2p_device *iface_hnext; /* next entry in interface addr hash */
+	size_t expire_idx; /* index in p2p_data::expire_heap */
 	struct os_reltime last_seen;
 	int listen_freq;
 	int oob_go_neg_freq;
@@ -270,6 +273,30 @@ struct p2p_data {
 	 */
 	struct dl_list devices;
 
+	/**
+	 * num_devices - Number of entries in devices
+	 */
+	size_t num_devices;
+
+#define P2P_DEV_HASH_SIZE 256
+#define P2P_DEV_HASH(addr) ((addr)[5])
+	/**
+	 * dev_hash - Index of devices by P2P Device Address
+	 */
+	struct p2p_device *dev_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * iface_hash - Index of devices by non-zero P2P Interface Address
+	 */
+	struct p2p_device *iface_hash[P2P_DEV_HASH_SIZE];
+
+	/**
+	 * expire_heap - Binary min-heap of devices ordered by last_seen
+	 */
+	struct p2p_device **expire_heap;
+	size_t expire_heap_len;
+	size_t expire_heap_size;
+
 	/**
 	 * go_neg_peer - Pointer to GO Negotiation peer
 	 */
@@ -876,6 +903,8 @@ int p2p_add_device(struct p2p_data *p2p, const u8 *addr, int freq,
 struct p2p_device * p2p_get_device(struct p2p_data *p2p, const u8 *addr);
 struct p2p_device * p2p_get_device_interface(struct p2p_data *p2p,
 					     const u8 *addr);
+void p2p_device_set_interface_addr(struct p2p_data *p2p,
+				   struct p2p_device *dev, const u8 *addr);
 void p2p_go_neg_failed(struct p2p_data *p2p, int status);
 void p2p_go_complete(struct p2p_data *p2p, struct p2p_device *peer);
 int p2p_match_dev_type(struct p2p_data *p2p, struct wpabuf *wps);
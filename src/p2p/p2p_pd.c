@@ -1186,8 +1186,8 @@ out:
 		}
 
 		if (msg.intended_addr)
-			os_memcpy(dev->interface_addr, msg.intended_addr,
-				  ETH_ALEN);
+			p2p_device_set_interface_addr(p2p, dev,
+						      msg.intended_addr);
 	}
 	p2p_parse_free(&msg);
 }
@@ -1544,7 +1544,7 @@ void p2p_process_prov_disc_resp(struct p2p_data *p2p, const u8 *sa,
 	/* Store the provisioning info */
 	dev->wps_prov_info = msg.wps_config_methods;
 	if (msg.intended_addr)
-		os_memcpy(dev->interface_addr, msg.intended_addr, ETH_ALEN);
+		p2p_device_set_interface_addr(p2p, dev, msg.intended_addr);
 
 	p2p_parse_free(&msg);
 
@@ -146,7 +146,8 @@ ieee802_1x_mka_dump_peer_body(struct ieee802_1x_mka_peer_body *body)
 	u8 *mi;
 	be32 mn;
 
-	if (body == NULL)
+	/* Avoid going through the possibly long list without debug output */
+	if (body == NULL || wpa_debug_level > MSG_DEBUG)
 		return;
 
 	body_len = get_mka_param_body_len(body);
@@ -281,12 +282,13 @@ ieee802_1x_kay_get_principal_participant(struct ieee802_1x_kay *kay)
 }
 
 
-static struct ieee802_1x_kay_peer * get_peer_mi(struct dl_list *peers,
-						const u8 *mi)
+static struct ieee802_1x_kay_peer *
+get_peer_mi(struct ieee802_1x_mka_participant *participant, const u8 *mi)
 {
 	struct ieee802_1x_kay_peer *peer;
 
-	dl_list_for_each(peer, peers, struct ieee802_1x_kay_peer, list) {
+	for (peer = participant->peer_mi_hash[MKA_PEER_MI_HASH(mi)]; peer;
+	     peer = peer->mi_hnext) {
 		if (os_memcmp(peer->mi, mi, MI_LEN) == 0)
 			return peer;
 	}
@@ -302,7 +304,9 @@ static struct ieee802_1x_kay_peer *
 ieee802_1x_kay_get_potential_peer(
 	struct ieee802_1x_mka_participant *participant, const u8 *mi)
 {
-	return get_peer_mi(&participant->potential_peers, mi);
+	struct ieee802_1x_kay_peer *peer = get_peer_mi(participant, mi);
+
+	return peer && !peer->live ? peer : NULL;
 }
 
 
@@ -313,7 +317,9 @@ static struct ieee802_1x_kay_peer *
 ieee802_1x_kay_get_live_peer(struct ieee802_1x_mka_participant *participant,
 			     const u8 *mi)
 {
-	return get_peer_mi(&participant->live_peers, mi);
+	struct ieee802_1x_kay_peer *peer = get_peer_mi(participant, mi);
+
+	return peer && peer->live ? peer : NULL;
 }
 
 
@@ -346,13 +352,7 @@ static struct ieee802_1x_kay_peer *
 ieee802_1x_kay_get_peer(struct ieee802_1x_mka_participant *participant,
 			const u8 *mi)
 {
-	struct ieee802_1x_kay_peer *peer;
-
-	peer = ieee802_1x_kay_get_live_peer(participant, mi);
-	if (peer)
-		return peer;
-
-	return ieee802_1x_kay_get_potential_peer(participant, mi);
+	return get_peer_mi(participant, mi);
 }
 
 
@@ -397,6 +397,12 @@ static Boolean sci_equal(const struct ieee802_1x_mka_sci *a,
 }
 
 
+static Boolean sci_is_zero(const struct ieee802_1x_mka_sci *sci)
+{
+	return is_zero_ether_addr(sci->addr) && !sci->port;
+}
+
+
 /**
  * ieee802_1x_kay_get_peer_sci
  */
@@ -404,21 +410,197 @@ static struct ieee802_1x_kay_peer *
 ieee802_1x_kay_get_peer_sci(struct ieee802_1x_mka_participant *participant,
 			    const struct ieee802_1x_mka_sci *sci)
 {
-	struct ieee802_1x_kay_peer *peer;
+	struct ieee802_1x_kay_peer *peer, *potential = NULL;
 
-	dl_list_for_each(peer, &participant->live_peers,
-			 struct ieee802_1x_kay_peer, list) {
-		if (sci_equal(&peer->sci, sci))
+	/* Potential peers learned from a peer list do not have an SCI and
+	 * are not in the index. */
+	if (sci_is_zero(sci))
+		return NULL;
+
+	for (peer = participant->peer_sci_hash[MKA_PEER_SCI_HASH(sci)]; peer;
+	     peer = peer->sci_hnext) {
+		if (!sci_equal(&peer->sci, sci))
+			continue;
+		if (peer->live)
 			return peer;
+		if (!potential)
+			potential = peer;
 	}
 
-	dl_list_for_each(peer, &participant->potential_peers,
-			 struct ieee802_1x_kay_peer, list) {
-		if (sci_equal(&peer->sci, sci))
-			return peer;
+	return potential;
+}
+
+
+static int mka_peer_ids_add(struct mka_peer_ids *set,
+			    struct ieee802_1x_kay_peer *peer)
+{
+	if (set->num >= MKA_MAX_PEERS) {
+		wpa_printf(MSG_DEBUG, "KaY: Peer list is full");
+		return -1;
 	}
 
-	return NULL;
+	if (set->num == set->size) {
+		struct ieee802_1x_mka_peer_id *ids;
+		struct ieee802_1x_kay_peer **peers;
+		size_t size = set->size ? 2 * set->size : 8;
+
+		ids = os_realloc_array(set->ids, size, sizeof(*ids));
+		if (!ids)
+			return -1;
+		set->ids = ids;
+		peers = os_realloc_array(set->peers, size, sizeof(*peers));
+		if (!peers)
+			return -1;
+		set->peers = peers;
+		set->size = size;
+	}
+
+	peer->id_idx = set->num++;
+	set->peers[peer->id_idx] = peer;
+	os_memcpy(set->ids[peer->id_idx].mi, peer->mi, MI_LEN);
+	set->ids[peer->id_idx].mn = host_to_be32(peer->mn);
+
+	return 0;
+}
+
+
+static void mka_peer_ids_del(struct mka_peer_ids *set, size_t idx)
+{
+	set->num--;
+	if (idx < set->num) {
+		set->ids[idx] = set->ids[set->num];
+		set->peers[idx] = set->peers[set->num];
+		set->peers[idx]->id_idx = idx;
+	}
+}
+
+
+static void mka_peer_ids_free(struct mka_peer_ids *set)
+{
+	os_free(set->ids);
+	os_free(set->peers);
+	os_memset(set, 0, sizeof(*set));
+}
+
+
+static struct mka_peer_ids *
+ieee802_1x_kay_peer_ids(struct ieee802_1x_mka_participant *participant,
+			struct ieee802_1x_kay_peer *peer)
+{
+	return peer->live ? &participant->live_ids :
+		&participant->potential_ids;
+}
+
+
+static void
+ieee802_1x_kay_peer_sci_hash_del(struct ieee802_1x_mka_participant *participant,
+				 struct ieee802_1x_kay_peer *peer)
+{
+	struct ieee802_1x_kay_peer **pos;
+
+	if (sci_is_zero(&peer->sci))
+		return;
+
+	pos = &participant->peer_sci_hash[MKA_PEER_SCI_HASH(&peer->sci)];
+	while (*pos && *pos != peer)
+		pos = &(*pos)->sci_hnext;
+	if (*pos)
+		*pos = peer->sci_hnext;
+	peer->sci_hnext = NULL;
+}
+
+
+static void
+ieee802_1x_kay_peer_sci_hash_add(struct ieee802_1x_mka_participant *participant,
+				 struct ieee802_1x_kay_peer *peer)
+{
+	struct ieee802_1x_kay_peer **pos;
+
+	if (sci_is_zero(&peer->sci))
+		return;
+
+	pos = &participant->peer_sci_hash[MKA_PEER_SCI_HASH(&peer->sci)];
+	peer->sci_hnext = *pos;
+	*pos = peer;
+}
+
+
+/**
+ * ieee802_1x_kay_peer_set_sci - Update the SCI of a peer and its index
+ */
+static void
+ieee802_1x_kay_peer_set_sci(struct ieee802_1x_mka_participant *participant,
+			    struct ieee802_1x_kay_peer *peer,
+			    const struct ieee802_1x_mka_sci *sci)
+{
+	ieee802_1x_kay_peer_sci_hash_del(participant, peer);
+	os_memcpy(&peer->sci, sci, sizeof(peer->sci));
+	ieee802_1x_kay_peer_sci_hash_add(participant, peer);
+}
+
+
+/**
+ * ieee802_1x_kay_peer_set_mn - Update the MN of a peer
+ *
+ * This updates the peer's entry in the encoded peer list, too.
+ */
+static void
+ieee802_1x_kay_peer_set_mn(struct ieee802_1x_mka_participant *participant,
+			   struct ieee802_1x_kay_peer *peer, u32 mn)
+{
+	peer->mn = mn;
+	ieee802_1x_kay_peer_ids(participant, peer)->ids[peer->id_idx].mn =
+		host_to_be32(mn);
+}
+
+
+/**
+ * ieee802_1x_kay_link_peer - Add a peer to the live or potential peer list
+ */
+static int
+ieee802_1x_kay_link_peer(struct ieee802_1x_mka_participant *participant,
+			 struct ieee802_1x_kay_peer *peer, Boolean live)
+{
+	struct ieee802_1x_kay_peer **pos;
+
+	peer->live = live;
+	if (mka_peer_ids_add(ieee802_1x_kay_peer_ids(participant, peer),
+			     peer) < 0)
+		return -1;
+
+	pos = &participant->peer_mi_hash[MKA_PEER_MI_HASH(peer->mi)];
+	peer->mi_hnext = *pos;
+	*pos = peer;
+
+	ieee802_1x_kay_peer_sci_hash_add(participant, peer);
+
+	dl_list_add(live ? &participant->live_peers :
+		    &participant->potential_peers, &peer->list);
+
+	return 0;
+}
+
+
+/**
+ * ieee802_1x_kay_remove_peer - Remove a peer from its list and free it
+ */
+static void
+ieee802_1x_kay_remove_peer(struct ieee802_1x_mka_participant *participant,
+			   struct ieee802_1x_kay_peer *peer)
+{
+	struct ieee802_1x_kay_peer **pos;
+
+	pos = &participant->peer_mi_hash[MKA_PEER_MI_HASH(peer->mi)];
+	while (*pos && *pos != peer)
+		pos = &(*pos)->mi_hnext;
+	if (*pos)
+		*pos = peer->mi_hnext;
+	ieee802_1x_kay_peer_sci_hash_del(participant, peer);
+	mka_peer_ids_del(ieee802_1x_kay_peer_ids(participant, peer),
+			 peer->id_idx);
+
+	dl_list_del(&peer->list);
+	os_free(peer);
 }
 
 
@@ -589,7 +771,11 @@ ieee802_1x_kay_create_live_peer(struct ieee802_1x_mka_participant *participant,
 		return NULL;
 	}
 
-	dl_list_add(&participant->live_peers, &peer->list);
+	if (ieee802_1x_kay_link_peer(participant, peer, TRUE) < 0) {
+		os_free(rxsc);
+		os_free(peer);
+		return NULL;
+	}
 	dl_list_add(&participant->rxsc_list, &rxsc->list);
 	secy_create_receive_sc(participant->kay, rxsc);
 
@@ -613,7 +799,10 @@ ieee802_1x_kay_create_potential_peer(
 	if (!peer)
 		return NULL;
 
-	dl_list_add(&participant->potential_peers, &peer->list);
+	if (ieee802_1x_kay_link_peer(participant, peer, FALSE) < 0) {
+		os_free(peer);
+		return NULL;
+	}
 
 	wpa_printf(MSG_DEBUG, "KaY: potential peer created");
 	ieee802_1x_kay_dump_peer(peer);
@@ -631,6 +820,7 @@ ieee802_1x_kay_move_live_peer(struct ieee802_1x_mka_participant *participant,
 {
 	struct ieee802_1x_kay_peer *peer;
 	struct receive_sc *rxsc;
+	size_t idx;
 
 	peer = ieee802_1x_kay_get_potential_peer(participant, mi);
 	if (!peer)
@@ -640,9 +830,17 @@ ieee802_1x_kay_move_live_peer(struct ieee802_1x_mka_participant *participant,
 	if (!rxsc)
 		return NULL;
 
-	os_memcpy(&peer->sci, &participant->current_peer_sci,
-		  sizeof(peer->sci));
-	peer->mn = mn;
+	idx = peer->id_idx;
+	if (mka_peer_ids_add(&participant->live_ids, peer) < 0) {
+		os_free(rxsc);
+		return NULL;
+	}
+	mka_peer_ids_del(&participant->potential_ids, idx);
+	peer->live = TRUE;
+
+	ieee802_1x_kay_peer_set_sci(participant, peer,
+				    &participant->current_peer_sci);
+	ieee802_1x_kay_peer_set_mn(participant, peer, mn);
 	peer->expire = time(NULL) + MKA_LIFE_TIME / 1000;
 
 	wpa_printf(MSG_DEBUG, "KaY: move potential peer to live peer");
@@ -791,8 +989,7 @@ ieee802_1x_mka_decode_basic_body(struct ieee802_1x_kay *kay, const u8 *mka_msg,
 		if (peer) {
 			wpa_printf(MSG_WARNING,
 				   "KaY: duplicated SCI detected, Maybe active attacker");
-			dl_list_del(&peer->list);
-			os_free(peer);
+			ieee802_1x_kay_remove_peer(participant, peer);
 		}
 
 		peer = ieee802_1x_kay_create_potential_peer(
@@ -806,7 +1003,8 @@ ieee802_1x_mka_decode_basic_body(struct ieee802_1x_kay *kay, const u8 *mka_msg,
 		peer->is_key_server = (Boolean) body->key_server;
 		peer->key_server_priority = body->priority;
 	} else if (peer->mn < be_to_host32(body->actor_mn)) {
-		peer->mn = be_to_host32(body->actor_mn);
+		ieee802_1x_kay_peer_set_mn(participant, peer,
+					   be_to_host32(body->actor_mn));
 		peer->expire = time(NULL) + MKA_LIFE_TIME / 1000;
 		peer->macsec_desired = body->macsec_desired;
 		peer->macsec_capability = body->macsec_capability;
@@ -840,11 +1038,8 @@ ieee802_1x_mka_get_live_peer_length(
 	struct ieee802_1x_mka_participant *participant)
 {
 	int len = MKA_HDR_LEN;
-	struct ieee802_1x_kay_peer *peer;
 
-	dl_list_for_each(peer, &participant->live_peers,
-			 struct ieee802_1x_kay_peer, list)
-		len += sizeof(struct ieee802_1x_mka_peer_id);
+	len += participant->live_ids.num * sizeof(struct ieee802_1x_mka_peer_id);
 
 	return MKA_ALIGN_LENGTH(len);
 }
@@ -859,9 +1054,7 @@ ieee802_1x_mka_encode_live_peer_body(
 	struct wpabuf *buf)
 {
 	struct ieee802_1x_mka_peer_body *body;
-	struct ieee802_1x_kay_peer *peer;
 	unsigned int length;
-	struct ieee802_1x_mka_peer_id *body_peer;
 
 	length = ieee802_1x_mka_get_live_peer_length(participant);
 	body = wpabuf_put(buf, sizeof(struct ieee802_1x_mka_peer_body));
@@ -869,13 +1062,10 @@ ieee802_1x_mka_encode_live_peer_body(
 	body->type = MKA_LIVE_PEER_LIST;
 	set_mka_param_body_len(body, length - MKA_HDR_LEN);
 
-	dl_list_for_each(peer, &participant->live_peers,
-			 struct ieee802_1x_kay_peer, list) {
-		body_peer = wpabuf_put(buf,
-				       sizeof(struct ieee802_1x_mka_peer_id));
-		os_memcpy(body_peer->mi, peer->mi, MI_LEN);
-		body_peer->mn = host_to_be32(peer->mn);
-	}
+	/* The body is maintained in MKPDU format as peers are updated */
+	wpabuf_put_data(buf, participant->live_ids.ids,
+			participant->live_ids.num *
+			sizeof(struct ieee802_1x_mka_peer_id));
 
 	ieee802_1x_mka_dump_peer_body(body);
 	return 0;
@@ -900,11 +1090,8 @@ ieee802_1x_mka_get_potential_peer_length(
 	struct ieee802_1x_mka_participant *participant)
 {
 	int len = MKA_HDR_LEN;
-	struct ieee802_1x_kay_peer *peer;
 
-	dl_list_for_each(peer, &participant->potential_peers,
-			 struct ieee802_1x_kay_peer, list)
-		len += sizeof(struct ieee802_1x_mka_peer_id);
+	len += participant->potential_ids.num * sizeof(struct ieee802_1x_mka_peer_id);
 
 	return MKA_ALIGN_LENGTH(len);
 }
@@ -919,9 +1106,7 @@ ieee802_1x_mka_encode_potential_peer_body(
 	struct wpabuf *buf)
 {
 	struct ieee802_1x_mka_peer_body *body;
-	struct ieee802_1x_kay_peer *peer;
 	unsigned int length;
-	struct ieee802_1x_mka_peer_id *body_peer;
 
 	length = ieee802_1x_mka_get_potential_peer_length(participant);
 	body = wpabuf_put(buf, sizeof(struct ieee802_1x_mka_peer_body));
@@ -929,13 +1114,10 @@ ieee802_1x_mka_encode_potential_peer_body(
 	body->type = MKA_POTENTIAL_PEER_LIST;
 	set_mka_param_body_len(body, length - MKA_HDR_LEN);
 
-	dl_list_for_each(peer, &participant->potential_peers,
-			 struct ieee802_1x_kay_peer, list) {
-		body_peer = wpabuf_put(buf,
-				       sizeof(struct ieee802_1x_mka_peer_id));
-		os_memcpy(body_peer->mi, peer->mi, MI_LEN);
-		body_peer->mn = host_to_be32(peer->mn);
-	}
+	/* The body is maintained in MKPDU format as peers are updated */
+	wpabuf_put_data(buf, participant->potential_ids.ids,
+			participant->potential_ids.num *
+			sizeof(struct ieee802_1x_mka_peer_id));
 
 	ieee802_1x_mka_dump_peer_body(body);
 	return 0;
@@ -964,21 +1146,21 @@ ieee802_1x_mka_i_in_peerlist(struct ieee802_1x_mka_participant *participant,
 		body_len = get_mka_param_body_len(hdr);
 		body_type = get_mka_param_body_type(hdr);
 
-		if (body_type != MKA_LIVE_PEER_LIST &&
-		    body_type != MKA_POTENTIAL_PEER_LIST)
-			continue;
-
-		ieee802_1x_mka_dump_peer_body(
-			(struct ieee802_1x_mka_peer_body *)pos);
-
 		if (left_len < (MKA_HDR_LEN + body_len + DEFAULT_ICV_LEN)) {
 			wpa_printf(MSG_ERROR,
 				   "KaY: MKA Peer Packet Body Length (%zu bytes) is less than the Parameter Set Header Length (%zu bytes) + the Parameter Set Body Length (%zu bytes) + %d bytes of ICV",
 				   left_len, MKA_HDR_LEN,
 				   body_len, DEFAULT_ICV_LEN);
-			continue;
+			return FALSE;
 		}
 
+		if (body_type != MKA_LIVE_PEER_LIST &&
+		    body_type != MKA_POTENTIAL_PEER_LIST)
+			continue;
+
+		ieee802_1x_mka_dump_peer_body(
+			(struct ieee802_1x_mka_peer_body *)pos);
+
 		if ((body_len % 16) != 0) {
 			wpa_printf(MSG_ERROR,
 				   "KaY: MKA Peer Packet Body Length (%zu bytes) should be a multiple of 16 octets",
@@ -1015,6 +1197,7 @@ static int ieee802_1x_mka_decode_live_peer_body(
 	size_t body_len;
 	size_t i;
 	Boolean is_included;
+	time_t expire = time(NULL) + MKA_LIFE_TIME / 1000;
 
 	is_included = ieee802_1x_kay_is_in_live_peer(
 		participant, participant->current_peer_id.mi);
@@ -1050,8 +1233,8 @@ static int ieee802_1x_mka_decode_live_peer_body(
 
 		peer = ieee802_1x_kay_get_peer(participant, peer_mi->mi);
 		if (peer) {
-			peer->mn = peer_mn;
-			peer->expire = time(NULL) + MKA_LIFE_TIME / 1000;
+			ieee802_1x_kay_peer_set_mn(participant, peer, peer_mn);
+			peer->expire = expire;
 		} else if (!ieee802_1x_kay_create_potential_peer(
 				participant, peer_mi->mi, peer_mn)) {
 			return -1;
@@ -2368,8 +2551,7 @@ static void ieee802_1x_participant_timer(void *eloop_ctx, void *timeout_ctx)
 						participant, rxsc);
 				}
 			}
-			dl_list_del(&peer->list);
-			os_free(peer);
+			ieee802_1x_kay_remove_peer(participant, peer);
 			lp_changed = TRUE;
 		}
 	}
@@ -2418,8 +2600,7 @@ static void ieee802_1x_participant_timer(void *eloop_ctx, void *timeout_ctx)
 			wpa_hexdump(MSG_DEBUG, "\tMI: ", peer->mi,
 				    sizeof(peer->mi));
 			wpa_printf(MSG_DEBUG, "\tMN: %d", peer->mn);
-			dl_list_del(&peer->list);
-			os_free(peer);
+			ieee802_1x_kay_remove_peer(participant, peer);
 		}
 	}
 
@@ -3018,7 +3199,7 @@ static int ieee802_1x_kay_decode_mkpdu(struct ieee802_1x_kay *kay,
 				   "KaY: MKA Peer Packet Body Length (%zu bytes) is less than the Parameter Set Header Length (%zu bytes) + the Parameter Set Body Length (%zu bytes) + %d bytes of ICV",
 				   left_len, MKA_HDR_LEN,
 				   body_len, DEFAULT_ICV_LEN);
-			continue;
+			return -1;
 		}
 
 		if (handled[body_type])
@@ -3413,17 +3594,17 @@ ieee802_1x_kay_delete_mka(struct ieee802_1x_kay *kay, struct mka_key_name *ckn)
 	while (!dl_list_empty(&participant->live_peers)) {
 		peer = dl_list_entry(participant->live_peers.next,
 				     struct ieee802_1x_kay_peer, list);
-		dl_list_del(&peer->list);
-		os_free(peer);
+		ieee802_1x_kay_remove_peer(participant, peer);
 	}
+	mka_peer_ids_free(&participant->live_ids);
 
 	/* remove potential peer */
 	while (!dl_list_empty(&participant->potential_peers)) {
 		peer = dl_list_entry(participant->potential_peers.next,
 				     struct ieee802_1x_kay_peer, list);
-		dl_list_del(&peer->list);
-		os_free(peer);
+		ieee802_1x_kay_remove_peer(participant, peer);
 	}
+	mka_peer_ids_free(&participant->potential_ids);
 
 	/* remove sak */
 	while (!dl_list_empty(&participant->sak_list)) {
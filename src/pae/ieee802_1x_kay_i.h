@@ -52,6 +52,31 @@ struct ieee802_1x_kay_peer {
 	enum macsec_cap macsec_capability;
 	Boolean sak_used;
 	struct dl_list list;
+
+	/* not defined in IEEE 802.1X */
+	Boolean live;
+	size_t id_idx; /* index in the participant's live/potential peer ids */
+	struct ieee802_1x_kay_peer *mi_hnext; /* next entry in peer_mi_hash */
+	struct ieee802_1x_kay_peer *sci_hnext; /* next entry in peer_sci_hash */
+};
+
+/* Peer List parameter set body length is limited to 12 bits */
+#define MKA_MAX_PEERS (0xfff / sizeof(struct ieee802_1x_mka_peer_id))
+
+/**
+ * struct mka_peer_ids - Encoded peer list of a participant
+ * @ids: Live/Potential Peer List parameter set body in MKPDU format; the
+ *	MI/MN of a peer is updated in place so that the body does not need to
+ *	be rebuilt for each transmitted MKPDU
+ * @peers: Peer entry owning each entry in @ids
+ * @num: Number of entries in @ids
+ * @size: Number of allocated entries in @ids and @peers
+ */
+struct mka_peer_ids {
+	struct ieee802_1x_mka_peer_id *ids;
+	struct ieee802_1x_kay_peer **peers;
+	size_t num;
+	size_t size;
 };
 
 struct macsec_ciphersuite {
@@ -105,6 +130,17 @@ struct ieee802_1x_mka_participant {
 	/* not defined in IEEE 802.1X */
 	struct dl_list list;
 
+#define MKA_PEER_HASH_SIZE 256
+#define MKA_PEER_MI_HASH(mi) ((mi)[0])
+#define MKA_PEER_SCI_HASH(sci) \
+	(((sci)->addr[5] ^ ((const u8 *) &(sci)->port)[1]) & \
+	 (MKA_PEER_HASH_SIZE - 1))
+	/* live and potential peers indexed by MI and by non-zero SCI */
+	struct ieee802_1x_kay_peer *peer_mi_hash[MKA_PEER_HASH_SIZE];
+	struct ieee802_1x_kay_peer *peer_sci_hash[MKA_PEER_HASH_SIZE];
+	struct mka_peer_ids live_ids;
+	struct mka_peer_ids potential_ids;
+
 	struct mka_key kek;
 	struct mka_key ick;
 
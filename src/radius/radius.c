@@ -10,6 +10,7 @@
 
 #include "utils/common.h"
 #include "utils/wpabuf.h"
+#include "utils/mem_pool.h"
 #include "crypto/md5.h"
 #include "crypto/crypto.h"
 #include "radius.h"
@@ -21,9 +22,17 @@
 struct radius_msg {
 	/**
 	 * buf - Allocated buffer for RADIUS message
+	 *
+	 * For messages from radius_msg_parse_inplace(), this points to
+	 * ext_buf until radius_msg_own_buf() has been called.
 	 */
 	struct wpabuf *buf;
 
+	/**
+	 * ext_buf - Buffer descriptor for caller owned message data
+	 */
+	struct wpabuf ext_buf;
+
 	/**
 	 * hdr - Pointer to the RADIUS header in buf
 	 */
@@ -46,8 +55,19 @@ struct radius_msg {
 	 * attr_used - Total number of attributes in the array
 	 */
 	size_t attr_used;
+
+	/**
+	 * attr_pos_buf - Initial attribute index array
+	 *
+	 * attr_pos points here until the message has more than
+	 * RADIUS_DEFAULT_ATTR_COUNT attributes.
+	 */
+	size_t attr_pos_buf[RADIUS_DEFAULT_ATTR_COUNT];
 };
 
+static struct mem_pool radius_msg_pool =
+	MEM_POOL_INIT("radius_msg", sizeof(struct radius_msg), 32);
+
 
 struct radius_hdr * radius_msg_get_hdr(struct radius_msg *msg)
 {
@@ -76,17 +96,11 @@ static void radius_msg_set_hdr(struct radius_msg *msg, u8 code, u8 identifier)
 }
 
 
-static int radius_msg_initialize(struct radius_msg *msg)
+static void radius_msg_initialize(struct radius_msg *msg)
 {
-	msg->attr_pos = os_calloc(RADIUS_DEFAULT_ATTR_COUNT,
-				  sizeof(*msg->attr_pos));
-	if (msg->attr_pos == NULL)
-		return -1;
-
+	msg->attr_pos = msg->attr_pos_buf;
 	msg->attr_size = RADIUS_DEFAULT_ATTR_COUNT;
 	msg->attr_used = 0;
-
-	return 0;
 }
 
 
@@ -100,15 +114,40 @@ static int radius_msg_initialize(struct radius_msg *msg)
  * radius_msg_free().
  */
 struct radius_msg * radius_msg_new(u8 code, u8 identifier)
+{
+	return radius_msg_new_len(code, identifier,
+				  RADIUS_DEFAULT_MSG_SIZE -
+				  sizeof(struct radius_hdr));
+}
+
+
+/**
+ * radius_msg_new_len - Create a new RADIUS message with a size estimate
+ * @code: Code for RADIUS header
+ * @identifier: Identifier for RADIUS header
+ * @attr_len: Expected total length of the attributes in octets
+ * Returns: Context for RADIUS message or %NULL on failure
+ *
+ * The message buffer is allocated for the RADIUS header and attr_len octets
+ * of attributes so that adding the attributes does not need to reallocate
+ * the buffer. The estimate does not need to be exact; the buffer is extended
+ * if more attributes are added. radius_msg_eap_len() can be used to
+ * calculate the space needed for EAP-Message attributes.
+ *
+ * The caller is responsible for freeing the returned data with
+ * radius_msg_free().
+ */
+struct radius_msg * radius_msg_new_len(u8 code, u8 identifier, size_t attr_len)
 {
 	struct radius_msg *msg;
 
-	msg = os_zalloc(sizeof(*msg));
+	msg = mem_pool_alloc(&radius_msg_pool);
 	if (msg == NULL)
 		return NULL;
 
-	msg->buf = wpabuf_alloc(RADIUS_DEFAULT_MSG_SIZE);
-	if (msg->buf == NULL || radius_msg_initialize(msg)) {
+	radius_msg_initialize(msg);
+	msg->buf = wpabuf_alloc(sizeof(struct radius_hdr) + attr_len);
+	if (msg->buf == NULL) {
 		radius_msg_free(msg);
 		return NULL;
 	}
@@ -129,9 +168,11 @@ void radius_msg_free(struct radius_msg *msg)
 	if (msg == NULL)
 		return;
 
-	wpabuf_free(msg->buf);
-	os_free(msg->attr_pos);
-	os_free(msg);
+	if (msg->buf != &msg->ext_buf)
+		wpabuf_free(msg->buf);
+	if (msg->attr_pos != msg->attr_pos_buf)
+		os_free(msg->attr_pos);
+	mem_pool_free(&radius_msg_pool, msg);
 }
 
 
@@ -609,8 +650,15 @@ static int radius_msg_add_attr_to_array(struct radius_msg *msg,
 		size_t *nattr_pos;
 		int nlen = msg->attr_size * 2;
 
-		nattr_pos = os_realloc_array(msg->attr_pos, nlen,
-					     sizeof(*msg->attr_pos));
+		if (msg->attr_pos == msg->attr_pos_buf) {
+			nattr_pos = os_calloc(nlen, sizeof(*msg->attr_pos));
+			if (nattr_pos)
+				os_memcpy(nattr_pos, msg->attr_pos_buf,
+					  sizeof(msg->attr_pos_buf));
+		} else {
+			nattr_pos = os_realloc_array(msg->attr_pos, nlen,
+						     sizeof(*msg->attr_pos));
+		}
 		if (nattr_pos == NULL)
 			return -1;
 
@@ -640,11 +688,28 @@ struct radius_attr_hdr *radius_msg_add_attr(struct radius_msg *msg, u8 type,
 		return NULL;
 	}
 
+	if (radius_msg_own_buf(msg) < 0)
+		return NULL;
+
 	buf_needed = sizeof(*attr) + data_len;
 
 	if (wpabuf_tailroom(msg->buf) < buf_needed) {
-		/* allocate more space for message buffer */
-		if (wpabuf_resize(&msg->buf, buf_needed) < 0)
+		size_t add_len;
+
+		/*
+		 * Allocate more space for message buffer. Grow by the current
+		 * length (up to the maximum RADIUS message length) so that a
+		 * message that did not get a large enough size estimate is
+		 * not reallocated for each new attribute.
+		 */
+		add_len = wpabuf_len(msg->buf);
+		if (add_len >= RADIUS_MAX_MSG_LEN)
+			add_len = 0;
+		else if (add_len > RADIUS_MAX_MSG_LEN - add_len)
+			add_len = RADIUS_MAX_MSG_LEN - add_len;
+		if (add_len < buf_needed)
+			add_len = buf_needed;
+		if (wpabuf_resize(&msg->buf, add_len) < 0)
 			return NULL;
 		msg->hdr = wpabuf_mhead(msg->buf);
 	}
@@ -661,6 +726,79 @@ struct radius_attr_hdr *radius_msg_add_attr(struct radius_msg *msg, u8 type,
 }
 
 
+static struct radius_msg * radius_msg_parse_hdr(const u8 *data, size_t len,
+						size_t *msg_len)
+{
+	const struct radius_hdr *hdr;
+	struct radius_msg *msg;
+
+	if (data == NULL || len < sizeof(*hdr))
+		return NULL;
+
+	hdr = (const struct radius_hdr *) data;
+
+	*msg_len = be_to_host16(hdr->length);
+	if (*msg_len < sizeof(*hdr) || *msg_len > len) {
+		wpa_printf(MSG_INFO, "RADIUS: Invalid message length");
+		return NULL;
+	}
+
+	if (*msg_len < len) {
+		wpa_printf(MSG_DEBUG, "RADIUS: Ignored %lu extra bytes after "
+			   "RADIUS message", (unsigned long) len - *msg_len);
+	}
+
+	msg = mem_pool_alloc(&radius_msg_pool);
+	if (msg == NULL)
+		return NULL;
+
+	radius_msg_initialize(msg);
+	return msg;
+}
+
+
+static int radius_msg_parse_attrs(struct radius_msg *msg)
+{
+	struct radius_attr_hdr *attr;
+	unsigned char *start, *pos, *end;
+	size_t count = 0;
+
+	start = wpabuf_mhead_u8(msg->buf) + sizeof(struct radius_hdr);
+	end = wpabuf_mhead_u8(msg->buf) + wpabuf_len(msg->buf);
+
+	/* Validate and count the attributes to size the index only once */
+	for (pos = start; pos < end; pos += attr->length) {
+		if ((size_t) (end - pos) < sizeof(*attr))
+			return -1;
+
+		attr = (struct radius_attr_hdr *) pos;
+
+		if (attr->length > end - pos || attr->length < sizeof(*attr))
+			return -1;
+
+		/* TODO: check that attr->length is suitable for attr->type */
+
+		count++;
+	}
+
+	if (count > msg->attr_size) {
+		msg->attr_pos = os_calloc(count, sizeof(*msg->attr_pos));
+		if (msg->attr_pos == NULL) {
+			msg->attr_pos = msg->attr_pos_buf;
+			return -1;
+		}
+		msg->attr_size = count;
+	}
+
+	for (pos = start; pos < end; pos += attr->length) {
+		attr = (struct radius_attr_hdr *) pos;
+		msg->attr_pos[msg->attr_used++] = pos - wpabuf_head_u8(msg->buf);
+	}
+
+	return 0;
+}
+
+
 /**
  * radius_msg_parse - Parse a RADIUS message
  * @data: RADIUS message to be parsed
@@ -673,63 +811,87 @@ struct radius_attr_hdr *radius_msg_add_attr(struct radius_msg *msg, u8 type,
 struct radius_msg * radius_msg_parse(const u8 *data, size_t len)
 {
 	struct radius_msg *msg;
-	struct radius_hdr *hdr;
-	struct radius_attr_hdr *attr;
 	size_t msg_len;
-	unsigned char *pos, *end;
 
-	if (data == NULL || len < sizeof(*hdr))
+	msg = radius_msg_parse_hdr(data, len, &msg_len);
+	if (msg == NULL)
 		return NULL;
 
-	hdr = (struct radius_hdr *) data;
-
-	msg_len = be_to_host16(hdr->length);
-	if (msg_len < sizeof(*hdr) || msg_len > len) {
-		wpa_printf(MSG_INFO, "RADIUS: Invalid message length");
+	msg->buf = wpabuf_alloc_copy(data, msg_len);
+	if (msg->buf == NULL) {
+		radius_msg_free(msg);
 		return NULL;
 	}
+	msg->hdr = wpabuf_mhead(msg->buf);
 
-	if (msg_len < len) {
-		wpa_printf(MSG_DEBUG, "RADIUS: Ignored %lu extra bytes after "
-			   "RADIUS message", (unsigned long) len - msg_len);
+	if (radius_msg_parse_attrs(msg) < 0) {
+		radius_msg_free(msg);
+		return NULL;
 	}
 
-	msg = os_zalloc(sizeof(*msg));
+	return msg;
+}
+
+
+/**
+ * radius_msg_parse_inplace - Parse a RADIUS message without copying it
+ * @data: RADIUS message to be parsed
+ * @len: Length of data buffer in octets
+ * Returns: Parsed RADIUS message or %NULL on failure
+ *
+ * This parses a RADIUS message in the caller's buffer, e.g., the buffer into
+ * which the message was received. The returned message refers to data and
+ * may modify it (e.g., when verifying or finishing the message), so data must
+ * remain valid and must not be reused until the message has been freed with
+ * radius_msg_free(). A message that needs to be kept after that (e.g., stored
+ * for a later response) must first be given its own copy of the data with
+ * radius_msg_own_buf(). Adding attributes makes that copy automatically.
+ */
+struct radius_msg * radius_msg_parse_inplace(u8 *data, size_t len)
+{
+	struct radius_msg *msg;
+	size_t msg_len;
+
+	msg = radius_msg_parse_hdr(data, len, &msg_len);
 	if (msg == NULL)
 		return NULL;
 
-	msg->buf = wpabuf_alloc_copy(data, msg_len);
-	if (msg->buf == NULL || radius_msg_initialize(msg)) {
+	wpabuf_set(&msg->ext_buf, data, msg_len);
+	msg->buf = &msg->ext_buf;
+	msg->hdr = (struct radius_hdr *) data;
+
+	if (radius_msg_parse_attrs(msg) < 0) {
 		radius_msg_free(msg);
 		return NULL;
 	}
-	msg->hdr = wpabuf_mhead(msg->buf);
 
-	/* parse attributes */
-	pos = wpabuf_mhead_u8(msg->buf) + sizeof(struct radius_hdr);
-	end = wpabuf_mhead_u8(msg->buf) + wpabuf_len(msg->buf);
-	while (pos < end) {
-		if ((size_t) (end - pos) < sizeof(*attr))
-			goto fail;
-
-		attr = (struct radius_attr_hdr *) pos;
-
-		if (attr->length > end - pos || attr->length < sizeof(*attr))
-			goto fail;
+	return msg;
+}
 
-		/* TODO: check that attr->length is suitable for attr->type */
 
-		if (radius_msg_add_attr_to_array(msg, attr))
-			goto fail;
+/**
+ * radius_msg_own_buf - Make a parsed RADIUS message independent of its data
+ * @msg: RADIUS message from radius_msg_parse_inplace()
+ * Returns: 0 on success, -1 on failure
+ *
+ * This copies the message data from the buffer that was passed to
+ * radius_msg_parse_inplace() into a buffer owned by the message. This does
+ * nothing for messages that already own their buffer.
+ */
+int radius_msg_own_buf(struct radius_msg *msg)
+{
+	struct wpabuf *buf;
 
-		pos += attr->length;
-	}
+	if (msg->buf != &msg->ext_buf)
+		return 0;
 
-	return msg;
+	buf = wpabuf_dup(&msg->ext_buf);
+	if (buf == NULL)
+		return -1;
+	msg->buf = buf;
+	msg->hdr = wpabuf_mhead(buf);
 
- fail:
-	radius_msg_free(msg);
-	return NULL;
+	return 0;
 }
 
 
@@ -757,39 +919,78 @@ int radius_msg_add_eap(struct radius_msg *msg, const u8 *data, size_t data_len)
 }
 
 
-struct wpabuf * radius_msg_get_eap(struct radius_msg *msg)
+/**
+ * radius_msg_get_eap_vec - Get EAP-Message fragments without copying them
+ * @msg: RADIUS message
+ * @addr: Array for pointers to the EAP-Message attribute values
+ * @len: Array for the lengths of the EAP-Message attribute values
+ * @num: Number of elements in addr and len arrays
+ * Returns: Number of non-empty EAP-Message attributes in the message
+ *
+ * Only the first num fragments are stored if the message has more than num
+ * EAP-Message attributes. The pointers refer to the message buffer and are
+ * valid until the message is freed or modified.
+ */
+int radius_msg_get_eap_vec(struct radius_msg *msg, const u8 *addr[],
+			   size_t len[], size_t num)
 {
-	struct wpabuf *eap;
-	size_t len, i;
 	struct radius_attr_hdr *attr;
+	size_t i;
+	int count = 0;
 
 	if (msg == NULL)
-		return NULL;
+		return 0;
 
-	len = 0;
 	for (i = 0; i < msg->attr_used; i++) {
 		attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == RADIUS_ATTR_EAP_MESSAGE &&
-		    attr->length > sizeof(struct radius_attr_hdr))
-			len += attr->length - sizeof(struct radius_attr_hdr);
+		if (attr->type != RADIUS_ATTR_EAP_MESSAGE ||
+		    attr->length <= sizeof(struct radius_attr_hdr))
+			continue;
+		if ((size_t) count < num) {
+			addr[count] = (const u8 *) (attr + 1);
+			len[count] = attr->length - sizeof(*attr);
+		}
+		count++;
 	}
 
-	if (len == 0)
-		return NULL;
+	return count;
+}
 
-	eap = wpabuf_alloc(len);
-	if (eap == NULL)
-		return NULL;
 
-	for (i = 0; i < msg->attr_used; i++) {
-		attr = radius_get_attr_hdr(msg, i);
-		if (attr->type == RADIUS_ATTR_EAP_MESSAGE &&
-		    attr->length > sizeof(struct radius_attr_hdr)) {
-			int flen = attr->length - sizeof(*attr);
-			wpabuf_put_data(eap, attr + 1, flen);
-		}
+struct wpabuf * radius_msg_get_eap(struct radius_msg *msg)
+{
+	const u8 *_addr[RADIUS_EAP_VEC_LEN], **addr = _addr;
+	size_t _len[RADIUS_EAP_VEC_LEN], *len = _len;
+	struct wpabuf *eap = NULL;
+	size_t total = 0;
+	int i, num;
+
+	num = radius_msg_get_eap_vec(msg, addr, len, RADIUS_EAP_VEC_LEN);
+	if (num > RADIUS_EAP_VEC_LEN) {
+		addr = os_calloc(num, sizeof(*addr));
+		len = os_calloc(num, sizeof(*len));
+		if (addr == NULL || len == NULL)
+			goto out;
+		radius_msg_get_eap_vec(msg, addr, len, num);
 	}
 
+	for (i = 0; i < num; i++)
+		total += len[i];
+	if (total == 0)
+		goto out;
+
+	eap = wpabuf_alloc(total);
+	if (eap == NULL)
+		goto out;
+
+	for (i = 0; i < num; i++)
+		wpabuf_put_data(eap, addr[i], len[i]);
+
+out:
+	if (addr != _addr)
+		os_free(addr);
+	if (len != _len)
+		os_free(len);
 	return eap;
 }
 
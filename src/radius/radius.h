@@ -215,6 +215,15 @@ struct radius_msg;
 /* Default size to be allocated for attribute array */
 #define RADIUS_DEFAULT_ATTR_COUNT 16
 
+/* Maximum length of a RADIUS message (RFC 2865) */
+#define RADIUS_MAX_MSG_LEN 4096
+
+/* Estimated length of attributes other than EAP-Message in EAP messages */
+#define RADIUS_EAP_ATTR_ESTIMATE 512
+
+/* Number of EAP-Message fragments radius_msg_get_eap() handles on stack */
+#define RADIUS_EAP_VEC_LEN 16
+
 
 /* MAC address ASCII format for IEEE 802.1X use
  * (draft-congdon-radius-8021x-20.txt) */
@@ -225,6 +234,8 @@ struct radius_msg;
 struct radius_hdr * radius_msg_get_hdr(struct radius_msg *msg);
 struct wpabuf * radius_msg_get_buf(struct radius_msg *msg);
 struct radius_msg * radius_msg_new(u8 code, u8 identifier);
+struct radius_msg * radius_msg_new_len(u8 code, u8 identifier,
+				       size_t attr_len);
 void radius_msg_free(struct radius_msg *msg);
 void radius_msg_dump(struct radius_msg *msg);
 int radius_msg_finish(struct radius_msg *msg, const u8 *secret,
@@ -247,9 +258,13 @@ int radius_msg_verify_das_req(struct radius_msg *msg, const u8 *secret,
 struct radius_attr_hdr * radius_msg_add_attr(struct radius_msg *msg, u8 type,
 					     const u8 *data, size_t data_len);
 struct radius_msg * radius_msg_parse(const u8 *data, size_t len);
+struct radius_msg * radius_msg_parse_inplace(u8 *data, size_t len);
+int radius_msg_own_buf(struct radius_msg *msg);
 int radius_msg_add_eap(struct radius_msg *msg, const u8 *data,
 		       size_t data_len);
 struct wpabuf * radius_msg_get_eap(struct radius_msg *msg);
+int radius_msg_get_eap_vec(struct radius_msg *msg, const u8 *addr[],
+			   size_t len[], size_t num);
 int radius_msg_verify(struct radius_msg *msg, const u8 *secret,
 		      size_t secret_len, struct radius_msg *sent_msg,
 		      int auth);
@@ -305,6 +320,14 @@ static inline int radius_msg_get_attr_int32(struct radius_msg *msg, u8 type,
 	*value = ntohl(val);
 	return 0;
 }
+
+/* Length of EAP-Message attributes needed for eap_len octets of EAP data */
+static inline size_t radius_msg_eap_len(size_t eap_len)
+{
+	return eap_len + (eap_len + RADIUS_MAX_ATTR_LEN - 1) /
+		RADIUS_MAX_ATTR_LEN * sizeof(struct radius_attr_hdr);
+}
+
 int radius_msg_get_attr_ptr(struct radius_msg *msg, u8 type, u8 **buf,
 			    size_t *len, const u8 *start);
 int radius_msg_count_attr(struct radius_msg *msg, u8 type, int min_len);
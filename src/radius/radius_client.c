@@ -9,6 +9,7 @@
 #include "includes.h"
 
 #include "common.h"
+#include "mem_pool.h"
 #include "radius.h"
 #include "radius_client.h"
 #include "eloop.h"
@@ -142,6 +143,9 @@ struct radius_msg_list {
 	struct radius_msg_list *next;
 };
 
+static struct mem_pool radius_msg_list_pool =
+	MEM_POOL_INIT("radius_msg_list", sizeof(struct radius_msg_list), 32);
+
 
 /**
  * struct radius_client_data - Internal RADIUS client data
@@ -253,7 +257,7 @@ static void radius_client_acct_failover(struct radius_client_data *radius);
 static void radius_client_msg_free(struct radius_msg_list *req)
 {
 	radius_msg_free(req->msg);
-	os_free(req);
+	mem_pool_free(&radius_msg_list_pool, req);
 }
 
 
@@ -657,7 +661,7 @@ static void radius_client_list_add(struct radius_client_data *radius,
 		return;
 	}
 
-	entry = os_zalloc(sizeof(*entry));
+	entry = mem_pool_alloc(&radius_msg_list_pool);
 	if (entry == NULL) {
 		wpa_printf(MSG_INFO, "RADIUS: Failed to add packet into retransmit list");
 		radius_msg_free(msg);
@@ -826,7 +830,7 @@ static void radius_client_receive(int sock, void *eloop_ctx, void *sock_ctx)
 		return;
 	}
 
-	msg = radius_msg_parse(buf, len);
+	msg = radius_msg_parse_inplace(buf, len);
 	if (msg == NULL) {
 		wpa_printf(MSG_INFO, "RADIUS: Parsing incoming frame failed");
 		rconf->malformed_responses++;
@@ -1676,3 +1680,48 @@ void radius_client_reconfig(struct radius_client_data *radius,
 	if (radius)
 		radius->conf = conf;
 }
+
+
+/**
+ * radius_client_reconfig_servers - Update RADIUS server configuration
+ * @radius: RADIUS client context from radius_client_init()
+ * @conf: New RADIUS client configuration (RADIUS servers)
+ * Returns: 0 on success, -1 on failure
+ *
+ * This function can be used to take a changed RADIUS server configuration into
+ * use without having to deinitialize the RADIUS client. All pending messages
+ * are flushed and the sockets are opened again for the new servers.
+ */
+int radius_client_reconfig_servers(struct radius_client_data *radius,
+				   struct hostapd_radius_servers *conf)
+{
+	int ret = 0;
+
+	if (!radius)
+		return -1;
+
+	eloop_cancel_timeout(radius_retry_primary_timer, radius, NULL);
+	radius_client_flush(radius, 0);
+	radius->conf = conf;
+
+	if (conf->auth_server) {
+		if (radius_client_init_auth(radius))
+			ret = -1;
+	} else {
+		radius_close_auth_sockets(radius);
+	}
+
+	if (conf->acct_server) {
+		if (radius_client_init_acct(radius))
+			ret = -1;
+	} else {
+		radius_close_acct_sockets(radius);
+	}
+
+	if (conf->retry_primary_interval)
+		eloop_register_timeout(conf->retry_primary_interval, 0,
+				       radius_retry_primary_timer, radius,
+				       NULL);
+
+	return ret;
+}
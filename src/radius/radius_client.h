@@ -217,7 +217,8 @@ typedef enum {
 	 *
 	 * This stops handler calls, but does not free the message; the handler
 	 * that returned this is responsible for eventually freeing the
-	 * message.
+	 * message. The message is parsed in the receive buffer, so the
+	 * handler must call radius_msg_own_buf() before returning this.
 	 */
 	RADIUS_RX_QUEUED,
 
@@ -258,5 +259,7 @@ int radius_client_get_mib(struct radius_client_data *radius, char *buf,
 			  size_t buflen);
 void radius_client_reconfig(struct radius_client_data *radius,
 			    struct hostapd_radius_servers *conf);
+int radius_client_reconfig_servers(struct radius_client_data *radius,
+				   struct hostapd_radius_servers *conf);
 
 #endif /* RADIUS_CLIENT_H */
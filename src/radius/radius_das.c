@@ -224,7 +224,7 @@ static void radius_das_receive(int sock, void *eloop_ctx, void *sock_ctx)
 		return;
 	}
 
-	msg = radius_msg_parse(buf, len);
+	msg = radius_msg_parse_inplace(buf, len);
 	if (msg == NULL) {
 		wpa_printf(MSG_DEBUG, "DAS: Parsing incoming RADIUS packet "
 			   "from %s:%d failed", abuf, from_port);
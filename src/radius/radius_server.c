@@ -6,6 +6,10 @@
  * See README for more details.
  */
 
+#ifdef __linux__
+/* recvmmsg() and sendmmsg() */
+#define _GNU_SOURCE
+#endif /* __linux__ */
 #include "includes.h"
 #include <net/if.h>
 #ifdef CONFIG_SQLITE
@@ -35,13 +39,32 @@
  */
 #define RADIUS_MAX_SESSION 1000
 
+#ifdef CONFIG_SQLITE
+/**
+ * RADIUS_SERVER_DB_INTERVAL - Default SQLite commit interval in milliseconds
+ */
+#define RADIUS_SERVER_DB_INTERVAL 100
+#endif /* CONFIG_SQLITE */
+
+#if defined(__linux__) && defined(MSG_WAITFORONE)
+#define RADIUS_SERVER_MMSG
+#endif /* __linux__ && MSG_WAITFORONE */
+
 /**
- * RADIUS_MAX_MSG_LEN - Maximum message length for incoming RADIUS messages
+ * RADIUS_SERVER_MAX_BATCH - Maximum number of datagrams in a batch
  */
-#define RADIUS_MAX_MSG_LEN 3000
+#define RADIUS_SERVER_MAX_BATCH 256
 
 static const struct eapol_callbacks radius_server_eapol_cb;
 
+union radius_server_addr {
+	struct sockaddr_storage ss;
+	struct sockaddr_in sin;
+#ifdef CONFIG_IPV6
+	struct sockaddr_in6 sin6;
+#endif /* CONFIG_IPV6 */
+};
+
 struct radius_client;
 struct radius_server_data;
 
@@ -113,12 +136,33 @@ struct radius_client {
 	struct radius_server_counters counters;
 };
 
+/**
+ * struct radius_server_batch - Datagram buffers for recvmmsg()/sendmmsg()
+ *
+ * The buffers are allocated once when the server is initialized. For
+ * reception, all entries are filled by a single recvmmsg() call. For
+ * transmission, replies are copied into the entries while a received batch
+ * is being processed and are then sent with a single sendmmsg() call.
+ */
+struct radius_server_batch {
+	unsigned int size;
+	unsigned int count;
+#ifdef RADIUS_SERVER_MMSG
+	struct mmsghdr *hdr;
+	struct iovec *iov;
+#endif /* RADIUS_SERVER_MMSG */
+	union radius_server_addr *addr;
+	u8 *buf;
+};
+
 /**
  * struct radius_server_data - Internal RADIUS server data
  */
 struct radius_server_data {
 	/**
 	 * auth_sock - Socket for RADIUS authentication messages
+	 *
+	 * This is -1 if the authentication server is disabled.
 	 */
 	int auth_sock;
 
@@ -127,6 +171,24 @@ struct radius_server_data {
 	 */
 	int acct_sock;
 
+	/**
+	 * rx - Receive ring for batched reception or %NULL if not used
+	 */
+	struct radius_server_batch *rx;
+
+	/**
+	 * tx - Reply queue for batched transmission or %NULL if not used
+	 */
+	struct radius_server_batch *tx;
+
+	/**
+	 * batch_sock - Socket of the received batch being processed or -1
+	 *
+	 * Replies to this socket are queued in tx until the batch has been
+	 * processed.
+	 */
+	int batch_sock;
+
 	/**
 	 * clients - List of authorized RADIUS clients
 	 */
@@ -346,10 +408,58 @@ struct radius_server_data {
 
 #ifdef CONFIG_SQLITE
 	sqlite3 *db;
+	sqlite3_stmt *db_authlog;
+	sqlite3_stmt *db_acctlog;
+
+	/*
+	 * db_queue - Log entries waiting to be written into the database
+	 *
+	 * This is a ring buffer of db_queue_size entries. Entries are written
+	 * in a single transaction from an eloop timeout and new entries are
+	 * dropped (and counted in db_dropped) if the queue is full.
+	 */
+	struct radius_server_db_entry *db_queue;
+	size_t db_queue_size;
+	size_t db_queue_start;
+	size_t db_queue_len;
+	unsigned int db_commit_interval;
+	u32 db_written;
+	u32 db_dropped;
+	u32 db_failed;
 #endif /* CONFIG_SQLITE */
 };
 
 
+#ifdef CONFIG_SQLITE
+enum radius_server_db_type {
+	RADIUS_SERVER_DB_AUTHLOG,
+	RADIUS_SERVER_DB_ACCTLOG,
+};
+
+/*
+ * struct radius_server_db_entry - Log entry queued for the SQLite database
+ */
+struct radius_server_db_entry {
+	enum radius_server_db_type type;
+	char timestamp[30];
+	char *nas_ip;
+	char *username;
+
+	/* authlog */
+	unsigned int session;
+	char *note;
+
+	/* acctlog */
+	int status_type;
+	char *acct_session_id;
+	char *calling_station_id;
+	u32 session_time;
+	u32 input_octets;
+	u32 output_octets;
+};
+#endif /* CONFIG_SQLITE */
+
+
 #define RADIUS_DEBUG(args...) \
 wpa_printf(MSG_DEBUG, "RADIUS SRV: " args)
 #define RADIUS_ERROR(args...) \
@@ -364,6 +474,255 @@ static void radius_server_session_timeout(void *eloop_ctx, void *timeout_ctx);
 static void radius_server_session_remove_timeout(void *eloop_ctx,
 						 void *timeout_ctx);
 
+#ifdef CONFIG_SQLITE
+
+static void radius_server_db_entry_clear(struct radius_server_db_entry *e)
+{
+	os_free(e->nas_ip);
+	os_free(e->username);
+	os_free(e->note);
+	os_free(e->acct_session_id);
+	os_free(e->calling_station_id);
+	os_memset(e, 0, sizeof(*e));
+}
+
+
+static void radius_server_db_entry_init(struct radius_server_db_entry *e,
+					enum radius_server_db_type type)
+{
+	struct os_time now;
+	struct os_tm tm;
+
+	os_memset(e, 0, sizeof(*e));
+	e->type = type;
+
+	/* Same format as strftime('%Y-%m-%d %H:%M:%f','now') in SQLite */
+	os_get_time(&now);
+	if (os_gmtime(now.sec, &tm) == 0)
+		os_snprintf(e->timestamp, sizeof(e->timestamp),
+			    "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+			    tm.year, tm.month, tm.day, tm.hour, tm.min,
+			    tm.sec, (int) (now.usec / 1000));
+}
+
+
+static int radius_server_db_write(struct radius_server_data *data,
+				  struct radius_server_db_entry *e)
+{
+	sqlite3_stmt *stmt;
+	int ret = 0;
+
+	switch (e->type) {
+	case RADIUS_SERVER_DB_AUTHLOG:
+		stmt = data->db_authlog;
+		if (!stmt)
+			return -1;
+		sqlite3_bind_text(stmt, 1, e->timestamp, -1, SQLITE_STATIC);
+		sqlite3_bind_int64(stmt, 2, e->session);
+		sqlite3_bind_text(stmt, 3, e->nas_ip, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 4, e->username, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 5, e->note, -1, SQLITE_STATIC);
+		break;
+	case RADIUS_SERVER_DB_ACCTLOG:
+		stmt = data->db_acctlog;
+		if (!stmt)
+			return -1;
+		sqlite3_bind_text(stmt, 1, e->timestamp, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 2, e->nas_ip, -1, SQLITE_STATIC);
+		sqlite3_bind_int(stmt, 3, e->status_type);
+		sqlite3_bind_text(stmt, 4, e->acct_session_id, -1,
+				  SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 5, e->username, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 6, e->calling_station_id, -1,
+				  SQLITE_STATIC);
+		sqlite3_bind_int64(stmt, 7, e->session_time);
+		sqlite3_bind_int64(stmt, 8, e->input_octets);
+		sqlite3_bind_int64(stmt, 9, e->output_octets);
+		break;
+	default:
+		return -1;
+	}
+
+	if (sqlite3_step(stmt) != SQLITE_DONE) {
+		RADIUS_ERROR("Failed to add %s entry into sqlite database: %s",
+			     e->type == RADIUS_SERVER_DB_AUTHLOG ?
+			     "authlog" : "acctlog",
+			     sqlite3_errmsg(data->db));
+		ret = -1;
+	}
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
+	return ret;
+}
+
+
+static void radius_server_db_flush(struct radius_server_data *data)
+{
+	struct radius_server_db_entry *e;
+	int trans;
+
+	if (!data->db_queue_len)
+		return;
+
+	RADIUS_DEBUG("Writing %u queued log entries into sqlite database",
+		     (unsigned int) data->db_queue_len);
+
+	trans = sqlite3_exec(data->db, "BEGIN;", NULL, NULL, NULL) ==
+		SQLITE_OK;
+	if (!trans)
+		RADIUS_ERROR("Failed to start sqlite transaction: %s",
+			     sqlite3_errmsg(data->db));
+
+	while (data->db_queue_len) {
+		e = &data->db_queue[data->db_queue_start];
+		if (radius_server_db_write(data, e) < 0)
+			data->db_failed++;
+		else
+			data->db_written++;
+		radius_server_db_entry_clear(e);
+		data->db_queue_start = (data->db_queue_start + 1) %
+			data->db_queue_size;
+		data->db_queue_len--;
+	}
+	data->db_queue_start = 0;
+
+	if (trans &&
+	    sqlite3_exec(data->db, "COMMIT;", NULL, NULL, NULL) != SQLITE_OK)
+		RADIUS_ERROR("Failed to commit sqlite transaction: %s",
+			     sqlite3_errmsg(data->db));
+}
+
+
+static void radius_server_db_flush_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct radius_server_data *data = eloop_ctx;
+
+	radius_server_db_flush(data);
+}
+
+
+/*
+ * Write a log entry into the database or queue it for the next batched
+ * transaction. The entry is cleared and the queue takes over the ownership of
+ * the allocated strings in either case.
+ */
+static void radius_server_db_add(struct radius_server_data *data,
+				 struct radius_server_db_entry *e)
+{
+	size_t idx;
+
+	if (!data->db_queue_size) {
+		if (radius_server_db_write(data, e) < 0)
+			data->db_failed++;
+		else
+			data->db_written++;
+		radius_server_db_entry_clear(e);
+		return;
+	}
+
+	if (data->db_queue_len == data->db_queue_size) {
+		data->db_dropped++;
+		radius_server_db_entry_clear(e);
+		return;
+	}
+
+	idx = (data->db_queue_start + data->db_queue_len) % data->db_queue_size;
+	data->db_queue[idx] = *e;
+	os_memset(e, 0, sizeof(*e));
+	data->db_queue_len++;
+
+	if (data->db_queue_len >= data->db_queue_size / 2) {
+		/* Write the queue as soon as the current socket event has been
+		 * processed to avoid dropping entries */
+		eloop_cancel_timeout(radius_server_db_flush_timeout, data,
+				     NULL);
+		eloop_register_timeout(0, 0, radius_server_db_flush_timeout,
+				       data, NULL);
+	} else if (!eloop_is_timeout_registered(radius_server_db_flush_timeout,
+						data, NULL)) {
+		eloop_register_timeout(
+			data->db_commit_interval / 1000,
+			(data->db_commit_interval % 1000) * 1000,
+			radius_server_db_flush_timeout, data, NULL);
+	}
+}
+
+
+static void radius_server_db_deinit(struct radius_server_data *data)
+{
+	if (data->db_queue) {
+		eloop_cancel_timeout(radius_server_db_flush_timeout, data,
+				     NULL);
+		radius_server_db_flush(data);
+		os_free(data->db_queue);
+		data->db_queue = NULL;
+	}
+	sqlite3_finalize(data->db_authlog);
+	data->db_authlog = NULL;
+	sqlite3_finalize(data->db_acctlog);
+	data->db_acctlog = NULL;
+	sqlite3_close(data->db);
+	data->db = NULL;
+}
+
+
+static int radius_server_db_init(struct radius_server_data *data,
+				 struct radius_server_conf *conf)
+{
+	if (sqlite3_open(conf->sqlite_file, &data->db)) {
+		RADIUS_ERROR("Could not open SQLite file '%s'",
+			     conf->sqlite_file);
+		return -1;
+	}
+
+	/*
+	 * With write-ahead logging, committing a batch of log entries does not
+	 * need to sync the database file and the user database can still be
+	 * read by other connections while entries are written.
+	 */
+	if (conf->sqlite_wal &&
+	    (sqlite3_exec(data->db, "PRAGMA journal_mode=WAL;", NULL, NULL,
+			  NULL) != SQLITE_OK ||
+	     sqlite3_exec(data->db, "PRAGMA synchronous=NORMAL;", NULL, NULL,
+			  NULL) != SQLITE_OK))
+		RADIUS_DEBUG("Could not enable WAL mode for SQLite file '%s': %s",
+			     conf->sqlite_file, sqlite3_errmsg(data->db));
+
+	/* The log tables are optional; skip logging if they do not exist */
+	if (sqlite3_prepare_v2(data->db,
+			       "INSERT INTO authlog"
+			       "(timestamp,session,nas_ip,username,note)"
+			       " VALUES (?,?,?,?,?);", -1,
+			       &data->db_authlog, NULL) != SQLITE_OK)
+		RADIUS_DEBUG("No authlog table in SQLite file: %s",
+			     sqlite3_errmsg(data->db));
+	if (sqlite3_prepare_v2(data->db,
+			       "INSERT INTO acctlog"
+			       "(timestamp,nas_ip,status_type,session_id,"
+			       "username,calling_station_id,session_time,"
+			       "input_octets,output_octets)"
+			       " VALUES (?,?,?,?,?,?,?,?,?);", -1,
+			       &data->db_acctlog, NULL) != SQLITE_OK)
+		RADIUS_DEBUG("No acctlog table in SQLite file: %s",
+			     sqlite3_errmsg(data->db));
+
+	data->db_queue_size = conf->sqlite_queue > 0 ? conf->sqlite_queue : 0;
+	data->db_commit_interval = conf->sqlite_commit_interval > 0 ?
+		conf->sqlite_commit_interval : RADIUS_SERVER_DB_INTERVAL;
+	if (data->db_queue_size) {
+		data->db_queue = os_calloc(data->db_queue_size,
+					   sizeof(struct radius_server_db_entry));
+		if (!data->db_queue)
+			return -1;
+	}
+
+	return 0;
+}
+
+#endif /* CONFIG_SQLITE */
+
+
 void srv_log(struct radius_session *sess, const char *fmt, ...)
 PRINTF_FORMAT(2, 3);
 
@@ -387,23 +746,16 @@ void srv_log(struct radius_session *sess, const char *fmt, ...)
 	RADIUS_DEBUG("[0x%x %s] %s", sess->sess_id, sess->nas_ip, buf);
 
 #ifdef CONFIG_SQLITE
-	if (sess->server->db) {
-		char *sql;
-		sql = sqlite3_mprintf("INSERT INTO authlog"
-				      "(timestamp,session,nas_ip,username,note)"
-				      " VALUES ("
-				      "strftime('%%Y-%%m-%%d %%H:%%M:%%f',"
-				      "'now'),%u,%Q,%Q,%Q)",
-				      sess->sess_id, sess->nas_ip,
-				      sess->username, buf);
-		if (sql) {
-			if (sqlite3_exec(sess->server->db, sql, NULL, NULL,
-					 NULL) != SQLITE_OK) {
-				RADIUS_ERROR("Failed to add authlog entry into sqlite database: %s",
-					     sqlite3_errmsg(sess->server->db));
-			}
-			sqlite3_free(sql);
-		}
+	if (sess->server->db_authlog) {
+		struct radius_server_db_entry e;
+
+		radius_server_db_entry_init(&e, RADIUS_SERVER_DB_AUTHLOG);
+		e.session = sess->sess_id;
+		e.nas_ip = sess->nas_ip ? os_strdup(sess->nas_ip) : NULL;
+		e.username = sess->username ? os_strdup(sess->username) : NULL;
+		e.note = buf;
+		buf = NULL;
+		radius_server_db_add(sess->server, &e);
 	}
 #endif /* CONFIG_SQLITE */
 
@@ -725,6 +1077,7 @@ radius_server_encapsulate_eap(struct radius_server_data *data,
 	int code;
 	unsigned int sess_id;
 	struct radius_hdr *hdr = radius_msg_get_hdr(request);
+	size_t eap_len = 0;
 
 	if (sess->eap_if->eapFail) {
 		sess->eap_if->eapFail = FALSE;
@@ -737,7 +1090,11 @@ radius_server_encapsulate_eap(struct radius_server_data *data,
 		code = RADIUS_CODE_ACCESS_CHALLENGE;
 	}
 
-	msg = radius_msg_new(code, hdr->identifier);
+	if (sess->eap_if->eapReqData)
+		eap_len = wpabuf_len(sess->eap_if->eapReqData);
+	msg = radius_msg_new_len(code, hdr->identifier,
+				 RADIUS_EAP_ATTR_ESTIMATE +
+				 radius_msg_eap_len(eap_len));
 	if (msg == NULL) {
 		RADIUS_DEBUG("Failed to allocate reply message");
 		return NULL;
@@ -929,6 +1286,116 @@ radius_server_macacl(struct radius_server_data *data,
 }
 
 
+#ifdef RADIUS_SERVER_MMSG
+
+static struct radius_server_batch * radius_server_batch_alloc(unsigned int size)
+{
+	struct radius_server_batch *batch;
+	unsigned int i;
+
+	batch = os_zalloc(sizeof(*batch));
+	if (batch == NULL)
+		return NULL;
+	batch->size = size;
+	batch->hdr = os_calloc(size, sizeof(*batch->hdr));
+	batch->iov = os_calloc(size, sizeof(*batch->iov));
+	batch->addr = os_calloc(size, sizeof(*batch->addr));
+	batch->buf = os_calloc(size, RADIUS_MAX_MSG_LEN);
+	if (batch->hdr == NULL || batch->iov == NULL || batch->addr == NULL ||
+	    batch->buf == NULL) {
+		os_free(batch->hdr);
+		os_free(batch->iov);
+		os_free(batch->addr);
+		os_free(batch->buf);
+		os_free(batch);
+		return NULL;
+	}
+
+	for (i = 0; i < size; i++) {
+		batch->iov[i].iov_base = batch->buf + i * RADIUS_MAX_MSG_LEN;
+		batch->iov[i].iov_len = RADIUS_MAX_MSG_LEN;
+		batch->hdr[i].msg_hdr.msg_name = &batch->addr[i];
+		batch->hdr[i].msg_hdr.msg_namelen = sizeof(batch->addr[i]);
+		batch->hdr[i].msg_hdr.msg_iov = &batch->iov[i];
+		batch->hdr[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	return batch;
+}
+
+
+static void radius_server_batch_free(struct radius_server_batch *batch)
+{
+	if (batch == NULL)
+		return;
+	os_free(batch->hdr);
+	os_free(batch->iov);
+	os_free(batch->addr);
+	os_free(batch->buf);
+	os_free(batch);
+}
+
+
+static void radius_server_flush(struct radius_server_data *data)
+{
+	struct radius_server_batch *tx = data->tx;
+	unsigned int sent = 0;
+	int res;
+
+	while (sent < tx->count) {
+		res = sendmmsg(data->batch_sock, &tx->hdr[sent],
+			       tx->count - sent, 0);
+		if (res < 0) {
+			wpa_printf(MSG_INFO, "sendmmsg[RADIUS SRV]: %s",
+				   strerror(errno));
+			/* Drop the reply that could not be sent */
+			res = 1;
+		}
+		sent += res;
+	}
+	tx->count = 0;
+}
+
+#endif /* RADIUS_SERVER_MMSG */
+
+
+/*
+ * Send a reply to a RADIUS client. While a batch of received messages is
+ * being processed, the reply is queued and sent with the rest of the replies
+ * for the batch.
+ */
+static int radius_server_send(struct radius_server_data *data, int sock,
+			      const struct wpabuf *buf,
+			      const struct sockaddr *to, socklen_t tolen)
+{
+	int res;
+#ifdef RADIUS_SERVER_MMSG
+	struct radius_server_batch *tx = data->tx;
+
+	if (tx && data->batch_sock == sock &&
+	    wpabuf_len(buf) <= RADIUS_MAX_MSG_LEN &&
+	    tolen <= sizeof(tx->addr[0])) {
+		unsigned int i;
+
+		if (tx->count == tx->size)
+			radius_server_flush(data);
+		i = tx->count++;
+		os_memcpy(tx->iov[i].iov_base, wpabuf_head(buf),
+			  wpabuf_len(buf));
+		tx->iov[i].iov_len = wpabuf_len(buf);
+		os_memcpy(&tx->addr[i], to, tolen);
+		tx->hdr[i].msg_hdr.msg_namelen = tolen;
+		return wpabuf_len(buf);
+	}
+#endif /* RADIUS_SERVER_MMSG */
+
+	res = sendto(sock, wpabuf_head(buf), wpabuf_len(buf), 0, to, tolen);
+	if (res < 0)
+		wpa_printf(MSG_INFO, "sendto[RADIUS SRV]: %s", strerror(errno));
+	return res;
+}
+
+
 static int radius_server_reject(struct radius_server_data *data,
 				struct radius_client *client,
 				struct radius_msg *request,
@@ -978,11 +1445,8 @@ static int radius_server_reject(struct radius_server_data *data,
 	data->counters.access_rejects++;
 	client->counters.access_rejects++;
 	buf = radius_msg_get_buf(msg);
-	if (sendto(data->auth_sock, wpabuf_head(buf), wpabuf_len(buf), 0,
-		   (struct sockaddr *) from, sizeof(*from)) < 0) {
-		wpa_printf(MSG_INFO, "sendto[RADIUS SRV]: %s", strerror(errno));
+	if (radius_server_send(data, data->auth_sock, buf, from, fromlen) < 0)
 		ret = -1;
-	}
 
 	radius_msg_free(msg);
 
@@ -1048,13 +1512,8 @@ static int radius_server_request(struct radius_server_data *data,
 		if (sess->last_reply) {
 			struct wpabuf *buf;
 			buf = radius_msg_get_buf(sess->last_reply);
-			res = sendto(data->auth_sock, wpabuf_head(buf),
-				     wpabuf_len(buf), 0,
-				     (struct sockaddr *) from, fromlen);
-			if (res < 0) {
-				wpa_printf(MSG_INFO, "sendto[RADIUS SRV]: %s",
-					   strerror(errno));
-			}
+			radius_server_send(data, data->auth_sock, buf, from,
+					   fromlen);
 			return 0;
 		}
 
@@ -1101,6 +1560,9 @@ static int radius_server_request(struct radius_server_data *data,
 		RADIUS_DEBUG("No EAP data from the state machine, but eapFail "
 			     "set");
 	} else if (eap_sm_method_pending(sess->eap)) {
+		/* Keep a copy that does not refer to the receive buffer */
+		if (radius_msg_own_buf(msg) < 0)
+			return -1;
 		radius_msg_free(sess->last_msg);
 		sess->last_msg = msg;
 		sess->last_from_port = from_port;
@@ -1154,13 +1616,7 @@ send_reply:
 			break;
 		}
 		buf = radius_msg_get_buf(reply);
-		res = sendto(data->auth_sock, wpabuf_head(buf),
-			     wpabuf_len(buf), 0,
-			     (struct sockaddr *) from, fromlen);
-		if (res < 0) {
-			wpa_printf(MSG_INFO, "sendto[RADIUS SRV]: %s",
-				   strerror(errno));
-		}
+		radius_server_send(data, data->auth_sock, buf, from, fromlen);
 		radius_msg_free(sess->last_reply);
 		sess->last_reply = reply;
 		sess->last_from_port = from_port;
@@ -1186,61 +1642,38 @@ send_reply:
 }
 
 
-static void radius_server_receive_auth(int sock, void *eloop_ctx,
-				       void *sock_ctx)
+static void radius_server_handle_auth(struct radius_server_data *data,
+				      int sock, u8 *buf, int len,
+				      union radius_server_addr *from,
+				      socklen_t fromlen)
 {
-	struct radius_server_data *data = eloop_ctx;
-	u8 *buf = NULL;
-	union {
-		struct sockaddr_storage ss;
-		struct sockaddr_in sin;
-#ifdef CONFIG_IPV6
-		struct sockaddr_in6 sin6;
-#endif /* CONFIG_IPV6 */
-	} from;
-	socklen_t fromlen;
-	int len;
 	struct radius_client *client = NULL;
 	struct radius_msg *msg = NULL;
 	char abuf[50];
 	int from_port = 0;
 
-	buf = os_malloc(RADIUS_MAX_MSG_LEN);
-	if (buf == NULL) {
-		goto fail;
-	}
-
-	fromlen = sizeof(from);
-	len = recvfrom(sock, buf, RADIUS_MAX_MSG_LEN, 0,
-		       (struct sockaddr *) &from.ss, &fromlen);
-	if (len < 0) {
-		wpa_printf(MSG_INFO, "recvfrom[radius_server]: %s",
-			   strerror(errno));
-		goto fail;
-	}
-
 #ifdef CONFIG_IPV6
 	if (data->ipv6) {
-		if (inet_ntop(AF_INET6, &from.sin6.sin6_addr, abuf,
+		if (inet_ntop(AF_INET6, &from->sin6.sin6_addr, abuf,
 			      sizeof(abuf)) == NULL)
 			abuf[0] = '\0';
-		from_port = ntohs(from.sin6.sin6_port);
+		from_port = ntohs(from->sin6.sin6_port);
 		RADIUS_DEBUG("Received %d bytes from %s:%d",
 			     len, abuf, from_port);
 
 		client = radius_server_get_client(data,
 						  (struct in_addr *)
-						  &from.sin6.sin6_addr, 1);
+						  &from->sin6.sin6_addr, 1);
 	}
 #endif /* CONFIG_IPV6 */
 
 	if (!data->ipv6) {
-		os_strlcpy(abuf, inet_ntoa(from.sin.sin_addr), sizeof(abuf));
-		from_port = ntohs(from.sin.sin_port);
+		os_strlcpy(abuf, inet_ntoa(from->sin.sin_addr), sizeof(abuf));
+		from_port = ntohs(from->sin.sin_port);
 		RADIUS_DEBUG("Received %d bytes from %s:%d",
 			     len, abuf, from_port);
 
-		client = radius_server_get_client(data, &from.sin.sin_addr, 0);
+		client = radius_server_get_client(data, &from->sin.sin_addr, 0);
 	}
 
 	RADIUS_DUMP("Received data", buf, len);
@@ -1251,7 +1684,7 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	msg = radius_msg_parse(buf, len);
+	msg = radius_msg_parse_inplace(buf, len);
 	if (msg == NULL) {
 		RADIUS_DEBUG("Parsing incoming RADIUS frame failed");
 		data->counters.malformed_access_requests++;
@@ -1259,9 +1692,6 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	os_free(buf);
-	buf = NULL;
-
 	if (wpa_debug_level <= MSG_MSGDUMP) {
 		radius_msg_dump(msg);
 	}
@@ -1285,31 +1715,60 @@ static void radius_server_receive_auth(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	if (radius_server_request(data, msg, (struct sockaddr *) &from,
+	if (radius_server_request(data, msg, (struct sockaddr *) from,
 				  fromlen, client, abuf, from_port, NULL) ==
 	    -2)
 		return; /* msg was stored with the session */
 
 fail:
 	radius_msg_free(msg);
-	os_free(buf);
 }
 
 
-static void radius_server_receive_acct(int sock, void *eloop_ctx,
-				       void *sock_ctx)
+#ifdef CONFIG_SQLITE
+static char * radius_server_get_attr_str(struct radius_msg *msg, u8 type)
+{
+	u8 *buf;
+	size_t len;
+
+	if (radius_msg_get_attr_ptr(msg, type, &buf, &len, NULL) < 0)
+		return NULL;
+	return dup_binstr(buf, len);
+}
+
+
+static void radius_server_acct_log(struct radius_server_data *data,
+				   struct radius_msg *msg, const char *nas_ip)
+{
+	struct radius_server_db_entry e;
+	u32 val;
+
+	radius_server_db_entry_init(&e, RADIUS_SERVER_DB_ACCTLOG);
+	e.nas_ip = os_strdup(nas_ip);
+	if (radius_msg_get_attr_int32(msg, RADIUS_ATTR_ACCT_STATUS_TYPE,
+				      &val) == 0)
+		e.status_type = val;
+	e.acct_session_id = radius_server_get_attr_str(
+		msg, RADIUS_ATTR_ACCT_SESSION_ID);
+	e.username = radius_server_get_attr_str(msg, RADIUS_ATTR_USER_NAME);
+	e.calling_station_id = radius_server_get_attr_str(
+		msg, RADIUS_ATTR_CALLING_STATION_ID);
+	radius_msg_get_attr_int32(msg, RADIUS_ATTR_ACCT_SESSION_TIME,
+				  &e.session_time);
+	radius_msg_get_attr_int32(msg, RADIUS_ATTR_ACCT_INPUT_OCTETS,
+				  &e.input_octets);
+	radius_msg_get_attr_int32(msg, RADIUS_ATTR_ACCT_OUTPUT_OCTETS,
+				  &e.output_octets);
+	radius_server_db_add(data, &e);
+}
+#endif /* CONFIG_SQLITE */
+
+
+static void radius_server_handle_acct(struct radius_server_data *data,
+				      int sock, u8 *buf, int len,
+				      union radius_server_addr *from,
+				      socklen_t fromlen)
 {
-	struct radius_server_data *data = eloop_ctx;
-	u8 *buf = NULL;
-	union {
-		struct sockaddr_storage ss;
-		struct sockaddr_in sin;
-#ifdef CONFIG_IPV6
-		struct sockaddr_in6 sin6;
-#endif /* CONFIG_IPV6 */
-	} from;
-	socklen_t fromlen;
-	int len, res;
 	struct radius_client *client = NULL;
 	struct radius_msg *msg = NULL, *resp = NULL;
 	char abuf[50];
@@ -1317,42 +1776,28 @@ static void radius_server_receive_acct(int sock, void *eloop_ctx,
 	struct radius_hdr *hdr;
 	struct wpabuf *rbuf;
 
-	buf = os_malloc(RADIUS_MAX_MSG_LEN);
-	if (buf == NULL) {
-		goto fail;
-	}
-
-	fromlen = sizeof(from);
-	len = recvfrom(sock, buf, RADIUS_MAX_MSG_LEN, 0,
-		       (struct sockaddr *) &from.ss, &fromlen);
-	if (len < 0) {
-		wpa_printf(MSG_INFO, "recvfrom[radius_server]: %s",
-			   strerror(errno));
-		goto fail;
-	}
-
 #ifdef CONFIG_IPV6
 	if (data->ipv6) {
-		if (inet_ntop(AF_INET6, &from.sin6.sin6_addr, abuf,
+		if (inet_ntop(AF_INET6, &from->sin6.sin6_addr, abuf,
 			      sizeof(abuf)) == NULL)
 			abuf[0] = '\0';
-		from_port = ntohs(from.sin6.sin6_port);
+		from_port = ntohs(from->sin6.sin6_port);
 		RADIUS_DEBUG("Received %d bytes from %s:%d",
 			     len, abuf, from_port);
 
 		client = radius_server_get_client(data,
 						  (struct in_addr *)
-						  &from.sin6.sin6_addr, 1);
+						  &from->sin6.sin6_addr, 1);
 	}
 #endif /* CONFIG_IPV6 */
 
 	if (!data->ipv6) {
-		os_strlcpy(abuf, inet_ntoa(from.sin.sin_addr), sizeof(abuf));
-		from_port = ntohs(from.sin.sin_port);
+		os_strlcpy(abuf, inet_ntoa(from->sin.sin_addr), sizeof(abuf));
+		from_port = ntohs(from->sin.sin_port);
 		RADIUS_DEBUG("Received %d bytes from %s:%d",
 			     len, abuf, from_port);
 
-		client = radius_server_get_client(data, &from.sin.sin_addr, 0);
+		client = radius_server_get_client(data, &from->sin.sin_addr, 0);
 	}
 
 	RADIUS_DUMP("Received data", buf, len);
@@ -1363,7 +1808,7 @@ static void radius_server_receive_acct(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	msg = radius_msg_parse(buf, len);
+	msg = radius_msg_parse_inplace(buf, len);
 	if (msg == NULL) {
 		RADIUS_DEBUG("Parsing incoming RADIUS frame failed");
 		data->counters.malformed_acct_requests++;
@@ -1371,9 +1816,6 @@ static void radius_server_receive_acct(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	os_free(buf);
-	buf = NULL;
-
 	if (wpa_debug_level <= MSG_MSGDUMP) {
 		radius_msg_dump(msg);
 	}
@@ -1397,7 +1839,10 @@ static void radius_server_receive_acct(int sock, void *eloop_ctx,
 		goto fail;
 	}
 
-	/* TODO: Write accounting information to a file or database */
+#ifdef CONFIG_SQLITE
+	if (data->db_acctlog)
+		radius_server_acct_log(data, msg, abuf);
+#endif /* CONFIG_SQLITE */
 
 	hdr = radius_msg_get_hdr(msg);
 
@@ -1416,17 +1861,101 @@ static void radius_server_receive_acct(int sock, void *eloop_ctx,
 	rbuf = radius_msg_get_buf(resp);
 	data->counters.acct_responses++;
 	client->counters.acct_responses++;
-	res = sendto(data->acct_sock, wpabuf_head(rbuf), wpabuf_len(rbuf), 0,
-		     (struct sockaddr *) &from.ss, fromlen);
-	if (res < 0) {
-		wpa_printf(MSG_INFO, "sendto[RADIUS SRV]: %s",
-			   strerror(errno));
-	}
+	radius_server_send(data, sock, rbuf, (struct sockaddr *) &from->ss,
+			   fromlen);
 
 fail:
 	radius_msg_free(resp);
 	radius_msg_free(msg);
-	os_free(buf);
+}
+
+typedef void (*radius_server_handler)(struct radius_server_data *data,
+				      int sock, u8 *buf, int len,
+				      union radius_server_addr *from,
+				      socklen_t fromlen);
+
+static void radius_server_receive(struct radius_server_data *data, int sock,
+				  radius_server_handler handler)
+{
+	u8 buf[RADIUS_MAX_MSG_LEN];
+	union radius_server_addr from;
+	socklen_t fromlen;
+	int len;
+
+	fromlen = sizeof(from);
+	len = recvfrom(sock, buf, sizeof(buf), 0,
+		       (struct sockaddr *) &from.ss, &fromlen);
+	if (len < 0) {
+		wpa_printf(MSG_INFO, "recvfrom[radius_server]: %s",
+			   strerror(errno));
+		return;
+	}
+
+	handler(data, sock, buf, len, &from, fromlen);
+}
+
+
+#ifdef RADIUS_SERVER_MMSG
+static void radius_server_receive_batch(struct radius_server_data *data,
+					int sock,
+					radius_server_handler handler)
+{
+	struct radius_server_batch *rx = data->rx;
+	unsigned int i;
+	int num;
+
+	for (i = 0; i < rx->size; i++)
+		rx->hdr[i].msg_hdr.msg_namelen = sizeof(rx->addr[i]);
+
+	/* Take all the pending datagrams (up to the ring size) at once */
+	num = recvmmsg(sock, rx->hdr, rx->size, MSG_DONTWAIT, NULL);
+	if (num < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+			wpa_printf(MSG_INFO, "recvmmsg[radius_server]: %s",
+				   strerror(errno));
+		return;
+	}
+	RADIUS_DEBUG("Received a batch of %d datagram(s)", num);
+
+	data->batch_sock = sock;
+	for (i = 0; i < (unsigned int) num; i++)
+		handler(data, sock, rx->iov[i].iov_base, rx->hdr[i].msg_len,
+			&rx->addr[i], rx->hdr[i].msg_hdr.msg_namelen);
+	radius_server_flush(data);
+	data->batch_sock = -1;
+}
+#endif /* RADIUS_SERVER_MMSG */
+
+
+static void radius_server_receive_auth(int sock, void *eloop_ctx,
+				       void *sock_ctx)
+{
+	struct radius_server_data *data = eloop_ctx;
+
+#ifdef RADIUS_SERVER_MMSG
+	if (data->rx) {
+		radius_server_receive_batch(data, sock,
+					    radius_server_handle_auth);
+		return;
+	}
+#endif /* RADIUS_SERVER_MMSG */
+	radius_server_receive(data, sock, radius_server_handle_auth);
+}
+
+
+static void radius_server_receive_acct(int sock, void *eloop_ctx,
+				       void *sock_ctx)
+{
+	struct radius_server_data *data = eloop_ctx;
+
+#ifdef RADIUS_SERVER_MMSG
+	if (data->rx) {
+		radius_server_receive_batch(data, sock,
+					    radius_server_handle_acct);
+		return;
+	}
+#endif /* RADIUS_SERVER_MMSG */
+	radius_server_receive(data, sock, radius_server_handle_acct);
 }
 
 
@@ -1446,7 +1975,25 @@ static int radius_server_disable_pmtu_discovery(int s)
 }
 
 
-static int radius_server_open_socket(int port)
+static int radius_server_set_reuseport(int s)
+{
+#ifdef SO_REUSEPORT
+	int on = 1;
+
+	if (setsockopt(s, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0) {
+		wpa_printf(MSG_ERROR, "RADIUS: setsockopt(SO_REUSEPORT): %s",
+			   strerror(errno));
+		return -1;
+	}
+	return 0;
+#else /* SO_REUSEPORT */
+	wpa_printf(MSG_ERROR, "RADIUS: SO_REUSEPORT not supported");
+	return -1;
+#endif /* SO_REUSEPORT */
+}
+
+
+static int radius_server_open_socket(int port, int reuseport)
 {
 	int s;
 	struct sockaddr_in addr;
@@ -1459,6 +2006,11 @@ static int radius_server_open_socket(int port)
 
 	radius_server_disable_pmtu_discovery(s);
 
+	if (reuseport && radius_server_set_reuseport(s) < 0) {
+		close(s);
+		return -1;
+	}
+
 	os_memset(&addr, 0, sizeof(addr));
 	addr.sin_family = AF_INET;
 	addr.sin_port = htons(port);
@@ -1473,7 +2025,7 @@ static int radius_server_open_socket(int port)
 
 
 #ifdef CONFIG_IPV6
-static int radius_server_open_socket6(int port)
+static int radius_server_open_socket6(int port, int reuseport)
 {
 	int s;
 	struct sockaddr_in6 addr;
@@ -1485,6 +2037,11 @@ static int radius_server_open_socket6(int port)
 		return -1;
 	}
 
+	if (reuseport && radius_server_set_reuseport(s) < 0) {
+		close(s);
+		return -1;
+	}
+
 	os_memset(&addr, 0, sizeof(addr));
 	addr.sin6_family = AF_INET6;
 	os_memcpy(&addr.sin6_addr, &in6addr_any, sizeof(in6addr_any));
@@ -1710,6 +2267,9 @@ radius_server_init(struct radius_server_conf *conf)
 	if (data == NULL)
 		return NULL;
 
+	data->auth_sock = -1;
+	data->acct_sock = -1;
+	data->batch_sock = -1;
 	dl_list_init(&data->erp_keys);
 	os_get_reltime(&data->start_time);
 	data->conf_ctx = conf->conf_ctx;
@@ -1762,13 +2322,9 @@ radius_server_init(struct radius_server_conf *conf)
 	data->subscr_remediation_method = conf->subscr_remediation_method;
 
 #ifdef CONFIG_SQLITE
-	if (conf->sqlite_file) {
-		if (sqlite3_open(conf->sqlite_file, &data->db)) {
-			RADIUS_ERROR("Could not open SQLite file '%s'",
-				     conf->sqlite_file);
-			radius_server_deinit(data);
-			return NULL;
-		}
+	if (conf->sqlite_file && radius_server_db_init(data, conf) < 0) {
+		radius_server_deinit(data);
+		return NULL;
 	}
 #endif /* CONFIG_SQLITE */
 
@@ -1785,32 +2341,56 @@ radius_server_init(struct radius_server_conf *conf)
 		return NULL;
 	}
 
+	if (conf->batch > 1) {
+#ifdef RADIUS_SERVER_MMSG
+		unsigned int size = conf->batch;
+
+		if (size > RADIUS_SERVER_MAX_BATCH)
+			size = RADIUS_SERVER_MAX_BATCH;
+		data->rx = radius_server_batch_alloc(size);
+		data->tx = radius_server_batch_alloc(size);
+		if (data->rx == NULL || data->tx == NULL) {
+			radius_server_deinit(data);
+			return NULL;
+		}
+		RADIUS_DEBUG("Using batches of up to %u datagrams", size);
+#else /* RADIUS_SERVER_MMSG */
+		wpa_printf(MSG_INFO,
+			   "RADIUS: Batched datagram I/O not supported - handle one datagram at a time");
+#endif /* RADIUS_SERVER_MMSG */
+	}
+
+	if (conf->auth_port) {
 #ifdef CONFIG_IPV6
-	if (conf->ipv6)
-		data->auth_sock = radius_server_open_socket6(conf->auth_port);
-	else
+		if (conf->ipv6)
+			data->auth_sock = radius_server_open_socket6(
+				conf->auth_port, 0);
+		else
 #endif /* CONFIG_IPV6 */
-	data->auth_sock = radius_server_open_socket(conf->auth_port);
-	if (data->auth_sock < 0) {
-		wpa_printf(MSG_ERROR, "Failed to open UDP socket for RADIUS authentication server");
-		radius_server_deinit(data);
-		return NULL;
-	}
-	if (eloop_register_read_sock(data->auth_sock,
-				     radius_server_receive_auth,
-				     data, NULL)) {
-		radius_server_deinit(data);
-		return NULL;
+		data->auth_sock = radius_server_open_socket(conf->auth_port,
+							    0);
+		if (data->auth_sock < 0) {
+			wpa_printf(MSG_ERROR, "Failed to open UDP socket for RADIUS authentication server");
+			radius_server_deinit(data);
+			return NULL;
+		}
+		if (eloop_register_read_sock(data->auth_sock,
+					     radius_server_receive_auth,
+					     data, NULL)) {
+			radius_server_deinit(data);
+			return NULL;
+		}
 	}
 
 	if (conf->acct_port) {
 #ifdef CONFIG_IPV6
 		if (conf->ipv6)
 			data->acct_sock = radius_server_open_socket6(
-				conf->acct_port);
+				conf->acct_port, conf->acct_reuseport);
 		else
 #endif /* CONFIG_IPV6 */
-		data->acct_sock = radius_server_open_socket(conf->acct_port);
+		data->acct_sock = radius_server_open_socket(
+			conf->acct_port, conf->acct_reuseport);
 		if (data->acct_sock < 0) {
 			wpa_printf(MSG_ERROR, "Failed to open UDP socket for RADIUS accounting server");
 			radius_server_deinit(data);
@@ -1822,8 +2402,13 @@ radius_server_init(struct radius_server_conf *conf)
 			radius_server_deinit(data);
 			return NULL;
 		}
-	} else {
-		data->acct_sock = -1;
+	}
+
+	if (data->auth_sock < 0 && data->acct_sock < 0) {
+		wpa_printf(MSG_ERROR,
+			   "No RADIUS authentication or accounting port configured");
+		radius_server_deinit(data);
+		return NULL;
 	}
 
 	return data;
@@ -1867,6 +2452,11 @@ void radius_server_deinit(struct radius_server_data *data)
 		close(data->acct_sock);
 	}
 
+#ifdef RADIUS_SERVER_MMSG
+	radius_server_batch_free(data->rx);
+	radius_server_batch_free(data->tx);
+#endif /* RADIUS_SERVER_MMSG */
+
 	radius_server_free_clients(data, data->clients);
 
 	os_free(data->pac_opaque_encr_key);
@@ -1880,7 +2470,7 @@ void radius_server_deinit(struct radius_server_data *data)
 
 #ifdef CONFIG_SQLITE
 	if (data->db)
-		sqlite3_close(data->db);
+		radius_server_db_deinit(data);
 #endif /* CONFIG_SQLITE */
 
 	radius_server_erp_flush(data);
@@ -1968,6 +2558,24 @@ int radius_server_get_mib(struct radius_server_data *data, char *buf,
 	}
 	pos += ret;
 
+#ifdef CONFIG_SQLITE
+	if (data->db) {
+		ret = os_snprintf(pos, end - pos,
+				  "sqliteLogWritten=%u\n"
+				  "sqliteLogFailed=%u\n"
+				  "sqliteLogDropped=%u\n"
+				  "sqliteLogQueued=%u\n",
+				  data->db_written, data->db_failed,
+				  data->db_dropped,
+				  (unsigned int) data->db_queue_len);
+		if (os_snprintf_error(end - pos, ret)) {
+			*pos = '\0';
+			return pos - buf;
+		}
+		pos += ret;
+	}
+#endif /* CONFIG_SQLITE */
+
 	for (cli = data->clients, idx = 0; cli; cli = cli->next, idx++) {
 		char abuf[50], mbuf[50];
 #ifdef CONFIG_IPV6
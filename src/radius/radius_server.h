@@ -18,6 +18,9 @@ struct eap_user;
 struct radius_server_conf {
 	/**
 	 * auth_port - UDP port to listen to as an authentication server
+	 *
+	 * 0 disables the authentication server, e.g., for a process that
+	 * only handles accounting.
 	 */
 	int auth_port;
 
@@ -26,6 +29,24 @@ struct radius_server_conf {
 	 */
 	int acct_port;
 
+	/**
+	 * acct_reuseport - Whether to share acct_port with other processes
+	 *
+	 * This sets SO_REUSEPORT on the accounting socket so that multiple
+	 * server processes can bind to the same port. The kernel distributes
+	 * the received datagrams between the sockets based on the source
+	 * address and port of the client.
+	 */
+	int acct_reuseport;
+
+	/**
+	 * batch - Maximum number of datagrams to receive or send at a time
+	 *
+	 * Values larger than one enable recvmmsg()/sendmmsg() based batching
+	 * where supported. 0 or 1 handles one datagram per socket event.
+	 */
+	int batch;
+
 	/**
 	 * client_file - RADIUS client configuration file
 	 *
@@ -41,9 +62,35 @@ struct radius_server_conf {
 
 	/**
 	 * sqlite_file - SQLite database for storing debug log information
+	 *
+	 * Authentication log entries are written into the authlog table and
+	 * accounting requests into the acctlog table, if these tables exist.
 	 */
 	const char *sqlite_file;
 
+	/**
+	 * sqlite_queue - Maximum number of queued SQLite log entries
+	 *
+	 * Log entries are written into the database in batched transactions
+	 * from this queue and entries are dropped if the queue is full. 0
+	 * writes each entry immediately.
+	 */
+	int sqlite_queue;
+
+	/**
+	 * sqlite_commit_interval - Maximum time to queue log entries in ms
+	 *
+	 * 0 uses the default value.
+	 */
+	int sqlite_commit_interval;
+
+	/**
+	 * sqlite_wal - Whether to switch the SQLite file to WAL journal mode
+	 *
+	 * The journal mode is stored persistently in the database file.
+	 */
+	int sqlite_wal;
+
 	/**
 	 * conf_ctx - Context pointer for callbacks
 	 *
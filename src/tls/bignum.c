@@ -222,3 +222,50 @@ int bignum_exptmod(const struct bignum *a, const struct bignum *b,
 	}
 	return 0;
 }
+
+
+/**
+ * bignum_div - c = a / b
+ * @a: Bignum from bignum_init(); dividend
+ * @b: Bignum from bignum_init(); divisor
+ * @c: Bignum from bignum_init(); used to store the quotient
+ * Returns: 0 on success, -1 on failure
+ */
+int bignum_div(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c)
+{
+	if (mp_div((mp_int *) a, (mp_int *) b, (mp_int *) c, NULL) != MP_OKAY) {
+		wpa_printf(MSG_DEBUG, "BIGNUM: %s failed", __func__);
+		return -1;
+	}
+	return 0;
+}
+
+
+/**
+ * bignum_mod - c = a (mod b)
+ * @a: Bignum from bignum_init()
+ * @b: Bignum from bignum_init(); modulus
+ * @c: Bignum from bignum_init(); used to store the result of a (mod b)
+ * Returns: 0 on success, -1 on failure
+ */
+int bignum_mod(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c)
+{
+	if (mp_mod((mp_int *) a, (mp_int *) b, (mp_int *) c) != MP_OKAY) {
+		wpa_printf(MSG_DEBUG, "BIGNUM: %s failed", __func__);
+		return -1;
+	}
+	return 0;
+}
+
+
+/**
+ * bignum_get_bits - Get the number of significant bits in a bignum
+ * @n: Bignum from bignum_init()
+ * Returns: Number of bits in n
+ */
+int bignum_get_bits(const struct bignum *n)
+{
+	return mp_count_bits((mp_int *) n);
+}
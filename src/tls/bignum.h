@@ -28,5 +28,10 @@ int bignum_mulmod(const struct bignum *a, const struct bignum *b,
 		  const struct bignum *c, struct bignum *d);
 int bignum_exptmod(const struct bignum *a, const struct bignum *b,
 		   const struct bignum *c, struct bignum *d);
+int bignum_div(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c);
+int bignum_mod(const struct bignum *a, const struct bignum *b,
+	       struct bignum *c);
+int bignum_get_bits(const struct bignum *n);
 
 #endif /* BIGNUM_H */
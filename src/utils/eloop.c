@@ -12,6 +12,7 @@
 #include "common.h"
 #include "trace.h"
 #include "list.h"
+#include "mem_pool.h"
 #include "eloop.h"
 
 #if defined(CONFIG_ELOOP_POLL) && defined(CONFIG_ELOOP_EPOLL)
@@ -74,6 +75,24 @@ struct eloop_sock_table {
 	int changed;
 };
 
+#ifdef CONFIG_ELOOP_STATS
+
+#define ELOOP_STATS_HASH_SIZE 64
+#define ELOOP_STATS_READY_BUCKETS 6
+
+struct eloop_handler_stats {
+	struct eloop_handler_stats *next;
+	void *handler;
+	int timeout; /* 1 = timeout handler, 0 = socket handler */
+	unsigned long count;
+	u64 total_usec;
+	unsigned int max_usec;
+	u64 lag_total_usec; /* time between the due time and the call */
+	unsigned int lag_max_usec;
+};
+
+#endif /* CONFIG_ELOOP_STATS */
+
 struct eloop_data {
 	int max_sock;
 
@@ -110,10 +129,236 @@ struct eloop_data {
 	int pending_terminate;
 
 	int terminate;
+
+#ifdef CONFIG_ELOOP_STATS
+	struct eloop_handler_stats *stats[ELOOP_STATS_HASH_SIZE];
+	unsigned int num_stats;
+	unsigned long iterations;
+	/* Number of ready sockets per iteration: 0, 1, 2-3, 4-7, 8-15, 16+ */
+	unsigned long ready[ELOOP_STATS_READY_BUCKETS];
+	int ready_max;
+	struct os_reltime stats_start;
+#endif /* CONFIG_ELOOP_STATS */
 };
 
 static struct eloop_data eloop;
 
+static struct mem_pool eloop_timeout_pool =
+	MEM_POOL_INIT("eloop_timeout", sizeof(struct eloop_timeout), 64);
+
+
+#ifdef CONFIG_ELOOP_STATS
+
+static unsigned int eloop_stats_usec(struct os_reltime *start,
+				     struct os_reltime *end)
+{
+	struct os_reltime diff;
+
+	if (os_reltime_before(end, start))
+		return 0;
+	os_reltime_sub(end, start, &diff);
+	if (diff.sec >= 4000)
+		return 4000000000U;
+	return diff.sec * 1000000 + diff.usec;
+}
+
+
+static void eloop_stats_record(void *handler, int timeout,
+			       struct os_reltime *start,
+			       struct os_reltime *due)
+{
+	struct eloop_handler_stats *st;
+	struct os_reltime now;
+	unsigned int hash, usec;
+
+	os_get_reltime(&now);
+	hash = ((uintptr_t) handler >> 4) % ELOOP_STATS_HASH_SIZE;
+	for (st = eloop.stats[hash]; st; st = st->next) {
+		if (st->handler == handler && st->timeout == timeout)
+			break;
+	}
+	if (!st) {
+		st = os_zalloc(sizeof(*st));
+		if (!st)
+			return;
+		st->handler = handler;
+		st->timeout = timeout;
+		st->next = eloop.stats[hash];
+		eloop.stats[hash] = st;
+		eloop.num_stats++;
+	}
+
+	usec = eloop_stats_usec(start, &now);
+	st->count++;
+	st->total_usec += usec;
+	if (usec > st->max_usec)
+		st->max_usec = usec;
+	if (due) {
+		usec = eloop_stats_usec(due, start);
+		st->lag_total_usec += usec;
+		if (usec > st->lag_max_usec)
+			st->lag_max_usec = usec;
+	}
+}
+
+
+static void eloop_stats_ready(int res)
+{
+	int i, n;
+
+	eloop.iterations++;
+	if (res > eloop.ready_max)
+		eloop.ready_max = res;
+	for (i = 0, n = res; n > 0 && i < ELOOP_STATS_READY_BUCKETS - 1; i++)
+		n >>= 1;
+	eloop.ready[i]++;
+}
+
+
+static void eloop_call_sock(eloop_sock_handler handler, int sock,
+			    void *eloop_data, void *user_data)
+{
+	struct os_reltime start;
+
+	os_get_reltime(&start);
+	handler(sock, eloop_data, user_data);
+	eloop_stats_record(handler, 0, &start, NULL);
+}
+
+
+static void eloop_call_timeout(eloop_timeout_handler handler,
+			       void *eloop_data, void *user_data,
+			       struct os_reltime *due)
+{
+	struct os_reltime start;
+
+	os_get_reltime(&start);
+	handler(eloop_data, user_data);
+	eloop_stats_record(handler, 1, &start, due);
+}
+
+
+void eloop_stats_reset(void)
+{
+	struct eloop_handler_stats *st, *prev;
+	int i;
+
+	for (i = 0; i < ELOOP_STATS_HASH_SIZE; i++) {
+		st = eloop.stats[i];
+		while (st) {
+			prev = st;
+			st = st->next;
+			os_free(prev);
+		}
+		eloop.stats[i] = NULL;
+	}
+	eloop.num_stats = 0;
+	eloop.iterations = 0;
+	os_memset(eloop.ready, 0, sizeof(eloop.ready));
+	eloop.ready_max = 0;
+	os_get_reltime(&eloop.stats_start);
+}
+
+
+static int eloop_stats_cmp(const void *a, const void *b)
+{
+	const struct eloop_handler_stats *sa, *sb;
+
+	sa = *(const struct eloop_handler_stats **) a;
+	sb = *(const struct eloop_handler_stats **) b;
+	if (sa->total_usec > sb->total_usec)
+		return -1;
+	if (sa->total_usec < sb->total_usec)
+		return 1;
+	return 0;
+}
+
+
+int eloop_stats_get(char *buf, size_t buflen)
+{
+	struct eloop_handler_stats **list, *st;
+	struct os_reltime now, diff;
+	char *pos = buf, *end = buf + buflen;
+	const char *name;
+	unsigned int i, num = 0;
+	int ret;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &eloop.stats_start, &diff);
+	ret = os_snprintf(pos, end - pos,
+			  "elapsed=%ld.%06ld\n"
+			  "iterations=%lu\n"
+			  "ready_sockets=0:%lu 1:%lu 2-3:%lu 4-7:%lu 8-15:%lu "
+			  "16+:%lu\n"
+			  "ready_sockets_max=%d\n",
+			  (long) diff.sec, (long) diff.usec, eloop.iterations,
+			  eloop.ready[0], eloop.ready[1], eloop.ready[2],
+			  eloop.ready[3], eloop.ready[4], eloop.ready[5],
+			  eloop.ready_max);
+	if (os_snprintf_error(end - pos, ret))
+		return pos - buf;
+	pos += ret;
+
+	if (!eloop.num_stats)
+		return pos - buf;
+	list = os_calloc(eloop.num_stats, sizeof(*list));
+	if (!list)
+		return pos - buf;
+	for (i = 0; i < ELOOP_STATS_HASH_SIZE; i++) {
+		for (st = eloop.stats[i]; st && num < eloop.num_stats;
+		     st = st->next)
+			list[num++] = st;
+	}
+	qsort(list, num, sizeof(*list), eloop_stats_cmp);
+
+	for (i = 0; i < num; i++) {
+		char addr[20];
+
+		st = list[i];
+		name = wpa_trace_func_name(st->handler);
+		if (!name) {
+			os_snprintf(addr, sizeof(addr), "%p", st->handler);
+			name = addr;
+		}
+		ret = os_snprintf(pos, end - pos,
+				  "%s %s count=%lu total_usec=%llu "
+				  "avg_usec=%llu max_usec=%u",
+				  st->timeout ? "timeout" : "sock", name,
+				  st->count,
+				  (unsigned long long) st->total_usec,
+				  (unsigned long long) (st->total_usec /
+							st->count),
+				  st->max_usec);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+		if (st->timeout) {
+			ret = os_snprintf(pos, end - pos,
+					  " lag_avg_usec=%llu lag_max_usec=%u",
+					  (unsigned long long)
+					  (st->lag_total_usec / st->count),
+					  st->lag_max_usec);
+			if (os_snprintf_error(end - pos, ret))
+				break;
+			pos += ret;
+		}
+		if (end - pos < 2)
+			break;
+		*pos++ = '\n';
+		*pos = '\0';
+	}
+	os_free(list);
+
+	return pos - buf;
+}
+
+#else /* CONFIG_ELOOP_STATS */
+
+#define eloop_call_sock(handler, sock, eloop_data, user_data) \
+	(handler)((sock), (eloop_data), (user_data))
+
+#endif /* CONFIG_ELOOP_STATS */
+
 
 #ifdef WPA_TRACE
 
@@ -162,6 +407,9 @@ int eloop_init(void)
 {
 	os_memset(&eloop, 0, sizeof(eloop));
 	dl_list_init(&eloop.timeout);
+#ifdef CONFIG_ELOOP_STATS
+	os_get_reltime(&eloop.stats_start);
+#endif /* CONFIG_ELOOP_STATS */
 #ifdef CONFIG_ELOOP_EPOLL
 	eloop.epollfd = epoll_create1(0);
 	if (eloop.epollfd < 0) {
@@ -530,9 +778,10 @@ static int eloop_sock_table_dispatch_table(struct eloop_sock_table *table,
 		if (!(pfd->revents & revents))
 			continue;
 
-		table->table[i].handler(table->table[i].sock,
-					table->table[i].eloop_data,
-					table->table[i].user_data);
+		eloop_call_sock(table->table[i].handler,
+				table->table[i].sock,
+				table->table[i].eloop_data,
+				table->table[i].user_data);
 		if (table->changed)
 			return 1;
 	}
@@ -592,9 +841,10 @@ static void eloop_sock_table_dispatch(struct eloop_sock_table *table,
 	table->changed = 0;
 	for (i = 0; i < table->count; i++) {
 		if (FD_ISSET(table->table[i].sock, fds)) {
-			table->table[i].handler(table->table[i].sock,
-						table->table[i].eloop_data,
-						table->table[i].user_data);
+			eloop_call_sock(table->table[i].handler,
+					table->table[i].sock,
+					table->table[i].eloop_data,
+					table->table[i].user_data);
 			if (table->changed)
 				break;
 		}
@@ -614,8 +864,8 @@ static void eloop_sock_table_dispatch(struct epoll_event *events, int nfds)
 		table = &eloop.fd_table[events[i].data.fd];
 		if (table->handler == NULL)
 			continue;
-		table->handler(table->sock, table->eloop_data,
-			       table->user_data);
+		eloop_call_sock(table->handler, table->sock,
+				table->eloop_data, table->user_data);
 		if (eloop.readers.changed ||
 		    eloop.writers.changed ||
 		    eloop.exceptions.changed)
@@ -636,8 +886,8 @@ static void eloop_sock_table_dispatch(struct kevent *events, int nfds)
 		table = &eloop.fd_table[events[i].ident];
 		if (table->handler == NULL)
 			continue;
-		table->handler(table->sock, table->eloop_data,
-			       table->user_data);
+		eloop_call_sock(table->handler, table->sock,
+				table->eloop_data, table->user_data);
 		if (eloop.readers.changed ||
 		    eloop.writers.changed ||
 		    eloop.exceptions.changed)
@@ -766,11 +1016,11 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 	struct eloop_timeout *timeout, *tmp;
 	os_time_t now_sec;
 
-	timeout = os_zalloc(sizeof(*timeout));
+	timeout = mem_pool_alloc(&eloop_timeout_pool);
 	if (timeout == NULL)
 		return -1;
 	if (os_get_reltime(&timeout->time) < 0) {
-		os_free(timeout);
+		mem_pool_free(&eloop_timeout_pool, timeout);
 		return -1;
 	}
 	now_sec = timeout->time.sec;
@@ -782,7 +1032,7 @@ int eloop_register_timeout(unsigned int secs, unsigned int usecs,
 		 */
 		wpa_printf(MSG_DEBUG, "ELOOP: Too long timeout (secs=%u) to "
 			   "ever happen - ignore it", secs);
-		os_free(timeout);
+		mem_pool_free(&eloop_timeout_pool, timeout);
 		return 0;
 	}
 	timeout->time.usec += usecs;
@@ -815,7 +1065,7 @@ static void eloop_remove_timeout(struct eloop_timeout *timeout)
 	dl_list_del(&timeout->list);
 	wpa_trace_remove_ref(timeout, eloop, timeout->eloop_data);
 	wpa_trace_remove_ref(timeout, user, timeout->user_data);
-	os_free(timeout);
+	mem_pool_free(&eloop_timeout_pool, timeout);
 }
 
 
@@ -1119,6 +1369,10 @@ void eloop_run(void)
 #endif /* CONFIG_ELOOP_KQUEUE */
 		}
 
+		/* Write out buffered debug output before waiting for events */
+		if (!timeout || tv.sec || tv.usec)
+			wpa_debug_flush();
+
 #ifdef CONFIG_ELOOP_POLL
 		num_poll_fds = eloop_sock_table_set_fds(
 			&eloop.readers, &eloop.writers, &eloop.exceptions,
@@ -1174,6 +1428,11 @@ void eloop_run(void)
 		eloop.writers.changed = 0;
 		eloop.exceptions.changed = 0;
 
+#ifdef CONFIG_ELOOP_STATS
+		if (res >= 0)
+			eloop_stats_ready(res);
+#endif /* CONFIG_ELOOP_STATS */
+
 		eloop_process_pending_signals();
 
 
@@ -1187,8 +1446,16 @@ void eloop_run(void)
 				void *user_data = timeout->user_data;
 				eloop_timeout_handler handler =
 					timeout->handler;
+#ifdef CONFIG_ELOOP_STATS
+				struct os_reltime due = timeout->time;
+
+				eloop_remove_timeout(timeout);
+				eloop_call_timeout(handler, eloop_data,
+						   user_data, &due);
+#else /* CONFIG_ELOOP_STATS */
 				eloop_remove_timeout(timeout);
 				handler(eloop_data, user_data);
+#endif /* CONFIG_ELOOP_STATS */
 			}
 
 		}
@@ -1272,6 +1539,10 @@ void eloop_destroy(void)
 	eloop_sock_table_destroy(&eloop.writers);
 	eloop_sock_table_destroy(&eloop.exceptions);
 	os_free(eloop.signals);
+	mem_pool_deinit(&eloop_timeout_pool);
+#ifdef CONFIG_ELOOP_STATS
+	eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
 
 #ifdef CONFIG_ELOOP_POLL
 	os_free(eloop.pollfds);
@@ -364,4 +364,27 @@ int eloop_terminated(void);
  */
 void eloop_wait_for_read_sock(int sock);
 
+#ifdef CONFIG_ELOOP_STATS
+
+/**
+ * eloop_stats_get - Get event loop handler statistics
+ * @buf: Buffer for the text output
+ * @buflen: Length of the buffer
+ * Returns: Number of characters written into buf
+ *
+ * The output includes the number of loop iterations, a histogram of the
+ * number of ready sockets per iteration, and for each socket and timeout
+ * handler the number of calls and the total and maximum run time. For timeout
+ * handlers, the delay between the requested timeout and the actual call is
+ * reported, too. Handlers are listed in decreasing order of total run time.
+ */
+int eloop_stats_get(char *buf, size_t buflen);
+
+/**
+ * eloop_stats_reset - Clear event loop handler statistics
+ */
+void eloop_stats_reset(void);
+
+#endif /* CONFIG_ELOOP_STATS */
+
 #endif /* ELOOP_H */
@@ -539,3 +539,79 @@ void json_print_tree(struct json_token *root, char *buf, size_t buflen)
 	buf[0] = '\0';
 	json_print_token(root, 1, buf, buflen);
 }
+
+
+/*
+ * JSON encoding helpers. These use wpabuf_printf(), so the caller is
+ * responsible for allocating a large enough buffer for the output.
+ */
+
+static void json_add_key(struct wpabuf *json, const char *name)
+{
+	if (name)
+		wpabuf_printf(json, "\"%s\":", name);
+}
+
+
+void json_start_object(struct wpabuf *json, const char *name)
+{
+	json_add_key(json, name);
+	wpabuf_put_u8(json, '{');
+}
+
+
+void json_end_object(struct wpabuf *json)
+{
+	wpabuf_put_u8(json, '}');
+}
+
+
+void json_start_array(struct wpabuf *json, const char *name)
+{
+	json_add_key(json, name);
+	wpabuf_put_u8(json, '[');
+}
+
+
+void json_end_array(struct wpabuf *json)
+{
+	wpabuf_put_u8(json, ']');
+}
+
+
+void json_value_sep(struct wpabuf *json)
+{
+	wpabuf_put_u8(json, ',');
+}
+
+
+void json_add_int(struct wpabuf *json, const char *name, int val)
+{
+	json_add_key(json, name);
+	wpabuf_printf(json, "%d", val);
+}
+
+
+void json_add_ull(struct wpabuf *json, const char *name,
+		  unsigned long long val)
+{
+	json_add_key(json, name);
+	wpabuf_printf(json, "%llu", val);
+}
+
+
+void json_add_string(struct wpabuf *json, const char *name, const char *str)
+{
+	size_t len = os_strlen(str);
+	char *txt;
+
+	json_add_key(json, name);
+	wpabuf_put_u8(json, '"');
+	txt = os_malloc(len * 6 + 1);
+	if (txt) {
+		json_escape_string(txt, len * 6 + 1, str, len);
+		wpabuf_put_str(json, txt);
+		os_free(txt);
+	}
+	wpabuf_put_u8(json, '"');
+}
@@ -39,4 +39,14 @@ struct wpabuf * json_get_member_base64url(struct json_token *json,
 					  const char *name);
 void json_print_tree(struct json_token *root, char *buf, size_t buflen);
 
+void json_start_object(struct wpabuf *json, const char *name);
+void json_end_object(struct wpabuf *json);
+void json_start_array(struct wpabuf *json, const char *name);
+void json_end_array(struct wpabuf *json);
+void json_value_sep(struct wpabuf *json);
+void json_add_int(struct wpabuf *json, const char *name, int val);
+void json_add_ull(struct wpabuf *json, const char *name,
+		  unsigned long long val);
+void json_add_string(struct wpabuf *json, const char *name, const char *str);
+
 #endif /* JSON_H */
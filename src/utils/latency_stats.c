@@ -0,0 +1,144 @@
+/*
+ * Latency samples and histograms
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "latency_stats.h"
+
+
+/**
+ * latency_samples_add - Add a latency sample
+ * @smp: Samples
+ * @usec: Latency in microseconds
+ * Returns: 0 on success, -1 on allocation failure
+ */
+int latency_samples_add(struct latency_samples *smp, unsigned int usec)
+{
+	unsigned int *n;
+	size_t size;
+
+	if (smp->num == smp->size) {
+		size = smp->size ? smp->size * 2 : 256;
+		n = os_realloc_array(smp->val, size, sizeof(*n));
+		if (!n)
+			return -1;
+		smp->val = n;
+		smp->size = size;
+	}
+
+	smp->val[smp->num++] = usec;
+	return 0;
+}
+
+
+/**
+ * latency_samples_add_age - Add the time elapsed since start as a sample
+ * @smp: Samples
+ * @start: Start time of the measured operation
+ * Returns: 0 on success, -1 on allocation failure
+ */
+int latency_samples_add_age(struct latency_samples *smp,
+			    struct os_reltime *start)
+{
+	struct os_reltime age;
+
+	os_reltime_age(start, &age);
+	return latency_samples_add(smp, age.sec * 1000000 + age.usec);
+}
+
+
+static int latency_cmp_uint(const void *a, const void *b)
+{
+	unsigned int _a = *(const unsigned int *) a;
+	unsigned int _b = *(const unsigned int *) b;
+
+	return _a < _b ? -1 : _a > _b;
+}
+
+
+/**
+ * latency_samples_sort - Sort samples for latency_samples_percentile()
+ * @smp: Samples
+ */
+void latency_samples_sort(struct latency_samples *smp)
+{
+	if (smp->num)
+		qsort(smp->val, smp->num, sizeof(smp->val[0]),
+		      latency_cmp_uint);
+}
+
+
+/**
+ * latency_samples_percentile - Get a percentile of sorted samples
+ * @smp: Samples sorted with latency_samples_sort()
+ * @p: Percentile (0..100); 100 gives the maximum
+ * Returns: Sample value in microseconds or 0 if there are no samples
+ */
+unsigned int latency_samples_percentile(const struct latency_samples *smp,
+					int p)
+{
+	if (smp->num == 0)
+		return 0;
+	return smp->val[(smp->num - 1) * p / 100];
+}
+
+
+/**
+ * latency_samples_print - Print a latency summary and a log2 histogram
+ * @title: Title for the summary line
+ * @smp: Samples; these are sorted by this function
+ */
+void latency_samples_print(const char *title, struct latency_samples *smp)
+{
+	unsigned int hist[18];
+	unsigned int limit;
+	size_t i;
+	int b;
+
+	if (smp->num == 0) {
+		printf("%s: no samples\n", title);
+		return;
+	}
+
+	latency_samples_sort(smp);
+	printf("%s (ms): n=%u min=%.3f p50=%.3f p90=%.3f p99=%.3f max=%.3f\n",
+	       title, (unsigned int) smp->num, smp->val[0] / 1000.0,
+	       latency_samples_percentile(smp, 50) / 1000.0,
+	       latency_samples_percentile(smp, 90) / 1000.0,
+	       latency_samples_percentile(smp, 99) / 1000.0,
+	       smp->val[smp->num - 1] / 1000.0);
+
+	/* log2 histogram: <1 ms, <2 ms, <4 ms, ..., >= 65536 ms */
+	os_memset(hist, 0, sizeof(hist));
+	for (i = 0; i < smp->num; i++) {
+		for (b = 0, limit = 1000; b < 17 && smp->val[i] >= limit; b++)
+			limit *= 2;
+		hist[b]++;
+	}
+	for (b = 0, limit = 1; b < 18; b++, limit *= 2) {
+		if (!hist[b])
+			continue;
+		if (b < 17)
+			printf("  < %6u ms: %u\n", limit, hist[b]);
+		else
+			printf("  >=%6u ms: %u\n", limit / 2, hist[b]);
+	}
+}
+
+
+/**
+ * latency_samples_free - Free samples
+ * @smp: Samples
+ */
+void latency_samples_free(struct latency_samples *smp)
+{
+	os_free(smp->val);
+	smp->val = NULL;
+	smp->num = smp->size = 0;
+}
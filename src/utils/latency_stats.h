@@ -0,0 +1,35 @@
+/*
+ * Latency samples and histograms
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+/**
+ * struct latency_samples - Collected latency samples
+ * @val: Samples in microseconds
+ * @num: Number of samples in val
+ * @size: Number of allocated entries in val
+ *
+ * The structure can be zero initialized; latency_samples_free() releases the
+ * samples.
+ */
+struct latency_samples {
+	unsigned int *val;
+	size_t num, size;
+};
+
+int latency_samples_add(struct latency_samples *smp, unsigned int usec);
+int latency_samples_add_age(struct latency_samples *smp,
+			    struct os_reltime *start);
+void latency_samples_sort(struct latency_samples *smp);
+unsigned int latency_samples_percentile(const struct latency_samples *smp,
+					int p);
+void latency_samples_print(const char *title, struct latency_samples *smp);
+void latency_samples_free(struct latency_samples *smp);
+
+#endif /* LATENCY_STATS_H */
@@ -0,0 +1,233 @@
+/*
+ * Pools of fixed-size objects
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "mem_pool.h"
+
+#ifdef CONFIG_MEM_POOL
+
+#define MEM_POOL_ALIGN 16
+#define MEM_POOL_ROUND(len) \
+	(((len) + MEM_POOL_ALIGN - 1) & ~((size_t) MEM_POOL_ALIGN - 1))
+
+struct mem_pool_slab {
+	struct mem_pool_slab *next;
+};
+
+/* Pools that have allocated at least one object, for statistics */
+static struct mem_pool *pools = NULL;
+
+
+static void mem_pool_register(struct mem_pool *pool)
+{
+	if (pool->registered)
+		return;
+	pool->next = pools;
+	pools = pool;
+	pool->registered = 1;
+}
+
+
+static void mem_pool_unregister(struct mem_pool *pool)
+{
+	struct mem_pool **p;
+
+	for (p = &pools; *p; p = &(*p)->next) {
+		if (*p == pool) {
+			*p = pool->next;
+			break;
+		}
+	}
+	pool->next = NULL;
+	pool->registered = 0;
+}
+
+
+#ifdef WPA_TRACE
+
+/*
+ * Keep each object a separate os_zalloc() allocation so that memory leak and
+ * double free detection covers pooled objects, too. Only the statistics are
+ * maintained.
+ */
+
+static void * mem_pool_get(struct mem_pool *pool)
+{
+	return os_zalloc(pool->obj_size);
+}
+
+
+static void mem_pool_put(struct mem_pool *pool, void *ptr)
+{
+	os_free(ptr);
+}
+
+
+static void mem_pool_free_slabs(struct mem_pool *pool)
+{
+}
+
+#else /* WPA_TRACE */
+
+static int mem_pool_grow(struct mem_pool *pool)
+{
+	struct mem_pool_slab *slab;
+	size_t size = MEM_POOL_ROUND(pool->obj_size);
+	unsigned int per_slab = pool->per_slab;
+	unsigned int i;
+	u8 *obj;
+
+	if (size < sizeof(void *))
+		size = MEM_POOL_ALIGN;
+	slab = os_malloc(MEM_POOL_ROUND(sizeof(*slab)) + per_slab * size);
+	if (!slab)
+		return -1;
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+	pool->slab_count++;
+
+	/* Link the new objects in address order in front of the free list */
+	obj = (u8 *) slab + MEM_POOL_ROUND(sizeof(*slab)) +
+		(per_slab - 1) * size;
+	for (i = 0; i < per_slab; i++) {
+		*(void **) obj = pool->free_list;
+		pool->free_list = obj;
+		obj -= size;
+	}
+
+	return 0;
+}
+
+
+static void * mem_pool_get(struct mem_pool *pool)
+{
+	void *obj;
+
+	if (!pool->free_list && mem_pool_grow(pool) < 0)
+		return NULL;
+	obj = pool->free_list;
+	pool->free_list = *(void **) obj;
+	os_memset(obj, 0, pool->obj_size);
+	return obj;
+}
+
+
+static void mem_pool_put(struct mem_pool *pool, void *ptr)
+{
+	*(void **) ptr = pool->free_list;
+	pool->free_list = ptr;
+}
+
+
+static void mem_pool_free_slabs(struct mem_pool *pool)
+{
+	struct mem_pool_slab *slab, *next;
+
+	for (slab = pool->slabs; slab; slab = next) {
+		next = slab->next;
+		os_free(slab);
+	}
+	pool->slabs = NULL;
+	pool->slab_count = 0;
+	pool->free_list = NULL;
+}
+
+#endif /* WPA_TRACE */
+
+
+void * mem_pool_alloc(struct mem_pool *pool)
+{
+	void *obj;
+
+	obj = mem_pool_get(pool);
+	if (!obj)
+		return NULL;
+	mem_pool_register(pool);
+	pool->allocs++;
+	pool->in_use++;
+	if (pool->in_use > pool->peak)
+		pool->peak = pool->in_use;
+	return obj;
+}
+
+
+void mem_pool_free(struct mem_pool *pool, void *ptr)
+{
+	if (!ptr)
+		return;
+	mem_pool_put(pool, ptr);
+	pool->frees++;
+	pool->in_use--;
+}
+
+
+void mem_pool_deinit(struct mem_pool *pool)
+{
+	if (pool->in_use) {
+		wpa_printf(MSG_ERROR,
+			   "mem_pool: %u %s objects still in use on deinit",
+			   pool->in_use, pool->name);
+		return;
+	}
+	mem_pool_free_slabs(pool);
+	mem_pool_unregister(pool);
+	pool->peak = 0;
+	pool->allocs = 0;
+	pool->frees = 0;
+}
+
+
+void mem_pool_deinit_all(void)
+{
+	struct mem_pool *pool, *next;
+
+	for (pool = pools; pool; pool = next) {
+		next = pool->next;
+		mem_pool_deinit(pool);
+	}
+}
+
+
+int mem_pool_stats_get(char *buf, size_t buflen)
+{
+	struct mem_pool *pool;
+	char *pos = buf, *end = buf + buflen;
+	int ret;
+
+	for (pool = pools; pool; pool = pool->next) {
+		ret = os_snprintf(pos, end - pos,
+				  "%s obj_size=%lu slabs=%u objects=%u "
+				  "in_use=%u peak=%u allocs=%lu frees=%lu\n",
+				  pool->name, (unsigned long) pool->obj_size,
+				  pool->slab_count,
+				  pool->slab_count * pool->per_slab,
+				  pool->in_use, pool->peak, pool->allocs,
+				  pool->frees);
+		if (os_snprintf_error(end - pos, ret))
+			break;
+		pos += ret;
+	}
+
+	return pos - buf;
+}
+
+
+void mem_pool_stats_reset(void)
+{
+	struct mem_pool *pool;
+
+	for (pool = pools; pool; pool = pool->next) {
+		pool->peak = pool->in_use;
+		pool->allocs = 0;
+		pool->frees = 0;
+	}
+}
+
+#endif /* CONFIG_MEM_POOL */
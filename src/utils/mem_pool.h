@@ -0,0 +1,126 @@
+/*
+ * Pools of fixed-size objects
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+struct mem_pool_slab;
+
+/**
+ * struct mem_pool - Pool of fixed-size objects
+ *
+ * A pool hands out zeroed objects of a single size. With CONFIG_MEM_POOL,
+ * objects are carved out of larger slabs and freed objects are kept on a
+ * free list for reuse, so that allocating or freeing an object does not
+ * normally go through the heap allocator. Slabs are not returned to the heap
+ * before mem_pool_deinit(). Without CONFIG_MEM_POOL, mem_pool_alloc() and
+ * mem_pool_free() are plain os_zalloc() and os_free() calls.
+ *
+ * Pools are declared as static data with MEM_POOL_INIT() and do not need any
+ * other initialization. The pools are not thread-safe: they are meant for the
+ * single-threaded event loop and a pool must not be used from more than one
+ * thread without external locking.
+ */
+struct mem_pool {
+	const char *name;
+	size_t obj_size;
+	unsigned int per_slab;
+
+	/* The rest is internal state that starts zeroed */
+	void *free_list;
+	struct mem_pool_slab *slabs;
+	struct mem_pool *next;
+	int registered;
+	unsigned int slab_count;
+	unsigned int in_use;
+	unsigned int peak;
+	unsigned long allocs;
+	unsigned long frees;
+};
+
+/**
+ * MEM_POOL_INIT - Static initializer for struct mem_pool
+ * @name: Name of the pool for statistics
+ * @size: Size of each object in octets
+ * @per_slab: Number of objects to allocate at a time (at least one)
+ */
+#define MEM_POOL_INIT(name, size, per_slab) { (name), (size), (per_slab) }
+
+#ifdef CONFIG_MEM_POOL
+
+/**
+ * mem_pool_alloc - Allocate an object from a pool
+ * @pool: Pool from MEM_POOL_INIT()
+ * Returns: Pointer to a zeroed object of pool->obj_size octets or %NULL on
+ * failure
+ *
+ * The object must be freed with mem_pool_free() on the same pool; it must not
+ * be passed to os_free() or os_realloc().
+ */
+void * mem_pool_alloc(struct mem_pool *pool);
+
+/**
+ * mem_pool_free - Return an object to a pool
+ * @pool: Pool from which the object was allocated
+ * @ptr: Object from mem_pool_alloc() or %NULL
+ */
+void mem_pool_free(struct mem_pool *pool, void *ptr);
+
+/**
+ * mem_pool_deinit - Free all slabs of a pool
+ * @pool: Pool from MEM_POOL_INIT()
+ *
+ * All objects must have been returned to the pool. The pool can be used
+ * again after this call.
+ */
+void mem_pool_deinit(struct mem_pool *pool);
+
+/**
+ * mem_pool_deinit_all - Free the slabs of all pools that have been used
+ *
+ * This is called on process exit once all objects have been freed. Pools that
+ * still have objects in use are reported and left in place.
+ */
+void mem_pool_deinit_all(void);
+
+/**
+ * mem_pool_stats_get - Get statistics of all pools that have been used
+ * @buf: Buffer for the text output
+ * @buflen: Length of the buffer
+ * Returns: Number of characters written into buf
+ */
+int mem_pool_stats_get(char *buf, size_t buflen);
+
+/**
+ * mem_pool_stats_reset - Clear allocation counters of all pools
+ */
+void mem_pool_stats_reset(void);
+
+#else /* CONFIG_MEM_POOL */
+
+static inline void * mem_pool_alloc(struct mem_pool *pool)
+{
+	return os_zalloc(pool->obj_size);
+}
+
+static inline void mem_pool_free(struct mem_pool *pool, void *ptr)
+{
+	os_free(ptr);
+}
+
+static inline void mem_pool_deinit(struct mem_pool *pool)
+{
+}
+
+static inline void mem_pool_deinit_all(void)
+{
+}
+
+#endif /* CONFIG_MEM_POOL */
+
+#endif /* MEM_POOL_H */
@@ -0,0 +1,146 @@
+/*
+ * Sorted list of timers sharing a single eloop timeout
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "eloop.h"
+#include "timer_list.h"
+
+
+static void timer_list_timeout(void *eloop_ctx, void *user_ctx);
+
+
+static void timer_list_arm(struct timer_list *tl)
+{
+	struct timer_list_entry *entry;
+	struct os_reltime now, diff;
+
+	eloop_cancel_timeout(timer_list_timeout, tl, NULL);
+	entry = dl_list_first(&tl->entries, struct timer_list_entry, list);
+	if (!entry)
+		return;
+
+	os_get_reltime(&now);
+	if (os_reltime_before(&now, &entry->expire))
+		os_reltime_sub(&entry->expire, &now, &diff);
+	else
+		diff.sec = diff.usec = 0;
+	eloop_register_timeout(diff.sec, diff.usec, timer_list_timeout, tl,
+			       NULL);
+}
+
+
+static void timer_list_timeout(void *eloop_ctx, void *user_ctx)
+{
+	struct timer_list *tl = eloop_ctx;
+	struct timer_list_entry *entry;
+	struct os_reltime now;
+
+	os_get_reltime(&now);
+	while ((entry = dl_list_first(&tl->entries, struct timer_list_entry,
+				      list))) {
+		if (os_reltime_before(&now, &entry->expire))
+			break;
+		dl_list_del(&entry->list);
+		tl->expired(tl->ctx, entry);
+	}
+
+	timer_list_arm(tl);
+}
+
+
+/**
+ * timer_list_init - Initialize a timer list
+ * @tl: Timer list
+ * @expired: Callback for expired timers; the timer has already been removed
+ *	from the list and can be set again from the callback
+ * @ctx: Context data for the callback
+ */
+void timer_list_init(struct timer_list *tl,
+		     void (*expired)(void *ctx,
+				     struct timer_list_entry *entry),
+		     void *ctx)
+{
+	dl_list_init(&tl->entries);
+	tl->expired = expired;
+	tl->ctx = ctx;
+}
+
+
+/**
+ * timer_list_deinit - Stop all timers of a list
+ * @tl: Timer list from timer_list_init()
+ *
+ * The pending timers are removed from the list without calling the expiration
+ * callback for them.
+ */
+void timer_list_deinit(struct timer_list *tl)
+{
+	struct timer_list_entry *entry;
+
+	eloop_cancel_timeout(timer_list_timeout, tl, NULL);
+	while ((entry = dl_list_first(&tl->entries, struct timer_list_entry,
+				      list)))
+		dl_list_del(&entry->list);
+}
+
+
+/**
+ * timer_list_set - Set a timer
+ * @tl: Timer list from timer_list_init()
+ * @entry: Timer; if it is already pending, it is moved to the new time
+ * @secs: Number of seconds until the timer expires
+ * @usecs: Number of microseconds (in addition to secs) until the timer expires
+ */
+void timer_list_set(struct timer_list *tl, struct timer_list_entry *entry,
+		    unsigned int secs, unsigned int usecs)
+{
+	struct timer_list_entry *pos;
+
+	if (timer_list_pending(entry))
+		dl_list_del(&entry->list);
+
+	os_get_reltime(&entry->expire);
+	entry->expire.sec += secs + usecs / 1000000;
+	entry->expire.usec += usecs % 1000000;
+	if (entry->expire.usec >= 1000000) {
+		entry->expire.sec++;
+		entry->expire.usec -= 1000000;
+	}
+
+	dl_list_for_each_reverse(pos, &tl->entries, struct timer_list_entry,
+				 list) {
+		if (!os_reltime_before(&entry->expire, &pos->expire)) {
+			dl_list_add(&pos->list, &entry->list);
+			return;
+		}
+	}
+
+	/* New first entry */
+	dl_list_add(&tl->entries, &entry->list);
+	timer_list_arm(tl);
+}
+
+
+/**
+ * timer_list_cancel - Cancel a timer
+ * @tl: Timer list from timer_list_init()
+ * @entry: Timer; nothing is done if it is not pending
+ *
+ * If the timer was the first one, the eloop timeout is left in place and it
+ * only re-arms itself for the next timer when it fires.
+ */
+void timer_list_cancel(struct timer_list *tl, struct timer_list_entry *entry)
+{
+	if (!timer_list_pending(entry))
+		return;
+	dl_list_del(&entry->list);
+	if (dl_list_empty(&tl->entries))
+		eloop_cancel_timeout(timer_list_timeout, tl, NULL);
+}
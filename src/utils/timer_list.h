@@ -0,0 +1,62 @@
+/*
+ * Sorted list of timers sharing a single eloop timeout
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#ifndef TIMER_LIST_H
+#define TIMER_LIST_H
+
+#include "list.h"
+
+/**
+ * struct timer_list_entry - Timer in a struct timer_list
+ *
+ * This is embedded in the data structure that owns the timer and must start
+ * zeroed. It is linked to the list only while the timer is pending.
+ */
+struct timer_list_entry {
+	struct dl_list list; /* struct timer_list::entries */
+	struct os_reltime expire;
+};
+
+/**
+ * struct timer_list - Timers ordered by expiration time
+ *
+ * Only the first timer of the list is registered with eloop, so the number of
+ * eloop timeouts does not grow with the number of pending timers. Timers that
+ * use the same timeout value are appended at the tail, so setting a timer is
+ * O(1) in the common case.
+ */
+struct timer_list {
+	struct dl_list entries;
+	void (*expired)(void *ctx, struct timer_list_entry *entry);
+	void *ctx;
+};
+
+void timer_list_init(struct timer_list *tl,
+		     void (*expired)(void *ctx,
+				     struct timer_list_entry *entry),
+		     void *ctx);
+void timer_list_deinit(struct timer_list *tl);
+void timer_list_set(struct timer_list *tl, struct timer_list_entry *entry,
+		    unsigned int secs, unsigned int usecs);
+void timer_list_cancel(struct timer_list *tl, struct timer_list_entry *entry);
+
+/**
+ * timer_list_owner - Get the data structure that contains a timer
+ * @entry: Pointer to the struct timer_list_entry
+ * @type: Type of the containing data structure
+ * @member: Name of the struct timer_list_entry member in @type
+ */
+#define timer_list_owner(entry, type, member) \
+	((type *) ((char *) (entry) - offsetof(type, member)))
+
+static inline int timer_list_pending(const struct timer_list_entry *entry)
+{
+	return entry->list.next != NULL;
+}
+
+#endif /* TIMER_LIST_H */
@@ -275,6 +275,13 @@ void wpa_trace_dump_funcname(const char *title, void *pc)
 }
 
 
+const char * wpa_trace_func_name(void *pc)
+{
+	wpa_trace_bfd_init();
+	return wpa_trace_bfd_addr2func(pc);
+}
+
+
 size_t wpa_trace_calling_func(const char *buf[], size_t len)
 {
 	bfd *abfd;
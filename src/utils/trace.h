@@ -59,10 +59,12 @@ size_t wpa_trace_calling_func(const char *buf[], size_t len);
 #ifdef WPA_TRACE_BFD
 
 void wpa_trace_dump_funcname(const char *title, void *pc);
+const char * wpa_trace_func_name(void *pc);
 
 #else /* WPA_TRACE_BFD */
 
 #define wpa_trace_dump_funcname(title, pc) do { } while (0)
+#define wpa_trace_func_name(pc) NULL
 
 #endif /* WPA_TRACE_BFD */
 
@@ -17,6 +17,7 @@
 #include "utils/ip_addr.h"
 #include "utils/eloop.h"
 #include "utils/json.h"
+#include "utils/mem_pool.h"
 #include "utils/module_tests.h"
 
 
@@ -555,6 +556,34 @@ static int wpabuf_tests(void)
 	if (buf != NULL)
 		errors++;
 
+	/* Resize within and beyond the pooled buffer sizes */
+	buf = wpabuf_alloc(100);
+	if (buf) {
+		unsigned int i;
+		u8 *pos, val;
+
+		os_memset(wpabuf_put(buf, 100), 0xaa, 100);
+		if (wpabuf_resize(&buf, 20) < 0)
+			errors++;
+		else
+			os_memset(wpabuf_put(buf, 20), 0xbb, 20);
+		if (wpabuf_resize(&buf, 2000) < 0)
+			errors++;
+		else
+			os_memset(wpabuf_put(buf, 2000), 0xcc, 2000);
+		pos = wpabuf_mhead_u8(buf);
+		for (i = 0; i < wpabuf_len(buf); i++) {
+			val = i < 100 ? 0xaa : (i < 120 ? 0xbb : 0xcc);
+			if (pos[i] != val) {
+				errors++;
+				break;
+			}
+		}
+		wpabuf_free(buf);
+	} else {
+		errors++;
+	}
+
 	if (errors) {
 		wpa_printf(MSG_ERROR, "%d wpabuf test(s) failed", errors);
 		return -1;
@@ -564,6 +593,57 @@ static int wpabuf_tests(void)
 }
 
 
+static int mem_pool_tests(void)
+{
+#ifdef CONFIG_MEM_POOL
+	struct mem_pool pool = MEM_POOL_INIT("test", 20, 4);
+	u8 *obj[10];
+	char buf[500];
+	unsigned int i, j;
+	int errors = 0;
+
+	wpa_printf(MSG_INFO, "mem_pool tests");
+
+	for (j = 0; j < 2; j++) {
+		for (i = 0; i < ARRAY_SIZE(obj); i++) {
+			obj[i] = mem_pool_alloc(&pool);
+			if (!obj[i]) {
+				errors++;
+				continue;
+			}
+			if (obj[i][0] || obj[i][19])
+				errors++;
+			os_memset(obj[i], 0xff, 20);
+		}
+		if (pool.in_use != ARRAY_SIZE(obj))
+			errors++;
+		for (i = 1; i < ARRAY_SIZE(obj); i++) {
+			if (obj[i] == obj[i - 1])
+				errors++;
+		}
+		for (i = 0; i < ARRAY_SIZE(obj); i++)
+			mem_pool_free(&pool, obj[i]);
+		if (pool.in_use != 0 || pool.peak != ARRAY_SIZE(obj))
+			errors++;
+	}
+
+	if (mem_pool_stats_get(buf, sizeof(buf)) <= 0 ||
+	    !os_strstr(buf, "test obj_size=20 "))
+		errors++;
+	mem_pool_deinit(&pool);
+	if (pool.slabs || pool.allocs)
+		errors++;
+
+	if (errors) {
+		wpa_printf(MSG_ERROR, "%d mem_pool test(s) failed", errors);
+		return -1;
+	}
+#endif /* CONFIG_MEM_POOL */
+
+	return 0;
+}
+
+
 static int ip_addr_tests(void)
 {
 	int errors = 0;
@@ -929,6 +1009,7 @@ int utils_module_tests(void)
 	    common_tests() < 0 ||
 	    os_tests() < 0 ||
 	    wpabuf_tests() < 0 ||
+	    mem_pool_tests() < 0 ||
 	    ip_addr_tests() < 0 ||
 	    eloop_tests() < 0 ||
 	    json_tests() < 0 ||
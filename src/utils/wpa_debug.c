@@ -59,6 +59,345 @@ static int wpa_to_android_level(int level)
 
 #ifdef CONFIG_DEBUG_FILE
 static FILE *out_file = NULL;
+static int out_file_binary = 0;
+#endif /* CONFIG_DEBUG_FILE */
+static int wpa_debug_buffered = 0;
+
+#define WPA_DEBUG_BUF_SIZE 65536
+
+
+#ifdef CONFIG_DEBUG_FILE
+
+/*
+ * Binary debug file format
+ *
+ * The file starts with WPA_DEBUG_BIN_MAGIC and is followed by records. Each
+ * record has a six octet header (type, level, payload length as 32-bit
+ * little endian integer) and the payload. A format string is written once as
+ * a WPA_DEBUG_BIN_FORMAT record (16-bit identifier followed by the string)
+ * and the messages using it refer to it by the identifier and include only
+ * the timestamp and the raw arguments. Integer and pointer arguments are
+ * stored as 64-bit little endian values, floating point arguments as 64-bit
+ * little endian IEEE 754 values, and strings with a 16-bit length prefix.
+ * wpa_supplicant/utils/wpa_debug_decode.py converts the file back to text.
+ */
+
+#define WPA_DEBUG_BIN_MAGIC "WPADBG1\n"
+#define WPA_DEBUG_BIN_FORMAT 1
+#define WPA_DEBUG_BIN_MSG 2
+#define WPA_DEBUG_BIN_TEXT 3
+#define WPA_DEBUG_BIN_HEXDUMP 4
+
+#define WPA_DEBUG_BIN_HEXDUMP_ASCII BIT(0)
+#define WPA_DEBUG_BIN_HEXDUMP_REMOVED BIT(1)
+#define WPA_DEBUG_BIN_HEXDUMP_NULL BIT(2)
+
+#define WPA_DEBUG_BIN_FMT_HASH_SIZE 1024
+#define WPA_DEBUG_BIN_MAX_FMT 0xffff
+#define WPA_DEBUG_BIN_MAX_ARGS 2048
+
+struct wpa_debug_bin_fmt {
+	struct wpa_debug_bin_fmt *next;
+	const char *ptr;
+	u16 id;
+	char str[];
+};
+
+static struct wpa_debug_bin_fmt *bin_fmt_hash[WPA_DEBUG_BIN_FMT_HASH_SIZE];
+static unsigned int bin_fmt_count = 0;
+
+
+static void wpa_debug_bin_reset(void)
+{
+	struct wpa_debug_bin_fmt *f, *prev;
+	unsigned int i;
+
+	for (i = 0; i < WPA_DEBUG_BIN_FMT_HASH_SIZE; i++) {
+		f = bin_fmt_hash[i];
+		while (f) {
+			prev = f;
+			f = f->next;
+			os_free(prev);
+		}
+		bin_fmt_hash[i] = NULL;
+	}
+	bin_fmt_count = 0;
+}
+
+
+static void wpa_debug_bin_record(u8 type, int level, const void *a,
+				 size_t alen, const void *b, size_t blen)
+{
+	u8 hdr[6];
+
+	hdr[0] = type;
+	hdr[1] = level;
+	WPA_PUT_LE32(&hdr[2], alen + blen);
+	fwrite(hdr, sizeof(hdr), 1, out_file);
+	if (alen)
+		fwrite(a, alen, 1, out_file);
+	if (blen)
+		fwrite(b, blen, 1, out_file);
+}
+
+
+static u8 * wpa_debug_bin_time(u8 *pos)
+{
+	struct os_time tv;
+
+	os_get_time(&tv);
+	WPA_PUT_LE32(pos, tv.sec);
+	WPA_PUT_LE32(pos + 4, tv.usec);
+	return pos + 8;
+}
+
+
+static int wpa_debug_bin_fmt_id(const char *fmt)
+{
+	struct wpa_debug_bin_fmt *f;
+	unsigned int hash;
+	size_t len;
+	u8 id[2];
+
+	hash = ((uintptr_t) fmt >> 2) % WPA_DEBUG_BIN_FMT_HASH_SIZE;
+	for (f = bin_fmt_hash[hash]; f; f = f->next) {
+		/* The same pointer may be reused for a different string */
+		if (f->ptr == fmt && os_strcmp(f->str, fmt) == 0)
+			return f->id;
+	}
+
+	if (bin_fmt_count >= WPA_DEBUG_BIN_MAX_FMT)
+		return -1;
+	len = os_strlen(fmt);
+	f = os_malloc(sizeof(*f) + len + 1);
+	if (!f)
+		return -1;
+	f->ptr = fmt;
+	f->id = bin_fmt_count++;
+	os_memcpy(f->str, fmt, len + 1);
+	f->next = bin_fmt_hash[hash];
+	bin_fmt_hash[hash] = f;
+
+	WPA_PUT_LE16(id, f->id);
+	wpa_debug_bin_record(WPA_DEBUG_BIN_FORMAT, 0, id, sizeof(id), fmt, len);
+	return f->id;
+}
+
+
+/* Store the printf arguments matching fmt without formatting them */
+static int wpa_debug_bin_args(u8 *buf, size_t size, const char *fmt,
+			      va_list ap)
+{
+	u8 *pos = buf, *end = buf + size;
+	const char *s;
+	char lmod;
+	int prec, wide;
+	size_t slen;
+	u64 val;
+	double d;
+
+	while ((fmt = os_strchr(fmt, '%'))) {
+		fmt++;
+		if (*fmt == '%') {
+			fmt++;
+			continue;
+		}
+		while (*fmt && os_strchr("-+ #0", *fmt))
+			fmt++;
+		if (*fmt == '*') {
+			fmt++;
+			if (end - pos < 8)
+				return -1;
+			WPA_PUT_LE64(pos, (u64) (s64) va_arg(ap, int));
+			pos += 8;
+		}
+		while (*fmt >= '0' && *fmt <= '9')
+			fmt++;
+		prec = -1;
+		if (*fmt == '.') {
+			fmt++;
+			prec = 0;
+			if (*fmt == '*') {
+				fmt++;
+				prec = va_arg(ap, int);
+				if (end - pos < 8)
+					return -1;
+				WPA_PUT_LE64(pos, (u64) (s64) prec);
+				pos += 8;
+			}
+			while (*fmt >= '0' && *fmt <= '9')
+				prec = prec * 10 + *fmt++ - '0';
+		}
+
+		/* Length modifier: h, l, q (long long), j, z, t, or L */
+		lmod = 0;
+		wide = 0;
+		if (*fmt == 'h' || *fmt == 'l') {
+			lmod = *fmt++;
+			if (*fmt == lmod) {
+				fmt++;
+				wide = 1;
+			}
+			if (lmod == 'l' && wide)
+				lmod = 'q';
+		} else if (*fmt && os_strchr("jztL", *fmt)) {
+			lmod = *fmt++;
+		}
+
+		switch (*fmt) {
+		case 'd':
+		case 'i':
+			if (lmod == 'l')
+				val = (u64) (s64) va_arg(ap, long);
+			else if (lmod == 'q')
+				val = (u64) (s64) va_arg(ap, long long);
+			else if (lmod == 'j')
+				val = (u64) (s64) va_arg(ap, intmax_t);
+			else if (lmod == 'z')
+				val = (u64) (s64) va_arg(ap, ssize_t);
+			else if (lmod == 't')
+				val = (u64) (s64) va_arg(ap, ptrdiff_t);
+			else
+				val = (u64) (s64) va_arg(ap, int);
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			if (lmod == 'l')
+				val = va_arg(ap, unsigned long);
+			else if (lmod == 'q')
+				val = va_arg(ap, unsigned long long);
+			else if (lmod == 'j')
+				val = va_arg(ap, uintmax_t);
+			else if (lmod == 'z')
+				val = va_arg(ap, size_t);
+			else if (lmod == 't')
+				val = va_arg(ap, ptrdiff_t);
+			else
+				val = va_arg(ap, unsigned int);
+			if (lmod == 'h')
+				val &= wide ? 0xff : 0xffff;
+			break;
+		case 'c':
+			val = va_arg(ap, int);
+			break;
+		case 'p':
+			val = (uintptr_t) va_arg(ap, void *);
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+			if (lmod == 'L')
+				d = va_arg(ap, long double);
+			else
+				d = va_arg(ap, double);
+			os_memcpy(&val, &d, sizeof(val));
+			break;
+		case 's':
+			s = va_arg(ap, const char *);
+			if (!s)
+				s = "(null)";
+			for (slen = 0; s[slen] && (prec < 0 || slen < (size_t) prec);
+			     slen++)
+				;
+			if (slen > 0xffff || (size_t) (end - pos) < 2 + slen)
+				return -1;
+			WPA_PUT_LE16(pos, slen);
+			os_memcpy(pos + 2, s, slen);
+			pos += 2 + slen;
+			fmt++;
+			continue;
+		default:
+			/* Not supported; let the caller format the message */
+			return -1;
+		}
+		fmt++;
+
+		if (end - pos < 8)
+			return -1;
+		WPA_PUT_LE64(pos, val);
+		pos += 8;
+	}
+
+	return pos - buf;
+}
+
+
+static void wpa_debug_bin_printf(int level, const char *fmt, va_list ap)
+{
+	u8 buf[10 + WPA_DEBUG_BIN_MAX_ARGS], *pos;
+	int id, len;
+	char *txt;
+	va_list ap2;
+
+	pos = wpa_debug_bin_time(buf);
+	id = wpa_debug_bin_fmt_id(fmt);
+	if (id >= 0) {
+		WPA_PUT_LE16(pos, id);
+		pos += 2;
+		va_copy(ap2, ap);
+		len = wpa_debug_bin_args(pos, WPA_DEBUG_BIN_MAX_ARGS, fmt, ap2);
+		va_end(ap2);
+		if (len >= 0) {
+			wpa_debug_bin_record(WPA_DEBUG_BIN_MSG, level, buf,
+					     pos - buf + len, NULL, 0);
+			return;
+		}
+	}
+
+	/* Fall back to storing the formatted message */
+	pos = wpa_debug_bin_time(buf);
+	va_copy(ap2, ap);
+	len = vsnprintf(NULL, 0, fmt, ap2);
+	va_end(ap2);
+	if (len < 0)
+		return;
+	txt = os_malloc(len + 1);
+	if (!txt)
+		return;
+	vsnprintf(txt, len + 1, fmt, ap);
+	wpa_debug_bin_record(WPA_DEBUG_BIN_TEXT, level, buf, pos - buf,
+			     txt, len);
+	os_free(txt);
+}
+
+
+static void wpa_debug_bin_hexdump(int level, const char *title,
+				  const u8 *buf, size_t len, int show,
+				  int ascii)
+{
+	u8 hdr[6 + 15], *pos;
+	size_t tlen, dlen;
+
+	tlen = os_strlen(title);
+	if (tlen > 0xffff)
+		tlen = 0xffff;
+	dlen = buf && show ? len : 0;
+
+	hdr[0] = WPA_DEBUG_BIN_HEXDUMP;
+	hdr[1] = level;
+	WPA_PUT_LE32(&hdr[2], sizeof(hdr) - 6 + tlen + dlen);
+	pos = wpa_debug_bin_time(&hdr[6]);
+	*pos = ascii ? WPA_DEBUG_BIN_HEXDUMP_ASCII : 0;
+	if (!buf)
+		*pos |= WPA_DEBUG_BIN_HEXDUMP_NULL;
+	else if (!show)
+		*pos |= WPA_DEBUG_BIN_HEXDUMP_REMOVED;
+	pos++;
+	WPA_PUT_LE32(pos, len);
+	pos += 4;
+	WPA_PUT_LE16(pos, tlen);
+
+	fwrite(hdr, sizeof(hdr), 1, out_file);
+	fwrite(title, tlen, 1, out_file);
+	if (dlen)
+		fwrite(buf, dlen, 1, out_file);
+}
+
 #endif /* CONFIG_DEBUG_FILE */
 
 
@@ -70,6 +409,11 @@ void wpa_debug_print_timestamp(void)
 	if (!wpa_debug_timestamp)
 		return;
 
+#ifdef CONFIG_DEBUG_FILE
+	if (out_file_binary)
+		return; /* binary records always include the timestamp */
+#endif /* CONFIG_DEBUG_FILE */
+
 	os_get_time(&tv);
 #ifdef CONFIG_DEBUG_FILE
 	if (out_file) {
@@ -190,6 +534,16 @@ void wpa_debug_close_linux_tracing(void)
 #endif /* CONFIG_DEBUG_LINUX_TRACING */
 
 
+int wpa_debug_level_enabled(int level)
+{
+#ifdef CONFIG_DEBUG_LINUX_TRACING
+	if (wpa_debug_tracing_file)
+		return 1;
+#endif /* CONFIG_DEBUG_LINUX_TRACING */
+	return level >= wpa_debug_level;
+}
+
+
 /**
  * wpa_printf - conditional printf
  * @level: priority level (MSG_*) of the message
@@ -218,7 +572,9 @@ void wpa_printf(int level, const char *fmt, ...)
 #endif /* CONFIG_DEBUG_SYSLOG */
 		wpa_debug_print_timestamp();
 #ifdef CONFIG_DEBUG_FILE
-		if (out_file) {
+		if (out_file && out_file_binary) {
+			wpa_debug_bin_printf(level, fmt, ap);
+		} else if (out_file) {
 			vfprintf(out_file, fmt, ap);
 			fprintf(out_file, "\n");
 		} else {
@@ -248,11 +604,28 @@ void wpa_printf(int level, const char *fmt, ...)
 }
 
 
+static void wpa_debug_hex(FILE *f, const u8 *buf, size_t len)
+{
+	static const char digits[] = "0123456789abcdef";
+	char hex[3 * 32 + 1];
+	size_t i, j;
+
+	/* Format the octets in blocks instead of one stdio call per octet */
+	for (i = 0; i < len; i += j) {
+		for (j = 0; j < 32 && i + j < len; j++) {
+			hex[3 * j] = ' ';
+			hex[3 * j + 1] = digits[buf[i + j] >> 4];
+			hex[3 * j + 2] = digits[buf[i + j] & 0x0f];
+		}
+		hex[3 * j] = '\0';
+		fputs(hex, f);
+	}
+}
+
+
 static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 			 size_t len, int show)
 {
-	size_t i;
-
 #ifdef CONFIG_DEBUG_LINUX_TRACING
 	if (wpa_debug_tracing_file != NULL) {
 		fprintf(wpa_debug_tracing_file,
@@ -263,9 +636,7 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 		} else if (!show) {
 			fprintf(wpa_debug_tracing_file, " [REMOVED]\n");
 		} else {
-			for (i = 0; i < len; i++)
-				fprintf(wpa_debug_tracing_file,
-					" %02x", buf[i]);
+			wpa_debug_hex(wpa_debug_tracing_file, buf, len);
 		}
 		fflush(wpa_debug_tracing_file);
 	}
@@ -277,7 +648,7 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 	{
 		const char *display;
 		char *strbuf = NULL;
-		size_t slen = len;
+		size_t i, slen = len;
 		if (buf == NULL) {
 			display = " [NULL]";
 		} else if (len == 0) {
@@ -315,6 +686,7 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 	if (wpa_debug_syslog) {
 		const char *display;
 		char *strbuf = NULL;
+		size_t i;
 
 		if (buf == NULL) {
 			display = " [NULL]";
@@ -345,14 +717,15 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 #endif /* CONFIG_DEBUG_SYSLOG */
 	wpa_debug_print_timestamp();
 #ifdef CONFIG_DEBUG_FILE
-	if (out_file) {
+	if (out_file && out_file_binary) {
+		wpa_debug_bin_hexdump(level, title, buf, len, show, 0);
+	} else if (out_file) {
 		fprintf(out_file, "%s - hexdump(len=%lu):",
 			title, (unsigned long) len);
 		if (buf == NULL) {
 			fprintf(out_file, " [NULL]");
 		} else if (show) {
-			for (i = 0; i < len; i++)
-				fprintf(out_file, " %02x", buf[i]);
+			wpa_debug_hex(out_file, buf, len);
 		} else {
 			fprintf(out_file, " [REMOVED]");
 		}
@@ -363,8 +736,7 @@ static void _wpa_hexdump(int level, const char *title, const u8 *buf,
 	if (buf == NULL) {
 		printf(" [NULL]");
 	} else if (show) {
-		for (i = 0; i < len; i++)
-			printf(" %02x", buf[i]);
+		wpa_debug_hex(stdout, buf, len);
 	} else {
 		printf(" [REMOVED]");
 	}
@@ -420,7 +792,9 @@ static void _wpa_hexdump_ascii(int level, const char *title, const void *buf,
 #else /* CONFIG_ANDROID_LOG */
 	wpa_debug_print_timestamp();
 #ifdef CONFIG_DEBUG_FILE
-	if (out_file) {
+	if (out_file && out_file_binary) {
+		wpa_debug_bin_hexdump(level, title, buf, len, show, 1);
+	} else if (out_file) {
 		if (!show) {
 			fprintf(out_file,
 				"%s - hexdump_ascii(len=%lu): [REMOVED]\n",
@@ -516,7 +890,7 @@ static char *last_path = NULL;
 int wpa_debug_reopen_file(void)
 {
 #ifdef CONFIG_DEBUG_FILE
-	int rv;
+	int rv, binary;
 	char *tmp;
 
 	if (!last_path)
@@ -526,8 +900,12 @@ int wpa_debug_reopen_file(void)
 	if (!tmp)
 		return -1;
 
+	binary = out_file_binary;
 	wpa_debug_close_file();
-	rv = wpa_debug_open_file(tmp);
+	if (binary)
+		rv = wpa_debug_open_binary_file(tmp);
+	else
+		rv = wpa_debug_open_file(tmp);
 	os_free(tmp);
 	return rv;
 #else /* CONFIG_DEBUG_FILE */
@@ -555,7 +933,12 @@ int wpa_debug_open_file(const char *path)
 		return -1;
 	}
 #ifndef _WIN32
+#ifdef CONFIG_DEBUG_BUFFERED
+	setvbuf(out_file, NULL, _IOFBF, WPA_DEBUG_BUF_SIZE);
+	wpa_debug_buffered = 1;
+#else /* CONFIG_DEBUG_BUFFERED */
 	setvbuf(out_file, NULL, _IOLBF, 0);
+#endif /* CONFIG_DEBUG_BUFFERED */
 #endif /* _WIN32 */
 #else /* CONFIG_DEBUG_FILE */
 	(void)path;
@@ -564,6 +947,35 @@ int wpa_debug_open_file(const char *path)
 }
 
 
+/**
+ * wpa_debug_open_binary_file - Open a debug file in the binary format
+ * @path: Path to the debug file
+ * Returns: 0 on success, -1 on failure
+ *
+ * Messages are written without formatting them (see WPA_DEBUG_BIN_MAGIC).
+ * The file is written in large blocks from the event loop, see
+ * wpa_debug_flush().
+ */
+int wpa_debug_open_binary_file(const char *path)
+{
+#ifdef CONFIG_DEBUG_FILE
+	if (wpa_debug_open_file(path) < 0 || !out_file)
+		return -1;
+#ifndef _WIN32
+	setvbuf(out_file, NULL, _IOFBF, WPA_DEBUG_BUF_SIZE);
+#endif /* _WIN32 */
+	wpa_debug_buffered = 1;
+	out_file_binary = 1;
+	wpa_debug_bin_reset();
+	fwrite(WPA_DEBUG_BIN_MAGIC, os_strlen(WPA_DEBUG_BIN_MAGIC), 1,
+	       out_file);
+	return 0;
+#else /* CONFIG_DEBUG_FILE */
+	return wpa_debug_open_file(path);
+#endif /* CONFIG_DEBUG_FILE */
+}
+
+
 void wpa_debug_close_file(void)
 {
 #ifdef CONFIG_DEBUG_FILE
@@ -571,19 +983,43 @@ void wpa_debug_close_file(void)
 		return;
 	fclose(out_file);
 	out_file = NULL;
+	if (out_file_binary) {
+		out_file_binary = 0;
+		wpa_debug_bin_reset();
+	}
 	os_free(last_path);
 	last_path = NULL;
 #endif /* CONFIG_DEBUG_FILE */
+	wpa_debug_buffered = 0;
 }
 
 
 void wpa_debug_setup_stdout(void)
 {
 #ifndef _WIN32
+#ifdef CONFIG_DEBUG_BUFFERED
+	setvbuf(stdout, NULL, _IOFBF, WPA_DEBUG_BUF_SIZE);
+	wpa_debug_buffered = 1;
+#else /* CONFIG_DEBUG_BUFFERED */
 	setvbuf(stdout, NULL, _IOLBF, 0);
+#endif /* CONFIG_DEBUG_BUFFERED */
 #endif /* _WIN32 */
 }
 
+
+void wpa_debug_flush(void)
+{
+	if (!wpa_debug_buffered)
+		return;
+#ifdef CONFIG_DEBUG_FILE
+	if (out_file) {
+		fflush(out_file);
+		return;
+	}
+#endif /* CONFIG_DEBUG_FILE */
+	fflush(stdout);
+}
+
 #endif /* CONFIG_NO_STDOUT_DEBUG */
 
 
@@ -790,6 +1226,14 @@ void hostapd_logger_register_cb(hostapd_logger_cb_func func)
 }
 
 
+static hostapd_logger_filter_func hostapd_logger_filter_cb = NULL;
+
+void hostapd_logger_register_filter_cb(hostapd_logger_filter_func func)
+{
+	hostapd_logger_filter_cb = func;
+}
+
+
 void hostapd_logger(void *ctx, const u8 *addr, unsigned int module, int level,
 		    const char *fmt, ...)
 {
@@ -798,6 +1242,13 @@ void hostapd_logger(void *ctx, const u8 *addr, unsigned int module, int level,
 	int buflen;
 	int len;
 
+	if (hostapd_logger_filter_cb) {
+		if (!hostapd_logger_filter_cb(ctx, module, level))
+			return;
+	} else if (!hostapd_logger_cb && !wpa_debug_level_enabled(MSG_DEBUG)) {
+		return;
+	}
+
 	va_start(ap, fmt);
 	buflen = vsnprintf(NULL, 0, fmt, ap) + 1;
 	va_end(ap);
@@ -37,7 +37,9 @@ enum {
 #define wpa_hexdump_ascii_key(l,t,b,le) do { } while (0)
 #define wpa_debug_open_file(p) do { } while (0)
 #define wpa_debug_close_file() do { } while (0)
+#define wpa_debug_open_binary_file(p) do { } while (0)
 #define wpa_debug_setup_stdout() do { } while (0)
+#define wpa_debug_flush() do { } while (0)
 #define wpa_dbg(args...) do { } while (0)
 
 static inline int wpa_debug_reopen_file(void)
@@ -45,13 +47,39 @@ static inline int wpa_debug_reopen_file(void)
 	return 0;
 }
 
+static inline int wpa_debug_level_enabled(int level)
+{
+	return 0;
+}
+
 #else /* CONFIG_NO_STDOUT_DEBUG */
 
 int wpa_debug_open_file(const char *path);
+int wpa_debug_open_binary_file(const char *path);
 int wpa_debug_reopen_file(void);
 void wpa_debug_close_file(void);
 void wpa_debug_setup_stdout(void);
 
+/**
+ * wpa_debug_flush - Write out buffered debug output
+ *
+ * With CONFIG_DEBUG_BUFFERED and for binary debug files, debug output is
+ * collected into a large stdio buffer instead of being written out line by
+ * line. The event loop calls this function before it blocks waiting for the
+ * next event so that the log is up to date whenever the process is idle.
+ */
+void wpa_debug_flush(void);
+
+/**
+ * wpa_debug_level_enabled - Check whether a debug level would be printed
+ * @level: priority level (MSG_*) of the message
+ * Returns: 1 if a wpa_printf() call with this level would produce output
+ *
+ * This can be used to skip building expensive debug messages that would be
+ * discarded.
+ */
+int wpa_debug_level_enabled(int level);
+
 /**
  * wpa_debug_printf_timestamp - Print timestamp for debug output
  *
@@ -285,6 +313,7 @@ void wpa_msg_register_ifname_cb(wpa_msg_get_ifname_func func);
 #ifdef CONFIG_NO_HOSTAPD_LOGGER
 #define hostapd_logger(args...) do { } while (0)
 #define hostapd_logger_register_cb(f) do { } while (0)
+#define hostapd_logger_register_filter_cb(f) do { } while (0)
 #else /* CONFIG_NO_HOSTAPD_LOGGER */
 void hostapd_logger(void *ctx, const u8 *addr, unsigned int module, int level,
 		    const char *fmt, ...) PRINTF_FORMAT(5, 6);
@@ -298,6 +327,20 @@ typedef void (*hostapd_logger_cb_func)(void *ctx, const u8 *addr,
  * @func: Callback function (%NULL to unregister)
  */
 void hostapd_logger_register_cb(hostapd_logger_cb_func func);
+
+typedef int (*hostapd_logger_filter_func)(void *ctx, unsigned int module,
+					  int level);
+
+/**
+ * hostapd_logger_register_filter_cb - Register filter for hostapd_logger()
+ * @func: Filter function (%NULL to unregister)
+ *
+ * The filter is called before the message is formatted and it returns 0 if
+ * none of the configured log destinations would accept a message for the
+ * specified module and level. Such messages are dropped without formatting
+ * them.
+ */
+void hostapd_logger_register_filter_cb(hostapd_logger_filter_func func);
 #endif /* CONFIG_NO_HOSTAPD_LOGGER */
 
 #define HOSTAPD_MODULE_IEEE80211	0x00000001
@@ -10,6 +10,7 @@
 
 #include "common.h"
 #include "trace.h"
+#include "mem_pool.h"
 #include "wpabuf.h"
 
 #ifdef WPA_TRACE
@@ -26,6 +27,39 @@ static struct wpabuf_trace * wpabuf_get_trace(const struct wpabuf *buf)
 }
 #endif /* WPA_TRACE */
 
+#if defined(CONFIG_MEM_POOL) && !defined(WPA_TRACE)
+#define WPABUF_POOLS
+#endif /* CONFIG_MEM_POOL && !WPA_TRACE */
+
+#ifdef WPABUF_POOLS
+
+/*
+ * Small buffers (most EAPOL, EAP, and RADIUS messages) are allocated from
+ * pools. The pool is selected based on wpabuf::size, which is the requested
+ * length, so it does not need to be stored in the buffer.
+ */
+static const size_t wpabuf_pool_len[] = { 128, 256, 1024 };
+
+static struct mem_pool wpabuf_pools[] = {
+	MEM_POOL_INIT("wpabuf_128", sizeof(struct wpabuf) + 128, 32),
+	MEM_POOL_INIT("wpabuf_256", sizeof(struct wpabuf) + 256, 32),
+	MEM_POOL_INIT("wpabuf_1024", sizeof(struct wpabuf) + 1024, 16),
+};
+
+
+static int wpabuf_pool_idx(size_t len)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(wpabuf_pool_len); i++) {
+		if (len <= wpabuf_pool_len[i])
+			return i;
+	}
+	return -1;
+}
+
+#endif /* WPABUF_POOLS */
+
 
 static void wpabuf_overflow(const struct wpabuf *buf, size_t len)
 {
@@ -74,6 +108,22 @@ int wpabuf_resize(struct wpabuf **_buf, size_t add_len)
 				return -1;
 			os_memset(nbuf + buf->used, 0, add_len);
 			buf->buf = nbuf;
+#ifdef WPABUF_POOLS
+		} else if (buf->flags & WPABUF_FLAG_POOL) {
+			int idx = wpabuf_pool_idx(buf->size);
+			struct wpabuf *n;
+
+			if (buf->used + add_len <= wpabuf_pool_len[idx]) {
+				os_memset(buf->buf + buf->used, 0, add_len);
+			} else {
+				n = wpabuf_alloc(buf->used + add_len);
+				if (n == NULL)
+					return -1;
+				wpabuf_put_buf(n, buf);
+				wpabuf_free(buf);
+				*_buf = buf = n;
+			}
+#endif /* WPABUF_POOLS */
 		} else {
 #ifdef WPA_TRACE
 			nbuf = os_realloc(trace, sizeof(struct wpabuf_trace) +
@@ -121,7 +171,20 @@ struct wpabuf * wpabuf_alloc(size_t len)
 	trace->magic = WPABUF_MAGIC;
 	buf = (struct wpabuf *) (trace + 1);
 #else /* WPA_TRACE */
+#ifdef WPABUF_POOLS
+	int idx = wpabuf_pool_idx(len);
+	struct wpabuf *buf;
+
+	if (idx >= 0) {
+		buf = mem_pool_alloc(&wpabuf_pools[idx]);
+		if (buf)
+			buf->flags = WPABUF_FLAG_POOL;
+	} else {
+		buf = os_zalloc(sizeof(struct wpabuf) + len);
+	}
+#else /* WPABUF_POOLS */
 	struct wpabuf *buf = os_zalloc(sizeof(struct wpabuf) + len);
+#endif /* WPABUF_POOLS */
 	if (buf == NULL)
 		return NULL;
 #endif /* WPA_TRACE */
@@ -198,6 +261,12 @@ void wpabuf_free(struct wpabuf *buf)
 #else /* WPA_TRACE */
 	if (buf == NULL)
 		return;
+#ifdef WPABUF_POOLS
+	if (buf->flags & WPABUF_FLAG_POOL) {
+		mem_pool_free(&wpabuf_pools[wpabuf_pool_idx(buf->size)], buf);
+		return;
+	}
+#endif /* WPABUF_POOLS */
 	if (buf->flags & WPABUF_FLAG_EXT_DATA)
 		os_free(buf->buf);
 	os_free(buf);
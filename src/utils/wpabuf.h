@@ -11,6 +11,8 @@
 
 /* wpabuf::buf is a pointer to external data */
 #define WPABUF_FLAG_EXT_DATA BIT(0)
+/* wpabuf was allocated from one of the small buffer pools */
+#define WPABUF_FLAG_POOL BIT(1)
 
 /*
  * Internal data structure for wpabuf. Please do not touch this directly from
@@ -0,0 +1,1271 @@
+/*
+ * hostapd - In-process control plane load simulator
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+#include <sys/resource.h>
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "utils/list.h"
+#include "utils/mem_pool.h"
+#include "common/ieee802_11_defs.h"
+#include "common/eapol_common.h"
+#include "common/wpa_common.h"
+#include "common/sae.h"
+#include "crypto/sha1.h"
+#include "eap_common/eap_defs.h"
+#include "eap_server/eap_methods.h"
+#include "radius/radius.h"
+#include "radius/radius_client.h"
+#include "drivers/driver.h"
+#include "ap/hostapd.h"
+#include "ap/ap_config.h"
+#include "ap/sta_info.h"
+#include "utils/latency_stats.h"
+
+
+/*
+ * The simulated stations and the AP share a lossless medium: frames from
+ * hostapd are captured by the fake driver below and queued for the station
+ * state machines while frames from the stations are injected through the
+ * same driver event interface (wpa_supplicant_event()) that a real driver
+ * wrapper uses. IEEE 802.1X authentication is forwarded by the RADIUS client
+ * over the loopback interface to a minimal in-process authentication server.
+ */
+
+const struct wpa_driver_ops *const wpa_drivers[] =
+{
+	NULL
+};
+
+enum sim_mode { SIM_PSK, SIM_SAE, SIM_EAP };
+
+/* Connection phases; also used as profile buckets for the AP processing */
+enum sim_phase {
+	SIM_AUTH, SIM_ASSOC, SIM_EAP_AUTH, SIM_4WAY,
+	SIM_NUM_PHASES,
+	SIM_PROF_STA = SIM_NUM_PHASES, SIM_PROF_RADIUS, SIM_PROF_OTHER,
+	SIM_NUM_PROF
+};
+
+static const char * const sim_prof_name[SIM_NUM_PROF] = {
+	"auth", "assoc", "eap", "4-way", "station", "RADIUS server", "other"
+};
+
+enum sim_frame_type {
+	SIM_TO_AP_MGMT, SIM_TO_AP_EAPOL, SIM_TO_STA_MGMT, SIM_TO_STA_EAPOL,
+	SIM_TX_STATUS
+};
+
+struct sim_frame {
+	struct dl_list list;
+	enum sim_frame_type type;
+	struct sim_sta *sta;
+	size_t len;
+	u8 buf[];
+};
+
+enum sim_sta_state {
+	SIM_STA_IDLE, SIM_STA_AUTH, SIM_STA_ASSOC, SIM_STA_EAP, SIM_STA_4WAY,
+	SIM_STA_CONNECTED, SIM_STA_FAILED
+};
+
+struct sim_sta {
+	u8 addr[ETH_ALEN];
+	enum sim_sta_state state;
+	struct os_reltime start, phase_end[SIM_NUM_PHASES];
+	struct sae_data sae;
+	u8 pmk[PMK_LEN];
+	u8 snonce[WPA_NONCE_LEN];
+	struct wpa_ptk ptk;
+};
+
+struct sim_prof {
+	double usec;
+	unsigned long allocs;
+	unsigned long long bytes;
+};
+
+static struct sim_ctx {
+	enum sim_mode mode;
+	int num_sta, concurrency, rounds;
+	struct sim_sta *sta;
+	struct hostapd_data *hapd;
+	struct dl_list queue;
+	int deliver_pending;
+
+	int round, next, in_flight, done;
+	unsigned int connected, failed;
+	struct os_reltime round_start;
+	double round_sec;
+
+	int radius_sock;
+	struct latency_samples latency[SIM_NUM_PHASES + 1];
+} sim;
+
+static struct sim_prof prof[SIM_NUM_PROF];
+static enum sim_phase cur_prof = SIM_PROF_OTHER;
+
+static const u8 bssid[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x03, 0x00 };
+static const char *sim_ssid = "ap-load-sim";
+static const char *sim_passphrase = "12345678";
+static const char *sim_radius_secret = "radius";
+static int sae_groups[] = { 19, 0 };
+static u8 sim_psk[PMK_LEN];
+static u8 sim_msk[2 * PMK_LEN];
+
+#define SIM_STA_TIMEOUT 10
+
+
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t nmemb, size_t size);
+void * __real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void * __wrap_malloc(size_t size)
+{
+	prof[cur_prof].allocs++;
+	prof[cur_prof].bytes += size;
+	return __real_malloc(size);
+}
+
+
+void * __wrap_calloc(size_t nmemb, size_t size)
+{
+	prof[cur_prof].allocs++;
+	prof[cur_prof].bytes += nmemb * size;
+	return __real_calloc(nmemb, size);
+}
+
+
+void * __wrap_realloc(void *ptr, size_t size)
+{
+	prof[cur_prof].allocs++;
+	prof[cur_prof].bytes += size;
+	return __real_realloc(ptr, size);
+}
+
+
+void __wrap_free(void *ptr)
+{
+	__real_free(ptr);
+}
+
+
+static enum sim_phase prof_enter(enum sim_phase p, struct os_reltime *start)
+{
+	enum sim_phase prev = cur_prof;
+
+	cur_prof = p;
+	os_get_reltime(start);
+	return prev;
+}
+
+
+static void prof_leave(enum sim_phase prev, struct os_reltime *start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	prof[cur_prof].usec += diff.sec * 1000000.0 + diff.usec;
+	cur_prof = prev;
+}
+
+
+static double ms_since(struct os_reltime *start, struct os_reltime *end)
+{
+	struct os_reltime diff;
+
+	os_reltime_sub(end, start, &diff);
+	return diff.sec * 1000.0 + diff.usec / 1000.0;
+}
+
+
+static unsigned int usec_since(struct os_reltime *start,
+			       struct os_reltime *end)
+{
+	struct os_reltime diff;
+
+	os_reltime_sub(end, start, &diff);
+	return diff.sec * 1000000 + diff.usec;
+}
+
+
+static struct sim_sta * sim_get_sta(const u8 *addr)
+{
+	u32 idx;
+
+	if (addr[0] != 0x02 || addr[1] != 0x00)
+		return NULL;
+	idx = WPA_GET_BE32(&addr[2]);
+	if (idx < 1 || idx > (u32) sim.num_sta)
+		return NULL;
+	return &sim.sta[idx - 1];
+}
+
+
+static enum sim_phase sim_sta_phase(struct sim_sta *sta)
+{
+	switch (sta->state) {
+	case SIM_STA_AUTH:
+		return SIM_AUTH;
+	case SIM_STA_ASSOC:
+		return SIM_ASSOC;
+	case SIM_STA_EAP:
+		return SIM_EAP_AUTH;
+	case SIM_STA_4WAY:
+		return SIM_4WAY;
+	default:
+		return SIM_PROF_OTHER;
+	}
+}
+
+
+static void sim_deliver(void *eloop_ctx, void *timeout_ctx);
+
+static void sim_queue(enum sim_frame_type type, struct sim_sta *sta,
+		      const u8 *data, size_t len)
+{
+	struct sim_frame *frame;
+
+	frame = os_malloc(sizeof(*frame) + len);
+	if (!frame)
+		return;
+	frame->type = type;
+	frame->sta = sta;
+	frame->len = len;
+	os_memcpy(frame->buf, data, len);
+	dl_list_add_tail(&sim.queue, &frame->list);
+	if (!sim.deliver_pending) {
+		sim.deliver_pending = 1;
+		eloop_register_timeout(0, 0, sim_deliver, NULL, NULL);
+	}
+}
+
+
+/* Fake driver interface */
+
+static struct hostapd_hw_modes * sim_get_hw_feature_data(void *priv,
+							 u16 *num_modes,
+							 u16 *flags, u8 *dfs)
+{
+	struct hostapd_hw_modes *mode;
+	struct hostapd_channel_data *chan;
+	static const int rates[] = { 10, 20, 55, 110 };
+
+	mode = os_zalloc(sizeof(struct hostapd_hw_modes));
+	if (!mode)
+		return NULL;
+
+	mode->mode = HOSTAPD_MODE_IEEE80211G;
+	chan = os_zalloc(sizeof(struct hostapd_channel_data));
+	mode->rates = os_memdup(rates, sizeof(rates));
+	if (!chan || !mode->rates) {
+		os_free(chan);
+		os_free(mode->rates);
+		os_free(mode);
+		return NULL;
+	}
+	chan->chan = 1;
+	chan->freq = 2412;
+	mode->channels = chan;
+	mode->num_channels = 1;
+	mode->num_rates = ARRAY_SIZE(rates);
+
+	*num_modes = 1;
+	*flags = 0;
+	*dfs = 0;
+	return mode;
+}
+
+
+static int sim_send_mlme(void *priv, const u8 *data, size_t data_len,
+			 int noack, unsigned int freq, const u16 *csa_offs,
+			 size_t csa_offs_len)
+{
+	const struct ieee80211_hdr *hdr = (const struct ieee80211_hdr *) data;
+	struct sim_sta *sta;
+
+	if (data_len < IEEE80211_HDRLEN)
+		return -1;
+	sta = sim_get_sta(hdr->addr1);
+	if (!sta)
+		return 0;
+	sim_queue(SIM_TO_STA_MGMT, sta, data, data_len);
+	if (!noack)
+		sim_queue(SIM_TX_STATUS, sta, data, data_len);
+	return 0;
+}
+
+
+static int sim_send_eapol(void *priv, const u8 *addr, const u8 *data,
+			  size_t data_len, int encrypt, const u8 *own_addr,
+			  u32 flags)
+{
+	struct sim_sta *sta;
+
+	sta = sim_get_sta(addr);
+	if (sta)
+		sim_queue(SIM_TO_STA_EAPOL, sta, data, data_len);
+	return 0;
+}
+
+
+static const struct wpa_driver_ops sim_driver = {
+	.name = "ap-load-sim",
+	.get_hw_feature_data = sim_get_hw_feature_data,
+	.send_mlme = sim_send_mlme,
+	.hapd_send_eapol = sim_send_eapol,
+};
+
+
+/* Minimal RADIUS authentication server */
+
+static void sim_radius_receive(int sock, void *eloop_ctx, void *sock_ctx)
+{
+	struct os_reltime start;
+	enum sim_phase prev;
+	struct radius_msg *msg, *reply = NULL;
+	struct radius_hdr *hdr;
+	struct wpabuf *eap = NULL, *buf;
+	struct sockaddr_in from;
+	socklen_t fromlen = sizeof(from);
+	u8 data[3000], success[4];
+	int len;
+
+	prev = prof_enter(SIM_PROF_RADIUS, &start);
+
+	len = recvfrom(sock, data, sizeof(data), 0, (struct sockaddr *) &from,
+		       &fromlen);
+	if (len < 0)
+		goto out;
+	msg = radius_msg_parse_inplace(data, len);
+	if (!msg)
+		goto out;
+	hdr = radius_msg_get_hdr(msg);
+	if (hdr->code != RADIUS_CODE_ACCESS_REQUEST ||
+	    radius_msg_verify_msg_auth(msg, (u8 *) sim_radius_secret,
+				       os_strlen(sim_radius_secret), NULL))
+		goto fail;
+	eap = radius_msg_get_eap(msg);
+	if (!eap || wpabuf_len(eap) < 5)
+		goto fail;
+
+	/* Accept the EAP-Response/Identity with an EAP-Success */
+	reply = radius_msg_new(RADIUS_CODE_ACCESS_ACCEPT, hdr->identifier);
+	if (!reply)
+		goto fail;
+	success[0] = EAP_CODE_SUCCESS;
+	success[1] = wpabuf_head_u8(eap)[1];
+	WPA_PUT_BE16(&success[2], 4);
+	if (!radius_msg_add_eap(reply, success, sizeof(success)) ||
+	    !radius_msg_add_mppe_keys(reply, hdr->authenticator,
+				      (u8 *) sim_radius_secret,
+				      os_strlen(sim_radius_secret),
+				      &sim_msk[PMK_LEN], PMK_LEN,
+				      sim_msk, PMK_LEN) ||
+	    radius_msg_finish_srv(reply, (u8 *) sim_radius_secret,
+				  os_strlen(sim_radius_secret),
+				  hdr->authenticator) < 0)
+		goto fail;
+	buf = radius_msg_get_buf(reply);
+	if (sendto(sock, wpabuf_head(buf), wpabuf_len(buf), 0,
+		   (struct sockaddr *) &from, fromlen) < 0)
+		wpa_printf(MSG_ERROR, "RADIUS: sendto: %s", strerror(errno));
+
+fail:
+	wpabuf_free(eap);
+	radius_msg_free(reply);
+	radius_msg_free(msg);
+out:
+	prof_leave(prev, &start);
+}
+
+
+static int sim_radius_init(struct hostapd_radius_server *srv)
+{
+	struct sockaddr_in addr;
+	socklen_t addrlen = sizeof(addr);
+	int s;
+
+	s = socket(PF_INET, SOCK_DGRAM, 0);
+	if (s < 0)
+		return -1;
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(s, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+	    getsockname(s, (struct sockaddr *) &addr, &addrlen) < 0 ||
+	    eloop_register_read_sock(s, sim_radius_receive, NULL, NULL)) {
+		close(s);
+		return -1;
+	}
+	sim.radius_sock = s;
+
+	srv->addr.af = AF_INET;
+	srv->addr.u.v4.s_addr = htonl(INADDR_LOOPBACK);
+	srv->port = ntohs(addr.sin_port);
+	srv->shared_secret = (u8 *) os_strdup(sim_radius_secret);
+	if (!srv->shared_secret)
+		return -1;
+	srv->shared_secret_len = os_strlen(sim_radius_secret);
+	return 0;
+}
+
+
+/* Simulated stations */
+
+static void sim_sta_done(struct sim_sta *sta, enum sim_sta_state state);
+
+static void sim_to_ap_mgmt(struct sim_sta *sta, u16 stype, struct wpabuf *buf)
+{
+	struct ieee80211_mgmt *mgmt = wpabuf_mhead(buf);
+
+	mgmt->frame_control = IEEE80211_FC(WLAN_FC_TYPE_MGMT, stype);
+	os_memcpy(mgmt->da, bssid, ETH_ALEN);
+	os_memcpy(mgmt->sa, sta->addr, ETH_ALEN);
+	os_memcpy(mgmt->bssid, bssid, ETH_ALEN);
+	sim_queue(SIM_TO_AP_MGMT, sta, wpabuf_head(buf), wpabuf_len(buf));
+}
+
+
+static void sim_sta_send_auth(struct sim_sta *sta, u16 alg, u16 seq,
+			      const struct wpabuf *token)
+{
+	struct ieee80211_mgmt *mgmt;
+	struct wpabuf *buf;
+
+	buf = wpabuf_alloc(IEEE80211_HDRLEN + sizeof(mgmt->u.auth) + 200);
+	if (!buf)
+		return;
+	mgmt = wpabuf_put(buf, IEEE80211_HDRLEN + sizeof(mgmt->u.auth));
+	os_memset(mgmt, 0, IEEE80211_HDRLEN + sizeof(mgmt->u.auth));
+	mgmt->u.auth.auth_alg = host_to_le16(alg);
+	mgmt->u.auth.auth_transaction = host_to_le16(seq);
+	mgmt->u.auth.status_code = host_to_le16(WLAN_STATUS_SUCCESS);
+	if (alg == WLAN_AUTH_SAE && seq == 1)
+		sae_write_commit(&sta->sae, buf, token);
+	else if (alg == WLAN_AUTH_SAE)
+		sae_write_confirm(&sta->sae, buf);
+	sim_to_ap_mgmt(sta, WLAN_FC_STYPE_AUTH, buf);
+	wpabuf_free(buf);
+}
+
+
+static int sim_key_mgmt(void)
+{
+	switch (sim.mode) {
+	case SIM_SAE:
+		return WPA_KEY_MGMT_SAE;
+	case SIM_EAP:
+		return WPA_KEY_MGMT_IEEE8021X;
+	default:
+		return WPA_KEY_MGMT_PSK;
+	}
+}
+
+
+static void sim_put_rsn_ie(struct wpabuf *buf)
+{
+	u8 *pos;
+
+	wpabuf_put_u8(buf, WLAN_EID_RSN);
+	wpabuf_put_u8(buf, 20);
+	wpabuf_put_le16(buf, RSN_VERSION);
+	pos = wpabuf_put(buf, RSN_SELECTOR_LEN);
+	RSN_SELECTOR_PUT(pos, RSN_CIPHER_SUITE_CCMP);
+	wpabuf_put_le16(buf, 1);
+	pos = wpabuf_put(buf, RSN_SELECTOR_LEN);
+	RSN_SELECTOR_PUT(pos, RSN_CIPHER_SUITE_CCMP);
+	wpabuf_put_le16(buf, 1);
+	pos = wpabuf_put(buf, RSN_SELECTOR_LEN);
+	if (sim.mode == SIM_SAE)
+		RSN_SELECTOR_PUT(pos, RSN_AUTH_KEY_MGMT_SAE);
+	else if (sim.mode == SIM_EAP)
+		RSN_SELECTOR_PUT(pos, RSN_AUTH_KEY_MGMT_UNSPEC_802_1X);
+	else
+		RSN_SELECTOR_PUT(pos, RSN_AUTH_KEY_MGMT_PSK_OVER_802_1X);
+	wpabuf_put_le16(buf, 0);
+}
+
+
+static void sim_sta_send_assoc(struct sim_sta *sta)
+{
+	struct ieee80211_mgmt *mgmt;
+	struct wpabuf *buf;
+	static const u8 rates[] = { 0x82, 0x84, 0x8b, 0x96 };
+
+	buf = wpabuf_alloc(IEEE80211_HDRLEN + sizeof(mgmt->u.assoc_req) + 100);
+	if (!buf)
+		return;
+	mgmt = wpabuf_put(buf, IEEE80211_HDRLEN + sizeof(mgmt->u.assoc_req));
+	os_memset(mgmt, 0, IEEE80211_HDRLEN + sizeof(mgmt->u.assoc_req));
+	mgmt->u.assoc_req.capab_info = host_to_le16(WLAN_CAPABILITY_ESS |
+						    WLAN_CAPABILITY_PRIVACY);
+	mgmt->u.assoc_req.listen_interval = host_to_le16(10);
+	wpabuf_put_u8(buf, WLAN_EID_SSID);
+	wpabuf_put_u8(buf, os_strlen(sim_ssid));
+	wpabuf_put_str(buf, sim_ssid);
+	wpabuf_put_u8(buf, WLAN_EID_SUPP_RATES);
+	wpabuf_put_u8(buf, sizeof(rates));
+	wpabuf_put_data(buf, rates, sizeof(rates));
+	sim_put_rsn_ie(buf);
+	sim_to_ap_mgmt(sta, WLAN_FC_STYPE_ASSOC_REQ, buf);
+	wpabuf_free(buf);
+}
+
+
+static void sim_sta_phase_done(struct sim_sta *sta, enum sim_phase phase,
+			       enum sim_sta_state next)
+{
+	os_get_reltime(&sta->phase_end[phase]);
+	sta->state = next;
+}
+
+
+static void sim_sta_rx_auth(struct sim_sta *sta,
+			    const struct ieee80211_mgmt *mgmt, size_t len)
+{
+	u16 alg, seq, status;
+	const u8 *pos, *end;
+	struct wpabuf *token;
+
+	if (len < IEEE80211_HDRLEN + sizeof(mgmt->u.auth) ||
+	    sta->state != SIM_STA_AUTH) {
+		sim_sta_done(sta, SIM_STA_FAILED);
+		return;
+	}
+	alg = le_to_host16(mgmt->u.auth.auth_alg);
+	seq = le_to_host16(mgmt->u.auth.auth_transaction);
+	status = le_to_host16(mgmt->u.auth.status_code);
+	pos = mgmt->u.auth.variable;
+	end = ((const u8 *) mgmt) + len;
+
+	if (alg == WLAN_AUTH_SAE && seq == 1 &&
+	    status == WLAN_STATUS_ANTI_CLOGGING_TOKEN_REQ && end - pos >= 2) {
+		/* Retry the Commit with the token after the Group field */
+		token = wpabuf_alloc_copy(pos + 2, end - pos - 2);
+		if (token)
+			sim_sta_send_auth(sta, WLAN_AUTH_SAE, 1, token);
+		wpabuf_free(token);
+		return;
+	}
+
+	if (status != WLAN_STATUS_SUCCESS) {
+		sim_sta_done(sta, SIM_STA_FAILED);
+		return;
+	}
+
+	if (alg == WLAN_AUTH_OPEN && sim.mode != SIM_SAE) {
+		sim_sta_phase_done(sta, SIM_AUTH, SIM_STA_ASSOC);
+		sim_sta_send_assoc(sta);
+	} else if (alg == WLAN_AUTH_SAE && seq == 1 &&
+		   sta->sae.state == SAE_COMMITTED) {
+		if (sae_parse_commit(&sta->sae, pos, end - pos, NULL, NULL,
+				     sae_groups) != WLAN_STATUS_SUCCESS ||
+		    sae_process_commit(&sta->sae) < 0) {
+			sim_sta_done(sta, SIM_STA_FAILED);
+			return;
+		}
+		sta->sae.state = SAE_CONFIRMED;
+		sim_sta_send_auth(sta, WLAN_AUTH_SAE, 2, NULL);
+	} else if (alg == WLAN_AUTH_SAE && seq == 2 &&
+		   sta->sae.state == SAE_CONFIRMED) {
+		if (sae_check_confirm(&sta->sae, pos, end - pos) < 0) {
+			sim_sta_done(sta, SIM_STA_FAILED);
+			return;
+		}
+		sta->sae.state = SAE_ACCEPTED;
+		os_memcpy(sta->pmk, sta->sae.pmk, PMK_LEN);
+		sae_clear_temp_data(&sta->sae);
+		sim_sta_phase_done(sta, SIM_AUTH, SIM_STA_ASSOC);
+		sim_sta_send_assoc(sta);
+	} else {
+		sim_sta_done(sta, SIM_STA_FAILED);
+	}
+}
+
+
+static void sim_sta_rx_mgmt(struct sim_sta *sta, const u8 *buf, size_t len)
+{
+	const struct ieee80211_mgmt *mgmt;
+	u16 fc;
+
+	mgmt = (const struct ieee80211_mgmt *) buf;
+	fc = le_to_host16(mgmt->frame_control);
+	if (WLAN_FC_GET_TYPE(fc) != WLAN_FC_TYPE_MGMT)
+		return;
+
+	switch (WLAN_FC_GET_STYPE(fc)) {
+	case WLAN_FC_STYPE_AUTH:
+		sim_sta_rx_auth(sta, mgmt, len);
+		break;
+	case WLAN_FC_STYPE_ASSOC_RESP:
+		if (len < IEEE80211_HDRLEN + sizeof(mgmt->u.assoc_resp) ||
+		    sta->state != SIM_STA_ASSOC ||
+		    le_to_host16(mgmt->u.assoc_resp.status_code) !=
+		    WLAN_STATUS_SUCCESS) {
+			sim_sta_done(sta, SIM_STA_FAILED);
+			break;
+		}
+		sim_sta_phase_done(sta, SIM_ASSOC, sim.mode == SIM_EAP ?
+				   SIM_STA_EAP : SIM_STA_4WAY);
+		break;
+	case WLAN_FC_STYPE_DEAUTH:
+	case WLAN_FC_STYPE_DISASSOC:
+		if (sta->state != SIM_STA_IDLE)
+			sim_sta_done(sta, SIM_STA_FAILED);
+		break;
+	}
+}
+
+
+static void sim_sta_rx_eap(struct sim_sta *sta, const u8 *buf, size_t len)
+{
+	struct ieee802_1x_hdr *hdr;
+	u8 resp[sizeof(*hdr) + 5 + 20];
+	int id_len;
+
+	if (len < 4 || sta->state != SIM_STA_EAP)
+		return;
+
+	if (buf[0] == EAP_CODE_SUCCESS) {
+		os_memcpy(sta->pmk, sim_msk, PMK_LEN);
+		sim_sta_phase_done(sta, SIM_EAP_AUTH, SIM_STA_4WAY);
+		return;
+	}
+	if (len < 5 || buf[0] != EAP_CODE_REQUEST ||
+	    buf[4] != EAP_TYPE_IDENTITY)
+		return;
+
+	hdr = (struct ieee802_1x_hdr *) resp;
+	id_len = os_snprintf((char *) &resp[sizeof(*hdr) + 5], 20, "sim-%d",
+			     (int) (sta - sim.sta));
+	hdr->version = EAPOL_VERSION;
+	hdr->type = IEEE802_1X_TYPE_EAP_PACKET;
+	hdr->length = host_to_be16(5 + id_len);
+	resp[sizeof(*hdr)] = EAP_CODE_RESPONSE;
+	resp[sizeof(*hdr) + 1] = buf[1];
+	WPA_PUT_BE16(&resp[sizeof(*hdr) + 2], 5 + id_len);
+	resp[sizeof(*hdr) + 4] = EAP_TYPE_IDENTITY;
+	sim_queue(SIM_TO_AP_EAPOL, sta, resp, sizeof(*hdr) + 5 + id_len);
+}
+
+
+static void sim_sta_send_key(struct sim_sta *sta,
+			     const struct wpa_eapol_key *req, u16 key_info,
+			     int msg2)
+{
+	struct ieee802_1x_hdr *hdr;
+	struct wpa_eapol_key *key;
+	struct wpabuf *buf;
+	size_t mic_len = wpa_mic_len(sim_key_mgmt(), PMK_LEN);
+	u8 *mic;
+
+	buf = wpabuf_alloc(sizeof(*hdr) + sizeof(*key) + mic_len + 2 + 22);
+	if (!buf)
+		return;
+	hdr = wpabuf_put(buf, sizeof(*hdr));
+	key = wpabuf_put(buf, sizeof(*key));
+	os_memset(key, 0, sizeof(*key));
+	mic = wpabuf_put(buf, mic_len);
+	os_memset(mic, 0, mic_len);
+
+	key->type = EAPOL_KEY_TYPE_RSN;
+	WPA_PUT_BE16(key->key_info, key_info);
+	os_memcpy(key->replay_counter, req->replay_counter,
+		  WPA_REPLAY_COUNTER_LEN);
+	if (msg2) {
+		os_memcpy(key->key_nonce, sta->snonce, WPA_NONCE_LEN);
+		wpabuf_put_be16(buf, 22);
+		sim_put_rsn_ie(buf);
+	} else {
+		wpabuf_put_be16(buf, 0);
+	}
+
+	hdr->version = EAPOL_VERSION;
+	hdr->type = IEEE802_1X_TYPE_EAPOL_KEY;
+	hdr->length = host_to_be16(wpabuf_len(buf) - sizeof(*hdr));
+	wpa_eapol_key_mic(sta->ptk.kck, sta->ptk.kck_len, sim_key_mgmt(),
+			  key_info & WPA_KEY_INFO_TYPE_MASK,
+			  wpabuf_head(buf), wpabuf_len(buf), mic);
+	sim_queue(SIM_TO_AP_EAPOL, sta, wpabuf_head(buf), wpabuf_len(buf));
+	wpabuf_free(buf);
+}
+
+
+static void sim_sta_rx_key(struct sim_sta *sta, const u8 *buf, size_t len)
+{
+	const struct wpa_eapol_key *key;
+	size_t mic_len = wpa_mic_len(sim_key_mgmt(), PMK_LEN);
+	u8 *tmp, *mic, calc[WPA_EAPOL_KEY_MIC_MAX_LEN];
+	u16 key_info, ver;
+
+	if (sta->state != SIM_STA_4WAY ||
+	    len < sizeof(struct ieee802_1x_hdr) + sizeof(*key) + mic_len + 2)
+		return;
+	key = (const struct wpa_eapol_key *)
+		(buf + sizeof(struct ieee802_1x_hdr));
+	key_info = WPA_GET_BE16(key->key_info);
+	ver = key_info & WPA_KEY_INFO_TYPE_MASK;
+	if (!(key_info & WPA_KEY_INFO_KEY_TYPE) ||
+	    !(key_info & WPA_KEY_INFO_ACK))
+		return;
+
+	if (!(key_info & WPA_KEY_INFO_MIC)) {
+		/* Message 1/4 */
+		if (os_get_random(sta->snonce, WPA_NONCE_LEN) < 0 ||
+		    wpa_pmk_to_ptk(sta->pmk, PMK_LEN, "Pairwise key expansion",
+				   sta->addr, bssid, sta->snonce,
+				   key->key_nonce, &sta->ptk, sim_key_mgmt(),
+				   WPA_CIPHER_CCMP) < 0) {
+			sim_sta_done(sta, SIM_STA_FAILED);
+			return;
+		}
+		sim_sta_send_key(sta, key, ver | WPA_KEY_INFO_KEY_TYPE |
+				 WPA_KEY_INFO_MIC, 1);
+		return;
+	}
+
+	/* Message 3/4 */
+	tmp = os_memdup(buf, len);
+	if (!tmp)
+		return;
+	mic = tmp + sizeof(struct ieee802_1x_hdr) + sizeof(*key);
+	os_memset(mic, 0, mic_len);
+	if (wpa_eapol_key_mic(sta->ptk.kck, sta->ptk.kck_len, sim_key_mgmt(),
+			      ver, tmp, len, calc) < 0 ||
+	    os_memcmp_const(calc, buf + sizeof(struct ieee802_1x_hdr) +
+			    sizeof(*key), mic_len) != 0) {
+		os_free(tmp);
+		sim_sta_done(sta, SIM_STA_FAILED);
+		return;
+	}
+	os_free(tmp);
+	sim_sta_send_key(sta, key, ver | WPA_KEY_INFO_KEY_TYPE |
+			 WPA_KEY_INFO_MIC | WPA_KEY_INFO_SECURE, 0);
+}
+
+
+static void sim_sta_rx_eapol(struct sim_sta *sta, const u8 *buf, size_t len)
+{
+	const struct ieee802_1x_hdr *hdr;
+
+	if (len < sizeof(*hdr))
+		return;
+	hdr = (const struct ieee802_1x_hdr *) buf;
+	if (be_to_host16(hdr->length) > len - sizeof(*hdr))
+		return;
+	len = sizeof(*hdr) + be_to_host16(hdr->length);
+
+	if (hdr->type == IEEE802_1X_TYPE_EAP_PACKET)
+		sim_sta_rx_eap(sta, (const u8 *) (hdr + 1), len - sizeof(*hdr));
+	else if (hdr->type == IEEE802_1X_TYPE_EAPOL_KEY)
+		sim_sta_rx_key(sta, buf, len);
+}
+
+
+static void sim_sta_authorized(void *ctx, const u8 *mac_addr, int authorized,
+			       const u8 *p2p_dev_addr)
+{
+	struct sim_sta *sta = sim_get_sta(mac_addr);
+
+	if (!sta || !authorized || sta->state != SIM_STA_4WAY)
+		return;
+	os_get_reltime(&sta->phase_end[SIM_4WAY]);
+	sim_sta_done(sta, SIM_STA_CONNECTED);
+}
+
+
+static void sim_deliver(void *eloop_ctx, void *timeout_ctx)
+{
+	struct sim_frame *frame;
+	union wpa_event_data event;
+	struct os_reltime start;
+	enum sim_phase prev;
+	const struct ieee80211_hdr *hdr;
+
+	sim.deliver_pending = 0;
+	while ((frame = dl_list_first(&sim.queue, struct sim_frame, list))) {
+		dl_list_del(&frame->list);
+
+		if (frame->type == SIM_TO_STA_MGMT ||
+		    frame->type == SIM_TO_STA_EAPOL) {
+			prev = prof_enter(SIM_PROF_STA, &start);
+			if (frame->type == SIM_TO_STA_MGMT)
+				sim_sta_rx_mgmt(frame->sta, frame->buf,
+						frame->len);
+			else
+				sim_sta_rx_eapol(frame->sta, frame->buf,
+						 frame->len);
+			prof_leave(prev, &start);
+			os_free(frame);
+			continue;
+		}
+
+		os_memset(&event, 0, sizeof(event));
+		prev = prof_enter(sim_sta_phase(frame->sta), &start);
+		switch (frame->type) {
+		case SIM_TO_AP_MGMT:
+			event.rx_mgmt.frame = frame->buf;
+			event.rx_mgmt.frame_len = frame->len;
+			event.rx_mgmt.freq = 2412;
+			wpa_supplicant_event(sim.hapd, EVENT_RX_MGMT, &event);
+			break;
+		case SIM_TO_AP_EAPOL:
+			event.eapol_rx.src = frame->sta->addr;
+			event.eapol_rx.data = frame->buf;
+			event.eapol_rx.data_len = frame->len;
+			wpa_supplicant_event(sim.hapd, EVENT_EAPOL_RX, &event);
+			break;
+		case SIM_TX_STATUS:
+			hdr = (const struct ieee80211_hdr *) frame->buf;
+			event.tx_status.type = WLAN_FC_TYPE_MGMT;
+			event.tx_status.stype =
+				WLAN_FC_GET_STYPE(le_to_host16(hdr->frame_control));
+			event.tx_status.dst = hdr->addr1;
+			event.tx_status.data = frame->buf;
+			event.tx_status.data_len = frame->len;
+			event.tx_status.ack = 1;
+			wpa_supplicant_event(sim.hapd, EVENT_TX_STATUS, &event);
+			break;
+		default:
+			break;
+		}
+		prof_leave(prev, &start);
+		os_free(frame);
+	}
+}
+
+
+static void sim_sta_timeout(void *eloop_ctx, void *timeout_ctx)
+{
+	struct sim_sta *sta = eloop_ctx;
+
+	wpa_printf(MSG_INFO, "Station " MACSTR " timed out in state %d",
+		   MAC2STR(sta->addr), sta->state);
+	sim_sta_done(sta, SIM_STA_FAILED);
+}
+
+
+static void sim_sta_start(struct sim_sta *sta)
+{
+	struct os_reltime start;
+	enum sim_phase prev;
+
+	sta->state = SIM_STA_AUTH;
+	os_get_reltime(&sta->start);
+	eloop_register_timeout(SIM_STA_TIMEOUT, 0, sim_sta_timeout, sta, NULL);
+	sim.in_flight++;
+
+	prev = prof_enter(SIM_PROF_STA, &start);
+	if (sim.mode == SIM_SAE) {
+		sae_clear_data(&sta->sae);
+		if (sae_set_group(&sta->sae, sae_groups[0]) < 0 ||
+		    sae_prepare_commit(sta->addr, bssid,
+				       (const u8 *) sim_passphrase,
+				       os_strlen(sim_passphrase),
+				       &sta->sae) < 0) {
+			prof_leave(prev, &start);
+			sim_sta_done(sta, SIM_STA_FAILED);
+			return;
+		}
+		sta->sae.state = SAE_COMMITTED;
+		sim_sta_send_auth(sta, WLAN_AUTH_SAE, 1, NULL);
+	} else {
+		if (sim.mode == SIM_PSK)
+			os_memcpy(sta->pmk, sim_psk, PMK_LEN);
+		sim_sta_send_auth(sta, WLAN_AUTH_OPEN, 1, NULL);
+	}
+	prof_leave(prev, &start);
+}
+
+
+static void sim_round_end(void *eloop_ctx, void *timeout_ctx);
+
+static void sim_start_stations(void *eloop_ctx, void *timeout_ctx)
+{
+	while (sim.in_flight < sim.concurrency && sim.next < sim.num_sta)
+		sim_sta_start(&sim.sta[sim.next++]);
+}
+
+
+static void sim_sta_done(struct sim_sta *sta, enum sim_sta_state state)
+{
+	int i;
+
+	if (sta->state == SIM_STA_CONNECTED || sta->state == SIM_STA_FAILED ||
+	    sta->state == SIM_STA_IDLE)
+		return;
+	eloop_cancel_timeout(sim_sta_timeout, sta, NULL);
+	sta->state = state;
+	sim.in_flight--;
+	sim.done++;
+
+	if (state == SIM_STA_CONNECTED) {
+		struct os_reltime *prev = &sta->start;
+
+		for (i = 0; i < SIM_NUM_PHASES; i++) {
+			if (i == SIM_EAP_AUTH && sim.mode != SIM_EAP)
+				continue;
+			latency_samples_add(&sim.latency[i],
+					    usec_since(prev,
+						       &sta->phase_end[i]));
+			prev = &sta->phase_end[i];
+		}
+		latency_samples_add(&sim.latency[SIM_NUM_PHASES],
+				    usec_since(&sta->start,
+					       &sta->phase_end[SIM_4WAY]));
+		sim.connected++;
+	} else {
+		sim.failed++;
+	}
+
+	if (sim.done == sim.num_sta) {
+		os_get_reltime(&sta->start);
+		sim.round_sec = ms_since(&sim.round_start, &sta->start) /
+			1000.0;
+		eloop_register_timeout(0, 0, sim_round_end, NULL, NULL);
+	} else if (!eloop_is_timeout_registered(sim_start_stations, NULL,
+						NULL)) {
+		eloop_register_timeout(0, 0, sim_start_stations, NULL, NULL);
+	}
+}
+
+
+static void sim_round_start(void)
+{
+	sim.next = 0;
+	sim.done = 0;
+	sim.in_flight = 0;
+	os_get_reltime(&sim.round_start);
+	sim_start_stations(NULL, NULL);
+}
+
+
+static void sim_round_end(void *eloop_ctx, void *timeout_ctx)
+{
+	struct ieee80211_mgmt *mgmt;
+	struct wpabuf *buf;
+	int i, ok = 0;
+
+	for (i = 0; i < sim.num_sta; i++) {
+		struct sim_sta *sta = &sim.sta[i];
+
+		if (sta->state == SIM_STA_CONNECTED)
+			ok++;
+		sta->state = SIM_STA_IDLE;
+
+		/* Tear down the association for the next round */
+		buf = wpabuf_alloc(IEEE80211_HDRLEN + sizeof(mgmt->u.deauth));
+		if (!buf)
+			continue;
+		mgmt = wpabuf_put(buf, IEEE80211_HDRLEN +
+				  sizeof(mgmt->u.deauth));
+		os_memset(mgmt, 0, wpabuf_len(buf));
+		mgmt->u.deauth.reason_code =
+			host_to_le16(WLAN_REASON_DEAUTH_LEAVING);
+		sim_to_ap_mgmt(sta, WLAN_FC_STYPE_DEAUTH, buf);
+		wpabuf_free(buf);
+	}
+	sim_deliver(NULL, NULL);
+
+	printf("round %d: %d/%d connected in %.3f ms (%.1f conn/s)\n",
+	       sim.round, ok, sim.num_sta, sim.round_sec * 1000.0,
+	       sim.round_sec > 0 ? ok / sim.round_sec : 0.0);
+
+	if (++sim.round < sim.rounds)
+		sim_round_start();
+	else
+		eloop_terminate();
+}
+
+
+/* Process startup and reporting */
+
+static struct hostapd_config * sim_config_read(const char *config_fname)
+{
+	struct hostapd_config *conf;
+	struct hostapd_bss_config *bss;
+
+	conf = hostapd_config_defaults();
+	if (!conf)
+		return NULL;
+	conf->hw_mode = HOSTAPD_MODE_IEEE80211G;
+	conf->channel = 1;
+
+	bss = conf->bss[0];
+	os_strlcpy(bss->iface, "sim0", sizeof(bss->iface));
+	os_memcpy(bss->ssid.ssid, sim_ssid, os_strlen(sim_ssid));
+	bss->ssid.ssid_len = os_strlen(sim_ssid);
+	bss->ssid.ssid_set = 1;
+	bss->wpa = 2;
+	bss->rsn_pairwise = WPA_CIPHER_CCMP;
+	bss->wpa_key_mgmt = sim_key_mgmt();
+
+	if (sim.mode == SIM_EAP) {
+		struct hostapd_radius_server *srv;
+
+		bss->ieee802_1x = 1;
+		srv = os_zalloc(sizeof(*srv));
+		if (!srv || sim_radius_init(srv) < 0) {
+			if (srv)
+				os_free(srv->shared_secret);
+			os_free(srv);
+			hostapd_config_free(conf);
+			return NULL;
+		}
+		bss->radius->auth_servers = srv;
+		bss->radius->auth_server = srv;
+		bss->radius->num_auth_servers = 1;
+		bss->own_ip_addr.af = AF_INET;
+		bss->own_ip_addr.u.v4.s_addr = htonl(INADDR_LOOPBACK);
+	} else {
+		bss->ssid.wpa_passphrase = os_strdup(sim_passphrase);
+		if (!bss->ssid.wpa_passphrase) {
+			hostapd_config_free(conf);
+			return NULL;
+		}
+		bss->ssid.wpa_passphrase_set = 1;
+	}
+
+	hostapd_set_security_params(bss, 1);
+	return conf;
+}
+
+
+static void sim_report(double cpu_sec, double wall_sec)
+{
+	static const char * const lat_name[SIM_NUM_PHASES + 1] = {
+		"auth", "assoc", "eap", "4-way", "total"
+	};
+	struct latency_samples *lat;
+	double other;
+	int i;
+
+	printf("connections: %u ok, %u failed, %.1f conn/s\n",
+	       sim.connected, sim.failed,
+	       wall_sec > 0 ? sim.connected / wall_sec : 0.0);
+
+	printf("latency (ms)         p50       p95       p99       max\n");
+	for (i = 0; i <= SIM_NUM_PHASES; i++) {
+		if (i == SIM_EAP_AUTH && sim.mode != SIM_EAP)
+			continue;
+		lat = &sim.latency[i];
+		latency_samples_sort(lat);
+		printf("  %-12s %9.3f %9.3f %9.3f %9.3f\n", lat_name[i],
+		       latency_samples_percentile(lat, 50) / 1000.0,
+		       latency_samples_percentile(lat, 95) / 1000.0,
+		       latency_samples_percentile(lat, 99) / 1000.0,
+		       latency_samples_percentile(lat, 100) / 1000.0);
+	}
+	latency_samples_print("connection latency",
+			      &sim.latency[SIM_NUM_PHASES]);
+
+	printf("CPU: %.3f s total, %.3f ms/connection\n", cpu_sec,
+	       sim.connected ? cpu_sec * 1000.0 / sim.connected : 0.0);
+
+	/* Time not spent in the instrumented handlers (timers, RADIUS client) */
+	other = wall_sec * 1000000.0;
+	for (i = 0; i < SIM_NUM_PROF; i++) {
+		if (i != SIM_PROF_OTHER)
+			other -= prof[i].usec;
+	}
+	prof[SIM_PROF_OTHER].usec = other > 0 ? other : 0;
+
+	printf("profile              ms/conn  allocs/conn   bytes/conn\n");
+	for (i = 0; i < SIM_NUM_PROF; i++) {
+		double conns = sim.connected ? sim.connected : 1;
+
+		if (i == SIM_EAP_AUTH && sim.mode != SIM_EAP)
+			continue;
+		if (i == SIM_PROF_RADIUS && sim.mode != SIM_EAP)
+			continue;
+		printf("  %-16s %9.3f %12.1f %12.0f\n", sim_prof_name[i],
+		       prof[i].usec / 1000.0 / conns, prof[i].allocs / conns,
+		       prof[i].bytes / conns);
+	}
+
+#ifdef CONFIG_MEM_POOL
+	{
+		char buf[2000];
+
+		if (mem_pool_stats_get(buf, sizeof(buf)) > 0)
+			printf("memory pools:\n%s", buf);
+	}
+#endif /* CONFIG_MEM_POOL */
+}
+
+
+static double rusage_sec(void)
+{
+	struct rusage ru;
+
+	if (getrusage(RUSAGE_SELF, &ru) < 0)
+		return 0;
+	return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0 +
+		ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+}
+
+
+static void usage(void)
+{
+	printf("usage: ap-load-sim [-m<psk|sae|eap>] [-n<stations>] "
+	       "[-c<concurrency>] [-r<rounds>] [-d]\n"
+	       "\n"
+	       "  -m = authentication mode (default: psk)\n"
+	       "  -n = number of simulated stations (default: 100)\n"
+	       "  -c = number of connections in progress at a time "
+	       "(default: 10)\n"
+	       "  -r = number of rounds; all stations are disconnected "
+	       "between rounds\n"
+	       "       (default: 1)\n"
+	       "  -d = show hostapd debug output\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct hapd_interfaces interfaces;
+	struct hostapd_iface *iface = NULL;
+	struct sim_frame *frame;
+	struct os_reltime start;
+	double cpu, wall;
+	int c, i, debug = 0, ret = -1;
+
+	os_memset(&sim, 0, sizeof(sim));
+	sim.num_sta = 100;
+	sim.concurrency = 10;
+	sim.rounds = 1;
+	sim.radius_sock = -1;
+	dl_list_init(&sim.queue);
+
+	for (;;) {
+		c = getopt(argc, argv, "c:dhm:n:r:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'c':
+			sim.concurrency = atoi(optarg);
+			break;
+		case 'd':
+			debug++;
+			break;
+		case 'm':
+			if (os_strcmp(optarg, "psk") == 0) {
+				sim.mode = SIM_PSK;
+			} else if (os_strcmp(optarg, "sae") == 0) {
+				sim.mode = SIM_SAE;
+			} else if (os_strcmp(optarg, "eap") == 0) {
+				sim.mode = SIM_EAP;
+			} else {
+				usage();
+				return -1;
+			}
+			break;
+		case 'n':
+			sim.num_sta = atoi(optarg);
+			break;
+		case 'r':
+			sim.rounds = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (sim.num_sta < 1 || sim.num_sta > MAX_STA_COUNT ||
+	    sim.concurrency < 1 || sim.rounds < 1) {
+		usage();
+		return -1;
+	}
+
+	if (os_program_init())
+		return -1;
+	wpa_debug_level = debug ? MSG_DEBUG : MSG_ERROR + 1;
+	if (eloop_init())
+		return -1;
+	/* The identity round is handled locally before forwarding to RADIUS */
+	if (eap_server_identity_register())
+		goto fail;
+
+	sim.sta = os_calloc(sim.num_sta, sizeof(struct sim_sta));
+	if (!sim.sta)
+		goto fail;
+	for (i = 0; i < sim.num_sta; i++) {
+		sim.sta[i].addr[0] = 0x02;
+		WPA_PUT_BE32(&sim.sta[i].addr[2], i + 1);
+	}
+	if (pbkdf2_sha1(sim_passphrase, (const u8 *) sim_ssid,
+			os_strlen(sim_ssid), 4096, sim_psk, PMK_LEN) < 0 ||
+	    os_get_random(sim_msk, sizeof(sim_msk)) < 0)
+		goto fail;
+
+	os_memset(&interfaces, 0, sizeof(interfaces));
+	interfaces.config_read_cb = sim_config_read;
+	interfaces.count = 1;
+	interfaces.iface = &iface;
+	iface = hostapd_init(&interfaces, "ap-load-sim");
+	if (!iface) {
+		printf("Failed to initialize the AP\n");
+		goto fail;
+	}
+	iface->interfaces = &interfaces;
+	sim.hapd = iface->bss[0];
+	sim.hapd->driver = &sim_driver;
+	sim.hapd->drv_priv = &sim;
+	sim.hapd->sta_authorized_cb = sim_sta_authorized;
+	os_memcpy(sim.hapd->own_addr, bssid, ETH_ALEN);
+	if (hostapd_setup_interface(iface) < 0 ||
+	    iface->state != HAPD_IFACE_ENABLED) {
+		printf("Failed to set up the AP\n");
+		goto fail;
+	}
+
+	printf("mode=%s stations=%d concurrency=%d rounds=%d\n",
+	       sim.mode == SIM_SAE ? "sae" :
+	       sim.mode == SIM_EAP ? "eap" : "psk",
+	       sim.num_sta, sim.concurrency, sim.rounds);
+
+	os_memset(prof, 0, sizeof(prof));
+	cpu = rusage_sec();
+	os_get_reltime(&start);
+	sim_round_start();
+	eloop_run();
+	os_get_reltime(&sim.round_start);
+	wall = ms_since(&start, &sim.round_start) / 1000.0;
+	cpu = rusage_sec() - cpu;
+	sim_report(cpu, wall);
+
+	ret = sim.failed ? -1 : 0;
+fail:
+	if (iface)
+		hostapd_interface_deinit_free(iface);
+	if (sim.radius_sock >= 0) {
+		eloop_unregister_read_sock(sim.radius_sock);
+		close(sim.radius_sock);
+	}
+	eloop_cancel_timeout(sim_deliver, NULL, NULL);
+	while ((frame = dl_list_first(&sim.queue, struct sim_frame, list))) {
+		dl_list_del(&frame->list);
+		os_free(frame);
+	}
+	for (i = 0; sim.sta && i < sim.num_sta; i++)
+		sae_clear_data(&sim.sta[i].sae);
+	os_free(sim.sta);
+	for (i = 0; i <= SIM_NUM_PHASES; i++)
+		latency_samples_free(&sim.latency[i]);
+	eap_server_unregister_methods();
+	eloop_destroy();
+	os_program_deinit();
+
+	return ret;
+}
@@ -0,0 +1,210 @@
+/*
+ * wpa_supplicant - BSS selection benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "common/ieee802_11_defs.h"
+#include "../../wpa_supplicant/config.h"
+#include "../../wpa_supplicant/wpa_supplicant_i.h"
+#include "../../wpa_supplicant/bss.h"
+
+
+static struct wpa_scan_res * bench_res(unsigned int i, const char *ssid)
+{
+	/* RSN: CCMP/CCMP/PSK */
+	static const u8 rsn[] = {
+		WLAN_EID_RSN, 20, 0x01, 0x00, 0x00, 0x0f, 0xac, 0x04,
+		0x01, 0x00, 0x00, 0x0f, 0xac, 0x04,
+		0x01, 0x00, 0x00, 0x0f, 0xac, 0x02, 0x00, 0x00
+	};
+	struct wpa_scan_res *res;
+	size_t ssid_len = os_strlen(ssid);
+	u8 *pos;
+
+	res = os_zalloc(sizeof(*res) + 2 + ssid_len + 10 + sizeof(rsn));
+	if (!res)
+		return NULL;
+	os_memcpy(res->bssid, "\x02\x00\x00\x00\x00\x00", ETH_ALEN);
+	res->bssid[4] = i >> 8;
+	res->bssid[5] = i & 0xff;
+	res->freq = 2412;
+	res->caps = IEEE80211_CAP_ESS | IEEE80211_CAP_PRIVACY;
+	res->level = -50;
+	pos = (u8 *) (res + 1);
+	*pos++ = WLAN_EID_SSID;
+	*pos++ = ssid_len;
+	os_memcpy(pos, ssid, ssid_len);
+	pos += ssid_len;
+	*pos++ = WLAN_EID_SUPP_RATES;
+	*pos++ = 8;
+	os_memcpy(pos, "\x82\x84\x8b\x96\x0c\x12\x18\x24", 8);
+	pos += 8;
+	os_memcpy(pos, rsn, sizeof(rsn));
+	pos += sizeof(rsn);
+	res->ie_len = pos - (u8 *) (res + 1);
+	return res;
+}
+
+
+static unsigned int bench_usec(struct os_reltime *start)
+{
+	struct os_reltime age;
+
+	os_reltime_age(start, &age);
+	return age.sec * 1000000 + age.usec;
+}
+
+
+static void usage(void)
+{
+	printf("usage: bss-select-bench [-b<BSSes>] [-n<networks>] "
+	       "[-r<rounds>]\n"
+	       "\n"
+	       "Only the last BSS matches a network (the last one). Debug "
+	       "messages are\n"
+	       "formatted, but not written, as done by wpa_supplicant "
+	       "without -d.\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct wpa_supplicant wpa_s;
+	struct wpa_config *conf;
+	struct wpa_global global;
+	struct wpa_radio radio;
+	struct wpa_ssid *ssid, *full_ssid = NULL, *sel_ssid = NULL;
+	struct wpa_bss *full_bss = NULL, *sel_bss = NULL;
+	struct os_reltime start, now;
+	unsigned int num_bss = 500, num_networks = 200, rounds = 10;
+	unsigned int i, r, full_usec = 0, sel_usec = 0, usec;
+	char buf[40];
+	int c, ret = -1;
+
+	for (;;) {
+		c = getopt(argc, argv, "b:hn:r:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'b':
+			num_bss = atoi(optarg);
+			break;
+		case 'n':
+			num_networks = atoi(optarg);
+			break;
+		case 'r':
+			rounds = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (num_bss < 1 || num_bss > 65536 || num_networks < 1 ||
+	    rounds < 1) {
+		usage();
+		return -1;
+	}
+
+	if (os_program_init())
+		return -1;
+
+	wpa_debug_level = MSG_INFO;
+
+	os_memset(&wpa_s, 0, sizeof(wpa_s));
+	os_memset(&global, 0, sizeof(global));
+	os_memset(&radio, 0, sizeof(radio));
+	conf = wpa_config_alloc_empty(NULL, NULL);
+	if (!conf)
+		goto fail;
+	dl_list_init(&radio.work);
+	conf->bss_max_count = num_bss;
+	wpa_s.global = &global;
+	wpa_s.conf = conf;
+	wpa_s.radio = &radio;
+	dl_list_init(&wpa_s.bss_tmp_disallowed);
+	wpa_bss_init(&wpa_s);
+
+	for (i = 0; i < num_networks; i++) {
+		ssid = wpa_config_add_network(conf);
+		if (!ssid)
+			goto fail;
+		wpa_config_set_network_defaults(ssid);
+		os_snprintf(buf, sizeof(buf), "net-%u", i);
+		ssid->ssid = (u8 *) os_strdup(buf);
+		if (!ssid->ssid)
+			goto fail;
+		ssid->ssid_len = os_strlen(buf);
+		ssid->psk_set = 1;
+	}
+
+	os_get_reltime(&now);
+	wpa_bss_update_start(&wpa_s);
+	for (i = 0; i < num_bss; i++) {
+		struct wpa_scan_res *res;
+
+		if (i == num_bss - 1)
+			os_snprintf(buf, sizeof(buf), "net-%u",
+				    num_networks - 1);
+		else
+			os_snprintf(buf, sizeof(buf), "bss-%u", i);
+		res = bench_res(i, buf);
+		if (!res)
+			goto fail;
+		wpa_bss_update_scan_res(&wpa_s, res, &now);
+		os_free(res);
+	}
+
+	for (r = 0; r < rounds; r++) {
+		/* Every BSS against every network */
+		os_get_reltime(&start);
+		for (i = 0; i < wpa_s.last_scan_res_used; i++) {
+			full_ssid = wpa_scan_res_match(&wpa_s, i,
+						       wpa_s.last_scan_res[i],
+						       conf->pssid[0], 0, 1);
+			if (full_ssid) {
+				full_bss = wpa_s.last_scan_res[i];
+				break;
+			}
+		}
+		usec = bench_usec(&start);
+		if (r == 0 || usec < full_usec)
+			full_usec = usec;
+
+		/* Indexed selection */
+		os_get_reltime(&start);
+		sel_bss = wpa_supplicant_pick_network(&wpa_s, &sel_ssid);
+		usec = bench_usec(&start);
+		if (r == 0 || usec < sel_usec)
+			sel_usec = usec;
+	}
+
+	if (!full_bss || full_bss != sel_bss || full_ssid != sel_ssid) {
+		printf("Selection mismatch between full match and indexed "
+		       "selection\n");
+		goto fail;
+	}
+
+	printf("%u BSSes x %u networks (best of %u rounds): full match %u "
+	       "usec, indexed selection %u usec\n",
+	       num_bss, num_networks, rounds, full_usec, sel_usec);
+
+	ret = 0;
+fail:
+	if (conf) {
+		wpa_bss_deinit(&wpa_s);
+		os_free(wpa_s.last_scan_res);
+		wpa_config_free(conf);
+	}
+	os_program_deinit();
+
+	return ret;
+}
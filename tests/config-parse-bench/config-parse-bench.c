@@ -0,0 +1,236 @@
+/*
+ * hostapd - Configuration file parsing benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "drivers/driver.h"
+#include "ap/ap_config.h"
+#include "../../hostapd/config_file.h"
+
+
+static struct wpa_driver_ops bench_driver = {
+	.name = "none",
+};
+
+const struct wpa_driver_ops *const wpa_drivers[] =
+{
+	&bench_driver,
+	NULL
+};
+
+
+static int write_bss(FILE *f, int idx, int extra)
+{
+	int i;
+
+	if (idx == 0)
+		fprintf(f, "interface=wlan0\n"
+			"driver=none\n"
+			"hw_mode=g\n"
+			"channel=1\n"
+			"country_code=FI\n");
+	else
+		fprintf(f, "\nbss=wlan0_%d\n"
+			"bssid=02:00:00:00:%02x:%02x\n",
+			idx, (idx >> 8) & 0xff, idx & 0xff);
+
+	fprintf(f, "ssid=bench-%d\n"
+		"logger_syslog=-1\n"
+		"logger_syslog_level=2\n"
+		"logger_stdout=-1\n"
+		"logger_stdout_level=2\n"
+		"ctrl_interface=/var/run/hostapd\n"
+		"ignore_broadcast_ssid=0\n"
+		"max_num_sta=255\n"
+		"ap_max_inactivity=300\n"
+		"wmm_enabled=1\n"
+		"wpa=2\n"
+		"wpa_key_mgmt=WPA-PSK FT-PSK\n"
+		"rsn_pairwise=CCMP\n"
+		"wpa_passphrase=12345678\n"
+		"wpa_group_rekey=600\n"
+		"wpa_ptk_rekey=0\n"
+		"ieee80211w=1\n"
+		"mobility_domain=a1b2\n"
+		"nas_identifier=bench-%d.example.com\n"
+		"r1_key_holder=02%08x02\n"
+		"reassociation_deadline=1000\n"
+		"pmk_r1_push=1\n"
+		"ft_over_ds=0\n"
+		"interworking=1\n"
+		"access_network_type=2\n"
+		"internet=1\n"
+		"venue_group=7\n"
+		"venue_type=1\n"
+		"venue_name=eng:Example venue\n"
+		"roaming_consortium=021122\n"
+		"domain_name=example.com,example.org\n"
+		"hs20=1\n"
+		"hs20_oper_friendly_name=eng:Example operator\n"
+		"hs20_wan_metrics=01:8000:1000:80:240:3000\n",
+		idx, idx, idx);
+
+	for (i = 0; i < extra; i++) {
+		fprintf(f, "anqp_elem=%d:%08x%08x\n", 0xdd00 + i, idx, i);
+		fprintf(f, "nai_realm=0,realm%d.example.com,13[5:6],21[2:4][5:7]\n",
+			i);
+		fprintf(f, "r0kh=02:00:00:%02x:%02x:%02x r0kh-%d-%d.example.com "
+			"000102030405060708090a0b0c0d0e0f\n",
+			idx & 0xff, (i >> 8) & 0xff, i & 0xff, idx, i);
+		fprintf(f, "r1kh=02:00:00:%02x:%02x:%02x 00:00:%02x:%02x:%02x:01 "
+			"000102030405060708090a0b0c0d0e0f\n",
+			idx & 0xff, (i >> 8) & 0xff, i & 0xff,
+			idx & 0xff, (i >> 8) & 0xff, i & 0xff);
+	}
+
+	return ferror(f) ? -1 : 0;
+}
+
+
+static int write_config(const char *fname, int num_bss, int extra)
+{
+	FILE *f;
+	int i, ret = 0;
+
+	f = fopen(fname, "w");
+	if (!f) {
+		printf("Could not create '%s'\n", fname);
+		return -1;
+	}
+	for (i = 0; i < num_bss && ret == 0; i++)
+		ret = write_bss(f, i, extra);
+	if (fclose(f) != 0)
+		ret = -1;
+	return ret;
+}
+
+
+static int count_lines(const char *fname)
+{
+	FILE *f;
+	char buf[4096];
+	int lines = 0;
+
+	f = fopen(fname, "r");
+	if (!f)
+		return 0;
+	while (fgets(buf, sizeof(buf), f))
+		lines++;
+	fclose(f);
+	return lines;
+}
+
+
+static void usage(void)
+{
+	printf("usage: config-parse-bench [-b<num BSSs>] [-e<extra lines>] "
+	       "[-i<iterations>] [-k] [-f<config file>]\n"
+	       "\n"
+	       "  -b = number of BSSs in the generated file (default: 100)\n"
+	       "  -e = number of anqp_elem/nai_realm/r0kh/r1kh lines per BSS\n"
+	       "       (default: 10)\n"
+	       "  -i = number of times to parse the file (default: 20)\n"
+	       "  -k = keep the generated configuration file\n"
+	       "  -f = parse an existing configuration file instead of a "
+	       "generated one\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	char gen_fname[] = "/tmp/config-parse-bench.XXXXXX";
+	const char *fname = NULL;
+	int num_bss = 100, extra = 10, iterations = 20, keep = 0;
+	int c, i, lines, fd, ret = -1;
+	struct os_reltime start, end, diff;
+	struct hostapd_config *conf;
+	double sec;
+
+	for (;;) {
+		c = getopt(argc, argv, "b:e:f:hi:k");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'b':
+			num_bss = atoi(optarg);
+			break;
+		case 'e':
+			extra = atoi(optarg);
+			break;
+		case 'f':
+			fname = optarg;
+			break;
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		case 'k':
+			keep = 1;
+			break;
+		case 'h':
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (num_bss < 1 || extra < 0 || iterations < 1) {
+		usage();
+		return -1;
+	}
+
+	if (os_program_init())
+		return -1;
+
+	wpa_debug_level = MSG_ERROR;
+
+	if (!fname) {
+		fd = mkstemp(gen_fname);
+		if (fd < 0) {
+			printf("Could not create a temporary file\n");
+			goto fail;
+		}
+		close(fd);
+		fname = gen_fname;
+		if (write_config(fname, num_bss, extra) < 0)
+			goto fail;
+	} else {
+		keep = 1;
+	}
+
+	lines = count_lines(fname);
+
+	os_get_reltime(&start);
+	for (i = 0; i < iterations; i++) {
+		conf = hostapd_config_read(fname);
+		if (!conf) {
+			printf("Failed to parse '%s'\n", fname);
+			goto fail;
+		}
+		if (i == 0)
+			num_bss = conf->num_bss;
+		hostapd_config_free(conf);
+	}
+	os_get_reltime(&end);
+
+	os_reltime_sub(&end, &start, &diff);
+	sec = diff.sec + diff.usec / 1000000.0;
+	printf("config=%s bss=%d lines=%d iterations=%d\n",
+	       fname, num_bss, lines, iterations);
+	printf("total=%.3f s per_file=%.3f ms lines_per_sec=%.0f\n",
+	       sec, sec * 1000.0 / iterations,
+	       sec > 0 ? (double) lines * iterations / sec : 0.0);
+
+	ret = 0;
+fail:
+	if (fname == gen_fname && !keep)
+		unlink(gen_fname);
+	os_program_deinit();
+
+	return ret;
+}
@@ -0,0 +1,427 @@
+/*
+ * hostapd - DPP Configurator throughput benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "common/dpp.h"
+#include "ap/hostapd.h"
+#include "ap/ap_drv_ops.h"
+#include "ap/gas_query_ap.h"
+#include "ap/wpa_auth.h"
+#include "ap/dpp_hostapd.h"
+#include "utils/latency_stats.h"
+
+
+/*
+ * The Configurator side is the hostapd DPP implementation. Each simulated
+ * Enrollee runs the protocol directly with the functions in common/dpp.c.
+ * Frames in both directions go through a single FIFO queue, so up to the
+ * configured number of Enrollees have their exchanges interleaved.
+ */
+
+enum bench_frame_type {
+	BENCH_TO_AP_ACTION,
+	BENCH_TO_AP_GAS_REQ,
+	BENCH_TO_ENROLLEE_ACTION,
+	BENCH_TO_ENROLLEE_GAS_RESP,
+};
+
+struct bench_frame {
+	struct bench_frame *next;
+	enum bench_frame_type type;
+	unsigned int enrollee;
+	struct wpabuf *buf;
+};
+
+struct bench_enrollee {
+	u8 addr[ETH_ALEN];
+	struct dpp_bootstrap_info *own_bi;
+	struct dpp_authentication *auth;
+	struct os_reltime start;
+};
+
+static struct hostapd_data bench_hapd;
+static struct bench_enrollee *enrollees;
+static unsigned int num_enrollees;
+static struct bench_frame *queue_head, *queue_tail;
+
+
+static void queue_frame(enum bench_frame_type type, unsigned int enrollee,
+			struct wpabuf *buf)
+{
+	struct bench_frame *frame;
+
+	frame = os_zalloc(sizeof(*frame));
+	if (!frame) {
+		wpabuf_free(buf);
+		return;
+	}
+	frame->type = type;
+	frame->enrollee = enrollee;
+	frame->buf = buf;
+	if (queue_tail)
+		queue_tail->next = frame;
+	else
+		queue_head = frame;
+	queue_tail = frame;
+}
+
+
+static unsigned int enrollee_idx(const u8 *addr)
+{
+	return WPA_GET_BE24(&addr[3]);
+}
+
+
+int hostapd_drv_send_action(struct hostapd_data *hapd, unsigned int freq,
+			    unsigned int wait, const u8 *dst, const u8 *data,
+			    size_t len)
+{
+	unsigned int idx = enrollee_idx(dst);
+
+	if (idx >= num_enrollees)
+		return -1;
+	queue_frame(BENCH_TO_ENROLLEE_ACTION, idx, wpabuf_alloc_copy(data, len));
+	return 0;
+}
+
+
+int gas_query_ap_req(struct gas_query_ap *gas, const u8 *dst, int freq,
+		     struct wpabuf *req,
+		     void (*cb)(void *ctx, const u8 *dst, u8 dialog_token,
+				enum gas_query_ap_result result,
+				const struct wpabuf *adv_proto,
+				const struct wpabuf *resp, u16 status_code),
+		     void *ctx)
+{
+	/* hostapd is always the Configurator in this benchmark */
+	return -1;
+}
+
+
+int wpa_auth_pmksa_add2(struct wpa_authenticator *wpa_auth, const u8 *addr,
+			const u8 *pmk, size_t pmk_len, const u8 *pmkid,
+			int session_timeout, int akmp)
+{
+	return -1;
+}
+
+
+static void send_to_ap(unsigned int idx, enum dpp_public_action_frame_type type,
+		       const struct wpabuf *attr)
+{
+	struct wpabuf *msg;
+
+	msg = dpp_alloc_msg(type, wpabuf_len(attr));
+	if (!msg)
+		return;
+	wpabuf_put_buf(msg, attr);
+	queue_frame(BENCH_TO_AP_ACTION, idx, msg);
+}
+
+
+static int enrollee_start(unsigned int idx, struct dpp_bootstrap_info *ap_bi)
+{
+	struct bench_enrollee *e = &enrollees[idx];
+
+	os_get_reltime(&e->start);
+	e->auth = dpp_auth_init(NULL, ap_bi, e->own_bi, 0);
+	if (!e->auth)
+		return -1;
+	send_to_ap(idx, DPP_PA_AUTHENTICATION_REQ, e->auth->req_attr);
+	return 0;
+}
+
+
+/* Returns 1 when the Enrollee completed the exchange, 0 if it continues, or
+ * -1 on failure */
+static int enrollee_rx(unsigned int idx, struct bench_frame *frame)
+{
+	struct bench_enrollee *e = &enrollees[idx];
+	const u8 *data = wpabuf_head(frame->buf);
+	size_t len = wpabuf_len(frame->buf);
+	struct wpabuf *attr;
+
+	if (!e->auth)
+		return -1;
+
+	if (frame->type == BENCH_TO_ENROLLEE_GAS_RESP) {
+		if (dpp_conf_resp_rx(e->auth, frame->buf) < 0 ||
+		    !e->auth->connector)
+			return -1;
+		return 1;
+	}
+
+	if (len < 7 || data[6] != DPP_PA_AUTHENTICATION_RESP)
+		return -1;
+	attr = dpp_auth_resp_rx(e->auth, data + 7, len - 7);
+	if (!attr)
+		return -1;
+	send_to_ap(idx, DPP_PA_AUTHENTICATION_CONF, attr);
+	wpabuf_free(attr);
+
+	attr = dpp_build_conf_req(e->auth,
+				  "{\"name\":\"Bench\",\"wi-fi_tech\":\"infra\","
+				  "\"netRole\":\"sta\"}");
+	if (!attr)
+		return -1;
+	queue_frame(BENCH_TO_AP_GAS_REQ, idx, attr);
+	return 0;
+}
+
+
+static void ap_rx(struct bench_frame *frame)
+{
+	struct bench_enrollee *e = &enrollees[frame->enrollee];
+	struct wpabuf *resp;
+
+	if (frame->type == BENCH_TO_AP_GAS_REQ) {
+		resp = hostapd_dpp_gas_req_handler(&bench_hapd, e->addr,
+						   wpabuf_head(frame->buf),
+						   wpabuf_len(frame->buf));
+		if (resp)
+			queue_frame(BENCH_TO_ENROLLEE_GAS_RESP,
+				    frame->enrollee, resp);
+		return;
+	}
+
+	/* Skip Public Action header; hostapd_dpp_rx_action() starts from the
+	 * DPP frame type */
+	hostapd_dpp_rx_action(&bench_hapd, e->addr,
+			      wpabuf_head_u8(frame->buf) + 6,
+			      wpabuf_len(frame->buf) - 6, 2412);
+}
+
+
+static int init_ap(struct dpp_bootstrap_info **ap_bi)
+{
+	struct hostapd_data *hapd = &bench_hapd;
+	char params[100];
+	const char *uri;
+	int conf_id, bi_id;
+
+	hapd->msg_ctx = hapd;
+	os_memcpy(hapd->own_addr, "\x02\x00\x00\xff\xff\xff", ETH_ALEN);
+	if (hostapd_dpp_init(hapd) < 0)
+		return -1;
+
+	conf_id = hostapd_dpp_configurator_add(hapd, " curve=prime256v1");
+	bi_id = hostapd_dpp_bootstrap_gen(hapd, " type=qrcode curve=prime256v1");
+	if (conf_id < 0 || bi_id < 0)
+		return -1;
+	os_snprintf(params, sizeof(params), " conf=sta-dpp configurator=%d",
+		    conf_id);
+	hapd->dpp_configurator_params = os_strdup(params);
+	uri = hostapd_dpp_bootstrap_get_uri(hapd, bi_id);
+	if (!hapd->dpp_configurator_params || !uri)
+		return -1;
+
+	*ap_bi = dpp_parse_qr_code(uri);
+	return *ap_bi ? 0 : -1;
+}
+
+
+static int init_enrollees(unsigned int num)
+{
+	unsigned int i;
+	char *pk, *uri;
+	size_t len;
+
+	enrollees = os_calloc(num, sizeof(*enrollees));
+	if (!enrollees)
+		return -1;
+	num_enrollees = num;
+
+	for (i = 0; i < num; i++) {
+		struct bench_enrollee *e = &enrollees[i];
+
+		e->addr[0] = 0x02;
+		WPA_PUT_BE24(&e->addr[3], i);
+		e->own_bi = os_zalloc(sizeof(*e->own_bi));
+		if (!e->own_bi)
+			return -1;
+		pk = dpp_keygen(e->own_bi, "prime256v1", NULL, 0);
+		if (!pk)
+			return -1;
+
+		/* Provision the Enrollee bootstrapping key into the
+		 * Configurator */
+		len = os_strlen(pk) + 10;
+		uri = os_malloc(len);
+		if (!uri) {
+			os_free(pk);
+			return -1;
+		}
+		os_snprintf(uri, len, "DPP:K:%s;;", pk);
+		os_free(pk);
+		if (hostapd_dpp_qr_code(&bench_hapd, uri) < 0) {
+			os_free(uri);
+			return -1;
+		}
+		os_free(uri);
+	}
+
+	return 0;
+}
+
+
+static void usage(void)
+{
+	printf("usage: dpp-bench [-k<provisioned keys>] [-n<enrollments>] "
+	       "[-c<concurrent>]\n"
+	       "\n"
+	       "  -k = number of Enrollee bootstrapping keys provisioned into "
+	       "the\n"
+	       "       Configurator (default: 1000)\n"
+	       "  -n = number of enrollments to run (default: 200)\n"
+	       "  -c = number of concurrent enrollments (default: 16)\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int keys = 1000, num = 200, concurrent = 16;
+	unsigned int started = 0, completed = 0, failed = 0, active = 0;
+	struct dpp_bootstrap_info *ap_bi = NULL;
+	struct os_reltime start, end, diff;
+	struct latency_samples latency;
+	double sec;
+	struct bench_frame *frame;
+	unsigned int i;
+	int c, res, ret = -1;
+
+	for (;;) {
+		c = getopt(argc, argv, "c:hk:n:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'c':
+			concurrent = atoi(optarg);
+			break;
+		case 'k':
+			keys = atoi(optarg);
+			break;
+		case 'n':
+			num = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (keys < 1 || num < 1 || concurrent < 1 || keys > 0xffffff) {
+		usage();
+		return -1;
+	}
+
+	if (os_program_init())
+		return -1;
+	if (eloop_init()) {
+		os_program_deinit();
+		return -1;
+	}
+
+	wpa_debug_level = MSG_ERROR;
+	os_memset(&latency, 0, sizeof(latency));
+
+	os_get_reltime(&start);
+	if (init_ap(&ap_bi) < 0 || init_enrollees(keys) < 0) {
+		printf("Initialization failed\n");
+		goto fail;
+	}
+	os_get_reltime(&end);
+	os_reltime_sub(&end, &start, &diff);
+	printf("keys=%u provisioning=%.3f s\n",
+	       keys, diff.sec + diff.usec / 1000000.0);
+
+	os_get_reltime(&start);
+	while (completed + failed < num) {
+		while (active < concurrent && started < num) {
+			i = started++ % keys;
+			if (enrollees[i].auth) {
+				/* Key is still in use by an earlier
+				 * enrollment; wait for it to complete */
+				started--;
+				break;
+			}
+			if (enrollee_start(i, ap_bi) < 0) {
+				failed++;
+				continue;
+			}
+			active++;
+		}
+
+		frame = queue_head;
+		if (!frame) {
+			/* Remaining exchanges were dropped */
+			failed += active;
+			break;
+		}
+		queue_head = frame->next;
+		if (!queue_head)
+			queue_tail = NULL;
+
+		if (frame->type == BENCH_TO_AP_ACTION ||
+		    frame->type == BENCH_TO_AP_GAS_REQ) {
+			ap_rx(frame);
+		} else {
+			res = enrollee_rx(frame->enrollee, frame);
+			if (res != 0) {
+				struct bench_enrollee *e;
+
+				e = &enrollees[frame->enrollee];
+				if (res > 0) {
+					completed++;
+					latency_samples_add_age(&latency,
+								&e->start);
+				} else {
+					failed++;
+				}
+				dpp_auth_deinit(e->auth);
+				e->auth = NULL;
+				active--;
+			}
+		}
+		wpabuf_free(frame->buf);
+		os_free(frame);
+	}
+	os_get_reltime(&end);
+
+	os_reltime_sub(&end, &start, &diff);
+	sec = diff.sec + diff.usec / 1000000.0;
+	printf("enrollments=%u completed=%u failed=%u concurrent=%u\n",
+	       num, completed, failed, concurrent);
+	printf("total=%.3f s enrollments_per_sec=%.1f\n",
+	       sec, sec > 0 ? completed / sec : 0.0);
+	latency_samples_print("enrollment latency", &latency);
+
+	ret = failed ? -1 : 0;
+fail:
+	while (queue_head) {
+		frame = queue_head;
+		queue_head = frame->next;
+		wpabuf_free(frame->buf);
+		os_free(frame);
+	}
+	for (i = 0; enrollees && i < num_enrollees; i++) {
+		dpp_auth_deinit(enrollees[i].auth);
+		dpp_bootstrap_info_free(enrollees[i].own_bi);
+	}
+	os_free(enrollees);
+	latency_samples_free(&latency);
+	dpp_bootstrap_info_free(ap_bi);
+	hostapd_dpp_deinit(&bench_hapd);
+	eloop_destroy();
+	os_program_deinit();
+
+	return ret;
+}
@@ -0,0 +1,266 @@
+/*
+ * hlr_auc_gw throughput benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+#include <sys/un.h>
+
+#include "utils/common.h"
+#include "utils/latency_stats.h"
+
+
+/*
+ * Benchmark clients use IMSIs 24201<index> with the index as ten digits. A
+ * matching Milenage file can be generated with -G.
+ */
+#define BENCH_IMSI_PREFIX "24201"
+
+static unsigned int num_imsi = 1000;
+
+
+static void bench_imsi(unsigned int idx, char *buf, size_t len)
+{
+	os_snprintf(buf, len, BENCH_IMSI_PREFIX "%010u", idx);
+}
+
+
+static int bench_generate(const char *fname)
+{
+	FILE *f;
+	char imsi[20];
+	u8 key[16];
+	unsigned int i, j;
+
+	f = fopen(fname, "w");
+	if (!f) {
+		perror("fopen");
+		return -1;
+	}
+
+	fprintf(f, "# Milenage data for hlr-auc-gw-bench\n"
+		"# IMSI Ki OPc AMF SQN\n");
+	for (i = 0; i < num_imsi; i++) {
+		bench_imsi(i, imsi, sizeof(imsi));
+		fprintf(f, "%s ", imsi);
+		for (j = 0; j < sizeof(key); j++)
+			key[j] = i + j;
+		for (j = 0; j < sizeof(key); j++)
+			fprintf(f, "%02x", key[j]);
+		fprintf(f, " ");
+		for (j = 0; j < sizeof(key); j++)
+			fprintf(f, "%02x", key[j] ^ 0x5a);
+		fprintf(f, " 8000 000000000000\n");
+	}
+
+	fclose(f);
+	printf("Wrote %u Milenage entries to %s\n", num_imsi, fname);
+	return 0;
+}
+
+
+static int bench_run(const char *server, const char *type,
+		     unsigned int num_req, unsigned int window)
+{
+	struct sockaddr_un addr;
+	char local[100], buf[1000], imsi[20];
+	const char *fmt;
+	struct os_reltime start, now, diff, *sent = NULL;
+	struct latency_samples latency;
+	unsigned int tx = 0, rx = 0, failures = 0, idx;
+	int s, ret = -1;
+	double secs;
+
+	if (os_strcmp(type, "aka") == 0)
+		fmt = "AKA-REQ-AUTH %s";
+	else if (os_strcmp(type, "sim") == 0)
+		fmt = "SIM-REQ-AUTH %s 3";
+	else {
+		printf("Unknown request type '%s'\n", type);
+		return -1;
+	}
+
+	/* Each IMSI has at most one request pending */
+	if (window > num_imsi)
+		window = num_imsi;
+
+	os_memset(&latency, 0, sizeof(latency));
+	sent = os_calloc(num_imsi, sizeof(*sent));
+	if (!sent)
+		goto fail;
+
+	s = socket(PF_UNIX, SOCK_DGRAM, 0);
+	if (s < 0) {
+		perror("socket");
+		goto fail;
+	}
+
+	os_snprintf(local, sizeof(local), "/tmp/hlr-auc-gw-bench-%d",
+		    getpid());
+	unlink(local);
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	os_strlcpy(addr.sun_path, local, sizeof(addr.sun_path));
+	if (bind(s, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		perror("bind");
+		goto fail_sock;
+	}
+
+	os_memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	os_strlcpy(addr.sun_path, server, sizeof(addr.sun_path));
+	if (connect(s, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		perror("connect");
+		goto fail_sock;
+	}
+
+	os_get_reltime(&start);
+	while (rx < num_req) {
+		fd_set rfds;
+		struct timeval tv;
+		ssize_t len;
+		char *pos;
+		int res;
+
+		while (tx < num_req && tx - rx < window) {
+			idx = tx % num_imsi;
+			bench_imsi(idx, imsi, sizeof(imsi));
+			res = os_snprintf(buf, sizeof(buf), fmt, imsi);
+			os_get_reltime(&sent[idx]);
+			if (send(s, buf, res, 0) < 0) {
+				perror("send");
+				goto fail_sock;
+			}
+			tx++;
+		}
+
+		FD_ZERO(&rfds);
+		FD_SET(s, &rfds);
+		tv.tv_sec = 5;
+		tv.tv_usec = 0;
+		res = select(s + 1, &rfds, NULL, NULL, &tv);
+		if (res < 0) {
+			perror("select");
+			goto fail_sock;
+		}
+		if (res == 0) {
+			printf("Timeout: %u responses missing\n", tx - rx);
+			goto fail_sock;
+		}
+
+		len = recv(s, buf, sizeof(buf) - 1, 0);
+		if (len < 0) {
+			perror("recv");
+			goto fail_sock;
+		}
+		buf[len] = '\0';
+		os_get_reltime(&now);
+
+		/* <response> <IMSI> ... */
+		pos = os_strchr(buf, ' ');
+		if (!pos || os_strncmp(pos + 1, BENCH_IMSI_PREFIX,
+				       os_strlen(BENCH_IMSI_PREFIX)) != 0) {
+			printf("Unexpected response: %s\n", buf);
+			goto fail_sock;
+		}
+		idx = atoi(pos + 1 + os_strlen(BENCH_IMSI_PREFIX));
+		if (idx >= num_imsi) {
+			printf("Unexpected IMSI in response: %s\n", buf);
+			goto fail_sock;
+		}
+		if (os_strstr(buf, "FAILURE"))
+			failures++;
+		os_reltime_sub(&now, &sent[idx], &diff);
+		latency_samples_add(&latency, diff.sec * 1000000 + diff.usec);
+		rx++;
+	}
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &start, &diff);
+	secs = diff.sec + diff.usec / 1000000.0;
+
+	printf("%u %s requests (%u IMSIs, window %u) in %.3f s: %.0f req/s\n",
+	       num_req, type, num_imsi, window, secs,
+	       secs > 0 ? num_req / secs : 0.0);
+	latency_samples_print("Latency", &latency);
+	printf("Failures: %u\n", failures);
+	ret = failures ? -1 : 0;
+
+fail_sock:
+	close(s);
+	unlink(local);
+fail:
+	os_free(sent);
+	latency_samples_free(&latency);
+	return ret;
+}
+
+
+static void usage(void)
+{
+	printf("usage: hlr-auc-gw-bench [-s<socket path>] [-t<aka|sim>] "
+	       "[-n<requests>] [-w<window>]\n"
+	       "                        [-i<IMSIs>]\n"
+	       "       hlr-auc-gw-bench -G<Milenage file> [-i<IMSIs>]\n"
+	       "\n"
+	       "Start hlr_auc_gw with a generated Milenage file, e.g.:\n"
+	       "  hlr-auc-gw-bench -G /tmp/bench.milenage_db -i 100000\n"
+	       "  hlr_auc_gw -q -u -m /tmp/bench.milenage_db "
+	       "-s /tmp/bench.sock\n"
+	       "  hlr-auc-gw-bench -s /tmp/bench.sock -i 100000 -n 1000000 "
+	       "-w 64\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	const char *server = "/tmp/hlr_auc_gw.sock";
+	const char *gen = NULL, *type = "aka";
+	unsigned int num_req = 100000, window = 32;
+	int c;
+
+	for (;;) {
+		c = getopt(argc, argv, "G:hi:n:s:t:w:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'G':
+			gen = optarg;
+			break;
+		case 'h':
+			usage();
+			return 0;
+		case 'i':
+			num_imsi = atoi(optarg);
+			break;
+		case 'n':
+			num_req = atoi(optarg);
+			break;
+		case 's':
+			server = optarg;
+			break;
+		case 't':
+			type = optarg;
+			break;
+		case 'w':
+			window = atoi(optarg);
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (num_imsi == 0 || num_req == 0 || window == 0) {
+		usage();
+		return -1;
+	}
+
+	if (gen)
+		return bench_generate(gen) < 0 ? -1 : 0;
+
+	return bench_run(server, type, num_req, window) < 0 ? -1 : 0;
+}
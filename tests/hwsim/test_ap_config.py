@@ -12,6 +12,7 @@ logger = logging.getLogger(__name__)
 
 from remotehost import remote_compatible
 import hostapd
+import hwsim_utils
 from utils import alloc_fail, fail_test
 
 @remote_compatible
@@ -123,6 +124,92 @@ def test_ap_config_reload_before_enable(dev, apdev, params):
     os.kill(pid, signal.SIGHUP)
     hapd.ping()
 
+def test_ap_config_reload_selective(dev, apdev, params):
+    """hostapd configuration reload without restarting the BSS"""
+    conf = os.path.join(params['logdir'], 'hostapd-reload.conf')
+    deny = os.path.join(params['logdir'], 'hostapd-reload.deny')
+    base = [ "driver=nl80211", "hw_mode=g", "channel=1",
+             "interface=" + apdev[0]['ifname'],
+             "ctrl_interface=/var/run/hostapd", "ssid=reload" ]
+
+    def write_conf(extra):
+        with open(conf, "w") as f:
+            f.write("\n".join(base + extra) + "\n")
+
+    def reload(pid, applied, changed):
+        os.kill(pid, signal.SIGHUP)
+        ev = hapd.wait_event(["AP-CONFIG-RELOADED"], timeout=5)
+        if ev is None:
+            raise Exception("AP-CONFIG-RELOADED not reported")
+        if "applied=" + applied + " changed=" + changed not in ev:
+            raise Exception("Unexpected AP-CONFIG-RELOADED contents: " + ev)
+
+    def check_connected():
+        ev = dev[0].wait_event(["CTRL-EVENT-DISCONNECTED"], timeout=1)
+        if ev is not None:
+            raise Exception("Station disconnected on reload")
+        hwsim_utils.test_connectivity(dev[0], hapd)
+
+    with open(deny, "w") as f:
+        f.write(dev[1].own_addr() + "\n")
+    write_conf([ "dtim_period=2" ])
+    hapd = hostapd.add_iface(apdev[0], conf)
+    hapd.enable()
+    with open(os.path.join(params['logdir'], 'hostapd-test.pid'), "r") as f:
+        pid = int(f.read())
+    dev[0].connect("reload", key_mgmt="NONE", scan_freq="2412")
+    dev[1].connect("reload", key_mgmt="NONE", scan_freq="2412")
+
+    # Beacon parameter change
+    write_conf([ "dtim_period=3" ])
+    reload(pid, "beacon", "dtim_period")
+    check_connected()
+
+    # ACL change disconnects only the denied station
+    write_conf([ "dtim_period=3", "macaddr_acl=0", "deny_mac_file=" + deny ])
+    reload(pid, "acl", "deny_mac_file")
+    dev[1].wait_disconnected()
+    dev[1].request("DISCONNECT")
+    check_connected()
+
+    # Interface parameter change falls back to full restart
+    write_conf([ "dtim_period=3", "macaddr_acl=0", "deny_mac_file=" + deny,
+                 "beacon_int=200" ])
+    reload(pid, "iface", "beacon_int")
+    dev[0].wait_disconnected()
+    dev[0].request("DISCONNECT")
+
+    # Removing a PSK disconnects only the station that used it
+    psk_file = os.path.join(params['logdir'], 'hostapd-reload.wpa_psk')
+    with open(psk_file, "w") as f:
+        f.write(dev[0].own_addr() + " passphrase-sta0\n")
+        f.write(dev[1].own_addr() + " passphrase-sta1\n")
+    wpa = [ "wpa=2", "wpa_key_mgmt=WPA-PSK", "rsn_pairwise=CCMP",
+            "wpa_psk_file=" + psk_file ]
+    write_conf(wpa + [ "wpa_passphrase=12345678" ])
+    os.kill(pid, signal.SIGHUP)
+    ev = hapd.wait_event(["AP-CONFIG-RELOADED"], timeout=5)
+    if ev is None:
+        raise Exception("AP-CONFIG-RELOADED not reported")
+    dev[0].connect("reload", psk="passphrase-sta0", scan_freq="2412")
+    dev[1].connect("reload", psk="passphrase-sta1", scan_freq="2412")
+    dev[2].connect("reload", psk="12345678", scan_freq="2412")
+
+    with open(psk_file, "w") as f:
+        f.write(dev[0].own_addr() + " passphrase-sta0\n")
+    reload(pid, "psk", "wpa_psk_file")
+    dev[1].wait_disconnected()
+    dev[1].request("DISCONNECT")
+    check_connected()
+    hwsim_utils.test_connectivity(dev[2], hapd)
+
+    # Changing the passphrase disconnects the station that used it
+    write_conf(wpa + [ "wpa_passphrase=abcdefgh" ])
+    reload(pid, "psk", "wpa_passphrase")
+    dev[2].wait_disconnected()
+    dev[2].request("DISCONNECT")
+    check_connected()
+
 def test_ap_config_sigusr1(dev, apdev, params):
     """hostapd SIGUSR1"""
     hapd = hostapd.add_ap(apdev[0], { "ssid": "foobar" })
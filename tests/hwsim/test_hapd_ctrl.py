@@ -4,8 +4,14 @@
 # This software may be distributed under the terms of the BSD license.
 # See README for more details.
 
+import json
+import os
+import re
+import select
+
 from remotehost import remote_compatible
 import hostapd
+import wpaspy
 import hwsim_utils
 from utils import skip_with_fips, alloc_fail, fail_test, HwsimSkip
 
@@ -920,3 +926,368 @@ def test_hapd_ctrl_test_fail(dev, apdev):
         raise Exception("TEST_ALLOC_FAIL clearing failed")
     if "OK" not in hapd.request("TEST_FAIL "):
         raise Exception("TEST_FAIL clearing failed")
+
+def events_status(hapd):
+    res = {}
+    for line in hapd.request("EVENTS_STATUS").splitlines():
+        name, val = line.split('=', 1)
+        res[name] = val
+    return res
+
+def events_monitor(hapd, idx):
+    vals = {}
+    for item in events_status(hapd)["monitor[%d]" % idx].split(' '):
+        name, val = item.split('=', 1)
+        vals[name] = val
+    return vals
+
+def events_attach(hapd, params):
+    mon = wpaspy.Ctrl(os.path.join(hostapd.hapd_ctrl, hapd.ifname))
+    if "OK" not in mon.request("ATTACH " + params):
+        raise Exception("ATTACH " + params + " failed")
+    mon.attached = True
+    return mon
+
+def events_recv(mon, timeout=5):
+    events = []
+    while mon.pending(timeout=timeout):
+        for line in mon.recv().split('\n'):
+            m = re.match(r'<(\d+):(\d+)>(.*)', line)
+            if not m:
+                raise Exception("Unexpected event format: " + line)
+            events.append((int(m.group(2)), m.group(3).strip()))
+        timeout = 0.1
+    return events
+
+def events_generate(hapd, count=1):
+    for i in range(count):
+        hapd.disable()
+        hapd.enable()
+        hapd.wait_event(["AP-ENABLED"], timeout=10)
+
+def test_hapd_ctrl_events_seq(dev, apdev):
+    """hostapd ctrl_iface ATTACH with event sequence numbers"""
+    hapd = hostapd.add_ap(apdev[0], { "ssid": "hapd-ctrl" })
+    for params in [ "foo", "seq foo", "batch=0", "batch=", "resume=",
+                    "resume=x", "resume=1x" ]:
+        if "FAIL" not in hapd.request("ATTACH " + params):
+            raise Exception("Invalid ATTACH accepted: " + params)
+
+    mon = events_attach(hapd, "seq")
+    events_generate(hapd, 2)
+    events = events_recv(mon)
+    names = [ev[1] for ev in events]
+    if names.count("AP-DISABLED") != 2 or names.count("AP-ENABLED") != 2:
+        raise Exception("Unexpected events: " + str(names))
+    seqs = [ev[0] for ev in events]
+    if seqs != range(seqs[0], seqs[0] + len(seqs)):
+        raise Exception("Event sequence numbers not consecutive: " +
+                        str(seqs))
+    status = events_status(hapd)
+    if int(status["next_seq"]) != seqs[-1] + 1:
+        raise Exception("Unexpected next_seq: " + status["next_seq"])
+    vals = events_monitor(hapd, 0)
+    if vals["seq"] != "1" or vals["pending"] != "0" or \
+       int(vals["sent"]) != len(events) or vals["lost"] != "0":
+        raise Exception("Unexpected monitor status: " + str(vals))
+    mon.close()
+
+def test_hapd_ctrl_events_batch_resume(dev, apdev):
+    """hostapd ctrl_iface ATTACH batch and resume after reconnect"""
+    hapd = hostapd.add_ap(apdev[0], { "ssid": "hapd-ctrl" })
+    mon = events_attach(hapd, "seq")
+    events_generate(hapd)
+    events = events_recv(mon)
+    last = events[-1][0]
+    mon.close()
+
+    # Events from while the monitor was disconnected are delivered after
+    # it reconnects
+    events_generate(hapd, 3)
+    mon = events_attach(hapd, "seq batch=4 resume=%d" % (last + 1))
+    if not mon.pending(timeout=5):
+        raise Exception("No buffered events delivered")
+    first = mon.recv()
+    if len(first.split('\n')) != 4:
+        raise Exception("Events not delivered in a batch: " + first)
+    if not first.startswith("<3:%d>" % (last + 1)):
+        raise Exception("Delivery did not resume from the requested event: "
+                        + first)
+    events = events_recv(mon)
+    names = [ev.split('>', 1)[1].strip() for ev in first.split('\n')]
+    names += [ev[1] for ev in events]
+    if names.count("AP-DISABLED") != 3 or names.count("AP-ENABLED") != 3:
+        raise Exception("Unexpected events after resume: " + str(names))
+    vals = events_monitor(hapd, 0)
+    if vals["batch"] != "4" or vals["pending"] != "0" or \
+       vals["lost"] != "0":
+        raise Exception("Unexpected monitor status: " + str(vals))
+    mon.close()
+
+def test_hapd_ctrl_events_overflow(dev, apdev):
+    """hostapd ctrl_iface event buffer overflow with a stalled monitor"""
+    hapd = hostapd.add_ap(apdev[0], { "ssid": "hapd-ctrl" })
+    stalled = events_attach(hapd, "seq")
+    ring_size = int(events_status(hapd)["ring_size"])
+
+    # The monitor of the hapd object keeps receiving the events while the
+    # one attached above does not read any of them. Once the stalled
+    # monitor has used its share of the socket send buffer, it falls
+    # behind and loses the events that get overwritten in the ring.
+    for i in range(ring_size):
+        events_generate(hapd)
+        if int(events_monitor(hapd, 0)["lost"]) > 0:
+            break
+    status = events_status(hapd)
+    if status["buffered"] != status["ring_size"] or \
+       status["oldest_seq"] == "1":
+        raise Exception("Event buffer did not wrap: " + str(status))
+    # The monitor of the hapd object was attached first, so it is the last
+    # one in the list
+    stalled_vals = events_monitor(hapd, 0)
+    active_vals = events_monitor(hapd, len([name for name in status
+                                            if name.startswith("monitor[")])
+                                 - 1)
+    if int(stalled_vals["lost"]) == 0:
+        raise Exception("Lost events not reported: " + str(stalled_vals))
+    if active_vals["lost"] != "0" or active_vals["pending"] != "0":
+        raise Exception("Stalled monitor affected another monitor: " +
+                        str(active_vals))
+
+    # Resuming from an event that is no longer buffered reports the gap
+    mon = events_attach(hapd, "seq batch=16 resume=1")
+    events = events_recv(mon)
+    if events[0][0] < int(status["oldest_seq"]):
+        raise Exception("Overwritten event delivered: " + str(events[0]))
+    vals = events_monitor(hapd, 0)
+    if int(vals["lost"]) < int(status["oldest_seq"]) - 1:
+        raise Exception("Lost events not counted on resume: " + str(vals))
+    mon.close()
+    stalled.close()
+
+def all_sta_request(hapd, cmd):
+    # The reply can be larger than what hapd.request() receives
+    hapd.ctrl.s.send(cmd)
+    [r, w, e] = select.select([hapd.ctrl.s], [], [], 10)
+    if not r:
+        raise Exception("Timeout on waiting response to " + cmd)
+    return hapd.ctrl.s.recv(65536)
+
+def all_sta_parse(reply):
+    stations = []
+    next_addr = None
+    for line in reply.splitlines():
+        if line.startswith("next="):
+            next_addr = line[5:]
+            continue
+        words = line.split(' ')
+        vals = {}
+        for word in words[1:]:
+            name, val = word.split('=', 1)
+            vals[name] = val
+        stations.append((words[0], vals))
+    return stations, next_addr
+
+def test_hapd_ctrl_all_sta(dev, apdev):
+    """hostapd ALL_STA ctrl_iface command"""
+    ssid = "hapd-ctrl"
+    hapd = hostapd.add_ap(apdev[0], { "ssid": ssid })
+    for i in range(3):
+        dev[i].connect(ssid, key_mgmt="NONE", scan_freq="2412")
+        hapd.wait_event(["AP-STA-CONNECTED"], timeout=5)
+    addrs = sorted([dev[i].own_addr() for i in range(3)])
+
+    for cmd in [ "fields=", "fields=foo", "fields=aid,foo", "format=xml",
+                 "after=foo", "max=0", "max=-1", "max_len=0", "max_len=10",
+                 "foo" ]:
+        if "FAIL" not in hapd.request("ALL_STA " + cmd):
+            raise Exception("Invalid ALL_STA accepted: " + cmd)
+
+    stations, next_addr = all_sta_parse(hapd.request("ALL_STA"))
+    if [sta[0] for sta in stations] != addrs or next_addr:
+        raise Exception("Unexpected ALL_STA stations: " + str(stations))
+    for addr, vals in stations:
+        for name in [ "flags", "aid", "connected_time", "rx_packets",
+                      "tx_packets", "rx_bytes", "tx_bytes", "inactive_msec" ]:
+            if name not in vals:
+                raise Exception("Default field %s missing for %s" % (name,
+                                                                     addr))
+        if "[AUTHORIZED]" not in vals["flags"]:
+            raise Exception("Unexpected flags: " + vals["flags"])
+        sta = hapd.get_sta(addr)
+        if vals["aid"] != sta["aid"]:
+            raise Exception("AID mismatch with STA for " + addr)
+
+    stations, next_addr = all_sta_parse(
+        hapd.request("ALL_STA fields=aid,listen_interval"))
+    for addr, vals in stations:
+        if sorted(vals.keys()) != [ "aid", "listen_interval" ]:
+            raise Exception("Unexpected fields: " + str(vals))
+
+    # Page through the stations one at a time
+    seen = []
+    cmd = "ALL_STA max=1 fields=aid"
+    while True:
+        stations, next_addr = all_sta_parse(hapd.request(cmd))
+        if len(stations) != 1:
+            raise Exception("Unexpected page: " + str(stations))
+        seen.append(stations[0][0])
+        if not next_addr:
+            break
+        if next_addr != stations[0][0]:
+            raise Exception("Unexpected next address " + next_addr)
+        cmd = "ALL_STA max=1 fields=aid after=" + next_addr
+        if len(seen) > len(addrs):
+            raise Exception("Paging did not end")
+    if seen != addrs:
+        raise Exception("Unexpected stations when paging: " + str(seen))
+
+    res = json.loads(hapd.request("ALL_STA format=json fields=all"))
+    if "next" in res:
+        raise Exception("Unexpected next in JSON: " + str(res))
+    if [sta["addr"] for sta in res["stations"]] != addrs:
+        raise Exception("Unexpected JSON stations: " + str(res))
+    for sta in res["stations"]:
+        if "capability" not in sta or "aid" not in sta or \
+           "flags" not in sta:
+            raise Exception("Field missing from JSON: " + str(sta))
+    res = json.loads(hapd.request("ALL_STA format=json max=2 fields=aid"))
+    if len(res["stations"]) != 2 or res["next"] != addrs[1]:
+        raise Exception("Unexpected JSON page: " + str(res))
+    res = json.loads(hapd.request("ALL_STA format=json fields=aid after=" +
+                                  res["next"]))
+    if [sta["addr"] for sta in res["stations"]] != addrs[2:]:
+        raise Exception("Unexpected second JSON page: " + str(res))
+
+    # Replies larger than the default 4096 octet control interface buffer
+    for i in range(100):
+        addr = "02:00:00:01:%02x:%02x" % (i / 256, i % 256)
+        if "OK" not in hapd.request("NEW_STA " + addr):
+            raise Exception("NEW_STA failed")
+    reply = hapd.request("ALL_STA fields=all")
+    stations, next_addr = all_sta_parse(reply)
+    if not next_addr or len(reply) > 4096:
+        raise Exception("Default reply length not limited")
+    reply = all_sta_request(hapd, "ALL_STA fields=all max_len=65000")
+    if len(reply) <= 4096:
+        raise Exception("Reply not larger than 4096 octets: %d" % len(reply))
+    stations, next_addr = all_sta_parse(reply)
+    if len(stations) != 103 or next_addr:
+        raise Exception("Unexpected number of stations: %d" % len(stations))
+    reply = all_sta_request(hapd, "ALL_STA format=json max_len=65000")
+    res = json.loads(reply)
+    if len(res["stations"]) != 103 or "next" in res:
+        raise Exception("Unexpected JSON reply with %d stations" %
+                        len(res["stations"]))
+
+def test_hapd_ctrl_eloop_stats(dev, apdev):
+    """hostapd ELOOP_STATS ctrl_iface command"""
+    ssid = "hapd-ctrl"
+    hapd = hostapd.add_ap(apdev[0], { "ssid": ssid })
+    res = hapd.request("ELOOP_STATS")
+    if "UNKNOWN COMMAND" in res:
+        raise HwsimSkip("ELOOP_STATS not supported")
+    if "OK" not in hapd.request("ELOOP_STATS RESET"):
+        raise Exception("ELOOP_STATS RESET failed")
+    dev[0].connect(ssid, key_mgmt="NONE", scan_freq="2412")
+    for i in range(10):
+        hapd.request("PING")
+
+    vals = {}
+    handlers = []
+    for line in hapd.request("ELOOP_STATS").splitlines():
+        if line.startswith("sock ") or line.startswith("timeout "):
+            words = line.split(' ')
+            entry = {}
+            for word in words[2:]:
+                name, val = word.split('=', 1)
+                entry[name] = int(val)
+            handlers.append((words[0], words[1], entry))
+        else:
+            name, val = line.split('=', 1)
+            vals[name] = val
+    for name in [ "elapsed", "iterations", "ready_sockets",
+                  "ready_sockets_max" ]:
+        if name not in vals:
+            raise Exception("Missing " + name)
+    if int(vals["iterations"]) < 10:
+        raise Exception("Unexpected iterations: " + vals["iterations"])
+    if int(vals["ready_sockets_max"]) < 1:
+        raise Exception("No ready sockets recorded")
+    hist = [int(item.split(':')[1])
+            for item in vals["ready_sockets"].split(' ')]
+    if sum(hist) != int(vals["iterations"]):
+        raise Exception("Ready socket histogram does not cover all iterations")
+
+    # The control interface socket handler ran for the PING commands
+    socks = [h for h in handlers if h[0] == "sock"]
+    if not socks or max([h[2]["count"] for h in socks]) < 10:
+        raise Exception("Socket handler count not recorded: " + str(socks))
+    for kind, name, entry in handlers:
+        for field in [ "count", "total_usec", "avg_usec", "max_usec" ]:
+            if field not in entry:
+                raise Exception("%s missing for %s" % (field, name))
+        if kind == "timeout" and "lag_max_usec" not in entry:
+            raise Exception("Timeout lag missing for " + name)
+        if entry["max_usec"] * entry["count"] < entry["total_usec"]:
+            raise Exception("Inconsistent statistics for " + name)
+
+    if "OK" not in hapd.request("ELOOP_STATS RESET"):
+        raise Exception("ELOOP_STATS RESET failed")
+    for line in hapd.request("ELOOP_STATS").splitlines():
+        if line.startswith("iterations=") and int(line[11:]) > 5:
+            raise Exception("Statistics not cleared: " + line)
+
+def mem_pool_stats(hapd):
+    res = hapd.request("MEM_POOL_STATS")
+    if "UNKNOWN COMMAND" in res:
+        raise HwsimSkip("MEM_POOL_STATS not supported")
+    pools = {}
+    for line in res.splitlines():
+        words = line.split(' ')
+        pools[words[0]] = dict([(w.split('=')[0], int(w.split('=')[1]))
+                                for w in words[1:]])
+    for name in pools:
+        pool = pools[name]
+        if pool["peak"] < pool["in_use"]:
+            raise Exception("Peak below in_use for " + name)
+        if pool["slabs"] and pool["objects"] < pool["in_use"]:
+            raise Exception("More objects in use than allocated for " + name)
+    return pools
+
+def test_hapd_ctrl_mem_pool_stats(dev, apdev):
+    """hostapd MEM_POOL_STATS ctrl_iface command"""
+    ssid = "hapd-ctrl"
+    hapd = hostapd.add_ap(apdev[0], { "ssid": ssid })
+    before = mem_pool_stats(hapd)
+    in_use = before["sta_info"]["in_use"] if "sta_info" in before else 0
+
+    dev[0].connect(ssid, key_mgmt="NONE", scan_freq="2412")
+    hapd.wait_event(["AP-STA-CONNECTED"], timeout=5)
+    for i in range(2):
+        if "OK" not in hapd.request("NEW_STA 02:00:00:00:02:%02x" % i):
+            raise Exception("NEW_STA failed")
+    pools = mem_pool_stats(hapd)
+    if "sta_info" not in pools:
+        raise Exception("sta_info pool not reported")
+    sta = pools["sta_info"]
+    if sta["in_use"] != in_use + 3 or sta["allocs"] < 3:
+        raise Exception("Unexpected sta_info pool state: " + str(sta))
+
+    dev[0].request("DISCONNECT")
+    ev = hapd.wait_event(["AP-STA-DISCONNECTED"], timeout=5)
+    if ev is None:
+        raise Exception("No disconnection event")
+    sta = mem_pool_stats(hapd)["sta_info"]
+    if sta["in_use"] != in_use + 2 or sta["frees"] < 1:
+        raise Exception("Station not returned to the pool: " + str(sta))
+
+    if "OK" not in hapd.request("MEM_POOL_STATS RESET"):
+        raise Exception("MEM_POOL_STATS RESET failed")
+    for name, pool in mem_pool_stats(hapd).items():
+        if pool["allocs"] or pool["frees"]:
+            raise Exception("Counters not cleared for " + name)
+    sta = mem_pool_stats(hapd)["sta_info"]
+    if sta["in_use"] != in_use + 2 or sta["peak"] != sta["in_use"]:
+        raise Exception("Unexpected sta_info pool state after reset: " +
+                        str(sta))
@@ -7,6 +7,7 @@
 # See README for more details.
 
 import binascii
+import os
 import re
 import logging
 logger = logging.getLogger()
@@ -159,6 +160,64 @@ def test_rrm_neighbor_db(dev, apdev):
     if "FAIL" not in hapd.request("REMOVE_NEIGHBOR 00:11:22:33:44:55"):
         raise Exception("Remove neighbor succeeded unexpectedly")
 
+def test_rrm_neighbor_db_load(dev, apdev, params):
+    """hostapd ctrl_iface LOAD_NEIGHBORS and cached neighbor reports"""
+    check_rrm_support(dev[0])
+
+    nr1="00112233445500000000510107"
+    nr2="00112233445600000000510107"
+    fname = os.path.join(params['logdir'], "rrm_neighbor_db_load.nr")
+
+    params = { "ssid": "test", "rrm_neighbor_report": "1" }
+    hapd = hostapd.add_ap(apdev[0]['ifname'], params)
+
+    if "FAIL" not in hapd.request("LOAD_NEIGHBORS " + fname + ".missing"):
+        raise Exception("Load neighbors succeeded unexpectedly")
+
+    with open(fname, "w") as f:
+        f.write("# neighbors\n")
+        f.write("\n")
+        f.write("00:11:22:33:44:55 ssid=\"test3\" nr=" + nr1 + " lci=" + lci + "\n")
+        f.write("00:11:22:33:44:56 ssid=\"test3\" nr=" + nr2 + "\n")
+        f.write("00:11:22:33:44:56 ssid=\"test4\" nr=" + nr2 + " stat\n")
+    if "OK" not in hapd.request("LOAD_NEIGHBORS " + fname):
+        raise Exception("Load neighbors failed")
+
+    dev[0].connect("test", key_mgmt="NONE", scan_freq="2412")
+    for i in range(2):
+        if "OK" not in dev[0].request("NEIGHBOR_REP_REQUEST ssid=\"test3\""):
+            raise Exception("Request failed")
+        check_nr_results(dev[0], ["00:11:22:33:44:55", "00:11:22:33:44:56"])
+
+    if "OK" not in hapd.request("REMOVE_NEIGHBOR 00:11:22:33:44:55 ssid=\"test3\""):
+        raise Exception("Remove neighbor failed")
+    if "OK" not in dev[0].request("NEIGHBOR_REP_REQUEST ssid=\"test3\""):
+        raise Exception("Request failed")
+    check_nr_results(dev[0], ["00:11:22:33:44:56"])
+    ev = dev[0].wait_event(["RRM-NEIGHBOR-REP-RECEIVED"], timeout=0.5)
+    if ev is not None:
+        raise Exception("Unexpected neighbor report: " + ev)
+
+    if "OK" not in hapd.request("REMOVE_NEIGHBOR 00:11:22:33:44:56 ssid=\"test4\""):
+        raise Exception("Remove neighbor failed")
+
+    with open(fname, "w") as f:
+        f.write("00:11:22:33:44:57 ssid=\"test5\" nr=" + nr1 + "\n")
+        f.write("00:11:22:33:44:58 ssid=test5 nr=" + nr1 + "\n")
+    res = hapd.request("LOAD_NEIGHBORS " + fname)
+    if "FAIL line=2" not in res:
+        raise Exception("Unexpected load neighbors result: " + res)
+    if "OK" not in hapd.request("REMOVE_NEIGHBOR 00:11:22:33:44:57 ssid=\"test5\""):
+        raise Exception("Entry before the invalid line was not added")
+
+    with open(fname, "w") as f:
+        f.write("# " + 3000 * "x" + "\n")
+        f.write("00:11:22:33:44:57 ssid=\"test5\" nr=" + nr1 + "\n")
+    res = hapd.request("LOAD_NEIGHBORS " + fname)
+    if "FAIL line=1" not in res:
+        raise Exception("Unexpected load neighbors result for a too long line: " + res)
+    os.remove(fname)
+
 def test_rrm_neighbor_rep_req(dev, apdev):
     """wpa_supplicant ctrl_iface NEIGHBOR_REP_REQUEST"""
     check_rrm_support(dev[0])
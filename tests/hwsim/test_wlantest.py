@@ -0,0 +1,69 @@
+# wlantest capture file processing tests
+# Copyright (c) 2026, agent <agent@local>
+#
+# This software may be distributed under the terms of the BSD license.
+# See README for more details.
+
+import filecmp
+import logging
+logger = logging.getLogger()
+import os
+import shutil
+import subprocess
+import time
+
+import hostapd
+import hwsim_utils
+
+def wlantest_read(capture, prefix, args):
+    if os.path.isfile('../../wlantest/wlantest'):
+        prg = '../../wlantest/wlantest'
+    else:
+        prg = 'wlantest'
+    out_pcap = prefix + ".pcap"
+    out_pcapng = prefix + ".pcapng"
+    cmd = [ prg, '-r', capture, '-w', out_pcap, '-n', out_pcapng ] + args
+    logger.info("Run " + str(cmd))
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    out = proc.communicate()[0]
+    logger.debug("wlantest output:\n" + out)
+    if proc.returncode != 0:
+        raise Exception("wlantest failed: " + out)
+    return out_pcap, out_pcapng
+
+def test_wlantest_sharded_read(dev, apdev, params):
+    """wlantest sharded capture file reading matches a serial run"""
+    passphrase = "qwertyuiop"
+    hapd = []
+    for i in range(2):
+        ap_params = hostapd.wpa2_params(ssid="wlantest-%d" % i,
+                                        passphrase=passphrase)
+        hapd.append(hostapd.add_ap(apdev[i], ap_params))
+    for i in range(3):
+        dev[i].connect("wlantest-%d" % (i % 2), psk=passphrase,
+                       scan_freq="2412")
+    for i in range(3):
+        hwsim_utils.test_connectivity(dev[i], hapd[i % 2])
+    dev[0].request("REASSOCIATE")
+    dev[0].wait_connected()
+    hwsim_utils.test_connectivity(dev[0], hapd[0])
+    for i in range(3):
+        dev[i].request("DISCONNECT")
+        dev[i].wait_disconnected()
+    for i in range(2):
+        hapd[i].disable()
+    time.sleep(0.5)
+
+    # Process a stable copy since the capture file is still being written
+    capture = os.path.join(params['logdir'], "wlantest-sharded.pcapng")
+    shutil.copyfile(os.path.join(params['logdir'], "hwsim0.pcapng"), capture)
+    prefix = os.path.join(params['logdir'], "wlantest-sharded")
+    ref = wlantest_read(capture, prefix + "-serial", [ '-p', passphrase ])
+    for threads in [ 1, 2, 4 ]:
+        res = wlantest_read(capture, prefix + "-S%d" % threads,
+                            [ '-p', passphrase, '-S%d' % threads ])
+        if not filecmp.cmp(ref[0], res[0], shallow=False):
+            raise Exception("-w output differs with %d thread(s)" % threads)
+        if not filecmp.cmp(ref[1], res[1], shallow=False):
+            raise Exception("Notes differ with %d thread(s)" % threads)
@@ -0,0 +1,270 @@
+/*
+ * MKA - Peer list scaling benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/eloop.h"
+#include "utils/list.h"
+#include "common/eapol_common.h"
+#include "l2_packet/l2_packet.h"
+#include "pae/ieee802_1x_kay.h"
+
+
+/*
+ * All the simulated ports are on the same wired segment: a frame sent by one
+ * KaY instance is delivered to all the other instances.
+ */
+
+struct l2_packet_data {
+	void (*rx_callback)(void *ctx, const u8 *src_addr,
+			    const u8 *buf, size_t len);
+	void *rx_callback_ctx;
+	struct dl_list list;
+};
+
+struct bench_frame {
+	struct dl_list list;
+	struct l2_packet_data *src;
+	size_t len;
+	u8 buf[];
+};
+
+static struct dl_list segment = DL_LIST_HEAD_INIT(segment);
+static struct dl_list queue = DL_LIST_HEAD_INIT(queue);
+static unsigned int tx_frames, rx_frames;
+static size_t min_live = (size_t) -1, max_live;
+
+
+struct l2_packet_data * l2_packet_init(
+	const char *ifname, const u8 *own_addr, unsigned short protocol,
+	void (*rx_callback)(void *ctx, const u8 *src_addr,
+			    const u8 *buf, size_t len),
+	void *rx_callback_ctx, int l2_hdr)
+{
+	struct l2_packet_data *l2;
+
+	l2 = os_zalloc(sizeof(*l2));
+	if (!l2)
+		return NULL;
+	l2->rx_callback = rx_callback;
+	l2->rx_callback_ctx = rx_callback_ctx;
+	dl_list_add_tail(&segment, &l2->list);
+	return l2;
+}
+
+
+void l2_packet_deinit(struct l2_packet_data *l2)
+{
+	if (!l2)
+		return;
+	dl_list_del(&l2->list);
+	os_free(l2);
+}
+
+
+static void count_live_peers(const u8 *buf, size_t len)
+{
+	const u8 *pos, *end, *first;
+	size_t body_len;
+
+	pos = buf + sizeof(struct ieee8023_hdr) + sizeof(struct ieee802_1x_hdr);
+	first = pos;
+	end = buf + len - 16 /* ICV */;
+	while (end - pos >= 4) {
+		body_len = ((pos[2] & 0x0f) << 8) | pos[3];
+		/* The first parameter set is the Basic Parameter Set */
+		if (pos != first && pos[0] == 1 /* Live Peer List */) {
+			body_len /= 16;
+			if (body_len < min_live)
+				min_live = body_len;
+			if (body_len > max_live)
+				max_live = body_len;
+			return;
+		}
+		if (pos[0] == 255 /* ICV Indicator */)
+			break;
+		pos += 4 + ((body_len + 3) & ~3);
+	}
+
+	min_live = 0;
+}
+
+
+int l2_packet_send(struct l2_packet_data *l2, const u8 *dst_addr, u16 proto,
+		   const u8 *buf, size_t len)
+{
+	struct bench_frame *frame;
+
+	frame = os_malloc(sizeof(*frame) + len);
+	if (!frame)
+		return -1;
+	frame->src = l2;
+	frame->len = len;
+	os_memcpy(frame->buf, buf, len);
+	dl_list_add_tail(&queue, &frame->list);
+	tx_frames++;
+	return 0;
+}
+
+
+static void deliver_frames(int count)
+{
+	struct bench_frame *frame;
+	struct l2_packet_data *l2;
+
+	while ((frame = dl_list_first(&queue, struct bench_frame, list))) {
+		dl_list_del(&frame->list);
+		if (count)
+			count_live_peers(frame->buf, frame->len);
+		dl_list_for_each(l2, &segment, struct l2_packet_data, list) {
+			if (l2 == frame->src)
+				continue;
+			l2->rx_callback(l2->rx_callback_ctx,
+					frame->buf + ETH_ALEN,
+					frame->buf, frame->len);
+			rx_frames++;
+		}
+		os_free(frame);
+	}
+}
+
+
+static int bench_get_capability(void *priv, enum macsec_cap *cap)
+{
+	*cap = MACSEC_CAP_NOT_IMPLEMENTED;
+	return 0;
+}
+
+
+static double elapsed(struct os_reltime *start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	return diff.sec + diff.usec / 1000000.0;
+}
+
+
+static void usage(void)
+{
+	printf("usage: mka-bench [-p<ports>] [-r<rounds>]\n"
+	       "\n"
+	       "  -p = number of MKA participants on the segment "
+	       "(default: 100)\n"
+	       "  -r = number of MKPDU rounds (default: 10)\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	struct ieee802_1x_kay **kay;
+	struct ieee802_1x_kay_ctx *ctx;
+	struct mka_key_name ckn;
+	struct mka_key cak;
+	struct os_reltime start;
+	double sec, total = 0;
+	int ports = 100, rounds = 10;
+	int c, i, r, ret = -1;
+	u8 addr[ETH_ALEN];
+
+	for (;;) {
+		c = getopt(argc, argv, "hp:r:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'p':
+			ports = atoi(optarg);
+			break;
+		case 'r':
+			rounds = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (ports < 2 || rounds < 2) {
+		usage();
+		return -1;
+	}
+
+	if (os_program_init())
+		return -1;
+	wpa_debug_level = MSG_ERROR + 1;
+	if (eloop_init())
+		return -1;
+
+	kay = os_calloc(ports, sizeof(*kay));
+	if (!kay)
+		goto fail;
+
+	os_memset(&ckn, 0, sizeof(ckn));
+	os_memcpy(ckn.name, "mka-bench-segment", 17);
+	ckn.len = 17;
+	os_memset(&cak, 0x11, sizeof(cak));
+	cak.len = 16;
+
+	for (i = 0; i < ports; i++) {
+		ctx = os_zalloc(sizeof(*ctx));
+		if (!ctx)
+			goto fail;
+		ctx->macsec_get_capability = bench_get_capability;
+
+		addr[0] = 0x02;
+		addr[1] = 0x00;
+		WPA_PUT_BE32(&addr[2], i + 1);
+		kay[i] = ieee802_1x_kay_init(ctx, SHOULD_SECURE, 1, 0xff,
+					     "mka-bench", addr);
+		if (!kay[i]) {
+			printf("Failed to initialize KaY %d\n", i);
+			goto fail;
+		}
+		if (!ieee802_1x_kay_create_mka(kay[i], &ckn, &cak, 0, PSK,
+					       FALSE)) {
+			printf("Failed to create MKA participant %d\n", i);
+			goto fail;
+		}
+	}
+
+	for (r = 0; r < rounds; r++) {
+		os_get_reltime(&start);
+		for (i = 0; i < ports; i++) {
+			ieee802_1x_kay_enable_new_info(kay[i]);
+			deliver_frames(r == rounds - 1);
+		}
+		sec = elapsed(&start);
+		/* The first rounds build up the peer lists */
+		if (r >= 2)
+			total += sec;
+		printf("round %d: %.3f ms\n", r, sec * 1000.0);
+	}
+
+	printf("ports=%d rounds=%d tx=%u rx=%u live_peers=%zu..%zu\n",
+	       ports, rounds, tx_frames, rx_frames,
+	       min_live == (size_t) -1 ? 0 : min_live, max_live);
+	if (rounds > 2)
+		printf("steady state: %.3f ms/round, %.0f MKPDUs/s received\n",
+		       total * 1000.0 / (rounds - 2),
+		       total > 0 ? (double) ports * (ports - 1) *
+		       (rounds - 2) / total : 0.0);
+
+	ret = 0;
+fail:
+	for (i = 0; kay && i < ports; i++)
+		ieee802_1x_kay_deinit(kay[i]);
+	os_free(kay);
+	deliver_frames(0);
+	eloop_destroy();
+	os_program_deinit();
+
+	return ret;
+}
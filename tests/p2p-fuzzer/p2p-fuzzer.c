@@ -68,12 +68,12 @@ static void go_neg_req_rx(void *ctx, const u8 *src, u16 dev_passwd_id)
 }
 
 
-static struct p2p_data * init_p2p(void)
+static struct p2p_data * init_p2p(size_t max_peers)
 {
 	struct p2p_config p2p;
 
 	os_memset(&p2p, 0, sizeof(p2p));
-	p2p.max_peers = 100;
+	p2p.max_peers = max_peers;
 	p2p.passphrase_len = 8;
 	p2p.channels.reg_classes = 1;
 	p2p.channels.reg_class[0].reg_class = 81;
@@ -97,6 +97,8 @@ static struct p2p_data * init_p2p(void)
 struct arg_ctx {
 	struct p2p_data *p2p;
 	const char *fname;
+	unsigned int peers;
+	unsigned int rounds;
 };
 
 
@@ -160,30 +162,141 @@ out:
 }
 
 
+static u8 * find_dev_info_addr(u8 *ies, size_t len)
+{
+	u8 *pos = ies, *end = ies + len, *a, *a_end;
+
+	while (end - pos >= 2 && end - pos - 2 >= pos[1]) {
+		if (pos[0] == WLAN_EID_VENDOR_SPECIFIC && pos[1] >= 4 &&
+		    WPA_GET_BE32(&pos[2]) == P2P_IE_VENDOR_TYPE) {
+			a = pos + 6;
+			a_end = pos + 2 + pos[1];
+			while (a_end - a >= 3 &&
+			       a_end - a - 3 >= WPA_GET_LE16(&a[1])) {
+				if (a[0] == P2P_ATTR_DEVICE_INFO &&
+				    WPA_GET_LE16(&a[1]) >= ETH_ALEN)
+					return a + 3;
+				a += 3 + WPA_GET_LE16(&a[1]);
+			}
+		}
+		pos += 2 + pos[1];
+	}
+
+	return NULL;
+}
+
+
+static double elapsed(struct os_reltime *start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	return diff.sec + diff.usec / 1000000.0;
+}
+
+
+static void test_flood(void *eloop_data, void *user_ctx)
+{
+	struct arg_ctx *ctx = eloop_data;
+	char *data;
+	size_t len;
+	u8 *dev_addr, bssid[ETH_ALEN];
+	unsigned int i, r, known = 0;
+	struct os_reltime rx_time, start;
+	double rx_sec = 0, lookup_sec = 0, expire_sec = 0;
+
+	data = os_readfile(ctx->fname, &len);
+	if (!data) {
+		wpa_printf(MSG_ERROR, "Could not read '%s'", ctx->fname);
+		goto out;
+	}
+
+	dev_addr = find_dev_info_addr((u8 *) data, len);
+	if (!dev_addr) {
+		wpa_printf(MSG_ERROR, "No P2P Device Info attribute in '%s'",
+			   ctx->fname);
+		goto out;
+	}
+
+	for (r = 0; r < ctx->rounds; r++) {
+		os_get_reltime(&start);
+		for (i = 0; i < ctx->peers; i++) {
+			os_memcpy(bssid, "\x02\x00\x00\x00\x00\x00", ETH_ALEN);
+			WPA_PUT_BE24(&bssid[3], i);
+			os_memcpy(dev_addr, bssid, ETH_ALEN);
+			dev_addr[0] |= 0x04;
+			os_get_reltime(&rx_time);
+			p2p_scan_res_handler(ctx->p2p, bssid, 2412, &rx_time, 0,
+					     (u8 *) data, len);
+		}
+		p2p_scan_res_handled(ctx->p2p);
+		rx_sec += elapsed(&start);
+
+		os_get_reltime(&start);
+		for (i = 0; i < ctx->peers; i++) {
+			os_memcpy(bssid, "\x06\x00\x00\x00\x00\x00", ETH_ALEN);
+			WPA_PUT_BE24(&bssid[3], i);
+			if (p2p_peer_known(ctx->p2p, bssid))
+				known++;
+		}
+		lookup_sec += elapsed(&start);
+
+		os_get_reltime(&start);
+		p2p_expire_peers(ctx->p2p);
+		expire_sec += elapsed(&start);
+	}
+
+	printf("peers=%u rounds=%u known=%u\n", ctx->peers, ctx->rounds, known);
+	printf("rx=%.3f s (%.0f frames/s) lookup=%.3f s (%.0f lookups/s) expire=%.3f ms/round\n",
+	       rx_sec, rx_sec > 0 ? ctx->peers * ctx->rounds / rx_sec : 0.0,
+	       lookup_sec,
+	       lookup_sec > 0 ? ctx->peers * ctx->rounds / lookup_sec : 0.0,
+	       expire_sec * 1000.0 / ctx->rounds);
+
+out:
+	os_free(data);
+	eloop_terminate();
+}
+
+
 int main(int argc, char *argv[])
 {
 	struct p2p_data *p2p;
 	struct arg_ctx ctx;
+	size_t max_peers = 100;
 
 	/* TODO: probreq and wpas_p2p_probe_req_rx() */
 
 	if (argc < 3) {
-		printf("usage: %s <proberesp|action> <file>\n", argv[0]);
+		printf("usage: %s <proberesp|action> <file>\n"
+		       "       %s flood <proberesp file> [peers] [rounds]\n",
+		       argv[0], argv[0]);
 		return -1;
 	}
 
+	os_memset(&ctx, 0, sizeof(ctx));
+	ctx.peers = argc > 3 ? atoi(argv[3]) : 1000;
+	ctx.rounds = argc > 4 ? atoi(argv[4]) : 10;
+	if (ctx.rounds < 1)
+		ctx.rounds = 1;
+
 	if (os_program_init())
 		return -1;
 
 	wpa_debug_level = 0;
 	wpa_debug_show_keys = 1;
+	if (os_strcmp(argv[1], "flood") == 0) {
+		wpa_debug_level = MSG_ERROR;
+		max_peers = ctx.peers;
+	}
 
 	if (eloop_init()) {
 		wpa_printf(MSG_ERROR, "Failed to initialize event loop");
 		return -1;
 	}
 
-	p2p = init_p2p();
+	p2p = init_p2p(max_peers);
 	if (!p2p) {
 		wpa_printf(MSG_ERROR, "P2P init failed");
 		return -1;
@@ -196,6 +309,8 @@ int main(int argc, char *argv[])
 		eloop_register_timeout(0, 0, test_send_proberesp, &ctx, NULL);
 	} else if (os_strcmp(argv[1], "action") == 0) {
 		eloop_register_timeout(0, 0, test_send_action, &ctx, NULL);
+	} else if (os_strcmp(argv[1], "flood") == 0) {
+		eloop_register_timeout(0, 0, test_flood, &ctx, NULL);
 	} else {
 		wpa_printf(MSG_ERROR, "Unsupported test type '%s'", argv[1]);
 		return -1;
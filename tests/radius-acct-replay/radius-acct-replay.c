@@ -0,0 +1,374 @@
+/*
+ * RADIUS accounting replay benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+#include <poll.h>
+
+#include "utils/common.h"
+#include "utils/wpabuf.h"
+#include "radius/radius.h"
+#include "utils/latency_stats.h"
+
+
+/*
+ * Each simulated NAS uses its own UDP socket (and source port) and has up to
+ * 256 requests (one per RADIUS Identifier) outstanding. The Accounting-Request
+ * (Interim-Update) messages are built once and then replayed.
+ */
+
+struct replay_nas {
+	int sock;
+	struct wpabuf *req[256];
+	struct os_reltime sent[256];
+	u8 pending[256];
+	unsigned int num_pending;
+	unsigned int next_id;
+};
+
+static const char *secret = "radius";
+
+
+static struct wpabuf * replay_build(unsigned int nas, unsigned int id)
+{
+	struct radius_msg *msg;
+	struct wpabuf *buf;
+	char txt[100];
+
+	msg = radius_msg_new(RADIUS_CODE_ACCOUNTING_REQUEST, id);
+	if (!msg)
+		return NULL;
+
+	os_snprintf(txt, sizeof(txt), "%08X-%08X", nas, id);
+	if (!radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_STATUS_TYPE,
+				       RADIUS_ACCT_STATUS_TYPE_INTERIM_UPDATE) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_ACCT_SESSION_ID,
+				 (u8 *) txt, os_strlen(txt)))
+		goto fail;
+	os_snprintf(txt, sizeof(txt), "user%u@example.com", id);
+	if (!radius_msg_add_attr(msg, RADIUS_ATTR_USER_NAME, (u8 *) txt,
+				 os_strlen(txt)))
+		goto fail;
+	os_snprintf(txt, sizeof(txt), "ap%u.example.com", nas);
+	if (!radius_msg_add_attr(msg, RADIUS_ATTR_NAS_IDENTIFIER, (u8 *) txt,
+				 os_strlen(txt)))
+		goto fail;
+	os_snprintf(txt, sizeof(txt), "02-00-%02X-%02X-%02X-00:replay",
+		    (nas >> 16) & 0xff, (nas >> 8) & 0xff, nas & 0xff);
+	if (!radius_msg_add_attr(msg, RADIUS_ATTR_CALLED_STATION_ID,
+				 (u8 *) txt, os_strlen(txt)))
+		goto fail;
+	os_snprintf(txt, sizeof(txt), "02-01-%02X-%02X-%02X-%02X",
+		    (nas >> 8) & 0xff, nas & 0xff, id, 0);
+	if (!radius_msg_add_attr(msg, RADIUS_ATTR_CALLING_STATION_ID,
+				 (u8 *) txt, os_strlen(txt)) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_NAS_PORT_TYPE,
+				       RADIUS_NAS_PORT_TYPE_IEEE_802_11) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_SESSION_TIME,
+				       600) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_INPUT_OCTETS,
+				       1000000 + id) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_OUTPUT_OCTETS,
+				       2000000 + id) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_INPUT_PACKETS,
+				       1000 + id) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_ACCT_OUTPUT_PACKETS,
+				       2000 + id))
+		goto fail;
+
+	radius_msg_finish_acct(msg, (u8 *) secret, os_strlen(secret));
+	buf = wpabuf_dup(radius_msg_get_buf(msg));
+	radius_msg_free(msg);
+	return buf;
+
+fail:
+	radius_msg_free(msg);
+	return NULL;
+}
+
+
+/* Server process CPU time (user + system) in clock ticks or 0 if unknown */
+static unsigned long replay_cpu_ticks(int pid)
+{
+	char fname[50], buf[1000], *pos;
+	unsigned long utime, stime;
+	unsigned int i;
+	FILE *f;
+	size_t len;
+
+	if (pid <= 0)
+		return 0;
+	os_snprintf(fname, sizeof(fname), "/proc/%d/stat", pid);
+	f = fopen(fname, "r");
+	if (!f)
+		return 0;
+	len = fread(buf, 1, sizeof(buf) - 1, f);
+	fclose(f);
+	buf[len] = '\0';
+
+	/* Fields 14 and 15 follow the command name in parentheses */
+	pos = os_strrchr(buf, ')');
+	if (!pos)
+		return 0;
+	for (i = 0; i < 12 && pos; i++)
+		pos = os_strchr(pos + 1, ' ');
+	if (!pos || sscanf(pos + 1, "%lu %lu", &utime, &stime) != 2)
+		return 0;
+	return utime + stime;
+}
+
+
+static int replay_run(struct replay_nas *nas, unsigned int num_nas,
+		      unsigned int num_req, unsigned int window,
+		      unsigned int burst, int server_pid)
+{
+	struct os_reltime start, now, diff;
+	struct latency_samples latency;
+	unsigned int tx = 0, rx = 0, lost = 0, bad = 0, next = 0;
+	unsigned int i, j;
+	unsigned long ticks;
+	struct pollfd *pfd;
+	double secs;
+	int ret = -1;
+
+	os_memset(&latency, 0, sizeof(latency));
+	pfd = os_calloc(num_nas, sizeof(*pfd));
+	if (!pfd)
+		goto out;
+	for (i = 0; i < num_nas; i++) {
+		pfd[i].fd = nas[i].sock;
+		pfd[i].events = POLLIN;
+	}
+
+	ticks = replay_cpu_ticks(server_pid);
+	os_get_reltime(&start);
+	while (rx + lost < num_req) {
+		int res;
+
+		/*
+		 * Refill the window only after it has drained to window - burst
+		 * so that the requests arrive at the server in bursts.
+		 */
+		if (tx < num_req && tx - rx - lost + burst <= window) {
+			while (tx < num_req && tx - rx - lost < window) {
+				struct replay_nas *n;
+				struct wpabuf *req;
+				unsigned int id;
+
+				n = &nas[next++ % num_nas];
+				if (n->num_pending == 256)
+					continue;
+				while (n->pending[n->next_id])
+					n->next_id = (n->next_id + 1) % 256;
+				id = n->next_id;
+				req = n->req[id];
+				os_get_reltime(&n->sent[id]);
+				if (send(n->sock, wpabuf_head(req),
+					 wpabuf_len(req), 0) < 0) {
+					perror("send");
+					goto out;
+				}
+				n->pending[id] = 1;
+				n->num_pending++;
+				tx++;
+			}
+			continue;
+		}
+
+		res = poll(pfd, num_nas, 200);
+		if (res < 0) {
+			perror("poll");
+			goto out;
+		}
+		if (res == 0) {
+			/* Requests that were dropped, e.g., due to a full socket
+			 * receive buffer on the server, are not retransmitted */
+			for (i = 0; i < num_nas; i++) {
+				lost += nas[i].num_pending;
+				os_memset(nas[i].pending, 0,
+					  sizeof(nas[i].pending));
+				nas[i].num_pending = 0;
+			}
+			continue;
+		}
+
+		for (i = 0; i < num_nas; i++) {
+			u8 buf[RADIUS_MAX_MSG_LEN];
+			struct replay_nas *n = &nas[i];
+			ssize_t len;
+
+			if (!(pfd[i].revents & POLLIN))
+				continue;
+			while ((len = recv(n->sock, buf, sizeof(buf),
+					   MSG_DONTWAIT)) > 0) {
+				const struct radius_hdr *hdr;
+
+				hdr = (const struct radius_hdr *) buf;
+				j = hdr->identifier;
+				if ((size_t) len < sizeof(*hdr) ||
+				    hdr->code !=
+				    RADIUS_CODE_ACCOUNTING_RESPONSE ||
+				    !n->pending[j]) {
+					bad++;
+					continue;
+				}
+				os_get_reltime(&now);
+				os_reltime_sub(&now, &n->sent[j], &diff);
+				n->pending[j] = 0;
+				n->num_pending--;
+				latency_samples_add(&latency,
+						    diff.sec * 1000000 +
+						    diff.usec);
+				rx++;
+			}
+		}
+	}
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, &start, &diff);
+	secs = diff.sec + diff.usec / 1000000.0;
+
+	printf("%u Accounting-Requests from %u NAS sockets (window %u, burst "
+	       "%u) in %.3f s: %.0f responses/s\n",
+	       num_req, num_nas, window, burst, secs,
+	       secs > 0 ? rx / secs : 0.0);
+	latency_samples_print("Latency", &latency);
+	if (server_pid > 0) {
+		ticks = replay_cpu_ticks(server_pid) - ticks;
+		printf("Server CPU: %.3f s, %.2f us/request\n",
+		       (double) ticks / sysconf(_SC_CLK_TCK),
+		       (double) ticks * 1000000.0 / sysconf(_SC_CLK_TCK) /
+		       num_req);
+	}
+	printf("Lost requests: %u  Unexpected responses: %u\n", lost, bad);
+	ret = bad ? -1 : 0;
+
+out:
+	latency_samples_free(&latency);
+	os_free(pfd);
+	return ret;
+}
+
+
+static void usage(void)
+{
+	printf("usage: radius-acct-replay [-a<server IPv4 address>] "
+	       "[-p<port>] [-s<secret>]\n"
+	       "                          [-c<NAS sockets>] [-n<requests>] "
+	       "[-w<window>] [-b<burst>]\n"
+	       "                          [-P<server pid>]\n"
+	       "\n"
+	       "Run, e.g., hostapd with a RADIUS server configuration:\n"
+	       "  radius_server_clients=<file with 127.0.0.1/32 radius>\n"
+	       "  radius_server_acct_port=1813\n"
+	       "  radius_server_batch=32\n"
+	       "and replay accounting requests to it:\n"
+	       "  radius-acct-replay -c 64 -n 1000000 -w 512 -b 256 "
+	       "-P <hostapd pid>\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	const char *addr = "127.0.0.1";
+	unsigned int num_nas = 16, num_req = 100000, window = 256, burst = 64;
+	int port = 1813, server_pid = 0, c, ret = -1;
+	struct replay_nas *nas;
+	struct sockaddr_in sin;
+	unsigned int i, j;
+
+	for (;;) {
+		c = getopt(argc, argv, "a:b:c:hn:p:P:s:w:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'a':
+			addr = optarg;
+			break;
+		case 'b':
+			burst = atoi(optarg);
+			break;
+		case 'c':
+			num_nas = atoi(optarg);
+			break;
+		case 'h':
+			usage();
+			return 0;
+		case 'n':
+			num_req = atoi(optarg);
+			break;
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'P':
+			server_pid = atoi(optarg);
+			break;
+		case 's':
+			secret = optarg;
+			break;
+		case 'w':
+			window = atoi(optarg);
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (num_nas == 0 || num_req == 0 || window == 0 || burst == 0) {
+		usage();
+		return -1;
+	}
+	if (window > num_nas * 256)
+		window = num_nas * 256;
+	if (burst > window)
+		burst = window;
+
+	os_memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_port = htons(port);
+	if (inet_aton(addr, &sin.sin_addr) == 0) {
+		printf("Invalid server address '%s'\n", addr);
+		return -1;
+	}
+
+	nas = os_calloc(num_nas, sizeof(*nas));
+	if (!nas)
+		return -1;
+	for (i = 0; i < num_nas; i++)
+		nas[i].sock = -1;
+
+	for (i = 0; i < num_nas; i++) {
+		nas[i].sock = socket(PF_INET, SOCK_DGRAM, 0);
+		if (nas[i].sock < 0) {
+			perror("socket");
+			goto out;
+		}
+		if (connect(nas[i].sock, (struct sockaddr *) &sin,
+			    sizeof(sin)) < 0) {
+			perror("connect");
+			goto out;
+		}
+		for (j = 0; j < 256; j++) {
+			nas[i].req[j] = replay_build(i, j);
+			if (!nas[i].req[j])
+				goto out;
+		}
+	}
+
+	ret = replay_run(nas, num_nas, num_req, window, burst, server_pid);
+
+out:
+	for (i = 0; i < num_nas; i++) {
+		if (nas[i].sock >= 0)
+			close(nas[i].sock);
+		for (j = 0; j < 256; j++)
+			wpabuf_free(nas[i].req[j]);
+	}
+	os_free(nas);
+	return ret < 0 ? -1 : 0;
+}
@@ -0,0 +1,256 @@
+/*
+ * RADIUS message construction and parsing benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+#include "utils/wpabuf.h"
+#include "radius/radius.h"
+
+
+static const char *secret = "radius";
+static unsigned long allocs;
+
+
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t nmemb, size_t size);
+void * __real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void * __wrap_malloc(size_t size)
+{
+	allocs++;
+	return __real_malloc(size);
+}
+
+
+void * __wrap_calloc(size_t nmemb, size_t size)
+{
+	allocs++;
+	return __real_calloc(nmemb, size);
+}
+
+
+void * __wrap_realloc(void *ptr, size_t size)
+{
+	allocs++;
+	return __real_realloc(ptr, size);
+}
+
+
+void __wrap_free(void *ptr)
+{
+	__real_free(ptr);
+}
+
+
+/*
+ * Access-Request similar to the ones ieee802_1x_encapsulate_radius() sends
+ * with eap_len octets of EAP data
+ */
+static struct radius_msg * bench_build(int presize, const u8 *eap,
+				       size_t eap_len)
+{
+	struct radius_msg *msg;
+	u8 state[32];
+	const char *user = "user@example.com";
+	const char *nas_id = "ap.example.com";
+	const char *called = "02-00-00-00-03-00:radius-bench";
+	const char *calling = "02-00-00-00-00-01";
+	const char *connect = "CONNECT 54Mbps 802.11g";
+
+	if (presize)
+		msg = radius_msg_new_len(RADIUS_CODE_ACCESS_REQUEST, 1,
+					 RADIUS_EAP_ATTR_ESTIMATE +
+					 radius_msg_eap_len(eap_len));
+	else
+		msg = radius_msg_new(RADIUS_CODE_ACCESS_REQUEST, 1);
+	if (!msg)
+		return NULL;
+
+	os_memset(state, 0x55, sizeof(state));
+	/*
+	 * The Request Authenticator is left zero since getting random data for
+	 * it with radius_msg_make_authenticator() would dominate the timing.
+	 */
+	if (!radius_msg_add_attr(msg, RADIUS_ATTR_USER_NAME, (u8 *) user,
+				 os_strlen(user)) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_NAS_IDENTIFIER,
+				 (u8 *) nas_id, os_strlen(nas_id)) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_NAS_PORT, 1) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_NAS_PORT_TYPE,
+				       RADIUS_NAS_PORT_TYPE_IEEE_802_11) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CALLED_STATION_ID,
+				 (u8 *) called, os_strlen(called)) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CALLING_STATION_ID,
+				 (u8 *) calling, os_strlen(calling)) ||
+	    !radius_msg_add_attr_int32(msg, RADIUS_ATTR_FRAMED_MTU, 1400) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_CONNECT_INFO,
+				 (u8 *) connect, os_strlen(connect)) ||
+	    !radius_msg_add_attr(msg, RADIUS_ATTR_STATE, state,
+				 sizeof(state)) ||
+	    !radius_msg_add_eap(msg, eap, eap_len) ||
+	    radius_msg_finish(msg, (u8 *) secret, os_strlen(secret)) < 0) {
+		radius_msg_free(msg);
+		return NULL;
+	}
+
+	return msg;
+}
+
+
+enum bench_op {
+	BENCH_BUILD, BENCH_BUILD_PRESIZED, BENCH_PARSE, BENCH_PARSE_INPLACE,
+	BENCH_GET_EAP, BENCH_GET_EAP_VEC, NUM_BENCH_OPS
+};
+
+static const char *bench_op_name[NUM_BENCH_OPS] = {
+	"build", "build presized", "parse copy", "parse in place",
+	"get_eap", "get_eap_vec"
+};
+
+
+static int bench_op(enum bench_op op, const u8 *eap, size_t eap_len,
+		    u8 *pkt, size_t pkt_len, struct radius_msg *parsed)
+{
+	struct radius_msg *msg = NULL;
+	struct wpabuf *buf;
+	const u8 *addr[RADIUS_EAP_VEC_LEN];
+	size_t len[RADIUS_EAP_VEC_LEN];
+
+	switch (op) {
+	case BENCH_BUILD:
+	case BENCH_BUILD_PRESIZED:
+		msg = bench_build(op == BENCH_BUILD_PRESIZED, eap, eap_len);
+		break;
+	case BENCH_PARSE:
+		msg = radius_msg_parse(pkt, pkt_len);
+		break;
+	case BENCH_PARSE_INPLACE:
+		msg = radius_msg_parse_inplace(pkt, pkt_len);
+		break;
+	case BENCH_GET_EAP:
+		buf = radius_msg_get_eap(parsed);
+		if (!buf)
+			return -1;
+		wpabuf_free(buf);
+		return 0;
+	case BENCH_GET_EAP_VEC:
+		return radius_msg_get_eap_vec(parsed, addr, len,
+					      RADIUS_EAP_VEC_LEN) > 0 ? 0 : -1;
+	default:
+		return -1;
+	}
+
+	if (!msg)
+		return -1;
+	radius_msg_free(msg);
+	return 0;
+}
+
+
+static void usage(void)
+{
+	printf("usage: radius-bench [-e<EAP length>] [-n<iterations>]\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned int iter = 1000000, i;
+	size_t eap_len = 1400;
+	struct radius_msg *msg, *parsed;
+	struct wpabuf *buf;
+	u8 *eap, *pkt;
+	size_t pkt_len;
+	struct os_reltime start, now, diff;
+	enum bench_op op;
+	unsigned long start_allocs;
+	double usecs;
+	int c, ret = -1;
+
+	for (;;) {
+		c = getopt(argc, argv, "e:hn:");
+		if (c < 0)
+			break;
+		switch (c) {
+		case 'e':
+			eap_len = atoi(optarg);
+			break;
+		case 'h':
+			usage();
+			return 0;
+		case 'n':
+			iter = atoi(optarg);
+			break;
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (eap_len < 5 || eap_len > 3000 || iter == 0) {
+		usage();
+		return -1;
+	}
+
+	eap = os_malloc(eap_len);
+	if (!eap)
+		return -1;
+	eap[0] = 2; /* EAP-Response */
+	eap[1] = 1;
+	WPA_PUT_BE16(&eap[2], eap_len);
+	eap[4] = 13; /* EAP-TLS */
+	for (i = 5; i < eap_len; i++)
+		eap[i] = i;
+
+	msg = bench_build(0, eap, eap_len);
+	if (!msg)
+		goto fail;
+	buf = radius_msg_get_buf(msg);
+	pkt_len = wpabuf_len(buf);
+	pkt = os_memdup(wpabuf_head(buf), pkt_len);
+	radius_msg_free(msg);
+	if (!pkt)
+		goto fail;
+	parsed = radius_msg_parse_inplace(pkt, pkt_len);
+	if (!parsed)
+		goto fail_pkt;
+
+	printf("Access-Request: %lu octets with %lu octets of EAP data, "
+	       "%u iterations\n",
+	       (unsigned long) pkt_len, (unsigned long) eap_len, iter);
+
+	for (op = 0; op < NUM_BENCH_OPS; op++) {
+		start_allocs = allocs;
+		os_get_reltime(&start);
+		for (i = 0; i < iter; i++) {
+			if (bench_op(op, eap, eap_len, pkt, pkt_len,
+				     parsed) < 0) {
+				printf("%s failed\n", bench_op_name[op]);
+				goto fail_parsed;
+			}
+		}
+		os_get_reltime(&now);
+		os_reltime_sub(&now, &start, &diff);
+		usecs = diff.sec * 1000000.0 + diff.usec;
+		printf("%-16s %8.1f ns/op %6.2f allocs/op\n",
+		       bench_op_name[op], usecs * 1000.0 / iter,
+		       (double) (allocs - start_allocs) / iter);
+	}
+
+	ret = 0;
+
+fail_parsed:
+	radius_msg_free(parsed);
+fail_pkt:
+	os_free(pkt);
+fail:
+	os_free(eap);
+	return ret;
+}
@@ -0,0 +1,87 @@
+/*
+ * Binary debug file - test program
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * Writes the same debug messages to a text debug file and to a binary debug
+ * file. The decoded binary file (wpa_debug_decode.py -n) must be identical
+ * to the text file.
+ */
+
+#include "utils/includes.h"
+
+#include "utils/common.h"
+
+
+static void write_messages(void)
+{
+	const u8 data[] = "binary\x00\x01\x02\x7f\x80\xff debug file test data";
+	const char *str = "string";
+	long long ll = -1234567890123LL;
+	unsigned long ul = 4000000000UL;
+	size_t len = sizeof(data);
+	int i;
+
+	wpa_printf(MSG_INFO, "plain message without arguments");
+	wpa_printf(MSG_DEBUG, "int %d %i neg %d unsigned %u hex %x %X oct %o",
+		   42, -7, -2147483647 - 1, 4294967295U, 0xabcdef, 0xabcdef,
+		   0755);
+	wpa_printf(MSG_DEBUG, "long %ld %lu %lx long long %lld %llu size %zu",
+		   -12345678L, ul, ul, ll, (unsigned long long) ll, len);
+	wpa_printf(MSG_DEBUG, "short %hd %hu char %hhd %hhu '%c'",
+		   (short) -300, (unsigned short) 65535, (signed char) -5,
+		   (unsigned char) 250, 'x');
+	wpa_printf(MSG_DEBUG, "width [%5d] [%-5d] [%05d] [%+d] [% d] [%#x]",
+		   12, 12, 12, 12, 12, 0x12);
+	wpa_printf(MSG_DEBUG, "star [%*d] [%-*s] [%.*s]", 6, 34, 8, str, 3,
+		   str);
+	wpa_printf(MSG_DEBUG, "string '%s' [%10s] [%-10s] [%.2s] empty '%s'",
+		   str, str, str, str, "");
+	wpa_printf(MSG_DEBUG, "percent 100%% done, MAC " MACSTR, MAC2STR(data));
+	wpa_printf(MSG_WARNING, "%s: level WARNING", __func__);
+	wpa_printf(MSG_ERROR, "level ERROR %d", 3);
+	for (i = 0; i < 3; i++)
+		wpa_printf(MSG_DEBUG, "repeated format %d/%d", i + 1, 3);
+
+	/* Filtered out with the default debug level */
+	wpa_printf(MSG_EXCESSIVE, "excessive %d", 1);
+
+	wpa_hexdump(MSG_DEBUG, "hexdump", data, len);
+	wpa_hexdump(MSG_DEBUG, "empty hexdump", data, 0);
+	wpa_hexdump(MSG_DEBUG, "NULL hexdump", NULL, 5);
+	wpa_hexdump_key(MSG_DEBUG, "hidden key", data, 16);
+	wpa_hexdump_ascii(MSG_DEBUG, "hexdump_ascii", data, len);
+	wpa_hexdump_ascii(MSG_DEBUG, "short hexdump_ascii", data, 5);
+	wpa_hexdump_ascii_key(MSG_DEBUG, "hidden ascii key", data, 16);
+}
+
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		printf("usage: test-debug-log <text file> <binary file>\n");
+		return -1;
+	}
+
+	wpa_debug_level = MSG_DEBUG;
+	wpa_debug_timestamp = 0;
+	wpa_debug_show_keys = 0;
+
+	if (wpa_debug_open_file(argv[1]) < 0) {
+		printf("Could not open %s\n", argv[1]);
+		return -1;
+	}
+	write_messages();
+	wpa_debug_close_file();
+
+	if (wpa_debug_open_binary_file(argv[2]) < 0) {
+		printf("Could not open %s\n", argv[2]);
+		return -1;
+	}
+	write_messages();
+	wpa_debug_close_file();
+
+	return 0;
+}
@@ -0,0 +1,420 @@
+/*
+ * Test program for elliptic curve operations and SAE commit benchmark
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ */
+
+#include "includes.h"
+
+#include "common.h"
+#include "crypto/crypto.h"
+#include "common/ieee802_11_defs.h"
+#include "common/sae.h"
+
+
+struct ec_test_vector {
+	int group;
+	const char *gx;
+	const char *gy;
+	const char *k1;
+	const char *k2;
+	const char *qx; /* Q = k1 * G */
+	const char *qy;
+	const char *sx; /* S = k2 * Q */
+	const char *sy;
+};
+
+static const struct ec_test_vector ec_tests[] = {
+	{ 19,
+	  "6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296",
+	  "4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5",
+	  "22cbf873763f887f65e1b051f93ca07cfda04585669e7e0f54081acf38d87d76",
+	  "533a0874099d1189dee26f0252407ca7e861dd8464dc434a9bfbe2257c48be51",
+	  "57b4c1911ea3ba01c3cfa90532f096d4f68ef8c661f7cefab81bff4d1f039877",
+	  "caca78710dc21c7b06a34fcddf5ad631571470693512e820671069e44789dc8c",
+	  "0ce7eb3eac5027018607b6f21f7a140fcd1e20270b891f83bacda3a50d1ec503",
+	  "c36289b983d4bbf3824944aea7ad10e28f717ff99a6ca6c9116ee4b358e664f0"
+	},
+	{ 20,
+	  "aa87ca22be8b05378eb1c71ef320ad746e1d3b628ba79b9859f741e082542a38"
+	  "5502f25dbf55296c3a545e3872760ab7",
+	  "3617de4a96262c6f5d9e98bf9292dc29f8f41dbd289a147ce9da3113b5f0b8c0"
+	  "0a60b1ce1d7e819d7a431d7c90ea0e5f",
+	  "64cc384d06c80feaff35a08da9955c238c0fd8059082a891fe106e49d5057989"
+	  "6b63a303e03690c30bae400d180ebaa0",
+	  "59cfd86b3bca40ab493b6f0454b4ab62217eb56c7ee9101ed28116bc91cfea39"
+	  "93a58758ab6d73898d2bc256aeefcc95",
+	  "f7fc49d95ddcdcdbf959a1be20108c29de0cfdf5967ba54483229a25a97bf321"
+	  "5b6ea7dc20ee1b625b612d02660c01d6",
+	  "e20b6328a61543692cf6c9e908e507eb6e7decaf988097d07cffbf45185db25b"
+	  "e615c7339bc29989fe750ce99993f716",
+	  "a5885847a2398220f198f8b7174dba8c5282415b60ab209c04bdacffbb46be3e"
+	  "855daf52b17f348b7f40bde8baf8e53d",
+	  "7cbd69aba4a98d655aeb262b35668fc35eebf2c029f9a9c0908e402e730b4694"
+	  "4a0eb00ec3d95aecedcfbb8642867eba"
+	},
+	{ 21,
+	  "00c6858e06b70404e9cd9e3ecb662395b4429c648139053fb521f828af606b4d"
+	  "3dbaa14b5e77efe75928fe1dc127a2ffa8de3348b3c1856a429bf97e7e31c2e5"
+	  "bd66",
+	  "011839296a789a3bc0045c8a5fb42c7d1bd998f54449579b446817afbd17273e"
+	  "662c97ee72995ef42640c550b9013fad0761353c7086a272c24088be94769fd1"
+	  "6650",
+	  "016972249e29f9faa0c301da7b3213f63e790b6109d826d1cfc776f3168da21c"
+	  "2eff7d515c4cc1f5d66da10826fa348a09111db1bdca5f83169ca381577e8393"
+	  "e052",
+	  "0129e8a9544b94f06ebbc98af5157326a6acf64f6c57110c96b78f499c45db2e"
+	  "d6e1401dd1e12d90f8fc1010b957f21b5724f691dad2fdccc0dd3ae964539a88"
+	  "abda",
+	  "01070db6da5725f957ee99814d227297aaadc72f793dfb0a72e9b8566b07e07b"
+	  "0b84238ff2d21996c199fafab7a73d74bcdb95e4f9d52c634408d32e731edaee"
+	  "e203",
+	  "01a231fd276311327b82cc1b9fd8daabc23053456896524d6370532b2eda1993"
+	  "2ed72b6db1b6004bb657ae8254fcecc61d2873d34bba3e58dfefb6bbb59bf427"
+	  "660c",
+	  "0081a1adb1b439f815a04554b047c22e4b06279134d93c4a2fc2aea7038894fb"
+	  "f707c6d77245d024d21e338609356fe567f0ba337ade242d87e11d0f1870f687"
+	  "d554",
+	  "01f828aeb6f299cbd329fdfa13a48e6daa74550fadc1f7b87bb67291ee0db475"
+	  "8122c1874e27929e791f14486022151d4de6a4a57e37daa64f81840307399d73"
+	  "020a"
+	},
+};
+
+
+static struct crypto_ec_point * point_from_hex(struct crypto_ec *e,
+					       const char *x, const char *y)
+{
+	u8 buf[2 * 66];
+	size_t len = crypto_ec_prime_len(e);
+
+	if (hexstr2bin(x, buf, len) < 0 || hexstr2bin(y, buf + len, len) < 0)
+		return NULL;
+	return crypto_ec_point_from_bin(e, buf);
+}
+
+
+static struct crypto_bignum * bignum_from_hex(const char *hex)
+{
+	u8 buf[66];
+	size_t len = os_strlen(hex) / 2;
+
+	if (len > sizeof(buf) || hexstr2bin(hex, buf, len) < 0)
+		return NULL;
+	return crypto_bignum_init_set(buf, len);
+}
+
+
+static int test_ecdh(int group)
+{
+	struct crypto_ecdh *a, *b;
+	struct wpabuf *pub_a = NULL, *pub_b = NULL, *s_a = NULL, *s_b = NULL;
+	int inc_y, ret = -1;
+
+	for (inc_y = 0; inc_y <= 1; inc_y++) {
+		a = crypto_ecdh_init(group);
+		b = crypto_ecdh_init(group);
+		if (a && b) {
+			pub_a = crypto_ecdh_get_pubkey(a, inc_y);
+			pub_b = crypto_ecdh_get_pubkey(b, inc_y);
+		}
+		if (pub_a && pub_b) {
+			s_a = crypto_ecdh_set_peerkey(a, inc_y,
+						      wpabuf_head(pub_b),
+						      wpabuf_len(pub_b));
+			s_b = crypto_ecdh_set_peerkey(b, inc_y,
+						      wpabuf_head(pub_a),
+						      wpabuf_len(pub_a));
+		}
+		ret = !s_a || !s_b || wpabuf_len(s_a) != wpabuf_len(s_b) ||
+			os_memcmp(wpabuf_head(s_a), wpabuf_head(s_b),
+				  wpabuf_len(s_a)) != 0 ? -1 : 0;
+		wpabuf_free(pub_a);
+		wpabuf_free(pub_b);
+		wpabuf_clear_free(s_a);
+		wpabuf_clear_free(s_b);
+		pub_a = pub_b = s_a = s_b = NULL;
+		crypto_ecdh_deinit(a);
+		crypto_ecdh_deinit(b);
+		if (ret < 0) {
+			printf("- ECDH (inc_y=%d) failed\n", inc_y);
+			break;
+		}
+	}
+
+	return ret;
+}
+
+
+static int test_ec(const struct ec_test_vector *t)
+{
+	struct crypto_ec *e;
+	struct crypto_ec_point *g = NULL, *g2 = NULL, *q = NULL, *s = NULL;
+	struct crypto_ec_point *res = NULL, *tmp = NULL, *neg = NULL;
+	struct crypto_bignum *k1 = NULL, *k2 = NULL, *x = NULL, *y = NULL;
+	struct crypto_bignum *y_sqr = NULL, *y2 = NULL;
+	const struct crypto_bignum *prime;
+	u8 buf[2 * 66];
+	size_t len;
+	int ret = -1;
+
+	printf("Group %d\n", t->group);
+
+	e = crypto_ec_init(t->group);
+	if (!e) {
+		printf("- crypto_ec_init failed\n");
+		return -1;
+	}
+	len = crypto_ec_prime_len(e);
+	prime = crypto_ec_get_prime(e);
+
+	g = point_from_hex(e, t->gx, t->gy);
+	q = point_from_hex(e, t->qx, t->qy);
+	s = point_from_hex(e, t->sx, t->sy);
+	k1 = bignum_from_hex(t->k1);
+	k2 = bignum_from_hex(t->k2);
+	res = crypto_ec_point_init(e);
+	tmp = crypto_ec_point_init(e);
+	g2 = crypto_ec_point_init(e);
+	if (!g || !q || !s || !k1 || !k2 || !res || !tmp || !g2) {
+		printf("- Failed to load test vector\n");
+		goto fail;
+	}
+
+	if (crypto_ec_point_mul(e, g, k1, res) < 0 ||
+	    crypto_ec_point_cmp(e, res, q) != 0) {
+		printf("- k1 * G mismatch\n");
+		goto fail;
+	}
+
+	if (crypto_ec_point_mul(e, q, k2, res) < 0 ||
+	    crypto_ec_point_cmp(e, res, s) != 0) {
+		printf("- k2 * Q mismatch\n");
+		goto fail;
+	}
+
+	/* G in non-affine representation: G2 = (G + G) + (-G) */
+	if (crypto_ec_point_add(e, g, g, tmp) < 0 ||
+	    crypto_ec_point_to_bin(e, g, buf, buf + len) < 0 ||
+	    !(neg = crypto_ec_point_from_bin(e, buf)) ||
+	    crypto_ec_point_invert(e, neg) < 0 ||
+	    crypto_ec_point_add(e, tmp, neg, g2) < 0 ||
+	    crypto_ec_point_cmp(e, g, g2) != 0 ||
+	    crypto_ec_point_mul(e, g2, k1, tmp) < 0 ||
+	    crypto_ec_point_cmp(e, tmp, q) != 0) {
+		printf("- k1 * G with generic base point mismatch\n");
+		goto fail;
+	}
+
+	/* P + (-P) = O and order * P = O */
+	if (crypto_ec_point_add(e, g, neg, tmp) < 0 ||
+	    !crypto_ec_point_is_at_infinity(e, tmp) ||
+	    crypto_ec_point_to_bin(e, tmp, buf, NULL) == 0 ||
+	    crypto_ec_point_mul(e, q, crypto_ec_get_order(e), tmp) < 0 ||
+	    !crypto_ec_point_is_at_infinity(e, tmp) ||
+	    !crypto_ec_point_is_on_curve(e, q)) {
+		printf("- Point at infinity handling failed\n");
+		goto fail;
+	}
+
+	/* y^2 = x^3 + ax + b and y coordinate recovery */
+	x = bignum_from_hex(t->qx);
+	y = bignum_from_hex(t->qy);
+	y2 = crypto_bignum_init();
+	if (!x || !y || !y2 ||
+	    !(y_sqr = crypto_ec_point_compute_y_sqr(e, x)) ||
+	    crypto_bignum_mulmod(y, y, prime, y2) < 0 ||
+	    crypto_bignum_cmp(y_sqr, y2) != 0 ||
+	    crypto_bignum_legendre(y_sqr, prime) != 1 ||
+	    crypto_ec_point_solve_y_coord(e, tmp, x,
+					  crypto_bignum_is_zero(y) ? 0 :
+					  (hex2byte(t->qy + 2 * len - 2) & 1))
+	    < 0 ||
+	    crypto_ec_point_cmp(e, tmp, q) != 0) {
+		printf("- y coordinate derivation failed\n");
+		goto fail;
+	}
+
+	/* Points that are not on the curve must be rejected */
+	if (crypto_ec_point_to_bin(e, q, buf, buf + len) < 0)
+		goto fail;
+	buf[2 * len - 1] ^= 0x01;
+	crypto_ec_point_deinit(tmp, 0);
+	tmp = crypto_ec_point_from_bin(e, buf);
+	if (tmp && crypto_ec_point_is_on_curve(e, tmp)) {
+		printf("- Invalid point accepted\n");
+		goto fail;
+	}
+
+	if (test_ecdh(t->group) < 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	crypto_ec_point_deinit(g, 0);
+	crypto_ec_point_deinit(g2, 0);
+	crypto_ec_point_deinit(q, 0);
+	crypto_ec_point_deinit(s, 0);
+	crypto_ec_point_deinit(res, 0);
+	crypto_ec_point_deinit(tmp, 0);
+	crypto_ec_point_deinit(neg, 0);
+	crypto_bignum_deinit(k1, 1);
+	crypto_bignum_deinit(k2, 1);
+	crypto_bignum_deinit(x, 0);
+	crypto_bignum_deinit(y, 0);
+	crypto_bignum_deinit(y2, 0);
+	crypto_bignum_deinit(y_sqr, 0);
+	crypto_ec_deinit(e);
+	return ret;
+}
+
+
+static int sae_commit_exchange(int group)
+{
+	struct sae_data a, b;
+	struct wpabuf *buf;
+	const u8 addr_a[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+	const u8 addr_b[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+	const char *pw = "mekmitasdigoat";
+	int groups[] = { group, 0 };
+	int ret = -1;
+
+	os_memset(&a, 0, sizeof(a));
+	os_memset(&b, 0, sizeof(b));
+	buf = wpabuf_alloc(1000);
+	if (!buf ||
+	    sae_set_group(&a, group) < 0 || sae_set_group(&b, group) < 0 ||
+	    sae_prepare_commit(addr_a, addr_b, (const u8 *) pw, os_strlen(pw),
+			       &a) < 0 ||
+	    sae_prepare_commit(addr_b, addr_a, (const u8 *) pw, os_strlen(pw),
+			       &b) < 0)
+		goto fail;
+
+	sae_write_commit(&b, buf, NULL);
+	if (sae_parse_commit(&a, wpabuf_head(buf), wpabuf_len(buf), NULL, NULL,
+			     groups) != WLAN_STATUS_SUCCESS ||
+	    sae_process_commit(&a) < 0)
+		goto fail;
+
+	wpabuf_free(buf);
+	buf = wpabuf_alloc(1000);
+	if (!buf)
+		goto fail;
+	sae_write_commit(&a, buf, NULL);
+	if (sae_parse_commit(&b, wpabuf_head(buf), wpabuf_len(buf), NULL, NULL,
+			     groups) != WLAN_STATUS_SUCCESS ||
+	    sae_process_commit(&b) < 0 ||
+	    os_memcmp(a.pmk, b.pmk, SAE_PMK_LEN) != 0)
+		goto fail;
+
+	ret = 0;
+fail:
+	wpabuf_free(buf);
+	sae_clear_data(&a);
+	sae_clear_data(&b);
+	return ret;
+}
+
+
+static double time_diff(struct os_reltime *start)
+{
+	struct os_reltime now, diff;
+
+	os_get_reltime(&now);
+	os_reltime_sub(&now, start, &diff);
+	return diff.sec + diff.usec / 1000000.0;
+}
+
+
+static int bench(int iterations)
+{
+	size_t i;
+	int j;
+
+	for (i = 0; i < ARRAY_SIZE(ec_tests); i++) {
+		const struct ec_test_vector *t = &ec_tests[i];
+		struct crypto_ec *e;
+		struct crypto_ec_point *g, *q, *res;
+		struct crypto_bignum *k;
+		struct crypto_ecdh *ecdh;
+		struct os_reltime start;
+		double base, var, dh, sae;
+
+		e = crypto_ec_init(t->group);
+		if (!e)
+			return -1;
+		g = point_from_hex(e, t->gx, t->gy);
+		q = point_from_hex(e, t->qx, t->qy);
+		k = bignum_from_hex(t->k2);
+		res = crypto_ec_point_init(e);
+		if (!g || !q || !k || !res)
+			return -1;
+
+		os_get_reltime(&start);
+		for (j = 0; j < iterations; j++)
+			crypto_ec_point_mul(e, g, k, res);
+		base = time_diff(&start);
+
+		os_get_reltime(&start);
+		for (j = 0; j < iterations; j++)
+			crypto_ec_point_mul(e, q, k, res);
+		var = time_diff(&start);
+
+		os_get_reltime(&start);
+		for (j = 0; j < iterations; j++) {
+			ecdh = crypto_ecdh_init(t->group);
+			crypto_ecdh_deinit(ecdh);
+		}
+		dh = time_diff(&start);
+
+		os_get_reltime(&start);
+		for (j = 0; j < iterations; j++) {
+			if (sae_commit_exchange(t->group) < 0) {
+				printf("SAE commit exchange failed\n");
+				return -1;
+			}
+		}
+		sae = time_diff(&start);
+
+		printf("group %d: k*G %.1f us, k*P %.1f us, ECDH keygen %.1f us, SAE commit exchange %.1f us\n",
+		       t->group, base * 1e6 / iterations,
+		       var * 1e6 / iterations, dh * 1e6 / iterations,
+		       sae * 1e6 / iterations);
+
+		crypto_ec_point_deinit(g, 0);
+		crypto_ec_point_deinit(q, 0);
+		crypto_ec_point_deinit(res, 0);
+		crypto_bignum_deinit(k, 0);
+		crypto_ec_deinit(e);
+	}
+
+	return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+	size_t i;
+	int ret = 0;
+
+	if (argc > 1 && os_strcmp(argv[1], "-b") == 0)
+		return bench(argc > 2 ? atoi(argv[2]) : 100) < 0 ? 1 : 0;
+
+	for (i = 0; i < ARRAY_SIZE(ec_tests); i++) {
+		if (test_ec(&ec_tests[i]) < 0)
+			ret = 1;
+		else if (sae_commit_exchange(ec_tests[i].group) < 0) {
+			printf("- SAE commit exchange failed\n");
+			ret = 1;
+		}
+	}
+
+	if (ret)
+		printf("Something failed\n");
+	else
+		printf("OK\n");
+
+	return ret;
+}
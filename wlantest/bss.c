@@ -7,6 +7,7 @@
  */
 
 #include "utils/includes.h"
+#include <pthread.h>
 
 #include "utils/common.h"
 #include "common/defs.h"
@@ -20,6 +21,9 @@ struct wlantest_bss * bss_find(struct wlantest *wt, const u8 *bssid)
 {
 	struct wlantest_bss *bss;
 
+	if (wt->num_shards > 1)
+		shard_check_bssid(wt, bssid);
+
 	dl_list_for_each(bss, &wt->bss, struct wlantest_bss, list) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0)
 			return bss;
@@ -47,6 +51,7 @@ struct wlantest_bss * bss_get(struct wlantest *wt, const u8 *bssid)
 	dl_list_init(&bss->pmk);
 	dl_list_init(&bss->tdls);
 	os_memcpy(bss->bssid, bssid, ETH_ALEN);
+	bss->first_frame = wt->frame_num;
 	dl_list_add(&wt->bss, &bss->list);
 	wpa_printf(MSG_DEBUG, "Discovered new BSS - " MACSTR,
 		   MAC2STR(bss->bssid));
@@ -84,19 +89,15 @@ void bss_deinit(struct wlantest_bss *bss)
 }
 
 
-int bss_add_pmk_from_passphrase(struct wlantest_bss *bss,
-				const char *passphrase)
+static int bss_add_derived_pmk(struct wlantest_bss *bss,
+			       const char *passphrase, const u8 *pmk_buf)
 {
 	struct wlantest_pmk *pmk;
 
 	pmk = os_zalloc(sizeof(*pmk));
 	if (pmk == NULL)
 		return -1;
-	if (pbkdf2_sha1(passphrase, bss->ssid, bss->ssid_len, 4096,
-			pmk->pmk, sizeof(pmk->pmk)) < 0) {
-		os_free(pmk);
-		return -1;
-	}
+	os_memcpy(pmk->pmk, pmk_buf, sizeof(pmk->pmk));
 
 	wpa_printf(MSG_INFO, "Add possible PMK for BSSID " MACSTR
 		   " based on passphrase '%s'",
@@ -108,18 +109,160 @@ int bss_add_pmk_from_passphrase(struct wlantest_bss *bss,
 }
 
 
+int bss_add_pmk_from_passphrase(struct wlantest_bss *bss,
+				const char *passphrase)
+{
+	u8 pmk[PMK_LEN];
+	int ret;
+
+	if (pbkdf2_sha1(passphrase, bss->ssid, bss->ssid_len, 4096,
+			pmk, sizeof(pmk)) < 0)
+		return -1;
+	ret = bss_add_derived_pmk(bss, passphrase, pmk);
+	os_memset(pmk, 0, sizeof(pmk));
+	return ret;
+}
+
+
+static int passphrase_match(struct wlantest_passphrase *p,
+			    struct wlantest_bss *bss)
+{
+	if (!is_zero_ether_addr(p->bssid) &&
+	    os_memcmp(p->bssid, bss->bssid, ETH_ALEN) != 0)
+		return 0;
+	if (p->ssid_len &&
+	    (p->ssid_len != bss->ssid_len ||
+	     os_memcmp(p->ssid, bss->ssid, p->ssid_len) != 0))
+		return 0;
+	return 1;
+}
+
+
+struct pmk_derive_job {
+	const char *passphrase;
+	u8 pmk[PMK_LEN];
+	int res;
+};
+
+struct pmk_derive_worker {
+	pthread_t thread;
+	const struct wlantest_bss *bss;
+	struct pmk_derive_job *jobs;
+	size_t num_jobs;
+	size_t first;
+	size_t step;
+};
+
+
+static void * pmk_derive_thread(void *ctx)
+{
+	struct pmk_derive_worker *w = ctx;
+	size_t i;
+
+	for (i = w->first; i < w->num_jobs; i += w->step) {
+		struct pmk_derive_job *job = &w->jobs[i];
+
+		job->res = pbkdf2_sha1(job->passphrase, w->bss->ssid,
+				       w->bss->ssid_len, 4096,
+				       job->pmk, sizeof(job->pmk));
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Derive the PMKs for all matching passphrases using wt->pmk_threads worker
+ * threads. PBKDF2 dominates the cost of learning a new SSID when a large
+ * number of passphrases is configured. The resulting PMKs are added in the
+ * same order as the sequential path would add them.
+ */
+static int bss_add_pmk_parallel(struct wlantest *wt, struct wlantest_bss *bss)
+{
+	struct wlantest_passphrase *p;
+	struct pmk_derive_job *jobs;
+	struct pmk_derive_worker *workers;
+	size_t num_jobs = 0, num_workers, i;
+	int *started;
+
+	dl_list_for_each(p, &wt->passphrase, struct wlantest_passphrase, list)
+	{
+		if (passphrase_match(p, bss))
+			num_jobs++;
+	}
+	if (num_jobs < 2)
+		return -1;
+
+	num_workers = wt->pmk_threads;
+	if (num_workers > num_jobs)
+		num_workers = num_jobs;
+
+	jobs = os_calloc(num_jobs, sizeof(*jobs));
+	workers = os_calloc(num_workers, sizeof(*workers));
+	started = os_calloc(num_workers, sizeof(*started));
+	if (!jobs || !workers || !started) {
+		os_free(jobs);
+		os_free(workers);
+		os_free(started);
+		return -1;
+	}
+
+	i = 0;
+	dl_list_for_each(p, &wt->passphrase, struct wlantest_passphrase, list)
+	{
+		if (passphrase_match(p, bss))
+			jobs[i++].passphrase = p->passphrase;
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		workers[i].bss = bss;
+		workers[i].jobs = jobs;
+		workers[i].num_jobs = num_jobs;
+		workers[i].first = i;
+		workers[i].step = num_workers;
+		/* The first share of the work is run in the calling thread */
+		if (i > 0 && pthread_create(&workers[i].thread, NULL,
+					    pmk_derive_thread,
+					    &workers[i]) == 0)
+			started[i] = 1;
+	}
+	for (i = 0; i < num_workers; i++) {
+		if (!started[i])
+			pmk_derive_thread(&workers[i]);
+	}
+	for (i = 0; i < num_workers; i++) {
+		if (started[i])
+			pthread_join(workers[i].thread, NULL);
+	}
+
+	wpa_printf(MSG_DEBUG, "Derived %u PMK(s) for BSSID " MACSTR
+		   " using %u thread(s)", (unsigned int) num_jobs,
+		   MAC2STR(bss->bssid), (unsigned int) num_workers);
+
+	for (i = 0; i < num_jobs; i++) {
+		if (jobs[i].res < 0 ||
+		    bss_add_derived_pmk(bss, jobs[i].passphrase,
+					jobs[i].pmk) < 0)
+			break;
+	}
+
+	bin_clear_free(jobs, num_jobs * sizeof(*jobs));
+	os_free(workers);
+	os_free(started);
+	return 0;
+}
+
+
 static void bss_add_pmk(struct wlantest *wt, struct wlantest_bss *bss)
 {
 	struct wlantest_passphrase *p;
 
+	if (wt->pmk_threads > 1 && bss_add_pmk_parallel(wt, bss) == 0)
+		return;
+
 	dl_list_for_each(p, &wt->passphrase, struct wlantest_passphrase, list)
 	{
-		if (!is_zero_ether_addr(p->bssid) &&
-		    os_memcmp(p->bssid, bss->bssid, ETH_ALEN) != 0)
-			continue;
-		if (p->ssid_len &&
-		    (p->ssid_len != bss->ssid_len ||
-		     os_memcmp(p->ssid, bss->ssid, p->ssid_len) != 0))
+		if (!passphrase_match(p, bss))
 			continue;
 
 		if (bss_add_pmk_from_passphrase(bss, p->passphrase) < 0)
@@ -154,22 +154,22 @@ u8 * ccmp_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 
 	os_memset(aad, 0, sizeof(aad));
 	ccmp_aad_nonce(hdr, data, aad, &aad_len, nonce);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP AAD", aad, aad_len);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP nonce", nonce, 13);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP AAD", aad, aad_len);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP nonce", nonce, 13);
 
 	if (aes_ccm_ad(tk, 16, nonce, 8, data + 8, mlen, aad, aad_len,
 		       data + 8 + mlen, plain) < 0) {
 		u16 seq_ctrl = le_to_host16(hdr->seq_ctrl);
-		wpa_printf(MSG_INFO, "Invalid CCMP MIC in frame: A1=" MACSTR
-			   " A2=" MACSTR " A3=" MACSTR " seq=%u frag=%u",
-			   MAC2STR(hdr->addr1), MAC2STR(hdr->addr2),
-			   MAC2STR(hdr->addr3),
-			   WLAN_GET_SEQ_SEQ(seq_ctrl),
-			   WLAN_GET_SEQ_FRAG(seq_ctrl));
+		wt_printf(MSG_INFO, "Invalid CCMP MIC in frame: A1=" MACSTR
+			  " A2=" MACSTR " A3=" MACSTR " seq=%u frag=%u",
+			  MAC2STR(hdr->addr1), MAC2STR(hdr->addr2),
+			  MAC2STR(hdr->addr3),
+			  WLAN_GET_SEQ_SEQ(seq_ctrl),
+			  WLAN_GET_SEQ_FRAG(seq_ctrl));
 		os_free(plain);
 		return NULL;
 	}
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP decrypted", plain, mlen);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP decrypted", plain, mlen);
 
 	*decrypted_len = mlen;
 	return plain;
@@ -218,8 +218,8 @@ u8 * ccmp_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen, u8 *qos,
 
 	os_memset(aad, 0, sizeof(aad));
 	ccmp_aad_nonce(hdr, crypt + hdrlen, aad, &aad_len, nonce);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP AAD", aad, aad_len);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP nonce", nonce, 13);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP AAD", aad, aad_len);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP nonce", nonce, 13);
 
 	if (aes_ccm_ae(tk, 16, nonce, 8, frame + hdrlen, plen, aad, aad_len,
 		       pos, pos + plen) < 0) {
@@ -227,7 +227,7 @@ u8 * ccmp_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen, u8 *qos,
 		return NULL;
 	}
 
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP encrypted", crypt + hdrlen + 8, plen);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP encrypted", crypt + hdrlen + 8, plen);
 
 	*encrypted_len = hdrlen + 8 + plen + 8;
 
@@ -260,8 +260,8 @@ u8 * ccmp_encrypt_pv1(const u8 *tk, const u8 *a1, const u8 *a2, const u8 *a3,
 
 	os_memset(aad, 0, sizeof(aad));
 	ccmp_aad_nonce_pv1(crypt, a1, a2, a3, pn, aad, &aad_len, nonce);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP AAD", aad, aad_len);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP nonce", nonce, sizeof(nonce));
+	wt_hexdump(MSG_EXCESSIVE, "CCMP AAD", aad, aad_len);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP nonce", nonce, sizeof(nonce));
 
 	if (aes_ccm_ae(tk, 16, nonce, 8, frame + hdrlen, plen, aad, aad_len,
 		       pos, pos + plen) < 0) {
@@ -269,7 +269,7 @@ u8 * ccmp_encrypt_pv1(const u8 *tk, const u8 *a1, const u8 *a2, const u8 *a3,
 		return NULL;
 	}
 
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP encrypted", crypt + hdrlen, plen);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP encrypted", crypt + hdrlen, plen);
 
 	*encrypted_len = hdrlen + plen + 8;
 
@@ -296,22 +296,22 @@ u8 * ccmp_256_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 
 	os_memset(aad, 0, sizeof(aad));
 	ccmp_aad_nonce(hdr, data, aad, &aad_len, nonce);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP-256 AAD", aad, aad_len);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP-256 nonce", nonce, 13);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP-256 AAD", aad, aad_len);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP-256 nonce", nonce, 13);
 
 	if (aes_ccm_ad(tk, 32, nonce, 16, data + 8, mlen, aad, aad_len,
 		       data + 8 + mlen, plain) < 0) {
 		u16 seq_ctrl = le_to_host16(hdr->seq_ctrl);
-		wpa_printf(MSG_INFO, "Invalid CCMP-256 MIC in frame: A1=" MACSTR
-			   " A2=" MACSTR " A3=" MACSTR " seq=%u frag=%u",
-			   MAC2STR(hdr->addr1), MAC2STR(hdr->addr2),
-			   MAC2STR(hdr->addr3),
-			   WLAN_GET_SEQ_SEQ(seq_ctrl),
-			   WLAN_GET_SEQ_FRAG(seq_ctrl));
+		wt_printf(MSG_INFO, "Invalid CCMP-256 MIC in frame: A1=" MACSTR
+			  " A2=" MACSTR " A3=" MACSTR " seq=%u frag=%u",
+			  MAC2STR(hdr->addr1), MAC2STR(hdr->addr2),
+			  MAC2STR(hdr->addr3),
+			  WLAN_GET_SEQ_SEQ(seq_ctrl),
+			  WLAN_GET_SEQ_FRAG(seq_ctrl));
 		os_free(plain);
 		return NULL;
 	}
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP-256 decrypted", plain, mlen);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP-256 decrypted", plain, mlen);
 
 	*decrypted_len = mlen;
 	return plain;
@@ -349,8 +349,8 @@ u8 * ccmp_256_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen,
 
 	os_memset(aad, 0, sizeof(aad));
 	ccmp_aad_nonce(hdr, crypt + hdrlen, aad, &aad_len, nonce);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP-256 AAD", aad, aad_len);
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP-256 nonce", nonce, 13);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP-256 AAD", aad, aad_len);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP-256 nonce", nonce, 13);
 
 	if (aes_ccm_ae(tk, 32, nonce, 16, frame + hdrlen, plen, aad, aad_len,
 		       pos, pos + plen) < 0) {
@@ -358,8 +358,8 @@ u8 * ccmp_256_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen,
 		return NULL;
 	}
 
-	wpa_hexdump(MSG_EXCESSIVE, "CCMP-256 encrypted", crypt + hdrlen + 8,
-		    plen);
+	wt_hexdump(MSG_EXCESSIVE, "CCMP-256 encrypted", crypt + hdrlen + 8,
+		   plen);
 
 	*encrypted_len = hdrlen + 8 + plen + 16;
 
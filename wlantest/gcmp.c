@@ -91,18 +91,18 @@ u8 * gcmp_decrypt(const u8 *tk, size_t tk_len, const struct ieee80211_hdr *hdr,
 
 	os_memset(aad, 0, sizeof(aad));
 	gcmp_aad_nonce(hdr, data, aad, &aad_len, nonce);
-	wpa_hexdump(MSG_EXCESSIVE, "GCMP AAD", aad, aad_len);
-	wpa_hexdump(MSG_EXCESSIVE, "GCMP nonce", nonce, sizeof(nonce));
+	wt_hexdump(MSG_EXCESSIVE, "GCMP AAD", aad, aad_len);
+	wt_hexdump(MSG_EXCESSIVE, "GCMP nonce", nonce, sizeof(nonce));
 
 	if (aes_gcm_ad(tk, tk_len, nonce, sizeof(nonce), m, mlen, aad, aad_len,
 		       m + mlen, plain) < 0) {
 		u16 seq_ctrl = le_to_host16(hdr->seq_ctrl);
-		wpa_printf(MSG_INFO, "Invalid GCMP frame: A1=" MACSTR
-			   " A2=" MACSTR " A3=" MACSTR " seq=%u frag=%u",
-			   MAC2STR(hdr->addr1), MAC2STR(hdr->addr2),
-			   MAC2STR(hdr->addr3),
-			   WLAN_GET_SEQ_SEQ(seq_ctrl),
-			   WLAN_GET_SEQ_FRAG(seq_ctrl));
+		wt_printf(MSG_INFO, "Invalid GCMP frame: A1=" MACSTR
+			  " A2=" MACSTR " A3=" MACSTR " seq=%u frag=%u",
+			  MAC2STR(hdr->addr1), MAC2STR(hdr->addr2),
+			  MAC2STR(hdr->addr3),
+			  WLAN_GET_SEQ_SEQ(seq_ctrl),
+			  WLAN_GET_SEQ_FRAG(seq_ctrl));
 		os_free(plain);
 		return NULL;
 	}
@@ -142,8 +142,8 @@ u8 * gcmp_encrypt(const u8 *tk, size_t tk_len, const u8 *frame, size_t len,
 
 	os_memset(aad, 0, sizeof(aad));
 	gcmp_aad_nonce(hdr, crypt + hdrlen, aad, &aad_len, nonce);
-	wpa_hexdump(MSG_EXCESSIVE, "GCMP AAD", aad, aad_len);
-	wpa_hexdump(MSG_EXCESSIVE, "GCMP nonce", nonce, sizeof(nonce));
+	wt_hexdump(MSG_EXCESSIVE, "GCMP AAD", aad, aad_len);
+	wt_hexdump(MSG_EXCESSIVE, "GCMP nonce", nonce, sizeof(nonce));
 
 	if (aes_gcm_ae(tk, tk_len, nonce, sizeof(nonce), frame + hdrlen, plen,
 		       aad, aad_len, pos, pos + plen) < 0) {
@@ -151,8 +151,8 @@ u8 * gcmp_encrypt(const u8 *tk, size_t tk_len, const u8 *frame, size_t len,
 		return NULL;
 	}
 
-	wpa_hexdump(MSG_EXCESSIVE, "GCMP MIC", pos + plen, 16);
-	wpa_hexdump(MSG_EXCESSIVE, "GCMP encrypted", pos, plen);
+	wt_hexdump(MSG_EXCESSIVE, "GCMP MIC", pos + plen, 16);
+	wt_hexdump(MSG_EXCESSIVE, "GCMP encrypted", pos, plen);
 
 	*encrypted_len = hdrlen + 8 + plen + 16;
 
@@ -195,7 +195,7 @@ static void rx_ack(struct wlantest *wt, const struct ieee80211_hdr *hdr)
 }
 
 
-static void rx_frame(struct wlantest *wt, const u8 *data, size_t len)
+void wlantest_rx_frame(struct wlantest *wt, const u8 *data, size_t len)
 {
 	const struct ieee80211_hdr *hdr;
 	u16 fc;
@@ -250,6 +250,7 @@ static void rx_frame(struct wlantest *wt, const u8 *data, size_t len)
 	os_memcpy(wt->last_hdr, data, len > sizeof(wt->last_hdr) ?
 		  sizeof(wt->last_hdr) : len);
 	wt->last_len = len;
+	wt->last_frame = wt->frame_num;
 }
 
 
@@ -268,19 +269,29 @@ static int check_fcs(const u8 *frame, size_t frame_len, const u8 *fcs)
 }
 
 
-void wlantest_process(struct wlantest *wt, const u8 *data, size_t len)
+/**
+ * wlantest_decap - Locate the IEEE 802.11 frame within a captured packet
+ * @wt: wlantest context
+ * @data: Captured packet (radiotap header + frame)
+ * @len: Length of the captured packet
+ * @frame: Buffer for returning a pointer to the IEEE 802.11 frame
+ * @frame_len: Buffer for returning the length of the frame (without FCS)
+ * Returns: 1 if the frame is to be processed as a received frame or 0 if it
+ * is to be dropped
+ */
+int wlantest_decap(struct wlantest *wt, const u8 *data, size_t len,
+		   const u8 **frame, size_t *frame_len)
 {
 	struct ieee80211_radiotap_iterator iter;
 	int ret;
 	int rxflags = 0, txflags = 0, failed = 0, fcs = 0;
-	const u8 *frame, *fcspos;
-	size_t frame_len;
+	const u8 *fcspos;
 
 	wpa_hexdump(MSG_EXCESSIVE, "Process data", data, len);
 
 	if (ieee80211_radiotap_iterator_init(&iter, (void *) data, len, NULL)) {
 		add_note(wt, MSG_INFO, "Invalid radiotap frame");
-		return;
+		return 0;
 	}
 
 	for (;;) {
@@ -292,7 +303,7 @@ void wlantest_process(struct wlantest *wt, const u8 *data, size_t len)
 		if (ret) {
 			add_note(wt, MSG_INFO, "Invalid radiotap header: %d",
 				 ret);
-			return;
+			return 0;
 		}
 		switch (iter.this_arg_index) {
 		case IEEE80211_RADIOTAP_FLAGS:
@@ -312,78 +323,77 @@ void wlantest_process(struct wlantest *wt, const u8 *data, size_t len)
 			    iter.this_arg[3] == QCA_RADIOTAP_VID_WLANTEST) {
 				add_note(wt, MSG_DEBUG,
 					 "Skip frame inserted by wlantest");
-				return;
+				return 0;
 			}
 		}
 	}
 
-	frame = data + iter._max_length;
-	frame_len = len - iter._max_length;
+	*frame = data + iter._max_length;
+	*frame_len = len - iter._max_length;
 
-	if (fcs && frame_len >= 4) {
-		frame_len -= 4;
-		fcspos = frame + frame_len;
-		if (check_fcs(frame, frame_len, fcspos) < 0) {
+	if (fcs && *frame_len >= 4) {
+		*frame_len -= 4;
+		fcspos = *frame + *frame_len;
+		if (check_fcs(*frame, *frame_len, fcspos) < 0) {
 			add_note(wt, MSG_EXCESSIVE, "Drop RX frame with "
 				 "invalid FCS");
 			wt->fcs_error++;
-			return;
+			return 0;
 		}
 	}
 
 	if (rxflags && txflags)
-		return;
-	if (!txflags)
-		rx_frame(wt, frame, frame_len);
-	else {
+		return 0;
+	if (txflags) {
 		add_note(wt, MSG_EXCESSIVE, "TX status - process as RX of "
 			 "local frame");
-		tx_status(wt, frame, frame_len, !failed);
+		tx_status(wt, *frame, *frame_len, !failed);
 		/* Process as RX frame to support local monitor interface */
-		rx_frame(wt, frame, frame_len);
 	}
+	return 1;
 }
 
 
-void wlantest_process_prism(struct wlantest *wt, const u8 *data, size_t len)
+int wlantest_decap_prism(struct wlantest *wt, const u8 *data, size_t len,
+			 const u8 **frame, size_t *frame_len)
 {
 	int fcs = 0;
-	const u8 *frame, *fcspos;
-	size_t frame_len;
+	const u8 *fcspos;
 	u32 hdrlen;
 
 	wpa_hexdump(MSG_EXCESSIVE, "Process data", data, len);
 
 	if (len < 8)
-		return;
+		return 0;
 	hdrlen = WPA_GET_LE32(data + 4);
 
 	if (len < hdrlen) {
 		wpa_printf(MSG_INFO, "Too short frame to include prism "
 			   "header");
-		return;
+		return 0;
 	}
 
-	frame = data + hdrlen;
-	frame_len = len - hdrlen;
+	*frame = data + hdrlen;
+	*frame_len = len - hdrlen;
 	fcs = 1;
 
-	if (fcs && frame_len >= 4) {
-		frame_len -= 4;
-		fcspos = frame + frame_len;
-		if (check_fcs(frame, frame_len, fcspos) < 0) {
+	if (fcs && *frame_len >= 4) {
+		*frame_len -= 4;
+		fcspos = *frame + *frame_len;
+		if (check_fcs(*frame, *frame_len, fcspos) < 0) {
 			add_note(wt, MSG_EXCESSIVE, "Drop RX frame with "
 				 "invalid FCS");
 			wt->fcs_error++;
-			return;
+			return 0;
 		}
 	}
 
-	rx_frame(wt, frame, frame_len);
+	return 1;
 }
 
 
-void wlantest_process_80211(struct wlantest *wt, const u8 *data, size_t len)
+int wlantest_decap_80211(struct wlantest *wt, const u8 *data, size_t len,
+			 const u8 **frame, size_t *frame_len)
 {
 	wpa_hexdump(MSG_EXCESSIVE, "Process data", data, len);
 
@@ -396,9 +406,41 @@ void wlantest_process_80211(struct wlantest *wt, const u8 *data, size_t len)
 			add_note(wt, MSG_EXCESSIVE, "Drop RX frame with "
 				 "invalid FCS");
 			wt->fcs_error++;
-			return;
+			return 0;
 		}
 	}
 
-	rx_frame(wt, data, len);
+	*frame = data;
+	*frame_len = len;
+	return 1;
+}
+
+
+void wlantest_process(struct wlantest *wt, const u8 *data, size_t len)
+{
+	const u8 *frame;
+	size_t frame_len;
+
+	if (wlantest_decap(wt, data, len, &frame, &frame_len))
+		wlantest_rx_frame(wt, frame, frame_len);
+}
+
+
+void wlantest_process_prism(struct wlantest *wt, const u8 *data, size_t len)
+{
+	const u8 *frame;
+	size_t frame_len;
+
+	if (wlantest_decap_prism(wt, data, len, &frame, &frame_len))
+		wlantest_rx_frame(wt, frame, frame_len);
+}
+
+
+void wlantest_process_80211(struct wlantest *wt, const u8 *data, size_t len)
+{
+	const u8 *frame;
+	size_t frame_len;
+
+	if (wlantest_decap_80211(wt, data, len, &frame, &frame_len))
+		wlantest_rx_frame(wt, frame, frame_len);
 }
@@ -13,39 +13,6 @@
 #include "wlantest.h"
 
 
-static void write_pcap_with_radiotap(struct wlantest *wt,
-				     const u8 *data, size_t data_len)
-{
-	struct pcap_pkthdr h;
-	u8 rtap[] = {
-		0x00 /* rev */,
-		0x00 /* pad */,
-		0x0a, 0x00, /* header len */
-		0x02, 0x00, 0x00, 0x00, /* present flags */
-		0x00, /* flags */
-		0x00 /* pad */
-	};
-	u8 *buf;
-	size_t len;
-
-	if (wt->assume_fcs)
-		rtap[8] |= 0x10;
-
-	os_memset(&h, 0, sizeof(h));
-	h.ts = wt->write_pcap_time;
-	len = sizeof(rtap) + data_len;
-	buf = os_malloc(len);
-	if (buf == NULL)
-		return;
-	os_memcpy(buf, rtap, sizeof(rtap));
-	os_memcpy(buf + sizeof(rtap), data, data_len);
-	h.caplen = len;
-	h.len = len;
-	pcap_dump(wt->write_pcap_dumper, &h, buf);
-	os_free(buf);
-}
-
-
 int read_cap_file(struct wlantest *wt, const char *fname)
 {
 	char errbuf[PCAP_ERRBUF_SIZE];
@@ -55,6 +22,7 @@ int read_cap_file(struct wlantest *wt, const char *fname)
 	const u_char *data;
 	int res;
 	int dlt;
+	struct os_reltime start, end, diff;
 
 	pcap = pcap_open_offline(fname, errbuf);
 	if (pcap == NULL) {
@@ -72,6 +40,7 @@ int read_cap_file(struct wlantest *wt, const char *fname)
 	}
 	wpa_printf(MSG_DEBUG, "pcap datalink type: %d", dlt);
 
+	os_get_reltime(&start);
 	for (;;) {
 		clear_notes(wt);
 		os_free(wt->decrypted);
@@ -127,9 +96,16 @@ int read_cap_file(struct wlantest *wt, const char *fname)
 		write_pcapng_write_read(wt, dlt, hdr, data);
 	}
 
+	os_get_reltime(&end);
+
 	pcap_close(pcap);
 
+	os_reltime_sub(&end, &start, &diff);
 	wpa_printf(MSG_DEBUG, "Read %s: %u packets", fname, count);
+	wpa_printf(MSG_INFO, "Read %u frames in %ld.%06ld s (%u frames/sec)",
+		   count, diff.sec, diff.usec,
+		   (unsigned int) (count * 1000000ULL /
+				   (diff.sec * 1000000ULL + diff.usec + 1)));
 
 	return 0;
 }
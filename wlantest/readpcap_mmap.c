@@ -0,0 +1,890 @@
+/*
+ * Memory-mapped PCAP/pcapng capture file reader with sharded processing
+ * Copyright (c) 2026, agent <agent@local>
+ *
+ * This software may be distributed under the terms of the BSD license.
+ * See README for more details.
+ *
+ * The capture file is mapped into memory and parsed without copying the
+ * packets. Each frame is assigned to a shard based on its BSSID and each
+ * shard is processed by a worker thread with its own struct wlantest, i.e.,
+ * its own BSS/STA state. Frames are handled in batches; once all workers have
+ * completed a batch, the per-frame results (notes and decrypted frames) are
+ * written out in the original frame order. Frames that cannot be mapped to a
+ * BSSID (e.g., Ack frames) are processed in the shard of the previous frame
+ * so that they see the same "previous frame" state as in a serial run. Once
+ * the full file has been processed, the per-shard BSS entries are merged back
+ * into the main context in creation order.
+ *
+ * The output is identical to a serial run as long as each frame uses only
+ * state of its own shard. Frames in different shards access disjoint sets of
+ * BSS entries and the key hints are per BSS/STA, so processing the shards in
+ * parallel does not change the result. A frame that looks up a BSS owned by
+ * another shard (e.g., an EAPOL-Key frame to a different address or a TDLS
+ * Link Identifier with another BSSID) or acknowledges a management frame that
+ * was dropped as a duplicate (and would see last_mgmt_valid of another shard)
+ * marks a conflict. In that case, the sharded results are discarded, the
+ * output files are truncated, and the file is processed serially instead.
+ */
+
+#include "utils/includes.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <pcap.h>
+
+#include "utils/common.h"
+#include "common/ieee802_11_defs.h"
+#include "wlantest.h"
+
+
+#define SHARD_BATCH_SIZE 4096
+#define PCAP_MAX_CAPLEN 262144
+
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+
+#define PCAPNG_BLOCK_SECTION_HEADER 0x0a0d0d0a
+#define PCAPNG_BLOCK_INTERFACE_DESC 0x00000001
+#define PCAPNG_BLOCK_PACKET 0x00000002
+#define PCAPNG_BLOCK_SIMPLE_PACKET 0x00000003
+#define PCAPNG_BLOCK_ENHANCED_PACKET 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1a2b3c4d
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_MAX_INTERFACES 32
+
+struct mmap_cap {
+	const u8 *buf;
+	size_t len;
+	size_t pos;
+	int pcapng;
+	int swap;
+	int dlt;
+	u32 nsec; /* classic pcap: nanosecond timestamps */
+	struct {
+		int dlt;
+		u64 tsresol; /* timestamp units per second */
+	} ifs[PCAPNG_MAX_INTERFACES];
+	unsigned int num_ifs;
+};
+
+struct wlantest_shard_frame {
+	struct pcap_pkthdr hdr;
+	const u8 *data; /* captured packet within the mapped file */
+	const u8 *frame; /* IEEE 802.11 frame; NULL if not processed */
+	size_t frame_len;
+	int shard;
+	char *notes[MAX_NOTES];
+	size_t num_notes;
+	struct wpabuf **decrypted;
+	size_t num_decrypted;
+};
+
+struct wlantest_shard {
+	struct wlantest wt;
+	pthread_t thread;
+	int id;
+	struct wlantest_shard_frame *frames;
+	size_t num_frames;
+	unsigned int first_frame_num;
+};
+
+
+static u32 cap_get32(struct mmap_cap *cap, const u8 *pos)
+{
+	return cap->swap ? WPA_GET_BE32(pos) : WPA_GET_LE32(pos);
+}
+
+
+static u16 cap_get16(struct mmap_cap *cap, const u8 *pos)
+{
+	return cap->swap ? WPA_GET_BE16(pos) : WPA_GET_LE16(pos);
+}
+
+
+static void cap_set_ts(struct pcap_pkthdr *hdr, u64 ts, u64 tsresol)
+{
+	u64 frac;
+
+	/* Same scaling as done by libpcap for microsecond precision */
+	hdr->ts.tv_sec = ts / tsresol;
+	frac = ts % tsresol;
+	if (tsresol == 1000000)
+		hdr->ts.tv_usec = frac;
+	else if (tsresol > 1000000 && tsresol % 1000000 == 0)
+		hdr->ts.tv_usec = frac / (tsresol / 1000000);
+	else
+		hdr->ts.tv_usec = frac * 1000000 / tsresol;
+}
+
+
+static int cap_init(struct mmap_cap *cap)
+{
+	u32 magic;
+
+	if (cap->len < 24)
+		return -1;
+
+	magic = WPA_GET_LE32(cap->buf);
+	if (magic == PCAPNG_BLOCK_SECTION_HEADER) {
+		/* Section Header Block is parsed with the other blocks */
+		cap->pcapng = 1;
+		cap->dlt = -1;
+		return 0;
+	}
+
+	if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC) {
+		cap->swap = 0;
+	} else {
+		magic = WPA_GET_BE32(cap->buf);
+		if (magic != PCAP_MAGIC_USEC && magic != PCAP_MAGIC_NSEC)
+			return -1;
+		cap->swap = 1;
+	}
+	cap->nsec = magic == PCAP_MAGIC_NSEC;
+	cap->dlt = cap_get32(cap, cap->buf + 20);
+	cap->pos = 24;
+	return 0;
+}
+
+
+static int cap_next_pcap(struct mmap_cap *cap, struct pcap_pkthdr *hdr,
+			 const u8 **data)
+{
+	const u8 *pos = cap->buf + cap->pos;
+	size_t left = cap->len - cap->pos;
+
+	if (left == 0)
+		return 0;
+	if (left < 16)
+		goto truncated;
+	hdr->caplen = cap_get32(cap, pos + 8);
+	hdr->len = cap_get32(cap, pos + 12);
+	if (hdr->caplen > PCAP_MAX_CAPLEN) {
+		wpa_printf(MSG_INFO, "Invalid packet capture length %u",
+			   hdr->caplen);
+		return -1;
+	}
+	if (left - 16 < hdr->caplen)
+		goto truncated;
+	cap_set_ts(hdr, (u64) cap_get32(cap, pos) *
+		   (cap->nsec ? 1000000000 : 1000000) +
+		   cap_get32(cap, pos + 4),
+		   cap->nsec ? 1000000000 : 1000000);
+	*data = pos + 16;
+	cap->pos += 16 + hdr->caplen;
+	return 1;
+
+truncated:
+	wpa_printf(MSG_INFO, "Truncated capture file");
+	return -1;
+}
+
+
+static int cap_pcapng_shb(struct mmap_cap *cap, const u8 *pos)
+{
+	u32 magic;
+
+	magic = WPA_GET_LE32(pos + 8);
+	if (magic == PCAPNG_BYTE_ORDER_MAGIC)
+		cap->swap = 0;
+	else if (WPA_GET_BE32(pos + 8) == PCAPNG_BYTE_ORDER_MAGIC)
+		cap->swap = 1;
+	else
+		return -1;
+	/* Interface IDs are scoped to the section */
+	cap->num_ifs = 0;
+	return 0;
+}
+
+
+static int cap_pcapng_idb(struct mmap_cap *cap, const u8 *pos, u32 blen)
+{
+	const u8 *opt, *end;
+	int dlt;
+	u64 tsresol = 1000000;
+
+	if (blen < 20)
+		return -1;
+	dlt = cap_get16(cap, pos + 8);
+	opt = pos + 16;
+	end = pos + blen - 4;
+	while (end - opt >= 4) {
+		u16 code = cap_get16(cap, opt);
+		u16 olen = cap_get16(cap, opt + 2);
+
+		if (code == 0 || end - opt - 4 < olen)
+			break;
+		if (code == PCAPNG_OPT_IF_TSRESOL && olen >= 1) {
+			u8 val = opt[4];
+			u64 base = (val & 0x80) ? 2 : 10;
+			unsigned int i;
+
+			tsresol = 1;
+			for (i = 0; i < (val & 0x7f) && tsresol < 1ULL << 50;
+			     i++)
+				tsresol *= base;
+		}
+		opt += 4 + ((olen + 3) & ~3);
+	}
+
+	if (cap->num_ifs == PCAPNG_MAX_INTERFACES)
+		return -1;
+	if (cap->dlt < 0)
+		cap->dlt = dlt;
+	else if (cap->dlt != dlt) {
+		wpa_printf(MSG_ERROR, "pcapng: Mixed link-layer types (%d and "
+			   "%d) are not supported", cap->dlt, dlt);
+		return -1;
+	}
+	cap->ifs[cap->num_ifs].dlt = dlt;
+	cap->ifs[cap->num_ifs].tsresol = tsresol;
+	cap->num_ifs++;
+	return 0;
+}
+
+
+static int cap_next_pcapng(struct mmap_cap *cap, struct pcap_pkthdr *hdr,
+			   const u8 **data)
+{
+	for (;;) {
+		const u8 *pos = cap->buf + cap->pos;
+		size_t left = cap->len - cap->pos;
+		u32 btype, blen, ifidx, caplen, len;
+		u64 ts;
+
+		if (left == 0)
+			return 0;
+		if (left < 12)
+			goto truncated;
+		btype = cap_get32(cap, pos);
+		if (btype == PCAPNG_BLOCK_SECTION_HEADER &&
+		    (left < 28 || cap_pcapng_shb(cap, pos) < 0))
+			goto invalid;
+		blen = cap_get32(cap, pos + 4);
+		if (blen < 12 || (blen & 3))
+			goto invalid;
+		if (blen > left)
+			goto truncated;
+		cap->pos += blen;
+
+		switch (btype) {
+		case PCAPNG_BLOCK_SECTION_HEADER:
+			continue;
+		case PCAPNG_BLOCK_INTERFACE_DESC:
+			if (cap_pcapng_idb(cap, pos, blen) < 0)
+				goto invalid;
+			continue;
+		case PCAPNG_BLOCK_ENHANCED_PACKET:
+			if (blen < 32)
+				goto invalid;
+			ifidx = cap_get32(cap, pos + 8);
+			ts = ((u64) cap_get32(cap, pos + 12) << 32) |
+				cap_get32(cap, pos + 16);
+			caplen = cap_get32(cap, pos + 20);
+			len = cap_get32(cap, pos + 24);
+			*data = pos + 28;
+			break;
+		case PCAPNG_BLOCK_PACKET:
+			if (blen < 32)
+				goto invalid;
+			ifidx = cap_get16(cap, pos + 8);
+			ts = ((u64) cap_get32(cap, pos + 12) << 32) |
+				cap_get32(cap, pos + 16);
+			caplen = cap_get32(cap, pos + 20);
+			len = cap_get32(cap, pos + 24);
+			*data = pos + 28;
+			break;
+		case PCAPNG_BLOCK_SIMPLE_PACKET:
+			if (blen < 16)
+				goto invalid;
+			ifidx = 0;
+			ts = 0;
+			len = cap_get32(cap, pos + 8);
+			caplen = blen - 16;
+			if (caplen > len)
+				caplen = len;
+			*data = pos + 12;
+			break;
+		default:
+			continue;
+		}
+
+		if (ifidx >= cap->num_ifs ||
+		    caplen > blen - (*data - pos) - 4 ||
+		    caplen > PCAP_MAX_CAPLEN)
+			goto invalid;
+		hdr->caplen = caplen;
+		hdr->len = len;
+		cap_set_ts(hdr, ts, cap->ifs[ifidx].tsresol);
+		return 1;
+	}
+
+truncated:
+	wpa_printf(MSG_INFO, "Truncated capture file");
+	return -1;
+invalid:
+	wpa_printf(MSG_INFO, "Invalid pcapng block at offset %u",
+		   (unsigned int) cap->pos);
+	return -1;
+}
+
+
+static int cap_next(struct mmap_cap *cap, struct pcap_pkthdr *hdr,
+		    const u8 **data)
+{
+	if (cap->pcapng)
+		return cap_next_pcapng(cap, hdr, data);
+	return cap_next_pcap(cap, hdr, data);
+}
+
+
+/* BSSID that wlantest uses to look up the state for the frame, if any */
+static const u8 * shard_bssid(const u8 *frame, size_t len)
+{
+	const struct ieee80211_hdr *hdr;
+	u16 fc;
+
+	if (len < 10)
+		return NULL;
+	hdr = (const struct ieee80211_hdr *) frame;
+	fc = le_to_host16(hdr->frame_control);
+	switch (WLAN_FC_GET_TYPE(fc)) {
+	case WLAN_FC_TYPE_MGMT:
+		if (len < 24)
+			return NULL;
+		return hdr->addr3;
+	case WLAN_FC_TYPE_DATA:
+		if (len < 24)
+			return NULL;
+		switch (fc & (WLAN_FC_TODS | WLAN_FC_FROMDS)) {
+		case WLAN_FC_TODS:
+			return hdr->addr1;
+		case WLAN_FC_FROMDS:
+			return hdr->addr2;
+		case 0:
+			return hdr->addr3;
+		default:
+			return NULL;
+		}
+	case WLAN_FC_TYPE_CTRL:
+		if (WLAN_FC_GET_STYPE(fc) == WLAN_FC_STYPE_PSPOLL && len >= 16)
+			return hdr->addr1;
+		return NULL;
+	}
+
+	return NULL;
+}
+
+
+static int shard_select(const u8 *bssid, int num_shards)
+{
+	u32 hash = 2166136261U;
+	int i;
+
+	for (i = 0; i < ETH_ALEN; i++) {
+		hash ^= bssid[i];
+		hash *= 16777619U;
+	}
+	return hash % num_shards;
+}
+
+
+/* Mark a conflict if the BSS entry for bssid belongs to another shard */
+void shard_check_bssid(struct wlantest *wt, const u8 *bssid)
+{
+	if (wt->shard_frame &&
+	    shard_select(bssid, wt->num_shards) != wt->shard_frame->shard)
+		wt->shard_conflict = 1;
+}
+
+
+void shard_frame_add_decrypted(struct wlantest_shard_frame *frame,
+			       const u8 *buf, size_t len)
+{
+	struct wpabuf **n;
+
+	n = os_realloc_array(frame->decrypted, frame->num_decrypted + 1,
+			     sizeof(struct wpabuf *));
+	if (n == NULL)
+		return;
+	frame->decrypted = n;
+	n[frame->num_decrypted] = wpabuf_alloc_copy(buf, len);
+	if (n[frame->num_decrypted])
+		frame->num_decrypted++;
+}
+
+
+static void shard_frame_clear(struct wlantest_shard_frame *frame)
+{
+	size_t i;
+
+	for (i = 0; i < frame->num_notes; i++)
+		os_free(frame->notes[i]);
+	for (i = 0; i < frame->num_decrypted; i++)
+		wpabuf_free(frame->decrypted[i]);
+	os_free(frame->decrypted);
+	os_memset(frame, 0, sizeof(*frame));
+}
+
+
+/* Move the notes from wt to frame or the other way around */
+static void shard_move_notes(char **to, size_t *to_num,
+			     char **from, size_t *from_num)
+{
+	size_t i;
+
+	for (i = 0; i < *from_num; i++) {
+		to[i] = from[i];
+		from[i] = NULL;
+	}
+	*to_num = *from_num;
+	*from_num = 0;
+}
+
+
+static void * shard_thread(void *ctx)
+{
+	struct wlantest_shard *shard = ctx;
+	struct wlantest *wt = &shard->wt;
+	size_t i;
+
+	for (i = 0; i < shard->num_frames; i++) {
+		struct wlantest_shard_frame *frame = &shard->frames[i];
+
+		if (frame->shard != shard->id || !frame->frame)
+			continue;
+
+		clear_notes(wt);
+		shard_move_notes(wt->notes, &wt->num_notes,
+				 frame->notes, &frame->num_notes);
+		wt->frame_num = shard->first_frame_num + i;
+		wt->shard_frame = frame;
+		wlantest_rx_frame(wt, frame->frame, frame->frame_len);
+		wt->shard_frame = NULL;
+		shard_move_notes(frame->notes, &frame->num_notes,
+				 wt->notes, &wt->num_notes);
+		os_free(wt->decrypted);
+		wt->decrypted = NULL;
+	}
+
+	return NULL;
+}
+
+
+static int shard_init(struct wlantest_shard *shard, int id, int num_shards,
+		      struct wlantest *wt)
+{
+	struct wlantest *swt = &shard->wt;
+	struct wlantest_passphrase *p, *np;
+	struct wlantest_pmk *pmk, *npmk;
+	struct wlantest_ptk *ptk, *nptk;
+	struct wlantest_wep *wep, *nwep;
+
+	shard->id = id;
+	os_memset(swt, 0, sizeof(*swt));
+	swt->monitor_sock = -1;
+	swt->ctrl_sock = -1;
+	dl_list_init(&swt->passphrase);
+	dl_list_init(&swt->bss);
+	dl_list_init(&swt->secret);
+	dl_list_init(&swt->radius);
+	dl_list_init(&swt->pmk);
+	dl_list_init(&swt->ptk);
+	dl_list_init(&swt->wep);
+	swt->pmk_threads = wt->pmk_threads;
+	swt->num_shards = num_shards;
+
+	/* Each shard uses a private copy of the configured keys */
+	dl_list_for_each(p, &wt->passphrase, struct wlantest_passphrase, list) {
+		np = os_memdup(p, sizeof(*p));
+		if (np == NULL)
+			return -1;
+		dl_list_add_tail(&swt->passphrase, &np->list);
+	}
+	dl_list_for_each(pmk, &wt->pmk, struct wlantest_pmk, list) {
+		npmk = os_memdup(pmk, sizeof(*pmk));
+		if (npmk == NULL)
+			return -1;
+		dl_list_add_tail(&swt->pmk, &npmk->list);
+	}
+	dl_list_for_each(ptk, &wt->ptk, struct wlantest_ptk, list) {
+		nptk = os_memdup(ptk, sizeof(*ptk));
+		if (nptk == NULL)
+			return -1;
+		dl_list_add_tail(&swt->ptk, &nptk->list);
+	}
+	dl_list_for_each(wep, &wt->wep, struct wlantest_wep, list) {
+		nwep = os_memdup(wep, sizeof(*wep));
+		if (nwep == NULL)
+			return -1;
+		dl_list_add_tail(&swt->wep, &nwep->list);
+	}
+
+	return 0;
+}
+
+
+static void shard_deinit(struct wlantest_shard *shard)
+{
+	struct wlantest *swt = &shard->wt;
+	struct wlantest_passphrase *p, *np;
+	struct wlantest_pmk *pmk, *npmk;
+	struct wlantest_ptk *ptk, *nptk;
+	struct wlantest_wep *wep, *nwep;
+
+	bss_flush(swt);
+	dl_list_for_each_safe(p, np, &swt->passphrase,
+			      struct wlantest_passphrase, list) {
+		dl_list_del(&p->list);
+		os_free(p);
+	}
+	dl_list_for_each_safe(pmk, npmk, &swt->pmk, struct wlantest_pmk, list)
+		pmk_deinit(pmk);
+	dl_list_for_each_safe(ptk, nptk, &swt->ptk, struct wlantest_ptk, list) {
+		dl_list_del(&ptk->list);
+		bin_clear_free(ptk, sizeof(*ptk));
+	}
+	dl_list_for_each_safe(wep, nwep, &swt->wep, struct wlantest_wep, list) {
+		dl_list_del(&wep->list);
+		os_free(wep);
+	}
+	clear_notes(swt);
+	os_free(swt->decrypted);
+	swt->decrypted = NULL;
+}
+
+
+/*
+ * Move the BSS entries learned by the shards into the main context. bss_get()
+ * adds new entries to the head of the list, so the entries are moved oldest
+ * first to keep the list in creation order.
+ */
+static void shard_merge(struct wlantest *wt, struct wlantest_shard *shards,
+			int num_shards)
+{
+	struct wlantest_bss *bss, *oldest;
+	struct wlantest_sta *sta;
+	int i;
+
+	for (;;) {
+		oldest = NULL;
+		for (i = 0; i < num_shards; i++) {
+			bss = dl_list_last(&shards[i].wt.bss,
+					   struct wlantest_bss, list);
+			if (bss && (!oldest ||
+				    bss->first_frame < oldest->first_frame))
+				oldest = bss;
+		}
+		if (!oldest)
+			break;
+
+		/* Key hints may point to the shard's private key copies */
+		oldest->pmk_hint = NULL;
+		dl_list_for_each(sta, &oldest->sta, struct wlantest_sta, list) {
+			sta->pmk_hint = NULL;
+			sta->ptk_hint = NULL;
+		}
+		dl_list_del(&oldest->list);
+		dl_list_add(&wt->bss, &oldest->list);
+	}
+
+	for (i = 0; i < num_shards; i++) {
+		struct wlantest *swt = &shards[i].wt;
+
+		wt->rx_mgmt += swt->rx_mgmt;
+		wt->rx_ctrl += swt->rx_ctrl;
+		wt->rx_data += swt->rx_data;
+		wt->fcs_error += swt->fcs_error;
+		wt->pmk_trials += swt->pmk_trials;
+		wt->pmk_matches += swt->pmk_matches;
+		wt->pmk_hint_hits += swt->pmk_hint_hits;
+		wt->ptk_trials += swt->ptk_trials;
+		wt->ptk_matches += swt->ptk_matches;
+		wt->ptk_hint_hits += swt->ptk_hint_hits;
+	}
+}
+
+
+static void shard_run(struct wlantest_shard *shards, int num_shards,
+		      struct wlantest_shard_frame *frames, size_t num_frames,
+		      unsigned int first_frame_num)
+{
+	int i;
+	int *started;
+
+	started = os_calloc(num_shards, sizeof(int));
+	for (i = 0; i < num_shards; i++) {
+		shards[i].frames = frames;
+		shards[i].num_frames = num_frames;
+		shards[i].first_frame_num = first_frame_num;
+		/* The first shard is processed in the calling thread */
+		if (i > 0 && started &&
+		    pthread_create(&shards[i].thread, NULL, shard_thread,
+				   &shards[i]) == 0)
+			started[i] = 1;
+	}
+	for (i = 0; i < num_shards; i++) {
+		if (!started || !started[i])
+			shard_thread(&shards[i]);
+	}
+	for (i = 0; started && i < num_shards; i++) {
+		if (started[i])
+			pthread_join(shards[i].thread, NULL);
+	}
+	os_free(started);
+}
+
+
+static void shard_write_output(struct wlantest *wt, int dlt,
+			       struct wlantest_shard_frame *frame)
+{
+	size_t i;
+
+	if (wt->write_pcap_dumper) {
+		wt->write_pcap_time = frame->hdr.ts;
+		if (dlt == DLT_IEEE802_11)
+			write_pcap_with_radiotap(wt, frame->data,
+						 frame->hdr.caplen);
+		else
+			pcap_dump(wt->write_pcap_dumper, &frame->hdr,
+				  frame->data);
+		if (wt->pcap_no_buffer)
+			pcap_dump_flush(wt->write_pcap_dumper);
+		for (i = 0; i < frame->num_decrypted; i++)
+			write_pcap_dump(wt, wpabuf_head(frame->decrypted[i]),
+					wpabuf_len(frame->decrypted[i]));
+	}
+
+	if (wt->pcapng) {
+		clear_notes(wt);
+		shard_move_notes(wt->notes, &wt->num_notes,
+				 frame->notes, &frame->num_notes);
+		os_free(wt->decrypted);
+		wt->decrypted = NULL;
+		if (frame->num_decrypted) {
+			struct wpabuf *last;
+
+			last = frame->decrypted[frame->num_decrypted - 1];
+			wt->decrypted = os_memdup(wpabuf_head(last),
+						  wpabuf_len(last));
+			if (wt->decrypted)
+				wt->decrypted_len = wpabuf_len(last);
+		}
+		write_pcapng_write_read(wt, dlt, &frame->hdr, frame->data);
+	}
+}
+
+
+/*
+ * Process the capture file with the serial reader after the sharded run was
+ * aborted. The output files are truncated first to drop the frames that were
+ * already written out by the sharded run.
+ */
+static int read_cap_file_serial(struct wlantest *wt, const char *fname)
+{
+	if (wt->write_pcap_dumper) {
+		write_pcap_deinit(wt);
+		if (write_pcap_init(wt, wt->write_file) < 0)
+			return -1;
+	}
+
+	if (wt->pcapng) {
+		write_pcapng_deinit(wt);
+		if (write_pcapng_init(wt, wt->pcapng_file) < 0)
+			return -1;
+	}
+
+	return read_cap_file(wt, fname);
+}
+
+
+int read_cap_file_mmap(struct wlantest *wt, const char *fname, int threads)
+{
+	struct mmap_cap cap;
+	struct wlantest_shard *shards;
+	struct wlantest_shard_frame *frames;
+	struct os_reltime start, end, diff;
+	unsigned int count = 0, frame_num = 0, fcs_error = wt->fcs_error;
+	size_t num, i;
+	int fd, res = 0, prev_shard = 0, conflict = 0;
+	struct stat st;
+	void *map;
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0) {
+		wpa_printf(MSG_ERROR, "Failed to read pcap file '%s': %s",
+			   fname, strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		wpa_printf(MSG_ERROR, "Failed to mmap pcap file '%s': %s",
+			   fname, strerror(errno));
+		return -1;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	os_memset(&cap, 0, sizeof(cap));
+	cap.buf = map;
+	cap.len = st.st_size;
+	if (cap_init(&cap) < 0) {
+		wpa_printf(MSG_ERROR, "Failed to read pcap file '%s': "
+			   "unknown file format", fname);
+		munmap(map, st.st_size);
+		return -1;
+	}
+
+	shards = os_calloc(threads, sizeof(*shards));
+	frames = os_calloc(SHARD_BATCH_SIZE, sizeof(*frames));
+	if (shards == NULL || frames == NULL) {
+		os_free(shards);
+		os_free(frames);
+		munmap(map, st.st_size);
+		return -1;
+	}
+	for (i = 0; i < (size_t) threads; i++) {
+		if (shard_init(&shards[i], i, threads, wt) < 0) {
+			res = -1;
+			threads = i + 1;
+			goto out;
+		}
+	}
+
+	os_get_reltime(&start);
+	for (;;) {
+		int ret = 0;
+
+		for (num = 0; num < SHARD_BATCH_SIZE; num++) {
+			struct wlantest_shard_frame *frame = &frames[num];
+			const u8 *bssid;
+			int ok = 0;
+
+			ret = cap_next(&cap, &frame->hdr, &frame->data);
+			if (ret <= 0)
+				break;
+			if (cap.dlt != DLT_IEEE802_11_RADIO &&
+			    cap.dlt != DLT_PRISM_HEADER &&
+			    cap.dlt != DLT_IEEE802_11) {
+				wpa_printf(MSG_ERROR, "Unsupported pcap "
+					   "datalink type: %d", cap.dlt);
+				ret = -1;
+				res = -1;
+				break;
+			}
+
+			clear_notes(wt);
+			wpa_printf(MSG_EXCESSIVE, "pcap hdr: ts=%d.%06d "
+				   "len=%u/%u",
+				   (int) frame->hdr.ts.tv_sec,
+				   (int) frame->hdr.ts.tv_usec,
+				   frame->hdr.caplen, frame->hdr.len);
+			if (frame->hdr.caplen < frame->hdr.len) {
+				add_note(wt, MSG_DEBUG, "pcap: Dropped "
+					 "incomplete frame (%u/%u captured)",
+					 frame->hdr.caplen, frame->hdr.len);
+			} else {
+				count++;
+				switch (cap.dlt) {
+				case DLT_IEEE802_11_RADIO:
+					ok = wlantest_decap(
+						wt, frame->data,
+						frame->hdr.caplen,
+						&frame->frame,
+						&frame->frame_len);
+					break;
+				case DLT_PRISM_HEADER:
+					ok = wlantest_decap_prism(
+						wt, frame->data,
+						frame->hdr.caplen,
+						&frame->frame,
+						&frame->frame_len);
+					break;
+				case DLT_IEEE802_11:
+					ok = wlantest_decap_80211(
+						wt, frame->data,
+						frame->hdr.caplen,
+						&frame->frame,
+						&frame->frame_len);
+					break;
+				}
+			}
+			if (!ok) {
+				frame->frame = NULL;
+			} else {
+				bssid = shard_bssid(frame->frame,
+						    frame->frame_len);
+				frame->shard = bssid ?
+					shard_select(bssid, threads) :
+					prev_shard;
+				/* Frames that wlantest_rx_frame() stores as
+				 * the previous frame (last_hdr) */
+				if (frame->frame_len >= 2 &&
+				    !(WPA_GET_LE16(frame->frame) &
+				      WLAN_FC_PVER))
+					prev_shard = frame->shard;
+			}
+			shard_move_notes(frame->notes, &frame->num_notes,
+					 wt->notes, &wt->num_notes);
+		}
+
+		if (num > 0) {
+			shard_run(shards, threads, frames, num, frame_num);
+			for (i = 0; i < (size_t) threads; i++) {
+				if (shards[i].wt.shard_conflict)
+					conflict = 1;
+			}
+			if (conflict) {
+				for (i = 0; i < num; i++)
+					shard_frame_clear(&frames[i]);
+				break;
+			}
+			for (i = 0; i < num; i++) {
+				shard_write_output(wt, cap.dlt, &frames[i]);
+				shard_frame_clear(&frames[i]);
+			}
+			frame_num += num;
+		}
+
+		if (ret <= 0)
+			break;
+	}
+	os_get_reltime(&end);
+
+	if (conflict) {
+		wpa_printf(MSG_INFO, "Frames in %s need state from more than "
+			   "one shard - process the file serially", fname);
+		goto out;
+	}
+
+	shard_merge(wt, shards, threads);
+
+	os_reltime_sub(&end, &start, &diff);
+	wpa_printf(MSG_DEBUG, "Read %s: %u packets", fname, count);
+	wpa_printf(MSG_INFO, "Read %u frames in %ld.%06ld s (%u frames/sec) "
+		   "using %d thread(s)", count, diff.sec, diff.usec,
+		   (unsigned int) (count * 1000000ULL /
+				   (diff.sec * 1000000ULL + diff.usec + 1)),
+		   threads);
+
+out:
+	for (i = 0; i < (size_t) threads; i++)
+		shard_deinit(&shards[i]);
+	os_free(shards);
+	os_free(frames);
+	clear_notes(wt);
+	os_free(wt->decrypted);
+	wt->decrypted = NULL;
+	munmap(map, st.st_size);
+
+	if (conflict) {
+		wt->fcs_error = fcs_error;
+		res = read_cap_file_serial(wt, fname);
+	}
+
+	return res;
+}
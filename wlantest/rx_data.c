@@ -92,46 +92,71 @@ static void rx_data_process(struct wlantest *wt, const u8 *bssid,
 }
 
 
-static u8 * try_all_ptk(struct wlantest *wt, int pairwise_cipher,
+static u8 * try_ptk(int pairwise_cipher, struct wlantest_ptk *ptk,
+		    const struct ieee80211_hdr *hdr,
+		    const u8 *data, size_t data_len, size_t *decrypted_len)
+{
+	unsigned int tk_len = ptk->ptk_len - 32;
+
+	if ((pairwise_cipher == WPA_CIPHER_CCMP ||
+	     pairwise_cipher == 0) && tk_len == 16)
+		return ccmp_decrypt(ptk->ptk.tk, hdr, data, data_len,
+				    decrypted_len);
+	if ((pairwise_cipher == WPA_CIPHER_CCMP_256 ||
+	     pairwise_cipher == 0) && tk_len == 32)
+		return ccmp_256_decrypt(ptk->ptk.tk, hdr, data, data_len,
+					decrypted_len);
+	if ((pairwise_cipher == WPA_CIPHER_GCMP ||
+	     pairwise_cipher == WPA_CIPHER_GCMP_256 ||
+	     pairwise_cipher == 0) &&
+	    (tk_len == 16 || tk_len == 32))
+		return gcmp_decrypt(ptk->ptk.tk, tk_len, hdr, data, data_len,
+				    decrypted_len);
+	if ((pairwise_cipher == WPA_CIPHER_TKIP ||
+	     pairwise_cipher == 0) && tk_len == 32)
+		return tkip_decrypt(ptk->ptk.tk, hdr, data, data_len,
+				    decrypted_len);
+	return NULL;
+}
+
+
+static u8 * try_all_ptk(struct wlantest *wt, struct wlantest_sta *sta,
 			const struct ieee80211_hdr *hdr,
 			const u8 *data, size_t data_len, size_t *decrypted_len)
 {
-	struct wlantest_ptk *ptk;
-	u8 *decrypted;
-	int prev_level = wpa_debug_level;
-
-	wpa_debug_level = MSG_WARNING;
-	dl_list_for_each(ptk, &wt->ptk, struct wlantest_ptk, list) {
-		unsigned int tk_len = ptk->ptk_len - 32;
-		decrypted = NULL;
-		if ((pairwise_cipher == WPA_CIPHER_CCMP ||
-		     pairwise_cipher == 0) && tk_len == 16) {
-			decrypted = ccmp_decrypt(ptk->ptk.tk, hdr, data,
-						 data_len, decrypted_len);
-		} else if ((pairwise_cipher == WPA_CIPHER_CCMP_256 ||
-			    pairwise_cipher == 0) && tk_len == 32) {
-			decrypted = ccmp_256_decrypt(ptk->ptk.tk, hdr, data,
-						     data_len, decrypted_len);
-		} else if ((pairwise_cipher == WPA_CIPHER_GCMP ||
-			    pairwise_cipher == WPA_CIPHER_GCMP_256 ||
-			    pairwise_cipher == 0) &&
-			   (tk_len == 16 || tk_len == 32)) {
-			decrypted = gcmp_decrypt(ptk->ptk.tk, tk_len, hdr,
-						 data, data_len, decrypted_len);
-		} else if ((pairwise_cipher == WPA_CIPHER_TKIP ||
-			    pairwise_cipher == 0) && tk_len == 32) {
-			decrypted = tkip_decrypt(ptk->ptk.tk, hdr, data,
-						 data_len, decrypted_len);
-		}
+	struct wlantest_ptk *ptk, *hint = sta->ptk_hint;
+	u8 *decrypted = NULL;
+
+	key_trial_debug_begin();
+	if (hint) {
+		/* PTK that matched the previous frame for this STA */
+		wt->ptk_trials++;
+		decrypted = try_ptk(sta->pairwise_cipher, hint, hdr, data,
+				    data_len, decrypted_len);
 		if (decrypted) {
-			wpa_debug_level = prev_level;
-			add_note(wt, MSG_DEBUG, "Found PTK match from list of all known PTKs");
-			return decrypted;
+			wt->ptk_hint_hits++;
+			ptk = hint;
 		}
 	}
-	wpa_debug_level = prev_level;
+	if (!decrypted) {
+		dl_list_for_each(ptk, &wt->ptk, struct wlantest_ptk, list) {
+			if (ptk == hint)
+				continue;
+			wt->ptk_trials++;
+			decrypted = try_ptk(sta->pairwise_cipher, ptk, hdr,
+					    data, data_len, decrypted_len);
+			if (decrypted)
+				break;
+		}
+	}
+	key_trial_debug_end();
 
-	return NULL;
+	if (!decrypted)
+		return NULL;
+	wt->ptk_matches++;
+	sta->ptk_hint = ptk;
+	add_note(wt, MSG_DEBUG, "Found PTK match from list of all known PTKs");
+	return decrypted;
 }
 
 
@@ -425,13 +450,11 @@ skip_replay_det:
 			decrypted = ccmp_decrypt(sta->ptk.tk, hdr, data, len,
 						 &dlen);
 	} else {
-		decrypted = try_all_ptk(wt, sta->pairwise_cipher, hdr, data,
-					len, &dlen);
+		decrypted = try_all_ptk(wt, sta, hdr, data, len, &dlen);
 		ptk_iter_done = 1;
 	}
 	if (!decrypted && !ptk_iter_done) {
-		decrypted = try_all_ptk(wt, sta->pairwise_cipher, hdr, data,
-					len, &dlen);
+		decrypted = try_all_ptk(wt, sta, hdr, data, len, &dlen);
 		if (decrypted) {
 			add_note(wt, MSG_DEBUG, "Current PTK did not work, but found a match from all known PTKs");
 		}
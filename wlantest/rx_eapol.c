@@ -99,6 +99,7 @@ static int try_pmk(struct wlantest *wt, struct wlantest_bss *bss,
 {
 	struct wpa_ptk ptk;
 
+	wt->pmk_trials++;
 	if (wpa_key_mgmt_ft(sta->key_mgmt)) {
 		u8 pmk_r0[PMK_LEN];
 		u8 pmk_r0_name[WPA_PMK_NAME_LEN];
@@ -136,6 +137,9 @@ static int try_pmk(struct wlantest *wt, struct wlantest_bss *bss,
 		return -1;
 	}
 
+	wt->pmk_matches++;
+	sta->pmk_hint = pmk;
+	bss->pmk_hint = pmk;
 	sta->tk_len = wpa_cipher_key_len(sta->pairwise_cipher);
 	wpa_printf(MSG_INFO, "Derived PTK for STA " MACSTR " BSSID " MACSTR,
 		   MAC2STR(sta->addr), MAC2STR(bss->bssid));
@@ -168,53 +172,97 @@ static int try_pmk(struct wlantest *wt, struct wlantest_bss *bss,
 }
 
 
+static int use_ptk(struct wlantest *wt, struct wlantest_bss *bss,
+		   struct wlantest_sta *sta, u16 ver,
+		   const u8 *data, size_t len,
+		   struct wlantest_ptk *ptk)
+{
+	wt->ptk_trials++;
+	if (check_mic(ptk->ptk.kck, ptk->ptk.kck_len, sta->key_mgmt, ver,
+		      data, len) < 0)
+		return -1;
+	wt->ptk_matches++;
+	sta->ptk_hint = ptk;
+	wt_printf(MSG_INFO, "Pre-set PTK matches for STA " MACSTR
+		  " BSSID " MACSTR, MAC2STR(sta->addr), MAC2STR(bss->bssid));
+	add_note(wt, MSG_DEBUG, "Using pre-set PTK");
+	ptk->ptk_len = 32 + wpa_cipher_key_len(sta->pairwise_cipher);
+	os_memcpy(&sta->ptk, &ptk->ptk, sizeof(ptk->ptk));
+	wt_hexdump(MSG_DEBUG, "PTK:KCK", sta->ptk.kck, sta->ptk.kck_len);
+	wt_hexdump(MSG_DEBUG, "PTK:KEK", sta->ptk.kek, sta->ptk.kek_len);
+	wt_hexdump(MSG_DEBUG, "PTK:TK", sta->ptk.tk, sta->ptk.tk_len);
+	sta->ptk_set = 1;
+	os_memset(sta->rsc_tods, 0, sizeof(sta->rsc_tods));
+	os_memset(sta->rsc_fromds, 0, sizeof(sta->rsc_fromds));
+	return 0;
+}
+
+
 static void derive_ptk(struct wlantest *wt, struct wlantest_bss *bss,
 		       struct wlantest_sta *sta, u16 ver,
 		       const u8 *data, size_t len)
 {
-	struct wlantest_pmk *pmk;
+	struct wlantest_pmk *pmk, *sta_hint, *bss_hint;
 
 	wpa_printf(MSG_DEBUG, "Trying to derive PTK for " MACSTR " (ver %u)",
 		   MAC2STR(sta->addr), ver);
+
+	/*
+	 * Try the PMK that last worked for this STA and then the one that last
+	 * worked within this BSS before walking through all candidates. This
+	 * avoids repeated trial derivation over the full per-BSS and global
+	 * lists on every 4-way handshake when many keys are configured.
+	 */
+	sta_hint = sta->pmk_hint;
+	bss_hint = bss->pmk_hint;
+	if (bss_hint == sta_hint)
+		bss_hint = NULL;
+	if (sta_hint) {
+		wpa_printf(MSG_DEBUG, "Try PMK that matched previously for STA");
+		if (try_pmk(wt, bss, sta, ver, data, len, sta_hint) == 0) {
+			wt->pmk_hint_hits++;
+			return;
+		}
+	}
+	if (bss_hint) {
+		wpa_printf(MSG_DEBUG, "Try PMK that matched previously in BSS");
+		if (try_pmk(wt, bss, sta, ver, data, len, bss_hint) == 0) {
+			wt->pmk_hint_hits++;
+			return;
+		}
+	}
+
 	dl_list_for_each(pmk, &bss->pmk, struct wlantest_pmk, list) {
+		if (pmk == sta_hint || pmk == bss_hint)
+			continue;
 		wpa_printf(MSG_DEBUG, "Try per-BSS PMK");
 		if (try_pmk(wt, bss, sta, ver, data, len, pmk) == 0)
 			return;
 	}
 
 	dl_list_for_each(pmk, &wt->pmk, struct wlantest_pmk, list) {
+		if (pmk == sta_hint || pmk == bss_hint)
+			continue;
 		wpa_printf(MSG_DEBUG, "Try global PMK");
 		if (try_pmk(wt, bss, sta, ver, data, len, pmk) == 0)
 			return;
 	}
 
 	if (!sta->ptk_set) {
-		struct wlantest_ptk *ptk;
-		int prev_level = wpa_debug_level;
-
-		wpa_debug_level = MSG_WARNING;
-		dl_list_for_each(ptk, &wt->ptk, struct wlantest_ptk, list) {
-			if (check_mic(ptk->ptk.kck, ptk->ptk.kck_len,
-				      sta->key_mgmt, ver, data, len) < 0)
-				continue;
-			wpa_printf(MSG_INFO, "Pre-set PTK matches for STA "
-				   MACSTR " BSSID " MACSTR,
-				   MAC2STR(sta->addr), MAC2STR(bss->bssid));
-			add_note(wt, MSG_DEBUG, "Using pre-set PTK");
-			ptk->ptk_len = 32 +
-				wpa_cipher_key_len(sta->pairwise_cipher);
-			os_memcpy(&sta->ptk, &ptk->ptk, sizeof(ptk->ptk));
-			wpa_hexdump(MSG_DEBUG, "PTK:KCK",
-				    sta->ptk.kck, sta->ptk.kck_len);
-			wpa_hexdump(MSG_DEBUG, "PTK:KEK",
-				    sta->ptk.kek, sta->ptk.kek_len);
-			wpa_hexdump(MSG_DEBUG, "PTK:TK",
-				    sta->ptk.tk, sta->ptk.tk_len);
-			sta->ptk_set = 1;
-			os_memset(sta->rsc_tods, 0, sizeof(sta->rsc_tods));
-			os_memset(sta->rsc_fromds, 0, sizeof(sta->rsc_fromds));
+		struct wlantest_ptk *ptk, *hint = sta->ptk_hint;
+		key_trial_debug_begin();
+		if (hint && use_ptk(wt, bss, sta, ver, data, len, hint) == 0) {
+			wt->ptk_hint_hits++;
+		} else {
+			dl_list_for_each(ptk, &wt->ptk, struct wlantest_ptk,
+					 list) {
+				if (ptk != hint &&
+				    use_ptk(wt, bss, sta, ver, data, len,
+					    ptk) == 0)
+					break;
+			}
 		}
-		wpa_debug_level = prev_level;
+		key_trial_debug_end();
 	}
 
 	add_note(wt, MSG_DEBUG, "No matching PMK found to derive PTK");
@@ -638,7 +686,8 @@ static void rx_data_eapol_key_3_of_4(struct wlantest *wt, const u8 *dst,
 		wpa_hexdump(MSG_DEBUG, "Decrypted EAPOL-Key Key Data",
 			    decrypted, decrypted_len);
 	}
-	if ((wt->write_pcap_dumper || wt->pcapng) && decrypted != key_data) {
+	if ((wt->write_pcap_dumper || wt->pcapng || wt->shard_frame) &&
+	    decrypted != key_data) {
 		/* Fill in a dummy Data frame header */
 		u8 buf[24 + 8 + sizeof(*eapol) + sizeof(*hdr) + 64];
 		struct ieee80211_hdr *h;
@@ -841,7 +890,7 @@ static void rx_data_eapol_key_1_of_2(struct wlantest *wt, const u8 *dst,
 	}
 	wpa_hexdump(MSG_DEBUG, "Decrypted EAPOL-Key Key Data",
 		    decrypted, decrypted_len);
-	if (wt->write_pcap_dumper || wt->pcapng) {
+	if (wt->write_pcap_dumper || wt->pcapng || wt->shard_frame) {
 		/* Fill in a dummy Data frame header */
 		u8 buf[24 + 8 + sizeof(*eapol) + sizeof(*hdr) + 64];
 		struct ieee80211_hdr *h;
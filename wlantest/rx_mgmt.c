@@ -1151,6 +1151,7 @@ void rx_mgmt(struct wlantest *wt, const u8 *data, size_t len)
 	os_free(decrypted);
 
 	wt->last_mgmt_valid = valid;
+	wt->last_mgmt_frame = wt->frame_num;
 }
 
 
@@ -1225,6 +1226,14 @@ void rx_mgmt_ack(struct wlantest *wt, const struct ieee80211_hdr *hdr)
 		   stype, MAC2STR(hdr->addr1), MAC2STR(hdr->addr2),
 		   MAC2STR(hdr->addr3));
 
+	/*
+	 * A shard knows last_mgmt_valid only if the acknowledged frame set it,
+	 * i.e., was not dropped as a duplicate.
+	 */
+	if (wt->num_shards > 1 && wt->last_mgmt_frame != wt->last_frame &&
+	    (stype == WLAN_FC_STYPE_DEAUTH || stype == WLAN_FC_STYPE_DISASSOC))
+		wt->shard_conflict = 1;
+
 	switch (stype) {
 	case WLAN_FC_STYPE_DEAUTH:
 		rx_mgmt_deauth_ack(wt, hdr);
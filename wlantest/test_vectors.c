@@ -15,6 +15,13 @@
 #include "wlantest.h"
 
 
+int key_trial_debug_quiet(void)
+{
+	/* No key trials here; always show the crypto debug output */
+	return 0;
+}
+
+
 static void test_vector_tkip(void)
 {
 	u8 tk[] = {
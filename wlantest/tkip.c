@@ -309,13 +309,13 @@ u8 * tkip_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 
 	iv16 = (data[0] << 8) | data[2];
 	iv32 = WPA_GET_LE32(&data[4]);
-	wpa_printf(MSG_EXCESSIVE, "TKIP decrypt: iv32=%08x iv16=%04x",
-		   iv32, iv16);
+	wt_printf(MSG_EXCESSIVE, "TKIP decrypt: iv32=%08x iv16=%04x",
+		  iv32, iv16);
 
 	tkip_mixing_phase1(ttak, tk, hdr->addr2, iv32);
-	wpa_hexdump(MSG_EXCESSIVE, "TKIP TTAK", (u8 *) ttak, sizeof(ttak));
+	wt_hexdump(MSG_EXCESSIVE, "TKIP TTAK", (u8 *) ttak, sizeof(ttak));
 	tkip_mixing_phase2(rc4key, tk, ttak, iv16);
-	wpa_hexdump(MSG_EXCESSIVE, "TKIP RC4KEY", rc4key, sizeof(rc4key));
+	wt_hexdump(MSG_EXCESSIVE, "TKIP RC4KEY", rc4key, sizeof(rc4key));
 
 	plain_len = data_len - 8;
 	plain = os_memdup(data + 8, plain_len);
@@ -326,10 +326,10 @@ u8 * tkip_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 	icv = crc32(plain, plain_len - 4);
 	rx_icv = WPA_GET_LE32(plain + plain_len - 4);
 	if (icv != rx_icv) {
-		wpa_printf(MSG_INFO, "TKIP ICV mismatch in frame from " MACSTR,
-			   MAC2STR(hdr->addr2));
-		wpa_printf(MSG_DEBUG, "TKIP calculated ICV %08x  received ICV "
-			   "%08x", icv, rx_icv);
+		wt_printf(MSG_INFO, "TKIP ICV mismatch in frame from " MACSTR,
+			  MAC2STR(hdr->addr2));
+		wt_printf(MSG_DEBUG, "TKIP calculated ICV %08x  received ICV "
+			  "%08x", icv, rx_icv);
 		os_free(plain);
 		return NULL;
 	}
@@ -338,8 +338,8 @@ u8 * tkip_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 	/* TODO: MSDU reassembly */
 
 	if (plain_len < 8) {
-		wpa_printf(MSG_INFO, "TKIP: Not enough room for Michael MIC "
-			   "in a frame from " MACSTR, MAC2STR(hdr->addr2));
+		wt_printf(MSG_INFO, "TKIP: Not enough room for Michael MIC "
+			  "in a frame from " MACSTR, MAC2STR(hdr->addr2));
 		os_free(plain);
 		return NULL;
 	}
@@ -348,11 +348,11 @@ u8 * tkip_decrypt(const u8 *tk, const struct ieee80211_hdr *hdr,
 	mic_key = tk + ((fc & WLAN_FC_FROMDS) ? 16 : 24);
 	michael_mic(mic_key, michael_hdr, plain, plain_len - 8, mic);
 	if (os_memcmp(mic, plain + plain_len - 8, 8) != 0) {
-		wpa_printf(MSG_INFO, "TKIP: Michael MIC mismatch in a frame "
-			   "from " MACSTR, MAC2STR(hdr->addr2));
-		wpa_hexdump(MSG_DEBUG, "TKIP: Calculated MIC", mic, 8);
-		wpa_hexdump(MSG_DEBUG, "TKIP: Received MIC",
-			    plain + plain_len - 8, 8);
+		wt_printf(MSG_INFO, "TKIP: Michael MIC mismatch in a frame "
+			  "from " MACSTR, MAC2STR(hdr->addr2));
+		wt_hexdump(MSG_DEBUG, "TKIP: Calculated MIC", mic, 8);
+		wt_hexdump(MSG_DEBUG, "TKIP: Received MIC",
+			   plain + plain_len - 8, 8);
 		os_free(plain);
 		return NULL;
 	}
@@ -395,14 +395,14 @@ u8 * tkip_encrypt(const u8 *tk, u8 *frame, size_t len, size_t hdrlen, u8 *qos,
 	michael_mic_hdr(hdr, michael_hdr);
 	mic_key = tk + ((fc & WLAN_FC_FROMDS) ? 16 : 24);
 	michael_mic(mic_key, michael_hdr, frame + hdrlen, len - hdrlen, mic);
-	wpa_hexdump(MSG_EXCESSIVE, "TKIP: MIC", mic, sizeof(mic));
+	wt_hexdump(MSG_EXCESSIVE, "TKIP: MIC", mic, sizeof(mic));
 
 	iv32 = WPA_GET_BE32(pn);
 	iv16 = WPA_GET_BE16(pn + 4);
 	tkip_mixing_phase1(ttak, tk, hdr->addr2, iv32);
-	wpa_hexdump(MSG_EXCESSIVE, "TKIP TTAK", (u8 *) ttak, sizeof(ttak));
+	wt_hexdump(MSG_EXCESSIVE, "TKIP TTAK", (u8 *) ttak, sizeof(ttak));
 	tkip_mixing_phase2(rc4key, tk, ttak, iv16);
-	wpa_hexdump(MSG_EXCESSIVE, "TKIP RC4KEY", rc4key, sizeof(rc4key));
+	wt_hexdump(MSG_EXCESSIVE, "TKIP RC4KEY", rc4key, sizeof(rc4key));
 
 	crypt = os_malloc(len + 8 + sizeof(mic) + 4);
 	if (crypt == NULL)
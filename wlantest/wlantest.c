@@ -27,7 +27,10 @@ static void usage(void)
 	       "[-P<RADIUS shared secret>]\n"
 	       "         [-n<write pcapng file>]\n"
 	       "         [-w<write pcap file>] [-f<MSK/PMK file>]\n"
-	       "         [-L<log file>] [-T<PTK file>]\n");
+	       "         [-L<log file>] [-T<PTK file>]\n"
+	       "         [-j<number of PMK derivation threads>]\n"
+	       "         [-S<number of threads for mmap-based pcap file "
+	       "reading>]\n");
 }
 
 
@@ -287,7 +290,7 @@ void add_note(struct wlantest *wt, int level, const char *fmt, ...)
 	}
 	if (wlen >= len)
 		wt->notes[wt->num_notes][len - 1] = '\0';
-	wpa_printf(level, "%s", wt->notes[wt->num_notes]);
+	wt_printf(level, "%s", wt->notes[wt->num_notes]);
 	wt->num_notes++;
 }
 
@@ -305,6 +308,33 @@ void clear_notes(struct wlantest *wt)
 }
 
 
+/*
+ * Most key trials are expected to fail, so debug output from the decryption
+ * and MIC check paths (wt_printf() and wt_hexdump()) is suppressed while
+ * running them. This is tracked per thread instead of raising
+ * wpa_debug_level so that key trials in one shard worker thread do not hide
+ * the debug output of the other shards.
+ */
+static __thread unsigned int key_trial_depth;
+
+void key_trial_debug_begin(void)
+{
+	key_trial_depth++;
+}
+
+
+void key_trial_debug_end(void)
+{
+	key_trial_depth--;
+}
+
+
+int key_trial_debug_quiet(void)
+{
+	return key_trial_depth > 0;
+}
+
+
 size_t notes_len(struct wlantest *wt, size_t hdrlen)
 {
 	size_t i;
@@ -351,6 +381,7 @@ int main(int argc, char *argv[])
 	const char *logfile = NULL;
 	struct wlantest wt;
 	int ctrl_iface = 0;
+	int read_threads = 0;
 
 	wpa_debug_level = MSG_INFO;
 	wpa_debug_show_keys = 1;
@@ -361,7 +392,7 @@ int main(int argc, char *argv[])
 	wlantest_init(&wt);
 
 	for (;;) {
-		c = getopt(argc, argv, "cdf:Fhi:I:L:n:Np:P:qr:R:tT:w:W:");
+		c = getopt(argc, argv, "cdf:Fhi:I:j:L:n:Np:P:qr:R:S:tT:w:W:");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -388,6 +419,9 @@ int main(int argc, char *argv[])
 		case 'I':
 			ifname_wired = optarg;
 			break;
+		case 'j':
+			wt.pmk_threads = atoi(optarg);
+			break;
 		case 'L':
 			logfile = optarg;
 			break;
@@ -412,6 +446,11 @@ int main(int argc, char *argv[])
 		case 'R':
 			read_wired_file = optarg;
 			break;
+		case 'S':
+			read_threads = atoi(optarg);
+			if (read_threads < 1)
+				read_threads = 1;
+			break;
 		case 't':
 			wpa_debug_timestamp = 1;
 			break;
@@ -453,7 +492,11 @@ int main(int argc, char *argv[])
 	if (read_wired_file && read_wired_cap_file(&wt, read_wired_file) < 0)
 		return -1;
 
-	if (read_file && read_cap_file(&wt, read_file) < 0)
+	if (read_file && read_threads &&
+	    read_cap_file_mmap(&wt, read_file, read_threads) < 0)
+		return -1;
+
+	if (read_file && !read_threads && read_cap_file(&wt, read_file) < 0)
 		return -1;
 
 	if (ifname && monitor_init(&wt, ifname) < 0)
@@ -472,6 +515,10 @@ int main(int argc, char *argv[])
 	wpa_printf(MSG_INFO, "Processed: rx_mgmt=%u rx_ctrl=%u rx_data=%u "
 		   "fcs_error=%u",
 		   wt.rx_mgmt, wt.rx_ctrl, wt.rx_data, wt.fcs_error);
+	wpa_printf(MSG_INFO, "Key trials: pmk=%u (matched=%u hint=%u) "
+		   "ptk=%u (matched=%u hint=%u)",
+		   wt.pmk_trials, wt.pmk_matches, wt.pmk_hint_hits,
+		   wt.ptk_trials, wt.ptk_matches, wt.ptk_hint_hits);
 
 	wlantest_deinit(&wt);
 
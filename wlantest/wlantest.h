@@ -74,6 +74,8 @@ struct wlantest_sta {
 	int ptk_set;
 	struct wpa_ptk tptk; /* Derived PTK during rekeying */
 	int tptk_set;
+	struct wlantest_pmk *pmk_hint; /* PMK that last derived a PTK */
+	struct wlantest_ptk *ptk_hint; /* pre-set PTK that last matched */
 	u8 rsc_tods[16 + 1][6];
 	u8 rsc_fromds[16 + 1][6];
 	u8 ap_sa_query_tr[2];
@@ -141,6 +143,7 @@ struct wlantest_bss {
 	int rsn_capab;
 	struct dl_list sta; /* struct wlantest_sta */
 	struct dl_list pmk; /* struct wlantest_pmk */
+	struct wlantest_pmk *pmk_hint; /* PMK that last derived a PTK */
 	u8 gtk[4][32];
 	size_t gtk_len[4];
 	int gtk_idx;
@@ -155,6 +158,7 @@ struct wlantest_bss {
 	u8 r0kh_id[FT_R0KH_ID_MAX_LEN];
 	size_t r0kh_id_len;
 	u8 r1kh_id[FT_R1KH_ID_LEN];
+	unsigned int first_frame; /* frame_num when the entry was added */
 };
 
 struct wlantest_radius {
@@ -188,6 +192,24 @@ struct wlantest {
 	unsigned int rx_data;
 	unsigned int fcs_error;
 
+	/* Key trial statistics */
+	unsigned int pmk_trials;
+	unsigned int pmk_matches;
+	unsigned int pmk_hint_hits;
+	unsigned int ptk_trials;
+	unsigned int ptk_matches;
+	unsigned int ptk_hint_hits;
+
+	int pmk_threads; /* worker threads for passphrase-to-PMK derivation */
+
+	/* Sharded capture file processing (readpcap_mmap.c) */
+	unsigned int frame_num;
+	struct wlantest_shard_frame *shard_frame;
+	int num_shards; /* number of shards if this is a shard context */
+	int shard_conflict; /* a frame needed state from another shard */
+	unsigned int last_frame; /* frame_num of the frame in last_hdr */
+	unsigned int last_mgmt_frame; /* frame_num that set last_mgmt_valid */
+
 	void *write_pcap; /* pcap_t* */
 	void *write_pcap_dumper; /* pcpa_dumper_t */
 	struct timeval write_pcap_time;
@@ -218,6 +240,26 @@ size_t notes_len(struct wlantest *wt, size_t hdrlen);
 
 int add_wep(struct wlantest *wt, const char *key);
 int read_cap_file(struct wlantest *wt, const char *fname);
+int read_cap_file_mmap(struct wlantest *wt, const char *fname, int threads);
+void shard_frame_add_decrypted(struct wlantest_shard_frame *frame,
+			       const u8 *buf, size_t len);
+void shard_check_bssid(struct wlantest *wt, const u8 *bssid);
+void key_trial_debug_begin(void);
+void key_trial_debug_end(void);
+int key_trial_debug_quiet(void);
+
+/* Debug output that is suppressed while the current thread is trying keys */
+#define wt_printf(level, ...)					\
+do {								\
+	if (!key_trial_debug_quiet())				\
+		wpa_printf((level), __VA_ARGS__);		\
+} while (0)
+
+#define wt_hexdump(level, title, buf, len)			\
+do {								\
+	if (!key_trial_debug_quiet())				\
+		wpa_hexdump((level), (title), (buf), (len));	\
+} while (0)
 int read_wired_cap_file(struct wlantest *wt, const char *fname);
 
 int write_pcap_init(struct wlantest *wt, const char *fname);
@@ -225,6 +267,9 @@ void write_pcap_deinit(struct wlantest *wt);
 void write_pcap_captured(struct wlantest *wt, const u8 *buf, size_t len);
 void write_pcap_decrypted(struct wlantest *wt, const u8 *buf1, size_t len1,
 			  const u8 *buf2, size_t len2);
+void write_pcap_with_radiotap(struct wlantest *wt,
+			      const u8 *data, size_t data_len);
+void write_pcap_dump(struct wlantest *wt, const u8 *buf, size_t len);
 
 int write_pcapng_init(struct wlantest *wt, const char *fname);
 void write_pcapng_deinit(struct wlantest *wt);
@@ -233,6 +278,13 @@ void write_pcapng_write_read(struct wlantest *wt, int dlt,
 			     struct pcap_pkthdr *hdr, const u8 *data);
 void write_pcapng_captured(struct wlantest *wt, const u8 *buf, size_t len);
 
+int wlantest_decap(struct wlantest *wt, const u8 *data, size_t len,
+		   const u8 **frame, size_t *frame_len);
+int wlantest_decap_prism(struct wlantest *wt, const u8 *data, size_t len,
+			 const u8 **frame, size_t *frame_len);
+int wlantest_decap_80211(struct wlantest *wt, const u8 *data, size_t len,
+			 const u8 **frame, size_t *frame_len);
+void wlantest_rx_frame(struct wlantest *wt, const u8 *data, size_t len);
 void wlantest_process(struct wlantest *wt, const u8 *data, size_t len);
 void wlantest_process_prism(struct wlantest *wt, const u8 *data, size_t len);
 void wlantest_process_80211(struct wlantest *wt, const u8 *data, size_t len);
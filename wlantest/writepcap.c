@@ -67,7 +67,6 @@ void write_pcap_captured(struct wlantest *wt, const u8 *buf, size_t len)
 void write_pcap_decrypted(struct wlantest *wt, const u8 *buf1, size_t len1,
 			  const u8 *buf2, size_t len2)
 {
-	struct pcap_pkthdr h;
 	u8 rtap[] = {
 		0x00 /* rev */,
 		0x00 /* pad */,
@@ -79,7 +78,7 @@ void write_pcap_decrypted(struct wlantest *wt, const u8 *buf1, size_t len1,
 	u8 *buf;
 	size_t len;
 
-	if (!wt->write_pcap_dumper && !wt->pcapng)
+	if (!wt->write_pcap_dumper && !wt->pcapng && !wt->shard_frame)
 		return;
 
 	os_free(wt->decrypted);
@@ -96,6 +95,20 @@ void write_pcap_decrypted(struct wlantest *wt, const u8 *buf1, size_t len1,
 	if (buf2)
 		os_memcpy(buf + sizeof(rtap) + len1, buf2, len2);
 
+	if (wt->shard_frame) {
+		/* Written in frame order once the shard workers are done */
+		shard_frame_add_decrypted(wt->shard_frame, buf, len);
+		return;
+	}
+
+	write_pcap_dump(wt, buf, len);
+}
+
+
+void write_pcap_dump(struct wlantest *wt, const u8 *buf, size_t len)
+{
+	struct pcap_pkthdr h;
+
 	if (!wt->write_pcap_dumper)
 		return;
 
@@ -109,6 +122,39 @@ void write_pcap_decrypted(struct wlantest *wt, const u8 *buf1, size_t len1,
 }
 
 
+void write_pcap_with_radiotap(struct wlantest *wt,
+			      const u8 *data, size_t data_len)
+{
+	struct pcap_pkthdr h;
+	u8 rtap[] = {
+		0x00 /* rev */,
+		0x00 /* pad */,
+		0x0a, 0x00, /* header len */
+		0x02, 0x00, 0x00, 0x00, /* present flags */
+		0x00, /* flags */
+		0x00 /* pad */
+	};
+	u8 *buf;
+	size_t len;
+
+	if (wt->assume_fcs)
+		rtap[8] |= 0x10;
+
+	os_memset(&h, 0, sizeof(h));
+	h.ts = wt->write_pcap_time;
+	len = sizeof(rtap) + data_len;
+	buf = os_malloc(len);
+	if (buf == NULL)
+		return;
+	os_memcpy(buf, rtap, sizeof(rtap));
+	os_memcpy(buf + sizeof(rtap), data, data_len);
+	h.caplen = len;
+	h.len = len;
+	pcap_dump(wt->write_pcap_dumper, &h, buf);
+	os_free(buf);
+}
+
+
 struct pcapng_section_header {
 	u32 block_type; /* 0x0a0d0d0a */
 	u32 block_total_len;
@@ -152,6 +152,18 @@ ifdef CONFIG_ELOOP_EPOLL
 L_CFLAGS += -DCONFIG_ELOOP_EPOLL
 endif
 
+ifdef CONFIG_ELOOP_STATS
+L_CFLAGS += -DCONFIG_ELOOP_STATS
+endif
+
+ifdef CONFIG_MEM_POOL
+L_CFLAGS += -DCONFIG_MEM_POOL
+OBJS += src/utils/mem_pool.c
+OBJS_p += src/utils/mem_pool.c
+OBJS_c += src/utils/mem_pool.c
+OBJS_priv += src/utils/mem_pool.c
+endif
+
 ifdef CONFIG_EAPOL_TEST
 L_CFLAGS += -Werror -DEAPOL_TEST
 endif
@@ -234,6 +246,7 @@ L_CFLAGS += -DCONFIG_MESH
 OBJS += mesh.c
 OBJS += mesh_mpm.c
 OBJS += mesh_rsn.c
+OBJS += src/utils/timer_list.c
 endif
 
 ifdef CONFIG_SAE
@@ -1519,6 +1532,10 @@ ifdef CONFIG_DEBUG_FILE
 L_CFLAGS += -DCONFIG_DEBUG_FILE
 endif
 
+ifdef CONFIG_DEBUG_BUFFERED
+L_CFLAGS += -DCONFIG_DEBUG_BUFFERED
+endif
+
 ifdef CONFIG_DELAYED_MIC_ERROR_REPORT
 L_CFLAGS += -DCONFIG_DELAYED_MIC_ERROR_REPORT
 endif
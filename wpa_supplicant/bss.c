@@ -13,6 +13,7 @@
 #include "common/ieee802_11_defs.h"
 #include "drivers/driver.h"
 #include "eap_peer/eap.h"
+#include "rsn_supp/wpa.h"
 #include "wpa_supplicant_i.h"
 #include "config.h"
 #include "notify.h"
@@ -31,6 +32,101 @@
 #define WPA_BSS_IES_CHANGED_FLAG	BIT(8)
 
 
+/* Largest IE field offset that can be stored in struct wpa_bss::ie_pos */
+#define WPA_BSS_IE_POS_MAX 0xfffe
+
+
+static void wpa_bss_hash_add(struct wpa_supplicant *wpa_s,
+			     struct wpa_bss *bss)
+{
+	bss->hnext = wpa_s->bss_hash[WPA_BSS_HASH(bss->bssid)];
+	wpa_s->bss_hash[WPA_BSS_HASH(bss->bssid)] = bss;
+
+#ifdef CONFIG_P2P
+	if (!is_zero_ether_addr(bss->p2p_dev_addr)) {
+		bss->p2p_hnext =
+			wpa_s->bss_p2p_hash[WPA_BSS_HASH(bss->p2p_dev_addr)];
+		wpa_s->bss_p2p_hash[WPA_BSS_HASH(bss->p2p_dev_addr)] = bss;
+	}
+#endif /* CONFIG_P2P */
+}
+
+
+static void wpa_bss_hash_del(struct wpa_supplicant *wpa_s,
+			     struct wpa_bss *bss)
+{
+	struct wpa_bss **pos;
+
+#ifdef CONFIG_P2P
+	if (!is_zero_ether_addr(bss->p2p_dev_addr)) {
+		for (pos = &wpa_s->bss_p2p_hash[
+			     WPA_BSS_HASH(bss->p2p_dev_addr)];
+		     *pos; pos = &(*pos)->p2p_hnext) {
+			if (*pos == bss) {
+				*pos = bss->p2p_hnext;
+				bss->p2p_hnext = NULL;
+				break;
+			}
+		}
+	}
+#endif /* CONFIG_P2P */
+
+	for (pos = &wpa_s->bss_hash[WPA_BSS_HASH(bss->bssid)]; *pos;
+	     pos = &(*pos)->hnext) {
+		if (*pos == bss) {
+			*pos = bss->hnext;
+			bss->hnext = NULL;
+			return;
+		}
+	}
+
+	wpa_printf(MSG_DEBUG, "BSS: Could not remove " MACSTR
+		   " from hash table", MAC2STR(bss->bssid));
+}
+
+
+static void wpa_bss_parse_ies(struct wpa_bss *bss)
+{
+	const u8 *start, *pos, *end, *ie;
+
+	os_memset(bss->ie_pos, 0, sizeof(bss->ie_pos));
+	start = pos = (const u8 *) (bss + 1);
+	end = pos + bss->ie_len;
+
+	bss->ie_pos_len = bss->ie_len;
+	while (end - pos > 1) {
+		if (2 + pos[1] > end - pos)
+			break;
+		if (pos - start > WPA_BSS_IE_POS_MAX) {
+			/* The rest is searched linearly */
+			bss->ie_pos_len = pos - start;
+			break;
+		}
+		if (!bss->ie_pos[pos[0]])
+			bss->ie_pos[pos[0]] = pos - start + 1;
+		pos += 2 + pos[1];
+	}
+
+	/* Security parameters are compared against every enabled network */
+	ie = wpa_bss_get_ie(bss, WLAN_EID_RSN);
+	bss->rsn_ie_parsed = ie &&
+		wpa_parse_wpa_ie(ie, 2 + ie[1], &bss->rsn_ie) == 0;
+	ie = wpa_bss_get_vendor_ie(bss, WPA_IE_VENDOR_TYPE);
+	bss->wpa_ie_parsed = ie &&
+		wpa_parse_wpa_ie(ie, 2 + ie[1], &bss->wpa_ie) == 0;
+
+#ifdef CONFIG_P2P
+	/*
+	 * The address is used as a key in bss_p2p_hash, so the caller must
+	 * have removed the entry from the hash tables.
+	 */
+	if (!wpa_bss_get_vendor_ie(bss, P2P_IE_VENDOR_TYPE) ||
+	    p2p_parse_dev_addr(start, bss->ie_len, bss->p2p_dev_addr) < 0)
+		os_memset(bss->p2p_dev_addr, 0, ETH_ALEN);
+#endif /* CONFIG_P2P */
+}
+
+
 static void wpa_bss_set_hessid(struct wpa_bss *bss)
 {
 #ifdef CONFIG_INTERWORKING
@@ -233,6 +329,7 @@ void wpa_bss_remove(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		}
 	}
 	wpa_bss_update_pending_connect(wpa_s, bss, NULL);
+	wpa_bss_hash_del(wpa_s, bss);
 	dl_list_del(&bss->list);
 	dl_list_del(&bss->list_id);
 	wpa_s->num_bss--;
@@ -259,7 +356,8 @@ struct wpa_bss * wpa_bss_get(struct wpa_supplicant *wpa_s, const u8 *bssid,
 	struct wpa_bss *bss;
 	if (!wpa_supplicant_filter_bssid_match(wpa_s, bssid))
 		return NULL;
-	dl_list_for_each(bss, &wpa_s->bss, struct wpa_bss, list) {
+	for (bss = wpa_s->bss_hash[WPA_BSS_HASH(bssid)]; bss;
+	     bss = bss->hnext) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0 &&
 		    bss->ssid_len == ssid_len &&
 		    os_memcmp(bss->ssid, ssid, ssid_len) == 0)
@@ -439,6 +537,7 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 	bss->ie_len = res->ie_len;
 	bss->beacon_ie_len = res->beacon_ie_len;
 	os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
+	wpa_bss_parse_ies(bss);
 	wpa_bss_set_hessid(bss);
 
 	if (wpa_s->num_bss + 1 > wpa_s->conf->bss_max_count &&
@@ -451,6 +550,7 @@ static struct wpa_bss * wpa_bss_add(struct wpa_supplicant *wpa_s,
 
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
 	dl_list_add_tail(&wpa_s->bss_id, &bss->list_id);
+	wpa_bss_hash_add(wpa_s, bss);
 	wpa_s->num_bss++;
 	wpa_dbg(wpa_s, MSG_DEBUG, "BSS: Add new id %u BSSID " MACSTR
 		" SSID '%s' freq %d",
@@ -640,8 +740,12 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 	bss->scan_miss_count = 0;
 	bss->last_update_idx = wpa_s->bss_update_idx;
 	wpa_bss_copy_res(bss, res, fetch_time);
-	/* Move the entry to the end of the list */
+	/*
+	 * Move the entry to the end of the list and to the head of its hash
+	 * bucket so that the bucket order matches the reverse list order.
+	 */
 	dl_list_del(&bss->list);
+	wpa_bss_hash_del(wpa_s, bss);
 #ifdef CONFIG_P2P
 	if (wpa_bss_get_vendor_ie(bss, P2P_IE_VENDOR_TYPE) &&
 	    !wpa_scan_get_vendor_ie(res, P2P_IE_VENDOR_TYPE)) {
@@ -663,6 +767,7 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 		os_memcpy(bss + 1, res + 1, res->ie_len + res->beacon_ie_len);
 		bss->ie_len = res->ie_len;
 		bss->beacon_ie_len = res->beacon_ie_len;
+		wpa_bss_parse_ies(bss);
 	} else {
 		struct wpa_bss *nbss;
 		struct dl_list *prev = bss->list_id.prev;
@@ -685,12 +790,14 @@ wpa_bss_update(struct wpa_supplicant *wpa_s, struct wpa_bss *bss,
 				  res->ie_len + res->beacon_ie_len);
 			bss->ie_len = res->ie_len;
 			bss->beacon_ie_len = res->beacon_ie_len;
+			wpa_bss_parse_ies(bss);
 		}
 		dl_list_add(prev, &bss->list_id);
 	}
 	if (changes & WPA_BSS_IES_CHANGED_FLAG)
 		wpa_bss_set_hessid(bss);
 	dl_list_add_tail(&wpa_s->bss, &bss->list);
+	wpa_bss_hash_add(wpa_s, bss);
 
 	notify_bss_changes(wpa_s, changes, bss);
 
@@ -789,16 +896,15 @@ void wpa_bss_update_scan_res(struct wpa_supplicant *wpa_s,
 	if (bss == NULL)
 		bss = wpa_bss_add(wpa_s, ssid + 2, ssid[1], res, fetch_time);
 	else {
+		/*
+		 * An entry that was already updated in this round has already
+		 * been added to last_scan_res.
+		 */
+		int seen = bss->last_update_idx == wpa_s->bss_update_idx;
+
 		bss = wpa_bss_update(wpa_s, bss, res, fetch_time);
-		if (wpa_s->last_scan_res) {
-			unsigned int i;
-			for (i = 0; i < wpa_s->last_scan_res_used; i++) {
-				if (bss == wpa_s->last_scan_res[i]) {
-					/* Already in the list */
-					return;
-				}
-			}
-		}
+		if (seen)
+			return;
 	}
 
 	if (bss == NULL)
@@ -943,6 +1049,10 @@ int wpa_bss_init(struct wpa_supplicant *wpa_s)
 {
 	dl_list_init(&wpa_s->bss);
 	dl_list_init(&wpa_s->bss_id);
+	os_memset(wpa_s->bss_hash, 0, sizeof(wpa_s->bss_hash));
+#ifdef CONFIG_P2P
+	os_memset(wpa_s->bss_p2p_hash, 0, sizeof(wpa_s->bss_p2p_hash));
+#endif /* CONFIG_P2P */
 	return 0;
 }
 
@@ -990,7 +1100,9 @@ struct wpa_bss * wpa_bss_get_bssid(struct wpa_supplicant *wpa_s,
 	struct wpa_bss *bss;
 	if (!wpa_supplicant_filter_bssid_match(wpa_s, bssid))
 		return NULL;
-	dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+	/* Hash buckets are ordered from the most recently updated entry */
+	for (bss = wpa_s->bss_hash[WPA_BSS_HASH(bssid)]; bss;
+	     bss = bss->hnext) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) == 0)
 			return bss;
 	}
@@ -1015,7 +1127,8 @@ struct wpa_bss * wpa_bss_get_bssid_latest(struct wpa_supplicant *wpa_s,
 	struct wpa_bss *bss, *found = NULL;
 	if (!wpa_supplicant_filter_bssid_match(wpa_s, bssid))
 		return NULL;
-	dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
+	for (bss = wpa_s->bss_hash[WPA_BSS_HASH(bssid)]; bss;
+	     bss = bss->hnext) {
 		if (os_memcmp(bss->bssid, bssid, ETH_ALEN) != 0)
 			continue;
 		if (found == NULL ||
@@ -1037,11 +1150,15 @@ struct wpa_bss * wpa_bss_get_p2p_dev_addr(struct wpa_supplicant *wpa_s,
 					  const u8 *dev_addr)
 {
 	struct wpa_bss *bss;
-	dl_list_for_each_reverse(bss, &wpa_s->bss, struct wpa_bss, list) {
-		u8 addr[ETH_ALEN];
-		if (p2p_parse_dev_addr((const u8 *) (bss + 1), bss->ie_len,
-				       addr) == 0 &&
-		    os_memcmp(addr, dev_addr, ETH_ALEN) == 0)
+
+	/* Entries without a P2P IE have an all-zeros address */
+	if (is_zero_ether_addr(dev_addr))
+		return NULL;
+
+	/* The most recently updated entry is at the head of the bucket */
+	for (bss = wpa_s->bss_p2p_hash[WPA_BSS_HASH(dev_addr)]; bss;
+	     bss = bss->p2p_hnext) {
+		if (os_memcmp(bss->p2p_dev_addr, dev_addr, ETH_ALEN) == 0)
 			return bss;
 	}
 	return NULL;
@@ -1089,6 +1206,19 @@ struct wpa_bss * wpa_bss_get_id_range(struct wpa_supplicant *wpa_s,
 }
 
 
+/* Start of the search for the first element with ID ie or NULL if none */
+static const u8 * wpa_bss_ie_start(const struct wpa_bss *bss, u8 ie)
+{
+	const u8 *start = (const u8 *) (bss + 1);
+
+	if (bss->ie_pos[ie])
+		return start + bss->ie_pos[ie] - 1;
+	if (bss->ie_pos_len < bss->ie_len)
+		return start + bss->ie_pos_len;
+	return NULL;
+}
+
+
 /**
  * wpa_bss_get_ie - Fetch a specified information element from a BSS entry
  * @bss: BSS table entry
@@ -1100,7 +1230,11 @@ struct wpa_bss * wpa_bss_get_id_range(struct wpa_supplicant *wpa_s,
  */
 const u8 * wpa_bss_get_ie(const struct wpa_bss *bss, u8 ie)
 {
-	return get_ie((const u8 *) (bss + 1), bss->ie_len, ie);
+	const u8 *pos = wpa_bss_ie_start(bss, ie);
+
+	if (!pos || bss->ie_pos[ie])
+		return pos;
+	return get_ie(pos, (const u8 *) (bss + 1) + bss->ie_len - pos, ie);
 }
 
 
@@ -1117,8 +1251,10 @@ const u8 * wpa_bss_get_vendor_ie(const struct wpa_bss *bss, u32 vendor_type)
 {
 	const u8 *end, *pos;
 
-	pos = (const u8 *) (bss + 1);
-	end = pos + bss->ie_len;
+	pos = wpa_bss_ie_start(bss, WLAN_EID_VENDOR_SPECIFIC);
+	if (!pos)
+		return NULL;
+	end = (const u8 *) (bss + 1) + bss->ie_len;
 
 	while (end - pos > 1) {
 		if (2 + pos[1] > end - pos)
@@ -1186,12 +1322,15 @@ struct wpabuf * wpa_bss_get_vendor_ie_multi(const struct wpa_bss *bss,
 	struct wpabuf *buf;
 	const u8 *end, *pos;
 
+	pos = wpa_bss_ie_start(bss, WLAN_EID_VENDOR_SPECIFIC);
+	if (!pos)
+		return NULL;
+
 	buf = wpabuf_alloc(bss->ie_len);
 	if (buf == NULL)
 		return NULL;
 
-	pos = (const u8 *) (bss + 1);
-	end = pos + bss->ie_len;
+	end = (const u8 *) (bss + 1) + bss->ie_len;
 
 	while (end - pos > 1) {
 		if (2 + pos[1] > end - pos)
@@ -9,6 +9,8 @@
 #ifndef BSS_H
 #define BSS_H
 
+#include "common/wpa_common.h"
+
 struct wpa_scan_res;
 
 #define WPA_BSS_QUAL_INVALID		BIT(0)
@@ -64,6 +66,8 @@ struct wpa_bss {
 	struct dl_list list;
 	/** List entry for struct wpa_supplicant::bss_id */
 	struct dl_list list_id;
+	/** Next entry in the struct wpa_supplicant::bss_hash bucket */
+	struct wpa_bss *hnext;
 	/** Unique identifier for this BSS entry */
 	unsigned int id;
 	/** Number of counts without seeing this BSS */
@@ -102,6 +106,31 @@ struct wpa_bss {
 	int snr;
 	/** ANQP data */
 	struct wpa_bss_anqp *anqp;
+#ifdef CONFIG_P2P
+	/** P2P Device Address from the P2P IE or all zeros if not found */
+	u8 p2p_dev_addr[ETH_ALEN];
+	/** Next entry in the struct wpa_supplicant::bss_p2p_hash bucket */
+	struct wpa_bss *p2p_hnext;
+#endif /* CONFIG_P2P */
+	/**
+	 * Offset + 1 of the first element with each Element ID in the first
+	 * ie_pos_len octets of the IE field (0 = not present); updated
+	 * whenever the IEs change
+	 */
+	u16 ie_pos[256];
+	/**
+	 * Length of the part of the IE field covered by ie_pos[]; shorter
+	 * than ie_len only if the offsets would not fit in ie_pos[]
+	 */
+	size_t ie_pos_len;
+	/** Whether the RSN element was found and parsed into rsn_ie */
+	unsigned int rsn_ie_parsed:1;
+	/** Whether the WPA element was found and parsed into wpa_ie */
+	unsigned int wpa_ie_parsed:1;
+	/** Parsed RSN element for network selection */
+	struct wpa_ie_data rsn_ie;
+	/** Parsed WPA element for network selection */
+	struct wpa_ie_data wpa_ie;
 	/** Length of the following IE field in octets (from Probe Response) */
 	size_t ie_len;
 	/** Length of the following Beacon IE field in octets */
@@ -14,6 +14,7 @@
 
 #include "utils/common.h"
 #include "utils/eloop.h"
+#include "utils/mem_pool.h"
 #include "utils/uuid.h"
 #include "utils/module_tests.h"
 #include "common/version.h"
@@ -9632,6 +9633,18 @@ char * wpa_supplicant_ctrl_iface_process(struct wpa_supplicant *wpa_s,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_MEM_POOL
+	} else if (os_strcmp(buf, "MEM_POOL_STATS") == 0) {
+		reply_len = mem_pool_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "MEM_POOL_STATS RESET") == 0) {
+		mem_pool_stats_reset();
+#endif /* CONFIG_MEM_POOL */
 	} else if (os_strncmp(buf, "NOTE ", 5) == 0) {
 		wpa_printf(MSG_INFO, "NOTE: %s", buf + 5);
 	} else if (os_strcmp(buf, "MIB") == 0) {
@@ -11097,6 +11110,18 @@ char * wpa_supplicant_global_ctrl_iface_process(struct wpa_global *global,
 	} else if (os_strncmp(buf, "RELOG", 5) == 0) {
 		if (wpa_debug_reopen_file() < 0)
 			reply_len = -1;
+#ifdef CONFIG_ELOOP_STATS
+	} else if (os_strcmp(buf, "ELOOP_STATS") == 0) {
+		reply_len = eloop_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "ELOOP_STATS RESET") == 0) {
+		eloop_stats_reset();
+#endif /* CONFIG_ELOOP_STATS */
+#ifdef CONFIG_MEM_POOL
+	} else if (os_strcmp(buf, "MEM_POOL_STATS") == 0) {
+		reply_len = mem_pool_stats_get(reply, reply_size);
+	} else if (os_strcmp(buf, "MEM_POOL_STATS RESET") == 0) {
+		mem_pool_stats_reset();
+#endif /* CONFIG_MEM_POOL */
 	} else {
 		os_memcpy(reply, "UNKNOWN COMMAND\n", 16);
 		reply_len = 16;
@@ -18,6 +18,7 @@
 #include "config.h"
 #include "eapol_supp/eapol_supp_sm.h"
 #include "eap_peer/eap.h"
+#include "eap_peer/eap_methods.h"
 #include "eap_server/eap_methods.h"
 #include "eloop.h"
 #include "utils/base64.h"
@@ -29,6 +30,7 @@
 #include "ctrl_iface.h"
 #include "pcsc_funcs.h"
 #include "wpas_glue.h"
+#include "utils/latency_stats.h"
 
 
 const struct wpa_driver_ops *const wpa_drivers[] = { NULL };
@@ -41,19 +43,34 @@ struct extra_radius_attr {
 	struct extra_radius_attr *next;
 };
 
-struct eapol_test_data {
-	struct wpa_supplicant *wpa_s;
+struct eapol_test_data;
 
-	int eapol_test_num_reauths;
-	int no_mppe_keys;
-	int num_mppe_ok, num_mppe_mismatch;
-	int req_eap_key_name;
+/*
+ * Maximum number of load test sessions sharing a RADIUS client; this matches
+ * the retransmit list limit (RADIUS_CLIENT_MAX_ENTRIES) in radius_client.c.
+ */
+#define EAPOL_TEST_LOAD_CLIENT_SESSIONS 30
+
+/* RADIUS client (socket and identifier space) shared by load test sessions */
+struct eapol_test_load_client {
+	struct eapol_test_load_client *next;
+	struct eapol_test_data *e;
+	struct radius_client_data *radius;
+	struct eapol_test_session *id_map[256];
+	unsigned int num_sessions;
+	u8 next_id;
+};
+
+/* State of a single EAP authentication through the RADIUS server */
+struct eapol_test_session {
+	struct dl_list list;
+	struct eapol_test_data *e;
+	struct eapol_sm *eapol;
+	struct radius_client_data *radius;
+	u8 own_addr[ETH_ALEN];
 
 	u8 radius_identifier;
 	struct radius_msg *last_recv_radius;
-	struct in_addr own_ip_addr;
-	struct radius_client_data *radius;
-	struct hostapd_radius_servers *radius_conf;
 
 	 /* last received EAP Response from Authentication Server */
 	struct wpabuf *last_eap_radius;
@@ -64,11 +81,60 @@ struct eapol_test_data {
 	size_t authenticator_eap_key_name_len;
 	int radius_access_accept_received;
 	int radius_access_reject_received;
-	int auth_timed_out;
 
 	u8 *eap_identity;
 	size_t eap_identity_len;
 
+	/* Load test mode */
+	struct eapol_test_load_client *client;
+	struct wpa_ssid *ssid;
+	struct os_reltime start, req_sent;
+	int id_in_use;
+	int done;
+};
+
+struct eapol_test_method_stats {
+	struct eapol_test_method_stats *next;
+	char name[32];
+	unsigned int ok, failed;
+	struct latency_samples latency;
+};
+
+struct eapol_test_load {
+	unsigned int num_sessions; /* 0 = load test mode not used */
+	unsigned int max_active;
+	unsigned int rate; /* new sessions per second, 0 = no limit */
+	int timeout;
+
+	unsigned int started, active, finished;
+	unsigned int ok, failed, timed_out;
+	struct os_reltime start, end;
+
+	struct wpa_ssid *next_ssid;
+	struct eapol_test_load_client *clients;
+	struct dl_list sessions;
+
+	struct latency_samples rtt;
+	struct eapol_test_method_stats *methods;
+};
+
+struct eapol_test_data {
+	struct wpa_supplicant *wpa_s;
+
+	int eapol_test_num_reauths;
+	int no_mppe_keys;
+	int num_mppe_ok, num_mppe_mismatch;
+	int req_eap_key_name;
+
+	struct in_addr own_ip_addr;
+	struct radius_client_data *radius;
+	struct hostapd_radius_servers *radius_conf;
+
+	struct eapol_test_session sess;
+	int auth_timed_out;
+
+	struct eapol_test_load load;
+
 	char *connect_info;
 	u8 own_addr[ETH_ALEN];
 	struct extra_radius_attr *extra_attrs;
@@ -174,9 +240,42 @@ find_extra_attr(struct extra_radius_attr *attrs, u8 type)
 }
 
 
-static void ieee802_1x_encapsulate_radius(struct eapol_test_data *e,
+static u8 eapol_test_load_get_id(struct eapol_test_session *s)
+{
+	struct eapol_test_load_client *client = s->client;
+	unsigned int i;
+	u8 id = client->next_id;
+
+	/*
+	 * Each session has at most one pending request, so a free identifier
+	 * is always available. Rotate through the identifier space to avoid
+	 * reusing a recently released identifier.
+	 */
+	for (i = 0; i < 256; i++) {
+		id = client->next_id++;
+		if (!client->id_map[id])
+			break;
+	}
+	client->id_map[id] = s;
+	s->id_in_use = 1;
+	return id;
+}
+
+
+static void eapol_test_load_put_id(struct eapol_test_session *s)
+{
+	if (!s->id_in_use)
+		return;
+	if (s->client->id_map[s->radius_identifier] == s)
+		s->client->id_map[s->radius_identifier] = NULL;
+	s->id_in_use = 0;
+}
+
+
+static void ieee802_1x_encapsulate_radius(struct eapol_test_session *s,
 					  const u8 *eap, size_t len)
 {
+	struct eapol_test_data *e = s->e;
 	struct radius_msg *msg;
 	char buf[RADIUS_MAX_ATTR_LEN + 1];
 	const struct eap_hdr *hdr;
@@ -185,9 +284,14 @@ static void ieee802_1x_encapsulate_radius(struct eapol_test_data *e,
 	wpa_printf(MSG_DEBUG, "Encapsulating EAP message into a RADIUS "
 		   "packet");
 
-	e->radius_identifier = radius_client_get_id(e->radius);
-	msg = radius_msg_new(RADIUS_CODE_ACCESS_REQUEST,
-			     e->radius_identifier);
+	if (s->client)
+		s->radius_identifier = eapol_test_load_get_id(s);
+	else
+		s->radius_identifier = radius_client_get_id(s->radius);
+	msg = radius_msg_new_len(RADIUS_CODE_ACCESS_REQUEST,
+				 s->radius_identifier,
+				 RADIUS_EAP_ATTR_ESTIMATE +
+				 radius_msg_eap_len(len));
 	if (msg == NULL) {
 		printf("Could not create net RADIUS packet\n");
 		return;
@@ -200,20 +304,20 @@ static void ieee802_1x_encapsulate_radius(struct eapol_test_data *e,
 	if (len > sizeof(*hdr) && hdr->code == EAP_CODE_RESPONSE &&
 	    pos[0] == EAP_TYPE_IDENTITY) {
 		pos++;
-		os_free(e->eap_identity);
-		e->eap_identity_len = len - sizeof(*hdr) - 1;
-		e->eap_identity = os_malloc(e->eap_identity_len);
-		if (e->eap_identity) {
-			os_memcpy(e->eap_identity, pos, e->eap_identity_len);
+		os_free(s->eap_identity);
+		s->eap_identity_len = len - sizeof(*hdr) - 1;
+		s->eap_identity = os_malloc(s->eap_identity_len);
+		if (s->eap_identity) {
+			os_memcpy(s->eap_identity, pos, s->eap_identity_len);
 			wpa_hexdump(MSG_DEBUG, "Learned identity from "
 				    "EAP-Response-Identity",
-				    e->eap_identity, e->eap_identity_len);
+				    s->eap_identity, s->eap_identity_len);
 		}
 	}
 
-	if (e->eap_identity &&
+	if (s->eap_identity &&
 	    !radius_msg_add_attr(msg, RADIUS_ATTR_USER_NAME,
-				 e->eap_identity, e->eap_identity_len)) {
+				 s->eap_identity, s->eap_identity_len)) {
 		printf("Could not add User-Name\n");
 		goto fail;
 	}
@@ -233,7 +337,7 @@ static void ieee802_1x_encapsulate_radius(struct eapol_test_data *e,
 	}
 
 	os_snprintf(buf, sizeof(buf), RADIUS_802_1X_ADDR_FORMAT,
-		    MAC2STR(e->wpa_s->own_addr));
+		    MAC2STR(s->own_addr));
 	if (!find_extra_attr(e->extra_attrs, RADIUS_ATTR_CALLING_STATION_ID)
 	    &&
 	    !radius_msg_add_attr(msg, RADIUS_ATTR_CALLING_STATION_ID,
@@ -283,10 +387,10 @@ static void ieee802_1x_encapsulate_radius(struct eapol_test_data *e,
 
 	/* State attribute must be copied if and only if this packet is
 	 * Access-Request reply to the previous Access-Challenge */
-	if (e->last_recv_radius &&
-	    radius_msg_get_hdr(e->last_recv_radius)->code ==
+	if (s->last_recv_radius &&
+	    radius_msg_get_hdr(s->last_recv_radius)->code ==
 	    RADIUS_CODE_ACCESS_CHALLENGE) {
-		int res = radius_msg_copy_attr(msg, e->last_recv_radius,
+		int res = radius_msg_copy_attr(msg, s->last_recv_radius,
 					       RADIUS_ATTR_STATE);
 		if (res < 0) {
 			printf("Could not copy State attribute from previous "
@@ -299,8 +403,8 @@ static void ieee802_1x_encapsulate_radius(struct eapol_test_data *e,
 		}
 	}
 
-	if (radius_client_send(e->radius, msg, RADIUS_AUTH, e->wpa_s->own_addr)
-	    < 0)
+	os_get_reltime(&s->req_sent);
+	if (radius_client_send(s->radius, msg, RADIUS_AUTH, s->own_addr) < 0)
 		goto fail;
 	return;
 
@@ -312,11 +416,16 @@ static void ieee802_1x_encapsulate_radius(struct eapol_test_data *e,
 static int eapol_test_eapol_send(void *ctx, int type, const u8 *buf,
 				 size_t len)
 {
-	printf("WPA: eapol_test_eapol_send(type=%d len=%lu)\n",
-	       type, (unsigned long) len);
+	struct eapol_test_session *s = ctx;
+
+	if (s->done)
+		return 0;
+	if (!s->client)
+		printf("WPA: eapol_test_eapol_send(type=%d len=%lu)\n",
+		       type, (unsigned long) len);
 	if (type == IEEE802_1X_TYPE_EAP_PACKET) {
 		wpa_hexdump(MSG_DEBUG, "TX EAP -> RADIUS", buf, len);
-		ieee802_1x_encapsulate_radius(&eapol_test, buf, len);
+		ieee802_1x_encapsulate_radius(s, buf, len);
 	}
 	return 0;
 }
@@ -352,36 +461,37 @@ static void eapol_sm_reauth(void *eloop_ctx, void *timeout_ctx)
 {
 	struct eapol_test_data *e = eloop_ctx;
 	printf("\n\n\n\n\neapol_test: Triggering EAP reauthentication\n\n");
-	e->radius_access_accept_received = 0;
+	e->sess.radius_access_accept_received = 0;
 	send_eap_request_identity(e->wpa_s, NULL);
 }
 
 
-static int eapol_test_compare_pmk(struct eapol_test_data *e)
+static int eapol_test_compare_pmk(struct eapol_test_session *s)
 {
+	struct eapol_test_data *e = s->e;
 	u8 pmk[PMK_LEN];
 	int ret = 1;
 	const u8 *sess_id;
 	size_t sess_id_len;
 
-	if (eapol_sm_get_key(e->wpa_s->eapol, pmk, PMK_LEN) == 0) {
+	if (eapol_sm_get_key(s->eapol, pmk, PMK_LEN) == 0) {
 		wpa_hexdump(MSG_DEBUG, "PMK from EAPOL", pmk, PMK_LEN);
-		if (os_memcmp(pmk, e->authenticator_pmk, PMK_LEN) != 0) {
+		if (os_memcmp(pmk, s->authenticator_pmk, PMK_LEN) != 0) {
 			printf("WARNING: PMK mismatch\n");
 			wpa_hexdump(MSG_DEBUG, "PMK from AS",
-				    e->authenticator_pmk, PMK_LEN);
-		} else if (e->radius_access_accept_received)
+				    s->authenticator_pmk, PMK_LEN);
+		} else if (s->radius_access_accept_received)
 			ret = 0;
-	} else if (e->authenticator_pmk_len == 16 &&
-		   eapol_sm_get_key(e->wpa_s->eapol, pmk, 16) == 0) {
+	} else if (s->authenticator_pmk_len == 16 &&
+		   eapol_sm_get_key(s->eapol, pmk, 16) == 0) {
 		wpa_hexdump(MSG_DEBUG, "LEAP PMK from EAPOL", pmk, 16);
-		if (os_memcmp(pmk, e->authenticator_pmk, 16) != 0) {
+		if (os_memcmp(pmk, s->authenticator_pmk, 16) != 0) {
 			printf("WARNING: PMK mismatch\n");
 			wpa_hexdump(MSG_DEBUG, "PMK from AS",
-				    e->authenticator_pmk, 16);
-		} else if (e->radius_access_accept_received)
+				    s->authenticator_pmk, 16);
+		} else if (s->radius_access_accept_received)
 			ret = 0;
-	} else if (e->radius_access_accept_received && e->no_mppe_keys) {
+	} else if (s->radius_access_accept_received && e->no_mppe_keys) {
 		/* No keying material expected */
 		ret = 0;
 	}
@@ -391,23 +501,23 @@ static int eapol_test_compare_pmk(struct eapol_test_data *e)
 	else if (!e->no_mppe_keys)
 		e->num_mppe_ok++;
 
-	sess_id = eapol_sm_get_session_id(e->wpa_s->eapol, &sess_id_len);
+	sess_id = eapol_sm_get_session_id(s->eapol, &sess_id_len);
 	if (!sess_id)
 		return ret;
-	if (e->authenticator_eap_key_name_len == 0) {
+	if (s->authenticator_eap_key_name_len == 0) {
 		wpa_printf(MSG_INFO, "No EAP-Key-Name received from server");
 		return ret;
 	}
 
-	if (e->authenticator_eap_key_name_len != sess_id_len ||
-	    os_memcmp(e->authenticator_eap_key_name, sess_id, sess_id_len) != 0)
+	if (s->authenticator_eap_key_name_len != sess_id_len ||
+	    os_memcmp(s->authenticator_eap_key_name, sess_id, sess_id_len) != 0)
 	{
 		wpa_printf(MSG_INFO,
 			   "Locally derived EAP Session-Id does not match EAP-Key-Name from server");
 		wpa_hexdump(MSG_DEBUG, "EAP Session-Id", sess_id, sess_id_len);
 		wpa_hexdump(MSG_DEBUG, "EAP-Key-Name from server",
-			    e->authenticator_eap_key_name,
-			    e->authenticator_eap_key_name_len);
+			    s->authenticator_eap_key_name,
+			    s->authenticator_eap_key_name_len);
 	} else {
 		wpa_printf(MSG_INFO,
 			   "Locally derived EAP Session-Id matches EAP-Key-Name from server");
@@ -429,7 +539,7 @@ static void eapol_sm_cb(struct eapol_sm *eapol, enum eapol_supp_result result,
 	if (e->eapol_test_num_reauths < 0)
 		eloop_terminate();
 	else {
-		eapol_test_compare_pmk(e);
+		eapol_test_compare_pmk(&e->sess);
 		eloop_register_timeout(0, 100000, eapol_sm_reauth, e, NULL);
 	}
 }
@@ -596,7 +706,7 @@ static int test_eapol(struct eapol_test_data *e, struct wpa_supplicant *wpa_s,
 	ctx->scard_ctx = wpa_s->scard;
 	ctx->cb = eapol_sm_cb;
 	ctx->cb_ctx = e;
-	ctx->eapol_send_ctx = wpa_s;
+	ctx->eapol_send_ctx = &e->sess;
 	ctx->preauth = 0;
 	ctx->eapol_done_cb = eapol_test_eapol_done_cb;
 	ctx->eapol_send = eapol_test_eapol_send;
@@ -617,6 +727,7 @@ static int test_eapol(struct eapol_test_data *e, struct wpa_supplicant *wpa_s,
 		printf("Failed to initialize EAPOL state machines.\n");
 		return -1;
 	}
+	e->sess.eapol = wpa_s->eapol;
 
 	wpa_s->key_mgmt = WPA_KEY_MGMT_IEEE8021X_NO_WPA;
 	wctx = os_zalloc(sizeof(*wctx));
@@ -664,13 +775,14 @@ static void test_eapol_clean(struct eapol_test_data *e,
 	wpa_sm_deinit(wpa_s->wpa);
 	wpa_s->wpa = NULL;
 	radius_client_deinit(e->radius);
-	wpabuf_free(e->last_eap_radius);
-	radius_msg_free(e->last_recv_radius);
-	e->last_recv_radius = NULL;
-	os_free(e->eap_identity);
-	e->eap_identity = NULL;
+	wpabuf_free(e->sess.last_eap_radius);
+	radius_msg_free(e->sess.last_recv_radius);
+	e->sess.last_recv_radius = NULL;
+	os_free(e->sess.eap_identity);
+	e->sess.eap_identity = NULL;
 	eapol_sm_deinit(wpa_s->eapol);
 	wpa_s->eapol = NULL;
+	e->sess.eapol = NULL;
 	if (e->radius_conf && e->radius_conf->auth_server) {
 		os_free(e->radius_conf->auth_server->shared_secret);
 		os_free(e->radius_conf->auth_server);
@@ -697,9 +809,9 @@ static void test_eapol_clean(struct eapol_test_data *e,
 }
 
 
-static void send_eap_request_identity(void *eloop_ctx, void *timeout_ctx)
+static void eapol_test_rx_eap_request_identity(struct eapol_sm *eapol,
+					       const u8 *src)
 {
-	struct wpa_supplicant *wpa_s = eloop_ctx;
 	u8 buf[100], *pos;
 	struct ieee802_1x_hdr *hdr;
 	struct eap_hdr *eap;
@@ -716,9 +828,16 @@ static void send_eap_request_identity(void *eloop_ctx, void *timeout_ctx)
 	pos = (u8 *) (eap + 1);
 	*pos = EAP_TYPE_IDENTITY;
 
+	eapol_sm_rx_eapol(eapol, src, buf, sizeof(*hdr) + 5);
+}
+
+
+static void send_eap_request_identity(void *eloop_ctx, void *timeout_ctx)
+{
+	struct wpa_supplicant *wpa_s = eloop_ctx;
+
 	printf("Sending fake EAP-Request-Identity\n");
-	eapol_sm_rx_eapol(wpa_s->eapol, wpa_s->bssid, buf,
-			  sizeof(*hdr) + 5);
+	eapol_test_rx_eap_request_identity(wpa_s->eapol, wpa_s->bssid);
 }
 
 
@@ -752,7 +871,7 @@ static char *eap_type_text(u8 type)
 }
 
 
-static void ieee802_1x_decapsulate_radius(struct eapol_test_data *e)
+static void ieee802_1x_decapsulate_radius(struct eapol_test_session *s)
 {
 	struct wpabuf *eap;
 	const struct eap_hdr *hdr;
@@ -760,10 +879,10 @@ static void ieee802_1x_decapsulate_radius(struct eapol_test_data *e)
 	char buf[64];
 	struct radius_msg *msg;
 
-	if (e->last_recv_radius == NULL)
+	if (s->last_recv_radius == NULL)
 		return;
 
-	msg = e->last_recv_radius;
+	msg = s->last_recv_radius;
 
 	eap = radius_msg_get_eap(msg);
 	if (eap == NULL) {
@@ -772,8 +891,8 @@ static void ieee802_1x_decapsulate_radius(struct eapol_test_data *e)
 		 * attribute */
 		wpa_printf(MSG_DEBUG, "could not extract "
 			       "EAP-Message from RADIUS message");
-		wpabuf_free(e->last_eap_radius);
-		e->last_eap_radius = NULL;
+		wpabuf_free(s->last_eap_radius);
+		s->last_eap_radius = NULL;
 		return;
 	}
 
@@ -806,7 +925,7 @@ static void ieee802_1x_decapsulate_radius(struct eapol_test_data *e)
 		break;
 	case EAP_CODE_FAILURE:
 		os_strlcpy(buf, "EAP Failure", sizeof(buf));
-		if (e->ctrl_iface)
+		if (s->e->ctrl_iface || s->client)
 			break;
 		eloop_terminate();
 		break;
@@ -821,8 +940,8 @@ static void ieee802_1x_decapsulate_radius(struct eapol_test_data *e)
 
 	/* sta->eapol_sm->be_auth.idFromServer = hdr->identifier; */
 
-	wpabuf_free(e->last_eap_radius);
-	e->last_eap_radius = eap;
+	wpabuf_free(s->last_eap_radius);
+	s->last_eap_radius = eap;
 
 	{
 		struct ieee802_1x_hdr *dot1x;
@@ -833,7 +952,7 @@ static void ieee802_1x_decapsulate_radius(struct eapol_test_data *e)
 		dot1x->length = htons(wpabuf_len(eap));
 		os_memcpy((u8 *) (dot1x + 1), wpabuf_head(eap),
 			  wpabuf_len(eap));
-		eapol_sm_rx_eapol(e->wpa_s->eapol, e->wpa_s->bssid,
+		eapol_sm_rx_eapol(s->eapol, s->e->wpa_s->bssid,
 				  (u8 *) dot1x,
 				  sizeof(*dot1x) + wpabuf_len(eap));
 		os_free(dot1x);
@@ -841,7 +960,7 @@ static void ieee802_1x_decapsulate_radius(struct eapol_test_data *e)
 }
 
 
-static void ieee802_1x_get_keys(struct eapol_test_data *e,
+static void ieee802_1x_get_keys(struct eapol_test_session *s,
 				struct radius_msg *msg, struct radius_msg *req,
 				const u8 *shared_secret,
 				size_t shared_secret_len)
@@ -866,20 +985,20 @@ static void ieee802_1x_get_keys(struct eapol_test_data *e,
 		if (keys->recv) {
 			wpa_hexdump(MSG_DEBUG, "MS-MPPE-Recv-Key (crypt)",
 				    keys->recv, keys->recv_len);
-			e->authenticator_pmk_len =
+			s->authenticator_pmk_len =
 				keys->recv_len > PMK_LEN ? PMK_LEN :
 				keys->recv_len;
-			os_memcpy(e->authenticator_pmk, keys->recv,
-				  e->authenticator_pmk_len);
-			if (e->authenticator_pmk_len == 16 && keys->send &&
+			os_memcpy(s->authenticator_pmk, keys->recv,
+				  s->authenticator_pmk_len);
+			if (s->authenticator_pmk_len == 16 && keys->send &&
 			    keys->send_len == 16) {
 				/* MS-CHAP-v2 derives 16 octet keys */
 				wpa_printf(MSG_DEBUG, "Use MS-MPPE-Send-Key "
 					   "to extend PMK to 32 octets");
-				os_memcpy(e->authenticator_pmk +
-					  e->authenticator_pmk_len,
+				os_memcpy(s->authenticator_pmk +
+					  s->authenticator_pmk_len,
 					  keys->send, keys->send_len);
-				e->authenticator_pmk_len += keys->send_len;
+				s->authenticator_pmk_len += keys->send_len;
 			}
 		}
 
@@ -890,10 +1009,10 @@ static void ieee802_1x_get_keys(struct eapol_test_data *e,
 
 	if (radius_msg_get_attr_ptr(msg, RADIUS_ATTR_EAP_KEY_NAME, &buf, &len,
 				    NULL) == 0) {
-		os_memcpy(e->authenticator_eap_key_name, buf, len);
-		e->authenticator_eap_key_name_len = len;
+		os_memcpy(s->authenticator_eap_key_name, buf, len);
+		s->authenticator_eap_key_name_len = len;
 	} else {
-		e->authenticator_eap_key_name_len = 0;
+		s->authenticator_eap_key_name_len = 0;
 	}
 }
 
@@ -904,7 +1023,7 @@ ieee802_1x_receive_auth(struct radius_msg *msg, struct radius_msg *req,
 			const u8 *shared_secret, size_t shared_secret_len,
 			void *data)
 {
-	struct eapol_test_data *e = data;
+	struct eapol_test_session *s = data;
 	struct radius_hdr *hdr = radius_msg_get_hdr(msg);
 
 	/* RFC 2869, Ch. 5.13: valid Message-Authenticator attribute MUST be
@@ -930,29 +1049,33 @@ ieee802_1x_receive_auth(struct radius_msg *msg, struct radius_msg *req,
 		return RADIUS_RX_UNKNOWN;
 	}
 
-	e->radius_identifier = -1;
+	/* msg is kept after returning; copy it out of the receive buffer */
+	if (radius_msg_own_buf(msg) < 0)
+		return RADIUS_RX_UNKNOWN;
+
+	s->radius_identifier = -1;
 	wpa_printf(MSG_DEBUG, "RADIUS packet matching with station");
 
-	radius_msg_free(e->last_recv_radius);
-	e->last_recv_radius = msg;
+	radius_msg_free(s->last_recv_radius);
+	s->last_recv_radius = msg;
 
 	switch (hdr->code) {
 	case RADIUS_CODE_ACCESS_ACCEPT:
-		e->radius_access_accept_received = 1;
-		ieee802_1x_get_keys(e, msg, req, shared_secret,
+		s->radius_access_accept_received = 1;
+		ieee802_1x_get_keys(s, msg, req, shared_secret,
 				    shared_secret_len);
 		break;
 	case RADIUS_CODE_ACCESS_REJECT:
-		e->radius_access_reject_received = 1;
+		s->radius_access_reject_received = 1;
 		break;
 	}
 
-	ieee802_1x_decapsulate_radius(e);
+	ieee802_1x_decapsulate_radius(s);
 
 	if ((hdr->code == RADIUS_CODE_ACCESS_ACCEPT &&
-	     e->eapol_test_num_reauths < 0) ||
+	     s->e->eapol_test_num_reauths < 0) ||
 	    hdr->code == RADIUS_CODE_ACCESS_REJECT) {
-		if (!e->ctrl_iface)
+		if (!s->e->ctrl_iface && !s->client)
 			eloop_terminate();
 	}
 
@@ -960,6 +1083,384 @@ ieee802_1x_receive_auth(struct radius_msg *msg, struct radius_msg *req,
 }
 
 
+static struct eapol_test_method_stats *
+eapol_test_load_method(struct eapol_test_load *load, const char *name)
+{
+	struct eapol_test_method_stats *m;
+
+	for (m = load->methods; m; m = m->next) {
+		if (os_strcmp(m->name, name) == 0)
+			return m;
+	}
+
+	m = os_zalloc(sizeof(*m));
+	if (!m)
+		return NULL;
+	os_strlcpy(m->name, name, sizeof(m->name));
+	m->next = load->methods;
+	load->methods = m;
+	return m;
+}
+
+
+static void eapol_test_load_session_timeout(void *eloop_ctx,
+					    void *timeout_ctx);
+static void eapol_test_load_session_free_cb(void *eloop_ctx,
+					    void *timeout_ctx);
+
+
+static void eapol_test_load_session_free(struct eapol_test_session *s)
+{
+	eloop_cancel_timeout(eapol_test_load_session_timeout, ELOOP_ALL_CTX, s);
+	eloop_cancel_timeout(eapol_test_load_session_free_cb, ELOOP_ALL_CTX, s);
+	dl_list_del(&s->list);
+	if (!s->done) {
+		eapol_test_load_put_id(s);
+		radius_client_flush_auth(s->radius, s->own_addr);
+		s->client->num_sessions--;
+		s->e->load.active--;
+	}
+	eapol_sm_deinit(s->eapol);
+	wpabuf_free(s->last_eap_radius);
+	radius_msg_free(s->last_recv_radius);
+	os_free(s->eap_identity);
+	os_free(s);
+}
+
+
+static void eapol_test_load_session_free_cb(void *eloop_ctx,
+					    void *timeout_ctx)
+{
+	eapol_test_load_session_free(timeout_ctx);
+}
+
+
+static void eapol_test_load_fill(struct eapol_test_data *e);
+
+
+static void eapol_test_load_finish(struct eapol_test_session *s, int ok,
+				   int timed_out)
+{
+	struct eapol_test_data *e = s->e;
+	struct eapol_test_load *load = &e->load;
+	struct eapol_test_method_stats *m;
+	const char *name = NULL;
+
+	if (s->done)
+		return;
+	s->done = 1;
+
+	eapol_test_load_put_id(s);
+	radius_client_flush_auth(s->radius, s->own_addr);
+	s->client->num_sessions--;
+
+	if (ok && s->radius_access_accept_received) {
+		if (eapol_test_compare_pmk(s) != 0)
+			ok = 0;
+		name = eapol_sm_get_method_name(s->eapol);
+	} else {
+		ok = 0;
+	}
+	if (!name && s->ssid->eap.eap_methods)
+		name = eap_get_name(s->ssid->eap.eap_methods[0].vendor,
+				    s->ssid->eap.eap_methods[0].method);
+
+	m = eapol_test_load_method(load, name ? name : "UNKNOWN");
+	if (m && ok) {
+		m->ok++;
+		latency_samples_add_age(&m->latency, &s->start);
+	} else if (m) {
+		m->failed++;
+	}
+
+	if (ok)
+		load->ok++;
+	else if (timed_out)
+		load->timed_out++;
+	else
+		load->failed++;
+	load->active--;
+	load->finished++;
+
+	/* The EAPOL state machine may still be in use by the caller */
+	eloop_cancel_timeout(eapol_test_load_session_timeout, ELOOP_ALL_CTX, s);
+	eloop_register_timeout(0, 0, eapol_test_load_session_free_cb, e, s);
+
+	if (load->finished == load->num_sessions) {
+		os_get_reltime(&load->end);
+		eloop_terminate();
+		return;
+	}
+	eapol_test_load_fill(e);
+}
+
+
+static void eapol_test_load_session_timeout(void *eloop_ctx,
+					    void *timeout_ctx)
+{
+	struct eapol_test_session *s = timeout_ctx;
+
+	wpa_printf(MSG_INFO, "Load test session " MACSTR " timed out",
+		   MAC2STR(s->own_addr));
+	eapol_test_load_finish(s, 0, 1);
+}
+
+
+static void eapol_test_load_sm_cb(struct eapol_sm *eapol,
+				  enum eapol_supp_result result, void *ctx)
+{
+	eapol_test_load_finish(ctx, result == EAPOL_SUPP_RESULT_SUCCESS, 0);
+}
+
+
+static RadiusRxResult
+eapol_test_load_receive(struct radius_msg *msg, struct radius_msg *req,
+			const u8 *shared_secret, size_t shared_secret_len,
+			void *data)
+{
+	struct eapol_test_load_client *client = data;
+	struct radius_hdr *hdr = radius_msg_get_hdr(msg);
+	struct eapol_test_session *s = client->id_map[hdr->identifier];
+	struct os_reltime sent;
+	u8 code = hdr->code;
+	RadiusRxResult res;
+
+	if (!s)
+		return RADIUS_RX_UNKNOWN;
+
+	/* A new request may be sent (and timed) while processing this one */
+	sent = s->req_sent;
+	eapol_test_load_put_id(s);
+	res = ieee802_1x_receive_auth(msg, req, shared_secret,
+				      shared_secret_len, s);
+	if (res == RADIUS_RX_UNKNOWN) {
+		/* Keep waiting for a valid response */
+		client->id_map[hdr->identifier] = s;
+		s->id_in_use = 1;
+		return res;
+	}
+
+	latency_samples_add_age(&client->e->load.rtt, &sent);
+	if (code == RADIUS_CODE_ACCESS_REJECT)
+		eapol_test_load_finish(s, 0, 0);
+
+	return res;
+}
+
+
+static struct eapol_test_load_client *
+eapol_test_load_get_client(struct eapol_test_data *e)
+{
+	struct eapol_test_load_client *client;
+
+	for (client = e->load.clients; client; client = client->next) {
+		if (client->num_sessions < EAPOL_TEST_LOAD_CLIENT_SESSIONS)
+			return client;
+	}
+
+	client = os_zalloc(sizeof(*client));
+	if (!client)
+		return NULL;
+	client->e = e;
+	client->radius = radius_client_init(e->wpa_s, e->radius_conf);
+	if (!client->radius ||
+	    radius_client_register(client->radius, RADIUS_AUTH,
+				   eapol_test_load_receive, client) < 0) {
+		radius_client_deinit(client->radius);
+		os_free(client);
+		return NULL;
+	}
+	client->next = e->load.clients;
+	e->load.clients = client;
+
+	return client;
+}
+
+
+static int eapol_test_load_start(struct eapol_test_data *e)
+{
+	struct eapol_test_load *load = &e->load;
+	struct wpa_supplicant *wpa_s = e->wpa_s;
+	struct eapol_test_session *s;
+	struct eapol_ctx *ctx;
+	struct eapol_config eapol_conf;
+	unsigned int addr;
+
+	s = os_zalloc(sizeof(*s));
+	ctx = os_zalloc(sizeof(*ctx));
+	if (!s || !ctx) {
+		os_free(s);
+		os_free(ctx);
+		return -1;
+	}
+	s->client = eapol_test_load_get_client(e);
+	if (!s->client) {
+		wpa_printf(MSG_ERROR, "Failed to initialize RADIUS client");
+		os_free(s);
+		os_free(ctx);
+		return -1;
+	}
+	s->e = e;
+	s->radius = s->client->radius;
+
+	/* Use a unique Calling-Station-Id for each session */
+	os_memcpy(s->own_addr, e->own_addr, ETH_ALEN);
+	addr = WPA_GET_BE24(&s->own_addr[3]) + load->started;
+	WPA_PUT_BE24(&s->own_addr[3], addr);
+
+	/* Each network block is a separate set of credentials */
+	s->ssid = load->next_ssid ? load->next_ssid : wpa_s->conf->ssid;
+	load->next_ssid = s->ssid->next;
+
+	ctx->ctx = e;
+	ctx->msg_ctx = wpa_s;
+	ctx->cb = eapol_test_load_sm_cb;
+	ctx->cb_ctx = s;
+	ctx->eapol_send_ctx = s;
+	ctx->eapol_send = eapol_test_eapol_send;
+	ctx->set_config_blob = eapol_test_set_config_blob;
+	ctx->get_config_blob = eapol_test_get_config_blob;
+	ctx->opensc_engine_path = wpa_s->conf->opensc_engine_path;
+	ctx->pkcs11_engine_path = wpa_s->conf->pkcs11_engine_path;
+	ctx->pkcs11_module_path = wpa_s->conf->pkcs11_module_path;
+	ctx->openssl_ciphers = wpa_s->conf->openssl_ciphers;
+
+	s->eapol = eapol_sm_init(ctx);
+	if (!s->eapol) {
+		wpa_printf(MSG_ERROR,
+			   "Failed to initialize EAPOL state machines");
+		os_free(ctx);
+		os_free(s);
+		return -1;
+	}
+
+	dl_list_add_tail(&load->sessions, &s->list);
+	s->client->num_sessions++;
+	load->started++;
+	load->active++;
+	os_get_reltime(&s->start);
+	eloop_register_timeout(load->timeout, 0,
+			       eapol_test_load_session_timeout, e, s);
+
+	os_memset(&eapol_conf, 0, sizeof(eapol_conf));
+	eapol_conf.accept_802_1x_keys = 1;
+	eapol_conf.fast_reauth = wpa_s->conf->fast_reauth;
+	eapol_conf.workaround = s->ssid->eap_workaround;
+	eapol_sm_notify_config(s->eapol, &s->ssid->eap, &eapol_conf);
+	eapol_sm_notify_portValid(s->eapol, FALSE);
+	eapol_sm_notify_portEnabled(s->eapol, TRUE);
+
+	eapol_test_rx_eap_request_identity(s->eapol, wpa_s->bssid);
+
+	return 0;
+}
+
+
+static void eapol_test_load_fill(struct eapol_test_data *e)
+{
+	struct eapol_test_load *load = &e->load;
+	unsigned int target = load->num_sessions;
+	struct os_reltime now, diff;
+	u64 arrived;
+
+	if (load->rate) {
+		os_get_reltime(&now);
+		os_reltime_sub(&now, &load->start, &diff);
+		arrived = (u64) load->rate *
+			(diff.sec * 1000000ULL + diff.usec) / 1000000 + 1;
+		if (arrived < target)
+			target = arrived;
+	}
+
+	while (load->started < target && load->active < load->max_active) {
+		if (eapol_test_load_start(e) < 0) {
+			eloop_terminate();
+			return;
+		}
+	}
+}
+
+
+static void eapol_test_load_tick(void *eloop_ctx, void *timeout_ctx)
+{
+	struct eapol_test_data *e = eloop_ctx;
+
+	eapol_test_load_fill(e);
+	if (e->load.rate && e->load.started < e->load.num_sessions)
+		eloop_register_timeout(0, 10000, eapol_test_load_tick, e,
+				       NULL);
+}
+
+
+static void eapol_test_load_report(struct eapol_test_data *e)
+{
+	struct eapol_test_load *load = &e->load;
+	struct hostapd_radius_server *as = e->radius_conf->auth_server;
+	struct eapol_test_method_stats *m;
+	struct os_reltime diff;
+	double secs;
+
+	if (!load->end.sec)
+		os_get_reltime(&load->end);
+	os_reltime_sub(&load->end, &load->start, &diff);
+	secs = diff.sec + diff.usec / 1000000.0;
+
+	printf("Sessions: %u started, %u finished: %u success, %u failure, %u timeout\n",
+	       load->started, load->finished, load->ok, load->failed,
+	       load->timed_out);
+	printf("Success rate: %.2f%%  duration: %.3f s  rate: %.1f auth/s\n",
+	       load->finished ? 100.0 * load->ok / load->finished : 0.0,
+	       secs, secs > 0 ? load->finished / secs : 0.0);
+	printf("RADIUS: %u requests, %u retransmissions, %u timeouts, %u accepts, %u rejects, %u challenges, %u bad authenticators, %u malformed\n",
+	       as->requests, as->retransmissions, as->timeouts,
+	       as->access_accepts, as->access_rejects, as->access_challenges,
+	       as->bad_authenticators, as->malformed_responses);
+	latency_samples_print("RADIUS round trip", &load->rtt);
+
+	for (m = load->methods; m; m = m->next) {
+		char title[50];
+
+		printf("EAP-%s: %u success, %u failure\n",
+		       m->name, m->ok, m->failed);
+		os_snprintf(title, sizeof(title), "EAP-%s latency", m->name);
+		latency_samples_print(title, &m->latency);
+	}
+}
+
+
+static void eapol_test_load_deinit(struct eapol_test_data *e)
+{
+	struct eapol_test_load *load = &e->load;
+	struct eapol_test_session *s, *n;
+	struct eapol_test_load_client *client, *prev_client;
+	struct eapol_test_method_stats *m, *prev_m;
+
+	eloop_cancel_timeout(eapol_test_load_tick, e, NULL);
+	dl_list_for_each_safe(s, n, &load->sessions, struct eapol_test_session,
+			      list)
+		eapol_test_load_session_free(s);
+
+	client = load->clients;
+	while (client) {
+		prev_client = client;
+		client = client->next;
+		radius_client_deinit(prev_client->radius);
+		os_free(prev_client);
+	}
+	load->clients = NULL;
+
+	m = load->methods;
+	while (m) {
+		prev_m = m;
+		m = m->next;
+		latency_samples_free(&prev_m->latency);
+		os_free(prev_m);
+	}
+	load->methods = NULL;
+	latency_samples_free(&load->rtt);
+}
+
+
 static int driver_get_ssid(void *priv, u8 *ssid)
 {
 	ssid[0] = 0;
@@ -1057,8 +1558,12 @@ static void wpa_init_conf(struct eapol_test_data *e,
 	assert(e->radius != NULL);
 
 	res = radius_client_register(e->radius, RADIUS_AUTH,
-				     ieee802_1x_receive_auth, e);
+				     ieee802_1x_receive_auth, &e->sess);
 	assert(res == 0);
+
+	e->sess.e = e;
+	e->sess.radius = e->radius;
+	os_memcpy(e->sess.own_addr, e->own_addr, ETH_ALEN);
 }
 
 
@@ -1253,7 +1758,8 @@ static void usage(void)
 	       "           [-M<client MAC address>] [-o<server cert file] \\\n"
 	       "           [-N<attr spec>] [-R<PC/SC reader>] "
 	       "[-P<PC/SC PIN>] \\\n"
-	       "           [-A<client IP>] [-i<ifname>] [-T<ctrl_iface>]\n"
+	       "           [-A<client IP>] [-i<ifname>] [-T<ctrl_iface>] \\\n"
+	       "           [-L<sessions> [-l<max active>] [-g<rate>]]\n"
 	       "eapol_test scard\n"
 	       "eapol_test sim <PIN> <num triplets> [debug]\n"
 	       "\n");
@@ -1273,7 +1779,9 @@ static void usage(void)
 	       "  -S = save configuration after authentication\n"
 	       "  -n = no MPPE keys expected\n"
 	       "  -v = show version\n"
-	       "  -t<timeout> = sets timeout in seconds (default: 30 s)\n"
+	       "  -t<timeout> = sets timeout in seconds (default: 30 s); "
+	       "per session in load test\n"
+	       "                mode\n"
 	       "  -C<Connect-Info> = RADIUS Connect-Info (default: "
 	       "CONNECT 11Mbps 802.11b)\n"
 	       "  -M<client MAC address> = Set own MAC address "
@@ -1292,7 +1800,21 @@ static void usage(void)
 	       "       When only attr_id is specified, NULL will be used as "
 	       "value.\n"
 	       "       Multiple attributes can be specified by using the "
-	       "option several times.\n");
+	       "option several times.\n"
+	       "  -L<sessions> = load test mode: run the specified number of "
+	       "concurrent,\n"
+	       "                 independent authentications; network blocks "
+	       "in the\n"
+	       "                 configuration file are used as credentials in "
+	       "round-robin\n"
+	       "                 order and the -M address is incremented for "
+	       "each session\n"
+	       "  -l<max active> = maximum number of simultaneous sessions in "
+	       "load test\n"
+	       "                   mode (default: 100)\n"
+	       "  -g<rate> = new sessions per second in load test mode "
+	       "(default: start\n"
+	       "             sessions as fast as -l allows)\n");
 }
 
 
@@ -1321,12 +1843,14 @@ int main(int argc, char *argv[])
 	eapol_test.connect_info = "CONNECT 11Mbps 802.11b";
 	os_memcpy(eapol_test.own_addr, "\x02\x00\x00\x00\x00\x01", ETH_ALEN);
 	eapol_test.pcsc_pin = "1234";
+	eapol_test.load.max_active = 100;
+	dl_list_init(&eapol_test.load.sessions);
 
 	wpa_debug_level = 0;
 	wpa_debug_show_keys = 1;
 
 	for (;;) {
-		c = getopt(argc, argv, "a:A:c:C:ei:M:nN:o:p:P:r:R:s:St:T:vW");
+		c = getopt(argc, argv, "a:A:c:C:eg:i:l:L:M:nN:o:p:P:r:R:s:St:T:vW");
 		if (c < 0)
 			break;
 		switch (c) {
@@ -1345,9 +1869,18 @@ int main(int argc, char *argv[])
 		case 'e':
 			eapol_test.req_eap_key_name = 1;
 			break;
+		case 'g':
+			eapol_test.load.rate = atoi(optarg);
+			break;
 		case 'i':
 			ifname = optarg;
 			break;
+		case 'l':
+			eapol_test.load.max_active = atoi(optarg);
+			break;
+		case 'L':
+			eapol_test.load.num_sessions = atoi(optarg);
+			break;
 		case 'M':
 			if (hwaddr_aton(optarg, eapol_test.own_addr)) {
 				usage();
@@ -1447,6 +1980,19 @@ int main(int argc, char *argv[])
 		return -1;
 	}
 
+	if (eapol_test.load.num_sessions) {
+		if (ctrl_iface || eapol_test.eapol_test_num_reauths ||
+		    eapol_test.load.max_active == 0) {
+			usage();
+			printf("Invalid load test mode parameters (-T and -r are not supported).\n");
+			return -1;
+		}
+		eapol_test.load.timeout = timeout;
+		/* Only report problems for individual sessions */
+		wpa_debug_level = MSG_WARNING;
+		wpa_debug_show_keys = 0;
+	}
+
 	if (eap_register_methods()) {
 		wpa_printf(MSG_ERROR, "Failed to register EAP methods");
 		return -1;
@@ -1499,7 +2045,8 @@ int main(int argc, char *argv[])
 	    wpa_supplicant_scard_init(&wpa_s, wpa_s.conf->ssid))
 		return -1;
 
-	if (test_eapol(&eapol_test, &wpa_s, wpa_s.conf->ssid))
+	if (test_eapol(&eapol_test, &wpa_s,
+		       eapol_test.load.num_sessions ? NULL : wpa_s.conf->ssid))
 		return -1;
 
 	if (wpas_init_ext_pw(&wpa_s) < 0)
@@ -1508,7 +2055,12 @@ int main(int argc, char *argv[])
 	if (wait_for_monitor)
 		wpa_supplicant_ctrl_iface_wait(wpa_s.ctrl_iface);
 
-	if (!ctrl_iface) {
+	if (eapol_test.load.num_sessions) {
+		eapol_test.radius_conf->msg_dumps = 0;
+		os_get_reltime(&eapol_test.load.start);
+		eloop_register_timeout(0, 0, eapol_test_load_tick, &eapol_test,
+				       NULL);
+	} else if (!ctrl_iface) {
 		eloop_register_timeout(timeout, 0, eapol_test_timeout,
 				       &eapol_test, NULL);
 		eloop_register_timeout(0, 0, send_eap_request_identity, &wpa_s,
@@ -1521,13 +2073,24 @@ int main(int argc, char *argv[])
 	eloop_cancel_timeout(eapol_test_timeout, &eapol_test, NULL);
 	eloop_cancel_timeout(eapol_sm_reauth, &eapol_test, NULL);
 
-	if (eapol_test_compare_pmk(&eapol_test) == 0 ||
-	    eapol_test.no_mppe_keys)
-		ret = 0;
-	if (eapol_test.auth_timed_out)
-		ret = -2;
-	if (eapol_test.radius_access_reject_received)
-		ret = -3;
+	if (eapol_test.load.num_sessions) {
+		eapol_test_load_report(&eapol_test);
+		eapol_test_load_deinit(&eapol_test);
+		if (eapol_test.load.ok == eapol_test.load.num_sessions)
+			ret = 0;
+		else if (eapol_test.load.failed)
+			ret = -3;
+		else
+			ret = -2;
+	} else {
+		if (eapol_test_compare_pmk(&eapol_test.sess) == 0 ||
+		    eapol_test.no_mppe_keys)
+			ret = 0;
+		if (eapol_test.auth_timed_out)
+			ret = -2;
+		if (eapol_test.sess.radius_access_reject_received)
+			ret = -3;
+	}
 
 	if (save_config)
 		wpa_config_write(conf, wpa_s.conf);
@@ -528,12 +528,13 @@ static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 	while ((ssid->proto & WPA_PROTO_RSN) && rsn_ie) {
 		proto_match++;
 
-		if (wpa_parse_wpa_ie(rsn_ie, 2 + rsn_ie[1], &ie)) {
+		if (!bss->rsn_ie_parsed) {
 			if (debug_print)
 				wpa_dbg(wpa_s, MSG_DEBUG,
 					"   skip RSN IE - parse failed");
 			break;
 		}
+		ie = bss->rsn_ie;
 
 		if (wep_ok &&
 		    (ie.group_cipher & (WPA_CIPHER_WEP40 | WPA_CIPHER_WEP104)))
@@ -621,12 +622,13 @@ static int wpa_supplicant_ssid_bss_match(struct wpa_supplicant *wpa_s,
 	while ((ssid->proto & WPA_PROTO_WPA) && wpa_ie) {
 		proto_match++;
 
-		if (wpa_parse_wpa_ie(wpa_ie, 2 + wpa_ie[1], &ie)) {
+		if (!bss->wpa_ie_parsed) {
 			if (debug_print)
 				wpa_dbg(wpa_s, MSG_DEBUG,
 					"   skip WPA IE - parse failed");
 			break;
 		}
+		ie = bss->wpa_ie;
 
 		if (wep_ok &&
 		    (ie.group_cipher & (WPA_CIPHER_WEP40 | WPA_CIPHER_WEP104)))
@@ -871,17 +873,156 @@ static int addr_in_list(const u8 *addr, const u8 *list, size_t num)
 }
 
 
-struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
-				     int i, struct wpa_bss *bss,
-				     struct wpa_ssid *group,
-				     int only_first_ssid, int debug_print)
+/*
+ * SSID index over the networks of a priority group. Only networks with a
+ * matching SSID and networks without a configured SSID (wildcard) can match
+ * a BSS, so BSS selection needs to evaluate only those candidates instead of
+ * the full group.
+ */
+#define WPAS_NET_HASH_SIZE 256
+
+struct wpas_net_index {
+	struct wpa_ssid **nets; /* networks in the pnext order of the group */
+	int *next; /* next network in the same hash bucket or -1 */
+	int *wildcard; /* networks without an SSID; terminated with -1 */
+	int head[WPAS_NET_HASH_SIZE];
+};
+
+struct wpas_net_iter {
+	const struct wpas_net_index *idx;
+	const struct wpa_bss *bss;
+	struct wpa_ssid *ssid;
+	int only_first_ssid;
+	int chain;
+	const int *wildcard;
+};
+
+
+static unsigned int wpas_ssid_hash(const u8 *ssid, size_t ssid_len)
+{
+	unsigned int hash = 0;
+	size_t i;
+
+	for (i = 0; i < ssid_len; i++)
+		hash = hash * 31 + ssid[i];
+	return hash % WPAS_NET_HASH_SIZE;
+}
+
+
+static struct wpas_net_index * wpas_net_index_build(struct wpa_ssid *group)
+{
+	struct wpas_net_index *idx;
+	struct wpa_ssid *ssid;
+	unsigned int i, num = 0, num_wildcard = 0;
+
+	for (ssid = group; ssid; ssid = ssid->pnext)
+		num++;
+
+	idx = os_zalloc(sizeof(*idx) + num * sizeof(struct wpa_ssid *) +
+			(2 * num + 1) * sizeof(int));
+	if (!idx)
+		return NULL;
+	idx->nets = (struct wpa_ssid **) (idx + 1);
+	idx->next = (int *) (idx->nets + num);
+	idx->wildcard = idx->next + num;
+
+	for (i = 0; i < WPAS_NET_HASH_SIZE; i++)
+		idx->head[i] = -1;
+
+	for (i = 0, ssid = group; ssid; ssid = ssid->pnext)
+		idx->nets[i++] = ssid;
+
+	/* Insert in reverse order to keep each bucket in the pnext order */
+	for (i = num; i > 0; i--) {
+		unsigned int hash;
+
+		ssid = idx->nets[i - 1];
+		if (ssid->ssid_len == 0)
+			continue;
+		hash = wpas_ssid_hash(ssid->ssid, ssid->ssid_len);
+		idx->next[i - 1] = idx->head[hash];
+		idx->head[hash] = i - 1;
+	}
+
+	for (i = 0; i < num; i++) {
+		if (idx->nets[i]->ssid_len == 0)
+			idx->wildcard[num_wildcard++] = i;
+	}
+	idx->wildcard[num_wildcard] = -1;
+
+	return idx;
+}
+
+
+static void wpas_net_iter_init(struct wpas_net_iter *iter,
+			       const struct wpas_net_index *idx,
+			       struct wpa_ssid *group,
+			       const struct wpa_bss *bss, int only_first_ssid)
+{
+	os_memset(iter, 0, sizeof(*iter));
+	iter->ssid = group;
+	iter->bss = bss;
+	iter->only_first_ssid = only_first_ssid;
+	if (idx && !only_first_ssid) {
+		iter->idx = idx;
+		iter->chain = idx->head[wpas_ssid_hash(bss->ssid,
+						       bss->ssid_len)];
+		iter->wildcard = idx->wildcard;
+	}
+}
+
+
+static struct wpa_ssid * wpas_net_iter_next(struct wpas_net_iter *iter)
+{
+	const struct wpas_net_index *idx = iter->idx;
+	const struct wpa_bss *bss = iter->bss;
+	struct wpa_ssid *ssid;
+	int pos;
+
+	if (!idx) {
+		ssid = iter->ssid;
+		if (ssid)
+			iter->ssid = iter->only_first_ssid ? NULL : ssid->pnext;
+		return ssid;
+	}
+
+	/* Skip hash collisions */
+	while (iter->chain >= 0) {
+		ssid = idx->nets[iter->chain];
+		if (ssid->ssid_len == bss->ssid_len &&
+		    os_memcmp(ssid->ssid, bss->ssid, bss->ssid_len) == 0)
+			break;
+		iter->chain = idx->next[iter->chain];
+	}
+
+	/* Merge the SSID bucket and wildcard networks in the pnext order */
+	if (iter->chain >= 0 &&
+	    (*iter->wildcard < 0 || iter->chain < *iter->wildcard)) {
+		pos = iter->chain;
+		iter->chain = idx->next[pos];
+	} else if (*iter->wildcard >= 0) {
+		pos = *iter->wildcard++;
+	} else {
+		return NULL;
+	}
+
+	return idx->nets[pos];
+}
+
+
+static struct wpa_ssid *
+wpa_scan_res_match_idx(struct wpa_supplicant *wpa_s, int i,
+		       struct wpa_bss *bss, struct wpa_ssid *group,
+		       const struct wpas_net_index *idx,
+		       int only_first_ssid, int debug_print)
 {
 	u8 wpa_ie_len, rsn_ie_len;
 	int wpa;
 	struct wpa_blacklist *e;
 	const u8 *ie;
 	struct wpa_ssid *ssid;
-	int osen;
+	struct wpas_net_iter iter;
+	int osen, candidates = 0;
 #ifdef CONFIG_MBO
 	const u8 *assoc_disallow;
 #endif /* CONFIG_MBO */
@@ -954,10 +1095,13 @@ struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 
 	wpa = wpa_ie_len > 0 || rsn_ie_len > 0;
 
-	for (ssid = group; ssid; ssid = only_first_ssid ? NULL : ssid->pnext) {
+	wpas_net_iter_init(&iter, idx, group, bss, only_first_ssid);
+	while ((ssid = wpas_net_iter_next(&iter))) {
 		int check_ssid = wpa ? 1 : (ssid->ssid_len != 0);
 		int res;
 
+		candidates++;
+
 		if (wpas_network_disabled(wpa_s, ssid)) {
 			if (debug_print)
 				wpa_dbg(wpa_s, MSG_DEBUG, "   skip - disabled");
@@ -1229,19 +1373,42 @@ struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
 		return ssid;
 	}
 
+	/*
+	 * The index returns only the networks with this SSID or a wildcard
+	 * SSID, so the other networks are not listed one by one above.
+	 */
+	if (debug_print && iter.idx && !candidates)
+		wpa_dbg(wpa_s, MSG_DEBUG,
+			"   skip - no network with matching SSID in index");
+
 	/* No matching configuration found */
 	return NULL;
 }
 
 
+struct wpa_ssid * wpa_scan_res_match(struct wpa_supplicant *wpa_s,
+				     int i, struct wpa_bss *bss,
+				     struct wpa_ssid *group,
+				     int only_first_ssid, int debug_print)
+{
+	return wpa_scan_res_match_idx(wpa_s, i, bss, group, NULL,
+				      only_first_ssid, debug_print);
+}
+
+
 static struct wpa_bss *
 wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 			  struct wpa_ssid *group,
 			  struct wpa_ssid **selected_ssid,
 			  int only_first_ssid)
 {
+	struct wpas_net_index *idx = NULL;
+	struct wpa_bss *selected = NULL;
 	unsigned int i;
 
+	if (!only_first_ssid)
+		idx = wpas_net_index_build(group);
+
 	if (wpa_s->current_ssid) {
 		struct wpa_ssid *ssid;
 
@@ -1250,8 +1417,8 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 		for (i = 0; i < wpa_s->last_scan_res_used; i++) {
 			struct wpa_bss *bss = wpa_s->last_scan_res[i];
 
-			ssid = wpa_scan_res_match(wpa_s, i, bss, group,
-						  only_first_ssid, 0);
+			ssid = wpa_scan_res_match_idx(wpa_s, i, bss, group,
+						      idx, only_first_ssid, 0);
 			if (ssid != wpa_s->current_ssid)
 				continue;
 			wpa_dbg(wpa_s, MSG_DEBUG, "%u: " MACSTR
@@ -1270,18 +1437,21 @@ wpa_supplicant_select_bss(struct wpa_supplicant *wpa_s,
 
 	for (i = 0; i < wpa_s->last_scan_res_used; i++) {
 		struct wpa_bss *bss = wpa_s->last_scan_res[i];
-		*selected_ssid = wpa_scan_res_match(wpa_s, i, bss, group,
-						    only_first_ssid, 1);
+		*selected_ssid = wpa_scan_res_match_idx(wpa_s, i, bss, group,
+							idx, only_first_ssid,
+							1);
 		if (!*selected_ssid)
 			continue;
 		wpa_dbg(wpa_s, MSG_DEBUG, "   selected BSS " MACSTR
 			" ssid='%s'",
 			MAC2STR(bss->bssid),
 			wpa_ssid_txt(bss->ssid, bss->ssid_len));
-		return bss;
+		selected = bss;
+		break;
 	}
 
-	return NULL;
+	os_free(idx);
+	return selected;
 }
 
 
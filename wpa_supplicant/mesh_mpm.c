@@ -29,7 +29,7 @@ struct mesh_peer_mgmt_ie {
 	const u8 *chosen_pmk; /* Chosen PMK (optional, 16 octets) */
 };
 
-static void plink_timer(void *eloop_ctx, void *user_data);
+static void plink_timer(struct wpa_supplicant *wpa_s, struct sta_info *sta);
 
 
 enum plink_event {
@@ -164,12 +164,17 @@ static Boolean matches_local(struct wpa_supplicant *wpa_s,
 }
 
 
+#define MESH_LLID_MAP_LEN (65536 / 8)
+
 /* check if local link id is already used with another peer */
 static Boolean llid_in_use(struct wpa_supplicant *wpa_s, u16 llid)
 {
 	struct sta_info *sta;
 	struct hostapd_data *hapd = wpa_s->ifmsh->bss[0];
 
+	if (hapd->mesh_llid_map)
+		return !!(hapd->mesh_llid_map[llid / 8] & BIT(llid % 8));
+
 	for (sta = hapd->sta_list; sta; sta = sta->next) {
 		if (sta->my_lid == llid)
 			return TRUE;
@@ -183,13 +188,27 @@ static Boolean llid_in_use(struct wpa_supplicant *wpa_s, u16 llid)
 static void mesh_mpm_init_link(struct wpa_supplicant *wpa_s,
 			       struct sta_info *sta)
 {
+	struct hostapd_data *hapd = wpa_s->ifmsh->bss[0];
 	u16 llid;
 
+	/*
+	 * The bitmap is allocated on first use; without it, llid_in_use()
+	 * falls back to going through the STA list.
+	 */
+	if (!hapd->mesh_llid_map)
+		hapd->mesh_llid_map = os_zalloc(MESH_LLID_MAP_LEN);
+
 	do {
 		if (os_get_random((u8 *) &llid, sizeof(llid)) < 0)
 			continue;
 	} while (!llid || llid_in_use(wpa_s, llid));
 
+	if (hapd->mesh_llid_map) {
+		if (sta->my_lid)
+			hapd->mesh_llid_map[sta->my_lid / 8] &=
+				~BIT(sta->my_lid % 8);
+		hapd->mesh_llid_map[llid / 8] |= BIT(llid % 8);
+	}
 	sta->my_lid = llid;
 	sta->peer_lid = 0;
 	sta->peer_aid = 0;
@@ -403,21 +422,63 @@ void wpa_mesh_set_plink_state(struct wpa_supplicant *wpa_s,
 }
 
 
+/*
+ * All the peer link timers of the interface are kept in a single timer list,
+ * so the number of eloop timeouts stays constant regardless of the number of
+ * peers that are in the middle of peering.
+ */
+static void mesh_mpm_plink_timer_expired(void *ctx,
+					 struct timer_list_entry *timer)
+{
+	struct wpa_supplicant *wpa_s = ctx;
+
+	plink_timer(wpa_s, timer_list_owner(timer, struct sta_info,
+					    plink_timer));
+}
+
+
+/**
+ * mesh_mpm_init - Initialize mesh peering state of a mesh BSS
+ * @wpa_s: Pointer to wpa_supplicant data
+ * @hapd: Mesh BSS
+ */
+void mesh_mpm_init(struct wpa_supplicant *wpa_s, struct hostapd_data *hapd)
+{
+	timer_list_init(&hapd->mesh_plink_timers, mesh_mpm_plink_timer_expired,
+			wpa_s);
+}
+
+
+static void mesh_mpm_plink_timer_cancel(struct hostapd_data *hapd,
+					struct sta_info *sta)
+{
+	timer_list_cancel(&hapd->mesh_plink_timers, &sta->plink_timer);
+}
+
+
+static void mesh_mpm_plink_timer_set(struct wpa_supplicant *wpa_s,
+				     struct sta_info *sta, int msecs)
+{
+	struct hostapd_data *hapd = wpa_s->ifmsh->bss[0];
+
+	timer_list_set(&hapd->mesh_plink_timers, &sta->plink_timer,
+		       msecs / 1000, (msecs % 1000) * 1000);
+}
+
+
 static void mesh_mpm_fsm_restart(struct wpa_supplicant *wpa_s,
 				 struct sta_info *sta)
 {
 	struct hostapd_data *hapd = wpa_s->ifmsh->bss[0];
 
-	eloop_cancel_timeout(plink_timer, wpa_s, sta);
+	mesh_mpm_plink_timer_cancel(hapd, sta);
 
 	ap_free_sta(hapd, sta);
 }
 
 
-static void plink_timer(void *eloop_ctx, void *user_data)
+static void plink_timer(struct wpa_supplicant *wpa_s, struct sta_info *sta)
 {
-	struct wpa_supplicant *wpa_s = eloop_ctx;
-	struct sta_info *sta = user_data;
 	u16 reason = 0;
 	struct mesh_conf *conf = wpa_s->ifmsh->mconf;
 	struct hostapd_data *hapd = wpa_s->ifmsh->bss[0];
@@ -427,10 +488,8 @@ static void plink_timer(void *eloop_ctx, void *user_data)
 	case PLINK_OPN_SNT:
 		/* retry timer */
 		if (sta->mpm_retries < conf->dot11MeshMaxRetries) {
-			eloop_register_timeout(
-				conf->dot11MeshRetryTimeout / 1000,
-				(conf->dot11MeshRetryTimeout % 1000) * 1000,
-				plink_timer, wpa_s, sta);
+			mesh_mpm_plink_timer_set(wpa_s, sta,
+						 conf->dot11MeshRetryTimeout);
 			mesh_mpm_send_plink_action(wpa_s, sta, PLINK_OPEN, 0);
 			sta->mpm_retries++;
 			break;
@@ -443,9 +502,8 @@ static void plink_timer(void *eloop_ctx, void *user_data)
 		if (!reason)
 			reason = WLAN_REASON_MESH_CONFIRM_TIMEOUT;
 		wpa_mesh_set_plink_state(wpa_s, sta, PLINK_HOLDING);
-		eloop_register_timeout(conf->dot11MeshHoldingTimeout / 1000,
-			(conf->dot11MeshHoldingTimeout % 1000) * 1000,
-			plink_timer, wpa_s, sta);
+		mesh_mpm_plink_timer_set(wpa_s, sta,
+					 conf->dot11MeshHoldingTimeout);
 		mesh_mpm_send_plink_action(wpa_s, sta, PLINK_CLOSE, reason);
 		break;
 	case PLINK_HOLDING:
@@ -472,10 +530,7 @@ mesh_mpm_plink_open(struct wpa_supplicant *wpa_s, struct sta_info *sta,
 {
 	struct mesh_conf *conf = wpa_s->ifmsh->mconf;
 
-	eloop_cancel_timeout(plink_timer, wpa_s, sta);
-	eloop_register_timeout(conf->dot11MeshRetryTimeout / 1000,
-			       (conf->dot11MeshRetryTimeout % 1000) * 1000,
-			       plink_timer, wpa_s, sta);
+	mesh_mpm_plink_timer_set(wpa_s, sta, conf->dot11MeshRetryTimeout);
 	mesh_mpm_send_plink_action(wpa_s, sta, PLINK_OPEN, 0);
 	wpa_mesh_set_plink_state(wpa_s, sta, next_state);
 }
@@ -492,7 +547,7 @@ static int mesh_mpm_plink_close(struct hostapd_data *hapd, struct sta_info *sta,
 		mesh_mpm_send_plink_action(wpa_s, sta, PLINK_CLOSE, reason);
 		wpa_printf(MSG_DEBUG, "MPM closing plink sta=" MACSTR,
 			   MAC2STR(sta->addr));
-		eloop_cancel_timeout(plink_timer, wpa_s, sta);
+		mesh_mpm_plink_timer_cancel(hapd, sta);
 		return 0;
 	}
 
@@ -589,6 +644,9 @@ void mesh_mpm_deinit(struct wpa_supplicant *wpa_s, struct hostapd_iface *ifmsh)
 	hapd->num_plinks = 0;
 	hostapd_free_stas(hapd);
 	eloop_cancel_timeout(peer_add_timer, wpa_s, NULL);
+	timer_list_deinit(&hapd->mesh_plink_timers);
+	os_free(hapd->mesh_llid_map);
+	hapd->mesh_llid_map = NULL;
 }
 
 
@@ -852,7 +910,7 @@ static void mesh_mpm_plink_estab(struct wpa_supplicant *wpa_s,
 
 	eloop_cancel_timeout(peer_add_timer, wpa_s, NULL);
 	peer_add_timer(wpa_s, NULL);
-	eloop_cancel_timeout(plink_timer, wpa_s, sta);
+	mesh_mpm_plink_timer_cancel(hapd, sta);
 
 	/* Send ctrl event */
 	wpa_msg(wpa_s, MSG_INFO, MESH_PEER_CONNECTED MACSTR,
@@ -900,10 +958,8 @@ static void mesh_mpm_fsm(struct wpa_supplicant *wpa_s, struct sta_info *sta,
 			wpa_mesh_set_plink_state(wpa_s, sta, PLINK_HOLDING);
 			if (!reason)
 				reason = WLAN_REASON_MESH_CLOSE_RCVD;
-			eloop_register_timeout(
-				conf->dot11MeshHoldingTimeout / 1000,
-				(conf->dot11MeshHoldingTimeout % 1000) * 1000,
-				plink_timer, wpa_s, sta);
+			mesh_mpm_plink_timer_set(wpa_s, sta,
+						 conf->dot11MeshHoldingTimeout);
 			mesh_mpm_send_plink_action(wpa_s, sta,
 						   PLINK_CLOSE, reason);
 			break;
@@ -915,11 +971,8 @@ static void mesh_mpm_fsm(struct wpa_supplicant *wpa_s, struct sta_info *sta,
 			break;
 		case CNF_ACPT:
 			wpa_mesh_set_plink_state(wpa_s, sta, PLINK_CNF_RCVD);
-			eloop_cancel_timeout(plink_timer, wpa_s, sta);
-			eloop_register_timeout(
-				conf->dot11MeshConfirmTimeout / 1000,
-				(conf->dot11MeshConfirmTimeout % 1000) * 1000,
-				plink_timer, wpa_s, sta);
+			mesh_mpm_plink_timer_set(wpa_s, sta,
+						 conf->dot11MeshConfirmTimeout);
 			break;
 		default:
 			break;
@@ -936,10 +989,8 @@ static void mesh_mpm_fsm(struct wpa_supplicant *wpa_s, struct sta_info *sta,
 			wpa_mesh_set_plink_state(wpa_s, sta, PLINK_HOLDING);
 			if (!reason)
 				reason = WLAN_REASON_MESH_CLOSE_RCVD;
-			eloop_register_timeout(
-				conf->dot11MeshHoldingTimeout / 1000,
-				(conf->dot11MeshHoldingTimeout % 1000) * 1000,
-				plink_timer, wpa_s, sta);
+			mesh_mpm_plink_timer_set(wpa_s, sta,
+						 conf->dot11MeshHoldingTimeout);
 			sta->mpm_close_reason = reason;
 			mesh_mpm_send_plink_action(wpa_s, sta,
 						   PLINK_CLOSE, reason);
@@ -968,10 +1019,8 @@ static void mesh_mpm_fsm(struct wpa_supplicant *wpa_s, struct sta_info *sta,
 			wpa_mesh_set_plink_state(wpa_s, sta, PLINK_HOLDING);
 			if (!reason)
 				reason = WLAN_REASON_MESH_CLOSE_RCVD;
-			eloop_register_timeout(
-				conf->dot11MeshHoldingTimeout / 1000,
-				(conf->dot11MeshHoldingTimeout % 1000) * 1000,
-				plink_timer, wpa_s, sta);
+			mesh_mpm_plink_timer_set(wpa_s, sta,
+						 conf->dot11MeshHoldingTimeout);
 			sta->mpm_close_reason = reason;
 			mesh_mpm_send_plink_action(wpa_s, sta,
 						   PLINK_CLOSE, reason);
@@ -996,10 +1045,8 @@ static void mesh_mpm_fsm(struct wpa_supplicant *wpa_s, struct sta_info *sta,
 			if (!reason)
 				reason = WLAN_REASON_MESH_CLOSE_RCVD;
 
-			eloop_register_timeout(
-				conf->dot11MeshHoldingTimeout / 1000,
-				(conf->dot11MeshHoldingTimeout % 1000) * 1000,
-				plink_timer, wpa_s, sta);
+			mesh_mpm_plink_timer_set(wpa_s, sta,
+						 conf->dot11MeshHoldingTimeout);
 			sta->mpm_close_reason = reason;
 
 			wpa_msg(wpa_s, MSG_INFO, "mesh plink with " MACSTR
@@ -1276,6 +1323,8 @@ void mesh_mpm_free_sta(struct hostapd_data *hapd, struct sta_info *sta)
 {
 	if (sta->plink_state == PLINK_ESTAB)
 		hapd->num_plinks--;
-	eloop_cancel_timeout(plink_timer, ELOOP_ALL_CTX, sta);
+	if (hapd->mesh_llid_map && sta->my_lid)
+		hapd->mesh_llid_map[sta->my_lid / 8] &= ~BIT(sta->my_lid % 8);
+	mesh_mpm_plink_timer_cancel(hapd, sta);
 	eloop_cancel_timeout(mesh_auth_timer, ELOOP_ALL_CTX, sta);
 }
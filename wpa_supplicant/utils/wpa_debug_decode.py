@@ -0,0 +1,170 @@
+#!/usr/bin/env python
+#
+# Decode a binary debug file (hostapd -F) into the text debug log format
+# Copyright (c) 2026, agent <agent@local>
+#
+# This software may be distributed under the terms of the BSD license.
+# See README for more details.
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b'WPADBG1\n'
+
+REC_FORMAT = 1
+REC_MSG = 2
+REC_TEXT = 3
+REC_HEXDUMP = 4
+
+HEXDUMP_ASCII = 0x01
+HEXDUMP_REMOVED = 0x02
+HEXDUMP_NULL = 0x04
+
+CONV = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|q|j|z|t|L)?([diouxXcpeEfFgGs%])')
+
+def to_signed(val, bits):
+    val &= (1 << bits) - 1
+    if val & (1 << (bits - 1)):
+        val -= 1 << bits
+    return val
+
+class Format(object):
+    def __init__(self, fmt):
+        self.parts = []
+        pos = 0
+        for m in CONV.finditer(fmt):
+            self.parts.append(fmt[pos:m.start()])
+            pos = m.end()
+            flags, width, prec, lmod, conv = m.groups()
+            if conv == '%':
+                self.parts.append('%')
+                continue
+            self.parts.append((flags, width, prec, lmod, conv))
+        self.parts.append(fmt[pos:])
+
+    def format(self, data):
+        out = []
+        pos = 0
+
+        def get_u64():
+            return struct.unpack_from('<Q', data, pos)[0]
+
+        for part in self.parts:
+            if not isinstance(part, tuple):
+                out.append(part)
+                continue
+            flags, width, prec, lmod, conv = part
+            spec = '%' + flags
+            args = []
+            if width == '*':
+                args.append(int(to_signed(get_u64(), 64)))
+                pos += 8
+                spec += '*'
+            elif width:
+                spec += width
+            if prec is not None:
+                if prec == '*':
+                    args.append(int(to_signed(get_u64(), 64)))
+                    pos += 8
+                    spec += '.*'
+                else:
+                    spec += '.' + prec
+            if conv == 's':
+                slen = struct.unpack_from('<H', data, pos)[0]
+                args.append(data[pos + 2:pos + 2 + slen].decode('latin-1'))
+                pos += 2 + slen
+                out.append((spec + 's') % tuple(args))
+                continue
+
+            val = get_u64()
+            pos += 8
+            if conv in 'di':
+                bits = {'hh': 8, 'h': 16}.get(lmod, 64)
+                if not lmod:
+                    bits = 32
+                args.append(to_signed(val, bits))
+            elif conv in 'ouxX':
+                args.append(val)
+                conv = 'd' if conv == 'u' else conv
+            elif conv == 'c':
+                args.append(chr(val & 0xff))
+            elif conv == 'p':
+                args.append('0x%x' % val if val else '(nil)')
+                conv = 's'
+            else:
+                args.append(struct.unpack('<d', struct.pack('<Q', val))[0])
+            out.append((spec + conv) % tuple(args))
+        return ''.join(out)
+
+def hexdump(title, flags, length, data):
+    kind = 'hexdump_ascii' if flags & HEXDUMP_ASCII else 'hexdump'
+    hdr = '%s - %s(len=%d):' % (title, kind, length)
+    if flags & HEXDUMP_NULL:
+        return hdr + ' [NULL]'
+    if flags & HEXDUMP_REMOVED:
+        return hdr + ' [REMOVED]'
+    if not flags & HEXDUMP_ASCII:
+        return hdr + ''.join(' %02x' % b for b in bytearray(data))
+    lines = [hdr]
+    data = bytearray(data)
+    for i in range(0, len(data), 16):
+        chunk = data[i:i + 16]
+        line = '    ' + ''.join(' %02x' % b for b in chunk)
+        line += '   ' * (16 - len(chunk)) + '   '
+        line += ''.join(chr(b) if 32 <= b < 127 else '_' for b in chunk)
+        line += ' ' * (16 - len(chunk))
+        lines.append(line)
+    return '\n'.join(lines)
+
+def decode(f, out, timestamps):
+    if f.read(len(MAGIC)) != MAGIC:
+        raise Exception('Not a binary debug file')
+    formats = {}
+    while True:
+        hdr = f.read(6)
+        if len(hdr) < 6:
+            break
+        rtype, level, rlen = struct.unpack('<BBI', hdr)
+        data = f.read(rlen)
+        if len(data) < rlen:
+            break
+        if rtype == REC_FORMAT:
+            fid = struct.unpack_from('<H', data)[0]
+            formats[fid] = Format(data[2:].decode('latin-1'))
+            continue
+
+        sec, usec = struct.unpack_from('<II', data)
+        if rtype == REC_MSG:
+            fid = struct.unpack_from('<H', data, 8)[0]
+            if fid not in formats:
+                continue
+            txt = formats[fid].format(data[10:])
+        elif rtype == REC_TEXT:
+            txt = data[8:].decode('latin-1')
+        elif rtype == REC_HEXDUMP:
+            flags, length, tlen = struct.unpack_from('<BIH', data, 8)
+            title = data[15:15 + tlen].decode('latin-1')
+            txt = hexdump(title, flags, length, data[15 + tlen:])
+        else:
+            continue
+
+        if timestamps:
+            txt = '%d.%06u: %s' % (sec, usec, txt)
+        out.write((txt + '\n').encode('latin-1'))
+
+def main():
+    parser = argparse.ArgumentParser(description=
+                                     'Decode a binary debug file to text')
+    parser.add_argument('file', help='binary debug file (hostapd -F)')
+    parser.add_argument('-n', '--no-timestamps', action='store_true',
+                        help='do not include timestamps in the output')
+    args = parser.parse_args()
+
+    out = getattr(sys.stdout, 'buffer', sys.stdout)
+    with open(args.file, 'rb') as f:
+        decode(f, out, not args.no_timestamps)
+
+if __name__ == "__main__":
+    main()
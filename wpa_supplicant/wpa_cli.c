@@ -310,6 +310,20 @@ static int wpa_cli_cmd_relog(struct wpa_ctrl *ctrl, int argc, char *argv[])
 }
 
 
+static int wpa_cli_cmd_eloop_stats(struct wpa_ctrl *ctrl, int argc,
+				   char *argv[])
+{
+	return wpa_cli_cmd(ctrl, "ELOOP_STATS", 0, argc, argv);
+}
+
+
+static int wpa_cli_cmd_mem_pool_stats(struct wpa_ctrl *ctrl, int argc,
+				      char *argv[])
+{
+	return wpa_cli_cmd(ctrl, "MEM_POOL_STATS", 0, argc, argv);
+}
+
+
 static int wpa_cli_cmd_note(struct wpa_ctrl *ctrl, int argc, char *argv[])
 {
 	return wpa_cli_cmd(ctrl, "NOTE", 1, argc, argv);
@@ -2948,6 +2962,12 @@ static const struct wpa_cli_cmd wpa_cli_commands[] = {
 	{ "relog", wpa_cli_cmd_relog, NULL,
 	  cli_cmd_flag_none,
 	  "= re-open log-file (allow rolling logs)" },
+	{ "eloop_stats", wpa_cli_cmd_eloop_stats, NULL,
+	  cli_cmd_flag_none,
+	  "[RESET] = show (or clear) event loop handler statistics" },
+	{ "mem_pool_stats", wpa_cli_cmd_mem_pool_stats, NULL,
+	  cli_cmd_flag_none,
+	  "[RESET] = show (or clear) memory pool statistics" },
 	{ "note", wpa_cli_cmd_note, NULL,
 	  cli_cmd_flag_none,
 	  "<text> = add a note to wpa_supplicant debug log" },
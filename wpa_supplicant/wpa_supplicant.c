@@ -27,6 +27,7 @@
 #include "eloop.h"
 #include "config.h"
 #include "utils/ext_password.h"
+#include "utils/mem_pool.h"
 #include "l2_packet/l2_packet.h"
 #include "wpa_supplicant_i.h"
 #include "driver_i.h"
@@ -5972,6 +5973,7 @@ void wpa_supplicant_deinit(struct wpa_global *global)
 	os_free(global->add_psk);
 
 	os_free(global);
+	mem_pool_deinit_all();
 	wpa_debug_close_syslog();
 	wpa_debug_close_file();
 	wpa_debug_close_linux_tracing();
@@ -577,6 +577,13 @@ struct wpa_supplicant {
 				 struct wpa_scan_results *scan_res);
 	struct dl_list bss; /* struct wpa_bss::list */
 	struct dl_list bss_id; /* struct wpa_bss::list_id */
+#define WPA_BSS_HASH_SIZE 256
+#define WPA_BSS_HASH(bssid) ((bssid)[5])
+	struct wpa_bss *bss_hash[WPA_BSS_HASH_SIZE]; /* struct wpa_bss::hnext */
+#ifdef CONFIG_P2P
+	/* Entries with a P2P Device Address; struct wpa_bss::p2p_hnext */
+	struct wpa_bss *bss_p2p_hash[WPA_BSS_HASH_SIZE];
+#endif /* CONFIG_P2P */
 	size_t num_bss;
 	unsigned int bss_update_idx;
 	unsigned int bss_next_id;
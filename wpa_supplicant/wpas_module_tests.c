@@ -10,8 +10,18 @@
 
 #include "utils/common.h"
 #include "utils/module_tests.h"
+#include "common/ieee802_11_defs.h"
+#include "drivers/driver.h"
 #include "wpa_supplicant_i.h"
+#include "config.h"
 #include "blacklist.h"
+#include "bss.h"
+#ifdef CONFIG_MESH
+#include "common/ieee802_11_common.h"
+#include "ap/hostapd.h"
+#include "ap/sta_info.h"
+#include "mesh_mpm.h"
+#endif /* CONFIG_MESH */
 
 
 static int wpas_blacklist_module_tests(void)
@@ -70,6 +80,521 @@ fail:
 }
 
 
+static struct wpa_scan_res * bss_test_res(const u8 *bssid, const char *ssid,
+					   const u8 *extra, size_t extra_len)
+{
+	struct wpa_scan_res *res;
+	size_t ssid_len = os_strlen(ssid);
+	u8 *pos;
+
+	res = os_zalloc(sizeof(*res) + 2 + ssid_len + 10 + 8 + extra_len);
+	if (!res)
+		return NULL;
+	os_memcpy(res->bssid, bssid, ETH_ALEN);
+	res->freq = 2412;
+	pos = (u8 *) (res + 1);
+	*pos++ = WLAN_EID_SSID;
+	*pos++ = ssid_len;
+	os_memcpy(pos, ssid, ssid_len);
+	pos += ssid_len;
+	*pos++ = WLAN_EID_SUPP_RATES;
+	*pos++ = 8;
+	os_memcpy(pos, "\x82\x84\x8b\x96\x0c\x12\x18\x24", 8);
+	pos += 8;
+	*pos++ = WLAN_EID_VENDOR_SPECIFIC;
+	*pos++ = 6;
+	WPA_PUT_BE32(pos, WPA_IE_VENDOR_TYPE);
+	pos += 4;
+	*pos++ = 0x01;
+	*pos++ = 0x00;
+	os_memcpy(pos, extra, extra_len);
+	pos += extra_len;
+	res->ie_len = pos - (u8 *) (res + 1);
+	return res;
+}
+
+
+static int wpas_bss_module_tests(void)
+{
+	struct wpa_supplicant *wpa_s;
+	struct wpa_config *conf;
+	struct wpa_global global;
+	struct wpa_radio radio;
+	struct wpa_scan_res *res[6];
+	struct wpa_bss *a, *b, *c;
+	struct os_reltime now;
+	u8 ext_rates[100];
+	/* P2P IE with a P2P Device ID attribute */
+	const u8 p2p_ie[] = {
+		WLAN_EID_VENDOR_SPECIFIC, 13, 0x50, 0x6f, 0x9a, 0x09,
+		P2P_ATTR_DEVICE_ID, 6, 0, 0x02, 0x00, 0x00, 0x00, 0x02, 0x01
+	};
+	const u8 bssid1[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+	const u8 bssid2[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x01, 0x01 };
+	const u8 bssid3[ETH_ALEN] = { 0x02, 0x00, 0x00, 0x00, 0x02, 0x01 };
+	const u8 *ie;
+	u8 *big_ies;
+	size_t big_len;
+	unsigned int i;
+	int ret = -1;
+
+	wpa_s = os_zalloc(sizeof(*wpa_s));
+	conf = os_zalloc(sizeof(*conf));
+	ext_rates[0] = WLAN_EID_EXT_SUPP_RATES;
+	ext_rates[1] = sizeof(ext_rates) - 2;
+	os_memset(&ext_rates[2], 0x30, sizeof(ext_rates) - 2);
+	res[0] = bss_test_res(bssid1, "one", NULL, 0);
+	res[1] = bss_test_res(bssid1, "two", NULL, 0);
+	res[2] = bss_test_res(bssid2, "one", NULL, 0);
+	res[3] = bss_test_res(bssid1, "one", ext_rates, sizeof(ext_rates));
+	res[4] = bss_test_res(bssid3, "DIRECT-xy", p2p_ie, sizeof(p2p_ie));
+
+	/*
+	 * IE field with elements beyond the offsets that fit in the element
+	 * index; HT Capabilities and WPS are found only after those
+	 */
+	big_len = 260 * 257 + 2 + 26 + 2 + 4;
+	big_ies = os_zalloc(big_len);
+	if (big_ies) {
+		u8 *pos = big_ies;
+
+		for (i = 0; i < 260; i++) {
+			*pos++ = WLAN_EID_EXT_SUPP_RATES;
+			*pos++ = 255;
+			pos += 255;
+		}
+		*pos++ = WLAN_EID_HT_CAP;
+		*pos++ = 26;
+		pos += 26;
+		*pos++ = WLAN_EID_VENDOR_SPECIFIC;
+		*pos++ = 4;
+		WPA_PUT_BE32(pos, WPS_IE_VENDOR_TYPE);
+		res[5] = bss_test_res(bssid2, "big", big_ies, big_len);
+		os_free(big_ies);
+	} else {
+		res[5] = NULL;
+	}
+
+	if (!wpa_s || !conf || !res[0] || !res[1] || !res[2] || !res[3] ||
+	    !res[4] || !res[5])
+		goto fail;
+
+	os_memset(&global, 0, sizeof(global));
+	os_memset(&radio, 0, sizeof(radio));
+	dl_list_init(&radio.work);
+	conf->bss_max_count = DEFAULT_BSS_MAX_COUNT;
+	wpa_s->global = &global;
+	wpa_s->conf = conf;
+	wpa_s->radio = &radio;
+	wpa_s->p2p_mgmt = 1; /* skip control interface notifications */
+	wpa_bss_init(wpa_s);
+	os_get_reltime(&now);
+
+	/* Same BSSID with two SSIDs and another BSSID in the same bucket */
+	wpa_bss_update_start(wpa_s);
+	for (i = 0; i < 3; i++)
+		wpa_bss_update_scan_res(wpa_s, res[i], &now);
+	a = wpa_bss_get(wpa_s, bssid1, (const u8 *) "one", 3);
+	b = wpa_bss_get(wpa_s, bssid1, (const u8 *) "two", 3);
+	c = wpa_bss_get(wpa_s, bssid2, (const u8 *) "one", 3);
+	if (wpa_s->num_bss != 3 || wpa_s->last_scan_res_used != 3 ||
+	    !a || !b || !c || a == b ||
+	    wpa_bss_get(wpa_s, bssid1, (const u8 *) "one", 2) ||
+	    wpa_bss_get_bssid(wpa_s, bssid1) != b ||
+	    wpa_bss_get_bssid(wpa_s, bssid2) != c ||
+	    wpa_bss_get_bssid_latest(wpa_s, bssid2) != c)
+		goto fail;
+
+	/* Element index */
+	ie = wpa_bss_get_ie(a, WLAN_EID_SUPP_RATES);
+	if (!ie || ie != get_ie((const u8 *) (a + 1), a->ie_len,
+				WLAN_EID_SUPP_RATES) ||
+	    wpa_bss_get_ie(a, WLAN_EID_EXT_SUPP_RATES) ||
+	    wpa_bss_get_ie(a, WLAN_EID_RSN) ||
+	    !wpa_bss_get_vendor_ie(a, WPA_IE_VENDOR_TYPE) ||
+	    wpa_bss_get_vendor_ie(a, WPS_IE_VENDOR_TYPE) ||
+	    wpa_bss_get_max_rate(a) != 0x24)
+		goto fail;
+
+	/* Update with longer IEs (reallocates the entry) in a new round */
+	wpa_bss_update_start(wpa_s);
+	wpa_bss_update_scan_res(wpa_s, res[3], &now);
+	wpa_bss_update_scan_res(wpa_s, res[3], &now);
+	a = wpa_bss_get(wpa_s, bssid1, (const u8 *) "one", 3);
+	if (!a || wpa_s->num_bss != 3 || wpa_s->last_scan_res_used != 1 ||
+	    wpa_s->last_scan_res[0] != a ||
+	    wpa_bss_get_bssid(wpa_s, bssid1) != a ||
+	    wpa_bss_get(wpa_s, bssid1, (const u8 *) "two", 3) != b)
+		goto fail;
+	ie = wpa_bss_get_ie(a, WLAN_EID_EXT_SUPP_RATES);
+	if (!ie || ie[1] != 98 || ie[2] != 0x30 ||
+	    wpa_bss_get_max_rate(a) != 0x30)
+		goto fail;
+
+	wpa_bss_remove(wpa_s, a, "test");
+	if (wpa_bss_get(wpa_s, bssid1, (const u8 *) "one", 3) ||
+	    wpa_bss_get_bssid(wpa_s, bssid1) != b ||
+	    wpa_bss_get(wpa_s, bssid2, (const u8 *) "one", 3) != c)
+		goto fail;
+
+	/* Elements after the indexed part of the IE field */
+	wpa_bss_update_scan_res(wpa_s, res[5], &now);
+	a = wpa_bss_get(wpa_s, bssid2, (const u8 *) "big", 3);
+	if (!a || a->ie_pos_len >= a->ie_len)
+		goto fail;
+	ie = wpa_bss_get_ie(a, WLAN_EID_HT_CAP);
+	if (!ie || ie != get_ie((const u8 *) (a + 1), a->ie_len,
+				WLAN_EID_HT_CAP) ||
+	    wpa_bss_get_ie(a, WLAN_EID_EXT_SUPP_RATES) !=
+	    get_ie((const u8 *) (a + 1), a->ie_len, WLAN_EID_EXT_SUPP_RATES) ||
+	    !wpa_bss_get_vendor_ie(a, WPS_IE_VENDOR_TYPE) ||
+	    wpa_bss_get_ie(a, WLAN_EID_RSN))
+		goto fail;
+
+#ifdef CONFIG_P2P
+	/* P2P Device Address index; entries without P2P IE are not found */
+	wpa_bss_update_scan_res(wpa_s, res[4], &now);
+	a = wpa_bss_get_bssid(wpa_s, bssid3);
+	if (!a || wpa_bss_get_p2p_dev_addr(wpa_s, bssid3) != a ||
+	    wpa_bss_get_p2p_dev_addr(wpa_s, bssid1) ||
+	    wpa_bss_get_p2p_dev_addr(wpa_s, (const u8 *) "\0\0\0\0\0\0"))
+		goto fail;
+	wpa_bss_remove(wpa_s, a, "test");
+	if (wpa_bss_get_p2p_dev_addr(wpa_s, bssid3))
+		goto fail;
+#endif /* CONFIG_P2P */
+
+	wpa_bss_flush(wpa_s);
+	if (wpa_s->num_bss != 0 || wpa_bss_get_bssid(wpa_s, bssid1) ||
+	    wpa_bss_get_bssid(wpa_s, bssid2))
+		goto fail;
+
+	ret = 0;
+fail:
+	if (wpa_s && wpa_s->conf)
+		wpa_bss_flush(wpa_s);
+	if (wpa_s)
+		os_free(wpa_s->last_scan_res);
+	for (i = 0; i < ARRAY_SIZE(res); i++)
+		os_free(res[i]);
+	os_free(conf);
+	os_free(wpa_s);
+
+	if (ret)
+		wpa_printf(MSG_ERROR, "BSS table module test failure");
+
+	return ret;
+}
+
+
+#ifndef CONFIG_NO_SCAN_PROCESSING
+
+#define BSS_SEL_TEST_NUM_BSS 10
+#define BSS_SEL_TEST_NUM_NETWORKS 6
+
+static struct wpa_scan_res * bss_sel_test_res(unsigned int i, const char *ssid)
+{
+	/* RSN: CCMP/CCMP/PSK */
+	static const u8 rsn[] = {
+		WLAN_EID_RSN, 20, 0x01, 0x00, 0x00, 0x0f, 0xac, 0x04,
+		0x01, 0x00, 0x00, 0x0f, 0xac, 0x04,
+		0x01, 0x00, 0x00, 0x0f, 0xac, 0x02, 0x00, 0x00
+	};
+	struct wpa_scan_res *res;
+
+	res = bss_test_res((const u8 *) "\x02\x00\x00\x00\x00\x00", ssid,
+			   rsn, sizeof(rsn));
+	if (!res)
+		return NULL;
+	res->bssid[4] = i >> 8;
+	res->bssid[5] = i & 0xff;
+	res->caps = IEEE80211_CAP_ESS | IEEE80211_CAP_PRIVACY;
+	res->level = -50;
+	return res;
+}
+
+
+static int wpas_bss_select_module_tests(void)
+{
+	struct wpa_supplicant *wpa_s;
+	struct wpa_config *conf;
+	struct wpa_global global;
+	struct wpa_radio radio;
+	struct wpa_ssid *ssid, *full_ssid = NULL, *sel_ssid = NULL;
+	struct wpa_bss *full_bss = NULL, *sel_bss;
+	struct os_reltime now;
+	char buf[40];
+	unsigned int i;
+	int ret = -1;
+
+	wpa_s = os_zalloc(sizeof(*wpa_s));
+	conf = wpa_config_alloc_empty(NULL, NULL);
+	if (!wpa_s || !conf)
+		goto fail;
+
+	os_memset(&global, 0, sizeof(global));
+	os_memset(&radio, 0, sizeof(radio));
+	dl_list_init(&radio.work);
+	conf->bss_max_count = BSS_SEL_TEST_NUM_BSS;
+	wpa_s->global = &global;
+	wpa_s->conf = conf;
+	wpa_s->radio = &radio;
+	dl_list_init(&wpa_s->bss_tmp_disallowed);
+	wpa_bss_init(wpa_s);
+
+	for (i = 0; i < BSS_SEL_TEST_NUM_NETWORKS; i++) {
+		ssid = wpa_config_add_network(conf);
+		if (!ssid)
+			goto fail;
+		wpa_config_set_network_defaults(ssid);
+		os_snprintf(buf, sizeof(buf), "net-%u", i);
+		ssid->ssid = (u8 *) os_strdup(buf);
+		if (!ssid->ssid)
+			goto fail;
+		ssid->ssid_len = os_strlen(buf);
+		ssid->psk_set = 1;
+	}
+
+	/* Only the last BSS matches a network (the last one) */
+	os_get_reltime(&now);
+	wpa_bss_update_start(wpa_s);
+	for (i = 0; i < BSS_SEL_TEST_NUM_BSS; i++) {
+		struct wpa_scan_res *res;
+
+		if (i == BSS_SEL_TEST_NUM_BSS - 1)
+			os_snprintf(buf, sizeof(buf), "net-%u",
+				    BSS_SEL_TEST_NUM_NETWORKS - 1);
+		else
+			os_snprintf(buf, sizeof(buf), "bss-%u", i);
+		res = bss_sel_test_res(i, buf);
+		if (!res)
+			goto fail;
+		wpa_bss_update_scan_res(wpa_s, res, &now);
+		os_free(res);
+	}
+	if (wpa_s->last_scan_res_used != BSS_SEL_TEST_NUM_BSS ||
+	    conf->num_prio != 1)
+		goto fail;
+
+	/* Every BSS against every network */
+	for (i = 0; i < wpa_s->last_scan_res_used; i++) {
+		full_ssid = wpa_scan_res_match(wpa_s, i,
+					       wpa_s->last_scan_res[i],
+					       conf->pssid[0], 0, 1);
+		if (full_ssid) {
+			full_bss = wpa_s->last_scan_res[i];
+			break;
+		}
+	}
+
+	/* Indexed selection */
+	sel_bss = wpa_supplicant_pick_network(wpa_s, &sel_ssid);
+
+	if (!full_bss || full_bss != sel_bss || full_ssid != sel_ssid ||
+	    sel_bss != wpa_s->last_scan_res[BSS_SEL_TEST_NUM_BSS - 1] ||
+	    sel_ssid->id != BSS_SEL_TEST_NUM_NETWORKS - 1)
+		goto fail;
+
+	/* A wildcard network earlier in the group is preferred */
+	ssid = conf->ssid->next;
+	os_free(ssid->ssid);
+	ssid->ssid = NULL;
+	ssid->ssid_len = 0;
+	ssid->bssid_set = 1;
+	os_memcpy(ssid->bssid, sel_bss->bssid, ETH_ALEN);
+	sel_bss = wpa_supplicant_pick_network(wpa_s, &sel_ssid);
+	if (sel_bss != wpa_s->last_scan_res[BSS_SEL_TEST_NUM_BSS - 1] ||
+	    sel_ssid != ssid)
+		goto fail;
+
+	ret = 0;
+fail:
+	if (wpa_s && wpa_s->conf) {
+		wpa_bss_flush(wpa_s);
+		os_free(wpa_s->last_scan_res);
+	}
+	if (conf)
+		wpa_config_free(conf);
+	os_free(wpa_s);
+
+	if (ret)
+		wpa_printf(MSG_ERROR, "BSS selection module test failure");
+
+	return ret;
+}
+
+#endif /* CONFIG_NO_SCAN_PROCESSING */
+
+
+#ifdef CONFIG_MESH
+
+static int mesh_test_sta_add(void *priv, struct hostapd_sta_add_params *params)
+{
+	return 0;
+}
+
+
+static int mesh_test_send_action(void *priv, unsigned int freq,
+				 unsigned int wait, const u8 *dst,
+				 const u8 *src, const u8 *bssid,
+				 const u8 *data, size_t data_len, int no_cck)
+{
+	return 0;
+}
+
+
+static const struct wpa_driver_ops mesh_test_driver = {
+	.name = "mesh-test",
+	.sta_add = mesh_test_sta_add,
+	.send_action = mesh_test_send_action,
+};
+
+
+#define MESH_TEST_PEERS 500
+
+static int wpas_mesh_module_tests(void)
+{
+	struct wpa_supplicant *wpa_s;
+	struct wpa_global global;
+	struct hostapd_iface *ifmsh = NULL;
+	struct hostapd_config *conf = NULL;
+	struct hostapd_data *hapd = NULL;
+	struct mesh_conf *mconf = NULL;
+	struct ieee802_11_elems elems;
+	struct sta_info *sta, *prev;
+	u8 *llids = NULL;
+	u8 addr[ETH_ALEN], supp_rates[] = { 0x82, 0x84, 0x8b, 0x96 };
+	u8 mesh_config[7];
+	int i, count, ret = -1;
+
+	wpa_printf(MSG_INFO, "mesh module tests");
+
+	wpa_s = os_zalloc(sizeof(*wpa_s));
+	ifmsh = os_zalloc(sizeof(*ifmsh));
+	conf = hostapd_config_defaults();
+	mconf = os_zalloc(sizeof(*mconf));
+	llids = os_zalloc(65536 / 8);
+	if (!wpa_s || !ifmsh || !conf || !mconf || !llids)
+		goto fail;
+	os_memset(&global, 0, sizeof(global));
+	wpa_s->global = &global;
+	wpa_s->driver = &mesh_test_driver;
+	wpa_s->ifmsh = ifmsh;
+
+	ifmsh->drv_flags = WPA_DRIVER_FLAGS_INACTIVITY_TIMER;
+	ifmsh->conf = conf;
+	ifmsh->mconf = mconf;
+	ifmsh->num_bss = 1;
+	ifmsh->bss = os_calloc(1, sizeof(struct hostapd_data *));
+	if (!ifmsh->bss)
+		goto fail;
+	ifmsh->bss[0] = hapd = hostapd_alloc_bss_data(ifmsh, conf, conf->bss[0]);
+	if (!hapd)
+		goto fail;
+	hapd->conf->mesh = MESH_ENABLED;
+	hapd->mesh_sta_free_cb = mesh_mpm_free_sta;
+	mesh_mpm_init(wpa_s, hapd);
+
+	os_memcpy(mconf->meshid, "mesh-test", 9);
+	mconf->meshid_len = 9;
+	mconf->security = MESH_CONF_SEC_NONE;
+	mconf->dot11MeshMaxRetries = 2;
+	mconf->dot11MeshRetryTimeout = 40;
+	mconf->dot11MeshConfirmTimeout = 40;
+	mconf->dot11MeshHoldingTimeout = 40;
+
+	os_memset(mesh_config, 0, sizeof(mesh_config));
+	mesh_config[6] = MESH_CAP_ACCEPT_ADDITIONAL_PEER;
+	os_memset(&elems, 0, sizeof(elems));
+	elems.supp_rates = supp_rates;
+	elems.supp_rates_len = sizeof(supp_rates);
+	elems.mesh_config = mesh_config;
+	elems.mesh_config_len = sizeof(mesh_config);
+
+	/* Start peering with a large number of new peers */
+	addr[0] = 0x02;
+	addr[1] = 0x00;
+	for (i = 0; i < MESH_TEST_PEERS; i++) {
+		WPA_PUT_BE32(&addr[2], i + 1);
+		wpa_mesh_new_mesh_peer(wpa_s, addr, &elems);
+		sta = ap_get_sta(hapd, addr);
+		if (!sta || sta->plink_state != PLINK_OPN_SNT || !sta->my_lid ||
+		    (llids[sta->my_lid / 8] & BIT(sta->my_lid % 8)) ||
+		    !hapd->mesh_llid_map ||
+		    !(hapd->mesh_llid_map[sta->my_lid / 8] &
+		      BIT(sta->my_lid % 8))) {
+			wpa_printf(MSG_INFO, "mesh: Peer %d not initialized",
+				   i);
+			goto fail;
+		}
+		llids[sta->my_lid / 8] |= BIT(sta->my_lid % 8);
+	}
+
+	/* All the retry timers are queued in expiration order */
+	count = 0;
+	prev = NULL;
+	dl_list_for_each(sta, &hapd->mesh_plink_timers.entries,
+			 struct sta_info, plink_timer.list) {
+		if (prev && os_reltime_before(&sta->plink_timer.expire,
+					      &prev->plink_timer.expire)) {
+			wpa_printf(MSG_INFO, "mesh: Timer list out of order");
+			goto fail;
+		}
+		prev = sta;
+		count++;
+	}
+	if (count != MESH_TEST_PEERS) {
+		wpa_printf(MSG_INFO, "mesh: %d/%d peer link timers queued",
+			   count, MESH_TEST_PEERS);
+		goto fail;
+	}
+
+	/* Removing peers releases their LLIDs and timers */
+	for (i = 0; i < MESH_TEST_PEERS; i += 2) {
+		WPA_PUT_BE32(&addr[2], i + 1);
+		sta = ap_get_sta(hapd, addr);
+		if (!sta)
+			goto fail;
+		llids[sta->my_lid / 8] &= ~BIT(sta->my_lid % 8);
+		ap_free_sta(hapd, sta);
+	}
+	if (os_memcmp(llids, hapd->mesh_llid_map, 65536 / 8) != 0 ||
+	    dl_list_len(&hapd->mesh_plink_timers.entries) !=
+	    MESH_TEST_PEERS / 2) {
+		wpa_printf(MSG_INFO, "mesh: Peer removal not reflected");
+		goto fail;
+	}
+
+	mesh_mpm_deinit(wpa_s, ifmsh);
+	if (hapd->sta_list || hapd->mesh_llid_map ||
+	    !dl_list_empty(&hapd->mesh_plink_timers.entries)) {
+		wpa_printf(MSG_INFO, "mesh: Peers left after deinit");
+		goto fail;
+	}
+
+	ret = 0;
+fail:
+	if (hapd) {
+		mesh_mpm_deinit(wpa_s, ifmsh);
+		os_free(hapd);
+	}
+	if (ifmsh)
+		os_free(ifmsh->bss);
+	os_free(ifmsh);
+	hostapd_config_free(conf);
+	os_free(mconf);
+	os_free(llids);
+	os_free(wpa_s);
+
+	if (ret)
+		wpa_printf(MSG_ERROR, "mesh module test failure");
+
+	return ret;
+}
+
+#endif /* CONFIG_MESH */
+
+
 int wpas_module_tests(void)
 {
 	int ret = 0;
@@ -79,6 +604,19 @@ int wpas_module_tests(void)
 	if (wpas_blacklist_module_tests() < 0)
 		ret = -1;
 
+	if (wpas_bss_module_tests() < 0)
+		ret = -1;
+
+#ifndef CONFIG_NO_SCAN_PROCESSING
+	if (wpas_bss_select_module_tests() < 0)
+		ret = -1;
+#endif /* CONFIG_NO_SCAN_PROCESSING */
+
+#ifdef CONFIG_MESH
+	if (wpas_mesh_module_tests() < 0)
+		ret = -1;
+#endif /* CONFIG_MESH */
+
 #ifdef CONFIG_WPS
 	if (wps_module_tests() < 0)
 		ret = -1;